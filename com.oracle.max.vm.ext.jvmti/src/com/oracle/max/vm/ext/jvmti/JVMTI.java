@@ -42,6 +42,8 @@ import com.sun.max.vm.actor.member.MethodActor;
 import com.sun.max.vm.compiler.RuntimeCompiler;
 import com.sun.max.vm.compiler.target.TargetMethod;
 import com.sun.max.vm.jni.*;
+import com.sun.max.vm.layout.Layout;
+import com.sun.max.vm.reference.Reference;
 import com.sun.max.vm.runtime.CriticalNativeMethod;
 import com.sun.max.vm.thread.VmThread;
 import com.sun.max.vm.thread.VmThreadFactory;
@@ -246,6 +248,11 @@ public class JVMTI {
             JVMTIException.raiseEvent(throwable, sp, fp, ip);
         }
 
+        @Override
+        public void objectSampled(Object object) {
+            JVMTI.event(E.SAMPLED_OBJECT_ALLOC, object);
+        }
+
         @Override
         public RuntimeCompiler runtimeCompiler(RuntimeCompiler stdRuntimeCompiler) {
             return new T1X(JVMTI_T1XTemplateSource.class, new JVMTI_T1XCompilationFactory());
@@ -380,6 +387,7 @@ public class JVMTI {
             NativeEnv nativeEnv = (NativeEnv) jvmtiEnvs[i];
             if (nativeEnv.cstruct.equals(env)) {
                 // TODO cleanup
+                JVMTICallbacks.disposeFieldWatchFilters(env);
                 nativeEnv.cstruct = Pointer.zero();
                 activeEnvCount--;
                 return JVMTI_ERROR_NONE;
@@ -708,6 +716,11 @@ public class JVMTI {
                         invokeExceptionCallback(callback, cstruct, event == E.EXCEPTION_CATCH, currentThreadHandle(), exceptionEventData.methodID, exceptionEventData.location,
                                         JniHandles.createLocalHandle(exceptionEventData.throwable), exceptionEventData.catchMethodID, exceptionEventData.catchLocation);
                         break;
+
+                    case SAMPLED_OBJECT_ALLOC:
+                        invokeSampledObjectAllocCallback(callback, cstruct, currentThreadHandle(), JniHandles.createLocalHandle(arg1),
+                                        JniHandles.createLocalHandle(arg1.getClass()), Layout.size(Reference.fromJava(arg1)).toLong());
+                        break;
                 }
             } else {
                 JavaEnv javaEnv = (JavaEnv) jvmtiEnvs[i];
@@ -807,6 +820,10 @@ public class JVMTI {
                         break;
                     }
 
+                    case SAMPLED_OBJECT_ALLOC:
+                        // only delivered to native agents
+                        break;
+
                     default:
                         assert false;
                 }
@@ -926,6 +943,12 @@ public class JVMTI {
         return JniHandles.createLocalHandle(VmThread.current().javaThread());
     }
 
+    /**
+     * The size of the callbacks table allocated for an environment in jvmti.c, which has an entry for every
+     * {@linkplain JVMTIEvents.E event}, including those after the last one in {@code jvmtiEventCallbacks}.
+     */
+    static final int CALLBACKS_SIZE = JVMTIEvents.E.VALUES.length * Word.size();
+
     private static Pointer getCallBack(Pointer callbacks, JVMTIEvents.E event) {
         int index = event.ordinal();
         return callbacks.readWord(index * Pointer.size()).asPointer();
@@ -37,10 +37,14 @@ public class JVMTICallbacks {
         new CriticalNativeMethod(JVMTICallbacks.class, "invokeClassfileLoadHookCallback");
         new CriticalNativeMethod(JVMTICallbacks.class, "invokeFieldWatchCallback");
         new CriticalNativeMethod(JVMTICallbacks.class, "invokeHeapIterationCallback");
+        new CriticalNativeMethod(JVMTICallbacks.class, "invokeHeapIterationCallbacks");
         new CriticalNativeMethod(JVMTICallbacks.class, "invokeBreakpointCallback");
         new CriticalNativeMethod(JVMTICallbacks.class, "invokeExceptionCallback");
         new CriticalNativeMethod(JVMTICallbacks.class, "invokeCompiledMethodLoadCallback");
         new CriticalNativeMethod(JVMTICallbacks.class, "invokeCompiledMethodUnloadCallback");
+        new CriticalNativeMethod(JVMTICallbacks.class, "invokeSampledObjectAllocCallback");
+        new CriticalNativeMethod(JVMTICallbacks.class, "getExtensionFunctions");
+        new CriticalNativeMethod(JVMTICallbacks.class, "disposeFieldWatchFilters");
     }
 
     static native int invokeAgentOnLoad(Address onLoad, Pointer options);
@@ -53,6 +57,12 @@ public class JVMTICallbacks {
     static native void invokeClassfileLoadHookCallback(Pointer callback, Pointer jvmtiEnv,
                     Word klass, Word loader, Pointer name, Word protectionDomain, int classDataLen,
                     Pointer classDataPtr, Pointer newClassDataLenPtr, Pointer newClassDataPtrPtr);
+    /**
+     * Implements {@code GetExtensionFunctions}, the extension functions being implemented in jvmti.c.
+     */
+    static native int getExtensionFunctions(Pointer jvmtiEnv, Pointer extensionCountPtr, Pointer extensionsPtr);
+    static native void disposeFieldWatchFilters(Pointer jvmtiEnv);
+
     static native void invokeFieldWatchCallback(Pointer callback, Pointer jvmtiEnv,
                     Word thread, Word methodID, long location, Word klass, Word object,
                     Word fieldID, byte sigType, Word value);
@@ -64,6 +74,14 @@ public class JVMTICallbacks {
 
     static native int invokeHeapIterationCallback(Pointer callback, long classTag, long size, Pointer tagPtr, int length, Word userData);
 
+    /**
+     * Calls a heap iteration callback for each entry of a batch (see {@code HeapIterationEntryStruct} in jvmti.c).
+     *
+     * @return {@code count} or, if the callback returned {@code JVMTI_VISIT_ABORT} for the entry at index {@code i},
+     *         {@code -(i + 1)}
+     */
+    static native int invokeHeapIterationCallbacks(Pointer callback, Pointer entries, int count, Word userData);
+
     static native void invokeBreakpointCallback(Pointer callback, Pointer jvmtiEnv, Word thread, long methodId, int location);
 
     static native void invokeCompiledMethodLoadCallback(Pointer callback, Pointer jvmtiEnv, Word methodId, int codeSize,
@@ -71,4 +89,6 @@ public class JVMTICallbacks {
 
     static native void invokeCompiledMethodUnloadCallback(Pointer callback, Pointer jvmtiEnv, Word methodId, Address codeAddr);
 
+    static native void invokeSampledObjectAllocCallback(Pointer callback, Pointer jvmtiEnv, Word thread, Word object, Word klass, long size);
+
 }
@@ -306,6 +306,7 @@ public class JVMTIConstants {
     public static final int JVMTI_EVENT_GARBAGE_COLLECTION_FINISH = 82;
     public static final int JVMTI_EVENT_OBJECT_FREE = 83;
     public static final int JVMTI_EVENT_VM_OBJECT_ALLOC = 84;
-    public static final int JVMTI_MAX_EVENT_TYPE_VAL = 84;
+    public static final int JVMTI_EVENT_SAMPLED_OBJECT_ALLOC = 86;
+    public static final int JVMTI_MAX_EVENT_TYPE_VAL = 86;
 
 }
@@ -31,7 +31,9 @@ import com.sun.max.unsafe.*;
 enum JVMTIEnvNativeStruct {
     FUNCTIONS(0),
     CALLBACKS(8),
-    CAPABILITIES(16); // the capabilities that are active for this environment
+    CAPABILITIES(16), // the capabilities that are active for this environment
+    FIELD_WATCH_FILTER(24), // the filter applied to the field watch events natively
+    REPLACED_FIELD_WATCH_FILTERS(32); // the replaced filters, released when the environment is disposed
 
     int offset;
 
@@ -32,6 +32,7 @@ import com.sun.max.vm.actor.holder.*;
 import com.sun.max.vm.actor.member.*;
 import com.oracle.max.vm.ext.jvmti.JVMTIBreakpoints.*;
 import com.sun.max.vm.heap.Heap;
+import com.sun.max.vm.heap.HeapSchemeWithTLAB;
 import com.sun.max.vm.log.*;
 import com.sun.max.vm.runtime.*;
 import com.sun.max.vm.thread.*;
@@ -103,7 +104,9 @@ public class JVMTIEvents {
         GARBAGE_COLLECTION_START(JVMTIConstants.JVMTI_EVENT_GARBAGE_COLLECTION_START, LIVE_PHASE),
         GARBAGE_COLLECTION_FINISH(JVMTIConstants.JVMTI_EVENT_GARBAGE_COLLECTION_FINISH, LIVE_PHASE),
         OBJECT_FREE(JVMTIConstants.JVMTI_EVENT_OBJECT_FREE, LIVE_PHASE),
-        VM_OBJECT_ALLOC(JVMTIConstants.JVMTI_EVENT_VM_OBJECT_ALLOC, LIVE_PHASE);
+        VM_OBJECT_ALLOC(JVMTIConstants.JVMTI_EVENT_VM_OBJECT_ALLOC, LIVE_PHASE),
+        MISSING5(-5, 0),
+        SAMPLED_OBJECT_ALLOC(JVMTIConstants.JVMTI_EVENT_SAMPLED_OBJECT_ALLOC, LIVE_PHASE);
 
         /**
          * The JVMTI code for this event.
@@ -364,6 +367,10 @@ public class JVMTIEvents {
 
         if (event == E.SINGLE_STEP) {
             JVMTIBreakpoints.setSingleStep(mode == JVMTI_ENABLE);
+        } else if (event == E.SAMPLED_OBJECT_ALLOC) {
+            // allocations are only counted while some agent wants the samples
+            long interval = isEventSet(E.SAMPLED_OBJECT_ALLOC) ? JVMTIVMOptions.heapSamplingIntervalOption.getValue().toLong() : 0;
+            HeapSchemeWithTLAB.setAllocationSamplingInterval(interval);
         }
 
         return JVMTI_ERROR_NONE;
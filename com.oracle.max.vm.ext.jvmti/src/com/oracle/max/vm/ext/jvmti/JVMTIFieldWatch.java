@@ -141,10 +141,11 @@ public class JVMTIFieldWatch {
         if (classActor != null) {
             JVMTICallbacks.invokeFieldWatchCallback(callback, jvmtiEnv, thread,
                 Word.zero(), 0, // TODO set these values
-                JniHandles.createLocalHandle(classActor.toJava()), JniHandles.createLocalHandle(data.object),
+                JniHandles.createLocalHandle(classActor.toJava()),
+                data.isStatic ? JniHandle.zero() : JniHandles.createLocalHandle(data.object),
                 FieldID.fromFieldActor(data.currentFieldActor),
-                data.tag == FieldEventData.DATA_NONE ? 0 : signatureType(data.tag),
-                Word.zero());
+                data.tag == FieldEventData.DATA_NONE ? 0 : signatureType(data.currentFieldActor),
+                newValue(data));
         }
     }
 
@@ -175,8 +176,32 @@ public class JVMTIFieldWatch {
         }
     }
 
-    private static byte signatureType(int tag) {
-        return 'I';
+    /**
+     * The JNI signature type of a field, words being reported as {@code long}.
+     */
+    private static byte signatureType(FieldActor fieldActor) {
+        if (fieldActor.kind.isWord) {
+            return 'J';
+        }
+        return (byte) fieldActor.descriptor().string.charAt(0);
+    }
+
+    /**
+     * Packs the new value of a modification event into the bits of a {@code jvalue}, so that the native side can
+     * compare it with the current value when filtering.
+     */
+    private static Word newValue(FieldEventData data) {
+        switch (data.tag) {
+            // Checkstyle: stop
+            case FieldEventData.DATA_INT: return Address.fromInt(data.intValue);
+            case FieldEventData.DATA_LONG: return Address.fromLong(data.longValue);
+            case FieldEventData.DATA_FLOAT: return Address.fromInt(Float.floatToRawIntBits(data.floatValue));
+            case FieldEventData.DATA_DOUBLE: return Address.fromLong(Double.doubleToRawLongBits(data.doubleValue));
+            case FieldEventData.DATA_OBJECT: return JniHandles.createLocalHandle(data.objectValue);
+            case FieldEventData.DATA_WORD: return data.wordValue;
+            default: return Word.zero();
+            // Checkstyle: resume
+        }
     }
 
 }
@@ -3344,7 +3344,10 @@ public class JVMTIFunctions  {
                 return JVMTI_ERROR_INVALID_ENVIRONMENT;
             }
             Pointer envCallbacks = CALLBACKS.get(env).asPointer();
-            Memory.copyBytes(callbacks, envCallbacks, Size.fromInt(size_of_callbacks));
+            // An agent built against a later jvmti.h may pass callbacks for events we do not know about
+            int size = callbacks.isZero() ? 0 : Math.min(size_of_callbacks, JVMTI.CALLBACKS_SIZE);
+            Memory.copyBytes(callbacks, envCallbacks, Size.fromInt(size));
+            Memory.clearBytes(envCallbacks.plus(size), JVMTI.CALLBACKS_SIZE - size);
             return JVMTI_ERROR_NONE;
         } catch (Throwable t) {
             return JVMTI_ERROR_INTERNAL;
@@ -3356,7 +3359,7 @@ public class JVMTIFunctions  {
 
     @VM_ENTRY_POINT
     private static int GenerateEvents(Pointer env, int event_type) {
-        // Source: JVMTIFunctionsSource.java:1055
+        // Source: JVMTIFunctionsSource.java:1058
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.GenerateEvents.ordinal(), env, Address.fromInt(event_type));
@@ -3377,7 +3380,7 @@ public class JVMTIFunctions  {
 
     @VM_ENTRY_POINT
     private static int GetExtensionFunctions(Pointer env, Pointer extension_count_ptr, Pointer extensions) {
-        // Source: JVMTIFunctionsSource.java:1060
+        // Source: JVMTIFunctionsSource.java:1063
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.GetExtensionFunctions.ordinal(), env, extension_count_ptr, extensions);
@@ -3387,7 +3390,7 @@ public class JVMTIFunctions  {
             if (jvmtiEnv == null) {
                 return JVMTI_ERROR_INVALID_ENVIRONMENT;
             }
-            return JVMTI_ERROR_NOT_AVAILABLE; // TODO
+            return JVMTICallbacks.getExtensionFunctions(env, extension_count_ptr, extensions);
         } catch (Throwable t) {
             return JVMTI_ERROR_INTERNAL;
         } finally {
@@ -3398,7 +3401,7 @@ public class JVMTIFunctions  {
 
     @VM_ENTRY_POINT
     private static int GetExtensionEvents(Pointer env, Pointer extension_count_ptr, Pointer extensions) {
-        // Source: JVMTIFunctionsSource.java:1065
+        // Source: JVMTIFunctionsSource.java:1068
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.GetExtensionEvents.ordinal(), env, extension_count_ptr, extensions);
@@ -3419,7 +3422,7 @@ public class JVMTIFunctions  {
 
     @VM_ENTRY_POINT
     private static int SetExtensionEventCallback(Pointer env, int extension_event_index, Address callback) {
-        // Source: JVMTIFunctionsSource.java:1070
+        // Source: JVMTIFunctionsSource.java:1073
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.SetExtensionEventCallback.ordinal(), env, Address.fromInt(extension_event_index), callback);
@@ -3440,7 +3443,7 @@ public class JVMTIFunctions  {
 
     @VM_ENTRY_POINT
     private static int DisposeEnvironment(Pointer env) {
-        // Source: JVMTIFunctionsSource.java:1075
+        // Source: JVMTIFunctionsSource.java:1078
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.DisposeEnvironment.ordinal(), env);
@@ -3462,7 +3465,7 @@ public class JVMTIFunctions  {
 
     @VM_ENTRY_POINT
     private static int GetErrorName(Pointer env, int error, Pointer name_ptr) {
-        // Source: JVMTIFunctionsSource.java:1081
+        // Source: JVMTIFunctionsSource.java:1084
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.GetErrorName.ordinal(), env, Address.fromInt(error), name_ptr);
@@ -3494,7 +3497,7 @@ public class JVMTIFunctions  {
 
     @VM_ENTRY_POINT
     private static int GetJLocationFormat(Pointer env, Pointer format_ptr) {
-        // Source: JVMTIFunctionsSource.java:1095
+        // Source: JVMTIFunctionsSource.java:1098
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.GetJLocationFormat.ordinal(), env, format_ptr);
@@ -3516,7 +3519,7 @@ public class JVMTIFunctions  {
 
     @VM_ENTRY_POINT
     private static int GetSystemProperties(Pointer env, Pointer count_ptr, Pointer property_ptr) {
-        // Source: JVMTIFunctionsSource.java:1101
+        // Source: JVMTIFunctionsSource.java:1104
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.GetSystemProperties.ordinal(), env, count_ptr, property_ptr);
@@ -3537,7 +3540,7 @@ public class JVMTIFunctions  {
 
     @VM_ENTRY_POINT
     private static int GetSystemProperty(Pointer env, Pointer property, Pointer value_ptr) {
-        // Source: JVMTIFunctionsSource.java:1106
+        // Source: JVMTIFunctionsSource.java:1109
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.GetSystemProperty.ordinal(), env, property, value_ptr);
@@ -3564,7 +3567,7 @@ public class JVMTIFunctions  {
 
     @VM_ENTRY_POINT
     private static int SetSystemProperty(Pointer env, Pointer property, Pointer value) {
-        // Source: JVMTIFunctionsSource.java:1113
+        // Source: JVMTIFunctionsSource.java:1116
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.SetSystemProperty.ordinal(), env, property, value);
@@ -3591,7 +3594,7 @@ public class JVMTIFunctions  {
 
     @VM_ENTRY_POINT
     private static int GetPhase(Pointer env, Pointer phase_ptr) {
-        // Source: JVMTIFunctionsSource.java:1120
+        // Source: JVMTIFunctionsSource.java:1123
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.GetPhase.ordinal(), env, phase_ptr);
@@ -3616,7 +3619,7 @@ public class JVMTIFunctions  {
 
     @VM_ENTRY_POINT
     private static int GetCurrentThreadCpuTimerInfo(Pointer env, Pointer info_ptr) {
-        // Source: JVMTIFunctionsSource.java:1127
+        // Source: JVMTIFunctionsSource.java:1130
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.GetCurrentThreadCpuTimerInfo.ordinal(), env, info_ptr);
@@ -3637,7 +3640,7 @@ public class JVMTIFunctions  {
 
     @VM_ENTRY_POINT
     private static int GetCurrentThreadCpuTime(Pointer env, Pointer nanos_ptr) {
-        // Source: JVMTIFunctionsSource.java:1132
+        // Source: JVMTIFunctionsSource.java:1135
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.GetCurrentThreadCpuTime.ordinal(), env, nanos_ptr);
@@ -3658,7 +3661,7 @@ public class JVMTIFunctions  {
 
     @VM_ENTRY_POINT
     private static int GetThreadCpuTimerInfo(Pointer env, Pointer info_ptr) {
-        // Source: JVMTIFunctionsSource.java:1137
+        // Source: JVMTIFunctionsSource.java:1140
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.GetThreadCpuTimerInfo.ordinal(), env, info_ptr);
@@ -3679,7 +3682,7 @@ public class JVMTIFunctions  {
 
     @VM_ENTRY_POINT
     private static int GetThreadCpuTime(Pointer env, JniHandle thread, Pointer nanos_ptr) {
-        // Source: JVMTIFunctionsSource.java:1142
+        // Source: JVMTIFunctionsSource.java:1145
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.GetThreadCpuTime.ordinal(), env, thread, nanos_ptr);
@@ -3700,7 +3703,7 @@ public class JVMTIFunctions  {
 
     @VM_ENTRY_POINT
     private static int GetTimerInfo(Pointer env, Pointer info_ptr) {
-        // Source: JVMTIFunctionsSource.java:1147
+        // Source: JVMTIFunctionsSource.java:1150
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.GetTimerInfo.ordinal(), env, info_ptr);
@@ -3721,7 +3724,7 @@ public class JVMTIFunctions  {
 
     @VM_ENTRY_POINT
     private static int GetTime(Pointer env, Pointer nanos_ptr) {
-        // Source: JVMTIFunctionsSource.java:1152
+        // Source: JVMTIFunctionsSource.java:1155
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.GetTime.ordinal(), env, nanos_ptr);
@@ -3747,7 +3750,7 @@ public class JVMTIFunctions  {
 
     @VM_ENTRY_POINT
     private static int GetPotentialCapabilities(Pointer env, Pointer capabilities_ptr) {
-        // Source: JVMTIFunctionsSource.java:1160
+        // Source: JVMTIFunctionsSource.java:1163
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.GetPotentialCapabilities.ordinal(), env, capabilities_ptr);
@@ -3776,11 +3779,11 @@ public class JVMTIFunctions  {
 
     @VM_ENTRY_POINT
     private static native void reserved141();
-        // Source: JVMTIFunctionsSource.java:1169
+        // Source: JVMTIFunctionsSource.java:1172
 
     @VM_ENTRY_POINT
     private static int AddCapabilities(Pointer env, Pointer capabilities_ptr) {
-        // Source: JVMTIFunctionsSource.java:1172
+        // Source: JVMTIFunctionsSource.java:1175
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.AddCapabilities.ordinal(), env, capabilities_ptr);
@@ -3807,7 +3810,7 @@ public class JVMTIFunctions  {
 
     @VM_ENTRY_POINT
     private static int RelinquishCapabilities(Pointer env, Pointer capabilities_ptr) {
-        // Source: JVMTIFunctionsSource.java:1179
+        // Source: JVMTIFunctionsSource.java:1182
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.RelinquishCapabilities.ordinal(), env, capabilities_ptr);
@@ -3834,7 +3837,7 @@ public class JVMTIFunctions  {
 
     @VM_ENTRY_POINT
     private static int GetAvailableProcessors(Pointer env, Pointer processor_count_ptr) {
-        // Source: JVMTIFunctionsSource.java:1186
+        // Source: JVMTIFunctionsSource.java:1189
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.GetAvailableProcessors.ordinal(), env, processor_count_ptr);
@@ -3860,7 +3863,7 @@ public class JVMTIFunctions  {
 
     @VM_ENTRY_POINT
     private static int GetClassVersionNumbers(Pointer env, JniHandle klass, Pointer minor_version_ptr, Pointer major_version_ptr) {
-        // Source: JVMTIFunctionsSource.java:1194
+        // Source: JVMTIFunctionsSource.java:1197
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.GetClassVersionNumbers.ordinal(), env, klass, minor_version_ptr, major_version_ptr);
@@ -3899,7 +3902,7 @@ public class JVMTIFunctions  {
 
     @VM_ENTRY_POINT
     private static int GetConstantPool(Pointer env, JniHandle klass, Pointer constant_pool_count_ptr, Pointer constant_pool_byte_count_ptr, Pointer constant_pool_bytes_ptr) {
-        // Source: JVMTIFunctionsSource.java:1205
+        // Source: JVMTIFunctionsSource.java:1208
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.GetConstantPool.ordinal(), env, klass, constant_pool_count_ptr, constant_pool_byte_count_ptr, constant_pool_bytes_ptr);
@@ -3920,7 +3923,7 @@ public class JVMTIFunctions  {
 
     @VM_ENTRY_POINT
     private static int GetEnvironmentLocalStorage(Pointer env, Pointer data_ptr) {
-        // Source: JVMTIFunctionsSource.java:1210
+        // Source: JVMTIFunctionsSource.java:1213
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.GetEnvironmentLocalStorage.ordinal(), env, data_ptr);
@@ -3944,7 +3947,7 @@ public class JVMTIFunctions  {
 
     @VM_ENTRY_POINT
     private static int SetEnvironmentLocalStorage(Pointer env, Pointer data) {
-        // Source: JVMTIFunctionsSource.java:1218
+        // Source: JVMTIFunctionsSource.java:1221
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.SetEnvironmentLocalStorage.ordinal(), env, data);
@@ -3967,7 +3970,7 @@ public class JVMTIFunctions  {
 
     @VM_ENTRY_POINT
     private static int AddToBootstrapClassLoaderSearch(Pointer env, Pointer segment) {
-        // Source: JVMTIFunctionsSource.java:1225
+        // Source: JVMTIFunctionsSource.java:1228
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.AddToBootstrapClassLoaderSearch.ordinal(), env, segment);
@@ -3992,7 +3995,7 @@ public class JVMTIFunctions  {
 
     @VM_ENTRY_POINT
     private static int SetVerboseFlag(Pointer env, int flag, boolean value) {
-        // Source: JVMTIFunctionsSource.java:1232
+        // Source: JVMTIFunctionsSource.java:1235
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.SetVerboseFlag.ordinal(), env, Address.fromInt(flag), Address.fromInt(value ? 1 : 0));
@@ -4014,7 +4017,7 @@ public class JVMTIFunctions  {
 
     @VM_ENTRY_POINT
     private static int AddToSystemClassLoaderSearch(Pointer env, Pointer segment) {
-        // Source: JVMTIFunctionsSource.java:1238
+        // Source: JVMTIFunctionsSource.java:1241
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.AddToSystemClassLoaderSearch.ordinal(), env, segment);
@@ -4035,7 +4038,7 @@ public class JVMTIFunctions  {
 
     @VM_ENTRY_POINT
     private static int RetransformClasses(Pointer env, int class_count, Pointer classes) {
-        // Source: JVMTIFunctionsSource.java:1243
+        // Source: JVMTIFunctionsSource.java:1246
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.RetransformClasses.ordinal(), env, Address.fromInt(class_count), classes);
@@ -4056,7 +4059,7 @@ public class JVMTIFunctions  {
 
     @VM_ENTRY_POINT
     private static int GetOwnedMonitorStackDepthInfo(Pointer env, JniHandle thread, Pointer monitor_info_count_ptr, Pointer monitor_info_ptr) {
-        // Source: JVMTIFunctionsSource.java:1248
+        // Source: JVMTIFunctionsSource.java:1251
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.GetOwnedMonitorStackDepthInfo.ordinal(), env, thread, monitor_info_count_ptr, monitor_info_ptr);
@@ -4077,7 +4080,7 @@ public class JVMTIFunctions  {
 
     @VM_ENTRY_POINT
     private static int GetObjectSize(Pointer env, JniHandle object, Pointer size_ptr) {
-        // Source: JVMTIFunctionsSource.java:1253
+        // Source: JVMTIFunctionsSource.java:1256
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.GetObjectSize.ordinal(), env, object, size_ptr);
@@ -4104,7 +4107,7 @@ public class JVMTIFunctions  {
 
     @VM_ENTRY_POINT
     private static int GetLocalInstance(Pointer env, JniHandle thread, int depth, Pointer value_ptr) {
-        // Source: JVMTIFunctionsSource.java:1260
+        // Source: JVMTIFunctionsSource.java:1263
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.GetLocalInstance.ordinal(), env, thread, Address.fromInt(depth), value_ptr);
@@ -1047,7 +1047,10 @@ public class JVMTIFunctionsSource {
     private static int SetEventCallbacks(Pointer env, Pointer callbacks, int size_of_callbacks) {
         // PHASES: ONLOAD,LIVE
         Pointer envCallbacks = CALLBACKS.get(env).asPointer();
-        Memory.copyBytes(callbacks, envCallbacks, Size.fromInt(size_of_callbacks));
+        // An agent built against a later jvmti.h may pass callbacks for events we do not know about
+        int size = callbacks.isZero() ? 0 : Math.min(size_of_callbacks, JVMTI.CALLBACKS_SIZE);
+        Memory.copyBytes(callbacks, envCallbacks, Size.fromInt(size));
+        Memory.clearBytes(envCallbacks.plus(size), JVMTI.CALLBACKS_SIZE - size);
         return JVMTI_ERROR_NONE;
     }
 
@@ -1058,7 +1061,7 @@ public class JVMTIFunctionsSource {
 
     @VM_ENTRY_POINT
     private static int GetExtensionFunctions(Pointer env, Pointer extension_count_ptr, Pointer extensions) {
-        return JVMTI_ERROR_NOT_AVAILABLE; // TODO
+        return JVMTICallbacks.getExtensionFunctions(env, extension_count_ptr, extensions);
     }
 
     @VM_ENTRY_POINT
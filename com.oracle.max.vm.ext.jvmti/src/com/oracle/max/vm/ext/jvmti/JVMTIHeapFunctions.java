@@ -29,6 +29,7 @@ import static com.oracle.max.vm.ext.jvmti.JVMTICallbacks.*;
 import static com.oracle.max.vm.ext.jvmti.JVMTIConstants.*;
 import static com.oracle.max.vm.ext.jvmti.JVMTIUtil.*;
 
+import com.sun.max.memory.*;
 import com.sun.max.unsafe.*;
 import com.sun.max.vm.*;
 import com.sun.max.vm.actor.holder.*;
@@ -64,6 +65,16 @@ public class JVMTIHeapFunctions {
         }
     }
 
+    /**
+     * The number of objects in a batch given to a native heap iteration callback.
+     */
+    private static final int HEAP_ITERATION_BATCH = 4096;
+
+    /**
+     * The size of {@code HeapIterationEntryStruct} in jvmti.c.
+     */
+    private static final int HEAP_ITERATION_ENTRY_SIZE = 32;
+
     /** A {@link VmOperation} that prevents any allocgtion while we walk the heap.
      * We don't care about the threads, just that they are blocked, so we
      * override the {@link VmOperation#doIt} method.
@@ -75,6 +86,7 @@ public class JVMTIHeapFunctions {
             protected final JVMTI.Env env;
             protected final int heapFilter;
             protected final Class klass;
+            boolean aborted;
 
             CBCV(JVMTI.Env env, int heapFilter, Class klass) {
                 this.env = env;
@@ -119,17 +131,34 @@ public class JVMTIHeapFunctions {
                 }
                 int flags = doCallback(object, objectClass);
                 if ((flags & JVMTI_VISIT_ABORT) != 0) {
+                    aborted = true;
                     return false;
                 }
                 return true;
             }
 
             protected abstract int doCallback(Object object, Class objectClass);
+
+            /**
+             * Called after the heap walk, unless it was aborted.
+             */
+            protected void finish() {
+            }
         }
 
+        /**
+         * Calls a native heap iteration callback for batches of objects, so that the boundary between Java and native
+         * code is crossed once per batch rather than once per object. The tags, class tags, sizes and lengths of the
+         * objects in a batch are written to a buffer in C heap memory and the tags updated by the callback are stored
+         * when the batch returns. Once the callback aborts the iteration, the remaining objects of the batch are not
+         * visited.
+         */
         class CBCVNative extends CBCV {
             private final Pointer callbacks;
             private final Word userData;
+            private final Object[] batch = new Object[HEAP_ITERATION_BATCH];
+            private Pointer entries = Pointer.zero();
+            private int count;
 
             CBCVNative(JVMTI.Env env, int heapFilter, Class klass, Pointer callbacks, Word userData) {
                 super(env, heapFilter, klass);
@@ -140,28 +169,61 @@ public class JVMTIHeapFunctions {
 
             @Override
             protected int doCallback(Object object, Class objectClass) {
-                Pointer tagPtr = Intrinsics.alloca(Word.size(), false);
+                if (HeapCallbacks.HEAP_ITERATION.getCallback(callbacks).isZero()) {
+                    return 0;
+                }
+                if (entries.isZero()) {
+                    entries = Memory.mustAllocate(HEAP_ITERATION_BATCH * HEAP_ITERATION_ENTRY_SIZE);
+                }
                 Reference objectRef = Reference.fromJava(object);
-                Word heapIterationCallback = HeapCallbacks.HEAP_ITERATION.getCallback(callbacks);
-                if (!heapIterationCallback.isZero()) {
-                    long tag = env.tags.getLongTag(object);
-                    tagPtr.setLong(tag);
-                    int flags = invokeHeapIterationCallback(
-                                    heapIterationCallback.asPointer(),
-                                    objectClass == null ? 0 : env.tags.getLongTag(objectClass),
-                                    Layout.size(objectRef).toInt(),
-                                    tagPtr,
-                                    Layout.isArray(objectRef) ? Layout.readArrayLength(objectRef) : -1,
-                                    userData);
-                    long newTag = tagPtr.getLong();
-                    if (newTag != tag) {
-                        env.tags.setTag(object, newTag);
-                    }
-                    return flags;
+                Pointer entry = entries.plus(count * HEAP_ITERATION_ENTRY_SIZE);
+                entry.writeLong(0, env.tags.getLongTag(object));
+                entry.writeLong(8, objectClass == null ? 0 : env.tags.getLongTag(objectClass));
+                entry.writeLong(16, Layout.size(objectRef).toLong());
+                entry.writeInt(24, Layout.isArray(objectRef) ? Layout.readArrayLength(objectRef) : -1);
+                batch[count++] = object;
+                if (count == HEAP_ITERATION_BATCH) {
+                    return flush();
                 }
                 return 0;
             }
 
+            /**
+             * Calls the callback for the objects in the current batch and stores the tags it changed.
+             *
+             * @return {@code JVMTI_VISIT_ABORT} if the callback aborted the iteration
+             */
+            private int flush() {
+                int result = count;
+                if (count > 0) {
+                    result = invokeHeapIterationCallbacks(HeapCallbacks.HEAP_ITERATION.getCallback(callbacks).asPointer(), entries, count, userData);
+                    int visited = result < 0 ? -result : result;
+                    for (int i = 0; i < count; i++) {
+                        if (i < visited) {
+                            Pointer entry = entries.plus(i * HEAP_ITERATION_ENTRY_SIZE);
+                            long tag = entry.readLong(0);
+                            if (tag != env.tags.getLongTag(batch[i])) {
+                                env.tags.setTag(batch[i], tag);
+                            }
+                        }
+                        batch[i] = null;
+                    }
+                    count = 0;
+                }
+                return result < 0 ? JVMTI_VISIT_ABORT : 0;
+            }
+
+            @Override
+            protected void finish() {
+                flush();
+            }
+
+            void release() {
+                if (!entries.isZero()) {
+                    Memory.deallocate(entries);
+                    entries = Pointer.zero();
+                }
+            }
         }
 
         class CBCVJava extends CBCV {
@@ -219,7 +281,13 @@ public class JVMTIHeapFunctions {
             try {
                 Heap.enableImmortalMemoryAllocation();
                 vmConfig().heapScheme().walkHeap(cbcv);
+                if (!cbcv.aborted) {
+                    cbcv.finish();
+                }
             } finally {
+                if (cbcv instanceof CBCVNative) {
+                    ((CBCVNative) cbcv).release();
+                }
                 Heap.disableImmortalMemoryAllocation();
             }
         }
@@ -22,6 +22,7 @@
  */
 package com.oracle.max.vm.ext.jvmti;
 
+import com.sun.max.unsafe.*;
 import com.sun.max.vm.*;
 
 public class JVMTIVMOptions {
@@ -30,11 +31,18 @@ public class JVMTIVMOptions {
      */
     static VMBooleanOption jdwpLogOption = new VMBooleanOption("-XX:-JDWPLog", "force JDWP logging");
 
+    /**
+     * The mean number of bytes allocated by a thread between two {@code SampledObjectAlloc} events.
+     */
+    static VMSizeOption heapSamplingIntervalOption = new VMSizeOption("-XX:JVMTIHeapSamplingInterval=", Size.K.times(512),
+                    "Mean number of bytes allocated by a thread between JVMTI sampled object allocation events.");
+
     static {
         VMOptions.register(new PathAgentVMOption(), MaxineVM.Phase.PRISTINE);
         VMOptions.register(new LibAgentVMOption(), MaxineVM.Phase.PRISTINE);
         VMOptions.register(new RunAgentVMOption(), MaxineVM.Phase.PRISTINE);
         VMOptions.register(new VMOption("-Xdebug ", "(deprecated) debugging support"), MaxineVM.Phase.PRISTINE);
         VMOptions.register(jdwpLogOption, MaxineVM.Phase.PRISTINE);
+        VMOptions.register(heapSamplingIntervalOption, MaxineVM.Phase.PRISTINE);
     }
 }
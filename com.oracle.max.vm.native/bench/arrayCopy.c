@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2007, 2011, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ */
+/**
+ * Native side of the array copy benchmark (see MeasureArrayCopy.java), which times the JVM_ArrayCopy
+ * entry point of the VM as called by native code.
+ */
+#include <dlfcn.h>
+#include <time.h>
+#include "jni.h"
+
+typedef void (*JVM_ArrayCopyFunction)(JNIEnv *env, jclass ignored, jobject src, jint srcPos, jobject dst, jint dstPos, jint length);
+
+static jlong now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((jlong) ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+/**
+ * Times 'iterations' calls of JVM_ArrayCopy copying 'length' elements from 'src' to 'dst'.
+ *
+ * @return the time taken in nanoseconds or -1 if the VM does not export JVM_ArrayCopy
+ */
+JNIEXPORT jlong JNICALL
+Java_com_oracle_max_vm_tests_interactive_MeasureArrayCopy_jvmArrayCopy(JNIEnv *env, jclass c, jobject src, jobject dst, jint length, jint iterations) {
+    JVM_ArrayCopyFunction arrayCopy = (JVM_ArrayCopyFunction) dlsym(RTLD_DEFAULT, "JVM_ArrayCopy");
+    if (arrayCopy == NULL) {
+        return -1;
+    }
+    jint i;
+    jlong start = now();
+    for (i = 0; i < iterations; i++) {
+        arrayCopy(env, NULL, src, 0, dst, 0, length);
+        if ((*env)->ExceptionCheck(env)) {
+            return -1;
+        }
+    }
+    return now() - start;
+}
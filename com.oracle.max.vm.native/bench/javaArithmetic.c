@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) 2011, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ */
+/**
+ * Native side of the arithmetic helper microbenchmark (see MeasureJavaArithmetic.java), which times the
+ * out-of-line runtime helpers for long and floating point arithmetic exported by the VM (d2long et al. in
+ * maxine.c and snippet.c) against the inline versions in javaArithmetic.h.
+ */
+#include <dlfcn.h>
+#include <time.h>
+#include "jni.h"
+#include "javaArithmetic.h"
+
+/* The number of distinct operands, a power of two so that they are selected with a mask. */
+#define OPERANDS 256
+
+/*
+ * The helpers, in the order of MeasureJavaArithmetic.HELPERS.
+ */
+static const char *helperNames[] = {
+    "d2long", "f2long", "l2double", "l2float",
+    "arithmeticldiv", "arithmeticlrem", "arithmeticludiv", "arithmeticlurem",
+    "nativeLongCompare", "nativeLongSignedShiftedRight", "nativeLongMultiply", "nativeLongDivided", "nativeLongRemainder",
+    "nativeFloatRemainder", "nativeDoubleRemainder"
+};
+
+#define HELPER_COUNT ((jint) (sizeof(helperNames) / sizeof(helperNames[0])))
+
+typedef jlong (*DoubleToLong)(jdouble);
+typedef jlong (*FloatToLong)(jfloat);
+typedef jdouble (*LongToDouble)(jlong);
+typedef jfloat (*LongToFloat)(jlong);
+typedef jlong (*LongLongToLong)(jlong, jlong);
+typedef jint (*LongLongToInt)(jlong, jlong);
+typedef jlong (*LongIntToLong)(jlong, jint);
+typedef jfloat (*FloatFloatToFloat)(jfloat, jfloat);
+typedef jdouble (*DoubleDoubleToDouble)(jdouble, jdouble);
+
+static jdouble doubles[OPERANDS];
+static jfloat floats[OPERANDS];
+static jlong longs[OPERANDS];
+static jlong divisors[OPERANDS];
+
+static jlong now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((jlong) ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+static void initializeOperands(void) {
+    Unsigned8 seed = 42;
+    jint i;
+    for (i = 0; i < OPERANDS; i++) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        longs[i] = (jlong) seed;
+        /* Mostly small divisors, as in typical code, and never 0 */
+        divisors[i] = (jlong) (seed >> (33 + (i & 15))) | 1;
+        /* Mostly in range, with a few out of range values and NaNs */
+        doubles[i] = (i % 64 == 63) ? javaArithmetic_TWO_63 * 4 : (i % 64 == 62) ? 0.0 / 0.0 : ((jdouble) (jlong) seed) / 1024;
+        floats[i] = (jfloat) doubles[i];
+    }
+}
+
+/* Consumes the results so that the loops are not optimized away. */
+static volatile Unsigned8 longSink;
+static volatile jdouble doubleSink;
+
+/*
+ * Times a loop of 'iterations' calls, summing the results in a variable of the type of the result so
+ * that no other conversion is timed.
+ */
+#define MEASURE(type, sink, call) do { \
+        type sum = 0; \
+        jint i; \
+        jlong start = now(); \
+        for (i = 0; i < iterations; i++) { \
+            jint j = i & (OPERANDS - 1); \
+            sum += (call); \
+        } \
+        elapsed = now() - start; \
+        sink = sum; \
+    } while (0)
+
+#define MEASURE_LONG(call) MEASURE(Unsigned8, longSink, call)
+#define MEASURE_DOUBLE(call) MEASURE(jdouble, doubleSink, call)
+
+JNIEXPORT jint JNICALL
+Java_com_oracle_max_vm_tests_interactive_MeasureJavaArithmetic_helperCount(JNIEnv *env, jclass c) {
+    return HELPER_COUNT;
+}
+
+/**
+ * Times 'iterations' calls of a helper.
+ *
+ * @param helper the index of the helper in 'helperNames'
+ * @param inlined specifies if the inline version in javaArithmetic.h is timed instead of the VM's entry point
+ * @return the time taken in nanoseconds, or -1 if the VM does not export the helper or there is no inline version
+ */
+JNIEXPORT jlong JNICALL
+Java_com_oracle_max_vm_tests_interactive_MeasureJavaArithmetic_measure(JNIEnv *env, jclass c, jint helper, jboolean inlined, jint iterations) {
+    static int initialized;
+    jlong elapsed = -1;
+    void *entry = NULL;
+    if (helper < 0 || helper >= HELPER_COUNT) {
+        return -1;
+    }
+    if (!initialized) {
+        initializeOperands();
+        initialized = 1;
+    }
+    if (!inlined) {
+        entry = dlsym(RTLD_DEFAULT, helperNames[helper]);
+        if (entry == NULL) {
+            return -1;
+        }
+    }
+    switch (helper) {
+        case 0:
+            if (inlined) MEASURE_LONG(javaArithmetic_d2l(doubles[j])); else MEASURE_LONG(((DoubleToLong) entry)(doubles[j]));
+            break;
+        case 1:
+            if (inlined) MEASURE_LONG(javaArithmetic_f2l(floats[j])); else MEASURE_LONG(((FloatToLong) entry)(floats[j]));
+            break;
+        case 2:
+            if (inlined) MEASURE_DOUBLE(javaArithmetic_l2d(longs[j])); else MEASURE_DOUBLE(((LongToDouble) entry)(longs[j]));
+            break;
+        case 3:
+            if (inlined) MEASURE_DOUBLE(javaArithmetic_l2f(longs[j])); else MEASURE_DOUBLE(((LongToFloat) entry)(longs[j]));
+            break;
+        case 4:
+            if (inlined) MEASURE_LONG(javaArithmetic_ldiv(longs[j], divisors[j])); else MEASURE_LONG(((LongLongToLong) entry)(longs[j], divisors[j]));
+            break;
+        case 5:
+            if (inlined) MEASURE_LONG(javaArithmetic_lrem(longs[j], divisors[j])); else MEASURE_LONG(((LongLongToLong) entry)(longs[j], divisors[j]));
+            break;
+        case 6:
+            if (inlined) MEASURE_LONG(javaArithmetic_ludiv(longs[j], divisors[j])); else MEASURE_LONG(((LongLongToLong) entry)(longs[j], divisors[j]));
+            break;
+        case 7:
+            if (inlined) MEASURE_LONG(javaArithmetic_lurem(longs[j], divisors[j])); else MEASURE_LONG(((LongLongToLong) entry)(longs[j], divisors[j]));
+            break;
+        case 8:
+            if (!inlined) MEASURE_LONG(((LongLongToInt) entry)(longs[j], divisors[j]));
+            break;
+        case 9:
+            if (!inlined) MEASURE_LONG(((LongIntToLong) entry)(longs[j], j & 63));
+            break;
+        case 10:
+            if (!inlined) MEASURE_LONG(((LongLongToLong) entry)(longs[j], divisors[j]));
+            break;
+        case 11:
+            if (inlined) MEASURE_LONG(javaArithmetic_ldiv(longs[j], divisors[j])); else MEASURE_LONG(((LongLongToLong) entry)(longs[j], divisors[j]));
+            break;
+        case 12:
+            if (inlined) MEASURE_LONG(javaArithmetic_lrem(longs[j], divisors[j])); else MEASURE_LONG(((LongLongToLong) entry)(longs[j], divisors[j]));
+            break;
+        case 13:
+            if (inlined) MEASURE_DOUBLE(javaArithmetic_frem(floats[j], 3.5f)); else MEASURE_DOUBLE(((FloatFloatToFloat) entry)(floats[j], 3.5f));
+            break;
+        case 14:
+            if (inlined) MEASURE_DOUBLE(javaArithmetic_drem(doubles[j], 3.5)); else MEASURE_DOUBLE(((DoubleDoubleToDouble) entry)(doubles[j], 3.5));
+            break;
+    }
+    return elapsed;
+}
@@ -0,0 +1,247 @@
+/*
+ * Copyright (c) 2007, 2011, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ */
+/**
+ * Native side of the JNI transition microbenchmarks (see MeasureJniTransitions.java).
+ *
+ * The Java to native transitions are timed by the Java side calling the empty native methods below.
+ * The benchmarks of the JNI functions called from native code run their loops here and return the
+ * total time of the loop in nanoseconds.
+ */
+#include <pthread.h>
+#include <stdlib.h>
+#include <time.h>
+#include "jni.h"
+
+#define LOCAL_FRAME_REFERENCES 16
+
+static jlong now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((jlong) ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+JNIEXPORT void JNICALL
+Java_com_oracle_max_vm_tests_interactive_MeasureJniTransitions_emptyStatic(JNIEnv *env, jclass c) {
+}
+
+JNIEXPORT void JNICALL
+Java_com_oracle_max_vm_tests_interactive_MeasureJniTransitions_emptyInstance(JNIEnv *env, jobject receiver) {
+}
+
+JNIEXPORT jint JNICALL
+Java_com_oracle_max_vm_tests_interactive_MeasureJniTransitions_sum(JNIEnv *env, jclass c, jintArray array) {
+    jint length = (*env)->GetArrayLength(env, array);
+    jint *elements = (jint *) (*env)->GetPrimitiveArrayCritical(env, array, NULL);
+    jint result = 0;
+    jint i;
+    for (i = 0; i < length; i++) {
+        result += elements[i];
+    }
+    (*env)->ReleasePrimitiveArrayCritical(env, array, elements, JNI_ABORT);
+    return result;
+}
+
+/**
+ * The critical entry point of the native method above, used when the VM supports critical natives.
+ */
+JNIEXPORT jint JNICALL
+JavaCritical_com_oracle_max_vm_tests_interactive_MeasureJniTransitions_criticalSum(jint length, jint *elements) {
+    jint result = 0;
+    jint i;
+    for (i = 0; i < length; i++) {
+        result += elements[i];
+    }
+    return result;
+}
+
+JNIEXPORT jint JNICALL
+Java_com_oracle_max_vm_tests_interactive_MeasureJniTransitions_criticalSum(JNIEnv *env, jclass c, jintArray array) {
+    return Java_com_oracle_max_vm_tests_interactive_MeasureJniTransitions_sum(env, c, array);
+}
+
+/**
+ * Times calls of the int method {@code add(int, int)} of {@code receiver} through CallIntMethod (varargs)
+ * or CallIntMethodA (jvalue array).
+ */
+JNIEXPORT jlong JNICALL
+Java_com_oracle_max_vm_tests_interactive_MeasureJniTransitions_callMethod(JNIEnv *env, jclass c, jobject receiver, jboolean varargs, jint iterations) {
+    jclass receiverClass = (*env)->GetObjectClass(env, receiver);
+    jmethodID add = (*env)->GetMethodID(env, receiverClass, "add", "(II)I");
+    if (add == NULL) {
+        return -1;
+    }
+    jvalue arguments[2];
+    jint i;
+    jlong start = now();
+    if (varargs) {
+        for (i = 0; i < iterations; i++) {
+            (*env)->CallIntMethod(env, receiver, add, i, 1);
+        }
+    } else {
+        for (i = 0; i < iterations; i++) {
+            arguments[0].i = i;
+            arguments[1].i = 1;
+            (*env)->CallIntMethodA(env, receiver, add, arguments);
+        }
+    }
+    return now() - start;
+}
+
+/**
+ * Times GetIntField/SetIntField pairs on the int field {@code value} of {@code object}.
+ */
+JNIEXPORT jlong JNICALL
+Java_com_oracle_max_vm_tests_interactive_MeasureJniTransitions_fieldAccess(JNIEnv *env, jclass c, jobject object, jint iterations) {
+    jclass objectClass = (*env)->GetObjectClass(env, object);
+    jfieldID value = (*env)->GetFieldID(env, objectClass, "value", "I");
+    if (value == NULL) {
+        return -1;
+    }
+    jint i;
+    jlong start = now();
+    for (i = 0; i < iterations; i++) {
+        jint v = (*env)->GetIntField(env, object, value);
+        (*env)->SetIntField(env, object, value, v + 1);
+    }
+    return now() - start;
+}
+
+#define ARRAY_ELEMENTS 0
+#define ARRAY_REGION   1
+#define ARRAY_CRITICAL 2
+
+/**
+ * Times reading and writing every element of {@code array} through Get/ReleaseIntArrayElements,
+ * Get/SetIntArrayRegion or Get/ReleasePrimitiveArrayCritical.
+ */
+JNIEXPORT jlong JNICALL
+Java_com_oracle_max_vm_tests_interactive_MeasureJniTransitions_arrayAccess(JNIEnv *env, jclass c, jintArray array, jint mode, jint iterations) {
+    jint length = (*env)->GetArrayLength(env, array);
+    jint *buffer = (jint *) malloc(length * sizeof(jint));
+    if (buffer == NULL) {
+        return -1;
+    }
+    jint i, j;
+    jlong start = now();
+    for (i = 0; i < iterations; i++) {
+        jint *elements;
+        switch (mode) {
+            case ARRAY_ELEMENTS:
+                elements = (*env)->GetIntArrayElements(env, array, NULL);
+                break;
+            case ARRAY_REGION:
+                (*env)->GetIntArrayRegion(env, array, 0, length, buffer);
+                elements = buffer;
+                break;
+            default:
+                elements = (jint *) (*env)->GetPrimitiveArrayCritical(env, array, NULL);
+                break;
+        }
+        for (j = 0; j < length; j++) {
+            elements[j]++;
+        }
+        switch (mode) {
+            case ARRAY_ELEMENTS:
+                (*env)->ReleaseIntArrayElements(env, array, elements, 0);
+                break;
+            case ARRAY_REGION:
+                (*env)->SetIntArrayRegion(env, array, 0, length, buffer);
+                break;
+            default:
+                (*env)->ReleasePrimitiveArrayCritical(env, array, elements, 0);
+                break;
+        }
+    }
+    jlong nanos = now() - start;
+    free(buffer);
+    return nanos;
+}
+
+/**
+ * Times the creation and deletion of local references: either a NewLocalRef/DeleteLocalRef pair or
+ * a local frame in which LOCAL_FRAME_REFERENCES references are created.
+ */
+JNIEXPORT jlong JNICALL
+Java_com_oracle_max_vm_tests_interactive_MeasureJniTransitions_localRefs(JNIEnv *env, jclass c, jobject object, jboolean frames, jint iterations) {
+    jint i, j;
+    jlong start = now();
+    if (frames) {
+        for (i = 0; i < iterations; i++) {
+            if ((*env)->PushLocalFrame(env, LOCAL_FRAME_REFERENCES) != 0) {
+                return -1;
+            }
+            for (j = 0; j < LOCAL_FRAME_REFERENCES; j++) {
+                (*env)->NewLocalRef(env, object);
+            }
+            (*env)->PopLocalFrame(env, NULL);
+        }
+    } else {
+        for (i = 0; i < iterations; i++) {
+            jobject ref = (*env)->NewLocalRef(env, object);
+            (*env)->DeleteLocalRef(env, ref);
+        }
+    }
+    return now() - start;
+}
+
+typedef struct {
+    JavaVM *vm;
+    jint iterations;
+    jlong nanos;
+} AttachBenchmark;
+
+static void *attachDetachLoop(void *arg) {
+    AttachBenchmark *benchmark = (AttachBenchmark *) arg;
+    JavaVMAttachArgs attachArgs;
+    attachArgs.version = JNI_VERSION_1_2;
+    attachArgs.name = "bench";
+    attachArgs.group = NULL;
+    jint i;
+    jlong start = now();
+    for (i = 0; i < benchmark->iterations; i++) {
+        JNIEnv *env;
+        if ((*benchmark->vm)->AttachCurrentThread(benchmark->vm, (void **) &env, &attachArgs) != JNI_OK ||
+            (*benchmark->vm)->DetachCurrentThread(benchmark->vm) != JNI_OK) {
+            benchmark->nanos = -1;
+            return NULL;
+        }
+    }
+    benchmark->nanos = now() - start;
+    return NULL;
+}
+
+/**
+ * Times AttachCurrentThread/DetachCurrentThread cycles of a native thread.
+ */
+JNIEXPORT jlong JNICALL
+Java_com_oracle_max_vm_tests_interactive_MeasureJniTransitions_attachDetach(JNIEnv *env, jclass c, jint iterations) {
+    AttachBenchmark benchmark;
+    pthread_t thread;
+    (*env)->GetJavaVM(env, &benchmark.vm);
+    benchmark.iterations = iterations;
+    benchmark.nanos = -1;
+    if (pthread_create(&thread, NULL, attachDetachLoop, &benchmark) != 0 || pthread_join(thread, NULL) != 0) {
+        return -1;
+    }
+    return benchmark.nanos;
+}
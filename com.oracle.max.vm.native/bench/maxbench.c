@@ -0,0 +1,762 @@
+/*
+ * Copyright (c) 2011, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ */
+/**
+ * A standalone harness for the native microbenchmarks of the substrate that do not need a running VM.
+ * It is built with libbench by the 'bench' target of the native makefile.
+ *
+ * Usage: maxbench [-o <file>] [-image <boot image file>] [-quick] [<benchmark>...]
+ *
+ * Each benchmark times a number of cases in TRIALS trials. The minimum, median and maximum time per
+ * operation are printed and, with '-o', written to a file with one comma separated line per case
+ * (case names therefore contain no commas):
+ *
+ *     benchmark,case,iterations,min_ns,median_ns,max_ns
+ *
+ * The benchmarks that need a VM (thread attach and detach, JNI transitions, array copy, arithmetic helpers)
+ * are driven from Java by the Measure* classes in com.oracle.max.vm.tests.interactive.
+ */
+#include "os.h"
+#include "isa.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <setjmp.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
+
+#if os_LINUX
+#include <sys/ptrace.h>
+#include <sys/uio.h>
+#include <sys/wait.h>
+#endif
+
+#include "word.h"
+#include "jni.h"
+#include "maxine.h"
+#include "image.h"
+#include "relocation.h"
+#include "mutex.h"
+#include "condition.h"
+
+#define TRIALS 5
+
+static FILE *resultsFile;
+static int quick;
+static const char *imageFileName;
+
+static jlong now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((jlong) ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+static int compareLongs(const void *a, const void *b) {
+    jlong x = *(const jlong *) a;
+    jlong y = *(const jlong *) b;
+    return x < y ? -1 : x > y;
+}
+
+/**
+ * The code timed by a benchmark case. It performs 'iterations' operations and returns
+ * the time taken in nanoseconds, or -1 if the case cannot be run.
+ */
+typedef jlong (*Measure)(jlong iterations, void *arg);
+
+/**
+ * Times TRIALS runs of 'iterations' operations of a case (after a warm up run) and reports the results.
+ */
+static void measure(const char *benchmark, const char *name, jlong iterations, Measure run, void *arg) {
+    jlong nanos[TRIALS];
+    int trial;
+
+    if (quick && iterations >= 10) {
+        iterations /= 10;
+    }
+    if (run(iterations > 10 ? iterations / 10 : iterations, arg) < 0) {
+        fprintf(stderr, "%-10s %-40s not available\n", benchmark, name);
+        return;
+    }
+    for (trial = 0; trial < TRIALS; trial++) {
+        nanos[trial] = run(iterations, arg);
+    }
+    qsort(nanos, TRIALS, sizeof(jlong), compareLongs);
+    printf("%-10s %-40s %14.1f ns/op (min %.1f, max %.1f)\n", benchmark, name,
+           nanos[TRIALS / 2] / (double) iterations, nanos[0] / (double) iterations, nanos[TRIALS - 1] / (double) iterations);
+    if (resultsFile != NULL) {
+        fprintf(resultsFile, "%s,%s,%lld,%.1f,%.1f,%.1f\n", benchmark, name, (long long) iterations,
+                nanos[0] / (double) iterations, nanos[TRIALS / 2] / (double) iterations, nanos[TRIALS - 1] / (double) iterations);
+        fflush(resultsFile);
+    }
+}
+
+/*
+ * The shared mutex and log code identifies threads with thread_self(), which the substrate defines in threads.c.
+ */
+void *thread_self() {
+#if os_SOLARIS
+    return (void *) (Address) thr_self();
+#else
+    return (void *) pthread_self();
+#endif
+}
+
+static int processorCount(void) {
+    return (int) sysconf(_SC_NPROCESSORS_ONLN);
+}
+
+/* Relocation ------------------------------------------------------------------------------------------------- */
+
+#define RELOCATION_HEAP_SIZE (64 * 1024 * 1024)
+
+typedef struct {
+    Byte *heap;
+    Byte *relocationData;
+    int relocationDataSize;
+    int maxThreads;
+} RelocationCase;
+
+static jlong measureRelocation(jlong iterations, void *arg) {
+    RelocationCase *r = (RelocationCase *) arg;
+    jlong i;
+    jlong start = now();
+    for (i = 0; i < iterations; i++) {
+        relocation_apply(r->heap, (Address) 0x100000, r->relocationData, r->relocationDataSize, word_BIG_ENDIAN, sizeof(Address), r->maxThreads);
+    }
+    return now() - start;
+}
+
+/**
+ * Relocates a synthetic heap in which every fourth word, on average, is a pointer.
+ */
+static void benchRelocation(void) {
+    RelocationCase r;
+    Size words = RELOCATION_HEAP_SIZE / sizeof(Address);
+    Size i;
+    char name[64];
+
+    r.heap = (Byte *) malloc(RELOCATION_HEAP_SIZE);
+    r.relocationDataSize = (int) (words / 8);
+    r.relocationData = (Byte *) malloc(r.relocationDataSize);
+    if (r.heap == NULL || r.relocationData == NULL) {
+        fprintf(stderr, "could not allocate the relocation heap\n");
+        exit(1);
+    }
+    srand(42);
+    for (i = 0; i < words; i++) {
+        ((Address *) r.heap)[i] = i;
+    }
+    for (i = 0; i < (Size) r.relocationDataSize; i++) {
+        r.relocationData[i] = (Byte) ((1 << (rand() & 7)) | (1 << (rand() & 7)));
+    }
+
+    r.maxThreads = 1;
+    sprintf(name, "%dMB heap on 1 thread", RELOCATION_HEAP_SIZE / (1024 * 1024));
+    measure("relocation", name, 10, measureRelocation, &r);
+    if (processorCount() > 1) {
+        r.maxThreads = processorCount();
+        sprintf(name, "%dMB heap on %d threads", RELOCATION_HEAP_SIZE / (1024 * 1024), r.maxThreads);
+        measure("relocation", name, 10, measureRelocation, &r);
+    }
+
+    free(r.heap);
+    free(r.relocationData);
+}
+
+/* Image load ------------------------------------------------------------------------------------------------- */
+
+#define IMAGE_READ_HEADER  0
+#define IMAGE_MAP          1
+#define IMAGE_RELOCATE     2
+#define IMAGE_UNMAP        3
+#define IMAGE_PHASE_COUNT  4
+
+static const char *imagePhaseNames[IMAGE_PHASE_COUNT] = {
+    "read and check header", "map heap and code", "relocate", "unmap"
+};
+
+/**
+ * Performs the phases of loading the boot image the way image.c does for a mapped, eagerly relocated image,
+ * accumulating the time taken by each phase. The page cache is warm after the first iteration, so this measures
+ * the processing and mapping costs rather than the disk.
+ *
+ * @return false if the image cannot be loaded
+ */
+static int loadImage(jlong *phaseNanos) {
+    struct image_Header header;
+    Size heapOffset, heapAndCodeSize, pageSize;
+    void *relocationData, *heap;
+    jlong start;
+    int fd;
+
+    start = now();
+    fd = open(imageFileName, O_RDONLY);
+    if (fd < 0 || read(fd, &header, sizeof(header)) != sizeof(header) || header.wordSize != sizeof(Address) || header.pageSize <= 0) {
+        if (fd >= 0) {
+            close(fd);
+        }
+        return 0;
+    }
+    if (header.compressionChunkSize != 0) {
+        fprintf(stderr, "compressed images are not supported by the image benchmark\n");
+        close(fd);
+        return 0;
+    }
+    pageSize = (Size) header.pageSize;
+    heapOffset = (sizeof(header) + header.stringDataSize + header.relocationDataSize + pageSize - 1) & ~(pageSize - 1);
+    heapAndCodeSize = (Size) header.heapSize + header.codeSize;
+    relocationData = malloc(header.relocationDataSize);
+    if (relocationData == NULL || pread(fd, relocationData, header.relocationDataSize, sizeof(header) + header.stringDataSize) != header.relocationDataSize) {
+        free(relocationData);
+        close(fd);
+        return 0;
+    }
+    phaseNanos[IMAGE_READ_HEADER] += now() - start;
+
+    start = now();
+    heap = mmap(NULL, heapAndCodeSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, heapOffset);
+    close(fd);
+    if (heap == MAP_FAILED) {
+        free(relocationData);
+        return 0;
+    }
+    phaseNanos[IMAGE_MAP] += now() - start;
+
+    start = now();
+    relocation_apply(heap, (Address) heap - ((Address) header.preferredHeapAddressMB << 20), relocationData, header.relocationDataSize,
+                     header.isBigEndian != 0, header.wordSize, processorCount());
+    phaseNanos[IMAGE_RELOCATE] += now() - start;
+
+    start = now();
+    munmap(heap, heapAndCodeSize);
+    free(relocationData);
+    phaseNanos[IMAGE_UNMAP] += now() - start;
+    return 1;
+}
+
+static jlong measureImagePhase(jlong iterations, void *arg) {
+    int phase = *(int *) arg;
+    jlong phaseNanos[IMAGE_PHASE_COUNT] = {0, 0, 0, 0};
+    jlong i;
+    for (i = 0; i < iterations; i++) {
+        if (!loadImage(phaseNanos)) {
+            return -1;
+        }
+    }
+    return phaseNanos[phase];
+}
+
+static void benchImage(void) {
+    int phase;
+    if (imageFileName == NULL) {
+        fprintf(stderr, "image      skipped: no boot image given with -image\n");
+        return;
+    }
+    for (phase = 0; phase < IMAGE_PHASE_COUNT; phase++) {
+        measure("image", imagePhaseNames[phase], 20, measureImagePhase, &phase);
+    }
+}
+
+/* Threads ---------------------------------------------------------------------------------------------------- */
+
+#define THREAD_STACK_SIZE (1024 * 1024)
+
+static void *emptyThread(void *arg) {
+    return arg;
+}
+
+/**
+ * Creates and joins threads, optionally on a stack mapped with a guard page by the caller
+ * as threadLocalsBlock_create() does for the stacks of VM threads.
+ */
+static jlong measureThreadCreate(jlong iterations, void *arg) {
+    int guarded = *(int *) arg;
+    Size pageSize = (Size) sysconf(_SC_PAGESIZE);
+    jlong i;
+    jlong start = now();
+    for (i = 0; i < iterations; i++) {
+        pthread_attr_t attr;
+        pthread_t thread;
+        void *stack = NULL;
+
+        pthread_attr_init(&attr);
+        if (guarded) {
+            stack = mmap(NULL, THREAD_STACK_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0);
+            if (stack == MAP_FAILED || mprotect(stack, pageSize, PROT_NONE) != 0) {
+                return -1;
+            }
+            pthread_attr_setstack(&attr, stack, THREAD_STACK_SIZE);
+        }
+        if (pthread_create(&thread, &attr, emptyThread, NULL) != 0 || pthread_join(thread, NULL) != 0) {
+            return -1;
+        }
+        pthread_attr_destroy(&attr);
+        if (guarded) {
+            munmap(stack, THREAD_STACK_SIZE);
+        }
+    }
+    return now() - start;
+}
+
+static void benchThread(void) {
+    int guarded = 0;
+    measure("thread", "create and join", 2000, measureThreadCreate, &guarded);
+    guarded = 1;
+    measure("thread", "create and join on guarded stack", 2000, measureThreadCreate, &guarded);
+}
+
+/* TLA lookup ------------------------------------------------------------------------------------------------- */
+
+/*
+ * The two ways in which threadLocalsBlock_current() finds the thread locals block of the current thread
+ * (see threadLocals.c): an initial-exec thread local variable and, on other platforms, a pthread key.
+ */
+#if os_LINUX || os_DARWIN
+static __thread Address currentBlock __attribute__((tls_model("initial-exec")));
+#endif
+static pthread_key_t currentBlockKey;
+
+static jlong measureThreadLocal(jlong iterations, void *arg) {
+#if os_LINUX || os_DARWIN
+    volatile Address sink = 0;
+    jlong i;
+    jlong start = now();
+    currentBlock = (Address) arg;
+    for (i = 0; i < iterations; i++) {
+        sink += currentBlock;
+    }
+    return now() - start;
+#else
+    return -1;
+#endif
+}
+
+static jlong measureThreadKey(jlong iterations, void *arg) {
+    volatile Address sink = 0;
+    jlong i;
+    jlong start = now();
+    for (i = 0; i < iterations; i++) {
+        sink += (Address) pthread_getspecific(currentBlockKey);
+    }
+    return now() - start;
+}
+
+static void benchTLA(void) {
+    static int block;
+    pthread_key_create(&currentBlockKey, NULL);
+    pthread_setspecific(currentBlockKey, &block);
+    measure("tla", "thread local variable", 100000000, measureThreadLocal, &block);
+    measure("tla", "pthread_getspecific", 100000000, measureThreadKey, NULL);
+}
+
+/* Mutex and condition ---------------------------------------------------------------------------------------- */
+
+static jlong measureMutex(jlong iterations, void *arg) {
+    mutex_Struct mutex;
+    jlong i, start;
+
+    mutex_initialize(&mutex);
+    start = now();
+    for (i = 0; i < iterations; i++) {
+        mutex_enter_nolog(&mutex);
+        mutex_exit_nolog(&mutex);
+    }
+    start = now() - start;
+    mutex_dispose(&mutex);
+    return start;
+}
+
+typedef struct {
+    mutex_Struct mutex;
+    condition_Struct condition;
+    jlong turn;
+    jlong iterations;
+} PingPong;
+
+static void *pong(void *arg) {
+    PingPong *p = (PingPong *) arg;
+    jlong i;
+    mutex_enter_nolog(&p->mutex);
+    for (i = 0; i < p->iterations; i++) {
+        while ((p->turn & 1) == 0) {
+            condition_wait(&p->condition, &p->mutex);
+        }
+        p->turn++;
+        condition_notify(&p->condition);
+    }
+    mutex_exit_nolog(&p->mutex);
+    return NULL;
+}
+
+/**
+ * Passes a token back and forth between two threads; each iteration is a round trip.
+ */
+static jlong measureCondition(jlong iterations, void *arg) {
+    PingPong p;
+    pthread_t thread;
+    jlong i, start;
+
+    mutex_initialize(&p.mutex);
+    condition_initialize(&p.condition);
+    p.turn = 0;
+    p.iterations = iterations;
+    if (pthread_create(&thread, NULL, pong, &p) != 0) {
+        return -1;
+    }
+    start = now();
+    mutex_enter_nolog(&p.mutex);
+    for (i = 0; i < iterations; i++) {
+        p.turn++;
+        condition_notify(&p.condition);
+        while ((p.turn & 1) != 0) {
+            condition_wait(&p.condition, &p.mutex);
+        }
+    }
+    mutex_exit_nolog(&p.mutex);
+    start = now() - start;
+    pthread_join(thread, NULL);
+    condition_destroy(&p.condition);
+    mutex_dispose(&p.mutex);
+    return start;
+}
+
+static void benchMutex(void) {
+    measure("mutex", "uncontended enter and exit", 10000000, measureMutex, NULL);
+    measure("mutex", "condition round trip", 50000, measureCondition, NULL);
+}
+
+/* Time ------------------------------------------------------------------------------------------------------- */
+
+static jlong measureNanoTime(jlong iterations, void *arg) {
+    volatile jlong sink = 0;
+    jlong i;
+    jlong start = now();
+    for (i = 0; i < iterations; i++) {
+        sink += native_nanoTime();
+    }
+    return now() - start;
+}
+
+static jlong measureCurrentTimeMillis(jlong iterations, void *arg) {
+    volatile jlong sink = 0;
+    jlong i;
+    jlong start = now();
+    for (i = 0; i < iterations; i++) {
+        sink += native_currentTimeMillis();
+    }
+    return now() - start;
+}
+
+static jlong measureClock(jlong iterations, void *arg) {
+    clockid_t clock = *(clockid_t *) arg;
+    struct timespec ts;
+    jlong i;
+    jlong start = now();
+    for (i = 0; i < iterations; i++) {
+        clock_gettime(clock, &ts);
+    }
+    return now() - start;
+}
+
+static void benchTime(void) {
+    clockid_t clock = CLOCK_MONOTONIC;
+    measure("time", "native_nanoTime", 10000000, measureNanoTime, NULL);
+    measure("time", "native_currentTimeMillis", 10000000, measureCurrentTimeMillis, NULL);
+    measure("time", "clock_gettime(CLOCK_MONOTONIC)", 10000000, measureClock, &clock);
+#if os_LINUX
+    clock = CLOCK_MONOTONIC_COARSE;
+    measure("time", "clock_gettime(CLOCK_MONOTONIC_COARSE)", 10000000, measureClock, &clock);
+#endif
+}
+
+/* Traps ------------------------------------------------------------------------------------------------------ */
+
+/*
+ * A null check is an implicit load from the checked address. Where the length of the faulting load is known,
+ * the handler resumes after it by advancing the instruction pointer in the signal context, as the trap stub
+ * of the VM resumes at a handler address. Elsewhere the handler returns with siglongjmp.
+ */
+#if os_LINUX && (isa_AMD64 || isa_AARCH64)
+#define TRAP_RESUMES_IN_CONTEXT 1
+#else
+#define TRAP_RESUMES_IN_CONTEXT 0
+#endif
+
+#if !TRAP_RESUMES_IN_CONTEXT
+static sigjmp_buf trapResume;
+#endif
+
+static void trapHandler(int signal, siginfo_t *info, void *context) {
+#if TRAP_RESUMES_IN_CONTEXT
+    ucontext_t *ucontext = (ucontext_t *) context;
+#if isa_AMD64
+    ucontext->uc_mcontext.gregs[REG_RIP] += 3;
+#else
+    ucontext->uc_mcontext.pc += 4;
+#endif
+#else
+    siglongjmp(trapResume, 1);
+#endif
+}
+
+static void __attribute__((noinline)) nullCheck(Address address) {
+#if TRAP_RESUMES_IN_CONTEXT && isa_AMD64
+    __asm__ __volatile__("movq (%%rax), %%rax" : : "a" (address) : "memory");
+#elif TRAP_RESUMES_IN_CONTEXT && isa_AARCH64
+    register Address x0 __asm__("x0") = address;
+    __asm__ __volatile__("ldr x0, [x0]" : "+r" (x0) : : "memory");
+#else
+    if (sigsetjmp(trapResume, 0) == 0) {
+        *(volatile jint *) address;
+    }
+#endif
+}
+
+static jlong measureTrap(jlong iterations, void *arg) {
+    volatile Address address = 0;
+    jlong i;
+    jlong start = now();
+    for (i = 0; i < iterations; i++) {
+        nullCheck(address);
+    }
+    return now() - start;
+}
+
+static void benchTrap(void) {
+    struct sigaction action, oldAction;
+    stack_t signalStack;
+
+    signalStack.ss_sp = malloc(SIGSTKSZ * 4);
+    signalStack.ss_size = SIGSTKSZ * 4;
+    signalStack.ss_flags = 0;
+    sigaltstack(&signalStack, NULL);
+
+    /* The same flags as trap.c uses for the VM's trap handlers */
+    memset(&action, 0, sizeof(action));
+    action.sa_sigaction = trapHandler;
+    action.sa_flags = SA_SIGINFO | SA_RESTART | SA_ONSTACK;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGSEGV, &action, &oldAction);
+#if os_DARWIN
+    sigaction(SIGBUS, &action, NULL);
+#endif
+    measure("trap", "null check round trip", 200000, measureTrap, NULL);
+    sigaction(SIGSEGV, &oldAction, NULL);
+}
+
+/* Tele reads ------------------------------------------------------------------------------------------------- */
+
+#if os_LINUX
+
+#define TELE_TARGET_SIZE (1024 * 1024)
+
+typedef struct {
+    pid_t pid;
+    int memFd;
+    Byte *target;
+    Byte *buffer;
+    Size size;
+} TeleCase;
+
+static jlong measurePeek(jlong iterations, void *arg) {
+    TeleCase *t = (TeleCase *) arg;
+    jlong i;
+    jlong start = now();
+    for (i = 0; i < iterations; i++) {
+        Size n;
+        for (n = 0; n < t->size; n += sizeof(long)) {
+            errno = 0;
+            *(long *) (t->buffer + n) = ptrace(PTRACE_PEEKDATA, t->pid, t->target + n, NULL);
+            if (errno != 0) {
+                return -1;
+            }
+        }
+    }
+    return now() - start;
+}
+
+static jlong measureProcMem(jlong iterations, void *arg) {
+    TeleCase *t = (TeleCase *) arg;
+    jlong i;
+    jlong start = now();
+    for (i = 0; i < iterations; i++) {
+        if (pread(t->memFd, t->buffer, t->size, (off_t) (Address) t->target) != (ssize_t) t->size) {
+            return -1;
+        }
+    }
+    return now() - start;
+}
+
+static jlong measureProcessVMRead(jlong iterations, void *arg) {
+    TeleCase *t = (TeleCase *) arg;
+    struct iovec local, remote;
+    jlong i;
+    jlong start = now();
+    local.iov_base = t->buffer;
+    local.iov_len = t->size;
+    remote.iov_base = t->target;
+    remote.iov_len = t->size;
+    for (i = 0; i < iterations; i++) {
+        if (process_vm_readv(t->pid, &local, 1, &remote, 1, 0) != (ssize_t) t->size) {
+            return -1;
+        }
+    }
+    return now() - start;
+}
+
+/**
+ * Reads the memory of a stopped, traced child process with the mechanisms used by the Linux tele
+ * library: word-wise PTRACE_PEEKDATA, pread of /proc/<pid>/mem and process_vm_readv.
+ */
+static void benchTele(void) {
+    static const Size sizes[] = {8, 4096, TELE_TARGET_SIZE};
+    TeleCase t;
+    char path[64], name[64];
+    unsigned int i;
+    int status;
+
+    t.target = (Byte *) malloc(TELE_TARGET_SIZE);
+    t.buffer = (Byte *) malloc(TELE_TARGET_SIZE);
+    memset(t.target, 0x5a, TELE_TARGET_SIZE);
+    t.pid = fork();
+    if (t.pid == 0) {
+        ptrace(PTRACE_TRACEME, 0, NULL, NULL);
+        raise(SIGSTOP);
+        _exit(0);
+    }
+    if (t.pid < 0 || waitpid(t.pid, &status, 0) != t.pid || !WIFSTOPPED(status)) {
+        fprintf(stderr, "tele       skipped: could not create a traced process\n");
+        return;
+    }
+    sprintf(path, "/proc/%d/mem", (int) t.pid);
+    t.memFd = open(path, O_RDONLY);
+
+    for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        t.size = sizes[i];
+        if (t.size <= 4096) {
+            sprintf(name, "ptrace peek %lu bytes", (unsigned long) t.size);
+            measure("tele", name, t.size == 8 ? 100000 : 1000, measurePeek, &t);
+        }
+        if (t.memFd >= 0) {
+            sprintf(name, "/proc/pid/mem %lu bytes", (unsigned long) t.size);
+            measure("tele", name, t.size == TELE_TARGET_SIZE ? 1000 : 100000, measureProcMem, &t);
+        }
+        sprintf(name, "process_vm_readv %lu bytes", (unsigned long) t.size);
+        measure("tele", name, t.size == TELE_TARGET_SIZE ? 1000 : 100000, measureProcessVMRead, &t);
+    }
+
+    if (t.memFd >= 0) {
+        close(t.memFd);
+    }
+    kill(t.pid, SIGKILL);
+    waitpid(t.pid, &status, 0);
+    free(t.target);
+    free(t.buffer);
+}
+
+#else
+
+static void benchTele(void) {
+    fprintf(stderr, "tele       skipped: only implemented on Linux\n");
+}
+
+#endif
+
+/* Driver ----------------------------------------------------------------------------------------------------- */
+
+typedef struct {
+    const char *name;
+    void (*run)(void);
+} Benchmark;
+
+static const Benchmark benchmarks[] = {
+    {"relocation", benchRelocation},
+    {"image", benchImage},
+    {"thread", benchThread},
+    {"tla", benchTLA},
+    {"mutex", benchMutex},
+    {"time", benchTime},
+    {"trap", benchTrap},
+    {"tele", benchTele},
+};
+
+#define NUMBER_OF_BENCHMARKS ((int) (sizeof(benchmarks) / sizeof(benchmarks[0])))
+
+static void usage(void) {
+    int i;
+    fprintf(stderr, "Usage: maxbench [-o <file>] [-image <boot image file>] [-quick] [<benchmark>...]\n");
+    fprintf(stderr, "Benchmarks:");
+    for (i = 0; i < NUMBER_OF_BENCHMARKS; i++) {
+        fprintf(stderr, " %s", benchmarks[i].name);
+    }
+    fprintf(stderr, "\n");
+    exit(1);
+}
+
+int main(int argc, char *argv[]) {
+    int selected[NUMBER_OF_BENCHMARKS];
+    int anySelected = 0;
+    int i, b;
+
+    memset(selected, 0, sizeof(selected));
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            resultsFile = fopen(argv[++i], "w");
+            if (resultsFile == NULL) {
+                fprintf(stderr, "could not open %s: %s\n", argv[i], strerror(errno));
+                return 1;
+            }
+            fprintf(resultsFile, "benchmark,case,iterations,min_ns,median_ns,max_ns\n");
+        } else if (strcmp(argv[i], "-image") == 0 && i + 1 < argc) {
+            imageFileName = argv[++i];
+        } else if (strcmp(argv[i], "-quick") == 0) {
+            quick = 1;
+        } else {
+            for (b = 0; b < NUMBER_OF_BENCHMARKS; b++) {
+                if (strcmp(argv[i], benchmarks[b].name) == 0) {
+                    selected[b] = 1;
+                    anySelected = 1;
+                    break;
+                }
+            }
+            if (b == NUMBER_OF_BENCHMARKS) {
+                usage();
+            }
+        }
+    }
+    for (b = 0; b < NUMBER_OF_BENCHMARKS; b++) {
+        if (!anySelected || selected[b]) {
+            benchmarks[b].run();
+        }
+    }
+    if (resultsFile != NULL) {
+        fclose(resultsFile);
+    }
+    return 0;
+}
@@ -0,0 +1,231 @@
+/*
+ * Copyright (c) 2007, 2011, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ */
+/**
+ * Native side of the thread lifecycle microbenchmarks (see MeasureThreadLifecycle.java).
+ *
+ * The benchmarks time the substrate paths that create, attach, detach and destroy threads:
+ * AttachCurrentThread/DetachCurrentThread on an existing native thread (thread_attachCurrent(),
+ * threadLocalsBlock_create() including guard page setup, thread_detachCurrent() and
+ * threadLocalsBlock_destroy()) and the complete lifecycle of a native thread that attaches to the VM.
+ * The creation of VM threads is timed by the Java side using the event counters below.
+ *
+ * On Linux, the number of system calls, page faults and context switches incurred by a benchmark
+ * are counted with perf events. The counters are inherited by threads created while they are
+ * enabled so that the events of the benchmarked threads are included in the totals.
+ */
+#include "os.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "jni.h"
+
+#if os_LINUX
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+#define EVENT_SYSCALLS          0
+#define EVENT_PAGE_FAULTS       1
+#define EVENT_CONTEXT_SWITCHES  2
+#define NUMBER_OF_EVENTS        3
+
+static int eventCounters[NUMBER_OF_EVENTS] = {-1, -1, -1};
+
+static jlong now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((jlong) ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+#if os_LINUX
+/**
+ * Gets the id of the tracepoint hit on entry to every system call, or -1 if tracing is not accessible.
+ */
+static long syscallTracepointId(void) {
+    static const char *paths[] = {
+        "/sys/kernel/tracing/events/raw_syscalls/sys_enter/id",
+        "/sys/kernel/debug/tracing/events/raw_syscalls/sys_enter/id"
+    };
+    unsigned int i;
+    for (i = 0; i < sizeof(paths) / sizeof(paths[0]); i++) {
+        FILE *file = fopen(paths[i], "r");
+        if (file != NULL) {
+            long id = -1;
+            if (fscanf(file, "%ld", &id) != 1) {
+                id = -1;
+            }
+            fclose(file);
+            return id;
+        }
+    }
+    return -1;
+}
+
+static int openEventCounter(__u32 type, __u64 config) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.inherit = 1;
+    int fd = (int) syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    if (fd < 0 && type == PERF_TYPE_SOFTWARE) {
+        /* Unprivileged processes may only be allowed to count user space events. */
+        attr.exclude_kernel = 1;
+        fd = (int) syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+    return fd;
+}
+#endif
+
+/**
+ * Starts counting the events incurred by the current thread and the threads it subsequently creates.
+ */
+JNIEXPORT void JNICALL
+Java_com_oracle_max_vm_tests_interactive_MeasureThreadLifecycle_beginEvents(JNIEnv *env, jclass c) {
+#if os_LINUX
+    long syscallTracepoint = syscallTracepointId();
+    eventCounters[EVENT_SYSCALLS] = syscallTracepoint < 0 ? -1 : openEventCounter(PERF_TYPE_TRACEPOINT, syscallTracepoint);
+    eventCounters[EVENT_PAGE_FAULTS] = openEventCounter(PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS);
+    eventCounters[EVENT_CONTEXT_SWITCHES] = openEventCounter(PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES);
+#endif
+}
+
+/**
+ * Stops counting events and stores the totals in {@code events} (-1 for an event that could not be counted).
+ */
+JNIEXPORT void JNICALL
+Java_com_oracle_max_vm_tests_interactive_MeasureThreadLifecycle_endEvents(JNIEnv *env, jclass c, jlongArray events) {
+    jlong counts[NUMBER_OF_EVENTS];
+    int i;
+    for (i = 0; i < NUMBER_OF_EVENTS; i++) {
+        counts[i] = -1;
+#if os_LINUX
+        if (eventCounters[i] >= 0) {
+            long long count;
+            if (read(eventCounters[i], &count, sizeof(count)) == sizeof(count)) {
+                counts[i] = count;
+            }
+            close(eventCounters[i]);
+        }
+#endif
+        eventCounters[i] = -1;
+    }
+    (*env)->SetLongArrayRegion(env, events, 0, NUMBER_OF_EVENTS, counts);
+}
+
+typedef struct {
+    JavaVM *vm;
+    jint iterations;
+    jlong *nanos;
+    jint failures;
+} Benchmark;
+
+static jboolean attachAndDetach(JavaVM *vm) {
+    JNIEnv *env;
+    JavaVMAttachArgs attachArgs;
+    attachArgs.version = JNI_VERSION_1_2;
+    attachArgs.name = "bench";
+    attachArgs.group = NULL;
+    if ((*vm)->AttachCurrentThread(vm, (void **) &env, &attachArgs) != JNI_OK) {
+        return JNI_FALSE;
+    }
+    return (*vm)->DetachCurrentThread(vm) == JNI_OK;
+}
+
+static void *attachDetachLoop(void *arg) {
+    Benchmark *benchmark = (Benchmark *) arg;
+    jint i;
+    for (i = 0; i < benchmark->iterations; i++) {
+        jlong start = now();
+        if (!attachAndDetach(benchmark->vm)) {
+            benchmark->failures++;
+        }
+        benchmark->nanos[i] = now() - start;
+    }
+    return NULL;
+}
+
+static void *attachDetachOnce(void *arg) {
+    Benchmark *benchmark = (Benchmark *) arg;
+    if (!attachAndDetach(benchmark->vm)) {
+        benchmark->failures++;
+    }
+    return NULL;
+}
+
+static jint runBenchmark(JNIEnv *env, jint iterations, jlongArray nanos, jboolean threadPerIteration) {
+    Benchmark benchmark;
+    pthread_t thread;
+    jint i;
+
+    (*env)->GetJavaVM(env, &benchmark.vm);
+    benchmark.iterations = iterations;
+    benchmark.failures = 0;
+    benchmark.nanos = (jlong *) calloc(iterations, sizeof(jlong));
+    if (benchmark.nanos == NULL) {
+        return -1;
+    }
+
+    if (threadPerIteration) {
+        for (i = 0; i < iterations; i++) {
+            jlong start = now();
+            if (pthread_create(&thread, NULL, attachDetachOnce, &benchmark) != 0 || pthread_join(thread, NULL) != 0) {
+                benchmark.failures++;
+            }
+            benchmark.nanos[i] = now() - start;
+        }
+    } else {
+        if (pthread_create(&thread, NULL, attachDetachLoop, &benchmark) != 0 || pthread_join(thread, NULL) != 0) {
+            benchmark.failures = iterations;
+        }
+    }
+
+    (*env)->SetLongArrayRegion(env, nanos, 0, iterations, benchmark.nanos);
+    free(benchmark.nanos);
+    return benchmark.failures;
+}
+
+/**
+ * Times {@code iterations} AttachCurrentThread/DetachCurrentThread pairs performed by a single native thread.
+ *
+ * @return the number of iterations that failed to attach or detach
+ */
+JNIEXPORT jint JNICALL
+Java_com_oracle_max_vm_tests_interactive_MeasureThreadLifecycle_attachDetach(JNIEnv *env, jclass c, jint iterations, jlongArray nanos) {
+    return runBenchmark(env, iterations, nanos, JNI_FALSE);
+}
+
+/**
+ * Times {@code iterations} lifecycles of a native thread that is created, attaches, detaches and is joined.
+ *
+ * @return the number of iterations that failed
+ */
+JNIEXPORT jint JNICALL
+Java_com_oracle_max_vm_tests_interactive_MeasureThreadLifecycle_attachedThread(JNIEnv *env, jclass c, jint iterations, jlongArray nanos) {
+    return runBenchmark(env, iterations, nanos, JNI_TRUE);
+}
@@ -24,7 +24,7 @@ PROJECT = ../../..
 
 LIB = hosted
 
-SOURCES = c.c log.c platform.c relocation.c dataio.c mutex.c
+SOURCES = c.c log.c platform.c imageWriter.c relocation.c dataio.c mutex.c cpuFeatures.c cacheTopology.c
 CXXSOURCES=
 SOURCE_DIRS = platform hosted share substrate
 
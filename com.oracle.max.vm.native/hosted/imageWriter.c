@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2011, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ */
+#include "os.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "log.h"
+#include "word.h"
+#include "jni.h"
+#include "relocation.h"
+
+/*
+ * Native support for BootImage.write(File): the image file is created at its full size and mapped, the
+ * Java builder writes the sections straight into the mapping, the heap and code are relocated in place
+ * by the parallel relocation in share/relocation.c, and the file is synchronized with a single msync.
+ */
+
+JNIEXPORT jobject JNICALL
+Java_com_sun_max_vm_hosted_BootImage_nativeMapImageFile(JNIEnv *env, jclass c, jstring path, jint size) {
+    const char *fileName = (*env)->GetStringUTFChars(env, path, NULL);
+    void *image;
+    int fd;
+
+    if (fileName == NULL) {
+        return NULL;
+    }
+    fd = open(fileName, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        log_println("could not open boot image file %s: %s", fileName, strerror(errno));
+        (*env)->ReleaseStringUTFChars(env, path, fileName);
+        return NULL;
+    }
+    if (ftruncate(fd, size) != 0) {
+        log_println("could not extend boot image file %s to %d bytes: %s", fileName, size, strerror(errno));
+        close(fd);
+        (*env)->ReleaseStringUTFChars(env, path, fileName);
+        return NULL;
+    }
+    image = mmap(NULL, (size_t) size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (image == MAP_FAILED) {
+        log_println("could not map boot image file %s: %s", fileName, strerror(errno));
+        close(fd);
+        (*env)->ReleaseStringUTFChars(env, path, fileName);
+        return NULL;
+    }
+    /* The mapping keeps the file open. */
+    close(fd);
+    (*env)->ReleaseStringUTFChars(env, path, fileName);
+    return (*env)->NewDirectByteBuffer(env, image, (jlong) size);
+}
+
+JNIEXPORT void JNICALL
+Java_com_sun_max_vm_hosted_BootImage_nativeRelocateMappedImage(JNIEnv *env, jclass c, jobject buffer,
+                                                                  jint relocationDataOffset, jint relocationDataSize, jint heapOffset,
+                                                                  jlong relocatedHeap, jint isBigEndian, jint wordSize) {
+    Byte *image = (Byte *) (*env)->GetDirectBufferAddress(env, buffer);
+    relocation_apply(image + heapOffset, (Address) relocatedHeap, image + relocationDataOffset, relocationDataSize,
+                     isBigEndian, wordSize, (int) sysconf(_SC_NPROCESSORS_ONLN));
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_sun_max_vm_hosted_BootImage_nativeUnmapImageFile(JNIEnv *env, jclass c, jobject buffer) {
+    void *image = (*env)->GetDirectBufferAddress(env, buffer);
+    size_t size = (size_t) (*env)->GetDirectBufferCapacity(env, buffer);
+    jboolean result = JNI_TRUE;
+
+    if (msync(image, size, MS_SYNC) != 0) {
+        log_println("could not synchronize boot image file: %s", strerror(errno));
+        result = JNI_FALSE;
+    }
+    if (munmap(image, size) != 0) {
+        log_println("could not unmap boot image file: %s", strerror(errno));
+        result = JNI_FALSE;
+    }
+    return result;
+}
@@ -22,6 +22,8 @@
 #include "word.h"
 #include "isa.h"
 #include "jni.h"
+#include "cpuFeatures.h"
+#include "cacheTopology.h"
 #include <string.h>
 #include <stdlib.h>
 
@@ -60,21 +62,20 @@ Java_com_sun_max_platform_Platform_nativeGetPageSize(JNIEnv *env, jclass c) {
 
 JNIEXPORT jint JNICALL
 Java_com_sun_max_platform_Platform_nativeHasIDiv(JNIEnv *env, jclass c) {
-#ifdef arm
-    FILE *cpuinfo = fopen("/proc/cpuinfo", "rb");
-    char *arg = 0;
-    size_t size = 0;
-    while(getdelim(&arg, &size, 0, cpuinfo) != -1) {
-        if (strstr(arg, "idiva") != 0) {
-           return (jint) 1;
-        }
+    return cpuFeatures_has(IDIV) ? 1 : 0;
+}
+
+JNIEXPORT jlong JNICALL
+Java_com_sun_max_platform_CPUFeature_nativeGetCPUFeatures(JNIEnv *env, jclass c) {
+    return cpuFeatures_get();
+}
+
+JNIEXPORT jlong JNICALL
+Java_com_sun_max_platform_CacheTopology_nativeGetCacheTopology(JNIEnv *env, jclass c, jint index) {
+    if (index < 0 || index >= CACHE_TOPOLOGY_COUNT) {
+        return 0;
     }
-    free(arg);
-    fclose(cpuinfo);
-#else
-    return (jint) 1;
-#endif
-    return (jint) 0;
+    return cacheTopology_get()[index];
 }
 
 /*
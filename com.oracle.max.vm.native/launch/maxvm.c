@@ -29,6 +29,161 @@
 
 typedef int (*MaxineFunction)(int argc, char *argv[], char *executablePath);
 
+#if os_LINUX || os_DARWIN
+#include <errno.h>
+#include <limits.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include "zygote.h"
+
+/*
+ * The process id of the VM forked by the zygote, to which the signals received by the launcher are forwarded.
+ */
+static pid_t zygoteChild;
+
+static void forwardSignal(int signal) {
+    if (zygoteChild > 0) {
+        kill(zygoteChild, signal);
+    }
+}
+
+static int readInt(int fd, int *value) {
+    char *p = (char *) value;
+    size_t remaining = sizeof(*value);
+    while (remaining > 0) {
+        ssize_t n = read(fd, p, remaining);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return 0;
+        }
+        p += n;
+        remaining -= n;
+    }
+    return 1;
+}
+
+static int writeFully(int fd, const void *buffer, size_t length) {
+    const char *p = (const char *) buffer;
+    while (length > 0) {
+        ssize_t n = write(fd, p, length);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return 0;
+        }
+        p += n;
+        length -= n;
+    }
+    return 1;
+}
+
+/**
+ * Runs a VM forked by the zygote listening on a given socket (see zygote.h) with the arguments of
+ * the launcher other than the '-XX:ZygoteConnect' option at index 'connectIndex'.
+ *
+ * @return the exit code of the VM
+ */
+static int runInZygote(const char *path, int argc, char *argv[], int connectIndex) {
+    struct sockaddr_un address;
+    char directory[PATH_MAX];
+    int i;
+
+    if (strlen(path) >= sizeof(address.sun_path)) {
+        fprintf(stderr, "zygote socket path is too long: %s\n", path);
+        return 1;
+    }
+    if (getcwd(directory, sizeof(directory)) == NULL) {
+        fprintf(stderr, "could not get the working directory: %s\n", strerror(errno));
+        return 1;
+    }
+    int length = strlen(directory) + 1;
+    for (i = 1; i < argc; i++) {
+        if (i != connectIndex) {
+            length += strlen(argv[i]) + 1;
+        }
+    }
+    if (length > ZYGOTE_MAX_REQUEST) {
+        fprintf(stderr, "the arguments are too long for a zygote request\n");
+        return 1;
+    }
+    char *payload = malloc(length);
+    char *p = payload;
+    strcpy(p, directory);
+    p += strlen(directory) + 1;
+    for (i = 1; i < argc; i++) {
+        if (i != connectIndex) {
+            strcpy(p, argv[i]);
+            p += strlen(argv[i]) + 1;
+        }
+    }
+
+    int connection = socket(AF_UNIX, SOCK_STREAM, 0);
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, path);
+    if (connection < 0 || connect(connection, (struct sockaddr *) &address, sizeof(address)) != 0) {
+        fprintf(stderr, "could not connect to the zygote at %s: %s\n", path, strerror(errno));
+        return 1;
+    }
+
+    /* The standard file descriptors are passed with the first byte of the request. */
+    int fds[3] = {STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO};
+    char byte = 0;
+    struct iovec iov;
+    union {
+        struct cmsghdr header;
+        char buffer[CMSG_SPACE(sizeof(fds))];
+    } control;
+    struct msghdr message;
+    iov.iov_base = &byte;
+    iov.iov_len = 1;
+    memset(&message, 0, sizeof(message));
+    memset(&control, 0, sizeof(control));
+    message.msg_iov = &iov;
+    message.msg_iovlen = 1;
+    message.msg_control = control.buffer;
+    message.msg_controllen = sizeof(control.buffer);
+    struct cmsghdr *header = CMSG_FIRSTHDR(&message);
+    header->cmsg_level = SOL_SOCKET;
+    header->cmsg_type = SCM_RIGHTS;
+    header->cmsg_len = CMSG_LEN(sizeof(fds));
+    memcpy(CMSG_DATA(header), fds, sizeof(fds));
+    if (sendmsg(connection, &message, 0) != 1 || !writeFully(connection, &length, sizeof(length)) || !writeFully(connection, payload, length)) {
+        fprintf(stderr, "could not send the request to the zygote: %s\n", strerror(errno));
+        return 1;
+    }
+    free(payload);
+
+    int pid;
+    if (!readInt(connection, &pid) || pid < 0) {
+        fprintf(stderr, "the zygote could not start a VM\n");
+        return 1;
+    }
+    zygoteChild = pid;
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = forwardSignal;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    sigaction(SIGHUP, &action, NULL);
+    sigaction(SIGQUIT, &action, NULL);
+
+    int exitCode;
+    if (!readInt(connection, &exitCode)) {
+        fprintf(stderr, "lost the connection to the zygote\n");
+        return 1;
+    }
+    return exitCode;
+}
+#endif
+
 #if os_DARWIN
 #include <unistd.h>
 #include <libgen.h>
@@ -69,6 +224,14 @@ const CFNullRef initializeCoreFoundationOnMainThread;
  * A simple launcher.
  */
 int main(int argc, char *argv[] MAIN_EXTRA_ARGS) {
+#if os_LINUX || os_DARWIN
+    int i;
+    for (i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "-XX:ZygoteConnect=", 18) == 0) {
+            return runInZygote(argv[i] + 18, argc, argv, i);
+        }
+    }
+#endif
     char *programPath = PROG_PATH;
 	char *p = programPath;
     int prefixLength = 0;
@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2011, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ */
+#ifndef __javaArithmetic_h__
+#define __javaArithmetic_h__ 1
+
+#include <math.h>
+#include "isa.h"
+#include "jni.h"
+
+/*
+ * The long and floating point conversions and long divisions of the Java language, as needed by the
+ * runtime helpers of the compilers for ISAs without (complete) instructions for them (see d2long() et al.
+ * in maxine.c and snippet.c). They are defined here so that C callers inline them. Where one instruction
+ * has the semantics of the Java conversion (AArch64) or almost has it (AMD64, RISC-V), that instruction
+ * is used, otherwise the common in-range case is tested first with a single comparison.
+ *
+ * Only native callers benefit from the inlining: compiled Java code still reaches the exported helpers
+ * through the generic runtime call stubs of the compilers, which save the volatile state. There are no
+ * dedicated assembly stubs and the compilers do not inline these operations.
+ */
+
+#define javaArithmetic_LONG_MIN ((jlong) (-9223372036854775807LL - 1))
+#define javaArithmetic_LONG_MAX ((jlong) 9223372036854775807LL)
+
+/* 2^63 as a double and as a float: the first value that does not fit a jlong. */
+#define javaArithmetic_TWO_63 9223372036854775808.0
+
+/**
+ * Converts a double to a long as the Java d2l instruction does: NaN converts to 0 and values out of
+ * range saturate.
+ */
+static inline jlong javaArithmetic_d2l(jdouble x) {
+#if isa_AARCH64
+    jlong result;
+    /* FCVTZS saturates and converts NaN to 0. */
+    __asm__ ("fcvtzs %x0, %d1" : "=r" (result) : "w" (x));
+    return result;
+#elif isa_AMD64
+    jlong result;
+    /* CVTTSD2SI returns the 'integer indefinite' value Long.MIN_VALUE for NaN and values out of range. */
+    __asm__ ("cvttsd2siq %1, %0" : "=r" (result) : "x" (x));
+    if (result == javaArithmetic_LONG_MIN && !(x < 0.0)) {
+        return x != x ? 0 : javaArithmetic_LONG_MAX;
+    }
+    return result;
+#elif isa_RISCV64
+    jlong result;
+    /* FCVT.L.D saturates but converts NaN to Long.MAX_VALUE. */
+    __asm__ ("fcvt.l.d %0, %1, rtz" : "=r" (result) : "f" (x));
+    return x != x ? 0 : result;
+#else
+    if (x >= -javaArithmetic_TWO_63 && x < javaArithmetic_TWO_63) {
+        return (jlong) x;
+    }
+    if (x != x) {
+        return 0;
+    }
+    return x < 0.0 ? javaArithmetic_LONG_MIN : javaArithmetic_LONG_MAX;
+#endif
+}
+
+/**
+ * Converts a float to a long as the Java f2l instruction does.
+ */
+static inline jlong javaArithmetic_f2l(jfloat x) {
+#if isa_AARCH64
+    jlong result;
+    __asm__ ("fcvtzs %x0, %s1" : "=r" (result) : "w" (x));
+    return result;
+#elif isa_AMD64
+    jlong result;
+    __asm__ ("cvttss2siq %1, %0" : "=r" (result) : "x" (x));
+    if (result == javaArithmetic_LONG_MIN && !(x < 0.0f)) {
+        return x != x ? 0 : javaArithmetic_LONG_MAX;
+    }
+    return result;
+#elif isa_RISCV64
+    jlong result;
+    __asm__ ("fcvt.l.s %0, %1, rtz" : "=r" (result) : "f" (x));
+    return x != x ? 0 : result;
+#else
+    if (x >= (jfloat) -javaArithmetic_TWO_63 && x < (jfloat) javaArithmetic_TWO_63) {
+        return (jlong) x;
+    }
+    if (x != x) {
+        return 0;
+    }
+    return x < 0.0f ? javaArithmetic_LONG_MIN : javaArithmetic_LONG_MAX;
+#endif
+}
+
+static inline jdouble javaArithmetic_l2d(jlong x) {
+    return (jdouble) x;
+}
+
+static inline jfloat javaArithmetic_l2f(jlong x) {
+    return (jfloat) x;
+}
+
+/*
+ * The divisions return 0 for a zero divisor: the compiled code tests for it and throws the
+ * ArithmeticException before calling them. Long.MIN_VALUE / -1 overflows in C (and traps on AMD64),
+ * so a divisor of -1 is handled as a negation.
+ */
+
+static inline jlong javaArithmetic_ldiv(jlong x, jlong y) {
+    if (y == 0) {
+        return 0;
+    }
+    if (y == -1) {
+        return (jlong) (0 - (Unsigned8) x);
+    }
+    return x / y;
+}
+
+static inline jlong javaArithmetic_lrem(jlong x, jlong y) {
+    if (y == 0 || y == -1) {
+        return 0;
+    }
+    return x % y;
+}
+
+static inline Unsigned8 javaArithmetic_ludiv(Unsigned8 x, Unsigned8 y) {
+    return y == 0 ? 0 : x / y;
+}
+
+static inline Unsigned8 javaArithmetic_lurem(Unsigned8 x, Unsigned8 y) {
+    return y == 0 ? 0 : x % y;
+}
+
+static inline jfloat javaArithmetic_frem(jfloat x, jfloat y) {
+    /* The remainder is exact, so it need not be computed in double precision. */
+    return fmodf(x, y);
+}
+
+static inline jdouble javaArithmetic_drem(jdouble x, jdouble y) {
+    return fmod(x, y);
+}
+
+#endif /*__javaArithmetic_h__*/
@@ -48,6 +48,10 @@ ifeq ($(LIB), javatest)
     TARGET := SUBSTRATE
 endif
 
+ifeq ($(LIB), bench)
+    TARGET := SUBSTRATE
+endif
+
 ifneq ($(MAIN),)
     TARGET := LAUNCH
 endif
@@ -268,6 +272,10 @@ ifeq ($(OS),linux)
     ifeq ($(ISA),amd64)
         LINK_LIB_POSTFIX += -lnuma
     endif
+    ifeq ($(LIB),jvm)
+        # zlib is used to decompress compressed boot images (see image.c) and to compress heap dumps (see heapDump.c)
+        LINK_LIB_POSTFIX += -lz
+    endif
     LIB_PREFIX = lib
     LIB_SUFFIX = .so
 endif
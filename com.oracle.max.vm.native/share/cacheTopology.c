@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) 2011, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "os.h"
+#include "isa.h"
+#include "cacheTopology.h"
+
+#if os_DARWIN
+#include <sys/types.h>
+#include <sys/sysctl.h>
+#endif
+
+static jlong topology[CACHE_TOPOLOGY_COUNT];
+static volatile int probed;
+
+#if os_LINUX
+
+static void setIfUnknown(int index, long value) {
+    if (topology[index] == 0 && value > 0) {
+        topology[index] = value;
+    }
+}
+
+/**
+ * Reads the first line of a file of a cache description.
+ */
+static int readCacheFile(int index, const char *name, char *buffer, int length) {
+    char path[128];
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/%s", index, name);
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        return 0;
+    }
+    char *line = fgets(buffer, length, file);
+    fclose(file);
+    if (line == NULL) {
+        return 0;
+    }
+    buffer[strcspn(buffer, "\n")] = '\0';
+    return 1;
+}
+
+/**
+ * Parses a size such as "32K" or "1M".
+ */
+static long parseSize(const char *text) {
+    char *end;
+    long value = strtol(text, &end, 10);
+    switch (*end) {
+        case 'K': return value * 1024;
+        case 'M': return value * 1024 * 1024;
+        case 'G': return value * 1024 * 1024 * 1024;
+        default: return value;
+    }
+}
+
+/**
+ * Counts the CPUs of a CPU list such as "0-3,8-11".
+ */
+static long countCpus(const char *list) {
+    long count = 0;
+    const char *p = list;
+    while (*p != '\0') {
+        char *end;
+        long first = strtol(p, &end, 10);
+        long last = first;
+        if (end == p) {
+            break;
+        }
+        if (*end == '-') {
+            p = end + 1;
+            last = strtol(p, &end, 10);
+        }
+        count += last - first + 1;
+        p = *end == ',' ? end + 1 : end;
+    }
+    return count;
+}
+
+static void probeSysfs(void) {
+    char buffer[256];
+    int index;
+    for (index = 0; readCacheFile(index, "level", buffer, sizeof(buffer)); index++) {
+        int level = atoi(buffer);
+        if (!readCacheFile(index, "type", buffer, sizeof(buffer))) {
+            continue;
+        }
+        boolean instruction = strcmp(buffer, "Instruction") == 0;
+        long size = readCacheFile(index, "size", buffer, sizeof(buffer)) ? parseSize(buffer) : 0;
+        long sharing = readCacheFile(index, "shared_cpu_list", buffer, sizeof(buffer)) ? countCpus(buffer) : 0;
+        if (!instruction && readCacheFile(index, "coherency_line_size", buffer, sizeof(buffer))) {
+            long lineSize = atol(buffer);
+            if (lineSize > 0 && (topology[CACHE_LINE_SIZE] == 0 || lineSize < topology[CACHE_LINE_SIZE])) {
+                topology[CACHE_LINE_SIZE] = lineSize;
+            }
+        }
+        switch (level) {
+            case 1:
+                setIfUnknown(instruction ? CACHE_L1I_SIZE : CACHE_L1D_SIZE, size);
+                break;
+            case 2:
+                setIfUnknown(CACHE_L2_SIZE, size);
+                setIfUnknown(CACHE_L2_SHARING, sharing);
+                break;
+            case 3:
+                setIfUnknown(CACHE_L3_SIZE, size);
+                setIfUnknown(CACHE_L3_SHARING, sharing);
+                break;
+        }
+    }
+}
+
+static void probeOS(void) {
+    /* The descriptions in /sys are complete on all ISAs, glibc's sysconf values are not (e.g. on AArch64). */
+    probeSysfs();
+#ifdef _SC_LEVEL1_DCACHE_LINESIZE
+    setIfUnknown(CACHE_LINE_SIZE, sysconf(_SC_LEVEL1_DCACHE_LINESIZE));
+    setIfUnknown(CACHE_L1D_SIZE, sysconf(_SC_LEVEL1_DCACHE_SIZE));
+    setIfUnknown(CACHE_L1I_SIZE, sysconf(_SC_LEVEL1_ICACHE_SIZE));
+    setIfUnknown(CACHE_L2_SIZE, sysconf(_SC_LEVEL2_CACHE_SIZE));
+    setIfUnknown(CACHE_L3_SIZE, sysconf(_SC_LEVEL3_CACHE_SIZE));
+#endif
+}
+
+#elif os_DARWIN
+
+static void probeSysctl(int index, const char *name) {
+    int64_t value = 0;
+    size_t length = sizeof(value);
+    if (sysctlbyname(name, &value, &length, NULL, 0) == 0 && value > 0) {
+        topology[index] = value;
+    }
+}
+
+static void probeOS(void) {
+    probeSysctl(CACHE_LINE_SIZE, "hw.cachelinesize");
+    probeSysctl(CACHE_L1D_SIZE, "hw.l1dcachesize");
+    probeSysctl(CACHE_L1I_SIZE, "hw.l1icachesize");
+    probeSysctl(CACHE_L2_SIZE, "hw.l2cachesize");
+    probeSysctl(CACHE_L3_SIZE, "hw.l3cachesize");
+}
+
+#else
+
+static void probeOS(void) {
+#ifdef _SC_LEVEL1_DCACHE_LINESIZE
+    long lineSize = sysconf(_SC_LEVEL1_DCACHE_LINESIZE);
+    if (lineSize > 0) {
+        topology[CACHE_LINE_SIZE] = lineSize;
+    }
+#endif
+}
+
+#endif
+
+/**
+ * Gets the data cache line size from the CPU itself.
+ */
+static jlong probeLineSize(void) {
+#if isa_AARCH64 && (defined(__GNUC__) || defined(__clang__))
+    Unsigned8 ctr;
+    __asm__ __volatile__("mrs %0, ctr_el0" : "=r" (ctr));
+    return 4 << ((ctr >> 16) & 0xf);
+#elif isa_AMD64 && (defined(__GNUC__) || defined(__clang__))
+    unsigned int eax, ebx, ecx, edx;
+    __asm__ __volatile__("cpuid" : "=a" (eax), "=b" (ebx), "=c" (ecx), "=d" (edx) : "a" (1), "c" (0));
+    /* The CLFLUSH line size in 8 byte units. */
+    return ((ebx >> 8) & 0xff) * 8;
+#else
+    return 0;
+#endif
+}
+
+jlong *cacheTopology_get(void) {
+    if (!__atomic_load_n(&probed, __ATOMIC_ACQUIRE)) {
+        /* Racing threads compute the same values. */
+        probeOS();
+        if (topology[CACHE_LINE_SIZE] == 0) {
+            topology[CACHE_LINE_SIZE] = probeLineSize();
+        }
+        /* Publish the topology only once it is complete. */
+        __atomic_store_n(&probed, 1, __ATOMIC_RELEASE);
+    }
+    return topology;
+}
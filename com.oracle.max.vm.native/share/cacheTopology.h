@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2011, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ */
+#ifndef __cacheTopology_h__
+#define __cacheTopology_h__ 1
+
+#include "jni.h"
+
+/*
+ * The cache hierarchy of the CPU the VM is running on, probed once with sysconf, the cache
+ * descriptions in /sys/devices/system/cpu/cpu0/cache (Linux) or the hw.* sysctls (Darwin), with the
+ * line size falling back to CTR_EL0 (AArch64) or CPUID (AMD64). A value that could not be
+ * determined is 0.
+ *
+ * The indexes must match the com.sun.max.platform.CacheTopology enum.
+ */
+#define CACHE_LINE_SIZE 0   /* the smallest data cache line size in bytes */
+#define CACHE_L1D_SIZE 1    /* the level 1 data cache size in bytes */
+#define CACHE_L1I_SIZE 2    /* the level 1 instruction cache size in bytes */
+#define CACHE_L2_SIZE 3     /* the level 2 cache size in bytes */
+#define CACHE_L3_SIZE 4     /* the level 3 cache size in bytes */
+#define CACHE_L2_SHARING 5  /* the number of CPUs sharing a level 2 cache */
+#define CACHE_L3_SHARING 6  /* the number of CPUs sharing a level 3 cache */
+#define CACHE_TOPOLOGY_COUNT 7
+
+/**
+ * Gets the cache hierarchy description, an array of CACHE_TOPOLOGY_COUNT values indexed by the constants above.
+ */
+extern jlong *cacheTopology_get(void);
+
+#endif /*__cacheTopology_h__*/
@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2011, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ */
+/**
+ * Reads the memory and CPU limits of the control group the VM runs in so that
+ * the VM does not size itself for the whole host when running in a container.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "cgroup.h"
+#include "log.h"
+
+#if os_LINUX
+
+#define CGROUP_ROOT "/sys/fs/cgroup"
+
+static boolean initialized = false;
+static Size memoryLimit = 0;
+static int processorLimit = 0;
+
+/*
+ * Finds the path of this process's control group from /proc/self/cgroup for the v1 controller
+ * named 'controller' or, if 'controller' is NULL, the v2 unified hierarchy.
+ */
+static boolean findCgroupPath(const char *controller, char *path, size_t pathSize) {
+    char line[1024];
+    boolean found = false;
+    FILE *file = fopen("/proc/self/cgroup", "r");
+    if (file == NULL) {
+        return false;
+    }
+    while (!found && fgets(line, sizeof(line), file) != NULL) {
+        char *controllers = strchr(line, ':');
+        char *cgroup = controllers == NULL ? NULL : strchr(controllers + 1, ':');
+        if (cgroup == NULL) {
+            continue;
+        }
+        *cgroup++ = '\0';
+        controllers++;
+        cgroup[strcspn(cgroup, "\n")] = '\0';
+        if (controller == NULL) {
+            found = controllers[0] == '\0';
+        } else {
+            char *c;
+            for (c = strtok(controllers, ","); c != NULL && !found; c = strtok(NULL, ",")) {
+                found = strcmp(c, controller) == 0;
+            }
+        }
+        if (found) {
+            snprintf(path, pathSize, "%s", cgroup);
+        }
+    }
+    fclose(file);
+    return found;
+}
+
+/*
+ * Reads the first line of a control file, trying the control group's own directory first and then
+ * the root of the hierarchy (which is where a container's control group is when the cgroup namespace is private).
+ */
+static boolean readControlFile(const char *hierarchy, const char *cgroup, const char *name, char *buffer, int bufferSize) {
+    char path[1024];
+    FILE *file;
+    snprintf(path, sizeof(path), "%s%s%s/%s", CGROUP_ROOT, hierarchy, cgroup, name);
+    file = fopen(path, "r");
+    if (file == NULL) {
+        snprintf(path, sizeof(path), "%s%s/%s", CGROUP_ROOT, hierarchy, name);
+        file = fopen(path, "r");
+        if (file == NULL) {
+            return false;
+        }
+    }
+    boolean result = fgets(buffer, bufferSize, file) != NULL;
+    fclose(file);
+    return result;
+}
+
+static void readLimitsV2(const char *cgroup) {
+    char buffer[128];
+    if (readControlFile("", cgroup, "memory.max", buffer, sizeof(buffer)) && strncmp(buffer, "max", 3) != 0) {
+        memoryLimit = (Size) strtoull(buffer, NULL, 10);
+    }
+    if (readControlFile("", cgroup, "cpu.max", buffer, sizeof(buffer)) && strncmp(buffer, "max", 3) != 0) {
+        long long quota, period;
+        if (sscanf(buffer, "%lld %lld", &quota, &period) == 2 && quota > 0 && period > 0) {
+            processorLimit = (int) ((quota + period - 1) / period);
+        }
+    }
+}
+
+static void readLimitsV1(void) {
+    char cgroup[512];
+    char buffer[128];
+    if (findCgroupPath("memory", cgroup, sizeof(cgroup)) &&
+        readControlFile("/memory", cgroup, "memory.limit_in_bytes", buffer, sizeof(buffer))) {
+        /* An unlimited control group reports a huge page aligned value close to LONG_MAX. */
+        Size limit = (Size) strtoull(buffer, NULL, 10);
+        if (limit < ((Size) 1 << 62)) {
+            memoryLimit = limit;
+        }
+    }
+    if (findCgroupPath("cpu", cgroup, sizeof(cgroup))) {
+        char periodBuffer[128];
+        if (readControlFile("/cpu", cgroup, "cpu.cfs_quota_us", buffer, sizeof(buffer)) &&
+            readControlFile("/cpu", cgroup, "cpu.cfs_period_us", periodBuffer, sizeof(periodBuffer))) {
+            long long quota = strtoll(buffer, NULL, 10);
+            long long period = strtoll(periodBuffer, NULL, 10);
+            if (quota > 0 && period > 0) {
+                processorLimit = (int) ((quota + period - 1) / period);
+            }
+        }
+    }
+}
+
+static void initialize(void) {
+    char cgroup[512];
+    /* Only use the unified hierarchy if it has the controllers, i.e. not on a hybrid v1/v2 system. */
+    if (access(CGROUP_ROOT "/cgroup.controllers", F_OK) == 0 && findCgroupPath(NULL, cgroup, sizeof(cgroup))) {
+        readLimitsV2(cgroup);
+    } else {
+        readLimitsV1();
+    }
+#if log_LOADER
+    log_println("cgroup: memory limit = %lu, processor limit = %d", memoryLimit, processorLimit);
+#endif
+    initialized = true;
+}
+
+Size cgroup_memoryLimit(void) {
+    if (!initialized) {
+        initialize();
+    }
+    return memoryLimit;
+}
+
+int cgroup_processorLimit(void) {
+    if (!initialized) {
+        initialize();
+    }
+    return processorLimit;
+}
+
+#else
+
+Size cgroup_memoryLimit(void) {
+    return 0;
+}
+
+int cgroup_processorLimit(void) {
+    return 0;
+}
+
+#endif
@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2011, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ */
+#ifndef __cgroup_h__
+#define __cgroup_h__ 1
+
+#include "word.h"
+
+/**
+ * Gets the memory limit of the control group (v1 or v2) of this process.
+ * The limits are read once and cached.
+ *
+ * @return the limit in bytes or 0 if the process is not in a memory limited control group
+ */
+extern Size cgroup_memoryLimit(void);
+
+/**
+ * Gets the number of processors the CPU quota of the control group (v1 or v2) of this process
+ * amounts to, rounded up. The limits are read once and cached.
+ *
+ * @return the number of processors or 0 if the process is not in a CPU limited control group
+ */
+extern int cgroup_processorLimit(void);
+
+#endif /*__cgroup_h__*/
@@ -30,6 +30,43 @@
 #define THREAD_CONDVAR_MUTEX_FORMAT "thread=%p, condvar=%p, mutex=%p"
 #define THREAD_CONDVAR_FORMAT "thread=%p, condvar=%p"
 
+#if (os_DARWIN || os_LINUX)
+/*
+ * A condition variable paired with adaptive mutexes (see mutex.h) is a sequence number in the first
+ * word of the condition_Struct. A waiter parks on the sequence number it read while holding the mutex
+ * and a notifier increments it before unparking waiters, so a notification is never lost. The timeouts
+ * of these waits are measured against the monotonic clock.
+ */
+typedef struct {
+    volatile int sequence;
+    Mutex mutex;            // the mutex of the most recent waiter
+} AdaptiveConditionStruct, *AdaptiveCondition;
+
+typedef char AdaptiveConditionFitsInConditionStruct[sizeof(AdaptiveConditionStruct) <= sizeof(condition_Struct) ? 1 : -1];
+
+static int adaptiveWait(Condition condition, Mutex mutex, Signed8 timeoutNanos) {
+    AdaptiveCondition adaptiveCondition = (AdaptiveCondition) condition;
+    int sequence = adaptiveCondition->sequence;
+    adaptiveCondition->mutex = mutex;
+    int depth = mutex_releaseAll(mutex);
+    int error = mutex_park(&adaptiveCondition->sequence, sequence, timeoutNanos);
+    mutex_reacquire(mutex, depth);
+    return error;
+}
+
+static boolean adaptiveNotify(Condition condition, boolean all) {
+    AdaptiveCondition adaptiveCondition = (AdaptiveCondition) condition;
+    int sequence = __sync_add_and_fetch(&adaptiveCondition->sequence, 1);
+    if (all) {
+        /* Wake one waiter and hand the others over to the mutex rather than have them all contend for it. */
+        mutex_unparkOneAndRequeue(&adaptiveCondition->sequence, sequence, adaptiveCondition->mutex);
+    } else {
+        mutex_unpark(&adaptiveCondition->sequence, false);
+    }
+    return true;
+}
+#endif
+
 void condition_initialize(Condition condition) {
 #if log_MONITORS
     log_println("condition_initialize(" THREAD_CONDVAR_FORMAT ")", thread_self(), condition);
@@ -39,10 +76,25 @@ void condition_initialize(Condition condition) {
         c_FATAL();
     }
 #elif os_LINUX || os_DARWIN
-    if (pthread_cond_init(condition, NULL) != 0) {
+    if (mutex_isAdaptive()) {
+        memset((void *) condition, 0, sizeof(condition_Struct));
+        return;
+    }
+    pthread_condattr_t attributes;
+    if (pthread_condattr_init(&attributes) != 0) {
+        c_FATAL();
+    }
+#if os_LINUX
+    /* Timed waits are not affected by changes to the time of day (see compute_abstime()). */
+    if (pthread_condattr_setclock(&attributes, CLOCK_MONOTONIC) != 0) {
+        c_FATAL();
+    }
+#endif
+    if (pthread_cond_init(condition, &attributes) != 0) {
 	printf("FATAL ERROR condition_initialize\n");
         c_FATAL();
     }
+    pthread_condattr_destroy(&attributes);
 #elif os_MAXVE
     *condition = maxve_condition_create();
 #else
@@ -59,6 +111,9 @@ void condition_destroy(Condition condition) {
         c_FATAL();
     }
 #elif os_LINUX || os_DARWIN
+    if (mutex_isAdaptive()) {
+        return;
+    }
     if (pthread_cond_destroy(condition) != 0) {
         c_FATAL();
     }
@@ -85,7 +140,13 @@ boolean condition_wait(Condition condition, Mutex mutex) {
     log_println("condition_wait      (" THREAD_CONDVAR_MUTEX_FORMAT ")", thread_self(), condition, mutex);
 #endif
     int error;
+    mutex_profileWait(mutex);
 #if (os_DARWIN || os_LINUX)
+    if (mutex_isAdaptive()) {
+        /* Spurious wake-ups and signals are reported as notifications. */
+        adaptiveWait(condition, mutex, 0);
+        return true;
+    }
     error = pthread_cond_wait(condition, mutex);
 #elif os_SOLARIS
     error = cond_wait(condition, mutex);
@@ -112,16 +173,22 @@ boolean condition_wait(Condition condition, Mutex mutex) {
     return true;
 }
 
-#if (os_DARWIN || os_LINUX)
 /*
- * This function is taken from HotSpot (os_linux.cpp).
+ * The longest timed wait, after which the waiting thread returns as if the wait had timed out (see man cond_timedwait(3T)).
+ */
+#define MAX_TIMEOUT_MILLISECONDS (50000000ULL * 1000ULL)
+
+#if os_LINUX
+/*
+ * This function is derived from HotSpot (os_linux.cpp). The condition variables
+ * are initialized to use the monotonic clock.
  */
 static struct timespec* compute_abstime(struct timespec* abstime, jlong millis) {
     if (millis < 0) {
         millis = 0;
     }
-    struct timeval now;
-    int status = gettimeofday(&now, NULL);
+    struct timespec now;
+    int status = clock_gettime(CLOCK_MONOTONIC, &now);
     c_ASSERT(status == 0);
     jlong seconds = millis / 1000UL;
     millis %= 1000;
@@ -129,12 +196,12 @@ static struct timespec* compute_abstime(struct timespec* abstime, jlong millis)
         seconds = 50000000L;
     }
     abstime->tv_sec = now.tv_sec  + seconds;
-    jlong usec = now.tv_usec + (jlong) millis * 1000UL;
-    if (usec >= 1000000) {
+    jlong nsec = now.tv_nsec + (jlong) millis * 1000000UL;
+    if (nsec >= 1000000000L) {
         abstime->tv_sec += 1;
-        usec -= 1000000;
+        nsec -= 1000000000L;
     }
-    abstime->tv_nsec = usec * 1000UL;
+    abstime->tv_nsec = nsec;
     return abstime;
 }
 #endif
@@ -155,17 +222,31 @@ boolean condition_timedWait(Condition condition, Mutex mutex, Unsigned8 timeoutM
     if (timeoutMilliSeconds <= 0) {
         return condition_wait(condition, mutex);
     }
+    /* Java timeouts can be as large as Long.MAX_VALUE, which would overflow when converted to nanoseconds. */
+    if (timeoutMilliSeconds > MAX_TIMEOUT_MILLISECONDS) {
+        timeoutMilliSeconds = MAX_TIMEOUT_MILLISECONDS;
+    }
 #if log_MONITORS
     log_println("condition_timedWait (" THREAD_CONDVAR_MUTEX_FORMAT ", %d)", thread_self(), condition, mutex, timeoutMilliSeconds);
 #endif
 	int error;
+    mutex_profileWait(mutex);
 #if (os_DARWIN || os_LINUX)
-	struct timeval now;
-	int status = gettimeofday(&now, NULL);
-	c_ASSERT(status != -1);
+    if (mutex_isAdaptive()) {
+        adaptiveWait(condition, mutex, (Signed8) timeoutMilliSeconds * 1000000LL);
+        return true;
+    }
+#if os_DARWIN
+	/* The relative wait is measured against the monotonic clock. */
+	struct timespec reltime;
+	reltime.tv_sec = timeoutMilliSeconds / 1000;
+	reltime.tv_nsec = (timeoutMilliSeconds % 1000) * 1000000;
+	error = pthread_cond_timedwait_relative_np(condition, mutex, &reltime);
+#else
 	struct timespec abstime;
 	compute_abstime(&abstime, timeoutMilliSeconds);
 	error = pthread_cond_timedwait(condition, mutex, &abstime);
+#endif
 	if (error == ETIMEDOUT) {
 #if log_MONITORS
 	    log_println("condition_timedWait (" THREAD_CONDVAR_MUTEX_FORMAT ", %d) timed-out", thread_self(), condition, mutex, timeoutMilliSeconds);
@@ -217,6 +298,9 @@ boolean condition_notify(Condition condition) {
     log_println("condition_notify    (" THREAD_CONDVAR_FORMAT ")", thread_self(), condition);
 #endif
 #if (os_DARWIN || os_LINUX)
+    if (mutex_isAdaptive()) {
+        return adaptiveNotify(condition, false);
+    }
     return pthread_cond_signal(condition) == 0;
 #elif os_SOLARIS
     return cond_signal(condition) == 0;
@@ -232,6 +316,9 @@ boolean condition_notifyAll(Condition condition) {
     log_println("condition_notifyAll (" THREAD_CONDVAR_FORMAT ")", thread_self(), condition);
 #endif
 #if (os_DARWIN || os_LINUX)
+    if (mutex_isAdaptive()) {
+        return adaptiveNotify(condition, true);
+    }
     return pthread_cond_broadcast(condition) == 0;
 #elif os_SOLARIS
     return cond_broadcast(condition) == 0;
@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2011, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ */
+#include "os.h"
+#include "isa.h"
+#include "cpuFeatures.h"
+
+#if os_LINUX && (isa_ARM || isa_AARCH64 || isa_RISCV64)
+#include <sys/auxv.h>
+#endif
+
+#define FEATURE(feature) (1LL << CPU_FEATURE_##feature)
+
+#if isa_AMD64 && (defined(__GNUC__) || defined(__clang__))
+
+static void cpuid(unsigned int leaf, unsigned int subleaf, unsigned int registers[4]) {
+    __asm__ __volatile__("cpuid"
+                    : "=a" (registers[0]), "=b" (registers[1]), "=c" (registers[2]), "=d" (registers[3])
+                    : "a" (leaf), "c" (subleaf));
+}
+
+static jlong probe(void) {
+    unsigned int r[4];
+    jlong features = 0;
+    cpuid(0, 0, r);
+    unsigned int maxLeaf = r[0];
+    if (maxLeaf < 1) {
+        return 0;
+    }
+    cpuid(1, 0, r);
+    unsigned int ecx1 = r[2];
+    if (ecx1 & (1 << 19)) features |= FEATURE(SSE4_1);
+    if (ecx1 & (1 << 20)) features |= FEATURE(SSE4_2);
+    if (ecx1 & (1 << 23)) features |= FEATURE(POPCNT);
+    if (ecx1 & (1 << 25)) features |= FEATURE(AESNI);
+
+    /* The AVX registers are only usable if the OS saves them (OSXSAVE and the XCR0 state bits). */
+    unsigned long long xcr0 = 0;
+    if (ecx1 & (1 << 27)) {
+        unsigned int low, high;
+        __asm__ __volatile__("xgetbv" : "=a" (low), "=d" (high) : "c" (0));
+        xcr0 = ((unsigned long long) high << 32) | low;
+    }
+    boolean avxState = (xcr0 & 0x6) == 0x6;
+    boolean avx512State = avxState && (xcr0 & 0xe0) == 0xe0;
+    if (avxState) {
+        if (ecx1 & (1 << 28)) features |= FEATURE(AVX);
+        if (ecx1 & (1 << 12)) features |= FEATURE(FMA);
+    }
+
+    if (maxLeaf >= 7) {
+        cpuid(7, 0, r);
+        unsigned int ebx7 = r[1];
+        if (ebx7 & (1 << 3)) features |= FEATURE(BMI1);
+        if (ebx7 & (1 << 8)) features |= FEATURE(BMI2);
+        if (avxState && (ebx7 & (1 << 5))) features |= FEATURE(AVX2);
+        if (avx512State) {
+            if (ebx7 & (1 << 16)) features |= FEATURE(AVX512F);
+            if (ebx7 & (1U << 30)) features |= FEATURE(AVX512BW);
+            if (ebx7 & (1U << 31)) features |= FEATURE(AVX512VL);
+        }
+    }
+
+    cpuid(0x80000000, 0, r);
+    if (r[0] >= 0x80000001) {
+        cpuid(0x80000001, 0, r);
+        if (r[2] & (1 << 5)) features |= FEATURE(LZCNT);
+    }
+    return features | FEATURE(IDIV);
+}
+
+#elif os_LINUX && isa_AARCH64
+
+static jlong probe(void) {
+    unsigned long hwcap = getauxval(AT_HWCAP);
+    unsigned long hwcap2 = getauxval(AT_HWCAP2);
+    jlong features = 0;
+    if (hwcap & (1UL << 1)) features |= FEATURE(NEON);     /* HWCAP_ASIMD */
+    if (hwcap & (1UL << 3)) features |= FEATURE(AES);      /* HWCAP_AES */
+    if (hwcap & (1UL << 4)) features |= FEATURE(PMULL);    /* HWCAP_PMULL */
+    if (hwcap & (1UL << 5)) features |= FEATURE(SHA1);     /* HWCAP_SHA1 */
+    if (hwcap & (1UL << 6)) features |= FEATURE(SHA2);     /* HWCAP_SHA2 */
+    if (hwcap & (1UL << 7)) features |= FEATURE(CRC32);    /* HWCAP_CRC32 */
+    if (hwcap & (1UL << 8)) features |= FEATURE(LSE);      /* HWCAP_ATOMICS */
+    if (hwcap & (1UL << 22)) features |= FEATURE(SVE);     /* HWCAP_SVE */
+    if (hwcap2 & (1UL << 1)) features |= FEATURE(SVE2);    /* HWCAP2_SVE2 */
+    /* SDIV and UDIV are part of the base A64 instruction set. */
+    features |= FEATURE(IDIV);
+    return features;
+}
+
+#elif os_LINUX && isa_ARM
+
+static jlong probe(void) {
+    unsigned long hwcap = getauxval(AT_HWCAP);
+    unsigned long hwcap2 = getauxval(AT_HWCAP2);
+    jlong features = 0;
+    if (hwcap & (1UL << 12)) features |= FEATURE(NEON);    /* HWCAP_NEON */
+    if (hwcap & (1UL << 17)) features |= FEATURE(IDIV);    /* HWCAP_IDIVA */
+    if (hwcap2 & (1UL << 0)) features |= FEATURE(AES);     /* HWCAP2_AES */
+    if (hwcap2 & (1UL << 1)) features |= FEATURE(PMULL);   /* HWCAP2_PMULL */
+    if (hwcap2 & (1UL << 2)) features |= FEATURE(SHA1);    /* HWCAP2_SHA1 */
+    if (hwcap2 & (1UL << 3)) features |= FEATURE(SHA2);    /* HWCAP2_SHA2 */
+    if (hwcap2 & (1UL << 4)) features |= FEATURE(CRC32);   /* HWCAP2_CRC32 */
+    return features;
+}
+
+#elif os_LINUX && isa_RISCV64
+
+static jlong probe(void) {
+    /* The bits of HWCAP are the single letter extensions, bit 0 being 'A'. */
+    unsigned long hwcap = getauxval(AT_HWCAP);
+    jlong features = FEATURE(IDIV);
+    if (hwcap & (1UL << ('C' - 'A'))) features |= FEATURE(RISCV_C);
+    if (hwcap & (1UL << ('V' - 'A'))) features |= FEATURE(RISCV_V);
+    return features;
+}
+
+#else
+
+static jlong probe(void) {
+    return FEATURE(IDIV);
+}
+
+#endif
+
+/*
+ * The probed features, with an extra bit set once the probe has run (no feature uses bit 63).
+ */
+static volatile jlong probedFeatures;
+
+#define PROBED (1LL << 63)
+
+jlong cpuFeatures_get(void) {
+    jlong features = probedFeatures;
+    if (features == 0) {
+        /* Racing threads compute the same value. */
+        features = probe() | PROBED;
+        probedFeatures = features;
+    }
+    return features & ~PROBED;
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2011, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ */
+#ifndef __cpuFeatures_h__
+#define __cpuFeatures_h__ 1
+
+#include "jni.h"
+
+/*
+ * The instruction set extensions of the CPU the VM is running on, probed once with CPUID on AMD64 and from
+ * the HWCAP and HWCAP2 auxiliary vector entries on Linux for ARM, AArch64 and RISC-V.
+ *
+ * Each feature is a bit of a 64-bit set. The bit numbers are stable and must match those of the
+ * com.sun.max.platform.CPUFeature enum.
+ */
+#define CPU_FEATURES(f) \
+    f(SSE4_1, 0) \
+    f(SSE4_2, 1) \
+    f(POPCNT, 2) \
+    f(LZCNT, 3) \
+    f(BMI1, 4) \
+    f(BMI2, 5) \
+    f(AVX, 6) \
+    f(AVX2, 7) \
+    f(FMA, 8) \
+    f(AVX512F, 9) \
+    f(AVX512BW, 10) \
+    f(AVX512VL, 11) \
+    f(AESNI, 12) \
+    f(NEON, 32) \
+    f(SVE, 33) \
+    f(SVE2, 34) \
+    f(LSE, 35) \
+    f(CRC32, 36) \
+    f(AES, 37) \
+    f(PMULL, 38) \
+    f(SHA1, 39) \
+    f(SHA2, 40) \
+    f(IDIV, 41) \
+    f(RISCV_C, 48) \
+    f(RISCV_V, 49) \
+
+#define CPU_FEATURE_ENUM(feature, bit) CPU_FEATURE_##feature = bit,
+
+typedef enum {
+    CPU_FEATURES(CPU_FEATURE_ENUM)
+} cpuFeatures_Feature;
+
+/**
+ * Gets the set of the features of the CPU, with bit 'n' set if the feature numbered 'n' is supported
+ * (and, for the vector extensions, enabled by the operating system).
+ */
+extern jlong cpuFeatures_get(void);
+
+/**
+ * Determines if the CPU supports a given feature.
+ */
+#define cpuFeatures_has(feature) ((cpuFeatures_get() & (1LL << CPU_FEATURE_##feature)) != 0)
+
+#endif /*__cpuFeatures_h__*/
@@ -23,85 +23,160 @@
  * questions.
  */
 #include "os.h"
+#include "isa.h"
 #include <stdlib.h>
+#include <string.h>
 
+#include "c.h"
 #include "log.h"
 #include "word.h"
 #include "jni.h"
 
 #include "dataio.h"
 
-#if (word_LITTLE_ENDIAN)
-#define GET_LITTLE_ENDIAN_DATUM(src, type) return *((type *) src);
-#define PUT_LITTLE_ENDIAN_DATUM(dst, type) do { *((type *) dst) = value; } while(0)
-#define GET_BIG_ENDIAN_DATUM(src, type) do { \
-        int i; \
-        type result = 0; \
-        Byte *srcByte = (Byte *) src; \
-        for (i = sizeof(type) - 1; i >= 0; --i) { \
-            result |= *srcByte++ << (i * 8); \
-        } \
-        return result; \
-    } while(0)
-#define PUT_BIG_ENDIAN_DATUM(dst, type) do { \
-        int i; \
-        Byte *dstByte = (Byte *) dst; \
-        for (i = sizeof(type) - 1; i >= 0; --i) { \
-            *dstByte++ = ((value >> (i * 8)) & 0xff); \
-        } \
-    } while(0)
-#else
-#define GET_BIG_ENDIAN_DATUM(src, type) return *((type *) src);
-#define PUT_BIG_ENDIAN_DATUM(dst, type) do { *((type *) dst) = value; } while(0)
-#define GET_LITTLE_ENDIAN_DATUM(src, type) do { \
-        unsigned int i; \
-        type result = 0; \
-        Byte *srcByte = (Byte *) src; \
-        for (i = 0; i < sizeof(type); i++) { \
-            result |= *srcByte++ << (i * 8); \
-        } \
-        return result; \
-    } while(0)
-#define PUT_LITTLE_ENDIAN_DATUM(dst, type) do { \
-        unsigned int i; \
-        Byte *dstByte = (Byte *) dst; \
-        for (i = 0; i < sizeof(type); i++) { \
-            *dstByte++ = (value & 0xff); \
-            value >>= 8; \
-        } \
-    } while(0)
+#if isa_AMD64
+#include <immintrin.h>
+#elif isa_AARCH64
+#include <arm_neon.h>
 #endif
 
-Unsigned8 readLittleEndianUnsigned8(Address src) {
-    GET_LITTLE_ENDIAN_DATUM(src, Unsigned8);
+/*
+ * Reverses the bytes of the elements in the range [start, end) of a copy, one element at a time.
+ * Moving backwards makes this safe for a destination that overlaps the end of the source.
+ */
+static void copySwappedScalar(Address dst, Address src, Size start, Size end, int elementSize, jboolean backwards) {
+    Size n = (end - start) / elementSize;
+    Size i;
+    for (i = 0; i < n; i++) {
+        Size offset = backwards ? end - (i + 1) * elementSize : start + i * elementSize;
+        switch (elementSize) {
+            case 2: {
+                Unsigned2 value;
+                memcpy(&value, (void *) (src + offset), sizeof(value));
+                value = __builtin_bswap16(value);
+                memcpy((void *) (dst + offset), &value, sizeof(value));
+                break;
+            }
+            case 4: {
+                Unsigned4 value;
+                memcpy(&value, (void *) (src + offset), sizeof(value));
+                value = __builtin_bswap32(value);
+                memcpy((void *) (dst + offset), &value, sizeof(value));
+                break;
+            }
+            case 8: {
+                Unsigned8 value;
+                memcpy(&value, (void *) (src + offset), sizeof(value));
+                value = __builtin_bswap64(value);
+                memcpy((void *) (dst + offset), &value, sizeof(value));
+                break;
+            }
+        }
+    }
+}
+
+#if isa_AMD64
+
+/*
+ * The pshufb masks that reverse the bytes of each 2, 4 and 8 byte element of a 16 byte vector.
+ */
+static const Byte swapMasks[3][16] __attribute__((aligned(16))) = {
+    { 1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14 },
+    { 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12 },
+    { 7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8 }
+};
+
+static inline const Byte *swapMask(int elementSize) {
+    return swapMasks[elementSize == 2 ? 0 : (elementSize == 4 ? 1 : 2)];
 }
 
-Unsigned8 readBigEndianUnsigned8(Address src) {
-    GET_BIG_ENDIAN_DATUM(src, Unsigned8);
+/*
+ * The vector kernels return the number of bytes copied, which is a multiple of the vector size.
+ */
+__attribute__((target("avx2")))
+static Size copySwappedAVX2(Address dst, Address src, Size size, int elementSize) {
+    const __m128i mask128 = _mm_load_si128((const __m128i *) swapMask(elementSize));
+    /* vpshufb shuffles within each 128 bit lane, so the same mask is used for both lanes. */
+    const __m256i mask = _mm256_broadcastsi128_si256(mask128);
+    Size i = 0;
+    for (; i + 64 <= size; i += 64) {
+        __m256i a = _mm256_loadu_si256((const __m256i *) (src + i));
+        __m256i b = _mm256_loadu_si256((const __m256i *) (src + i + 32));
+        _mm256_storeu_si256((__m256i *) (dst + i), _mm256_shuffle_epi8(a, mask));
+        _mm256_storeu_si256((__m256i *) (dst + i + 32), _mm256_shuffle_epi8(b, mask));
+    }
+    for (; i + 32 <= size; i += 32) {
+        __m256i a = _mm256_loadu_si256((const __m256i *) (src + i));
+        _mm256_storeu_si256((__m256i *) (dst + i), _mm256_shuffle_epi8(a, mask));
+    }
+    return i;
 }
 
-Unsigned4 readLittleEndianUnsigned4(Address src) {
-    GET_LITTLE_ENDIAN_DATUM(src, Unsigned4);
+__attribute__((target("ssse3")))
+static Size copySwappedSSSE3(Address dst, Address src, Size size, int elementSize) {
+    const __m128i mask = _mm_load_si128((const __m128i *) swapMask(elementSize));
+    Size i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m128i a = _mm_loadu_si128((const __m128i *) (src + i));
+        _mm_storeu_si128((__m128i *) (dst + i), _mm_shuffle_epi8(a, mask));
+    }
+    return i;
 }
 
-Unsigned4 readBigEndianUnsigned4(Address src) {
-    GET_BIG_ENDIAN_DATUM(src, Unsigned4);
+static Size copySwappedVector(Address dst, Address src, Size size, int elementSize) {
+    if (__builtin_cpu_supports("avx2")) {
+        return copySwappedAVX2(dst, src, size, elementSize);
+    } else if (__builtin_cpu_supports("ssse3")) {
+        return copySwappedSSSE3(dst, src, size, elementSize);
+    }
+    return 0;
 }
 
+#elif isa_AARCH64
+
+static Size copySwappedVector(Address dst, Address src, Size size, int elementSize) {
+    Size i = 0;
+    for (; i + 16 <= size; i += 16) {
+        uint8x16_t a = vld1q_u8((const uint8_t *) (src + i));
+        uint8x16_t b = elementSize == 2 ? vrev16q_u8(a) : (elementSize == 4 ? vrev32q_u8(a) : vrev64q_u8(a));
+        vst1q_u8((uint8_t *) (dst + i), b);
+    }
+    return i;
+}
 
+#else
 
-void writeLittleEndianUnsigned8(Address dst, Unsigned8 value) {
-    PUT_LITTLE_ENDIAN_DATUM(dst, Unsigned8);
+static Size copySwappedVector(Address dst, Address src, Size size, int elementSize) {
+    return 0;
 }
 
-void writeBigEndianUnsigned8(Address dst, Unsigned8 value) {
-    PUT_BIG_ENDIAN_DATUM(dst, Unsigned8);
+#endif
+
+void copySwapped(Address dst, Address src, Size size, int elementSize) {
+    c_ASSERT(elementSize == 2 || elementSize == 4 || elementSize == 8);
+    c_ASSERT(size % elementSize == 0);
+    if (dst > src && dst < src + size) {
+        /* A forward copy would overwrite source elements before they are read. */
+        copySwappedScalar(dst, src, 0, size, elementSize, true);
+        return;
+    }
+    Size copied = copySwappedVector(dst, src, size, elementSize);
+    copySwappedScalar(dst, src, copied, size, elementSize, false);
 }
 
-void writeLittleEndianUnsigned4(Address dst, Unsigned4 value) {
-    PUT_LITTLE_ENDIAN_DATUM(dst, Unsigned4);
+void copyConvertingByteOrder(Address dst, Address src, Size size, int elementSize, jboolean isBigEndian) {
+    if ((isBigEndian != 0) == (word_BIG_ENDIAN != 0)) {
+        if (dst != src) {
+            memmove((void *) dst, (void *) src, size);
+        }
+        return;
+    }
+    copySwapped(dst, src, size, elementSize);
 }
 
-void writeBigEndianUnsigned4(Address dst, Unsigned4 value) {
-    PUT_BIG_ENDIAN_DATUM(dst, Unsigned4);
+void convertByteOrder(Address data, Size size, int elementSize, jboolean isBigEndian) {
+    if ((isBigEndian != 0) != (word_BIG_ENDIAN != 0)) {
+        /* The vector kernels load each block before storing it, so they are safe in place. */
+        copySwapped(data, data, size, elementSize);
+    }
 }
@@ -23,15 +23,64 @@
 #ifndef __dataio_h__
 #define __dataio_h__    1
 
-extern Unsigned8 readLittleEndianUnsigned8(Address src);
-extern Unsigned8 readBigEndianUnsigned8(Address src);
-extern Unsigned4 readLittleEndianUnsigned4(Address src);
-extern Unsigned4 readBigEndianUnsigned4(Address src);
-
-extern void writeLittleEndianUnsigned8(Address dst, Unsigned8 value);
-extern void writeBigEndianUnsigned8(Address dst, Unsigned8 value);
-extern void writeLittleEndianUnsigned4(Address dst, Unsigned4 value);
-extern void writeBigEndianUnsigned4(Address dst, Unsigned4 value);
+#include <string.h>
+#include "word.h"
+#include "jni.h"
+
+/*
+ * The single value accessors are inline so that loops over values in a foreign byte order (e.g. the
+ * relocation of a big endian image on a little endian host) compile to a load and a byte swap.
+ */
+
+#if word_BIG_ENDIAN
+#define DATAIO_FROM_BIG_ENDIAN(bits, value) (value)
+#define DATAIO_FROM_LITTLE_ENDIAN(bits, value) __builtin_bswap##bits(value)
+#else
+#define DATAIO_FROM_BIG_ENDIAN(bits, value) __builtin_bswap##bits(value)
+#define DATAIO_FROM_LITTLE_ENDIAN(bits, value) (value)
+#endif
+
+#define DATAIO_ACCESSORS(order, ORDER, bits, size) \
+    static inline Unsigned##size read##order##EndianUnsigned##size(Address src) { \
+        Unsigned##size value; \
+        memcpy(&value, (void *) src, sizeof(value)); \
+        return DATAIO_FROM_##ORDER##_ENDIAN(bits, value); \
+    } \
+    static inline void write##order##EndianUnsigned##size(Address dst, Unsigned##size value) { \
+        value = DATAIO_FROM_##ORDER##_ENDIAN(bits, value); \
+        memcpy((void *) dst, &value, sizeof(value)); \
+    }
+
+DATAIO_ACCESSORS(Little, LITTLE, 64, 8)
+DATAIO_ACCESSORS(Big, BIG, 64, 8)
+DATAIO_ACCESSORS(Little, LITTLE, 32, 4)
+DATAIO_ACCESSORS(Big, BIG, 32, 4)
+
+/**
+ * Copies a range of memory, reversing the byte order of each element in the range.
+ * The source and destination may overlap.
+ *
+ * @param size the number of bytes to copy, a multiple of 'elementSize'
+ * @param elementSize 2, 4 or 8
+ */
+extern void copySwapped(Address dst, Address src, Size size, int elementSize);
+
+/**
+ * Copies an array of 2, 4 or 8 byte values from or to a given byte order, reversing the bytes of
+ * each value if that order is not the native one. The source and destination may overlap.
+ *
+ * @param size the number of bytes to copy, a multiple of 'elementSize'
+ * @param isBigEndian specifies if the values are (to be) in big endian order
+ */
+extern void copyConvertingByteOrder(Address dst, Address src, Size size, int elementSize, jboolean isBigEndian);
+
+/**
+ * Converts an array of 2, 4 or 8 byte values in place from or to a given byte order.
+ *
+ * @param size the size of the array in bytes, a multiple of 'elementSize'
+ * @param isBigEndian specifies if the values are (to be) in big endian order
+ */
+extern void convertByteOrder(Address data, Size size, int elementSize, jboolean isBigEndian);
 
 #endif /*__dataio_h__*/
 
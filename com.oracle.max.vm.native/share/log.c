@@ -33,6 +33,264 @@
 static FILE *fileStream = NULL;
 #endif
 
+#if os_LINUX || os_DARWIN
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <sys/time.h>
+
+/*
+ * Asynchronous logging (-XX:+AsyncLogging). Each thread formats its output into a private ring buffer
+ * and a background writer thread drains the buffers to the log file in large writes. Output is only
+ * handed over to the writer at line boundaries (or at the end of a log_lock()/log_unlock() block) so
+ * lines of different threads are never interleaved and the output of each thread stays in order.
+ * The multi-part messages bracketed by log_lock() and log_unlock() therefore no longer need the global
+ * log mutex. Pending output is written when the VM exits.
+ */
+#define LOG_BUFFER_SIZE (64 * 1024)
+#define LOG_FORMAT_SIZE 1024
+#define LOG_WRITER_PERIOD_MILLIS 10
+
+typedef struct LogBufferStruct {
+    struct LogBufferStruct *next;
+    volatile Size head;        // the number of bytes appended by the owning thread
+    volatile Size committed;   // the number of bytes that the writer may write
+    volatile Size tail;        // the number of bytes written by the writer
+    Size lastLineEnd;          // the end of the last complete line appended
+    int lockDepth;             // the nesting depth of log_lock() on the owning thread
+    boolean busy;              // detects reentrant logging from a signal handler
+    volatile boolean exited;
+    char data[LOG_BUFFER_SIZE];
+} LogBufferStruct, *LogBuffer;
+
+static boolean asyncLogging;
+
+static LogBuffer volatile theLogBuffers;
+
+static __thread LogBuffer theCurrentLogBuffer;
+
+/*
+ * Used to detect thread exit so that the buffer of an exited thread can be released once it has been drained.
+ */
+static pthread_key_t logBufferKey;
+
+/*
+ * Held by the writer thread while it drains buffers.
+ */
+static pthread_mutex_t logWriterMutex = PTHREAD_MUTEX_INITIALIZER;
+
+static pthread_cond_t logWriterCondition = PTHREAD_COND_INITIALIZER;
+
+void log_setAsync(boolean async) {
+    asyncLogging = async;
+}
+
+static void wakeLogWriter(void) {
+    pthread_cond_signal(&logWriterCondition);
+}
+
+/*
+ * Makes the appended output up to the end of the last complete line available to the writer.
+ */
+static void commitLogBuffer(LogBuffer buffer, boolean all) {
+    Size end = all ? buffer->head : buffer->lastLineEnd;
+    if (end > buffer->committed) {
+        /* The committed bytes must be visible to the writer before the new commit position. */
+        __sync_synchronize();
+        buffer->committed = end;
+        if (end - buffer->tail >= LOG_BUFFER_SIZE / 4) {
+            wakeLogWriter();
+        }
+    }
+}
+
+static void logBufferExited(void *value) {
+    LogBuffer buffer = (LogBuffer) value;
+    theCurrentLogBuffer = NULL;
+    commitLogBuffer(buffer, true);
+    buffer->exited = true;
+}
+
+static LogBuffer currentLogBuffer(void) {
+    LogBuffer buffer = theCurrentLogBuffer;
+    if (buffer == NULL) {
+        buffer = (LogBuffer) calloc(1, sizeof(LogBufferStruct));
+        if (buffer == NULL) {
+            return NULL;
+        }
+        pthread_setspecific(logBufferKey, buffer);
+        LogBuffer next;
+        do {
+            next = theLogBuffers;
+            buffer->next = next;
+        } while (!__sync_bool_compare_and_swap(&theLogBuffers, next, buffer));
+        theCurrentLogBuffer = buffer;
+    }
+    return buffer;
+}
+
+static void appendToLogBuffer(LogBuffer buffer, const char *chars, Size length) {
+    Size i = length;
+    while (i > 0 && chars[i - 1] != '\n') {
+        i--;
+    }
+    if (i > 0) {
+        buffer->lastLineEnd = buffer->head + i;
+    }
+    while (length > 0) {
+        Size space = LOG_BUFFER_SIZE - (buffer->head - buffer->tail);
+        if (space == 0) {
+            /* The buffer is full: wait for the writer, handing it an incomplete line only if there is nothing else to write. */
+            if (buffer->committed == buffer->tail) {
+                commitLogBuffer(buffer, true);
+            }
+            wakeLogWriter();
+            sched_yield();
+            continue;
+        }
+        Size offset = buffer->head % LOG_BUFFER_SIZE;
+        Size chunk = length;
+        if (chunk > space) {
+            chunk = space;
+        }
+        if (chunk > LOG_BUFFER_SIZE - offset) {
+            chunk = LOG_BUFFER_SIZE - offset;
+        }
+        memcpy(&buffer->data[offset], chars, chunk);
+        buffer->head += chunk;
+        chars += chunk;
+        length -= chunk;
+    }
+    if (buffer->lockDepth == 0) {
+        commitLogBuffer(buffer, false);
+    }
+}
+
+/*
+ * Formats output into the current thread's log buffer.
+ *
+ * @return false if the output could not be buffered and must be written directly
+ */
+static boolean logToBuffer(const char *format, va_list ap) {
+    LogBuffer buffer = currentLogBuffer();
+    if (buffer == NULL || buffer->busy) {
+        return false;
+    }
+    buffer->busy = true;
+    char chars[LOG_FORMAT_SIZE];
+    va_list copy;
+    va_copy(copy, ap);
+    int length = vsnprintf(chars, LOG_FORMAT_SIZE, format, copy);
+    va_end(copy);
+    if (length >= LOG_FORMAT_SIZE) {
+        char *longChars = (char *) malloc(length + 1);
+        if (longChars != NULL) {
+            vsnprintf(longChars, length + 1, format, ap);
+            appendToLogBuffer(buffer, longChars, length);
+            free(longChars);
+        }
+    } else if (length > 0) {
+        appendToLogBuffer(buffer, chars, length);
+    }
+    buffer->busy = false;
+    return true;
+}
+
+/*
+ * Writes the buffered output to the log file. Must be called with logWriterMutex held.
+ *
+ * @param all specifies if output that has not been committed is also to be written (only safe when the VM is exiting)
+ */
+static void drainLogBuffers(boolean all) {
+    LogBuffer buffer;
+    for (buffer = theLogBuffers; buffer != NULL; buffer = buffer->next) {
+        Size end = all ? buffer->head : buffer->committed;
+        __sync_synchronize();
+        Size tail = buffer->tail;
+        while (tail != end) {
+            Size offset = tail % LOG_BUFFER_SIZE;
+            Size chunk = end - tail;
+            if (chunk > LOG_BUFFER_SIZE - offset) {
+                chunk = LOG_BUFFER_SIZE - offset;
+            }
+            fwrite(&buffer->data[offset], 1, chunk, fileStream);
+            tail += chunk;
+        }
+        /* The bytes must have been written before their space is handed back to the thread. */
+        __sync_synchronize();
+        buffer->tail = tail;
+    }
+    fflush(fileStream);
+
+    /* Release the drained buffers of exited threads. The first buffer is kept as new buffers are pushed before it. */
+    LogBuffer previous = theLogBuffers;
+    while (previous != NULL && previous->next != NULL) {
+        buffer = previous->next;
+        if (buffer->exited && buffer->tail == buffer->head) {
+            previous->next = buffer->next;
+            free(buffer);
+        } else {
+            previous = buffer;
+        }
+    }
+}
+
+static void *logWriter(void *arg) {
+    pthread_mutex_lock(&logWriterMutex);
+    while (true) {
+        struct timeval now;
+        struct timespec abstime;
+        gettimeofday(&now, NULL);
+        Signed8 nanos = (Signed8) now.tv_usec * 1000 + LOG_WRITER_PERIOD_MILLIS * 1000000LL;
+        abstime.tv_sec = now.tv_sec + nanos / 1000000000LL;
+        abstime.tv_nsec = nanos % 1000000000LL;
+        pthread_cond_timedwait(&logWriterCondition, &logWriterMutex, &abstime);
+        drainLogBuffers(false);
+    }
+    return NULL;
+}
+
+static void flushLogBuffersAtExit(void) {
+    pthread_mutex_lock(&logWriterMutex);
+    drainLogBuffers(true);
+    pthread_mutex_unlock(&logWriterMutex);
+}
+
+static void startLogWriter(void) {
+    if (pthread_key_create(&logBufferKey, logBufferExited) != 0) {
+        asyncLogging = false;
+        return;
+    }
+    /* The writer must not handle any of the signals that are directed at the VM's threads. */
+    sigset_t allSignals, signals;
+    sigfillset(&allSignals);
+    pthread_sigmask(SIG_SETMASK, &allSignals, &signals);
+    pthread_attr_t attributes;
+    pthread_attr_init(&attributes);
+    pthread_attr_setdetachstate(&attributes, PTHREAD_CREATE_DETACHED);
+    pthread_t writer;
+    int error = pthread_create(&writer, &attributes, logWriter, NULL);
+    pthread_attr_destroy(&attributes);
+    pthread_sigmask(SIG_SETMASK, &signals, NULL);
+    if (error != 0) {
+        asyncLogging = false;
+        return;
+    }
+    /* Writes are already batched by the writer. */
+    setvbuf(fileStream, NULL, _IOFBF, LOG_BUFFER_SIZE);
+    atexit(flushLogBuffersAtExit);
+}
+
+#else
+
+void log_setAsync(boolean async) {
+}
+
+#define asyncLogging false
+#define logToBuffer(format, ap) false
+
+#endif
+
 void log_assert(boolean condition, char *conditionString, char *fileName, int lineNumber) {
     if (!condition) {
         log_println("log_assert %s[%d]: %s", fileName, lineNumber, conditionString);
@@ -65,10 +323,25 @@ void log_initialize(const char *path) {
         /* Set the file stream to flush whenever a newline character is encountered */
         setlinebuf(fileStream);
     }
+#if os_LINUX || os_DARWIN
+    if (asyncLogging) {
+        startLogWriter();
+    }
+#endif
 #endif
 }
 
 void log_lock(void) {
+#if os_LINUX || os_DARWIN
+    if (asyncLogging) {
+        /* The output of the thread is not handed over to the writer until the matching log_unlock(). */
+        LogBuffer buffer = currentLogBuffer();
+        if (buffer != NULL) {
+            buffer->lockDepth++;
+            return;
+        }
+    }
+#endif
 	int result;
 	if ((result = mutex_enter_nolog(&log_mutexStruct)) != 0) {
 	    log_exit(-1, "Thread %p could not lock mutex %p: %s", thread_self(), &log_mutexStruct, strerror(result));
@@ -84,6 +357,17 @@ void numaProfiler_lock(void) {
 }
 
 void log_unlock(void) {
+#if os_LINUX || os_DARWIN
+    if (asyncLogging) {
+        LogBuffer buffer = theCurrentLogBuffer;
+        if (buffer != NULL && buffer->lockDepth > 0) {
+            if (--buffer->lockDepth == 0) {
+                commitLogBuffer(buffer, false);
+            }
+            return;
+        }
+    }
+#endif
     int result;
 	if ((result = mutex_exit_nolog(&log_mutexStruct)) != 0) {
         log_exit(-1, "Thread %p could not unlock mutex %p: %s", thread_self(), &log_mutexStruct, strerror(result));
@@ -101,16 +385,23 @@ void numaProfiler_unlock(void) {
 void log_print_format(const char *format, ...) {
     va_list ap;
     va_start(ap, format);
-#if !os_MAXVE
-    FILE* out = fileStream == NULL ? stdout : fileStream;
-    vfprintf(out, format, ap);
-#else
-    vprintf(format, ap);
-#endif
+    log_print_vformat(format, ap);
     va_end(ap);
 }
 
 void log_flush() {
+#if os_LINUX || os_DARWIN
+    if (asyncLogging) {
+        LogBuffer buffer = theCurrentLogBuffer;
+        if (buffer != NULL) {
+            commitLogBuffer(buffer, true);
+        }
+        pthread_mutex_lock(&logWriterMutex);
+        drainLogBuffers(false);
+        pthread_mutex_unlock(&logWriterMutex);
+        return;
+    }
+#endif
 #if !os_MAXVE
     FILE* out = fileStream == NULL ? stdout : fileStream;
     fflush(out);
@@ -118,6 +409,9 @@ void log_flush() {
 }
 
 void log_print_vformat(const char *format, va_list ap) {
+    if (asyncLogging && logToBuffer(format, ap)) {
+        return;
+    }
 #if !os_MAXVE
     FILE* out = fileStream == NULL ? stdout : fileStream;
     vfprintf(out, format, ap);
@@ -196,10 +490,103 @@ void log_print_newline() {
     log_print_format(NEWLINE_STRING);
 }
 
+#if !os_MAXVE
+/*
+ * A cache of the results of dladdr(). Stack dumps resolve the same return addresses over and over and
+ * dladdr() searches the symbol tables of all loaded libraries (and takes the dynamic linker's lock).
+ * The cache is a fixed, direct mapped table so that a lookup is async-signal-safe: an entry is guarded
+ * by a sequence number that is odd while the entry is being updated, and a reader that sees the number
+ * change discards what it read and calls dladdr().
+ *
+ * The names in a Dl_info point into the library that defines the symbol, so all entries are discarded
+ * (by advancing the generation of the cache) before a library is unloaded. An entry is only used if it
+ * was resolved in the current generation.
+ */
+typedef struct {
+    volatile Unsigned4 sequence;
+    Unsigned4 generation;
+    Address address;
+    boolean found;
+    Dl_info info;
+} SymbolCacheEntryStruct, *SymbolCacheEntry;
+
+#define SYMBOL_CACHE_SIZE 2048
+
+static SymbolCacheEntryStruct symbolCache[SYMBOL_CACHE_SIZE];
+
+static volatile Unsigned4 symbolCacheGeneration;
+
+void log_forgetSymbols(void) {
+    __sync_fetch_and_add(&symbolCacheGeneration, 1);
+}
+
+static SymbolCacheEntry symbolCacheEntry(Address address) {
+    return &symbolCache[((address >> 2) * 0x9E3779B1U) % SYMBOL_CACHE_SIZE];
+}
+
+static boolean lookupSymbol(Address address, boolean *found, Dl_info *info) {
+    SymbolCacheEntry entry = symbolCacheEntry(address);
+    Unsigned4 sequence = entry->sequence;
+    if ((sequence & 1) != 0 || sequence == 0) {
+        return false;
+    }
+    __sync_synchronize();
+    Unsigned4 generation = entry->generation;
+    Address cachedAddress = entry->address;
+    *found = entry->found;
+    *info = entry->info;
+    __sync_synchronize();
+    return entry->sequence == sequence && cachedAddress == address && generation == symbolCacheGeneration;
+}
+
+/*
+ * Caches the result of a dladdr() call that was made in a given generation of the cache.
+ */
+static void cacheSymbol(Address address, Unsigned4 generation, boolean found, Dl_info *info) {
+    SymbolCacheEntry entry = symbolCacheEntry(address);
+    Unsigned4 sequence = entry->sequence;
+    if ((sequence & 1) != 0 || !__sync_bool_compare_and_swap(&entry->sequence, sequence, sequence + 1)) {
+        /* Another thread is updating the entry. */
+        return;
+    }
+    entry->generation = generation;
+    entry->address = address;
+    entry->found = found;
+    entry->info = *info;
+    __sync_synchronize();
+    entry->sequence = sequence + 2;
+}
+#endif
+
+/*
+ * The code region of the boot image, which has no symbols.
+ */
+static Address bootCodeStart;
+static Address bootCodeEnd;
+
+void log_setBootCodeRange(Address start, Address end) {
+    bootCodeStart = start;
+    bootCodeEnd = end;
+}
+
 void log_print_symbol(Address address) {
+    if (address >= bootCodeStart && address < bootCodeEnd) {
+        log_print("%p(code + %d)", address, (int) (address - bootCodeStart));
+        return;
+    }
 #if !os_MAXVE
     Dl_info info;
-    if (dladdr((void *) address, &info) != 0) {
+    boolean found;
+    if (!lookupSymbol(address, &found, &info)) {
+        Unsigned4 generation = symbolCacheGeneration;
+        __sync_synchronize();
+        found = dladdr((void *) address, &info) != 0;
+        if (!found) {
+            memset(&info, 0, sizeof(info));
+        }
+        cacheSymbol(address, generation, found, &info);
+    }
+    if (found) {
         if (info.dli_sname == NULL) {
             log_print("%s (%p+%d)", info.dli_fname, info.dli_fbase, address - (Address) info.dli_fbase);
             return;
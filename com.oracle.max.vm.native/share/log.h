@@ -35,6 +35,11 @@
  */
 extern void log_initialize(const char *path);
 
+/**
+ * Selects asynchronous logging (Linux and Darwin only). This must be called before log_initialize().
+ */
+extern void log_setAsync(boolean async);
+
 extern void log_lock(void);
 extern void log_unlock(void);
 
@@ -52,6 +57,12 @@ extern void log_print_format(const char *format, ...);
 extern void log_print_vformat(const char *format, va_list ap);
 extern void log_print_newline(void);
 extern void log_print_symbol(Address address);
+
+/**
+ * Discards the symbols cached by log_print_symbol(). This must be called before a library is unloaded.
+ */
+extern void log_forgetSymbols(void);
+extern void log_setBootCodeRange(Address start, Address end);
 extern void log_print_float(float f);
 extern void log_print_double(double d);
 extern void log_flush(void);
@@ -20,12 +20,258 @@
  * or visit www.oracle.com if you need additional information or have any
  * questions.
  */
+#include <stdlib.h>
+#include <string.h>
+
 #include "mutex.h"
+#include "isa.h"
 #include "log.h"
 #include "threads.h"
+#include "spinWait.h"
 
 #define THREAD_MUTEX_FORMAT "thread=%p, mutex=%p"
 
+#if os_LINUX || os_DARWIN
+#include <errno.h>
+#include <limits.h>
+#include <time.h>
+#include <unistd.h>
+#if os_LINUX
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#elif os_DARWIN
+/* The ulock interface of the Darwin kernel (see bsd/sys/ulock.h in xnu). */
+extern int __ulock_wait(Unsigned4 operation, void *address, Unsigned8 value, Unsigned4 timeoutMicros);
+extern int __ulock_wake(Unsigned4 operation, void *address, Unsigned8 wakeValue);
+#define UL_COMPARE_AND_WAIT 1
+#define ULF_WAKE_ALL 0x00000100
+#define ULF_NO_ERRNO 0x01000000
+#endif
+
+/*
+ * The layout of an adaptive mutex within a mutex_Struct.
+ */
+typedef struct {
+    volatile int state;        // one of the ADAPTIVE_* values below
+    int depth;                 // the number of times the owner has (recursively) locked the mutex
+    volatile Address owner;    // pthread_self() of the owner, or 0
+} AdaptiveMutexStruct, *AdaptiveMutex;
+
+/* An adaptive mutex must fit in the space reserved for a mutex_Struct (see nativeMutexSize() in sync.c). */
+typedef char AdaptiveMutexFitsInMutexStruct[sizeof(AdaptiveMutexStruct) <= sizeof(mutex_Struct) ? 1 : -1];
+
+#define ADAPTIVE_UNLOCKED 0
+#define ADAPTIVE_LOCKED 1
+#define ADAPTIVE_CONTENDED 2   // locked and there may be parked threads
+
+/*
+ * The number of times a contending thread checks the mutex before parking.
+ */
+#define ADAPTIVE_SPINS 100
+
+static boolean adaptiveMutexes = false;
+
+/*
+ * Spinning is pointless on a uniprocessor.
+ */
+static int adaptiveSpins = ADAPTIVE_SPINS;
+
+/*
+ * Parks the current thread while *address == expected.
+ *
+ * @param timeoutNanos the maximum time to park, or 0 for no timeout
+ * @return 0 if woken up (possibly spuriously), ETIMEDOUT if the timeout expired or EINTR if interrupted by a signal
+ */
+int mutex_park(volatile int *address, int expected, Signed8 timeoutNanos) {
+#if os_LINUX
+    struct timespec timeout;
+    struct timespec *timeoutPointer = NULL;
+    if (timeoutNanos > 0) {
+        timeout.tv_sec = timeoutNanos / 1000000000LL;
+        timeout.tv_nsec = timeoutNanos % 1000000000LL;
+        timeoutPointer = &timeout;
+    }
+    if (syscall(SYS_futex, address, FUTEX_WAIT_PRIVATE, expected, timeoutPointer, NULL, 0) != 0) {
+        if (errno == ETIMEDOUT || errno == EINTR) {
+            return errno;
+        }
+    }
+    return 0;
+#else
+    Signed8 timeoutMicros = timeoutNanos <= 0 ? 0 : (timeoutNanos + 999) / 1000;
+    if (timeoutMicros > UINT_MAX) {
+        timeoutMicros = UINT_MAX;
+    }
+    int result = __ulock_wait(UL_COMPARE_AND_WAIT | ULF_NO_ERRNO, (void *) address, (Unsigned8) expected, (Unsigned4) timeoutMicros);
+    if (result == -ETIMEDOUT || result == -EINTR) {
+        return -result;
+    }
+    return 0;
+#endif
+}
+
+/*
+ * Unparks one or all of the threads parked on a given address.
+ */
+void mutex_unpark(volatile int *address, boolean all) {
+#if os_LINUX
+    syscall(SYS_futex, address, FUTEX_WAKE_PRIVATE, all ? INT_MAX : 1, NULL, NULL, 0);
+#else
+    __ulock_wake(UL_COMPARE_AND_WAIT | ULF_NO_ERRNO | (all ? ULF_WAKE_ALL : 0), (void *) address, 0);
+#endif
+}
+
+/*
+ * Unparks one of the threads parked on a given address and, if the current thread holds a given
+ * adaptive mutex, moves the others to the queue of the mutex. The moved threads are then unparked
+ * one at a time as the mutex is released instead of all contending for the mutex at once.
+ */
+void mutex_unparkOneAndRequeue(volatile int *address, int expected, Mutex mutex) {
+#if os_LINUX
+    AdaptiveMutex adaptiveMutex = (AdaptiveMutex) mutex;
+    if (adaptiveMutex != NULL && adaptiveMutex->owner == (Address) pthread_self()) {
+        /* The requeued threads must be unparked when the mutex is released. */
+        adaptiveMutex->state = ADAPTIVE_CONTENDED;
+        if (syscall(SYS_futex, address, FUTEX_CMP_REQUEUE_PRIVATE, 1, (void *) (Address) INT_MAX, &adaptiveMutex->state, expected) >= 0) {
+            return;
+        }
+    }
+#endif
+    mutex_unpark(address, true);
+}
+
+void mutex_setAdaptive(boolean adaptive) {
+    adaptiveMutexes = adaptive;
+    adaptiveSpins = sysconf(_SC_NPROCESSORS_ONLN) > 1 ? ADAPTIVE_SPINS : 0;
+}
+
+boolean mutex_isAdaptive(void) {
+    return adaptiveMutexes;
+}
+
+/*
+ * Acquires an adaptive mutex that is known not to be owned by the current thread.
+ * This is the three state mutex of Drepper's "Futexes Are Tricky".
+ */
+static void adaptiveLock(AdaptiveMutex mutex) {
+    int state = __sync_val_compare_and_swap(&mutex->state, ADAPTIVE_UNLOCKED, ADAPTIVE_LOCKED);
+    if (state != ADAPTIVE_UNLOCKED) {
+        int spins;
+        for (spins = 0; spins < adaptiveSpins; spins++) {
+            spinWait_pause();
+            state = mutex->state;
+            if (state == ADAPTIVE_UNLOCKED) {
+                state = __sync_val_compare_and_swap(&mutex->state, ADAPTIVE_UNLOCKED, ADAPTIVE_LOCKED);
+                if (state == ADAPTIVE_UNLOCKED) {
+                    break;
+                }
+            }
+            if (state == ADAPTIVE_CONTENDED) {
+                /* Other threads have already given up spinning: the critical section is not short. */
+                break;
+            }
+        }
+        if (state != ADAPTIVE_UNLOCKED) {
+            if (state != ADAPTIVE_CONTENDED) {
+                state = __sync_lock_test_and_set(&mutex->state, ADAPTIVE_CONTENDED);
+            }
+            while (state != ADAPTIVE_UNLOCKED) {
+                mutex_park(&mutex->state, ADAPTIVE_CONTENDED, 0);
+                state = __sync_lock_test_and_set(&mutex->state, ADAPTIVE_CONTENDED);
+            }
+        }
+    }
+    mutex->owner = (Address) pthread_self();
+    mutex->depth = 1;
+}
+
+/*
+ * Acquires an adaptive mutex, leaving it in the contended state. This is used by threads returning from
+ * a condition wait as other waiters may have been requeued on the mutex (see mutex_unparkOneAndRequeue()).
+ */
+static void adaptiveLockContended(AdaptiveMutex mutex) {
+    while (__sync_lock_test_and_set(&mutex->state, ADAPTIVE_CONTENDED) != ADAPTIVE_UNLOCKED) {
+        mutex_park(&mutex->state, ADAPTIVE_CONTENDED, 0);
+    }
+    mutex->owner = (Address) pthread_self();
+    mutex->depth = 1;
+}
+
+static void adaptiveUnlock(AdaptiveMutex mutex) {
+    mutex->owner = 0;
+    mutex->depth = 0;
+    if (__sync_fetch_and_sub(&mutex->state, 1) != ADAPTIVE_LOCKED) {
+        mutex->state = ADAPTIVE_UNLOCKED;
+        __sync_synchronize();
+        mutex_unpark(&mutex->state, false);
+    }
+}
+
+static int adaptiveEnter(AdaptiveMutex mutex) {
+    if (mutex->owner == (Address) pthread_self()) {
+        mutex->depth++;
+        return 0;
+    }
+    adaptiveLock(mutex);
+    return 0;
+}
+
+static int adaptiveTryEnter(AdaptiveMutex mutex) {
+    if (mutex->owner == (Address) pthread_self()) {
+        mutex->depth++;
+        return 0;
+    }
+    if (__sync_val_compare_and_swap(&mutex->state, ADAPTIVE_UNLOCKED, ADAPTIVE_LOCKED) != ADAPTIVE_UNLOCKED) {
+        return EBUSY;
+    }
+    mutex->owner = (Address) pthread_self();
+    mutex->depth = 1;
+    return 0;
+}
+
+static int adaptiveExit(AdaptiveMutex mutex) {
+    if (mutex->owner != (Address) pthread_self()) {
+        return EPERM;
+    }
+    if (--mutex->depth == 0) {
+        adaptiveUnlock(mutex);
+    }
+    return 0;
+}
+
+/*
+ * Releases an adaptive mutex held by the current thread, regardless of its recursion depth.
+ *
+ * @return the recursion depth to be passed to mutex_reacquire()
+ */
+int mutex_releaseAll(Mutex mutex) {
+    AdaptiveMutex adaptiveMutex = (AdaptiveMutex) mutex;
+    c_ASSERT(adaptiveMutex->owner == (Address) pthread_self());
+    int depth = adaptiveMutex->depth;
+    adaptiveUnlock(adaptiveMutex);
+    return depth;
+}
+
+/*
+ * Reacquires an adaptive mutex released by mutex_releaseAll().
+ */
+void mutex_reacquire(Mutex mutex, int depth) {
+    AdaptiveMutex adaptiveMutex = (AdaptiveMutex) mutex;
+    adaptiveLockContended(adaptiveMutex);
+    adaptiveMutex->depth = depth;
+}
+
+#else
+
+void mutex_setAdaptive(boolean adaptive) {
+}
+
+boolean mutex_isAdaptive(void) {
+    return false;
+}
+
+#endif
+
 void mutex_initialize(Mutex mutex) {
 #if log_MONITORS
     log_println("mutex_initialize(" THREAD_MUTEX_FORMAT ")", thread_self(), mutex);
@@ -35,6 +281,10 @@ void mutex_initialize(Mutex mutex) {
         c_ASSERT(false);
     }
 #elif os_LINUX || os_DARWIN
+    if (adaptiveMutexes) {
+        memset((void *) mutex, 0, sizeof(mutex_Struct));
+        return;
+    }
     pthread_mutexattr_t mutex_attribute;
     if (pthread_mutexattr_init(&mutex_attribute) != 0) {
         c_ASSERT(false);
@@ -55,10 +305,13 @@ void mutex_initialize(Mutex mutex) {
 #   endif
 }
 
-int mutex_enter_nolog(Mutex mutex) {
+static int lockMutex(Mutex mutex) {
 #if os_SOLARIS
     return mutex_lock(mutex);
 #elif os_LINUX || os_DARWIN
+    if (adaptiveMutexes) {
+        return adaptiveEnter((AdaptiveMutex) mutex);
+    }
     return pthread_mutex_lock(mutex);
 #elif os_MAXVE
     if (maxve_monitor_enter(*mutex) != 0) {
@@ -70,10 +323,13 @@ int mutex_enter_nolog(Mutex mutex) {
 #endif
 }
 
-int mutex_try_enter(Mutex mutex) {
+static int tryLockMutex(Mutex mutex) {
 #if os_SOLARIS
     return mutex_trylock(mutex);
 #elif os_LINUX || os_DARWIN
+    if (adaptiveMutexes) {
+        return adaptiveTryEnter((AdaptiveMutex) mutex);
+    }
     return pthread_mutex_trylock(mutex);
 #else
     c_UNIMPLEMENTED();
@@ -81,17 +337,13 @@ int mutex_try_enter(Mutex mutex) {
 
 }
 
-int mutex_enter(Mutex mutex) {
-#if log_MONITORS
-    log_println("mutex_enter     (" THREAD_MUTEX_FORMAT ")", thread_self(), mutex);
-#endif
-    return mutex_enter_nolog(mutex);
-}
-
-int mutex_exit_nolog(Mutex mutex) {
+static int unlockMutex(Mutex mutex) {
 #if os_SOLARIS
     return mutex_unlock(mutex);
 #elif os_LINUX || os_DARWIN
+    if (adaptiveMutexes) {
+        return adaptiveExit((AdaptiveMutex) mutex);
+    }
     return pthread_mutex_unlock(mutex);
 #elif os_MAXVE
     if (maxve_monitor_exit(*mutex) != 0) {
@@ -103,6 +355,245 @@ int mutex_exit_nolog(Mutex mutex) {
 #endif
 }
 
+#if os_LINUX || os_DARWIN
+
+/*
+ * The native mutex contention profiler (-XX:NativeMutexProfile=<period>). One in every 'period'
+ * acquisitions by a thread is sampled: it is counted, checked for contention with a non-blocking
+ * attempt, timed if it has to wait, and the time for which the mutex is then held is measured.
+ * All the statistics of a mutex are updated while holding the mutex so no atomic updates are needed.
+ */
+typedef struct {
+    volatile Address mutex;    // the profiled mutex, or 0 if the entry is free
+    Unsigned8 acquires;
+    Unsigned8 contended;
+    Unsigned8 waitNanos;
+    Unsigned8 maxHoldNanos;
+    Address holder;            // the thread timing a sampled hold, or 0
+    int holdDepth;
+    Unsigned8 holdStartNanos;
+} MutexProfileStruct, *MutexProfile;
+
+/*
+ * The number of mutexes that can be profiled. This must be a power of 2.
+ */
+#define MUTEX_PROFILE_ENTRIES 1024
+
+static MutexProfile mutexProfiles;
+
+static int mutexProfilePeriod;
+
+static __thread int mutexProfileCountdown;
+
+/*
+ * The number of sampled holds being timed by the current thread.
+ */
+static __thread int mutexProfileHolds;
+
+static Unsigned8 profileNanos(void) {
+    struct timespec tp;
+    clock_gettime(CLOCK_MONOTONIC, &tp);
+    return (Unsigned8) tp.tv_sec * 1000000000ULL + tp.tv_nsec;
+}
+
+void mutex_setProfilePeriod(int period) {
+    if (period > 0 && mutexProfiles == NULL) {
+        mutexProfiles = (MutexProfile) calloc(MUTEX_PROFILE_ENTRIES, sizeof(MutexProfileStruct));
+        if (mutexProfiles == NULL) {
+            return;
+        }
+    }
+    mutexProfilePeriod = period > 0 ? period : 0;
+}
+
+/*
+ * Gets the profile entry for a given mutex.
+ *
+ * @param create specifies if an entry is to be allocated for the mutex if it does not have one
+ * @return NULL if the mutex has no entry and one could not be (or was not to be) allocated
+ */
+static MutexProfile getProfile(Mutex mutex, boolean create) {
+    Address address = (Address) mutex;
+    Address index = ((address >> 3) * 0x9E3779B97F4A7C15ULL) >> 32;
+    int probes;
+    for (probes = 0; probes < MUTEX_PROFILE_ENTRIES; probes++) {
+        MutexProfile profile = &mutexProfiles[(index + probes) & (MUTEX_PROFILE_ENTRIES - 1)];
+        Address entry = profile->mutex;
+        if (entry == address) {
+            return profile;
+        }
+        if (entry == 0) {
+            if (!create) {
+                return NULL;
+            }
+            entry = __sync_val_compare_and_swap(&profile->mutex, 0, address);
+            if (entry == 0 || entry == address) {
+                return profile;
+            }
+        }
+    }
+    return NULL;
+}
+
+static void startHold(MutexProfile profile) {
+    Address self = (Address) pthread_self();
+    if (profile->holder == self) {
+        profile->holdDepth++;
+    } else {
+        profile->holder = self;
+        profile->holdDepth = 1;
+        profile->holdStartNanos = profileNanos();
+        mutexProfileHolds++;
+    }
+}
+
+static void endHold(MutexProfile profile) {
+    Unsigned8 hold = profileNanos() - profile->holdStartNanos;
+    if (hold > profile->maxHoldNanos) {
+        profile->maxHoldNanos = hold;
+    }
+    profile->holder = 0;
+    mutexProfileHolds--;
+}
+
+static int profiledLock(Mutex mutex, boolean block) {
+    boolean sampled = --mutexProfileCountdown <= 0;
+    if (!sampled && mutexProfileHolds == 0) {
+        return block ? lockMutex(mutex) : tryLockMutex(mutex);
+    }
+    MutexProfile profile = getProfile(mutex, sampled);
+    if (profile == NULL) {
+        return block ? lockMutex(mutex) : tryLockMutex(mutex);
+    }
+    if (!sampled) {
+        int result = block ? lockMutex(mutex) : tryLockMutex(mutex);
+        if (result == 0 && profile->holder == (Address) pthread_self()) {
+            profile->holdDepth++;
+        }
+        return result;
+    }
+    mutexProfileCountdown = mutexProfilePeriod;
+    int result = tryLockMutex(mutex);
+    if (result != 0) {
+        if (!block) {
+            return result;
+        }
+        Unsigned8 start = profileNanos();
+        result = lockMutex(mutex);
+        if (result != 0) {
+            return result;
+        }
+        profile->contended++;
+        profile->waitNanos += profileNanos() - start;
+    }
+    profile->acquires++;
+    startHold(profile);
+    return 0;
+}
+
+static int profiledUnlock(Mutex mutex) {
+    if (mutexProfileHolds != 0) {
+        MutexProfile profile = getProfile(mutex, false);
+        if (profile != NULL && profile->holder == (Address) pthread_self() && --profile->holdDepth == 0) {
+            endHold(profile);
+        }
+    }
+    return unlockMutex(mutex);
+}
+
+void mutex_profileWait(Mutex mutex) {
+    if (mutexProfileHolds != 0) {
+        MutexProfile profile = getProfile(mutex, false);
+        if (profile != NULL && profile->holder == (Address) pthread_self()) {
+            endHold(profile);
+        }
+    }
+}
+
+static int compareProfiles(const void *a, const void *b) {
+    Unsigned8 waitA = (*(MutexProfile *) a)->waitNanos;
+    Unsigned8 waitB = (*(MutexProfile *) b)->waitNanos;
+    return waitA < waitB ? 1 : (waitA > waitB ? -1 : 0);
+}
+
+void mutex_printProfile(void) {
+    if (mutexProfiles == NULL) {
+        return;
+    }
+    MutexProfile *sorted = (MutexProfile *) calloc(MUTEX_PROFILE_ENTRIES, sizeof(MutexProfile));
+    if (sorted == NULL) {
+        return;
+    }
+    int n = 0;
+    int i;
+    for (i = 0; i < MUTEX_PROFILE_ENTRIES; i++) {
+        if (mutexProfiles[i].acquires != 0) {
+            sorted[n++] = &mutexProfiles[i];
+        }
+    }
+    qsort(sorted, n, sizeof(MutexProfile), compareProfiles);
+
+    log_lock();
+    log_println("Native mutex profile (1 in %d acquisitions sampled, counts and wait times are estimates):", mutexProfilePeriod);
+    log_println("%18s %12s %12s %12s %14s  %s", "mutex", "acquires", "contended", "wait (us)", "max hold (us)", "symbol");
+    Unsigned8 scale = mutexProfilePeriod;
+    for (i = 0; i < n; i++) {
+        MutexProfile profile = sorted[i];
+        log_print("%18p %12llu %12llu %12llu %14llu  ", (void *) profile->mutex,
+                        profile->acquires * scale, profile->contended * scale,
+                        (profile->waitNanos * scale) / 1000, profile->maxHoldNanos / 1000);
+        log_print_symbol(profile->mutex);
+        log_print_newline();
+    }
+    log_unlock();
+    free(sorted);
+}
+
+#else
+
+void mutex_setProfilePeriod(int period) {
+}
+
+void mutex_profileWait(Mutex mutex) {
+}
+
+void mutex_printProfile(void) {
+}
+
+#define mutexProfilePeriod 0
+#define profiledLock(mutex, block) 0
+#define profiledUnlock(mutex) 0
+
+#endif
+
+int mutex_enter_nolog(Mutex mutex) {
+    if (mutexProfilePeriod != 0) {
+        return profiledLock(mutex, true);
+    }
+    return lockMutex(mutex);
+}
+
+int mutex_try_enter(Mutex mutex) {
+    if (mutexProfilePeriod != 0) {
+        return profiledLock(mutex, false);
+    }
+    return tryLockMutex(mutex);
+}
+
+int mutex_exit_nolog(Mutex mutex) {
+    if (mutexProfilePeriod != 0) {
+        return profiledUnlock(mutex);
+    }
+    return unlockMutex(mutex);
+}
+
+int mutex_enter(Mutex mutex) {
+#if log_MONITORS
+    log_println("mutex_enter     (" THREAD_MUTEX_FORMAT ")", thread_self(), mutex);
+#endif
+    return mutex_enter_nolog(mutex);
+}
+
 int mutex_exit(Mutex mutex) {
 #if log_MONITORS
     log_println("mutex_exit     (" THREAD_MUTEX_FORMAT ")", thread_self(), mutex);
@@ -119,6 +610,10 @@ void mutex_dispose(Mutex mutex) {
         c_ASSERT(false);
     }
 #elif os_LINUX || os_DARWIN
+    if (adaptiveMutexes) {
+        c_ASSERT(((AdaptiveMutex) mutex)->state == ADAPTIVE_UNLOCKED);
+        return;
+    }
     if (pthread_mutex_destroy(mutex) != 0) {
         c_ASSERT(false);
     }
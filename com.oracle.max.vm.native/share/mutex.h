@@ -24,6 +24,7 @@
 #define __mutex_h__ 1
 
 #include "os.h"
+#include "c.h"
 
 #if (os_DARWIN || os_LINUX)
 #   include <pthread.h>
@@ -49,4 +50,38 @@ extern int mutex_exit(Mutex mutex);
 extern int mutex_enter_nolog(Mutex mutex);
 extern int mutex_exit_nolog(Mutex mutex);
 
+/*
+ * Adaptive mutexes (Linux and Darwin only) keep their state in a single word of the mutex_Struct.
+ * A thread that finds an adaptive mutex locked spins briefly before parking on a futex (a ulock
+ * on Darwin) so short critical sections do not incur context switches. The kind of mutex (and of
+ * condition variables, see condition.c) must be selected before any mutex is initialized.
+ */
+extern void mutex_setAdaptive(boolean adaptive);
+extern boolean mutex_isAdaptive(void);
+
+/*
+ * Support for condition variables paired with adaptive mutexes.
+ */
+extern int mutex_releaseAll(Mutex mutex);
+extern void mutex_reacquire(Mutex mutex, int depth);
+extern int mutex_park(volatile int *address, int expected, Signed8 timeoutNanos);
+extern void mutex_unpark(volatile int *address, boolean all);
+extern void mutex_unparkOneAndRequeue(volatile int *address, int expected, Mutex mutex);
+
+/*
+ * The native mutex contention profiler (Linux and Darwin only). Every 'period'th acquisition of a
+ * mutex by a thread is sampled. A period of 0 disables the profiler.
+ */
+extern void mutex_setProfilePeriod(int period);
+
+/*
+ * Notifies the profiler that the current thread is about to release a mutex by waiting on a condition variable.
+ */
+extern void mutex_profileWait(Mutex mutex);
+
+/*
+ * Prints the profiled mutexes to the log, in decreasing order of the time threads have waited to acquire them.
+ */
+extern void mutex_printProfile(void);
+
 #endif /*__mutex_h__*/
@@ -21,6 +21,7 @@
  * questions.
  */
 #include "os.h"
+#include "isa.h"
 #include <stdlib.h>
 
 #include "log.h"
@@ -29,25 +30,82 @@
 #include "dataio.h"
 #include "relocation.h"
 
+#if !os_MAXVE
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
 #define DEBUG_RELOCATION 0
 
-#define RELOCATION_LOOP(wordType, getWord, putWord) do { \
-        for (i = 0; i < relocationDataSize; i++) { \
+/*
+ * The implementations of the relocation loop. These values must match those in BootImageRelocationBenchmark.java.
+ */
+#define RELOCATION_KERNEL_BYTEWISE 0
+#define RELOCATION_KERNEL_WORDWISE 1
+
+/*
+ * Relocation bitmaps smaller than this (in bytes) are always processed by the calling thread.
+ * With 8-byte words, this corresponds to 32MB of boot heap and code per thread.
+ */
+#define PARALLEL_RELOCATION_CHUNK_SIZE (512 * 1024)
+
+/*
+ * Upper bound on the number of threads used to relocate a boot image.
+ * Beyond this, relocation is bound by memory bandwidth rather than processing.
+ */
+#define MAX_RELOCATION_THREADS 32
+
+/*
+ * Where available, blocks of 16 bitmap bytes are tested for zero with a single SIMD comparison.
+ * Only the baseline instruction sets (SSE2 on AMD64, NEON on AArch64) are used as the native
+ * code is not compiled with support for wider vector extensions.
+ */
+#if isa_AMD64 && defined(__SSE2__)
+#include <emmintrin.h>
+#define ZERO_BLOCK_SIZE 16
+static inline boolean isZeroBlock(Byte *p) {
+    __m128i block = _mm_loadu_si128((__m128i *) p);
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(block, _mm_setzero_si128())) == 0xffff;
+}
+#elif isa_AARCH64 && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define ZERO_BLOCK_SIZE 16
+static inline boolean isZeroBlock(Byte *p) {
+    return vmaxvq_u8(vld1q_u8(p)) == 0;
+}
+#else
+#define ZERO_BLOCK_SIZE 0
+static inline boolean isZeroBlock(Byte *p) {
+    return false;
+}
+#endif
+
+#define RELOCATE_WORD(wordType, getWord, putWord, offset) do { \
+        Address p = (base + (offset)); \
+        wordType value = getWord(p); \
+        if (value != (wordType) 0) { \
+            if (DEBUG_RELOCATION) { \
+                log_println("%p: %p -> %p", p, value, value + relocatedHeap); \
+            } \
+            value = value + relocatedHeap; \
+            putWord(p, value); \
+        } \
+    } while (0)
+
+/*
+ * The original relocation loop, testing the bit map one bit at a time.
+ * It is retained as a reference for BootImageRelocationBenchmark.
+ */
+#define RELOCATION_LOOP_BYTEWISE(wordType, getWord, putWord) do { \
+        Size dataOffset = ((Size) start) * 8 * wordSize; \
+        for (i = start; i < end; i++) { \
             Byte byte = bytes[i]; \
             if (byte == 0) { \
                 dataOffset += 8 * wordSize; \
             } else { \
                 for (bit = 0; bit < 8; bit++) { \
                     if ((byte & (1 << bit)) != 0) { \
-                        Address p = (base + dataOffset); \
-                        wordType value = getWord(p); \
-                        if (value != (wordType) 0) { \
-                            if (DEBUG_RELOCATION) { \
-                                log_println("%p: %p -> %p", p, value, value + relocatedHeap); \
-                            } \
-                            value = value + relocatedHeap; \
-                            putWord(p, value); \
-                        } \
+                        RELOCATE_WORD(wordType, getWord, putWord, dataOffset); \
                     } \
                     dataOffset += wordSize; \
                 } \
@@ -55,6 +113,149 @@
         } \
     } while (0)
 
+/*
+ * Scans the bit map 64 bits at a time, skipping empty words (or blocks of ZERO_BLOCK_SIZE
+ * bytes) and going straight to each set bit with count-trailing-zeros. The bytes of the
+ * bit map are read as a little endian word so that bit 'n' of the word denotes the same
+ * heap word as bit 'n % 8' of byte 'n / 8'.
+ */
+#define RELOCATION_LOOP(wordType, getWord, putWord) do { \
+        i = start; \
+        while (i < end) { \
+            Unsigned8 bits; \
+            int n; \
+            if (ZERO_BLOCK_SIZE != 0 && i + ZERO_BLOCK_SIZE <= end && isZeroBlock(&bytes[i])) { \
+                i += ZERO_BLOCK_SIZE; \
+                continue; \
+            } \
+            if (i + 8 <= end) { \
+                bits = readLittleEndianUnsigned8((Address) &bytes[i]); \
+                n = 8; \
+            } else { \
+                bits = bytes[i]; \
+                n = 1; \
+            } \
+            if (bits != 0) { \
+                Size firstWord = ((Size) i) * 8; \
+                do { \
+                    bit = __builtin_ctzll(bits); \
+                    bits &= bits - 1; \
+                    RELOCATE_WORD(wordType, getWord, putWord, (firstWord + bit) * wordSize); \
+                } while (bits != 0); \
+            } \
+            i += n; \
+        } \
+    } while (0)
+
+#define RELOCATION_KERNEL(loop) do { \
+        if (wordSize == sizeof(Unsigned4)) { \
+            if (isBigEndian) { \
+                loop(Unsigned4, readBigEndianUnsigned4, writeBigEndianUnsigned4); \
+            } else { \
+                loop(Unsigned4, readLittleEndianUnsigned4, writeLittleEndianUnsigned4); \
+            } \
+        } else if (wordSize == sizeof(Unsigned8)) { \
+            if (isBigEndian) { \
+                loop(Unsigned8, readBigEndianUnsigned8, writeBigEndianUnsigned8); \
+            } else { \
+                loop(Unsigned8, readLittleEndianUnsigned8, writeLittleEndianUnsigned8); \
+            } \
+        } else { \
+            log_println("wordSize=%d", wordSize); \
+            c_ASSERT(false); \
+        } \
+    } while (0)
+
+/**
+ * Relocates the pointers denoted by the bytes in the range '[start .. end)' of a relocation bit map.
+ *
+ * @param kernel RELOCATION_KERNEL_WORDWISE or RELOCATION_KERNEL_BYTEWISE
+ */
+static void relocateRange(Address base, Address relocatedHeap, Byte *bytes, int start, int end, int isBigEndian, int wordSize, int kernel) {
+    int i, bit;
+
+    if (kernel == RELOCATION_KERNEL_BYTEWISE) {
+        RELOCATION_KERNEL(RELOCATION_LOOP_BYTEWISE);
+    } else {
+        RELOCATION_KERNEL(RELOCATION_LOOP);
+    }
+}
+
+#if !os_MAXVE
+
+typedef struct RelocationTask {
+    Address base;
+    Address relocatedHeap;
+    Byte *bytes;
+    int start;
+    int end;
+    int isBigEndian;
+    int wordSize;
+    int kernel;
+} RelocationTask;
+
+static void *relocationTask_run(void *arg) {
+    RelocationTask *task = (RelocationTask *) arg;
+    relocateRange(task->base, task->relocatedHeap, task->bytes, task->start, task->end, task->isBigEndian, task->wordSize, task->kernel);
+    return NULL;
+}
+
+/**
+ * Splits the relocation bit map into 'numberOfThreads' contiguous ranges, each relocated by its own thread.
+ * The calling thread relocates the first range. If a thread cannot be started, its range is relocated
+ * by the calling thread instead.
+ */
+static void relocateInParallel(Address base, Address relocatedHeap, Byte *bytes, int relocationDataSize, int isBigEndian, int wordSize, int kernel, int numberOfThreads) {
+    RelocationTask tasks[MAX_RELOCATION_THREADS];
+    pthread_t threads[MAX_RELOCATION_THREADS];
+    boolean started[MAX_RELOCATION_THREADS];
+    int rangeSize = (relocationDataSize + numberOfThreads - 1) / numberOfThreads;
+    int t;
+
+    for (t = 0; t < numberOfThreads; t++) {
+        RelocationTask *task = &tasks[t];
+        task->base = base;
+        task->relocatedHeap = relocatedHeap;
+        task->bytes = bytes;
+        task->start = t * rangeSize;
+        task->end = task->start + rangeSize > relocationDataSize ? relocationDataSize : task->start + rangeSize;
+        task->isBigEndian = isBigEndian;
+        task->wordSize = wordSize;
+        task->kernel = kernel;
+        started[t] = t != 0 && pthread_create(&threads[t], NULL, relocationTask_run, task) == 0;
+    }
+    relocationTask_run(&tasks[0]);
+    for (t = 1; t < numberOfThreads; t++) {
+        if (started[t]) {
+            pthread_join(threads[t], NULL);
+        } else {
+            relocationTask_run(&tasks[t]);
+        }
+    }
+}
+
+#endif
+
+static void relocate(void *heap, Address relocatedHeap, void *relocationData, int relocationDataSize, int isBigEndian, int wordSize, int kernel, int maxThreads) {
+    Address base = (Address) heap;
+    Byte *bytes = (Byte *) relocationData;
+    int numberOfThreads = relocationDataSize / PARALLEL_RELOCATION_CHUNK_SIZE;
+
+    if (numberOfThreads > maxThreads) {
+        numberOfThreads = maxThreads;
+    }
+    if (numberOfThreads > MAX_RELOCATION_THREADS) {
+        numberOfThreads = MAX_RELOCATION_THREADS;
+    }
+#if !os_MAXVE
+    if (numberOfThreads > 1) {
+        relocateInParallel(base, relocatedHeap, bytes, relocationDataSize, isBigEndian, wordSize, kernel, numberOfThreads);
+        return;
+    }
+#endif
+    relocateRange(base, relocatedHeap, bytes, 0, relocationDataSize, isBigEndian, wordSize, kernel);
+}
+
 /**
  * Relocates the pointers in the heap and code. All the pointers are assumed to be
  * canonicalized; their current values assume that the heap and code start address 0.
@@ -63,37 +264,36 @@
  * @param relocatedHeap the logical address to which the heap and code is being relocated
  * @param relocationData the bit map denoting where all the pointers are in the heap and code
  * @param relocationDataSize the size (in bytes) of the bit map
+ * @param maxThreads the maximum number of threads that may be used to perform the relocation
  */
-void relocation_apply(void *heap, Address relocatedHeap, void *relocationData, int relocationDataSize, int isBigEndian, int wordSize) {
-    int i, bit;
-    Address base = (Address) heap;
-    Byte *bytes = (Byte *) relocationData;
-    int dataOffset = 0;
+void relocation_apply(void *heap, Address relocatedHeap, void *relocationData, int relocationDataSize, int isBigEndian, int wordSize, int maxThreads) {
+    relocate(heap, relocatedHeap, relocationData, relocationDataSize, isBigEndian, wordSize, RELOCATION_KERNEL_WORDWISE, maxThreads);
+}
 
-    if (wordSize == sizeof(Unsigned4)) {
-        if (isBigEndian) {
-            RELOCATION_LOOP(Unsigned4, readBigEndianUnsigned4, writeBigEndianUnsigned4);
-        } else {
-            RELOCATION_LOOP(Unsigned4, readLittleEndianUnsigned4, writeLittleEndianUnsigned4);
-        }
-    } else if (wordSize == sizeof(Unsigned8)) {
-        if (isBigEndian) {
-            RELOCATION_LOOP(Unsigned8, readBigEndianUnsigned8, writeBigEndianUnsigned8);
-        } else {
-            RELOCATION_LOOP(Unsigned8, readLittleEndianUnsigned8, writeLittleEndianUnsigned8);
-        }
-    } else {
-        log_println("wordSize=%d", wordSize);
-        c_ASSERT(false);
-    }
+static int onlineProcessorCount(void) {
+#if os_MAXVE
+    return 1;
+#else
+    return (int) sysconf(_SC_NPROCESSORS_ONLN);
+#endif
 }
 
 JNIEXPORT void JNICALL
 Java_com_sun_max_vm_hosted_BootImage_nativeRelocate(JNIEnv *env, jclass c, jlong heap, jlong relocatedHeap,
                                                        jbyteArray relocationData, jint relocationDataSize,
                                                        jint isBigEndian, jint wordSize) {
+    /* Pinned rather than copied: relocation makes no JNI calls and the bit map can be tens of megabytes. */
+    jbyte *bytes = (*env)->GetPrimitiveArrayCritical(env, relocationData, NULL);
+    relocation_apply((void *) (Address) heap, (Address) relocatedHeap, bytes, relocationDataSize, isBigEndian, wordSize, onlineProcessorCount());
+    (*env)->ReleasePrimitiveArrayCritical(env, relocationData, bytes, JNI_ABORT);
+}
+
+JNIEXPORT void JNICALL
+Java_com_sun_max_vm_hosted_BootImageRelocationBenchmark_nativeRelocate(JNIEnv *env, jclass c, jlong heap, jlong relocatedHeap,
+                                                       jbyteArray relocationData, jint relocationDataSize,
+                                                       jint isBigEndian, jint wordSize, jint kernel, jint maxThreads) {
     jboolean isCopy;
     jbyte *bytes = (*env)->GetByteArrayElements(env, relocationData, &isCopy);
-    relocation_apply((void *) (Address) heap, (Address) relocatedHeap, bytes, relocationDataSize, isBigEndian, wordSize);
+    relocate((void *) (Address) heap, (Address) relocatedHeap, bytes, relocationDataSize, isBigEndian, wordSize, kernel, maxThreads);
     (*env)->ReleaseByteArrayElements(env, relocationData, bytes, JNI_ABORT);
 }
@@ -25,7 +25,11 @@
 
 #include "word.h"
 
-extern void relocation_apply(void *heap, Address base, void *relocationData, int relocationDataSize, int isBigEndian, int wordSize);
+/**
+ * Relocates the pointers in the heap and code, in parallel if the relocation data
+ * is large enough and 'maxThreads' is greater than 1 (see relocation.c).
+ */
+extern void relocation_apply(void *heap, Address base, void *relocationData, int relocationDataSize, int isBigEndian, int wordSize, int maxThreads);
 
 #endif /*__relocation_h__*/
 
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2011, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ */
+#include <unistd.h>
+#include "os.h"
+#include "isa.h"
+#include "cacheTopology.h"
+#include "spinWait.h"
+
+#if os_DARWIN || os_LINUX
+#include <sched.h>
+#elif os_SOLARIS
+#include <thread.h>
+#elif os_MAXVE
+#include "maxve.h"
+#endif
+
+/*
+ * The number of rounds that spin before spinWait() yields, and the largest number of pauses
+ * (as a power of 2) in one of them.
+ */
+#define SPIN_ROUNDS 10
+#define SPIN_BACKOFF_SHIFT 6
+
+/* Until spinWait_initialize() is called, every round yields. */
+static int spinRounds = 0;
+static int spinBackoffShift = SPIN_BACKOFF_SHIFT;
+
+void spinWait_initialize(void) {
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    long l3Sharing = cacheTopology_get()[CACHE_L3_SHARING];
+    spinBackoffShift = SPIN_BACKOFF_SHIFT;
+    if (l3Sharing > 0 && processors > l3Sharing) {
+        /*
+         * The other thread may be behind another last level cache, where each poll of the line it will
+         * write costs a cross-cache transfer: poll less often.
+         */
+        spinBackoffShift += 2;
+    }
+    /* Spinning is pointless on a uniprocessor: the thread being waited for cannot run. */
+    spinRounds = processors > 1 ? SPIN_ROUNDS : 0;
+}
+
+void spinWait_onSpinWait(void) {
+    spinWait_pause();
+}
+
+static void yieldProcessor(void) {
+#if os_DARWIN || os_LINUX
+    sched_yield();
+#elif os_SOLARIS
+    thr_yield();
+#elif os_MAXVE
+    maxve_yield();
+#endif
+}
+
+void spinWait_adaptive(jint round) {
+    if (round < spinRounds) {
+        int pauses = 1 << (round < spinBackoffShift ? round : spinBackoffShift);
+        while (pauses-- > 0) {
+            spinWait_pause();
+        }
+    } else {
+        yieldProcessor();
+    }
+}
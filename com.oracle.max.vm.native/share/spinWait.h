@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2011, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ */
+#ifndef __spinWait_h__
+#define __spinWait_h__ 1
+
+#include "jni.h"
+#include "isa.h"
+
+/*
+ * Tells the CPU that the current thread is in a spin-wait loop, so that it can give the
+ * resources of the core to its sibling hardware threads and avoid the memory order
+ * mis-speculation on leaving the loop. This is a hint: it never enters the kernel.
+ */
+static inline void spinWait_pause(void) {
+#if isa_AMD64 || isa_IA32
+    __asm__ __volatile__("pause");
+#elif isa_AARCH64
+    /* 'yield' is a no-op on most cores whereas 'isb' actually delays the thread for a short while. */
+    __asm__ __volatile__("isb" : : : "memory");
+#elif isa_ARM
+    __asm__ __volatile__("yield");
+#elif isa_RISCV64
+    /* The Zihintpause 'pause' instruction, encoded as a hint so that older assemblers and cores accept it. */
+    __asm__ __volatile__(".word 0x0100000f");
+#endif
+}
+
+/**
+ * Derives how long spinWait_adaptive() spins from the number of CPUs and the cache topology. This reads
+ * sysfs and so is done once while the VM starts, before any Java code runs.
+ */
+extern void spinWait_initialize(void);
+
+/**
+ * Called by the VM for Thread.onSpinWait().
+ */
+extern void spinWait_onSpinWait(void);
+
+/**
+ * Waits briefly for a condition that another thread is expected to establish soon. The first rounds
+ * spin on the CPU, backing off exponentially, and the later ones yield the CPU to other threads.
+ * How long to spin is derived from the number of CPUs and the cache topology.
+ *
+ * @param round the number of times the caller has already waited for the same condition, starting at 0
+ */
+extern void spinWait_adaptive(jint round);
+
+#endif /*__spinWait_h__*/
@@ -31,6 +31,7 @@
 #include "threadLocals.h"
 #include "virtualMemory.h"
 #include "mutex.h"
+#include "sampler.h"
 
 #if (os_DARWIN || os_LINUX)
 #   include <pthread.h>
@@ -52,32 +53,111 @@
 
 int theTLASize = -1;
 
+/**
+ * Specifies if each thread locals block is placed on the NUMA node of the thread that owns it.
+ */
+static boolean bindToLocalNode = false;
+
+void threadLocalsBlock_setNUMALocal(boolean value) {
+    bindToLocalNode = value;
+}
+
 /**
  * The global key used to retrieve a ThreadLocals object for a thread.
  */
 static ThreadLocalsKey theThreadLocalsKey;
 
-static Address allocateThreadLocalBlock(size_t tlBlockSize) {
-#if os_MAXVE
-	return (Address) maxve_virtualMemory_allocate(tlBlockSize, DATA_VM);
-#elif os_DARWIN
-	Address result;
-	if (posix_memalign((void**)&result, 4096, tlBlockSize) != 0) {
-		printf("posix_memalign failed\n");
-	}
-	return result;
-#else
-	c_ASSERT(tlBlockSize < 100000000);
-    return (Address) aligned_alloc(4096, tlBlockSize);
+#if os_DARWIN || os_LINUX
+/**
+ * A copy of the value associated with theThreadLocalsKey for the current thread. Reading it
+ * avoids the library call (pthread_getspecific) on the paths that query the current thread
+ * locals at high rates such as JNI entry and the trap handler. The initial-exec model makes
+ * each access a single load relative to the thread pointer (which is also async-signal-safe).
+ * The key is still needed so that threadLocalsBlock_destroy() is called when a thread exits.
+ */
+#define THREAD_LOCALS_FAST_PATH 1
+static __thread Address theCurrentThreadLocalsBlock __attribute__((tls_model("initial-exec")));
 #endif
+
+/**
+ * A bounded pool of thread locals blocks released by terminated threads. As the size of a block is
+ * derived from the stack size of its thread, a pooled block is only reused for a thread with the
+ * same stack size. This takes the allocation (and page zeroing) of blocks off the thread start
+ * path for short lived threads. The parts of a block that must be zeroed are cleared by
+ * threadLocalsBlock_create() whether or not it is recycled.
+ */
+#define THREAD_LOCALS_BLOCK_POOL_SIZE 32
+
+typedef struct {
+    Address tlBlock;
+    Size tlBlockSize;
+} PooledThreadLocalsBlock;
+
+static PooledThreadLocalsBlock theThreadLocalsBlockPool[THREAD_LOCALS_BLOCK_POOL_SIZE];
+static int theThreadLocalsBlockPoolCount = 0;
+static mutex_Struct theThreadLocalsBlockPoolMutex;
+
+Address threadLocalsBlock_exitedThreadsTrapCounts[TRAP_COUNT_KINDS];
+
+static Address takePooledThreadLocalBlock(Size tlBlockSize) {
+    Address tlBlock = 0;
+    int i;
+    mutex_enter(&theThreadLocalsBlockPoolMutex);
+    for (i = theThreadLocalsBlockPoolCount - 1; i >= 0; i--) {
+        if (theThreadLocalsBlockPool[i].tlBlockSize == tlBlockSize) {
+            tlBlock = theThreadLocalsBlockPool[i].tlBlock;
+            theThreadLocalsBlockPool[i] = theThreadLocalsBlockPool[--theThreadLocalsBlockPoolCount];
+            break;
+        }
+    }
+    mutex_exit(&theThreadLocalsBlockPoolMutex);
+    return tlBlock;
 }
 
-static void deallocateThreadLocalBlock(Address tlBlock, Size tlBlockSize) {
-#if os_MAXVE
-	maxve_virtualMemory_deallocate((void *) tlBlock, tlBlockSize, DATA_VM);
-#else
-	free ((void *) tlBlock);
-#endif
+static boolean poolThreadLocalBlock(Address tlBlock, Size tlBlockSize) {
+    boolean pooled = false;
+    mutex_enter(&theThreadLocalsBlockPoolMutex);
+    if (theThreadLocalsBlockPoolCount < THREAD_LOCALS_BLOCK_POOL_SIZE) {
+        theThreadLocalsBlockPool[theThreadLocalsBlockPoolCount].tlBlock = tlBlock;
+        theThreadLocalsBlockPool[theThreadLocalsBlockPoolCount].tlBlockSize = tlBlockSize;
+        theThreadLocalsBlockPoolCount++;
+        pooled = true;
+    }
+    mutex_exit(&theThreadLocalsBlockPoolMutex);
+    return pooled;
+}
+
+/**
+ * Allocates a thread locals block. The block is mapped directly instead of coming from the C heap
+ * so that its pages are only committed when first touched. This matters for the stack reference
+ * map at the end of the block: it is sized for the deepest possible stack but the GC only ever
+ * touches the part of it covering the frames actually on the stack.
+ */
+static Address allocateThreadLocalBlock(size_t tlBlockSize) {
+    Address tlBlock = takePooledThreadLocalBlock(tlBlockSize);
+    if (tlBlock != 0) {
+        return tlBlock;
+    }
+    c_ASSERT(tlBlockSize < 100000000);
+    return virtualMemory_allocate(virtualMemory_pageAlign(tlBlockSize), DATA_VM);
+}
+
+/**
+ * Releases a thread locals block. A block that goes back to the pool keeps its mapping but the
+ * pages of its stack reference map are handed back to the OS as the next thread using the block
+ * may never touch them. The reference map does not need to be preserved as the GC clears the
+ * part of it covering a stack before filling it in.
+ */
+static void deallocateThreadLocalBlock(Address tlBlock, Size tlBlockSize, Address refMap) {
+    const Address end = tlBlock + virtualMemory_pageAlign(tlBlockSize);
+    if (poolThreadLocalBlock(tlBlock, tlBlockSize)) {
+        const Address refMapPages = virtualMemory_pageAlign(refMap);
+        if (refMapPages < end) {
+            virtualMemory_uncommit(refMapPages, end - refMapPages);
+        }
+        return;
+    }
+    virtualMemory_deallocate(tlBlock, end - tlBlock, DATA_VM);
 }
 
 /**
@@ -118,6 +198,7 @@ Address threadLocalsBlock_create(jint id, Address tlBlock, Size stackSize) {
     const int tlaSize = s;
     const int pageSize = virtualMemory_getPageSize();
     const jboolean attaching = id < 0 || id == PRIMORDIAL_THREAD_ID;
+    const jboolean initializing = tlBlock != 0;
     jboolean haveRedZone = false;
 #if os_MAXVE
     haveRedZone = true;
@@ -142,6 +223,10 @@ Address threadLocalsBlock_create(jint id, Address tlBlock, Size stackSize) {
         tlBlock = allocateThreadLocalBlock(tlBlockSize);
         // if we are creating a VM thread, initialization is deferred until the thread is running
         if (!attaching) {
+            if (tlBlock != 0) {
+                // let the creator know the size of the block (e.g. to place it on a NUMA node)
+                ((NativeThreadLocals) (tlBlock + pageSize - sizeof(Address) + (3 * tlaSize)))->tlBlockSize = tlBlockSize;
+            }
             return tlBlock;
         }
     }
@@ -156,13 +241,21 @@ Address threadLocalsBlock_create(jint id, Address tlBlock, Size stackSize) {
     Address refMap = current;
     current = current + refMapSize;
 
+    if (bindToLocalNode) {
+        /* The block may have been allocated (and touched) by another thread so only whole pages
+         * exclusively owned by the block are moved to the node of the current thread. */
+        virtualMemory_setPlacementPolicy(tlBlock, (tlBlockSize / pageSize) * pageSize, NUMA_POLICY_LOCAL, -1);
+    }
+
     /* Clear each of the thread local spaces: */
     memset((void *) ttla, 0, tlaSize);
     memset((void *) etla, 0, tlaSize);
     memset((void *) dtla, 0, tlaSize);
 
-    /* Clear the NativeThreadLocals: */
+    /* Clear the NativeThreadLocals, preserving the flag set by thread_create() before the thread started: */
+    Address stackIsCached = initializing ? ntl->stackIsCached : 0;
     memset((void *) ntl, 0, sizeof(NativeThreadLocalsStruct));
+    ntl->stackIsCached = stackIsCached;
 
     ntl->handle = (Address) thread_self();
     ntl->stackBase = stackBase;
@@ -248,7 +341,7 @@ Address threadLocalsBlock_create(jint id, Address tlBlock, Size stackSize) {
     log_println("thread %3d: refMapSize   = %d (%p)", id, refMapSize, refMapSize);
 #endif
 
-    if (guardZonePages != 0) {
+    if (guardZonePages != 0 && !ntl->stackIsCached) {
 #if os_MAXVE
         // custom stack initialization
         maxve_initStack(ntl);
@@ -275,6 +368,9 @@ extern Mutex globalThreadLock;
 void threadLocalsBlock_destroy(Address tlBlock) {
     // The native thread library de-registers the value for a thread local key
     // before calling the associated destructor
+#if THREAD_LOCALS_FAST_PATH
+    theCurrentThreadLocalsBlock = 0;
+#endif
     c_ASSERT(threadLocalsBlock_current() == 0);
 
     // Temporarily re-register the block for the duration of this function
@@ -326,9 +422,13 @@ void threadLocalsBlock_destroy(Address tlBlock) {
     /* Unprotect the first page of the TL block which contains the first word of the triggered thread locals */
     virtualMemory_unprotectPages(tlBlock, 1);
 
-    /* Unprotect the stack guard pages */
+    /* Unprotect the stack guard pages unless the stack goes back to the stack cache with them protected */
 #if !os_MAXVE
-    virtualMemory_unprotectPages(startGuardZone, guardZonePages);
+    if (ntl->stackIsCached) {
+        thread_releaseStack(ntl);
+    } else {
+        virtualMemory_unprotectPages(startGuardZone, guardZonePages);
+    }
 #else
     // on MAXVE stack protection is handled elsewhere
 #endif
@@ -336,16 +436,53 @@ void threadLocalsBlock_destroy(Address tlBlock) {
     // Undo the temporary re-establishment of the thread locals block
     threadLocalsBlock_setCurrent(0);
 
+    /* A thread that exits while attached has not released its sample buffer (see thread_detach()). */
+    sampler_threadExiting();
+
+    /* Keep the trap counts of the thread for the VM wide totals. */
+    int kind;
+    for (kind = 0; kind < TRAP_COUNT_KINDS; kind++) {
+        if (ntl->trapCounts[kind] != 0) {
+            __sync_fetch_and_add(&threadLocalsBlock_exitedThreadsTrapCounts[kind], ntl->trapCounts[kind]);
+        }
+    }
+
+    if (ntl->jniLocalHandles != 0) {
+        virtualMemory_deallocate(ntl->jniLocalHandles, ntl->jniLocalHandlesEnd - ntl->jniLocalHandles, DATA_VM);
+    }
+
     /* Release the memory of the TL block. */
-    deallocateThreadLocalBlock(tlBlock, ntl->tlBlockSize);
+    deallocateThreadLocalBlock(tlBlock, ntl->tlBlockSize, (Address) ntl + sizeof(NativeThreadLocalsStruct));
 
 #if log_THREADS
     log_println("threadLocalsBlock_destroy: END t=%p", nativeThread);
 #endif
 }
 
+/**
+ * Maps the arena of JNI local references of the current thread, which is only done once the thread
+ * first creates a local reference.
+ *
+ * @return whether the thread has an arena
+ */
+JNIEXPORT jboolean JNICALL
+Java_com_sun_max_vm_jni_JniHandles_nativeAllocateArena(JNIEnv *env, jclass c, NativeThreadLocals ntl) {
+    if (ntl->jniLocalHandles == 0) {
+        Size jniLocalHandlesSize = JNI_LOCAL_HANDLES_PER_THREAD * sizeof(Address);
+        Address jniLocalHandles = virtualMemory_allocatePrivateAnon(0, jniLocalHandlesSize, JNI_FALSE, JNI_FALSE, DATA_VM);
+        if (jniLocalHandles == ALLOC_FAILED) {
+            return JNI_FALSE;
+        }
+        ntl->jniLocalHandlesTop = jniLocalHandles;
+        ntl->jniLocalHandlesEnd = jniLocalHandles + jniLocalHandlesSize;
+        ntl->jniLocalHandles = jniLocalHandles;
+    }
+    return JNI_TRUE;
+}
+
 void tla_initialize(int tlaSize) {
     theTLASize = tlaSize;
+    mutex_initialize(&theThreadLocalsBlockPoolMutex);
 #if !TELE
 #if os_DARWIN || os_LINUX
     int error = pthread_key_create(&theThreadLocalsKey, (ThreadLocalsBlockDestructor)(void *) threadLocalsBlock_destroy);
@@ -368,8 +505,8 @@ void tla_initialize(int tlaSize) {
 
 Address threadLocalsBlock_current() {
     Address tlBlock;
-#if os_DARWIN || os_LINUX
-    tlBlock = (Address) pthread_getspecific(theThreadLocalsKey);
+#if THREAD_LOCALS_FAST_PATH
+    tlBlock = theCurrentThreadLocalsBlock;
 #elif os_SOLARIS
     Address value;
     int result = thr_getspecific(theThreadLocalsKey, (void**) &value);
@@ -387,6 +524,7 @@ Address threadLocalsBlock_current() {
 
 void threadLocalsBlock_setCurrent(Address tlBlock) {
 #if (os_DARWIN || os_LINUX)
+    theCurrentThreadLocalsBlock = tlBlock;
     pthread_setspecific(theThreadLocalsKey, (void *) tlBlock);
 #elif os_SOLARIS
     thr_setspecific(theThreadLocalsKey, (void *) tlBlock);
@@ -27,7 +27,7 @@
 #include "word.h"
 
 /*
- * A thread locals block is a block of memory allocated on a page boundary (e.g. by valloc(3c)).
+ * A thread locals block is a block of memory allocated on a page boundary (by mmap(2)).
  * It contains all the VM and native thread local data for a thread.
  * This block of memory is laid out as follows:
  *
@@ -85,6 +85,12 @@ extern Address threadLocalsBlock_create(jint id, Address tlBlock, Size stackSize
 
 extern Address threadLocalsBlock_createForExistingThread(jint id);
 
+/**
+ * Specifies if threadLocalsBlock_create() should place each thread locals block on the NUMA node
+ * of the thread initializing it (i.e. the thread that owns it).
+ */
+extern void threadLocalsBlock_setNUMALocal(boolean value);
+
 /**
  * Releases the resources for the current thread allocated and protected by threadLocalsBlock_create().
  * This is the function specified as the destructor for the value associated with the ThreadLocalsKey
@@ -195,6 +201,20 @@ extern int tlaSize(void);
     *((Address *) tla_load(TLA, tla, TTLA) + name) = (Address) (value); \
 } while (0)
 
+/*
+ * The kinds of traps counted per thread in NativeThreadLocalsStruct.trapCounts.
+ * These must match the ordinals of com.sun.max.vm.runtime.Trap.Count.
+ */
+#define TRAP_COUNT_NULL_CHECK       0 // memory faults other than safepoints and stack overflows
+#define TRAP_COUNT_SAFEPOINT        1
+#define TRAP_COUNT_STACK_FAULT      2
+#define TRAP_COUNT_STACK_FATAL      3
+#define TRAP_COUNT_DIVIDE_BY_ZERO   4
+#define TRAP_COUNT_DIVIDE_OVERFLOW  5 // Integer.MIN_VALUE / -1, handled entirely by the native trap handler
+#define TRAP_COUNT_BLUE_ZONE        6
+#define TRAP_COUNT_ASYNC_INTERRUPT  7
+#define TRAP_COUNT_KINDS            8
+
 typedef struct {
     Address stackBase;
     Size stackSize;
@@ -216,8 +236,40 @@ typedef struct {
      * Place to hang miscellaneous OS dependent record keeping data.
      */
     void *osData;  //
+
+    Address stackIsCached; // non-zero if the stack was taken from the VM's stack cache with its guard zones protected
+
+    /*
+     * The number of traps taken by the thread, indexed by the TRAP_COUNT_* constants. These are only
+     * updated by the thread itself (in the trap handler) and so need neither locking nor atomic updates.
+     */
+    Address trapCounts[TRAP_COUNT_KINDS];
+
+    /*
+     * The arena of JNI local references of the thread (see JniHandles.java). Creating a local reference
+     * stores it at 'jniLocalHandlesTop' and advances it, and a local frame is popped by restoring a saved top.
+     * The GC scans the references between 'jniLocalHandles' and 'jniLocalHandlesTop' as roots.
+     * The arena is only mapped when the thread first creates a local reference, as most threads never do, and
+     * it is reserved without swap space so only the pages that are used are backed by memory.
+     */
+    Address jniLocalHandles;
+    Address jniLocalHandlesTop;
+    Address jniLocalHandlesEnd;
+
+    Address dormant; // non-zero while an attached thread is detached but kept dormant (see thread_detachCurrent())
 } NativeThreadLocalsStruct, *NativeThreadLocals;
 
+/*
+ * The number of JNI local references in the arena of each thread. Local references created once the
+ * arena is full are allocated from the pool of handles in the VmThread object.
+ */
+#define JNI_LOCAL_HANDLES_PER_THREAD (256 * 1024)
+
+/**
+ * The trap counts of all the threads whose thread locals block has been destroyed.
+ */
+extern Address threadLocalsBlock_exitedThreadsTrapCounts[TRAP_COUNT_KINDS];
+
 /**
  * Gets a pointer to NativeThreadLocalsStruct associated with the current thread.
  */
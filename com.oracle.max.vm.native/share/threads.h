@@ -81,10 +81,35 @@ typedef void (*VmThreadDetachMethod)(Address tla);
  */
 extern jboolean thread_sleep(jlong numberOfMilliSeconds);
 
+/**
+ * Sleeps the current thread for a given number of nanoseconds. The sleep is to a deadline on the
+ * monotonic clock so that the time remaining after an interruption can be slept without drift.
+ *
+ * @return 0 if the full time was slept, otherwise the (positive) number of nanoseconds remaining
+ *         when the sleep was interrupted
+ */
+extern jlong thread_sleepNanos(jlong nanos);
+
+/**
+ * Sets the timer slack of the current thread, i.e. how late the kernel may deliver its timed wakeups
+ * so that they can be coalesced with others.
+ *
+ * @param nanos the new slack, or 0 to restore the thread's default slack
+ * @return the previous slack in nanoseconds, or -1 if the slack cannot be set on this platform
+ */
+extern jlong thread_setTimerSlack(jlong nanos);
+
 void *thread_run(void *arg);
 int thread_attachCurrent(void **penv, JavaVMAttachArgs* args, boolean daemon);
 int thread_detachCurrent();
 
+/**
+ * Specifies if an attached thread that detaches is kept dormant, with its thread locals and VmThread,
+ * so that attaching it again only has to make it running again (see -XX:+DormantAttachedThreads).
+ * It is torn down when the native thread exits.
+ */
+extern void thread_setDormantAttach(boolean dormant);
+
 /**
  * Gets the address and size of the calling thread's stack.
  *
@@ -93,6 +118,14 @@ int thread_detachCurrent();
  */
 extern void thread_getStackInfo(Address *stackBase, Size* stackSize);
 
+/**
+ * Returns the stack of the calling thread to the VM's stack cache if it was taken from it (i.e.
+ * 'ntl->stackIsCached' is non-zero). The stack is only reused once the calling thread has terminated.
+ *
+ * @param ntl the native thread locals of the calling thread, which is about to terminate
+ */
+extern void thread_releaseStack(NativeThreadLocals ntl);
+
 /**
  * For debugging purposes:
  */
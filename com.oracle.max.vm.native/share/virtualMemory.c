@@ -19,11 +19,221 @@
  * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 #include "virtualMemory.h"
+#include "cgroup.h"
 #include "log.h"
 
+#include <stdlib.h>
+#include <string.h>
+#if !os_MAXVE
+#include <sys/mman.h>
+#endif
+
+static Size accounting[(DATA_VM + 1) * VM_ACCOUNTING_KINDS];
+
+Size *virtualMemory_getAccounting(void) {
+    return accounting;
+}
+
+/*
+ * The accounted space is kept as a sorted list of disjoint ranges, each with the type of memory it holds and its
+ * state, so that unmapping or (un)protecting space updates the counters of what the space actually was.
+ */
+#define RANGE_MAPPED    1 // mapped by a function in this file (VM_RESERVED)
+#define RANGE_COMMITTED 2 // mapped accessible (VM_COMMITTED, if also mapped)
+#define RANGE_PROTECTED 4 // protected by virtualMemory_protectPages() (VM_PROTECTED)
+
+typedef struct {
+    Address start;
+    Address end;
+    int type;
+    int state;
+} AccountedRangeStruct, *AccountedRange;
+
+static AccountedRange theRanges;
+static int theRangeCount;
+static int theRangeCapacity;
+static volatile int theRangesLock;
+
+/*
+ * The ranges are updated in signal handlers (when a stack guard zone is unprotected) and so
+ * they are guarded by a spin lock and their storage is not allocated with malloc.
+ */
+static void lockRanges(void) {
+    while (__sync_lock_test_and_set(&theRangesLock, 1)) {
+        while (theRangesLock) {
+        }
+    }
+}
+
+static void unlockRanges(void) {
+    __sync_lock_release(&theRangesLock);
+}
+
+static boolean ensureRangeCapacity(int capacity) {
+    if (capacity <= theRangeCapacity) {
+        return true;
+    }
+    int newCapacity = theRangeCapacity == 0 ? 256 : theRangeCapacity;
+    while (newCapacity < capacity) {
+        newCapacity *= 2;
+    }
+#if os_MAXVE
+    AccountedRange ranges = (AccountedRange) malloc(newCapacity * sizeof(AccountedRangeStruct));
+    if (ranges == NULL) {
+        return false;
+    }
+#else
+    void *mapping = mmap(0, newCapacity * sizeof(AccountedRangeStruct), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0);
+    if (mapping == MAP_FAILED) {
+        return false;
+    }
+    AccountedRange ranges = (AccountedRange) mapping;
+#endif
+    if (theRanges != NULL) {
+        memcpy(ranges, theRanges, theRangeCount * sizeof(AccountedRangeStruct));
+#if os_MAXVE
+        free(theRanges);
+#else
+        munmap((void *) theRanges, theRangeCapacity * sizeof(AccountedRangeStruct));
+#endif
+    }
+    theRanges = ranges;
+    theRangeCapacity = newCapacity;
+    return true;
+}
+
+/* Adds (if 'add' is true) or subtracts the bytes of a range of a given state to or from the counters of its type. */
+static void accountState(int type, int state, Size size, boolean add) {
+    if (type < HEAP_VM || type > DATA_VM) {
+        return;
+    }
+    Size *counters = &accounting[type * VM_ACCOUNTING_KINDS];
+    Size delta = add ? size : -size;
+    if ((state & RANGE_MAPPED) != 0) {
+        __sync_fetch_and_add(&counters[VM_RESERVED], delta);
+        if ((state & RANGE_COMMITTED) != 0) {
+            __sync_fetch_and_add(&counters[VM_COMMITTED], delta);
+        }
+    }
+    if ((state & RANGE_PROTECTED) != 0) {
+        __sync_fetch_and_add(&counters[VM_PROTECTED], delta);
+    }
+}
+
+/* Appends a piece of the ranges being rebuilt, merging it with the previous piece if possible. */
+static int appendPiece(AccountedRange pieces, int count, Address start, Address end, int type, int state) {
+    if (start == end || (state & (RANGE_MAPPED | RANGE_PROTECTED)) == 0) {
+        return count;
+    }
+    if (count > 0 && pieces[count - 1].end == start && pieces[count - 1].type == type && pieces[count - 1].state == state) {
+        pieces[count - 1].end = end;
+        return count;
+    }
+    pieces[count].start = start;
+    pieces[count].end = end;
+    pieces[count].type = type;
+    pieces[count].state = state;
+    return count + 1;
+}
+
+/*
+ * Updates the accounting of the space [start, start + size). If 'replace' is true, the space is given the type 'type'
+ * and the state 'set' (0 if it is unmapped). Otherwise the bits of 'clear' are cleared and those of 'set' are set in
+ * the state of the accounted space, keeping its type, while space that is not accounted yet gets the state 'set' and
+ * the type 'type'.
+ */
+static void accountRanges(Address start, Size size, int type, int set, int clear, boolean replace) {
+    Address end = start + size;
+    int first, last, count, i;
+    if (size == 0) {
+        return;
+    }
+    lockRanges();
+    for (first = 0; first < theRangeCount && theRanges[first].end <= start; first++) {
+    }
+    for (last = first; last < theRangeCount && theRanges[last].start < end; last++) {
+    }
+    /* Each range overlapped yields at most 3 pieces and the gaps between them at most 1 more each. */
+    int maxPieces = 3 * (last - first) + 3;
+    if (!ensureRangeCapacity(theRangeCount + 2 * maxPieces)) {
+        unlockRanges();
+        log_println("WARNING: could not allocate virtual memory accounting ranges");
+        return;
+    }
+    AccountedRange pieces = &theRanges[theRangeCount + maxPieces];
+    Address cursor = start;
+    count = 0;
+    for (i = first; i < last; i++) {
+        AccountedRangeStruct range = theRanges[i];
+        Address overlapStart = range.start > start ? range.start : start;
+        Address overlapEnd = range.end < end ? range.end : end;
+        int newType = replace ? type : range.type;
+        int newState = replace ? set : (range.state & ~clear) | set;
+        if (cursor < overlapStart) {
+            accountState(type, set, overlapStart - cursor, true);
+            count = appendPiece(pieces, count, cursor, overlapStart, type, set);
+        }
+        count = appendPiece(pieces, count, range.start, overlapStart, range.type, range.state);
+        accountState(range.type, range.state, overlapEnd - overlapStart, false);
+        accountState(newType, newState, overlapEnd - overlapStart, true);
+        count = appendPiece(pieces, count, overlapStart, overlapEnd, newType, newState);
+        count = appendPiece(pieces, count, overlapEnd, range.end, range.type, range.state);
+        cursor = overlapEnd;
+    }
+    if (cursor < end) {
+        accountState(type, set, end - cursor, true);
+        count = appendPiece(pieces, count, cursor, end, type, set);
+    }
+    /* Replace the overlapped ranges with the pieces and merge them with their neighbours. */
+    memmove(&theRanges[first + count], &theRanges[last], (theRangeCount - last) * sizeof(AccountedRangeStruct));
+    memcpy(&theRanges[first], pieces, count * sizeof(AccountedRangeStruct));
+    theRangeCount += count - (last - first);
+    int from = first > 0 ? first - 1 : 0;
+    int to = first + count + 1 < theRangeCount ? first + count + 1 : theRangeCount;
+    int merged = from;
+    for (i = from; i < to; i++) {
+        if (i > from && theRanges[merged - 1].end == theRanges[i].start && theRanges[merged - 1].type == theRanges[i].type &&
+                        theRanges[merged - 1].state == theRanges[i].state) {
+            theRanges[merged - 1].end = theRanges[i].end;
+        } else {
+            theRanges[merged++] = theRanges[i];
+        }
+    }
+    memmove(&theRanges[merged], &theRanges[to], (theRangeCount - to) * sizeof(AccountedRangeStruct));
+    theRangeCount -= to - merged;
+    unlockRanges();
+}
+
+/* Accounts for a successful mapping, which replaces whatever was mapped in its space before. */
+static void accountMapping(Address address, Size size, boolean accessible, int type) {
+    if (address == ALLOC_FAILED) {
+        return;
+    }
+    accountRanges(address, size, type, accessible ? RANGE_MAPPED | RANGE_COMMITTED : RANGE_MAPPED, 0, true);
+}
+
 #if defined(MAXVE)
 #include <maxve.h>
 /* No mmap function on MaxVE (yet)*/
+
+boolean virtualMemory_setPlacementPolicy(Address address, Size size, int policy, int node) {
+    return false;
+}
+
+void virtualMemory_setTypePlacementPolicy(int type, int policy, int node) {
+}
+
+boolean virtualMemory_uncommit(Address address, Size size) {
+    return false;
+}
+
+boolean virtualMemory_commit(Address address, Size size) {
+    return true;
+}
+
+boolean virtualMemory_adviseMapping(Address address, Size size, int advice) {
+    return false;
+}
 #else
 #include <stdlib.h>
 #include <errno.h>
@@ -38,6 +248,10 @@
 #include <sys/sysctl.h>
 #endif
 
+#if os_LINUX
+#include <sys/syscall.h>
+#endif
+
 /* There is a problem binding these identifiers in RedHat's include files, so we fake them: */
 #if os_LINUX
 #   ifndef MAP_ANONYMOUS
@@ -102,6 +316,96 @@ static Address check_mmap_result(void *result) {
     return ((Address) (result == (void *) MAP_FAILED ? ALLOC_FAILED : result));
 }
 
+#if os_LINUX
+
+/* The memory policy modes and flags of mbind(2), defined here so that numaif.h is not required. */
+#define MPOL_DEFAULT 0
+#define MPOL_PREFERRED 1
+#define MPOL_BIND 2
+#define MPOL_INTERLEAVE 3
+#define MPOL_MF_MOVE (1 << 1)
+#define MPOL_F_MEMS_ALLOWED (1 << 2)
+
+#define NUMA_MAX_NODES 1024
+#define NUMA_MASK_WORDS (NUMA_MAX_NODES / (8 * sizeof(unsigned long)))
+
+typedef unsigned long NodeMask[NUMA_MASK_WORDS];
+
+static int currentNode(void) {
+    unsigned int cpu, node;
+    if (syscall(SYS_getcpu, &cpu, &node, NULL) != 0) {
+        return -1;
+    }
+    return (int) node;
+}
+
+static boolean setPlacementPolicy(Address address, Size size, int policy, int node, unsigned int flags) {
+    NodeMask mask;
+    int mode;
+    memset(mask, 0, sizeof(mask));
+    switch (policy) {
+        case NUMA_POLICY_FIRST_TOUCH:
+            mode = MPOL_DEFAULT;
+            break;
+        case NUMA_POLICY_INTERLEAVE:
+            if (syscall(SYS_get_mempolicy, NULL, mask, NUMA_MAX_NODES + 1, NULL, MPOL_F_MEMS_ALLOWED) != 0) {
+                return false;
+            }
+            mode = MPOL_INTERLEAVE;
+            break;
+        case NUMA_POLICY_LOCAL:
+            node = currentNode();
+            /* fall through */
+        case NUMA_POLICY_BIND:
+        case NUMA_POLICY_PREFERRED:
+            if (node < 0 || node >= NUMA_MAX_NODES) {
+                return false;
+            }
+            mask[node / (8 * sizeof(unsigned long))] |= 1UL << (node % (8 * sizeof(unsigned long)));
+            mode = policy == NUMA_POLICY_BIND ? MPOL_BIND : MPOL_PREFERRED;
+            break;
+        default:
+            return false;
+    }
+    if (syscall(SYS_mbind, (void *) address, (unsigned long) size, mode, mode == MPOL_DEFAULT ? NULL : mask, NUMA_MAX_NODES + 1, flags) != 0) {
+#if log_MMAP
+        log_println("mbind(%p, %p, mode=%d, node=%d) failed: %s", address, size, mode, node, strerror(errno));
+#endif
+        return false;
+    }
+    return true;
+}
+
+#endif
+
+/* The placement policy (and node) applied to allocations of each type of memory, indexed by type. */
+static int typePlacementPolicy[DATA_VM + 1];
+static int typePlacementNode[DATA_VM + 1];
+
+boolean virtualMemory_setPlacementPolicy(Address address, Size size, int policy, int node) {
+#if os_LINUX
+    c_ASSERT(virtualMemory_pageAlign(address) == address);
+    return setPlacementPolicy(address, size, policy, node, MPOL_MF_MOVE);
+#else
+    return false;
+#endif
+}
+
+void virtualMemory_setTypePlacementPolicy(int type, int policy, int node) {
+    c_ASSERT(type >= HEAP_VM && type <= DATA_VM);
+    typePlacementPolicy[type] = policy;
+    typePlacementNode[type] = node;
+}
+
+/* Applies the placement policy of a given type of memory to a new mapping. */
+static void applyTypePlacementPolicy(Address address, Size size, int type) {
+#if os_LINUX
+    if (address != ALLOC_FAILED && type >= HEAP_VM && type <= DATA_VM && typePlacementPolicy[type] != NUMA_POLICY_FIRST_TOUCH) {
+        setPlacementPolicy(address, size, typePlacementPolicy[type], typePlacementNode[type], 0);
+    }
+#endif
+}
+
 #ifdef arm
   static int attempt = 0;
   static Address allocAddress = 0x0;
@@ -149,10 +453,39 @@ Address virtualMemory_allocatePrivateAnon(Address address, Size size, jboolean r
 #ifdef arm
   address =  check_mmap_result(result);
   allocAddress = address + size;
+  accountMapping(address, size, protNone == JNI_FALSE, type);
   return address;
 #else
-  return check_mmap_result(result);
+  Address allocated = check_mmap_result(result);
+  accountMapping(allocated, size, protNone == JNI_FALSE, type);
+  if (protNone == JNI_FALSE) {
+      applyTypePlacementPolicy(allocated, size, type);
+  }
+  return allocated;
+#endif
+}
+
+/* Allocates virtual space exactly at a preferred address, without clobbering any existing mapping.
+ * Unlike virtualMemory_allocatePrivateAnon, the address is only used as a hint to mmap and this
+ * function fails (returning ALLOC_FAILED) when the space cannot be allocated there.
+ */
+Address virtualMemory_allocatePrivateAnonAtPreferredAddress(Address address, Size size, jboolean reserveSwap, jboolean protNone, int type) {
+    int flags = MAP_PRIVATE | MAP_ANON;
+    int prot = protNone == JNI_TRUE ? PROT_NONE : PROT;
+    if (reserveSwap == JNI_FALSE) {
+        flags |= MAP_NORESERVE;
+    }
+    c_ASSERT(address != 0);
+    Address result = check_mmap_result(mmap((void*) address, (size_t) size, prot, flags, -1, 0));
+#if log_LOADER
+    log_println("virtualMemory_allocatePrivateAnonAtPreferredAddress(address=%p, size=%p) allocated at %p", address, size, result);
 #endif
+    if (result != ALLOC_FAILED && result != address) {
+        munmap((void *) result, (size_t) size);
+        return ALLOC_FAILED;
+    }
+    accountMapping(result, size, protNone == JNI_FALSE, type);
+    return result;
 }
 
 
@@ -171,9 +504,12 @@ Address virtualMemory_mapFile(Size size, jint fd, Size offset) {
     void *result = mmap((void *)address, (size_t) size, PROT, MAP_PRIVATE, fd, (off_t) offset);
     address = check_mmap_result(result);
     allocAddress = address + size;
+    accountMapping(address, size, true, DATA_VM);
     return address;
 #else
-	return check_mmap_result(mmap(0, (size_t) size, PROT, MAP_PRIVATE, fd, (off_t) offset));
+    Address result = check_mmap_result(mmap(0, (size_t) size, PROT, MAP_PRIVATE, fd, (off_t) offset));
+    accountMapping(result, size, true, DATA_VM);
+    return result;
 #endif
 }
 
@@ -183,7 +519,9 @@ Java_com_sun_max_memory_VirtualMemory_virtualMemory_1mapFile(JNIEnv *env, jclass
 }
 
 Address virtualMemory_mapFileIn31BitSpace(jint size, jint fd, Size offset) {
-	return check_mmap_result(mmap(0, (size_t) size, PROT, MAP_PRIVATE | MAP_32BIT, fd, (off_t) offset));
+    Address result = check_mmap_result(mmap(0, (size_t) size, PROT, MAP_PRIVATE | MAP_32BIT, fd, (off_t) offset));
+    accountMapping(result, size, true, DATA_VM);
+    return result;
 }
 
 JNIEXPORT jlong JNICALL
@@ -192,7 +530,77 @@ Java_com_sun_max_memory_VirtualMemory_virtualMemory_1mapFileIn31BitSpace(JNIEnv
 }
 
 Address virtualMemory_mapFileAtFixedAddress(Address address, Size size, jint fd, Size offset) {
-    return check_mmap_result(mmap((void *) address, (size_t) size, PROT, MAP_PRIVATE | MAP_FIXED, fd, (off_t) offset));
+    Address result = check_mmap_result(mmap((void *) address, (size_t) size, PROT, MAP_PRIVATE | MAP_FIXED, fd, (off_t) offset));
+    accountMapping(result, size, true, DATA_VM);
+    return result;
+}
+
+boolean virtualMemory_adviseMapping(Address address, Size size, int advice) {
+    c_ASSERT(virtualMemory_pageAlign(address) == address);
+    int madviseAdvice;
+    switch (advice) {
+        case MAPPING_ADVICE_NORMAL: madviseAdvice = MADV_NORMAL; break;
+        case MAPPING_ADVICE_SEQUENTIAL: madviseAdvice = MADV_SEQUENTIAL; break;
+        case MAPPING_ADVICE_RANDOM: madviseAdvice = MADV_RANDOM; break;
+        case MAPPING_ADVICE_WILLNEED: madviseAdvice = MADV_WILLNEED; break;
+        case MAPPING_ADVICE_DONTNEED: madviseAdvice = MADV_DONTNEED; break;
+        default: return false;
+    }
+    return madvise((void *) address, (size_t) size, madviseAdvice) == 0;
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_sun_max_memory_VirtualMemory_virtualMemory_1adviseMapping(JNIEnv *env, jclass c, jlong address, jlong size, jint advice) {
+    return virtualMemory_adviseMapping((Address) address, (Size) size, advice);
+}
+
+/* Linux kernels before 4.5 do not support MADV_FREE, in which case MADV_DONTNEED is used instead. */
+#if os_LINUX
+#   ifndef MADV_FREE
+#       define MADV_FREE 8
+#   endif
+static boolean madviseFreeSupported = true;
+#endif
+
+boolean virtualMemory_uncommit(Address address, Size size) {
+    c_ASSERT(virtualMemory_pageAlign(address) == address);
+#if os_LINUX
+    if (madviseFreeSupported) {
+        if (madvise((void *) address, (size_t) size, MADV_FREE) == 0) {
+            return true;
+        }
+        if (errno != EINVAL) {
+            return false;
+        }
+        madviseFreeSupported = false;
+    }
+    return madvise((void *) address, (size_t) size, MADV_DONTNEED) == 0;
+#elif os_DARWIN
+    return madvise((void *) address, (size_t) size, MADV_FREE_REUSABLE) == 0;
+#else
+    return false;
+#endif
+}
+
+boolean virtualMemory_commit(Address address, Size size) {
+    c_ASSERT(virtualMemory_pageAlign(address) == address);
+#if os_DARWIN
+    /* Tells the kernel the pages are in use again so that they are accounted to this process. */
+    return madvise((void *) address, (size_t) size, MADV_FREE_REUSE) == 0;
+#else
+    /* Released pages are faulted back in on their next access. */
+    return true;
+#endif
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_sun_max_memory_VirtualMemory_virtualMemory_1uncommit(JNIEnv *env, jclass c, jlong address, jlong size) {
+    return virtualMemory_uncommit((Address) address, (Size) size);
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_sun_max_memory_VirtualMemory_virtualMemory_1commit(JNIEnv *env, jclass c, jlong address, jlong size) {
+    return virtualMemory_commit((Address) address, (Size) size);
 }
 
 // end of conditional exclusion of mmap stuff not available (or used) on MAXVE
@@ -201,37 +609,49 @@ Address virtualMemory_mapFileAtFixedAddress(Address address, Size size, jint fd,
 
 Address virtualMemory_allocate(Size size, int type) {
 #if os_MAXVE
-	return (Address) maxve_virtualMemory_allocate(size, type);
+    Address result = (Address) maxve_virtualMemory_allocate(size, type);
 #else
-    return check_mmap_result(mmap(0, (size_t) size, PROT, MAP_ANON | MAP_PRIVATE, -1, (off_t) 0));
+    Address result = check_mmap_result(mmap(0, (size_t) size, PROT, MAP_ANON | MAP_PRIVATE, -1, (off_t) 0));
+    applyTypePlacementPolicy(result, size, type);
 #endif
+    accountMapping(result, size, true, type);
+    return result;
 }
 
 Address virtualMemory_allocateIn31BitSpace(Size size, int type) {
 #if os_LINUX
-    return check_mmap_result(mmap(0, (size_t) size, PROT, MAP_ANON | MAP_PRIVATE | MAP_32BIT, -1, (off_t) 0));
+    Address result = check_mmap_result(mmap(0, (size_t) size, PROT, MAP_ANON | MAP_PRIVATE | MAP_32BIT, -1, (off_t) 0));
 #elif os_MAXVE
-    return (Address) maxve_virtualMemory_allocateIn31BitSpace(size, type);
+    Address result = (Address) maxve_virtualMemory_allocateIn31BitSpace(size, type);
 #else
     c_UNIMPLEMENTED();
-    return 0;
+    Address result = ALLOC_FAILED;
 #endif
+    accountMapping(result, size, true, type);
+    return result;
 }
 
 Address virtualMemory_deallocate(Address start, Size size, int type) {
 #if os_MAXVE
-    return (Address) maxve_virtualMemory_deallocate((void *)start, size, type);
+    Address result = (Address) maxve_virtualMemory_deallocate((void *)start, size, type);
 #else
-    int result = munmap((void *) start, (size_t) size);
-    return result == -1 ? 0 : start;
+    Address result = munmap((void *) start, (size_t) size) == -1 ? 0 : start;
 #endif
+    if (result != 0) {
+        accountRanges(start, size, type, 0, 0, true);
+    }
+    return result;
 }
 
 boolean virtualMemory_allocateAtFixedAddress(Address address, Size size, int type) {
 #if os_SOLARIS || os_DARWIN  || os_LINUX
-    return check_mmap_result(mmap((void *) address, (size_t) size, PROT, MAP_ANON | MAP_PRIVATE | MAP_FIXED, -1, (off_t) 0)) != ALLOC_FAILED;
+    Address result = check_mmap_result(mmap((void *) address, (size_t) size, PROT, MAP_ANON | MAP_PRIVATE | MAP_FIXED, -1, (off_t) 0));
+    accountMapping(result, size, true, type);
+    return result != ALLOC_FAILED;
 #elif os_MAXVE
-    return (Address) maxve_virtualMemory_allocateAtFixedAddress((unsigned long)address, size, type) != ALLOC_FAILED;
+    Address result = (Address) maxve_virtualMemory_allocateAtFixedAddress((unsigned long)address, size, type);
+    accountMapping(result, size, true, type);
+    return result != ALLOC_FAILED;
 #else
     c_UNIMPLEMENTED();
     return false;
@@ -251,6 +671,8 @@ void virtualMemory_protectPages(Address address, int count) {
 #else
     c_UNIMPLEMENTED();
 #endif
+    /* The pages protected outside the mappings made here are the guard zones of stacks made by the thread library. */
+    accountRanges(address, count * virtualMemory_getPageSize(), STACK_VM, RANGE_PROTECTED, 0, false);
 }
 
 void virtualMemory_unprotectPages(Address address, int count) {
@@ -266,6 +688,7 @@ void virtualMemory_unprotectPages(Address address, int count) {
 #else
 	c_UNIMPLEMENTED();
 #endif
+	accountRanges(address, count * virtualMemory_getPageSize(), STACK_VM, RANGE_COMMITTED, RANGE_PROTECTED, false);
 }
 
 static unsigned int pageSize = 0;
@@ -298,6 +721,11 @@ Size virtualMemory_getPhysicalMemorySize(void) {
         int ok = sysctl(query, 2, &physicalMemory, &len, NULL, 0);
         c_ASSERT(ok == 0);
 #endif
+        /* Report the memory limit of the container (i.e. control group) the VM runs in, if it is lower. */
+        Size limit = cgroup_memoryLimit() & ~((Size) virtualMemory_getPageSize() - 1);
+        if (limit != 0 && limit < physicalMemory) {
+            physicalMemory = limit;
+        }
         c_ASSERT(physicalMemory > 0 && physicalMemory % virtualMemory_getPageSize() == 0);
     }
     return physicalMemory;
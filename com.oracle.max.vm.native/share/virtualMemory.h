@@ -33,6 +33,64 @@
 
 #define ALLOC_FAILED ((Address) 0)  // return value for failed allocations
 
+/*
+ * NUMA placement policies for virtual memory.
+ *
+ *  ATTENTION: these must match the ordinals of 'com.sun.max.memory.VirtualMemory.PlacementPolicy'.
+ */
+#define NUMA_POLICY_FIRST_TOUCH 0  // pages are placed on the node of the thread that first touches them (the OS default)
+#define NUMA_POLICY_BIND 1         // pages must be placed on a given node
+#define NUMA_POLICY_INTERLEAVE 2   // pages are interleaved across all nodes the process may allocate on
+#define NUMA_POLICY_PREFERRED 3    // pages are placed on a given node if it has free memory
+#define NUMA_POLICY_LOCAL 4        // pages are placed on the node of the calling thread if it has free memory
+
+/*
+ * The kinds of virtual memory accounted for per type of memory (see virtualMemory_getAccounting()).
+ *
+ *  ATTENTION: these must match the ordinals of 'com.sun.max.memory.VirtualMemory.Accounting'.
+ */
+#define VM_RESERVED 0   // bytes of address space mapped
+#define VM_COMMITTED 1  // bytes of address space mapped accessible
+#define VM_PROTECTED 2  // bytes of address space protected by virtualMemory_protectPages()
+#define VM_ACCOUNTING_KINDS 3
+
+/**
+ * Gets the virtual memory accounting counters. The counter for the bytes of a given kind (VM_RESERVED, VM_COMMITTED or
+ * VM_PROTECTED) of a given type (HEAP_VM, STACK_VM, CODE_VM or DATA_VM) of memory is at index
+ * '(type * VM_ACCOUNTING_KINDS) + kind'. The counters are updated atomically by the functions declared in this file.
+ *
+ * The type and state of the accounted space are tracked per range, so that a mapping at a given address replaces
+ * the accounting of the space it overlays and unmapping or (un)protecting space updates the counters of the type it
+ * was mapped as. Mapped files are accounted as DATA_VM and pages protected outside of the mappings made by these
+ * functions (i.e. the guard zones of thread library stacks) as STACK_VM.
+ */
+extern Size *virtualMemory_getAccounting(void);
+
+extern Address virtualMemory_mapFile(Size size, jint fd, Size offset);
+
+/*
+ * Access pattern hints for mapped memory (see virtualMemory_adviseMapping()).
+ *
+ *  ATTENTION: these must match the ordinals of 'com.sun.max.memory.VirtualMemory.MappingAdvice'.
+ */
+#define MAPPING_ADVICE_NORMAL 0      // no particular access pattern
+#define MAPPING_ADVICE_SEQUENTIAL 1  // the range will be accessed sequentially, so read ahead aggressively
+#define MAPPING_ADVICE_RANDOM 2      // the range will be accessed randomly, so do not read ahead
+#define MAPPING_ADVICE_WILLNEED 3    // the range will be accessed soon, so start reading it in
+#define MAPPING_ADVICE_DONTNEED 4    // the range will not be accessed soon, so its pages can be dropped
+
+/**
+ * Gives the kernel a hint of how a range of mapped memory, typically a file mapped by one of the
+ * virtualMemory_mapFile*() functions, will be accessed. For MAPPING_ADVICE_DONTNEED the pages of the
+ * range are dropped: a later access reads the file again, so modifications of a private mapping are lost.
+ *
+ * @param address the page aligned start of the range
+ * @param size the size of the range
+ * @param advice one of the MAPPING_ADVICE_* values
+ * @return true if the hint was given, false if it failed or is not supported on this platform
+ */
+extern boolean virtualMemory_adviseMapping(Address address, Size size, int advice);
+
 extern Address virtualMemory_mapFileIn31BitSpace(jint size, jint fd, Size offset);
 
 extern Address virtualMemory_mapFileAtFixedAddress(Address address, Size size, jint fd, Size offset);
@@ -42,13 +100,55 @@ extern boolean virtualMemory_allocateAtFixedAddress(Address address, Size size,
 extern Address virtualMemory_allocate(Size size, int type);
 extern Address virtualMemory_allocateIn31BitSpace(Size size, int type);
 extern Address virtualMemory_allocatePrivateAnon(Address address, Size size, jboolean reserveSwap, jboolean protNone, int type);
+extern Address virtualMemory_allocatePrivateAnonAtPreferredAddress(Address address, Size size, jboolean reserveSwap, jboolean protNone, int type);
 extern Address virtualMemory_deallocate(Address start, Size size, int type);
 
+/**
+ * Gives the physical pages backing a range of committed virtual memory back to the OS while keeping
+ * the range reserved and accessible. The contents of the range are undefined (they may read as zero
+ * or as their previous values) until they are next written.
+ *
+ * @param address the page aligned start of the range
+ * @param size the size of the range
+ * @return true if the pages were released, false otherwise
+ */
+extern boolean virtualMemory_uncommit(Address address, Size size);
+
+/**
+ * Prepares a range released by virtualMemory_uncommit() for reuse.
+ *
+ * @param address the page aligned start of the range
+ * @param size the size of the range
+ * @return true if the range can be used, false otherwise
+ */
+extern boolean virtualMemory_commit(Address address, Size size);
+
 extern unsigned int virtualMemory_getPageSize(void);
 extern Size virtualMemory_getPhysicalMemorySize(void);
 
 extern Address virtualMemory_pageAlign(Address address);
 
+/**
+ * Applies a NUMA placement policy to a range of virtual memory. Pages of the range that have already
+ * been placed are migrated to conform to the policy where possible.
+ *
+ * @param address the page aligned start of the range
+ * @param size the size of the range
+ * @param policy one of the NUMA_POLICY_* values
+ * @param node the node for NUMA_POLICY_BIND and NUMA_POLICY_PREFERRED (ignored otherwise)
+ * @return true if the policy was applied, false if it failed or NUMA placement is not supported on this platform
+ */
+extern boolean virtualMemory_setPlacementPolicy(Address address, Size size, int policy, int node);
+
+/**
+ * Sets the NUMA placement policy applied to all subsequent allocations and commits of a given type of memory.
+ *
+ * @param type one of HEAP_VM, STACK_VM, CODE_VM or DATA_VM
+ * @param policy one of the NUMA_POLICY_* values
+ * @param node the node for NUMA_POLICY_BIND and NUMA_POLICY_PREFERRED (ignored otherwise)
+ */
+extern void virtualMemory_setTypePlacementPolicy(int type, int policy, int node);
+
 extern void virtualMemory_protectPages(Address address, int count);
 extern void virtualMemory_unprotectPages(Address address, int count);
 #endif /*__virtualMemory_h__*/
@@ -0,0 +1,677 @@
+/*
+ * Copyright (c) 2011, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include "aio.h"
+#include "log.h"
+#include "mutex.h"
+#include "os.h"
+
+#if os_SOLARIS || os_LINUX || os_DARWIN
+#include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#if os_LINUX && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#if defined(__NR_io_uring_setup)
+#define AIO_IO_URING 1
+#ifndef IORING_SQ_CQ_OVERFLOW
+#define IORING_SQ_CQ_OVERFLOW (1U << 1)
+#endif
+#endif
+#endif
+#endif
+
+#ifndef AIO_IO_URING
+#define AIO_IO_URING 0
+#endif
+
+typedef struct {
+    jlong userData;
+    jint result;
+} AioCompletionStruct, *AioCompletion;
+
+typedef struct AioRingStruct {
+    mutex_Struct submitLock;
+    mutex_Struct completeLock;
+
+    /* The io_uring file descriptor or -1 if operations are performed synchronously. */
+    int fd;
+
+#if AIO_IO_URING
+    void *sqRing;
+    Size sqRingSize;
+    void *cqRing;
+    Size cqRingSize;
+    struct io_uring_sqe *sqes;
+    Size sqesSize;
+    unsigned *sqHead;
+    unsigned *sqTail;
+    unsigned sqMask;
+    unsigned sqEntries;
+    unsigned *sqArray;
+    unsigned *sqFlags;
+    unsigned *cqHead;
+    unsigned *cqTail;
+    unsigned cqMask;
+    struct io_uring_cqe *cqes;
+    /* The number of completions the kernel dropped because the completion queue was full. */
+    unsigned *cqOverflow;
+    unsigned cqOverflowSeen;
+    /* The number of entries queued since the last io_uring_enter(), guarded by the submit lock. */
+    unsigned pending;
+#endif
+
+    /* The completions of the synchronous engine. */
+    AioCompletion completions;
+    jint completionsLength;
+    jint completionsCapacity;
+
+    /* The registered files of the synchronous engine. */
+    jint *files;
+    jint filesLength;
+} AioRingStruct;
+
+static jboolean useIoUring = true;
+
+static AioRing theSharedRing;
+static pthread_once_t theSharedRingOnce = PTHREAD_ONCE_INIT;
+
+static __thread AioRing theCurrentThreadRing;
+
+void aio_setUseIoUring(jboolean value) {
+    useIoUring = value;
+}
+
+#if AIO_IO_URING
+
+static int io_uring_setup(unsigned entries, struct io_uring_params *params) {
+    return (int) syscall(__NR_io_uring_setup, entries, params);
+}
+
+static int io_uring_enter(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags) {
+    return (int) syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, NULL, 0);
+}
+
+static int io_uring_register(int fd, unsigned opcode, void *arg, unsigned count) {
+    return (int) syscall(__NR_io_uring_register, fd, opcode, arg, count);
+}
+
+static void unmapRing(AioRing ring) {
+    if (ring->sqes != NULL) {
+        munmap(ring->sqes, ring->sqesSize);
+    }
+    if (ring->cqRing != NULL && ring->cqRing != ring->sqRing) {
+        munmap(ring->cqRing, ring->cqRingSize);
+    }
+    if (ring->sqRing != NULL) {
+        munmap(ring->sqRing, ring->sqRingSize);
+    }
+}
+
+/*
+ * Sets up the io_uring instance of a ring, leaving the ring synchronous if the kernel does not support
+ * io_uring (ENOSYS) or does not allow it (e.g. EPERM when disabled by the io_uring_disabled sysctl).
+ */
+static void setUpIoUring(AioRing ring, jint entries) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    int fd = io_uring_setup((unsigned) entries, &params);
+    if (fd < 0) {
+        return;
+    }
+    ring->fd = fd;
+    ring->sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if ((params.features & IORING_FEAT_SINGLE_MMAP) != 0) {
+        if (ring->cqRingSize > ring->sqRingSize) {
+            ring->sqRingSize = ring->cqRingSize;
+        }
+        ring->cqRingSize = ring->sqRingSize;
+    }
+    void *sqRing = mmap(NULL, ring->sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (sqRing == MAP_FAILED) {
+        goto fail;
+    }
+    ring->sqRing = sqRing;
+    if ((params.features & IORING_FEAT_SINGLE_MMAP) != 0) {
+        ring->cqRing = sqRing;
+    } else {
+        void *cqRing = mmap(NULL, ring->cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        if (cqRing == MAP_FAILED) {
+            goto fail;
+        }
+        ring->cqRing = cqRing;
+    }
+    ring->sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+    void *sqes = mmap(NULL, ring->sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        goto fail;
+    }
+    ring->sqes = (struct io_uring_sqe *) sqes;
+
+    char *sq = (char *) ring->sqRing;
+    ring->sqHead = (unsigned *) (sq + params.sq_off.head);
+    ring->sqTail = (unsigned *) (sq + params.sq_off.tail);
+    ring->sqMask = *(unsigned *) (sq + params.sq_off.ring_mask);
+    ring->sqEntries = *(unsigned *) (sq + params.sq_off.ring_entries);
+    ring->sqArray = (unsigned *) (sq + params.sq_off.array);
+    ring->sqFlags = (unsigned *) (sq + params.sq_off.flags);
+    char *cq = (char *) ring->cqRing;
+    ring->cqHead = (unsigned *) (cq + params.cq_off.head);
+    ring->cqTail = (unsigned *) (cq + params.cq_off.tail);
+    ring->cqMask = *(unsigned *) (cq + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe *) (cq + params.cq_off.cqes);
+    ring->cqOverflow = (unsigned *) (cq + params.cq_off.overflow);
+    return;
+fail:
+    log_println("aio: could not map io_uring queues: %s", strerror(errno));
+    unmapRing(ring);
+    close(fd);
+    ring->sqRing = ring->cqRing = NULL;
+    ring->sqes = NULL;
+    ring->fd = -1;
+}
+
+/*
+ * Submits the queued entries. The caller holds the submit lock.
+ */
+static int enter(AioRing ring) {
+    for (;;) {
+        int n = io_uring_enter(ring->fd, ring->pending, 0, 0);
+        if (n >= 0) {
+            ring->pending -= n;
+            return n;
+        }
+        if (errno != EINTR) {
+            return -errno;
+        }
+    }
+}
+
+/*
+ * Waits for completions without holding the submit lock, so that other threads can queue operations meanwhile.
+ */
+static int waitForCompletions(AioRing ring, unsigned minComplete) {
+    while (io_uring_enter(ring->fd, 0, minComplete, IORING_ENTER_GETEVENTS) < 0) {
+        if (errno != EINTR) {
+            return -errno;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Gets a free submission queue entry, submitting the queued entries to make room if necessary. The caller holds the submit lock.
+ */
+static struct io_uring_sqe *nextEntry(AioRing ring) {
+    unsigned tail = *ring->sqTail;
+    if (tail - __atomic_load_n(ring->sqHead, __ATOMIC_ACQUIRE) == ring->sqEntries) {
+        if (enter(ring) < 0 || tail - __atomic_load_n(ring->sqHead, __ATOMIC_ACQUIRE) == ring->sqEntries) {
+            return NULL;
+        }
+    }
+    struct io_uring_sqe *sqe = &ring->sqes[tail & ring->sqMask];
+    memset(sqe, 0, sizeof(*sqe));
+    return sqe;
+}
+
+/*
+ * Makes the entry obtained by nextEntry() visible to the kernel. The caller holds the submit lock.
+ */
+static void queueEntry(AioRing ring, struct io_uring_sqe *sqe) {
+    unsigned tail = *ring->sqTail;
+    unsigned index = tail & ring->sqMask;
+    ring->sqArray[index] = index;
+    __atomic_store_n(ring->sqTail, tail + 1, __ATOMIC_RELEASE);
+    ring->pending++;
+}
+
+static jint queue(AioRing ring, int opcode, jint fd, Address addr, jint length, jlong offset, Unsigned4 opFlags, jint bufferIndex, Address addr2, jlong userData) {
+    mutex_enter(&ring->submitLock);
+    struct io_uring_sqe *sqe = nextEntry(ring);
+    if (sqe == NULL) {
+        mutex_exit(&ring->submitLock);
+        return -EBUSY;
+    }
+    sqe->opcode = (Unsigned1) opcode;
+    if ((fd & AIO_FIXED_FILE_TAG) != 0 && fd >= 0) {
+        sqe->fd = fd & ~AIO_FIXED_FILE_TAG;
+        sqe->flags |= IOSQE_FIXED_FILE;
+    } else {
+        sqe->fd = fd;
+    }
+    sqe->addr = (Unsigned8) addr;
+    sqe->len = (Unsigned4) length;
+    sqe->off = (Unsigned8) offset;
+    sqe->rw_flags = (int) opFlags;
+    sqe->buf_index = (Unsigned2) bufferIndex;
+    if (addr2 != 0) {
+        /* 'addr2' shares its storage with 'off'. */
+        sqe->addr2 = (Unsigned8) addr2;
+    }
+    sqe->user_data = (Unsigned8) userData;
+    queueEntry(ring, sqe);
+    mutex_exit(&ring->submitLock);
+    return 0;
+}
+
+#endif /* AIO_IO_URING */
+
+AioRing aio_createRing(jint entries) {
+    AioRing ring = (AioRing) calloc(1, sizeof(AioRingStruct));
+    if (ring == NULL) {
+        return NULL;
+    }
+    mutex_initialize(&ring->submitLock);
+    mutex_initialize(&ring->completeLock);
+    ring->fd = -1;
+#if AIO_IO_URING
+    if (useIoUring) {
+        setUpIoUring(ring, entries);
+    }
+#endif
+    return ring;
+}
+
+void aio_destroyRing(AioRing ring) {
+    if (ring == NULL) {
+        return;
+    }
+#if AIO_IO_URING
+    if (ring->fd >= 0) {
+        unmapRing(ring);
+        close(ring->fd);
+    }
+#endif
+    mutex_dispose(&ring->submitLock);
+    mutex_dispose(&ring->completeLock);
+    free(ring->completions);
+    free(ring->files);
+    free(ring);
+}
+
+AioRing aio_currentThreadRing(void) {
+    AioRing ring = theCurrentThreadRing;
+    if (ring == NULL) {
+        ring = aio_createRing(AIO_DEFAULT_ENTRIES);
+        theCurrentThreadRing = ring;
+    }
+    return ring;
+}
+
+static void createSharedRing(void) {
+    theSharedRing = aio_createRing(AIO_DEFAULT_ENTRIES);
+}
+
+AioRing aio_sharedRing(void) {
+    pthread_once(&theSharedRingOnce, createSharedRing);
+    return theSharedRing;
+}
+
+void aio_threadExiting(void) {
+    AioRing ring = theCurrentThreadRing;
+    if (ring != NULL) {
+        theCurrentThreadRing = NULL;
+        aio_destroyRing(ring);
+    }
+}
+
+jboolean aio_isAsynchronous(AioRing ring) {
+    return ring->fd >= 0;
+}
+
+jint aio_registerBuffers(AioRing ring, void *iov, jint count) {
+#if AIO_IO_URING
+    if (ring->fd >= 0) {
+        mutex_enter(&ring->submitLock);
+        io_uring_register(ring->fd, IORING_UNREGISTER_BUFFERS, NULL, 0);
+        int result = count == 0 ? 0 : io_uring_register(ring->fd, IORING_REGISTER_BUFFERS, iov, (unsigned) count);
+        mutex_exit(&ring->submitLock);
+        return result < 0 ? -errno : 0;
+    }
+#endif
+    /* The synchronous engine reads and writes the buffers given with each operation. */
+    return 0;
+}
+
+jint aio_registerFiles(AioRing ring, jint *fds, jint count) {
+#if AIO_IO_URING
+    if (ring->fd >= 0) {
+        mutex_enter(&ring->submitLock);
+        io_uring_register(ring->fd, IORING_UNREGISTER_FILES, NULL, 0);
+        int result = count == 0 ? 0 : io_uring_register(ring->fd, IORING_REGISTER_FILES, fds, (unsigned) count);
+        mutex_exit(&ring->submitLock);
+        return result < 0 ? -errno : 0;
+    }
+#endif
+    jint *files = NULL;
+    if (count > 0) {
+        files = (jint *) malloc(count * sizeof(jint));
+        if (files == NULL) {
+            return -ENOMEM;
+        }
+        memcpy(files, fds, count * sizeof(jint));
+    }
+    mutex_enter(&ring->submitLock);
+    free(ring->files);
+    ring->files = files;
+    ring->filesLength = count;
+    mutex_exit(&ring->submitLock);
+    return 0;
+}
+
+/*
+ * Records a completion of the synchronous engine.
+ */
+static jint complete(AioRing ring, jlong userData, jlong result) {
+    jint value = result < 0 ? -errno : (jint) result;
+    mutex_enter(&ring->completeLock);
+    if (ring->completionsLength == ring->completionsCapacity) {
+        jint capacity = ring->completionsCapacity == 0 ? AIO_DEFAULT_ENTRIES : ring->completionsCapacity * 2;
+        AioCompletion completions = (AioCompletion) realloc(ring->completions, capacity * sizeof(AioCompletionStruct));
+        if (completions == NULL) {
+            mutex_exit(&ring->completeLock);
+            return -ENOMEM;
+        }
+        ring->completions = completions;
+        ring->completionsCapacity = capacity;
+    }
+    AioCompletion completion = &ring->completions[ring->completionsLength++];
+    completion->userData = userData;
+    completion->result = value;
+    mutex_exit(&ring->completeLock);
+    return 0;
+}
+
+/*
+ * Translates a file descriptor argument of the synchronous engine.
+ */
+static int fileDescriptor(AioRing ring, jint fd) {
+    if ((fd & AIO_FIXED_FILE_TAG) != 0 && fd >= 0) {
+        jint index = fd & ~AIO_FIXED_FILE_TAG;
+        mutex_enter(&ring->submitLock);
+        fd = index < ring->filesLength ? ring->files[index] : -1;
+        mutex_exit(&ring->submitLock);
+    }
+    return fd;
+}
+
+jint aio_read(AioRing ring, jint fd, void *buf, jint nbytes, jlong offset, jlong userData) {
+#if AIO_IO_URING
+    if (ring->fd >= 0) {
+        return queue(ring, IORING_OP_READ, fd, (Address) buf, nbytes, offset, 0, 0, 0, userData);
+    }
+#endif
+    int f = fileDescriptor(ring, fd);
+    return complete(ring, userData, offset < 0 ? read(f, buf, (size_t) nbytes) : pread(f, buf, (size_t) nbytes, (off_t) offset));
+}
+
+jint aio_write(AioRing ring, jint fd, void *buf, jint nbytes, jlong offset, jlong userData) {
+#if AIO_IO_URING
+    if (ring->fd >= 0) {
+        return queue(ring, IORING_OP_WRITE, fd, (Address) buf, nbytes, offset, 0, 0, 0, userData);
+    }
+#endif
+    int f = fileDescriptor(ring, fd);
+    return complete(ring, userData, offset < 0 ? write(f, buf, (size_t) nbytes) : pwrite(f, buf, (size_t) nbytes, (off_t) offset));
+}
+
+jint aio_readFixed(AioRing ring, jint fd, void *buf, jint nbytes, jlong offset, jint bufferIndex, jlong userData) {
+#if AIO_IO_URING
+    if (ring->fd >= 0) {
+        return queue(ring, IORING_OP_READ_FIXED, fd, (Address) buf, nbytes, offset, 0, bufferIndex, 0, userData);
+    }
+#endif
+    return aio_read(ring, fd, buf, nbytes, offset, userData);
+}
+
+jint aio_writeFixed(AioRing ring, jint fd, void *buf, jint nbytes, jlong offset, jint bufferIndex, jlong userData) {
+#if AIO_IO_URING
+    if (ring->fd >= 0) {
+        return queue(ring, IORING_OP_WRITE_FIXED, fd, (Address) buf, nbytes, offset, 0, bufferIndex, 0, userData);
+    }
+#endif
+    return aio_write(ring, fd, buf, nbytes, offset, userData);
+}
+
+jint aio_fsync(AioRing ring, jint fd, jlong userData) {
+#if AIO_IO_URING
+    if (ring->fd >= 0) {
+        return queue(ring, IORING_OP_FSYNC, fd, 0, 0, 0, 0, 0, 0, userData);
+    }
+#endif
+    return complete(ring, userData, fsync(fileDescriptor(ring, fd)));
+}
+
+jint aio_accept(AioRing ring, jint fd, void *address, jint *addressLength, jlong userData) {
+#if AIO_IO_URING
+    if (ring->fd >= 0) {
+        return queue(ring, IORING_OP_ACCEPT, fd, (Address) address, 0, 0, 0, 0, (Address) addressLength, userData);
+    }
+#endif
+    return complete(ring, userData, accept(fileDescriptor(ring, fd), (struct sockaddr *) address, (socklen_t *) addressLength));
+}
+
+jint aio_recv(AioRing ring, jint fd, void *buf, jint nbytes, jint flags, jlong userData) {
+#if AIO_IO_URING
+    if (ring->fd >= 0) {
+        return queue(ring, IORING_OP_RECV, fd, (Address) buf, nbytes, 0, (Unsigned4) flags, 0, 0, userData);
+    }
+#endif
+    return complete(ring, userData, recv(fileDescriptor(ring, fd), buf, (size_t) nbytes, flags));
+}
+
+jint aio_send(AioRing ring, jint fd, void *buf, jint nbytes, jint flags, jlong userData) {
+#if AIO_IO_URING
+    if (ring->fd >= 0) {
+        return queue(ring, IORING_OP_SEND, fd, (Address) buf, nbytes, 0, (Unsigned4) flags, 0, 0, userData);
+    }
+#endif
+    return complete(ring, userData, send(fileDescriptor(ring, fd), buf, (size_t) nbytes, flags));
+}
+
+jint aio_submit(AioRing ring, jint minComplete) {
+#if AIO_IO_URING
+    if (ring->fd >= 0) {
+        mutex_enter(&ring->submitLock);
+        int result = enter(ring);
+        mutex_exit(&ring->submitLock);
+        if (result >= 0 && minComplete > 0) {
+            int waited = waitForCompletions(ring, (unsigned) minComplete);
+            if (waited < 0) {
+                return waited;
+            }
+        }
+        return result;
+    }
+#endif
+    return 0;
+}
+
+jint aio_drain(AioRing ring, jlong *userData, jint *results, jint max, jint minComplete) {
+    jint n = 0;
+#if AIO_IO_URING
+    if (ring->fd >= 0) {
+        mutex_enter(&ring->completeLock);
+        unsigned head = *ring->cqHead;
+        unsigned available = __atomic_load_n(ring->cqTail, __ATOMIC_ACQUIRE) - head;
+        int result = 0;
+        mutex_enter(&ring->submitLock);
+        if (ring->pending > 0) {
+            result = enter(ring);
+        }
+        mutex_exit(&ring->submitLock);
+        if (result >= 0 && available < (unsigned) minComplete) {
+            result = waitForCompletions(ring, (unsigned) minComplete - available);
+        }
+        if (result < 0 && available == 0) {
+            mutex_exit(&ring->completeLock);
+            return result;
+        }
+        for (;;) {
+            unsigned tail = __atomic_load_n(ring->cqTail, __ATOMIC_ACQUIRE);
+            while (head != tail && n < max) {
+                struct io_uring_cqe *cqe = &ring->cqes[head & ring->cqMask];
+                userData[n] = (jlong) cqe->user_data;
+                results[n] = cqe->res;
+                n++;
+                head++;
+            }
+            __atomic_store_n(ring->cqHead, head, __ATOMIC_RELEASE);
+            if (n == max || (__atomic_load_n(ring->sqFlags, __ATOMIC_ACQUIRE) & IORING_SQ_CQ_OVERFLOW) == 0) {
+                break;
+            }
+            /* The kernel holds completions that did not fit in the completion queue, which entering moves into the room just made. */
+            if (waitForCompletions(ring, 0) < 0) {
+                break;
+            }
+        }
+        /* Kernels without IORING_FEAT_NODROP drop the completions that do not fit instead. */
+        unsigned overflow = __atomic_load_n(ring->cqOverflow, __ATOMIC_ACQUIRE);
+        if (overflow != ring->cqOverflowSeen) {
+            log_println("aio: %u completions were lost because the completion queue was full", overflow - ring->cqOverflowSeen);
+            ring->cqOverflowSeen = overflow;
+            if (n == 0) {
+                n = -EOVERFLOW;
+            }
+        }
+        mutex_exit(&ring->completeLock);
+        return n;
+    }
+#endif
+    /* Synchronous operations have all completed, so there is nothing to wait for. */
+    mutex_enter(&ring->completeLock);
+    n = ring->completionsLength < max ? ring->completionsLength : max;
+    jint i;
+    for (i = 0; i < n; i++) {
+        userData[i] = ring->completions[i].userData;
+        results[i] = ring->completions[i].result;
+    }
+    ring->completionsLength -= n;
+    memmove(ring->completions, ring->completions + n, ring->completionsLength * sizeof(AioCompletionStruct));
+    mutex_exit(&ring->completeLock);
+    return n;
+}
+
+/*
+ * The entry points of com.sun.max.vm.runtime.AsyncIO. The operations are JNI methods because the
+ * synchronous engine performs them when they are queued, and draining can wait for completions.
+ */
+
+JNIEXPORT jint JNICALL
+Java_com_sun_max_vm_runtime_AsyncIO_nativeRead(JNIEnv *env, jclass c, AioRing ring, jint fd, Address buf, jint nbytes, jlong offset, jlong userData) {
+    return aio_read(ring, fd, (void *) buf, nbytes, offset, userData);
+}
+
+JNIEXPORT jint JNICALL
+Java_com_sun_max_vm_runtime_AsyncIO_nativeWrite(JNIEnv *env, jclass c, AioRing ring, jint fd, Address buf, jint nbytes, jlong offset, jlong userData) {
+    return aio_write(ring, fd, (void *) buf, nbytes, offset, userData);
+}
+
+JNIEXPORT jint JNICALL
+Java_com_sun_max_vm_runtime_AsyncIO_nativeReadFixed(JNIEnv *env, jclass c, AioRing ring, jint fd, Address buf, jint nbytes, jlong offset, jint bufferIndex, jlong userData) {
+    return aio_readFixed(ring, fd, (void *) buf, nbytes, offset, bufferIndex, userData);
+}
+
+JNIEXPORT jint JNICALL
+Java_com_sun_max_vm_runtime_AsyncIO_nativeWriteFixed(JNIEnv *env, jclass c, AioRing ring, jint fd, Address buf, jint nbytes, jlong offset, jint bufferIndex, jlong userData) {
+    return aio_writeFixed(ring, fd, (void *) buf, nbytes, offset, bufferIndex, userData);
+}
+
+JNIEXPORT jint JNICALL
+Java_com_sun_max_vm_runtime_AsyncIO_nativeFsync(JNIEnv *env, jclass c, AioRing ring, jint fd, jlong userData) {
+    return aio_fsync(ring, fd, userData);
+}
+
+JNIEXPORT jint JNICALL
+Java_com_sun_max_vm_runtime_AsyncIO_nativeAccept(JNIEnv *env, jclass c, AioRing ring, jint fd, Address address, Address addressLength, jlong userData) {
+    return aio_accept(ring, fd, (void *) address, (jint *) addressLength, userData);
+}
+
+JNIEXPORT jint JNICALL
+Java_com_sun_max_vm_runtime_AsyncIO_nativeRecv(JNIEnv *env, jclass c, AioRing ring, jint fd, Address buf, jint nbytes, jint flags, jlong userData) {
+    return aio_recv(ring, fd, (void *) buf, nbytes, flags, userData);
+}
+
+JNIEXPORT jint JNICALL
+Java_com_sun_max_vm_runtime_AsyncIO_nativeSend(JNIEnv *env, jclass c, AioRing ring, jint fd, Address buf, jint nbytes, jint flags, jlong userData) {
+    return aio_send(ring, fd, (void *) buf, nbytes, flags, userData);
+}
+
+JNIEXPORT jint JNICALL
+Java_com_sun_max_vm_runtime_AsyncIO_nativeSubmit(JNIEnv *env, jclass c, AioRing ring, jint minComplete) {
+    return aio_submit(ring, minComplete);
+}
+
+JNIEXPORT jint JNICALL
+Java_com_sun_max_vm_runtime_AsyncIO_nativeDrain(JNIEnv *env, jclass c, AioRing ring, Address userData, Address results, jint max, jint minComplete) {
+    return aio_drain(ring, (jlong *) userData, (jint *) results, max, minComplete);
+}
+
+JNIEXPORT jint JNICALL
+Java_com_sun_max_vm_runtime_AsyncIO_nativeRegisterBuffers(JNIEnv *env, jclass c, AioRing ring, Address iov, jint count) {
+    return aio_registerBuffers(ring, (void *) iov, count);
+}
+
+JNIEXPORT jint JNICALL
+Java_com_sun_max_vm_runtime_AsyncIO_nativeRegisterFiles(JNIEnv *env, jclass c, AioRing ring, Address fds, jint count) {
+    return aio_registerFiles(ring, (jint *) fds, count);
+}
+
+#else
+
+void aio_setUseIoUring(jboolean value) {
+}
+
+AioRing aio_createRing(jint entries) {
+    return NULL;
+}
+
+void aio_destroyRing(AioRing ring) {
+}
+
+AioRing aio_currentThreadRing(void) {
+    return NULL;
+}
+
+AioRing aio_sharedRing(void) {
+    return NULL;
+}
+
+void aio_threadExiting(void) {
+}
+
+jboolean aio_isAsynchronous(AioRing ring) {
+    return false;
+}
+
+#endif
@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2011, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ */
+#ifndef __aio_h__
+#define __aio_h__ 1
+
+#include "word.h"
+#include "jni.h"
+
+/*
+ * Asynchronous I/O rings.
+ *
+ * A ring queues read, write, fsync, accept, recv and send operations, each tagged with a caller chosen
+ * 64-bit value, and delivers their results as completions that a poller drains in batches. On Linux
+ * kernels with io_uring, a ring is an io_uring instance: queued operations are handed to the kernel
+ * by aio_submit() (or implicitly when the submission queue is full) and many operations cost a single
+ * system call. Elsewhere, or with -XX:-IoUring, an operation is performed synchronously when it is
+ * queued and its completion is recorded for the next drain, so callers need not care which engine is used.
+ *
+ * The result of a completion follows the io_uring convention: the non-negative result of the operation
+ * or a negated errno value.
+ *
+ * A ring may be used by several threads. The ring of the current thread (aio_currentThreadRing())
+ * is destroyed when the thread exits.
+ */
+
+typedef struct AioRingStruct *AioRing;
+
+/*
+ * The number of submission queue entries of the rings created by aio_currentThreadRing() and aio_sharedRing().
+ */
+#define AIO_DEFAULT_ENTRIES 256
+
+/*
+ * Tags a file descriptor argument as an index into the files registered with aio_registerFiles().
+ */
+#define AIO_FIXED_FILE_TAG 0x40000000
+#define AIO_FIXED_FILE(index) ((index) | AIO_FIXED_FILE_TAG)
+
+/**
+ * Selects whether rings use io_uring when the kernel supports it. This must be called before the first ring is created.
+ */
+extern void aio_setUseIoUring(jboolean value);
+
+/**
+ * Creates a ring.
+ *
+ * @param entries the minimum number of operations that can be queued before they must be submitted
+ * @return NULL if the ring could not be allocated
+ */
+extern AioRing aio_createRing(jint entries);
+
+extern void aio_destroyRing(AioRing ring);
+
+/**
+ * Gets the ring of the current thread, creating it if necessary.
+ */
+extern AioRing aio_currentThreadRing(void);
+
+/**
+ * Gets the ring shared by all threads, creating it if necessary.
+ */
+extern AioRing aio_sharedRing(void);
+
+/**
+ * Destroys the ring of the current thread, if any.
+ */
+extern void aio_threadExiting(void);
+
+/**
+ * Determines if the operations queued on a ring are performed asynchronously by the kernel.
+ */
+extern jboolean aio_isAsynchronous(AioRing ring);
+
+/**
+ * Registers buffers with a ring for use by aio_readFixed() and aio_writeFixed(), replacing any registered before.
+ *
+ * @param iov an array of 'count' struct iovec
+ * @return 0 or a negated errno value
+ */
+extern jint aio_registerBuffers(AioRing ring, void *iov, jint count);
+
+/**
+ * Registers file descriptors with a ring, replacing any registered before. The operations of a ring
+ * accept AIO_FIXED_FILE(i) in place of the file descriptor at index i.
+ *
+ * @return 0 or a negated errno value
+ */
+extern jint aio_registerFiles(AioRing ring, jint *fds, jint count);
+
+/*
+ * The operations. An offset of -1 reads or writes at the file position (like JVM_Read() and JVM_Write()).
+ * These return 0 if the operation was queued or a negated errno value if it could not be.
+ */
+extern jint aio_read(AioRing ring, jint fd, void *buf, jint nbytes, jlong offset, jlong userData);
+extern jint aio_write(AioRing ring, jint fd, void *buf, jint nbytes, jlong offset, jlong userData);
+extern jint aio_readFixed(AioRing ring, jint fd, void *buf, jint nbytes, jlong offset, jint bufferIndex, jlong userData);
+extern jint aio_writeFixed(AioRing ring, jint fd, void *buf, jint nbytes, jlong offset, jint bufferIndex, jlong userData);
+extern jint aio_fsync(AioRing ring, jint fd, jlong userData);
+extern jint aio_accept(AioRing ring, jint fd, void *address, jint *addressLength, jlong userData);
+extern jint aio_recv(AioRing ring, jint fd, void *buf, jint nbytes, jint flags, jlong userData);
+extern jint aio_send(AioRing ring, jint fd, void *buf, jint nbytes, jint flags, jlong userData);
+
+/**
+ * Submits the queued operations to the kernel and optionally waits for completions.
+ *
+ * @param minComplete the number of completions to wait for
+ * @return the number of operations submitted or a negated errno value
+ */
+extern jint aio_submit(AioRing ring, jint minComplete);
+
+/**
+ * Drains completions from a ring, submitting any queued operations first.
+ *
+ * @param userData receives the tags of the completed operations
+ * @param results receives the results of the completed operations
+ * @param max the length of the 'userData' and 'results' arrays
+ * @param minComplete the number of completions to wait for (not more than 'max')
+ * @return the number of completions drained or a negated errno value, which is -EOVERFLOW if none
+ *         was drained and the kernel dropped completions because the completion queue was full
+ */
+extern jint aio_drain(AioRing ring, jlong *userData, jint *results, jint max, jint minComplete);
+
+#endif /*__aio_h__*/
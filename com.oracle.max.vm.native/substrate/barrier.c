@@ -22,12 +22,17 @@
  * This system call causes an inter-processor-interrupt (IPI) to be delivered
  * to concurrently executing cores on the current system. On Aarch64 platforms
  * we use that mechanism to synchronise instruction streams on multi-cores.
+ * On all platforms, the VM operation thread uses it for handshakes with the
+ * threads it freezes: a single barrier makes the safepoint latches it has just
+ * triggered visible to the running threads (and serializes their memory accesses)
+ * without each of them having to execute a fence.
  */
 
 #include <stdlib.h>
 #include <stdio.h>
 #include "log.h"
 #include "os.h"
+#include "jni.h"
 #if os_LINUX
 #include "isa.h"
 #include <unistd.h>
@@ -38,8 +43,7 @@
 
 /*
  * Pre-processor override for whether to compile in the membarrier system call.
- * Currently only affects Aarch64. See syscall_membarrier() in this compilation
- * unit.
+ * See syscall_membarrier() in this compilation unit.
  */
 #ifndef USE_SYS_MEMBARRIER
 # define USE_SYS_MEMBARRIER 1
@@ -51,10 +55,24 @@
  */
 #define membarrier(cmd, flags) syscall(__NR_membarrier, cmd, flags)
 
+/*
+ * The barrier command used, 0 if not yet determined and -1 if no barrier is available.
+ */
+static volatile int barrier_kind = 0;
+
 /*
  * Initialise the system to use the best available barrier.
  */
-static int membarrier_init(void) __attribute__ ((unused));
+static int membarrier_init(void);
+
+static int
+membarrier_kind(void)
+{
+    if (!barrier_kind) {
+        barrier_kind = membarrier_init();
+    }
+    return barrier_kind;
+}
 
 /*
  * Execute the membarrier system call
@@ -62,17 +80,82 @@ static int membarrier_init(void) __attribute__ ((unused));
 void
 syscall_membarrier()
 {
-#if isa_AARCH64
-# if USE_SYS_MEMBARRIER
-    static volatile int barrier_kind = 0;
-    if (!barrier_kind) {
-        barrier_kind = membarrier_init();
+#if USE_SYS_MEMBARRIER
+    int kind = membarrier_kind();
+    if (kind < 0) {
+        log_exit(1, "No useable barrier on this platform.");
     }
-    membarrier(barrier_kind, 0);
-# endif /* USE_SYS_MEMBARRIER */
+    membarrier(kind, 0);
+#endif /* USE_SYS_MEMBARRIER */
+}
+
+/*
+ * Determines if syscall_membarrier() can be used. Unlike syscall_membarrier(), this
+ * does not exit the VM if no barrier is available.
+ */
+jboolean
+membarrier_isAvailable()
+{
+#if USE_SYS_MEMBARRIER
+    return membarrier_kind() > 0;
 #else
-    log_exit(1, "membarrier not configured on this platform");
-#endif /* isa_AARCH64 */
+    return JNI_FALSE;
+#endif
+}
+
+/*
+ * Determines if syscall_membarrier() only interrupts the CPUs running threads of this process.
+ */
+jboolean
+membarrier_isExpedited()
+{
+#if USE_SYS_MEMBARRIER && LINUX_VERSION_CODE >= KERNEL_VERSION(4,14,0)
+    return membarrier_kind() == MEMBARRIER_CMD_PRIVATE_EXPEDITED;
+#else
+    return JNI_FALSE;
+#endif
+}
+
+/*
+ * The core serializing barrier command, 0 if not yet determined and -1 if it is not available.
+ */
+static volatile int sync_core_kind = 0;
+
+static int
+membarrier_sync_core_init(void)
+{
+#if defined(MEMBARRIER_CMD_PRIVATE_EXPEDITED_SYNC_CORE)
+    long lv = membarrier(MEMBARRIER_CMD_QUERY, 0);
+    if (lv > 0 && (lv & MEMBARRIER_CMD_PRIVATE_EXPEDITED_SYNC_CORE) &&
+        membarrier(MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED_SYNC_CORE, 0) == 0) {
+        if (log_MEMBARRIER) {
+            log_println("Using private expedited core serializing barrier");
+        }
+        return MEMBARRIER_CMD_PRIVATE_EXPEDITED_SYNC_CORE;
+    }
+#endif
+    return -1;
+}
+
+/*
+ * Executes a barrier after cross-modifying code. In addition to the guarantees of
+ * syscall_membarrier(), the core serializing barrier makes every thread of the process
+ * discard instructions it may have fetched before the modification. Where the kernel
+ * does not provide it, this falls back to syscall_membarrier().
+ */
+void
+syscall_membarrierSyncCore()
+{
+#if USE_SYS_MEMBARRIER
+    if (!sync_core_kind) {
+        sync_core_kind = membarrier_sync_core_init();
+    }
+    if (sync_core_kind > 0) {
+        membarrier(sync_core_kind, 0);
+        return;
+    }
+#endif /* USE_SYS_MEMBARRIER */
+    syscall_membarrier();
 }
 
 static int
@@ -83,7 +166,10 @@ membarrier_init(void)
     lv = membarrier(MEMBARRIER_CMD_QUERY, 0);
 
     if (lv <= 0) {
-        log_exit(1, "No barriers available on this platform.");
+        if (log_MEMBARRIER) {
+            log_println("No barriers available on this platform.");
+        }
+        return -1;
     }
 
 #if LINUX_VERSION_CODE >= KERNEL_VERSION(4,14,0)
@@ -116,7 +202,10 @@ membarrier_init(void)
         return MEMBARRIER_CMD_SHARED;
     }
     /* No useable barrier available. */
-    log_exit(1, "No useable barrier on this platform.");
+    if (log_MEMBARRIER) {
+        log_println("No useable barrier on this platform.");
+    }
+    return -1;
 }
 
 #else
@@ -126,5 +215,22 @@ syscall_membarrier()
 {
     log_exit(1, "membarrier not available on this platform");
 }
-#endif /* os_LINUX */
 
+void
+syscall_membarrierSyncCore()
+{
+    log_exit(1, "membarrier not available on this platform");
+}
+
+jboolean
+membarrier_isAvailable()
+{
+    return JNI_FALSE;
+}
+
+jboolean
+membarrier_isExpedited()
+{
+    return JNI_FALSE;
+}
+#endif /* os_LINUX */
@@ -0,0 +1,1068 @@
+/*
+ * Copyright (c) 2011, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ */
+/**
+ * A heap dump writer in the HPROF binary format, as produced by jmm_DumpHeap0.
+ *
+ * The VM operation that walks the heap hands the objects it finds to this writer in batches (see HeapDump.java).
+ * A pool of worker threads serializes the batches in parallel, each into its own buffer of complete HPROF records,
+ * while the heap stays frozen at the safepoint. The full buffers are (optionally) compressed by the worker that
+ * filled them, each one as a separate member of a gzip file, and queued to a single output thread that writes them
+ * in the order they were queued with large sequential writes.
+ *
+ * The records that must precede the objects using them (names, class loads and class dumps) are written by the
+ * thread that defines the classes and its buffer is queued before the batch that first uses them.
+ */
+#include "os.h"
+#include "log.h"
+#include "jni.h"
+#include "word.h"
+#include "dataio.h"
+
+#if os_LINUX || os_DARWIN || os_SOLARIS
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+#include "condition.h"
+#include "mutex.h"
+
+#if os_LINUX
+#define COMPRESSED_DUMP 1
+#include <zlib.h>
+#else
+#define COMPRESSED_DUMP 0
+#endif
+
+extern jint JVM_ActiveProcessorCount(void);
+
+#define MAX_WORKERS 32
+
+/* The size of the buffer of each writer, which is also the size of the chunks queued for output before compression. */
+#define BUFFER_SIZE (4 * 1024 * 1024)
+
+/* The most chunks queued for output and batches queued for the workers, per worker. */
+#define PENDING_PER_WORKER 2
+
+#define CLASS_BUCKETS 4096
+#define NAME_BUCKETS 65536
+
+#define ID_SIZE ((int) sizeof(Address))
+
+/* Top level record tags. */
+#define HPROF_UTF8 0x01
+#define HPROF_LOAD_CLASS 0x02
+#define HPROF_FRAME 0x04
+#define HPROF_TRACE 0x05
+#define HPROF_HEAP_DUMP_SEGMENT 0x1C
+#define HPROF_HEAP_DUMP_END 0x2C
+
+/* Heap dump sub-record tags. */
+#define HPROF_GC_ROOT_JNI_GLOBAL 0x01
+#define HPROF_GC_ROOT_STICKY_CLASS 0x05
+#define HPROF_GC_ROOT_THREAD_OBJ 0x08
+#define HPROF_GC_CLASS_DUMP 0x20
+#define HPROF_GC_INSTANCE_DUMP 0x21
+#define HPROF_GC_OBJ_ARRAY_DUMP 0x22
+#define HPROF_GC_PRIM_ARRAY_DUMP 0x23
+
+/* Basic types, as used in entries and class descriptors. */
+#define HPROF_NORMAL_OBJECT 2
+#define HPROF_BOOLEAN 4
+#define HPROF_CHAR 5
+#define HPROF_FLOAT 6
+#define HPROF_DOUBLE 7
+#define HPROF_BYTE 8
+#define HPROF_SHORT 9
+#define HPROF_INT 10
+#define HPROF_LONG 11
+
+/* The serial number of the (empty) stack trace referenced by all objects. */
+#define STACK_TRACE_SERIAL 1
+
+#define RECORD_HEADER_SIZE 9
+
+/* The most bytes of a top level record, whose length is a u4. */
+#define MAX_RECORD_LENGTH ((Size) 0xFFFFFFFF)
+
+#define NO_SEGMENT ((Size) -1)
+
+/*
+ * An object in a batch given to nativeDumpObjects. The layout must be kept in sync with
+ * HeapDump.ENTRY_SIZE and the offsets used by HeapDump.DumpVisitor.
+ */
+typedef struct {
+    /* The origin of the object. */
+    Address address;
+    jlong classId;
+    /* 0 for a tuple, the basic type of the elements for an array. */
+    jint type;
+    jint length;
+    /* The offset of the first element of an array from its origin. */
+    jint elementsOffset;
+    jint padding;
+} heapDump_EntryStruct, *heapDump_Entry;
+
+/*
+ * The class descriptor given to nativeDefineClass, followed by 'staticCount' static fields and 'fieldCount'
+ * instance fields. The layout must be kept in sync with HeapDump.defineClass.
+ */
+typedef struct {
+    jlong classId;
+    jlong superId;
+    jlong loaderId;
+    jlong nameId;
+    jint instanceSize;
+    jint staticCount;
+    jint fieldCount;
+    jint padding;
+} heapDump_ClassDescriptorStruct;
+
+typedef struct {
+    jlong nameId;
+    jlong value;
+    jint type;
+    jint padding;
+} heapDump_StaticFieldStruct;
+
+typedef struct {
+    jlong nameId;
+    jint type;
+    jint offset;
+} heapDump_FieldStruct;
+
+typedef struct ChunkStruct {
+    struct ChunkStruct *next;
+    Size size;
+    Byte data[1];
+} ChunkStruct, *Chunk;
+
+typedef struct JobStruct {
+    struct JobStruct *next;
+    jint count;
+    heapDump_EntryStruct entries[1];
+} JobStruct, *Job;
+
+typedef struct ClassInfoStruct {
+    jlong id;
+    struct ClassInfoStruct *superClass;
+    /* The size of the values of the instance fields of the class and its super classes. */
+    Size valuesSize;
+    jint fieldCount;
+    jint *offsets;
+    Byte *types;
+    struct ClassInfoStruct *next;
+} ClassInfoStruct, *ClassInfo;
+
+typedef struct NameStruct {
+    jlong id;
+    struct NameStruct *next;
+} NameStruct, *Name;
+
+typedef struct {
+    Chunk buffer;
+    Size used;
+    /* The offset of the header of the heap dump segment being filled, or NO_SEGMENT. */
+    Size segmentStart;
+    /* Set while the writer streams a record that does not fit in one buffer, holding 'submitLock'. */
+    jboolean exclusive;
+#if COMPRESSED_DUMP
+    jboolean deflating;
+    z_stream stream;
+#endif
+} WriterStruct, *Writer;
+
+typedef struct HeapDumpStruct *HeapDump;
+
+typedef struct {
+    HeapDump dump;
+    Writer writer;
+} WorkerArgumentStruct;
+
+typedef struct HeapDumpStruct {
+    int fd;
+    jboolean compress;
+    jboolean failed;
+
+    /* Protects the queues. */
+    mutex_Struct lock;
+    /* Notified when a queue changes or the dump is closing. */
+    condition_Struct changed;
+    /* Held while queueing output chunks, to keep the chunks of a record streamed by one writer together. */
+    mutex_Struct submitLock;
+
+    Chunk outputHead;
+    Chunk outputTail;
+    int outputCount;
+    jboolean outputClosed;
+    jboolean outputRunning;
+    pthread_t outputThread;
+
+    Job jobHead;
+    Job jobTail;
+    int jobCount;
+    jboolean closing;
+
+    int workerCount;
+    pthread_t workers[MAX_WORKERS];
+    WriterStruct workerWriters[MAX_WORKERS];
+    WorkerArgumentStruct workerArguments[MAX_WORKERS];
+
+    /* The writer of the thread that defines the classes. */
+    WriterStruct writer;
+
+    /* Only accessed by the thread that defines the classes, except for lookups by the workers. */
+    ClassInfo classes[CLASS_BUCKETS];
+    Name names[NAME_BUCKETS];
+    jint classCount;
+} HeapDumpStruct;
+
+static inline Byte *putU1(Byte *p, int value) {
+    *p = (Byte) value;
+    return p + 1;
+}
+
+static inline Byte *putU2(Byte *p, jint value) {
+    p[0] = (Byte) (value >> 8);
+    p[1] = (Byte) value;
+    return p + 2;
+}
+
+static inline Byte *putU4(Byte *p, jint value) {
+    writeBigEndianUnsigned4((Address) p, (Unsigned4) value);
+    return p + 4;
+}
+
+static inline Byte *putU8(Byte *p, jlong value) {
+    writeBigEndianUnsigned8((Address) p, (Unsigned8) value);
+    return p + 8;
+}
+
+static inline Byte *putID(Byte *p, jlong id) {
+#if word_64_BITS
+    return putU8(p, id);
+#else
+    return putU4(p, (jint) id);
+#endif
+}
+
+static int typeSize(int type) {
+    switch (type) {
+        case HPROF_NORMAL_OBJECT:
+            return ID_SIZE;
+        case HPROF_BOOLEAN:
+        case HPROF_BYTE:
+            return 1;
+        case HPROF_CHAR:
+        case HPROF_SHORT:
+            return 2;
+        case HPROF_FLOAT:
+        case HPROF_INT:
+            return 4;
+        default:
+            return 8;
+    }
+}
+
+/**
+ * Writes the value of a field of a given basic type, read in native byte order from 'src'.
+ */
+static Byte *putValue(Byte *p, int type, Address src) {
+    switch (type) {
+        case HPROF_NORMAL_OBJECT:
+            return putID(p, (jlong) *(Address *) src);
+        case HPROF_BOOLEAN:
+        case HPROF_BYTE:
+            return putU1(p, *(Byte *) src);
+        case HPROF_CHAR:
+        case HPROF_SHORT:
+            return putU2(p, *(jshort *) src);
+        case HPROF_FLOAT:
+        case HPROF_INT:
+            return putU4(p, *(jint *) src);
+        default:
+            return putU8(p, *(jlong *) src);
+    }
+}
+
+/**
+ * Writes the low 'typeSize(type)' bytes of a value.
+ */
+static Byte *putRawValue(Byte *p, int type, jlong value) {
+    switch (typeSize(type)) {
+        case 1:
+            return putU1(p, (int) value);
+        case 2:
+            return putU2(p, (jint) value);
+        case 4:
+            return putU4(p, (jint) value);
+        default:
+            return putU8(p, value);
+    }
+}
+
+static Chunk newChunk(Size capacity) {
+    return (Chunk) malloc(sizeof(ChunkStruct) + capacity);
+}
+
+static boolean writeFully(int fd, Byte *data, Size size) {
+    while (size > 0) {
+        ssize_t n = write(fd, data, size);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += n;
+        size -= n;
+    }
+    return true;
+}
+
+static void *output_run(void *arg) {
+    HeapDump dump = (HeapDump) arg;
+    mutex_enter(&dump->lock);
+    while (true) {
+        Chunk chunk;
+        while (dump->outputHead == NULL && !dump->outputClosed) {
+            condition_wait(&dump->changed, &dump->lock);
+        }
+        chunk = dump->outputHead;
+        if (chunk == NULL) {
+            break;
+        }
+        dump->outputHead = chunk->next;
+        if (dump->outputHead == NULL) {
+            dump->outputTail = NULL;
+        }
+        dump->outputCount--;
+        condition_notifyAll(&dump->changed);
+        mutex_exit(&dump->lock);
+
+        if (!dump->failed && !writeFully(dump->fd, chunk->data, chunk->size)) {
+            log_println("heap dump: write failed: %s", strerror(errno));
+            dump->failed = true;
+        }
+        free(chunk);
+        mutex_enter(&dump->lock);
+    }
+    mutex_exit(&dump->lock);
+    return NULL;
+}
+
+/**
+ * Queues a chunk for output, waiting while the output queue is full. If there is no output thread,
+ * the chunk is written by the caller.
+ */
+static void queueChunk(HeapDump dump, Chunk chunk) {
+    mutex_enter(&dump->lock);
+    if (!dump->outputRunning) {
+        if (!dump->failed && !writeFully(dump->fd, chunk->data, chunk->size)) {
+            log_println("heap dump: write failed: %s", strerror(errno));
+            dump->failed = true;
+        }
+        free(chunk);
+    } else {
+        while (dump->outputCount >= PENDING_PER_WORKER * (dump->workerCount + 1)) {
+            condition_wait(&dump->changed, &dump->lock);
+        }
+        chunk->next = NULL;
+        if (dump->outputTail == NULL) {
+            dump->outputHead = chunk;
+        } else {
+            dump->outputTail->next = chunk;
+        }
+        dump->outputTail = chunk;
+        dump->outputCount++;
+        condition_notifyAll(&dump->changed);
+    }
+    mutex_exit(&dump->lock);
+}
+
+static void writer_initialize(Writer writer) {
+    memset(writer, 0, sizeof(WriterStruct));
+    writer->segmentStart = NO_SEGMENT;
+}
+
+static void writer_release(Writer writer) {
+    free(writer->buffer);
+    writer->buffer = NULL;
+#if COMPRESSED_DUMP
+    if (writer->deflating) {
+        deflateEnd(&writer->stream);
+        writer->deflating = false;
+    }
+#endif
+}
+
+/**
+ * Patches the length of the heap dump segment being filled, if any.
+ */
+static void closeSegment(Writer writer) {
+    if (writer->segmentStart != NO_SEGMENT) {
+        Size length = writer->used - writer->segmentStart - RECORD_HEADER_SIZE;
+        putU4(writer->buffer->data + writer->segmentStart + 5, (jint) length);
+        writer->segmentStart = NO_SEGMENT;
+    }
+}
+
+#if COMPRESSED_DUMP
+/**
+ * Compresses the used part of the buffer of a writer into a new chunk, as a complete gzip member.
+ */
+static Chunk compressBuffer(HeapDump dump, Writer writer) {
+    Chunk chunk;
+    Size capacity;
+    if (!writer->deflating) {
+        memset(&writer->stream, 0, sizeof(writer->stream));
+        /* Favor speed: the dump is taken while the VM is stopped. 16 selects a gzip header and trailer. */
+        if (deflateInit2(&writer->stream, Z_BEST_SPEED, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            return NULL;
+        }
+        writer->deflating = true;
+    } else if (deflateReset(&writer->stream) != Z_OK) {
+        return NULL;
+    }
+    capacity = deflateBound(&writer->stream, writer->used);
+    chunk = newChunk(capacity);
+    if (chunk == NULL) {
+        return NULL;
+    }
+    writer->stream.next_in = writer->buffer->data;
+    writer->stream.avail_in = writer->used;
+    writer->stream.next_out = chunk->data;
+    writer->stream.avail_out = capacity;
+    if (deflate(&writer->stream, Z_FINISH) != Z_STREAM_END) {
+        free(chunk);
+        return NULL;
+    }
+    chunk->size = writer->stream.total_out;
+    return chunk;
+}
+#endif
+
+/**
+ * Queues the records in the buffer of a writer for output and empties the buffer.
+ *
+ * @return false if the dump has failed
+ */
+static boolean submit(HeapDump dump, Writer writer) {
+    Chunk chunk;
+    closeSegment(writer);
+    if (writer->used == 0 || dump->failed) {
+        writer->used = 0;
+        return !dump->failed;
+    }
+#if COMPRESSED_DUMP
+    if (dump->compress) {
+        chunk = compressBuffer(dump, writer);
+        if (chunk == NULL) {
+            log_println("heap dump: compression failed");
+            dump->failed = true;
+            return false;
+        }
+    } else
+#endif
+    {
+        chunk = writer->buffer;
+        chunk->size = writer->used;
+        writer->buffer = newChunk(BUFFER_SIZE);
+        if (writer->buffer == NULL) {
+            writer->buffer = chunk;
+            log_println("heap dump: could not allocate buffer");
+            dump->failed = true;
+            return false;
+        }
+    }
+    writer->used = 0;
+    if (!writer->exclusive) {
+        mutex_enter(&dump->submitLock);
+    }
+    queueChunk(dump, chunk);
+    if (!writer->exclusive) {
+        mutex_exit(&dump->submitLock);
+    }
+    return true;
+}
+
+static Byte *putRecordHeader(Byte *p, int tag, Size length) {
+    p = putU1(p, tag);
+    p = putU4(p, 0);
+    return putU4(p, (jint) length);
+}
+
+/**
+ * Reserves space in the buffer of a writer for a top level record.
+ *
+ * @param length the length of the body of the record, at most BUFFER_SIZE - RECORD_HEADER_SIZE
+ * @return the address at which the body of the record is to be written, or NULL if the dump has failed
+ */
+static Byte *beginRecord(HeapDump dump, Writer writer, int tag, Size length) {
+    Byte *p;
+    closeSegment(writer);
+    if (writer->used + RECORD_HEADER_SIZE + length > BUFFER_SIZE && !submit(dump, writer)) {
+        return NULL;
+    }
+    if (dump->failed) {
+        return NULL;
+    }
+    p = putRecordHeader(writer->buffer->data + writer->used, tag, length);
+    writer->used += RECORD_HEADER_SIZE + length;
+    return p;
+}
+
+/**
+ * Reserves space in the buffer of a writer for a heap dump sub-record, in the heap dump segment being filled
+ * or in a new one.
+ *
+ * @param length the length of the sub-record, at most BUFFER_SIZE - RECORD_HEADER_SIZE
+ * @return the address at which the sub-record is to be written, or NULL if the dump has failed
+ */
+static Byte *beginSubRecord(HeapDump dump, Writer writer, Size length) {
+    Byte *p;
+    Size needed = length + (writer->segmentStart == NO_SEGMENT ? RECORD_HEADER_SIZE : 0);
+    if (writer->used + needed > BUFFER_SIZE) {
+        if (!submit(dump, writer)) {
+            return NULL;
+        }
+    }
+    if (dump->failed) {
+        return NULL;
+    }
+    if (writer->segmentStart == NO_SEGMENT) {
+        writer->segmentStart = writer->used;
+        putRecordHeader(writer->buffer->data + writer->used, HPROF_HEAP_DUMP_SEGMENT, 0);
+        writer->used += RECORD_HEADER_SIZE;
+    }
+    p = writer->buffer->data + writer->used;
+    writer->used += length;
+    return p;
+}
+
+static ClassInfo findClass(HeapDump dump, jlong id) {
+    ClassInfo info;
+    for (info = dump->classes[((Unsigned8) id >> 3) % CLASS_BUCKETS]; info != NULL; info = info->next) {
+        if (info->id == id) {
+            return info;
+        }
+    }
+    return NULL;
+}
+
+static void dumpInstance(HeapDump dump, Writer writer, heapDump_Entry entry) {
+    ClassInfo info = findClass(dump, entry->classId);
+    Byte *p;
+    if (info == NULL) {
+        return;
+    }
+    p = beginSubRecord(dump, writer, 1 + ID_SIZE + 4 + ID_SIZE + 4 + info->valuesSize);
+    if (p == NULL) {
+        return;
+    }
+    p = putU1(p, HPROF_GC_INSTANCE_DUMP);
+    p = putID(p, (jlong) entry->address);
+    p = putU4(p, STACK_TRACE_SERIAL);
+    p = putID(p, entry->classId);
+    p = putU4(p, (jint) info->valuesSize);
+    for (; info != NULL; info = info->superClass) {
+        jint i;
+        for (i = 0; i < info->fieldCount; i++) {
+            p = putValue(p, info->types[i], entry->address + info->offsets[i]);
+        }
+    }
+}
+
+/**
+ * Copies 'length' array elements to the buffer of a writer in big endian order.
+ */
+static void putElements(Writer writer, int type, Address src, Size length) {
+    Byte *dst = writer->buffer->data + writer->used;
+    int elementSize = typeSize(type);
+    Size size = length * elementSize;
+    if (elementSize == 1) {
+        memcpy(dst, (void *) src, size);
+    } else {
+        copyConvertingByteOrder((Address) dst, src, size, elementSize, true);
+    }
+    writer->used += size;
+}
+
+static void dumpArray(HeapDump dump, Writer writer, heapDump_Entry entry) {
+    int type = entry->type;
+    int elementSize = typeSize(type);
+    Size headerSize = 1 + ID_SIZE + 4 + 4 + (type == HPROF_NORMAL_OBJECT ? ID_SIZE : 1);
+    Size length = entry->length;
+    Address elements = entry->address + entry->elementsOffset;
+    Size recordSize;
+    Byte *p;
+
+    /* Arrays whose record would be too long for a segment are truncated. */
+    if (headerSize + length * elementSize > MAX_RECORD_LENGTH) {
+        length = (MAX_RECORD_LENGTH - headerSize) / elementSize;
+        log_println("heap dump: array %p of length %d truncated to %d elements", entry->address, entry->length, (int) length);
+    }
+    recordSize = headerSize + length * elementSize;
+
+    if (recordSize + RECORD_HEADER_SIZE > BUFFER_SIZE) {
+        /* Stream the array in a segment of its own, keeping the chunks of the segment together in the output. */
+        if (!submit(dump, writer)) {
+            return;
+        }
+        mutex_enter(&dump->submitLock);
+        writer->exclusive = true;
+        p = putRecordHeader(writer->buffer->data, HPROF_HEAP_DUMP_SEGMENT, recordSize);
+        writer->used = RECORD_HEADER_SIZE + headerSize;
+    } else {
+        p = beginSubRecord(dump, writer, recordSize);
+        if (p == NULL) {
+            return;
+        }
+        writer->used -= recordSize - headerSize;
+    }
+
+    if (type == HPROF_NORMAL_OBJECT) {
+        p = putU1(p, HPROF_GC_OBJ_ARRAY_DUMP);
+        p = putID(p, (jlong) entry->address);
+        p = putU4(p, STACK_TRACE_SERIAL);
+        p = putU4(p, (jint) length);
+        p = putID(p, entry->classId);
+    } else {
+        p = putU1(p, HPROF_GC_PRIM_ARRAY_DUMP);
+        p = putID(p, (jlong) entry->address);
+        p = putU4(p, STACK_TRACE_SERIAL);
+        p = putU4(p, (jint) length);
+        p = putU1(p, type);
+    }
+
+    if (writer->exclusive) {
+        while (length > 0 && !dump->failed) {
+            Size n = (BUFFER_SIZE - writer->used) / elementSize;
+            if (n > length) {
+                n = length;
+            }
+            putElements(writer, type, elements, n);
+            elements += n * elementSize;
+            length -= n;
+            if (length > 0) {
+                submit(dump, writer);
+            }
+        }
+        submit(dump, writer);
+        writer->exclusive = false;
+        mutex_exit(&dump->submitLock);
+    } else {
+        putElements(writer, type, elements, length);
+    }
+}
+
+static void dumpObjects(HeapDump dump, Writer writer, heapDump_Entry entries, jint count) {
+    jint i;
+    for (i = 0; i < count && !dump->failed; i++) {
+        if (entries[i].type == 0) {
+            dumpInstance(dump, writer, &entries[i]);
+        } else {
+            dumpArray(dump, writer, &entries[i]);
+        }
+    }
+}
+
+static void *worker_run(void *arg) {
+    WorkerArgumentStruct *argument = (WorkerArgumentStruct *) arg;
+    HeapDump dump = argument->dump;
+    while (true) {
+        Job job;
+        mutex_enter(&dump->lock);
+        while (dump->jobHead == NULL && !dump->closing) {
+            condition_wait(&dump->changed, &dump->lock);
+        }
+        job = dump->jobHead;
+        if (job != NULL) {
+            dump->jobHead = job->next;
+            if (dump->jobHead == NULL) {
+                dump->jobTail = NULL;
+            }
+            dump->jobCount--;
+            condition_notifyAll(&dump->changed);
+        }
+        mutex_exit(&dump->lock);
+        if (job == NULL) {
+            break;
+        }
+        dumpObjects(dump, argument->writer, job->entries, job->count);
+        free(job);
+    }
+    submit(dump, argument->writer);
+    return NULL;
+}
+
+static boolean startThread(pthread_t *thread, void *(*run)(void *), void *arg) {
+    sigset_t all, saved;
+    int error;
+    /* The threads must not handle the signals meant for the VM threads. */
+    sigfillset(&all);
+    pthread_sigmask(SIG_SETMASK, &all, &saved);
+    error = pthread_create(thread, NULL, run, arg);
+    pthread_sigmask(SIG_SETMASK, &saved, NULL);
+    return error == 0;
+}
+
+static void writeHeader(HeapDump dump) {
+    static const char format[] = "JAVA PROFILE 1.0.2";
+    Writer writer = &dump->writer;
+    struct timeval now;
+    Byte *p = writer->buffer->data;
+
+    gettimeofday(&now, NULL);
+    memcpy(p, format, sizeof(format));
+    p += sizeof(format);
+    p = putU4(p, ID_SIZE);
+    p = putU8(p, (jlong) now.tv_sec * 1000 + now.tv_usec / 1000);
+    writer->used = p - writer->buffer->data;
+
+    /* The empty stack trace referenced by all objects. */
+    p = beginRecord(dump, writer, HPROF_TRACE, 4 + 4 + 4);
+    p = putU4(p, STACK_TRACE_SERIAL);
+    p = putU4(p, 0);
+    putU4(p, 0);
+}
+
+static void releaseDump(HeapDump dump) {
+    int i;
+    for (i = 0; i < CLASS_BUCKETS; i++) {
+        ClassInfo info = dump->classes[i];
+        while (info != NULL) {
+            ClassInfo next = info->next;
+            free(info);
+            info = next;
+        }
+    }
+    for (i = 0; i < NAME_BUCKETS; i++) {
+        Name name = dump->names[i];
+        while (name != NULL) {
+            Name next = name->next;
+            free(name);
+            name = next;
+        }
+    }
+    for (i = 0; i < dump->workerCount; i++) {
+        writer_release(&dump->workerWriters[i]);
+    }
+    writer_release(&dump->writer);
+    free(dump);
+}
+
+/**
+ * Creates a heap dump file and starts the threads that write it.
+ *
+ * @param path the path of the file
+ * @param compress specifies if the file is to be written in gzip format
+ * @return the heap dump or NULL if the file could not be created
+ */
+JNIEXPORT HeapDump JNICALL
+Java_com_sun_max_vm_management_HeapDump_nativeOpen(JNIEnv *env, jclass c, const char *path, jboolean compress) {
+    HeapDump dump;
+    int workers = JVM_ActiveProcessorCount();
+    int i;
+
+#if !COMPRESSED_DUMP
+    if (compress) {
+        log_println("heap dump: compression is not supported on this platform");
+        return NULL;
+    }
+#endif
+    dump = (HeapDump) calloc(1, sizeof(HeapDumpStruct));
+    if (dump == NULL) {
+        return NULL;
+    }
+    dump->compress = compress;
+    writer_initialize(&dump->writer);
+    dump->writer.buffer = newChunk(BUFFER_SIZE);
+    if (dump->writer.buffer == NULL) {
+        free(dump);
+        return NULL;
+    }
+    dump->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (dump->fd < 0) {
+        log_println("heap dump: could not create %s: %s", path, strerror(errno));
+        releaseDump(dump);
+        return NULL;
+    }
+    mutex_initialize(&dump->lock);
+    mutex_initialize(&dump->submitLock);
+    condition_initialize(&dump->changed);
+
+    if (workers > MAX_WORKERS) {
+        workers = MAX_WORKERS;
+    }
+    for (i = 0; i < workers; i++) {
+        Writer writer = &dump->workerWriters[i];
+        writer_initialize(writer);
+        writer->buffer = newChunk(BUFFER_SIZE);
+        if (writer->buffer == NULL) {
+            break;
+        }
+        dump->workerArguments[i].dump = dump;
+        dump->workerArguments[i].writer = writer;
+        if (!startThread(&dump->workers[i], worker_run, &dump->workerArguments[i])) {
+            writer_release(writer);
+            break;
+        }
+        dump->workerCount++;
+    }
+    dump->outputRunning = startThread(&dump->outputThread, output_run, dump);
+    writeHeader(dump);
+    return dump;
+}
+
+/**
+ * Writes a UTF8 record for a name, unless one was already written for the given id.
+ *
+ * @param className specifies if the name is a type descriptor, written as a class name
+ */
+JNIEXPORT void JNICALL
+Java_com_sun_max_vm_management_HeapDump_nativeWriteName(JNIEnv *env, jclass c, HeapDump dump, jlong id, const char *utf8, jboolean className) {
+    Name *bucket = &dump->names[((Unsigned8) id >> 3) % NAME_BUCKETS];
+    Name name;
+    Size length = strlen(utf8);
+    Byte *p;
+
+    for (name = *bucket; name != NULL; name = name->next) {
+        if (name->id == id) {
+            return;
+        }
+    }
+    name = (Name) malloc(sizeof(NameStruct));
+    if (name == NULL) {
+        return;
+    }
+    name->id = id;
+    name->next = *bucket;
+    *bucket = name;
+
+    if (className && length >= 2 && utf8[0] == 'L' && utf8[length - 1] == ';') {
+        utf8++;
+        length -= 2;
+    }
+    if (length > BUFFER_SIZE - RECORD_HEADER_SIZE - ID_SIZE) {
+        length = BUFFER_SIZE - RECORD_HEADER_SIZE - ID_SIZE;
+    }
+    p = beginRecord(dump, &dump->writer, HPROF_UTF8, ID_SIZE + length);
+    if (p != NULL) {
+        p = putID(p, id);
+        memcpy(p, utf8, length);
+    }
+}
+
+/**
+ * Writes the load record and the class dump of a class, whose super class and names have been written.
+ * Objects of the class can be written once this returns.
+ */
+JNIEXPORT void JNICALL
+Java_com_sun_max_vm_management_HeapDump_nativeDefineClass(JNIEnv *env, jclass c, HeapDump dump, heapDump_ClassDescriptorStruct *descriptor) {
+    heapDump_StaticFieldStruct *statics = (heapDump_StaticFieldStruct *) (descriptor + 1);
+    heapDump_FieldStruct *fields = (heapDump_FieldStruct *) (statics + descriptor->staticCount);
+    Writer writer = &dump->writer;
+    ClassInfo info;
+    Size length;
+    Byte *p;
+    jint i;
+
+    if (findClass(dump, descriptor->classId) != NULL) {
+        return;
+    }
+    info = (ClassInfo) malloc(sizeof(ClassInfoStruct) + descriptor->fieldCount * (sizeof(jint) + 1));
+    if (info == NULL) {
+        dump->failed = true;
+        return;
+    }
+    info->id = descriptor->classId;
+    info->superClass = descriptor->superId == 0 ? NULL : findClass(dump, descriptor->superId);
+    info->fieldCount = descriptor->fieldCount;
+    info->offsets = (jint *) (info + 1);
+    info->types = (Byte *) (info->offsets + descriptor->fieldCount);
+    info->valuesSize = info->superClass == NULL ? 0 : info->superClass->valuesSize;
+    for (i = 0; i < descriptor->fieldCount; i++) {
+        info->offsets[i] = fields[i].offset;
+        info->types[i] = (Byte) fields[i].type;
+        info->valuesSize += typeSize(fields[i].type);
+    }
+
+    p = beginRecord(dump, writer, HPROF_LOAD_CLASS, 4 + ID_SIZE + 4 + ID_SIZE);
+    if (p != NULL) {
+        p = putU4(p, ++dump->classCount);
+        p = putID(p, descriptor->classId);
+        p = putU4(p, STACK_TRACE_SERIAL);
+        putID(p, descriptor->nameId);
+    }
+
+    length = 1 + 7 * ID_SIZE + 4 + 4 + 2 + 2 + 2;
+    for (i = 0; i < descriptor->staticCount; i++) {
+        length += ID_SIZE + 1 + typeSize(statics[i].type);
+    }
+    length += descriptor->fieldCount * (ID_SIZE + 1);
+    p = beginSubRecord(dump, writer, length);
+    if (p != NULL) {
+        p = putU1(p, HPROF_GC_CLASS_DUMP);
+        p = putID(p, descriptor->classId);
+        p = putU4(p, STACK_TRACE_SERIAL);
+        p = putID(p, descriptor->superId);
+        p = putID(p, descriptor->loaderId);
+        /* The signers, protection domain and two reserved ids. */
+        p = putID(p, 0);
+        p = putID(p, 0);
+        p = putID(p, 0);
+        p = putID(p, 0);
+        p = putU4(p, descriptor->instanceSize);
+        /* The constant pool is not dumped. */
+        p = putU2(p, 0);
+        p = putU2(p, descriptor->staticCount);
+        for (i = 0; i < descriptor->staticCount; i++) {
+            p = putID(p, statics[i].nameId);
+            p = putU1(p, statics[i].type);
+            p = putRawValue(p, statics[i].type, statics[i].value);
+        }
+        p = putU2(p, descriptor->fieldCount);
+        for (i = 0; i < descriptor->fieldCount; i++) {
+            p = putID(p, fields[i].nameId);
+            p = putU1(p, fields[i].type);
+        }
+    }
+    if (descriptor->loaderId == 0) {
+        p = beginSubRecord(dump, writer, 1 + ID_SIZE);
+        if (p != NULL) {
+            p = putU1(p, HPROF_GC_ROOT_STICKY_CLASS);
+            putID(p, descriptor->classId);
+        }
+    }
+
+    /* Publish the class to the workers only once it is complete. */
+    __sync_synchronize();
+    info->next = dump->classes[((Unsigned8) info->id >> 3) % CLASS_BUCKETS];
+    dump->classes[((Unsigned8) info->id >> 3) % CLASS_BUCKETS] = info;
+}
+
+/**
+ * Writes a GC root. For a {@code HPROF_GC_ROOT_THREAD_OBJ} root, {@code extra} is the serial number of the thread
+ * and for a {@code HPROF_GC_ROOT_JNI_GLOBAL} root, it is the global handle.
+ */
+JNIEXPORT void JNICALL
+Java_com_sun_max_vm_management_HeapDump_nativeWriteRoot(JNIEnv *env, jclass c, HeapDump dump, jint tag, jlong id, jlong extra) {
+    Writer writer = &dump->writer;
+    Byte *p;
+    if (tag == HPROF_GC_ROOT_THREAD_OBJ) {
+        p = beginSubRecord(dump, writer, 1 + ID_SIZE + 4 + 4);
+        if (p != NULL) {
+            p = putU1(p, HPROF_GC_ROOT_THREAD_OBJ);
+            p = putID(p, id);
+            p = putU4(p, (jint) extra);
+            putU4(p, STACK_TRACE_SERIAL);
+        }
+    } else {
+        p = beginSubRecord(dump, writer, 1 + ID_SIZE + ID_SIZE);
+        if (p != NULL) {
+            p = putU1(p, HPROF_GC_ROOT_JNI_GLOBAL);
+            p = putID(p, id);
+            putID(p, extra);
+        }
+    }
+}
+
+/**
+ * Writes a batch of objects, whose classes have been defined. The batch is copied and written by the workers,
+ * after the records written so far by the caller.
+ */
+JNIEXPORT void JNICALL
+Java_com_sun_max_vm_management_HeapDump_nativeDumpObjects(JNIEnv *env, jclass c, HeapDump dump, heapDump_Entry entries, jint count) {
+    Job job;
+    if (count <= 0 || dump->failed) {
+        return;
+    }
+    if (dump->workerCount == 0 || (job = (Job) malloc(sizeof(JobStruct) + (count - 1) * sizeof(heapDump_EntryStruct))) == NULL) {
+        dumpObjects(dump, &dump->writer, entries, count);
+        return;
+    }
+    job->next = NULL;
+    job->count = count;
+    memcpy(job->entries, entries, count * sizeof(heapDump_EntryStruct));
+
+    /* The class records written by the caller must be output before the objects using them. */
+    submit(dump, &dump->writer);
+
+    mutex_enter(&dump->lock);
+    while (dump->jobCount >= PENDING_PER_WORKER * dump->workerCount) {
+        condition_wait(&dump->changed, &dump->lock);
+    }
+    if (dump->jobTail == NULL) {
+        dump->jobHead = job;
+    } else {
+        dump->jobTail->next = job;
+    }
+    dump->jobTail = job;
+    dump->jobCount++;
+    condition_notifyAll(&dump->changed);
+    mutex_exit(&dump->lock);
+}
+
+/**
+ * Waits for the objects to be written, ends the heap dump, closes the file and releases the dump.
+ *
+ * @return 0 if the dump was written completely, -1 otherwise
+ */
+JNIEXPORT jint JNICALL
+Java_com_sun_max_vm_management_HeapDump_nativeClose(JNIEnv *env, jclass c, HeapDump dump) {
+    jint result;
+    int i;
+
+    mutex_enter(&dump->lock);
+    dump->closing = true;
+    condition_notifyAll(&dump->changed);
+    mutex_exit(&dump->lock);
+    for (i = 0; i < dump->workerCount; i++) {
+        pthread_join(dump->workers[i], NULL);
+    }
+
+    beginRecord(dump, &dump->writer, HPROF_HEAP_DUMP_END, 0);
+    submit(dump, &dump->writer);
+
+    if (dump->outputRunning) {
+        mutex_enter(&dump->lock);
+        dump->outputClosed = true;
+        condition_notifyAll(&dump->changed);
+        mutex_exit(&dump->lock);
+        pthread_join(dump->outputThread, NULL);
+    }
+    if (close(dump->fd) != 0 && !dump->failed) {
+        log_println("heap dump: close failed: %s", strerror(errno));
+        dump->failed = true;
+    }
+    result = dump->failed ? -1 : 0;
+    releaseDump(dump);
+    return result;
+}
+
+#endif
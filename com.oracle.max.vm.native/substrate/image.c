@@ -34,6 +34,7 @@
 
 #include "image.h"
 #include "log.h"
+#include "startup.h"
 #include "word.h"
 
 /* TODO: make this cpu-dependent: */
@@ -43,7 +44,7 @@
 /*
  * Image format version checked against com.sun.max.vm.hosted.BootImage.BOOT_IMAGE_FORMAT_VERSION
  */
-#define IMAGE_FORMAT_VERSION                    2
+#define IMAGE_FORMAT_VERSION                    4
 #define DEFAULT_RELOCATION_SCHEME        0
 
 #if os_MAXVE
@@ -52,6 +53,7 @@
 #include <string.h>
 #else
 #define MEMORY_IMAGE 0
+#include <sys/mman.h>
 #endif
 
 #if MEMORY_IMAGE
@@ -59,6 +61,81 @@ extern void *maxvm_image_start;
 extern void *maxvm_image_end;
 #endif
 
+/*
+ * Lazy relocation replaces each range of pages of the boot heap and code atomically (with mremap)
+ * after relocating a private copy of it, which is only possible on Linux.
+ */
+#if os_LINUX && !MEMORY_IMAGE
+#define LAZY_RELOCATION 1
+#include "mutex.h"
+#include "trap.h"
+#else
+#define LAZY_RELOCATION 0
+#endif
+
+/*
+ * Backing the boot heap and code with large pages requires copying them from the image file
+ * into anonymous memory as neither transparent nor explicit huge pages are used for private
+ * file mappings. The heap is aligned to LARGE_PAGE_ALIGNMENT (or 1GB for 1GB pages) so that
+ * all of the heap and code except for the last partial large page can be backed by large pages.
+ */
+#if os_LINUX && !MEMORY_IMAGE
+#define LARGE_PAGES 1
+#define LARGE_PAGE_ALIGNMENT (2 * 1024L * 1024L)
+#ifndef MADV_HUGEPAGE
+#define MADV_HUGEPAGE 14
+#endif
+#ifndef MAP_HUGETLB
+#define MAP_HUGETLB 0x40000
+#endif
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+#else
+#define LARGE_PAGES 0
+#endif
+
+/*
+ * A page profile records the boot heap and code pages mapped into the process
+ * (as reported by /proc/self/pagemap) which is only possible on Linux.
+ */
+#if os_LINUX && !MEMORY_IMAGE
+#define PAGE_PROFILE 1
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <string.h>
+#include <time.h>
+#else
+#define PAGE_PROFILE 0
+#endif
+
+/*
+ * Relocated boot heap and code pages are private to each VM. Processes that relocate the image
+ * to the same address produce identical pages which the kernel can merge (KSM) on Linux.
+ */
+#if os_LINUX && !MEMORY_IMAGE
+#define MERGEABLE_PAGES 1
+#ifndef MADV_MERGEABLE
+#define MADV_MERGEABLE 12
+#endif
+#else
+#define MERGEABLE_PAGES 0
+#endif
+
+/*
+ * Compressed boot images consist of independently compressed (zlib) chunks that are decompressed
+ * in parallel into the memory reserved for the boot heap and code.
+ */
+#if os_LINUX && !MEMORY_IMAGE
+#define COMPRESSED_IMAGE 1
+#define MAX_DECOMPRESSION_THREADS 32
+#include <pthread.h>
+#include <zlib.h>
+#else
+#define COMPRESSED_IMAGE 0
+#endif
+
 /*
  * The data loaded/initialized from the boot image.
  */
@@ -67,6 +144,9 @@ static image_StringInfo theStringInfo = 0;
 static Address          theHeap = 0;
 static Address          theCode = 0;
 static Address          theCodeEnd = 0;
+static Address          thePreferredHeap = 0;
+static Address          theReservedVirtualSpace = 0;
+static boolean          theHeapAndCodeRelocated = false;
 
 /*************************************************************************
  Functions for accessing image sections (once they are loaded).
@@ -248,7 +328,12 @@ static void checkTrailer(int fd) {
     struct image_Trailer trailerStruct;
     image_Trailer trailerStructPtr = &trailerStruct;
 
-    trailerOffset = virtualMemory_pageAlign(sizeof(struct image_Header) + theHeader->stringDataSize + theHeader->relocationDataSize) + theHeader->codeSize + theHeader->heapSize;
+    trailerOffset = virtualMemory_pageAlign(sizeof(struct image_Header) + theHeader->stringDataSize + theHeader->relocationDataSize);
+    if (theHeader->compressionChunkSize != 0) {
+        trailerOffset += theHeader->compressedHeapAndCodeSize;
+    } else {
+        trailerOffset += theHeader->codeSize + theHeader->heapSize;
+    }
 
 #if !MEMORY_IMAGE
     fileSize = lseek(fd, 0, SEEK_END);
@@ -295,26 +380,151 @@ static void checkTrailer(int fd) {
     }
 }
 
-static void mapHeapAndCode(int fd) {
+#if LARGE_PAGES
+
+static Size largePageSize(int largePages) {
+    return largePages == image_LARGE_PAGES_1G ? 1024L * 1024L * 1024L : LARGE_PAGE_ALIGNMENT;
+}
+
+/**
+ * Tries to replace the (anonymous) memory at 'theHeap' with explicit huge pages of the size given by 'largePages'.
+ *
+ * @return the number of bytes that are now backed by huge pages, which is 0 if the mapping failed
+ */
+static Size mapHugePages(Size heapAndCodeSize, int largePages) {
+    Size pageSize = largePageSize(largePages);
+    Size largePagesSize = heapAndCodeSize - (heapAndCodeSize % pageSize);
+    if (largePagesSize == 0) {
+        return 0;
+    }
+    int sizeFlag = (largePages == image_LARGE_PAGES_1G ? 30 : 21) << MAP_HUGE_SHIFT;
+    void *result = mmap((void *) theHeap, largePagesSize, PROT_EXEC | PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED | MAP_HUGETLB | sizeFlag, -1, 0);
+    // The original mapping is left intact by a failed mmap
+    return result == MAP_FAILED ? 0 : largePagesSize;
+}
+
+/**
+ * Backs the (anonymous) memory at 'theHeap' for the boot heap and code with large pages as far as possible,
+ * falling back from 1G to 2M explicit huge pages and then to transparent huge pages.
+ */
+static void backWithLargePages(Size heapAndCodeSize, int largePages) {
+    Size largePagesSize = 0;
+
+    if (largePages == image_LARGE_PAGES_1G) {
+        largePagesSize = mapHugePages(heapAndCodeSize, image_LARGE_PAGES_1G);
+        if (largePagesSize == 0) {
+            log_println("WARNING: could not allocate 1G huge pages for boot image, trying 2M huge pages");
+            largePages = image_LARGE_PAGES_2M;
+        }
+    }
+    if (largePages == image_LARGE_PAGES_2M) {
+        largePagesSize = mapHugePages(heapAndCodeSize, image_LARGE_PAGES_2M);
+        if (largePagesSize == 0) {
+            log_println("WARNING: could not allocate huge pages for boot image, using transparent huge pages");
+            largePages = image_LARGE_PAGES_THP;
+        }
+    }
+    if (largePages == image_LARGE_PAGES_THP) {
+        largePagesSize = heapAndCodeSize;
+        if (madvise((void *) theHeap, heapAndCodeSize, MADV_HUGEPAGE) != 0) {
+            log_println("WARNING: could not advise use of transparent huge pages for boot image, using base pages");
+            largePagesSize = 0;
+        }
+    }
+#if log_LOADER
+    log_println("image.mapHeapAndCode: backing %lu of %lu bytes of boot heap and code with %s pages", largePagesSize, heapAndCodeSize,
+                    largePagesSize == 0 ? "base" : largePages == image_LARGE_PAGES_1G ? "1G huge" : largePages == image_LARGE_PAGES_2M ? "2M huge" : "transparent huge");
+#endif
+}
+
+#endif
+
+#if !MEMORY_IMAGE
+/**
+ * Copies the boot heap and code from the image file into the memory at 'theHeap'.
+ */
+static void readHeapAndCode(int fd, Size heapOffsetInImage, Size heapAndCodeSize) {
+    Size n = 0;
+    while (n < heapAndCodeSize) {
+        ssize_t count = pread(fd, (void *) (theHeap + n), heapAndCodeSize - n, heapOffsetInImage + n);
+        if (count <= 0) {
+            log_exit(4, "could not read boot image");
+        }
+        n += count;
+    }
+}
+
+/**
+ * Reserves 'size' bytes of virtual memory, preferably at 'preferredAddress'.
+ * If 'alignment' is not 0, the reserved memory is placed such that 'result + offset' is a multiple of 'alignment'.
+ */
+static Address reserveVirtualSpace(Address preferredAddress, Size size, Size alignment, Size offset) {
+    Address result = ALLOC_FAILED;
+    if (preferredAddress != 0 && (alignment == 0 || (preferredAddress + offset) % alignment == 0)) {
+        result = virtualMemory_allocatePrivateAnonAtPreferredAddress(preferredAddress, size, JNI_FALSE, JNI_FALSE, HEAP_VM);
+    }
+    if (result == ALLOC_FAILED) {
+        if (alignment == 0) {
+            return virtualMemory_allocatePrivateAnon((Address) 0, size, JNI_FALSE, JNI_FALSE, HEAP_VM);
+        }
+        Address base = virtualMemory_allocatePrivateAnon((Address) 0, size + alignment, JNI_FALSE, JNI_FALSE, HEAP_VM);
+        if (base == ALLOC_FAILED) {
+            return ALLOC_FAILED;
+        }
+        Address aligned = base + offset + alignment - 1;
+        result = aligned - (aligned % alignment) - offset;
+        // Release the unused memory on either side of the aligned range
+        if (result != base) {
+            virtualMemory_deallocate(base, result - base, HEAP_VM);
+        }
+        if (result + size != base + size + alignment) {
+            virtualMemory_deallocate(result + size, (base + size + alignment) - (result + size), HEAP_VM);
+        }
+    }
+    return result;
+}
+#endif
+
+static void mapHeapAndCode(int fd, int largePages) {
     int heapOffsetInImage = virtualMemory_pageAlign(sizeof(struct image_Header) + theHeader->stringDataSize + theHeader->relocationDataSize);
     int heapAndCodeSize = theHeader->heapSize + theHeader->codeSize;
     c_ASSERT(virtualMemory_pageAlign((Size) heapAndCodeSize) == (Size) heapAndCodeSize);
 #if log_LOADER
     log_println("image.mapHeapAndCode");
 #endif
+    thePreferredHeap = ((Address) theHeader->preferredHeapAddressMB) * 1024L * 1024L;
 #if MEMORY_IMAGE
     theHeap = (Address) &maxvm_image_start + heapOffsetInImage;
 #elif os_SOLARIS || os_DARWIN || os_LINUX
     Address reservedVirtualSpace = (Address) 0;
     size_t virtualSpaceSize = 1024L * theHeader->reservedVirtualSpaceSize;
+    Size alignment = 0;
     c_ASSERT(virtualMemory_pageAlign((Size) virtualSpaceSize) == (Size) virtualSpaceSize);
+#if LARGE_PAGES
+    if (largePages != image_LARGE_PAGES_NONE) {
+        alignment = largePageSize(largePages);
+    }
+#else
+    if (largePages != image_LARGE_PAGES_NONE) {
+        log_println("WARNING: large pages for the boot image are not supported on this platform");
+    }
+#endif
     if (virtualSpaceSize != 0) {
         // VM configuration asks for reserving an address space of size reservedVirtualSpaceSize.
         // The following will create a mapping in virtual space of the requested size.
         // The address returned might subsequently be used to memory map various regions, including the
         // boot heap region, automatically splitting this mapping.
         // In any case,  the VM (mostly the heap scheme) is responsible for releasing unused reserved space.
-        reservedVirtualSpace = virtualMemory_allocatePrivateAnon((Address) 0, virtualSpaceSize, JNI_FALSE, JNI_FALSE, HEAP_VM);
+        Address preferredReservedVirtualSpace = 0;
+        Size heapOffset = 0;
+        if (theHeader->bootRegionMappingConstraint == 2) {
+            heapOffset = virtualSpaceSize - heapAndCodeSize;
+        }
+        if (thePreferredHeap != 0 && theHeader->bootRegionMappingConstraint != 0) {
+            // Try to place the reserved space such that the boot heap region lands at its preferred address.
+            preferredReservedVirtualSpace = thePreferredHeap > heapOffset ? thePreferredHeap - heapOffset : 0;
+        }
+        reservedVirtualSpace = reserveVirtualSpace(preferredReservedVirtualSpace, virtualSpaceSize, theHeader->bootRegionMappingConstraint != 0 ? alignment : 0, heapOffset);
         if (reservedVirtualSpace == ALLOC_FAILED) {
             log_exit(4, "could not reserve requested virtual space");
         }
@@ -326,19 +536,25 @@ static void mapHeapAndCode(int fd) {
         // Map the boot heap region at the end of the reserved space. The start of the boot heap region is page-aligned.
         theHeap = reservedVirtualSpace + virtualSpaceSize - heapAndCodeSize;
     } else {
-        // Map the boot heap region anywhere outside of the reserved space.
-        theHeap = virtualMemory_allocatePrivateAnon((Address) 0, heapAndCodeSize, JNI_FALSE, JNI_FALSE, HEAP_VM);
+        // Map the boot heap region anywhere outside of the reserved space, preferably at its preferred address.
+        theHeap = reserveVirtualSpace(thePreferredHeap, heapAndCodeSize, alignment, 0);
         if (theHeap == ALLOC_FAILED) {
             log_exit(4, "could not reserve virtual space for boot image");
         }
     }
-    if (virtualMemory_mapFileAtFixedAddress(theHeap, heapAndCodeSize, fd, heapOffsetInImage) == ALLOC_FAILED) {
-        log_exit(4, "could not map boot image");
+#if LARGE_PAGES
+    if (alignment != 0) {
+        backWithLargePages(heapAndCodeSize, largePages);
     }
-    if (reservedVirtualSpace) {
-        Address *addr = image_offset_as_address(Address *, reservedVirtualSpaceFieldOffset);
-        *addr = reservedVirtualSpace;
+#endif
+    if (theHeader->compressionChunkSize != 0) {
+        // The heap and code are decompressed into the reserved memory by 'decompressHeapAndCode'
+    } else if (alignment != 0) {
+        readHeapAndCode(fd, heapOffsetInImage, heapAndCodeSize);
+    } else if (virtualMemory_mapFileAtFixedAddress(theHeap, heapAndCodeSize, fd, heapOffsetInImage) == ALLOC_FAILED) {
+        log_exit(4, "could not map boot image");
     }
+    theReservedVirtualSpace = reservedVirtualSpace;
 #else
     c_UNIMPLEMENTED();
 #endif
@@ -348,6 +564,7 @@ static void mapHeapAndCode(int fd) {
 #endif
     theCode = theHeap + theHeader->heapSize;
     theCodeEnd = theCode + theHeader->codeSize;
+    log_setBootCodeRange(theCode, theCodeEnd);
 #if log_LOADER
     log_println("ReservedVSpace Size %d ActualVSpaceSize(*1Mb) %u",theHeader->reservedVirtualSpaceSize, virtualSpaceSize);
     log_println("boot heap start at %p", theHeap);
@@ -359,51 +576,578 @@ static void mapHeapAndCode(int fd) {
 #endif
 }
 
-static void relocate(int fd) {
-    off_t wantedFileOffset;
-    Byte *relocationData;
+#if LAZY_RELOCATION
+
+#define LAZY_RANGE_UNRELOCATED 0
+#define LAZY_RANGE_RELOCATING  1
+#define LAZY_RANGE_WAITED      2
+#define LAZY_RANGE_RELOCATED   3
+
+/*
+ * The number of pages relocated together. Each relocated range can become a separate mapping,
+ * so relocating single pages could exceed the vm.max_map_count limit for a large boot image.
+ */
+#define LAZY_RANGE_PAGES 64
+
+/*
+ * State for lazily relocating the boot heap and code. The relocation data and the image
+ * file descriptor are retained for the lifetime of the VM.
+ */
+static volatile int *theLazyRangeStates = NULL;
+static Byte *theLazyRelocationData = NULL;
+static int theLazyImageFd = -1;
+static int theLazyNumberOfPages = 0;
+
+#define LAZY_PAGE_PROT (PROT_EXEC | PROT_READ | PROT_WRITE)
+
+/**
+ * Makes a range of pages of the boot heap or code accessible with all its pointers relocated.
+ * A range without pointers is simply unprotected. Otherwise, a private copy of the range
+ * is mapped from the image file, relocated and then moved over the inaccessible range.
+ * As such, no other thread can observe a partially relocated page.
+ */
+static void relocateRangeLazily(int rangeIndex) {
+    Size pageSize = virtualMemory_getPageSize();
+    int firstPage = rangeIndex * LAZY_RANGE_PAGES;
+    int numberOfPages = theLazyNumberOfPages - firstPage;
+    if (numberOfPages > LAZY_RANGE_PAGES) {
+        numberOfPages = LAZY_RANGE_PAGES;
+    }
+    Size size = numberOfPages * pageSize;
+    Address start = theHeap + firstPage * pageSize;
+    int bytesPerPage = pageSize / (theHeader->wordSize * 8);
+    int firstByte = firstPage * bytesPerPage;
+    int n = theHeader->relocationDataSize - firstByte;
+    boolean hasPointers = false;
+    int i;
+
+    if (n > numberOfPages * bytesPerPage) {
+        n = numberOfPages * bytesPerPage;
+    }
+    for (i = 0; i < n; i++) {
+        if (theLazyRelocationData[firstByte + i] != 0) {
+            hasPointers = true;
+            break;
+        }
+    }
+    if (!hasPointers) {
+        if (mprotect((void *) start, size, LAZY_PAGE_PROT) != 0) {
+            log_exit(4, "could not unprotect boot image pages at %p", start);
+        }
+        return;
+    }
+    Size heapOffsetInImage = virtualMemory_pageAlign(sizeof(struct image_Header) + theHeader->stringDataSize + theHeader->relocationDataSize);
+    void *copy = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, theLazyImageFd, heapOffsetInImage + firstPage * pageSize);
+    if (copy == MAP_FAILED) {
+        log_exit(4, "could not map copy of boot image pages at %p", start);
+    }
+    relocation_apply(copy, theHeap - thePreferredHeap, theLazyRelocationData + firstByte, n, word_BIG_ENDIAN, theHeader->wordSize, 1);
+    if (mprotect(copy, size, LAZY_PAGE_PROT) != 0 ||
+        mremap(copy, size, size, MREMAP_MAYMOVE | MREMAP_FIXED, (void *) start) == MAP_FAILED) {
+        log_exit(4, "could not install relocated boot image pages at %p", start);
+    }
+}
+
+boolean image_relocateOnFault(Address faultAddress) {
+    if (theLazyRangeStates == NULL || faultAddress < theHeap || faultAddress >= theCodeEnd) {
+        return false;
+    }
+    int rangeIndex = (faultAddress - theHeap) / (virtualMemory_getPageSize() * LAZY_RANGE_PAGES);
+    volatile int *state = &theLazyRangeStates[rangeIndex];
+    if (__sync_bool_compare_and_swap(state, LAZY_RANGE_UNRELOCATED, LAZY_RANGE_RELOCATING)) {
+        relocateRangeLazily(rangeIndex);
+        if (__atomic_exchange_n(state, LAZY_RANGE_RELOCATED, __ATOMIC_RELEASE) == LAZY_RANGE_WAITED) {
+            mutex_unpark(state, true);
+        }
+        return true;
+    }
+    // Another thread is relocating (or has relocated) the range: park until it is done and then
+    // retry the access. The VM never protects pages in the boot heap or code so this cannot be a
+    // genuine fault. The futex system call is async-signal-safe.
+    for (;;) {
+        int value = __atomic_load_n(state, __ATOMIC_ACQUIRE);
+        if (value == LAZY_RANGE_RELOCATED) {
+            return true;
+        }
+        if (value == LAZY_RANGE_RELOCATING && !__sync_bool_compare_and_swap(state, LAZY_RANGE_RELOCATING, LAZY_RANGE_WAITED)) {
+            continue;
+        }
+        mutex_park(state, LAZY_RANGE_WAITED, 0);
+    }
+}
+
+void image_relocateRange(Address start, Size length) {
+    if (theLazyRangeStates == NULL || length == 0 || start + length <= theHeap || start >= theCodeEnd) {
+        return;
+    }
+    Size rangeSize = virtualMemory_getPageSize() * LAZY_RANGE_PAGES;
+    int rangeIndex = start > theHeap ? (start - theHeap) / rangeSize : 0;
+    Address end = start + length < theCodeEnd ? start + length : theCodeEnd;
+    for (; theHeap + rangeIndex * rangeSize < end; rangeIndex++) {
+        if (__atomic_load_n(&theLazyRangeStates[rangeIndex], __ATOMIC_ACQUIRE) != LAZY_RANGE_RELOCATED) {
+            image_relocateOnFault(theHeap + rangeIndex * rangeSize);
+        }
+    }
+}
+
+/**
+ * Handles faults on lazily relocated pages until the VM installs its own trap handler
+ * (which then calls 'image_relocateOnFault' itself).
+ */
+static void lazyRelocationSignalHandler(int signal, SigInfo *signalInfo, void *ucontext) {
+    if (!image_relocateOnFault((Address) signalInfo->si_addr)) {
+        // Not a boot image page: restore the default action and let the access fault again.
+        struct sigaction defaultAction;
+        memset((char *) &defaultAction, 0, sizeof(defaultAction));
+        defaultAction.sa_handler = SIG_DFL;
+        sigaction(signal, &defaultAction, NULL);
+    }
+}
+
+/**
+ * Protects the boot heap and code so that each range of pages is relocated when it is first accessed.
+ *
+ * Note that an access by the kernel (e.g. a read(2) into an array in the boot heap) to a page that
+ * has not yet been relocated fails with EFAULT instead of raising a signal. Such accesses are made
+ * safe by calling 'image_relocateRange' on the buffer first. Tools that read the memory of the VM
+ * without going through the page protection (e.g. the Inspector) see such pages unrelocated.
+ */
+static void relocateLazily(int fd, Byte *relocationData) {
+    Size pageSize = virtualMemory_getPageSize();
+    int numberOfPages = (theHeader->heapSize + theHeader->codeSize) / pageSize;
+    int numberOfRanges = (numberOfPages + LAZY_RANGE_PAGES - 1) / LAZY_RANGE_PAGES;
+    theLazyRangeStates = (volatile int *) calloc(numberOfRanges, sizeof(int));
+    if (theLazyRangeStates == NULL) {
+        log_exit(1, "could not allocate lazy relocation range states");
+    }
+    theLazyNumberOfPages = numberOfPages;
+    theLazyRelocationData = relocationData;
+    theLazyImageFd = fd;
+    setSignalHandler(SIGSEGV, (SignalHandlerFunction) lazyRelocationSignalHandler);
+    setSignalHandler(SIGBUS, (SignalHandlerFunction) lazyRelocationSignalHandler);
+    if (mprotect((void *) theHeap, numberOfPages * pageSize, PROT_NONE) != 0) {
+        log_exit(4, "could not protect boot image for lazy relocation");
+    }
 #if log_LOADER
-    log_println("image.relocate");
+    log_println("image.relocate: %d pages will be relocated lazily in ranges of %d pages", numberOfPages, LAZY_RANGE_PAGES);
+#endif
+}
+
+#else
+
+boolean image_relocateOnFault(Address faultAddress) {
+    return false;
+}
+
+void image_relocateRange(Address start, Size length) {
+}
+
 #endif
+
+/* Defined in jvm.c */
+extern jint JVM_ActiveProcessorCount(void);
+
+#if log_LOADER
+/**
+ * Counts the pages of the boot heap and code that are not written by relocation.
+ */
+static int numberOfPagesWithoutPointers(Byte *relocationData) {
+    int bytesPerPage = virtualMemory_getPageSize() / (8 * theHeader->wordSize);
+    int numberOfPages = (theCodeEnd - theHeap) / virtualMemory_getPageSize();
+    int page, i, result = 0;
+    for (page = 0; page < numberOfPages; page++) {
+        int start = page * bytesPerPage;
+        int end = start + bytesPerPage > theHeader->relocationDataSize ? theHeader->relocationDataSize : start + bytesPerPage;
+        for (i = start; i < end && relocationData[i] == 0; i++) {
+        }
+        if (i == end) {
+            result++;
+        }
+    }
+    return result;
+}
+#endif
+
+/**
+ * Gets the relocation data, mapping it from the image file if necessary.
+ *
+ * @param mapping if the relocation data is mapped, the start of the mapping is returned in this out parameter
+ * @param mappingSize if the relocation data is mapped, the size of the mapping is returned in this out parameter
+ */
+static Byte *mapRelocationData(int fd, Address *mapping, Size *mappingSize) {
+    off_t wantedFileOffset = sizeof(struct image_Header) + theHeader->stringDataSize;
 #if !MEMORY_IMAGE
-    off_t actualFileOffset;
-    int n;
+    // The relocation data is mapped from the image file instead of being read into a buffer.
+    // The mapping must start on a page boundary which, in general, the relocation data does not.
+    Size pageSize = virtualMemory_getPageSize();
+    Size mappingOffset = wantedFileOffset - (wantedFileOffset % pageSize);
+    *mappingSize = virtualMemory_pageAlign(wantedFileOffset + theHeader->relocationDataSize) - mappingOffset;
+    *mapping = virtualMemory_mapFile(*mappingSize, fd, mappingOffset);
+    if (*mapping == ALLOC_FAILED) {
+        log_exit(1, "could not map relocation data");
+    }
+    if (mprotect((void *) *mapping, *mappingSize, PROT_READ) != 0) {
+        log_exit(1, "could not protect relocation data");
+    }
+    if (madvise((void *) *mapping, *mappingSize, MADV_SEQUENTIAL) != 0) {
+        log_println("WARNING: could not advise sequential access to relocation data");
+    }
+    return (Byte *) (*mapping + (wantedFileOffset - mappingOffset));
+#else
+    *mapping = 0;
+    *mappingSize = 0;
+    return (Byte*)(((char*)&maxvm_image_start) + wantedFileOffset);
 #endif
+}
 
-    wantedFileOffset = sizeof(struct image_Header) + theHeader->stringDataSize;
+static void unmapRelocationData(Address mapping, Size mappingSize) {
 #if !MEMORY_IMAGE
-    relocationData = (Byte *) malloc(theHeader->relocationDataSize);
-    if (relocationData == NULL) {
-        log_exit(1, "could not allocate memory for relocation data");
+    if (virtualMemory_deallocate(mapping, mappingSize, DATA_VM) == 0) {
+        log_println("WARNING: could not unmap relocation data");
     }
+#endif
+}
+
+#if COMPRESSED_IMAGE
 
-    actualFileOffset = lseek(fd, wantedFileOffset, SEEK_SET);
-    if (actualFileOffset != wantedFileOffset) {
-        log_exit(1, "could not set relocation data position in file");
+typedef struct Decompression {
+    Byte *chunks;
+    Size *chunkOffsets;
+    int numberOfChunks;
+    int nextChunk;
+    Byte *relocationData;
+} Decompression;
+
+/**
+ * Decompresses a chunk of the heap and code and, if 'relocationData' is not NULL, relocates it
+ * while it is still in the cache.
+ */
+static void decompressChunk(Decompression *decompression, int chunk) {
+    Size heapAndCodeSize = theHeader->heapSize + theHeader->codeSize;
+    Size offset = (Size) chunk * theHeader->compressionChunkSize;
+    Size size = heapAndCodeSize - offset < (Size) theHeader->compressionChunkSize ? heapAndCodeSize - offset : (Size) theHeader->compressionChunkSize;
+    uLongf decompressedSize = size;
+    Size compressedSize = decompression->chunkOffsets[chunk + 1] - decompression->chunkOffsets[chunk];
+
+    if (uncompress((Bytef *) (theHeap + offset), &decompressedSize, decompression->chunks + decompression->chunkOffsets[chunk], compressedSize) != Z_OK || decompressedSize != size) {
+        log_exit(4, "could not decompress boot image chunk %d", chunk);
     }
-    n = read(fd, relocationData, theHeader->relocationDataSize);
-    if (n != theHeader->relocationDataSize) {
-        log_exit(1, "could not read relocation data");
+    if (decompression->relocationData != NULL) {
+        int bytesPerChunk = theHeader->compressionChunkSize / (8 * theHeader->wordSize);
+        int first = chunk * bytesPerChunk;
+        int n = theHeader->relocationDataSize - first < bytesPerChunk ? theHeader->relocationDataSize - first : bytesPerChunk;
+        if (n > 0) {
+            relocation_apply((void *) (theHeap + offset), theHeap - thePreferredHeap, decompression->relocationData + first, n, word_BIG_ENDIAN, theHeader->wordSize, 1);
+        }
     }
-#else
-    relocationData = (Byte*)(((char*)&maxvm_image_start) + wantedFileOffset);
+}
+
+static void *decompressChunks(void *arg) {
+    Decompression *decompression = (Decompression *) arg;
+    int chunk;
+    while ((chunk = __sync_fetch_and_add(&decompression->nextChunk, 1)) < decompression->numberOfChunks) {
+        decompressChunk(decompression, chunk);
+    }
+    return NULL;
+}
+
+/**
+ * Decompresses the compressed heap and code section of the image file into the memory reserved at 'theHeap',
+ * with one thread per available processor taking chunks in turn. If 'relocate' is true, each chunk is
+ * relocated right after being decompressed.
+ */
+static void decompressHeapAndCode(int fd, boolean relocate) {
+    int heapOffsetInImage = virtualMemory_pageAlign(sizeof(struct image_Header) + theHeader->stringDataSize + theHeader->relocationDataSize);
+    Size sectionSize = virtualMemory_pageAlign(theHeader->compressedHeapAndCodeSize);
+    Address section = virtualMemory_mapFile(sectionSize, fd, heapOffsetInImage);
+    Address relocationMapping;
+    Size relocationMappingSize;
+    Decompression decompression;
+    pthread_t threads[MAX_DECOMPRESSION_THREADS];
+    int numberOfThreads = JVM_ActiveProcessorCount();
+    int chunk, t;
+    jint *chunkSizes;
+
+    if (section == ALLOC_FAILED) {
+        log_exit(4, "could not map compressed boot image");
+    }
+    if (madvise((void *) section, sectionSize, MADV_WILLNEED) != 0) {
+        log_println("WARNING: could not prefetch compressed boot image");
+    }
+    decompression.numberOfChunks = ((theHeader->heapSize + theHeader->codeSize) + theHeader->compressionChunkSize - 1) / theHeader->compressionChunkSize;
+    decompression.chunkOffsets = (Size *) malloc((decompression.numberOfChunks + 1) * sizeof(Size));
+    if (decompression.chunkOffsets == NULL) {
+        log_exit(1, "could not allocate boot image chunk table");
+    }
+    chunkSizes = (jint *) section;
+    decompression.chunks = (Byte *) section;
+    decompression.chunkOffsets[0] = decompression.numberOfChunks * sizeof(jint);
+    for (chunk = 0; chunk < decompression.numberOfChunks; chunk++) {
+        decompression.chunkOffsets[chunk + 1] = decompression.chunkOffsets[chunk] + chunkSizes[chunk];
+    }
+    if (decompression.chunkOffsets[decompression.numberOfChunks] != (Size) theHeader->compressedHeapAndCodeSize) {
+        log_exit(2, "inconsistent boot image chunk table");
+    }
+    decompression.nextChunk = 0;
+    decompression.relocationData = relocate ? mapRelocationData(fd, &relocationMapping, &relocationMappingSize) : NULL;
+
+    if (numberOfThreads > decompression.numberOfChunks) {
+        numberOfThreads = decompression.numberOfChunks;
+    }
+    if (numberOfThreads > MAX_DECOMPRESSION_THREADS) {
+        numberOfThreads = MAX_DECOMPRESSION_THREADS;
+    }
+#if log_LOADER
+    log_println("image.decompressHeapAndCode: %d chunks, %d threads%s", decompression.numberOfChunks, numberOfThreads, relocate ? ", relocating" : "");
+#endif
+    for (t = 1; t < numberOfThreads; t++) {
+        if (pthread_create(&threads[t], NULL, decompressChunks, &decompression) != 0) {
+            break;
+        }
+    }
+    numberOfThreads = t;
+    decompressChunks(&decompression);
+    for (t = 1; t < numberOfThreads; t++) {
+        pthread_join(threads[t], NULL);
+    }
+
+    if (relocate) {
+        unmapRelocationData(relocationMapping, relocationMappingSize);
+        theHeapAndCodeRelocated = true;
+    }
+    free(decompression.chunkOffsets);
+    virtualMemory_deallocate(section, sectionSize, DATA_VM);
+}
+
+#endif
+
+static void relocate(int fd, int relocationMode) {
+    Byte *relocationData;
+    Address mapping;
+    Size mappingSize;
+#if log_LOADER
+    log_println("image.relocate");
 #endif
 
+    if (theHeap == thePreferredHeap) {
+        // The pointers in the image file are already relocated to where the heap got mapped.
+        // Not touching the heap and code keeps their pages shared with the image file.
+#if log_LOADER
+        log_println("image.relocate: boot heap mapped at preferred address %p, skipping relocation", thePreferredHeap);
+#endif
+        return;
+    }
+    if (theHeapAndCodeRelocated) {
+        // The chunks of a compressed image are relocated as they are decompressed
+        return;
+    }
+
+    relocationData = mapRelocationData(fd, &mapping, &mappingSize);
+
 #if log_LOADER
     log_println("image.relocate [relocation map: %d bytes]", theHeader->relocationDataSize);
 #endif
 
-    relocation_apply((void *) theHeap, theHeap, relocationData, theHeader->relocationDataSize, word_BIG_ENDIAN, theHeader->wordSize);
+    if (relocationMode == image_RELOCATION_LAZY) {
+#if LAZY_RELOCATION
+        // The relocation data stays mapped as pages are relocated on demand
+        relocateLazily(fd, relocationData);
+        return;
+#else
+        log_println("WARNING: lazy boot image relocation is not supported on this platform, relocating eagerly");
+#endif
+    }
 
-#if !MEMORY_IMAGE
-    free(relocationData);
+#if log_LOADER
+    log_println("image.relocate: %d of %d pages contain no pointers and stay shared with the image file",
+                    numberOfPagesWithoutPointers(relocationData), (theCodeEnd - theHeap) / virtualMemory_getPageSize());
 #endif
+    relocation_apply((void *) theHeap, theHeap - thePreferredHeap, relocationData, theHeader->relocationDataSize, word_BIG_ENDIAN, theHeader->wordSize, JVM_ActiveProcessorCount());
+
+    unmapRelocationData(mapping, mappingSize);
 #if log_LOADER
     log_println("image.relocate: done");
 #endif
 }
 
-void image_load(char *imageFileName) {
+#if PAGE_PROFILE
+
+#define PAGE_PROFILE_IDENTIFICATION 0xcafe9a9e
+#define PAGEMAP_PRESENT (1ULL << 63)
+#define PAGEMAP_SWAPPED (1ULL << 62)
+#define PAGEMAP_BATCH 512
+
+/*
+ * A page profile file contains the header below followed by a bit map with one bit per
+ * page of the boot heap and code. The random ID ties the profile to the image it was recorded from.
+ */
+typedef struct PageProfileHeader {
+    jint identification;
+    jint randomID;
+    jint numberOfPages;
+} PageProfileHeader;
+
+static char *thePageProfilePath = NULL;
+static int thePageProfileSeconds = 0;
+
+static char *pageProfilePath(const char *imageFileName) {
+    const char *suffix = ".pages";
+    char *path = (char *) malloc(strlen(imageFileName) + strlen(suffix) + 1);
+    if (path == NULL) {
+        log_exit(1, "could not allocate page profile path");
+    }
+    strcpy(path, imageFileName);
+    strcat(path, suffix);
+    return path;
+}
+
+static int numberOfHeapAndCodePages(void) {
+    return (theCodeEnd - theHeap) / virtualMemory_getPageSize();
+}
+
+/**
+ * Advises the kernel that the pages denoted by the page profile will be needed soon,
+ * issuing one request for each run of consecutive pages.
+ */
+static void prefetchPageProfile(const char *imageFileName) {
+    char *path = pageProfilePath(imageFileName);
+    PageProfileHeader header;
+    Size pageSize = virtualMemory_getPageSize();
+    int numberOfPages = numberOfHeapAndCodePages();
+    int size = (numberOfPages + 7) / 8;
+    int fd = open(path, O_RDONLY);
+    int page, firstPage = -1, requests = 0, prefetched = 0;
+    Byte *bits;
+
+    if (fd < 0) {
+        log_println("WARNING: could not open boot image page profile %s", path);
+        free(path);
+        return;
+    }
+    bits = (Byte *) malloc(size);
+    if (read(fd, &header, sizeof(header)) != sizeof(header) || header.identification != (jint) PAGE_PROFILE_IDENTIFICATION ||
+                    header.randomID != theHeader->randomID || header.numberOfPages != numberOfPages ||
+                    bits == NULL || read(fd, bits, size) != size) {
+        log_println("WARNING: ignoring invalid or stale boot image page profile %s", path);
+    } else {
+        for (page = 0; page <= numberOfPages; page++) {
+            boolean isProfiled = page < numberOfPages && (bits[page / 8] & (1 << (page % 8))) != 0;
+            if (isProfiled) {
+                if (firstPage < 0) {
+                    firstPage = page;
+                }
+                prefetched++;
+            } else if (firstPage >= 0) {
+                if (madvise((void *) (theHeap + firstPage * pageSize), (page - firstPage) * pageSize, MADV_WILLNEED) != 0) {
+                    log_println("WARNING: could not prefetch boot image pages %d-%d", firstPage, page - 1);
+                }
+                requests++;
+                firstPage = -1;
+            }
+        }
+#if log_LOADER
+        log_println("image.prefetchPageProfile: prefetched %d of %d pages with %d requests", prefetched, numberOfPages, requests);
+#endif
+    }
+    free(bits);
+    close(fd);
+    free(path);
+}
+
+/**
+ * Writes the page profile once the recording period has elapsed. The profile is written
+ * to a temporary file which is then renamed so that a concurrently starting VM never sees
+ * a partial profile. No profile is written if the VM exits before the recording period ends.
+ */
+static void *recordPageProfile(void *arg) {
+    Size pageSize = virtualMemory_getPageSize();
+    int numberOfPages = numberOfHeapAndCodePages();
+    Unsigned8 entries[PAGEMAP_BATCH];
+    struct timespec remaining;
+    PageProfileHeader header;
+    char *tmpPath;
+    Byte *bits;
+    int fd, page, recorded = 0;
+
+    remaining.tv_sec = thePageProfileSeconds;
+    remaining.tv_nsec = 0;
+    while (nanosleep(&remaining, &remaining) != 0 && errno == EINTR) {
+    }
+
+    bits = (Byte *) calloc((numberOfPages + 7) / 8, 1);
+    fd = open("/proc/self/pagemap", O_RDONLY);
+    if (bits == NULL || fd < 0) {
+        log_println("WARNING: could not record boot image page profile");
+        free(bits);
+        return NULL;
+    }
+    for (page = 0; page < numberOfPages; page += PAGEMAP_BATCH) {
+        int n = numberOfPages - page < PAGEMAP_BATCH ? numberOfPages - page : PAGEMAP_BATCH;
+        int i;
+        off_t offset = ((theHeap / pageSize) + page) * sizeof(Unsigned8);
+        if (pread(fd, entries, n * sizeof(Unsigned8), offset) != (ssize_t) (n * sizeof(Unsigned8))) {
+            log_println("WARNING: could not read /proc/self/pagemap");
+            close(fd);
+            free(bits);
+            return NULL;
+        }
+        for (i = 0; i < n; i++) {
+            if ((entries[i] & (PAGEMAP_PRESENT | PAGEMAP_SWAPPED)) != 0) {
+                bits[(page + i) / 8] |= 1 << ((page + i) % 8);
+                recorded++;
+            }
+        }
+    }
+    close(fd);
+
+    header.identification = PAGE_PROFILE_IDENTIFICATION;
+    header.randomID = theHeader->randomID;
+    header.numberOfPages = numberOfPages;
+    tmpPath = (char *) malloc(strlen(thePageProfilePath) + 5);
+    if (tmpPath != NULL) {
+        strcpy(tmpPath, thePageProfilePath);
+        strcat(tmpPath, ".tmp");
+        fd = open(tmpPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd >= 0 && write(fd, &header, sizeof(header)) == sizeof(header) &&
+                        write(fd, bits, (numberOfPages + 7) / 8) == (numberOfPages + 7) / 8 &&
+                        close(fd) == 0 && rename(tmpPath, thePageProfilePath) == 0) {
+#if log_LOADER
+            log_println("image.recordPageProfile: recorded %d of %d pages in %s", recorded, numberOfPages, thePageProfilePath);
+#endif
+        } else {
+            log_println("WARNING: could not write boot image page profile %s", thePageProfilePath);
+        }
+        free(tmpPath);
+    }
+    free(bits);
+    return NULL;
+}
+
+/**
+ * Starts a native thread that records the page profile after 'seconds' seconds. All signals
+ * are blocked in the thread so that it never handles signals meant for VM threads.
+ */
+static void startPageProfileRecorder(const char *imageFileName, int seconds) {
+    pthread_t thread;
+    pthread_attr_t attr;
+    sigset_t all, saved;
+
+    thePageProfilePath = pageProfilePath(imageFileName);
+    thePageProfileSeconds = seconds;
+    sigfillset(&all);
+    pthread_sigmask(SIG_SETMASK, &all, &saved);
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    if (pthread_create(&thread, &attr, recordPageProfile, NULL) != 0) {
+        log_println("WARNING: could not start boot image page profile recorder");
+    }
+    pthread_attr_destroy(&attr);
+    pthread_sigmask(SIG_SETMASK, &saved, NULL);
+}
+
+#endif
+
+void image_load(char *imageFileName, int relocationMode, int largePages, int pageProfile, int pageProfileSeconds, boolean mergeable) {
     if (theHeap != 0) {
         // loaded already (via inspector)
         return;
@@ -423,13 +1167,81 @@ void image_load(char *imageFileName) {
     checkImage();
     readStringInfo(fd);
     checkTrailer(fd);
-    mapHeapAndCode(fd);
+    startup_mark(STARTUP_IMAGE_CHECKED);
+#if !COMPRESSED_IMAGE
+    if (theHeader->compressionChunkSize != 0) {
+        log_exit(2, "compressed boot images are not supported on this platform");
+    }
+#endif
+    if (largePages != image_LARGE_PAGES_NONE || theHeader->compressionChunkSize != 0) {
+        // The boot heap and code are copied in their entirety instead of being mapped from the image file
+        if (relocationMode == image_RELOCATION_LAZY) {
+            // Lazily relocated pages are individually mapped from the image file
+            log_println("WARNING: lazy boot image relocation is not supported with large pages or compressed images, relocating eagerly");
+            relocationMode = image_RELOCATION_EAGER;
+        }
+        if (pageProfile != image_PAGE_PROFILE_NONE) {
+            log_println("WARNING: boot image page profiles are not supported with large pages or compressed images");
+            pageProfile = image_PAGE_PROFILE_NONE;
+        }
+    }
+    if (pageProfile == image_PAGE_PROFILE_RECORD && relocationMode == image_RELOCATION_EAGER) {
+        // Eager relocation writes every page with pointers, which would all be recorded as touched.
+        // Relocated lazily, a page with pointers is only recorded if a page of its range is accessed.
+#if LAZY_RELOCATION
+        relocationMode = image_RELOCATION_LAZY;
+#else
+        log_println("WARNING: the boot image page profile includes all the pages written by eager relocation");
+#endif
+    }
+    mapHeapAndCode(fd, largePages);
+    startup_mark(STARTUP_IMAGE_MAPPED);
 #if log_LOADER
     log_println("code @%p codeEnd @%p heap @%p", theCode, theCodeEnd, theHeap);
 #endif
-    relocate(fd);
+#if COMPRESSED_IMAGE
+    if (theHeader->compressionChunkSize != 0) {
+        decompressHeapAndCode(fd, theHeap != thePreferredHeap);
+        startup_mark(STARTUP_IMAGE_DECOMPRESSED);
+    }
+#endif
+#if PAGE_PROFILE
+    if (pageProfile == image_PAGE_PROFILE_PREFETCH) {
+        prefetchPageProfile(imageFileName);
+    } else if (pageProfile == image_PAGE_PROFILE_RECORD) {
+        startPageProfileRecorder(imageFileName, pageProfileSeconds);
+    }
+#else
+    if (pageProfile != image_PAGE_PROFILE_NONE) {
+        log_println("WARNING: boot image page profiles are not supported on this platform");
+    }
+#endif
+    relocate(fd, relocationMode);
+    startup_mark(STARTUP_IMAGE_RELOCATED);
 #if log_LOADER
     log_println("code @%p codeEnd @%p heap @%p", theCode, theCodeEnd, theHeap);
+#endif
+    if (theReservedVirtualSpace) {
+        Address *addr = image_offset_as_address(Address *, reservedVirtualSpaceFieldOffset);
+        *addr = theReservedVirtualSpace;
+    }
+    if (mergeable) {
+#if MERGEABLE_PAGES
+        if (relocationMode == image_RELOCATION_LAZY) {
+            // Lazily relocated pages are moved into place after the advice is given, losing it
+            log_println("WARNING: boot image pages cannot be made mergeable with lazy relocation");
+        } else if (madvise((void *) theHeap, theCodeEnd - theHeap, MADV_MERGEABLE) != 0) {
+            log_println("WARNING: could not make boot image pages mergeable");
+        }
+#else
+        log_println("WARNING: mergeable boot image pages are not supported on this platform");
+#endif
+    }
+#if LAZY_RELOCATION
+    if (fd == theLazyImageFd) {
+        // the lazy relocation of boot image pages maps them from the image file
+        return;
+    }
 #endif
     int error = close(fd);
     if (error != 0) {
@@ -53,6 +53,9 @@
     f(reservedVirtualSpaceSize) /* Amount of contiguous virtual space to reserve at boot image load-time  */ \
     f(reservedVirtualSpaceFieldOffset) /* offset where to store the address of the reserved contiguous virtual space, if any*/ \
     f(bootRegionMappingConstraint) \
+    f(preferredHeapAddressMB) /* Address (in MB) to which the heap and code are pre-relocated, 0 for a canonical image */ \
+    f(compressionChunkSize) /* Bytes of heap and code per compressed chunk, 0 if the heap and code are not compressed */ \
+    f(compressedHeapAndCodeSize) /* Size of the chunk table and compressed chunks, 0 if not compressed */ \
     f(tlaListHeadOffset) /* See the comment for the 'tlaListHead' field in the VmThreadMap class.  */ \
     f(exitCodeOffset) \
     f(tlaSize) /* The size of a TLA.  */ \
@@ -119,6 +122,33 @@ typedef struct image_Trailer {
     jint identification;
 } *image_Trailer;
 
+/*
+ * The modes in which the pointers in the boot heap and code can be relocated,
+ * selected with the '-XX:ImageRelocation=' option (see maxine.c).
+ */
+#define image_RELOCATION_EAGER 0 /* relocate the whole boot heap and code while loading the image */
+#define image_RELOCATION_LAZY  1 /* relocate each page of the boot heap and code when it is first accessed */
+
+/*
+ * The kinds of pages with which the boot heap and code can be backed,
+ * selected with the '-XX:ImageLargePages=' option (see maxine.c).
+ */
+#define image_LARGE_PAGES_NONE 0 /* map the boot heap and code from the image file with normal pages */
+#define image_LARGE_PAGES_THP  1 /* copy the boot heap and code into memory advised to use transparent huge pages */
+#define image_LARGE_PAGES_2M   2 /* copy the boot heap and code into explicitly allocated 2MB huge pages */
+#define image_LARGE_PAGES_1G   3 /* copy the boot heap and code into explicitly allocated 1GB huge pages */
+
+/*
+ * The uses of a page profile of the boot heap and code, selected with the
+ * '-XX:ImagePageProfile=' option (see maxine.c). The profile is a file next
+ * to the boot image denoting the pages touched early in a previous run.
+ */
+#define image_PAGE_PROFILE_NONE     0 /* neither record nor use a page profile */
+#define image_PAGE_PROFILE_RECORD   1 /* record the pages touched in the first seconds of execution, relocating lazily */
+#define image_PAGE_PROFILE_PREFETCH 2 /* prefetch the pages denoted by a page profile while loading the image */
+
+#define image_PAGE_PROFILE_DEFAULT_SECONDS 10
+
 /**
  *  Read and verify the boot image file header, the string info section and the trailer,
  *  then verify these, then mmap the boot image, then relocate pointers in it.
@@ -130,8 +160,30 @@ typedef struct image_Trailer {
  *   - boot code data
  *
  * @param imageFileName full path of the boot image file
+ * @param relocationMode one of the image_RELOCATION_* values
+ * @param largePages one of the image_LARGE_PAGES_* values
+ * @param pageProfile one of the image_PAGE_PROFILE_* values
+ * @param pageProfileSeconds the number of seconds during which touched pages are recorded if {@code pageProfile == image_PAGE_PROFILE_RECORD}
+ * @param mergeable specifies if the relocated boot heap and code pages should be made available for merging
+ *        with identical pages in other processes (e.g. other VMs relocated to the same address)
+ */
+extern void image_load(char *imageFileName, int relocationMode, int largePages, int pageProfile, int pageProfileSeconds, boolean mergeable);
+
+/**
+ * Relocates the range of pages of the boot heap or code containing a given address if the image
+ * is being relocated lazily and the page has not yet been relocated.
+ *
+ * @param faultAddress the address whose access raised a memory fault
+ * @return true if the faulting access should be retried, false if the fault is not due to lazy relocation
+ */
+extern boolean image_relocateOnFault(Address faultAddress);
+
+/**
+ * Relocates all pages of the boot heap or code overlapping a given memory range if the image is being
+ * relocated lazily. This must be called before passing a buffer that may be in the boot heap to a
+ * system call, as the kernel fails with EFAULT instead of raising a fault on a page not yet relocated.
  */
-extern void image_load(char *imageFileName);
+extern void image_relocateRange(Address start, Size length);
 
 /**
  * Must only be called after calling 'load_image()'.
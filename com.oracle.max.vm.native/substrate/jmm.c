@@ -19,6 +19,9 @@
  * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <string.h>
+
+#include "os.h"
 #include "jmm.h"
 
 static void jmm_reserved() {
@@ -29,6 +32,12 @@ static jint jmm_GetVersion(JNIEnv *env) {
 }
 
 static jint jmm_GetOptionalSupport(JNIEnv *env, jmmOptionalSupport* support) {
+    memset(support, 0, sizeof(jmmOptionalSupport));
+#if os_LINUX || os_DARWIN
+    /* See Java_com_sun_max_vm_thread_VmThread_nativeThreadCpuTime in threads.c. */
+    support->isCurrentThreadCpuTimeSupported = 1;
+    support->isOtherThreadCpuTimeSupported = 1;
+#endif
     return 0;
 }
 
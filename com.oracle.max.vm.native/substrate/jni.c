@@ -121,24 +121,96 @@ static void copyVarargsToArray(jvalue *argumentArray, va_list argumentList, int
     }
 }
 
+/*
+ * A cache of the argument kinds of the methods called through the varargs functions, so that
+ * calling a method again does not make the upcalls that parse its signature. Entries are only
+ * ever added: a method ID denotes the same method for the lifetime of the VM. When the table is
+ * full, methods that are not in it are handled by the upcalls each time.
+ */
+#define ARGUMENT_KINDS_CACHE_SIZE 4096
+#define ARGUMENT_KINDS_CACHE_PROBES 8
+
+typedef struct {
+    int numberOfArguments;
+    char kinds[];
+} ArgumentKindsStruct, *ArgumentKinds;
+
+typedef struct {
+    volatile Address methodID;
+    ArgumentKinds volatile argumentKinds;    // published after 'methodID'
+} ArgumentKindsEntryStruct;
+
+static ArgumentKindsEntryStruct argumentKindsCache[ARGUMENT_KINDS_CACHE_SIZE];
+
+/**
+ * Gets the cached kinds of the arguments of a method, adding them to the cache if necessary.
+ *
+ * @return NULL if the kinds are not in the cache and could not be added
+ */
+static char *argumentKinds(JNIEnv *env, jmethodID methodID, int *numberOfArguments) {
+    Address key = (Address) methodID;
+    unsigned int index = (unsigned int) ((key ^ (key >> 17)) * 2654435761u) % ARGUMENT_KINDS_CACHE_SIZE;
+    int probe;
+    for (probe = 0; probe < ARGUMENT_KINDS_CACHE_PROBES; probe++) {
+        ArgumentKindsEntryStruct *entry = &argumentKindsCache[(index + probe) % ARGUMENT_KINDS_CACHE_SIZE];
+        Address current = entry->methodID;
+        if (current == key) {
+            ArgumentKinds argumentKinds = __atomic_load_n(&entry->argumentKinds, __ATOMIC_ACQUIRE);
+            if (argumentKinds == NULL) {
+                /* Another thread is adding the entry. */
+                return NULL;
+            }
+            *numberOfArguments = argumentKinds->numberOfArguments;
+            return argumentKinds->kinds;
+        }
+        if (current == 0) {
+            if (!__sync_bool_compare_and_swap(&entry->methodID, 0, key)) {
+                /* Lost the race for this slot: look at it again. */
+                probe--;
+                continue;
+            }
+            int n = getVMInterface()->GetNumberOfArguments(env, methodID);
+            ArgumentKinds argumentKinds = (ArgumentKinds) malloc(sizeof(ArgumentKindsStruct) + n);
+            if (argumentKinds == NULL) {
+                /* The slot stays claimed and the method is handled by the upcalls. */
+                return NULL;
+            }
+            argumentKinds->numberOfArguments = n;
+            getVMInterface()->GetKindsOfArguments(env, methodID, argumentKinds->kinds);
+            if ((*env)->ExceptionCheck(env)) {
+                /* An invalid method ID: do not cache whatever was filled in. */
+                free(argumentKinds);
+                return NULL;
+            }
+            __atomic_store_n(&entry->argumentKinds, argumentKinds, __ATOMIC_RELEASE);
+            *numberOfArguments = n;
+            return argumentKinds->kinds;
+        }
+    }
+    return NULL;
+}
+
 /**
  * Copies the varargs from their platform dependent locations into a jvalue array allocated on
  * the current call stack. This array can then be passed to the corresponding routine that
  * takes such an array of arguments.
  *
- * This copying of arguments allocates two arrays on the stack; a jbyte array for getting
- * the kinds of the arguments and the jvalue array for the copied arguments. The number
- * of arguments is determined by parsing the method's signature.
+ * This copying of arguments allocates a jvalue array on the stack for the copied arguments.
+ * The number and kinds of the arguments are determined by parsing the method's signature
+ * the first time the method is called (see argumentKinds()).
  */
 #define PREPARE_CALL \
     int numberOfVarArgs; \
     jvalue *argumentArray; \
     char *kinds; \
     \
-    numberOfVarArgs = getVMInterface()->GetNumberOfArguments(env, methodID); \
-    /* Space for array of argument kinds is stack allocated and so needs no corresponding deallocation */ \
-    kinds = (char *) alloca(numberOfVarArgs); \
-    getVMInterface()->GetKindsOfArguments(env, methodID, kinds); \
+    kinds = argumentKinds(env, methodID, &numberOfVarArgs); \
+    if (kinds == NULL) { \
+        numberOfVarArgs = getVMInterface()->GetNumberOfArguments(env, methodID); \
+        /* Space for array of argument kinds is stack allocated and so needs no corresponding deallocation */ \
+        kinds = (char *) alloca(numberOfVarArgs); \
+        getVMInterface()->GetKindsOfArguments(env, methodID, kinds); \
+    } \
     /* Space for arguments is stack allocated and so needs no corresponding deallocation */ \
     argumentArray = (jvalue *) alloca(sizeof(jvalue) * numberOfVarArgs); \
     \
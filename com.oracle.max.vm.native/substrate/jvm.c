@@ -33,8 +33,10 @@
 #include <fcntl.h>
 #include <string.h>
 #include <sys/ioctl.h>
+#include <sys/socket.h>
 #include <sys/stat.h>
 #include <sys/time.h>
+#include <sys/uio.h>
 #include <sched.h>
 #if os_DARWIN
 #include <sys/poll.h>
@@ -49,11 +51,28 @@
 #include "threads.h"
 #include "maxine.h"
 #include "memory.h"
+#include "cgroup.h"
+#include "dataio.h"
+#include "readiness.h"
+#include "resolver.h"
+#include "lookupCache.h"
+#include "symbolIndex.h"
+#include "image.h"
 
 #if os_SOLARIS
 #include <sys/filio.h>
 #endif
 
+#if os_LINUX
+#include <sys/sendfile.h>
+#include <sys/syscall.h>
+#endif
+
+#if os_SOLARIS || os_LINUX || os_DARWIN
+#include <netdb.h>
+#include <pthread.h>
+#endif
+
 #if os_DARWIN
 #define lseek64 lseek
 #include <sys/poll.h>
@@ -156,8 +175,37 @@ jlong JVM_NanoTime(JNIEnv *env, jclass ignored) {
     return native_nanoTime();
 }
 
+/*
+ * Copies of at least this many elements between primitive arrays are done here. Checking and pinning
+ * the arrays takes several upcalls, so shorter copies are cheaper to do with the single upcall of vm.ArrayCopy.
+ */
+#define NATIVE_ARRAY_COPY_MIN_LENGTH 1024
+
 void
 JVM_ArrayCopy(JNIEnv *env, jclass ignored, jobject src, jint src_pos, jobject dst, jint dst_pos, jint length) {
+    if (length >= NATIVE_ARRAY_COPY_MIN_LENGTH) {
+        /* Object arrays are copied by the VM, which applies the store checks and barriers. */
+        jint elementSize = vm.PrimitiveArrayCopyElementSize(env, src, src_pos, dst, dst_pos, length);
+        if (elementSize < 0) {
+            /* An exception is pending. */
+            return;
+        }
+        if (elementSize > 0) {
+            Address srcElements = (Address) (*env)->GetPrimitiveArrayCritical(env, src, NULL);
+            if (srcElements == 0) {
+                return;
+            }
+            Address dstElements = (Address) (*env)->GetPrimitiveArrayCritical(env, dst, NULL);
+            if (dstElements == 0) {
+                (*env)->ReleasePrimitiveArrayCritical(env, src, (void *) srcElements, JNI_ABORT);
+                return;
+            }
+            memory_copy(dstElements + (Size) dst_pos * elementSize, srcElements + (Size) src_pos * elementSize, (Size) length * elementSize);
+            (*env)->ReleasePrimitiveArrayCritical(env, dst, (void *) dstElements, 0);
+            (*env)->ReleasePrimitiveArrayCritical(env, src, (void *) srcElements, JNI_ABORT);
+            return;
+        }
+    }
     vm.ArrayCopy(env, src, src_pos, dst, dst_pos, length);
 }
 
@@ -176,9 +224,51 @@ void JVM_OnExit(void (*func)(void)) {
 /*
  * java.nio.Bits
  */
+static jint theArrayBaseOffset = -1;
+
+/*
+ * Copies 'size' bytes, reversing the bytes of each element of 'elemSize' bytes. An operand that is
+ * a (primitive) array is addressed by an Unsafe style offset from its origin; otherwise the offset
+ * is an absolute address. The arrays are accessed as JNI critical arrays so that they cannot be moved
+ * by the GC during the copy.
+ */
 void JVM_CopySwapMemory(JNIEnv *env, jobject srcObj, jlong srcOffset,
                         jobject dstObj, jlong dstOffset, jlong size, jlong elemSize) {
-    UNIMPLEMENTED_WITH_ENV();
+    if (srcObj == NULL && dstObj == NULL) {
+        copySwapped((Address) dstOffset, (Address) srcOffset, (Size) size, (int) elemSize);
+        return;
+    }
+    if (theArrayBaseOffset < 0) {
+        theArrayBaseOffset = vm.ArrayBaseOffset(env);
+    }
+    void *srcElements = NULL;
+    void *dstElements = NULL;
+    Address src = (Address) srcOffset;
+    Address dst = (Address) dstOffset;
+    if (srcObj != NULL) {
+        srcElements = (*env)->GetPrimitiveArrayCritical(env, srcObj, NULL);
+        if (srcElements == NULL) {
+            return;
+        }
+        src = (Address) srcElements + (srcOffset - theArrayBaseOffset);
+    }
+    if (dstObj != NULL) {
+        dstElements = (*env)->GetPrimitiveArrayCritical(env, dstObj, NULL);
+        if (dstElements == NULL) {
+            if (srcElements != NULL) {
+                (*env)->ReleasePrimitiveArrayCritical(env, srcObj, srcElements, JNI_ABORT);
+            }
+            return;
+        }
+        dst = (Address) dstElements + (dstOffset - theArrayBaseOffset);
+    }
+    copySwapped(dst, src, (Size) size, (int) elemSize);
+    if (dstElements != NULL) {
+        (*env)->ReleasePrimitiveArrayCritical(env, dstObj, dstElements, 0);
+    }
+    if (srcElements != NULL) {
+        (*env)->ReleasePrimitiveArrayCritical(env, srcObj, srcElements, JNI_ABORT);
+    }
 }
 
 /*
@@ -272,6 +362,11 @@ JVM_ActiveProcessorCount(void) {
         cpu_count = sysconf(_SC_NPROCESSORS_ONLN);
     }
 
+    // the CPU quota of the container (i.e. control group) the VM runs in may be lower
+    int cpu_limit = cgroup_processorLimit();
+    if (cpu_limit > 0 && cpu_limit < cpu_count) {
+        cpu_count = cpu_limit;
+    }
     return cpu_count;
 #elif os_DARWIN
     // Linux doesn't yet have a (official) notion of processor sets,
@@ -302,6 +397,8 @@ JVM_LoadLibrary(const char *name) {
 void
 JVM_UnloadLibrary(void * handle) {
 #if os_SOLARIS || os_LINUX || os_DARWIN
+    symbolIndex_forget(handle);
+    log_forgetSymbols();
     dlclose(handle);
 #else
     UNIMPLEMENTED();
@@ -311,7 +408,7 @@ JVM_UnloadLibrary(void * handle) {
 void *
 JVM_FindLibraryEntry(void *handle, const char *name) {
 #if os_SOLARIS || os_LINUX || os_DARWIN
-    return dlsym(handle, name);
+    return symbolIndex_lookup(handle, name);
 #else
     UNIMPLEMENTED();
     return 0;
@@ -481,7 +578,7 @@ JVM_HoldsLock(JNIEnv *env, jclass threadClass, jobject obj) {
 
 void
 JVM_DumpAllStacks(JNIEnv *env, jclass unused) {
-    UNIMPLEMENTED_WITH_ENV();
+    vm.DumpAllStacks(env);
 }
 
 jobjectArray
@@ -492,8 +589,7 @@ JVM_GetAllThreads(JNIEnv *env, jclass dummy) {
 /* getStackTrace() and getAllStackTraces() method */
 jobjectArray
 JVM_DumpThreads(JNIEnv *env, jclass threadClass, jobjectArray threads) {
-    UNIMPLEMENTED_WITH_ENV();
-    return 0;
+    return (jobjectArray) vm.DumpThreads(env, threads);
 }
 
 /*
@@ -1193,17 +1289,144 @@ JVM_CX8Field(JNIEnv *env, jobject obj, jfieldID fldID, jlong oldVal, jlong newVa
 /*************************************************************************
  PART 2: Support for the Verifier and Class File Format Checker
  ************************************************************************/
+/*
+ * The strings returned by the JVM_Get*UTF functions below are interned in a table whose strings are never
+ * freed. A verifier makes many of these calls per class: with the table, a call allocates nothing once its
+ * string has been seen and JVM_ReleaseUTF has nothing to do. The table only ever holds class, member and
+ * signature names, which the VM interns in its own symbol table as well.
+ *
+ * The kinds of strings, which must match VMFunctionsSource.ClassFileUTF().
+ */
+#define CLASS_FILE_UTF_CLASS_NAME        0
+#define CLASS_FILE_UTF_CP_FIELD_NAME     1
+#define CLASS_FILE_UTF_CP_METHOD_NAME    2
+#define CLASS_FILE_UTF_CP_METHOD_SIG     3
+#define CLASS_FILE_UTF_CP_FIELD_SIG      4
+#define CLASS_FILE_UTF_CP_CLASS_NAME     5
+#define CLASS_FILE_UTF_CP_FIELD_CLASS    6
+#define CLASS_FILE_UTF_CP_METHOD_CLASS   7
+
+#define UTF_ARENA_CHUNK_SIZE (64 * 1024)
+
+typedef struct {
+    Unsigned4 hash;
+    Unsigned4 length;
+    const char *utf;
+} InternedUTFStruct, *InternedUTF;
+
+static mutex_Struct theUTFLock;
+static pthread_once_t theUTFLockOnce = PTHREAD_ONCE_INIT;
+static InternedUTF theUTFTable;
+static Unsigned4 theUTFTableCapacity;
+static Unsigned4 theUTFTableCount;
+static char *theUTFArena;
+static Size theUTFArenaAvailable;
+
+static InternedUTF findUTF(InternedUTF table, Unsigned4 capacity, const char *utf, Unsigned4 length, Unsigned4 hash) {
+    Unsigned4 i = hash & (capacity - 1);
+    for (;;) {
+        InternedUTF entry = &table[i];
+        if (entry->utf == NULL || (entry->hash == hash && entry->length == length && memcmp(entry->utf, utf, length) == 0)) {
+            return entry;
+        }
+        i = (i + 1) & (capacity - 1);
+    }
+}
+
+/*
+ * Interns a copy of a NUL terminated modified UTF-8 string. The caller holds theUTFLock.
+ */
+static const char *internUTF(const char *utf, Unsigned4 length) {
+    Unsigned4 hash = 2166136261u;
+    Unsigned4 i;
+    for (i = 0; i < length; i++) {
+        hash = (hash ^ (Unsigned1) utf[i]) * 16777619u;
+    }
+    if ((theUTFTableCount + 1) * 2 > theUTFTableCapacity) {
+        Unsigned4 capacity = theUTFTableCapacity == 0 ? 4096 : theUTFTableCapacity * 2;
+        InternedUTF table = (InternedUTF) calloc(capacity, sizeof(InternedUTFStruct));
+        if (table == NULL) {
+            return NULL;
+        }
+        for (i = 0; i < theUTFTableCapacity; i++) {
+            if (theUTFTable[i].utf != NULL) {
+                *findUTF(table, capacity, theUTFTable[i].utf, theUTFTable[i].length, theUTFTable[i].hash) = theUTFTable[i];
+            }
+        }
+        free(theUTFTable);
+        theUTFTable = table;
+        theUTFTableCapacity = capacity;
+    }
+    InternedUTF entry = findUTF(theUTFTable, theUTFTableCapacity, utf, length, hash);
+    if (entry->utf != NULL) {
+        return entry->utf;
+    }
+    Size size = length + 1;
+    char *copy;
+    if (size > UTF_ARENA_CHUNK_SIZE / 4) {
+        copy = (char *) malloc(size);
+    } else {
+        if (size > theUTFArenaAvailable) {
+            theUTFArena = (char *) malloc(UTF_ARENA_CHUNK_SIZE);
+            theUTFArenaAvailable = theUTFArena == NULL ? 0 : UTF_ARENA_CHUNK_SIZE;
+        }
+        if (size > theUTFArenaAvailable) {
+            return NULL;
+        }
+        copy = theUTFArena;
+        theUTFArena += size;
+        theUTFArenaAvailable -= size;
+    }
+    if (copy == NULL) {
+        return NULL;
+    }
+    memcpy(copy, utf, size);
+    entry->hash = hash;
+    entry->length = length;
+    entry->utf = copy;
+    theUTFTableCount++;
+    return copy;
+}
+
+static void initializeUTFLock(void) {
+    mutex_initialize(&theUTFLock);
+}
+
+static const char *classFileUTF(JNIEnv *env, jclass cb, jint kind, jint index) {
+    jstring string = (jstring) vm.ClassFileUTF(env, cb, kind, index);
+    if (string == NULL) {
+        return NULL;
+    }
+    jsize length = (*env)->GetStringLength(env, string);
+    jsize utfLength = (*env)->GetStringUTFLength(env, string);
+    char buffer[256];
+    char *utf = utfLength < (jsize) sizeof(buffer) ? buffer : (char *) malloc(utfLength + 1);
+    const char *result = NULL;
+    if (utf != NULL) {
+        (*env)->GetStringUTFRegion(env, string, 0, length, utf);
+        utf[utfLength] = '\0';
+        pthread_once(&theUTFLockOnce, initializeUTFLock);
+        mutex_enter(&theUTFLock);
+        result = internUTF(utf, (Unsigned4) utfLength);
+        mutex_exit(&theUTFLock);
+        if (utf != buffer) {
+            free(utf);
+        }
+    }
+    (*env)->DeleteLocalRef(env, string);
+    return result;
+}
+
 /*
  * Return the class name in UTF format. The result is valid
- * until JVM_ReleaseUTf is called.
+ * until JVM_ReleaseUTf is called (in fact for the lifetime of the VM).
  *
  * The caller must treat the string as a constant and not modify it
  * in any way.
  */
 const char *
 JVM_GetClassNameUTF(JNIEnv *env, jclass cb) {
-    UNIMPLEMENTED_WITH_ENV();
-    return 0;
+    return classFileUTF(env, cb, CLASS_FILE_UTF_CLASS_NAME, 0);
 }
 
 /*
@@ -1412,8 +1635,7 @@ JVM_GetMethodIxSignatureUTF(JNIEnv *env, jclass cb, jint index) {
  */
 const char *
 JVM_GetCPFieldNameUTF(JNIEnv *env, jclass cb, jint index) {
-    UNIMPLEMENTED_WITH_ENV();
-    return 0;
+    return classFileUTF(env, cb, CLASS_FILE_UTF_CP_FIELD_NAME, index);
 }
 
 /*
@@ -1428,8 +1650,7 @@ JVM_GetCPFieldNameUTF(JNIEnv *env, jclass cb, jint index) {
  */
 const char *
 JVM_GetCPMethodNameUTF(JNIEnv *env, jclass cb, jint index) {
-    UNIMPLEMENTED_WITH_ENV();
-    return 0;
+    return classFileUTF(env, cb, CLASS_FILE_UTF_CP_METHOD_NAME, index);
 }
 
 /*
@@ -1444,8 +1665,7 @@ JVM_GetCPMethodNameUTF(JNIEnv *env, jclass cb, jint index) {
  */
 const char *
 JVM_GetCPMethodSignatureUTF(JNIEnv *env, jclass cb, jint index) {
-    UNIMPLEMENTED_WITH_ENV();
-    return 0;
+    return classFileUTF(env, cb, CLASS_FILE_UTF_CP_METHOD_SIG, index);
 }
 
 /*
@@ -1460,8 +1680,7 @@ JVM_GetCPMethodSignatureUTF(JNIEnv *env, jclass cb, jint index) {
  */
 const char *
 JVM_GetCPFieldSignatureUTF(JNIEnv *env, jclass cb, jint index) {
-    UNIMPLEMENTED_WITH_ENV();
-    return 0;
+    return classFileUTF(env, cb, CLASS_FILE_UTF_CP_FIELD_SIG, index);
 }
 
 /*
@@ -1475,8 +1694,7 @@ JVM_GetCPFieldSignatureUTF(JNIEnv *env, jclass cb, jint index) {
  */
 const char *
 JVM_GetCPClassNameUTF(JNIEnv *env, jclass cb, jint index) {
-    UNIMPLEMENTED_WITH_ENV();
-    return 0;
+    return classFileUTF(env, cb, CLASS_FILE_UTF_CP_CLASS_NAME, index);
 }
 
 /*
@@ -1492,8 +1710,7 @@ JVM_GetCPClassNameUTF(JNIEnv *env, jclass cb, jint index) {
  */
 const char *
 JVM_GetCPFieldClassNameUTF(JNIEnv *env, jclass cb, jint index) {
-    UNIMPLEMENTED_WITH_ENV();
-    return 0;
+    return classFileUTF(env, cb, CLASS_FILE_UTF_CP_FIELD_CLASS, index);
 }
 
 /*
@@ -1510,8 +1727,7 @@ JVM_GetCPFieldClassNameUTF(JNIEnv *env, jclass cb, jint index) {
  */
 const char *
 JVM_GetCPMethodClassNameUTF(JNIEnv *env, jclass cb, jint index) {
-    UNIMPLEMENTED_WITH_ENV();
-    return 0;
+    return classFileUTF(env, cb, CLASS_FILE_UTF_CP_METHOD_CLASS, index);
 }
 
 /*
@@ -1542,11 +1758,10 @@ JVM_GetCPMethodModifiers(JNIEnv *env, jclass cb, int index, jclass calledClass)
 }
 
 /*
- * Releases the UTF string obtained from the VM.
+ * Releases the UTF string obtained from the VM. The strings are interned and never freed.
  */
 void
 JVM_ReleaseUTF(const char *utf) {
-    UNIMPLEMENTED();
 }
 
 /*
@@ -1878,6 +2093,7 @@ jint JVM_Close(jint fd) {
  */
 jint
 JVM_Read(jint fd, char *buf, jint nbytes) {
+    image_relocateRange((Address) buf, (Size) nbytes);
     return (jint) read(fd, buf, (size_t) nbytes);
 }
 
@@ -1892,9 +2108,155 @@ JVM_Read(jint fd, char *buf, jint nbytes) {
  */
 jint
 JVM_Write(jint fd, char *buf, jint nbytes) {
+    image_relocateRange((Address) buf, (Size) nbytes);
     return (jint) write(fd, buf, (size_t) nbytes);
 }
 
+/*
+ * Scatter/gather and positional I/O. These return the number of bytes transferred or -1 (with errno set) on error.
+ *
+ * iov       an array of 'count' struct iovec describing the buffers
+ * offset    the file position at which to read or write, which does not change the file pointer
+ */
+static void relocateIOVectors(const struct iovec *iov, jint count) {
+    int i;
+    for (i = 0; i < count; i++) {
+        image_relocateRange((Address) iov[i].iov_base, (Size) iov[i].iov_len);
+    }
+}
+
+jlong
+JVM_Readv(jint fd, void *iov, jint count) {
+    relocateIOVectors((const struct iovec *) iov, count);
+    return (jlong) readv(fd, (const struct iovec *) iov, count);
+}
+
+jlong
+JVM_Writev(jint fd, void *iov, jint count) {
+    relocateIOVectors((const struct iovec *) iov, count);
+    return (jlong) writev(fd, (const struct iovec *) iov, count);
+}
+
+jint
+JVM_Pread(jint fd, char *buf, jint nbytes, jlong offset) {
+    image_relocateRange((Address) buf, (Size) nbytes);
+    return (jint) pread(fd, buf, (size_t) nbytes, (off_t) offset);
+}
+
+jint
+JVM_Pwrite(jint fd, char *buf, jint nbytes, jlong offset) {
+    image_relocateRange((Address) buf, (Size) nbytes);
+    return (jint) pwrite(fd, buf, (size_t) nbytes, (off_t) offset);
+}
+
+#define COPY_BUFFER_SIZE (64 * 1024)
+
+/*
+ * Copies up to 'count' bytes between two file descriptors through a buffer, for the platforms and
+ * descriptors for which the kernel cannot do the copy. An offset that is not NULL gives the position
+ * at which to read or write with pread/pwrite (and is advanced), leaving the file pointer untouched;
+ * a NULL offset reads or writes at the file pointer.
+ */
+static jlong copyThroughBuffer(jint inFd, jlong *inOffset, jint outFd, jlong *outOffset, jlong count) {
+    char buffer[COPY_BUFFER_SIZE];
+    jlong copied = 0;
+    while (copied < count) {
+        size_t n = count - copied < COPY_BUFFER_SIZE ? (size_t) (count - copied) : COPY_BUFFER_SIZE;
+        ssize_t r = inOffset != NULL ? pread(inFd, buffer, n, (off_t) *inOffset) : read(inFd, buffer, n);
+        if (r <= 0) {
+            if (r < 0 && copied == 0) {
+                return -1;
+            }
+            break;
+        }
+        ssize_t written = 0;
+        while (written < r) {
+            ssize_t w = outOffset != NULL ? pwrite(outFd, buffer + written, r - written, (off_t) *outOffset) : write(outFd, buffer + written, r - written);
+            if (w < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                /* The bytes read but not written are lost for a read at the file pointer, as with sendfile(2). */
+                return copied + written > 0 ? copied + written : -1;
+            }
+            written += w;
+            if (inOffset != NULL) {
+                *inOffset += w;
+            }
+            if (outOffset != NULL) {
+                *outOffset += w;
+            }
+        }
+        copied += r;
+    }
+    return copied;
+}
+
+/*
+ * Kernel to kernel copies. Each of these copies up to 'count' bytes and returns the number of bytes
+ * copied or -1 (with errno set) on error. An offset that is not NULL gives the position in the
+ * corresponding file at which to copy, which is advanced instead of the file pointer. Where the
+ * kernel does not support the copy for the given descriptors, the data is copied through a buffer.
+ */
+jlong
+JVM_Sendfile(jint outFd, jint inFd, jlong *offset, jlong count) {
+#if os_LINUX
+    off_t position = offset != NULL ? (off_t) *offset : 0;
+    ssize_t result = sendfile(outFd, inFd, offset != NULL ? &position : NULL, (size_t) count);
+    if (result >= 0 || (errno != EINVAL && errno != ENOSYS)) {
+        if (offset != NULL) {
+            *offset = position;
+        }
+        return result;
+    }
+#endif
+    return copyThroughBuffer(inFd, offset, outFd, NULL, count);
+}
+
+/*
+ * One of the descriptors must be a pipe on Linux. 'flags' are the SPLICE_F_* flags of splice(2).
+ */
+jlong
+JVM_Splice(jint inFd, jlong *inOffset, jint outFd, jlong *outOffset, jlong count, jint flags) {
+#if os_LINUX
+    loff_t inPosition = inOffset != NULL ? (loff_t) *inOffset : 0;
+    loff_t outPosition = outOffset != NULL ? (loff_t) *outOffset : 0;
+    ssize_t result = splice(inFd, inOffset != NULL ? &inPosition : NULL, outFd, outOffset != NULL ? &outPosition : NULL, (size_t) count, (unsigned int) flags);
+    if (inOffset != NULL) {
+        *inOffset = inPosition;
+    }
+    if (outOffset != NULL) {
+        *outOffset = outPosition;
+    }
+    return result;
+#else
+    return copyThroughBuffer(inFd, inOffset, outFd, outOffset, count);
+#endif
+}
+
+jlong
+JVM_CopyFileRange(jint inFd, jlong *inOffset, jint outFd, jlong *outOffset, jlong count) {
+#if os_LINUX && defined(__NR_copy_file_range)
+    loff_t inPosition = inOffset != NULL ? (loff_t) *inOffset : 0;
+    loff_t outPosition = outOffset != NULL ? (loff_t) *outOffset : 0;
+    long result = syscall(__NR_copy_file_range, inFd, inOffset != NULL ? &inPosition : NULL, outFd, outOffset != NULL ? &outPosition : NULL, (size_t) count, 0);
+    if (result >= 0 || (errno != ENOSYS && errno != EXDEV && errno != EINVAL && errno != EOPNOTSUPP)) {
+        if (inOffset != NULL) {
+            *inOffset = inPosition;
+        }
+        if (outOffset != NULL) {
+            *outOffset = outPosition;
+        }
+        return result;
+    }
+#endif
+    if (outOffset != NULL) {
+        /* sendfile(2) can only write at the file pointer, which must not be moved. */
+        return copyThroughBuffer(inFd, inOffset, outFd, outOffset, count);
+    }
+    return JVM_Sendfile(outFd, inFd, inOffset, count);
+}
+
 /*
  * Returns the number of bytes available for reading from a given file
  * descriptor
@@ -2031,35 +2393,8 @@ JVM_Send(jint fd, char *buf, jint nBytes, jint flags) {
 jint
 JVM_Timeout(int fd, long timeout) {
 #if os_DARWIN || os_LINUX
-    Unsigned8 prevtime,newtime;
-    struct timeval t;
-
-    gettimeofday(&t, NULL);
-    prevtime = ((Unsigned8)t.tv_sec * 1000)  +  t.tv_usec / 1000;
-
-    for(;;) {
-      struct pollfd pfd;
-
-      pfd.fd = fd;
-      pfd.events = POLLIN | POLLERR;
-
-      int res = poll(&pfd, 1, timeout);
-
-      if (res == OS_ERR && errno == EINTR) {
-
-        // On Bsd/Linux any value < 0 means "forever"
-
-        if(timeout >= 0) {
-          gettimeofday(&t, NULL);
-          newtime = ((Unsigned8)t.tv_sec * 1000)  +  t.tv_usec / 1000;
-          timeout -= newtime - prevtime;
-          if(timeout <= 0)
-            return OS_OK;
-          prevtime = newtime;
-        }
-      } else
-        return res;
-    }
+    /* On Bsd/Linux any value < 0 means "forever". */
+    return readiness_waitReadable(fd, (jlong) timeout);
 #elif os_SOLARIS
     int res;
     struct timeval t;
@@ -2137,7 +2472,7 @@ JVM_Accept(jint fd, struct sockaddr *him, jint *len) {
 jint
 JVM_RecvFrom(jint fd, char *buf, int nBytes,
                   int flags, struct sockaddr *from, int *fromlen) {
-#if os_SOLARIS
+#if os_SOLARIS || os_LINUX || os_DARWIN
     return recvfrom(fd, buf, nBytes, (unsigned int) flags, from, (socklen_t *)fromlen);
 #else
     UNIMPLEMENTED();
@@ -2148,7 +2483,7 @@ JVM_RecvFrom(jint fd, char *buf, int nBytes,
 jint
 JVM_SendTo(jint fd, char *buf, int len,
                 int flags, struct sockaddr *to, int tolen) {
-#if os_SOLARIS
+#if os_SOLARIS || os_LINUX || os_DARWIN
     return sendto(fd, buf, len, (unsigned int) flags, to, tolen);
 #else
     UNIMPLEMENTED();
@@ -2241,6 +2576,95 @@ JVM_GetHostByName(char* name) {
     return 0;
 }
 
+#elif os_SOLARIS || os_LINUX || os_DARWIN
+
+/*
+ * The results of JVM_GetHostByName() and JVM_GetHostByAddr() are kept in a buffer per thread, so they are
+ * valid until the next call in the same thread instead of until the next call in any thread.
+ */
+typedef struct {
+    struct hostent hostent;
+    char *aliases[1];
+    char *addressList[RESOLVER_MAX_ADDRESSES + 1];
+    Unsigned4 addresses[RESOLVER_MAX_ADDRESSES];
+    unsigned char address[16];
+    char name[NI_MAXHOST];
+} HostBufferStruct, *HostBuffer;
+
+static pthread_key_t hostBufferKey;
+static pthread_once_t hostBufferKeyOnce = PTHREAD_ONCE_INIT;
+
+static void createHostBufferKey(void) {
+    if (pthread_key_create(&hostBufferKey, free) != 0) {
+        log_exit(11, "Could not create host buffer key");
+    }
+}
+
+static HostBuffer hostBuffer(void) {
+    pthread_once(&hostBufferKeyOnce, createHostBufferKey);
+    HostBuffer buffer = (HostBuffer) pthread_getspecific(hostBufferKey);
+    if (buffer == NULL) {
+        buffer = (HostBuffer) malloc(sizeof(HostBufferStruct));
+        if (buffer == NULL || pthread_setspecific(hostBufferKey, buffer) != 0) {
+            free(buffer);
+            return NULL;
+        }
+    }
+    memset(buffer, 0, sizeof(HostBufferStruct));
+    buffer->hostent.h_name = buffer->name;
+    buffer->hostent.h_aliases = buffer->aliases;
+    buffer->hostent.h_addr_list = buffer->addressList;
+    return buffer;
+}
+
+struct protoent *
+JVM_GetProtoByName(char* name) {
+    return getprotobyname(name);
+}
+
+/*
+ * Looks up the name of a host address through the caching resolver (see resolver.h).
+ */
+struct hostent*
+JVM_GetHostByAddr(const char* name, int len, int type) {
+    HostBuffer buffer = hostBuffer();
+    if (buffer == NULL || len > (int) sizeof(buffer->address)) {
+        return NULL;
+    }
+    if (!resolver_lookupAddress(name, len, type, buffer->name, sizeof(buffer->name))) {
+        h_errno = HOST_NOT_FOUND;
+        return NULL;
+    }
+    memcpy(buffer->address, name, len);
+    buffer->addressList[0] = (char *) buffer->address;
+    buffer->hostent.h_addrtype = type;
+    buffer->hostent.h_length = len;
+    return &buffer->hostent;
+}
+
+/*
+ * Looks up the IPv4 addresses of a host name through the caching resolver (see resolver.h).
+ */
+struct hostent*
+JVM_GetHostByName(char* name) {
+    HostBuffer buffer = hostBuffer();
+    if (buffer == NULL) {
+        return NULL;
+    }
+    int count = resolver_lookupName(name, buffer->addresses, buffer->name, sizeof(buffer->name));
+    if (count == 0) {
+        h_errno = HOST_NOT_FOUND;
+        return NULL;
+    }
+    int i;
+    for (i = 0; i < count; i++) {
+        buffer->addressList[i] = (char *) &buffer->addresses[i];
+    }
+    buffer->hostent.h_addrtype = AF_INET;
+    buffer->hostent.h_length = sizeof(Unsigned4);
+    return &buffer->hostent;
+}
+
 #endif /* _WINDOWS */
 
 int
@@ -2296,7 +2720,7 @@ jio_vfprintf(FILE *file, const char *fmt, va_list args) {
 }
 
 void *JVM_RawMonitorCreate(void) {
-    Mutex mutex = (Mutex) calloc(sizeof(*mutex), 1);
+    Mutex mutex = (Mutex) memory_allocate(sizeof(*mutex));
     mutex_initialize(mutex);
     return mutex;
 }
@@ -2304,7 +2728,7 @@ void *JVM_RawMonitorCreate(void) {
 
 void JVM_RawMonitorDestroy(void *monitor) {
     mutex_dispose((Mutex) monitor);
-    free(monitor);
+    memory_deallocate((Address) monitor);
 }
 
 jint JVM_RawMonitorEnter(void *monitor) {
@@ -2399,8 +2823,7 @@ JVM_GetThreadStateNames(JNIEnv* env, jint javaThreadState, jintArray values) {
  */
 jboolean
 JVM_KnownToNotExist(JNIEnv *env, jobject loader, const char *classname) {
-    UNIMPLEMENTED_WITH_ENV();
-    return 0;
+    return lookupCache_knownToNotExist(env, loader, classname);
 }
 
 /*
@@ -2409,8 +2832,7 @@ JVM_KnownToNotExist(JNIEnv *env, jobject loader, const char *classname) {
  */
 jobjectArray
 JVM_GetResourceLookupCacheURLs(JNIEnv *env, jobject loader) {
-    UNIMPLEMENTED_WITH_ENV();
-    return 0;
+    return lookupCache_urls(env, loader);
 }
 
 /*
@@ -2422,8 +2844,7 @@ JVM_GetResourceLookupCacheURLs(JNIEnv *env, jobject loader) {
  */
 jintArray
 JVM_GetResourceLookupCache(JNIEnv *env, jobject loader, const char *resource_name) {
-    UNIMPLEMENTED_WITH_ENV();
-    return 0;
+    return lookupCache_lookup(env, loader, resource_name);
 }
 
 /* =========================================================================
@@ -19,7 +19,9 @@
  * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <stdarg.h>
 #include <stdlib.h>
+#include <string.h>
 #include <jvmti.h>
 #include <jni.h>
 #include "vm.h"
@@ -40,6 +42,43 @@ typedef jint (JNICALL *Agent_OnUnLoad_t)(JavaVM *);
 typedef void (JNICALL *GarbageCollectionCallback) (jvmtiEnv *jvmti_env);
 typedef void (JNICALL *jvmtiStartFunctionNoArg) (jvmtiEnv* jvmti_env, JNIEnv* jni_env);
 typedef void (JNICALL *ThreadObjectCall) (jvmtiEnv *jvmti_env, JNIEnv* jni_env, jthread thread, jclass klass);
+/* The SampledObjectAlloc callback, which is not in the jvmti.h of JDK 8. */
+typedef void (JNICALL *SampledObjectAllocCallback) (jvmtiEnv *jvmti_env, JNIEnv* jni_env, jthread thread, jobject object, jclass object_klass, jlong size);
+
+/* The number of entries in the callbacks table of an environment, up to and including the SampledObjectAlloc event (86). */
+#define CALLBACK_COUNT (86 - JVMTI_MIN_EVENT_TYPE_VAL + 1)
+
+/*
+ * The filters of field watch events, which can be combined. An event is only delivered to the agent
+ * if it passes all the filters configured for its environment.
+ */
+/* Only the events on a given object (no static field events). */
+#define FIELD_WATCH_FILTER_OBJECT 1
+/* Only the events in a given thread. */
+#define FIELD_WATCH_FILTER_THREAD 2
+/* Only the modifications that change the value of the field (access events are not affected). */
+#define FIELD_WATCH_FILTER_VALUE_CHANGE 4
+
+#define FIELD_WATCH_FILTER_ALL (FIELD_WATCH_FILTER_OBJECT | FIELD_WATCH_FILTER_THREAD | FIELD_WATCH_FILTER_VALUE_CHANGE)
+
+/* The filter of the field watch events of an environment, which is not changed once published. */
+typedef struct FieldWatchFilterStruct {
+    jint filters;
+    /* Global references to the object and the thread, if filtered on. */
+    jobject object;
+    jthread thread;
+    /* The next filter in the list of the replaced filters of the environment. */
+    struct FieldWatchFilterStruct *next;
+} FieldWatchFilterStruct, *FieldWatchFilter;
+
+/* Must be kept in sync with JVMTIEnvNativeStruct.java. */
+typedef struct {
+    const struct jvmtiInterface_1_ *functions;
+    jvmtiEventCallbacks *callbacks;
+    jvmtiCapabilities *capabilities;
+    FieldWatchFilter fieldWatchFilter;
+    FieldWatchFilter replacedFieldWatchFilters;
+} JVMTIEnvImplStruct, *JVMTIEnvImpl;
 
 
 JNIEXPORT jint JNICALL
@@ -82,6 +121,143 @@ Java_com_oracle_max_vm_ext_jvmti_JVMTICallbacks_invokeClassfileLoadHookCallback(
     (*callback)(jvmti_env, env, klass, loader, name, protection_domain, class_data_len, class_data, new_class_data_len, new_class_data);
 }
 
+/*
+ * Determines if a field modification changes the value of the field, whose current value is read with JNI.
+ */
+static jboolean changesValue(JNIEnv *env, jclass field_class, jobject object, jfieldID field, char signature_type, jvalue new_value) {
+#define CURRENT_VALUE(Type) (object == NULL ? (*env)->GetStatic##Type##Field(env, field_class, field) : (*env)->Get##Type##Field(env, object, field))
+    jvalue current;
+    switch (signature_type) {
+        case 'Z':
+            return CURRENT_VALUE(Boolean) != new_value.z;
+        case 'B':
+            return CURRENT_VALUE(Byte) != new_value.b;
+        case 'C':
+            return CURRENT_VALUE(Char) != new_value.c;
+        case 'S':
+            return CURRENT_VALUE(Short) != new_value.s;
+        case 'I':
+            return CURRENT_VALUE(Int) != new_value.i;
+        case 'J':
+            return CURRENT_VALUE(Long) != new_value.j;
+        case 'F':
+            /* Compare the bits, so that storing a NaN over itself is not a change. */
+            current.i = 0;
+            current.f = CURRENT_VALUE(Float);
+            return current.i != new_value.i;
+        case 'D':
+            current.d = CURRENT_VALUE(Double);
+            return current.j != new_value.j;
+        case 'L':
+        case '[': {
+            jobject value = CURRENT_VALUE(Object);
+            jboolean changes = !(*env)->IsSameObject(env, value, new_value.l);
+            (*env)->DeleteLocalRef(env, value);
+            return changes;
+        }
+        default:
+            return JNI_TRUE;
+    }
+#undef CURRENT_VALUE
+}
+
+static jboolean passesFieldWatchFilter(JNIEnv *env, FieldWatchFilter filter, jthread thread, jclass field_class,
+                jobject object, jfieldID field, char signature_type, jvalue new_value) {
+    if ((filter->filters & FIELD_WATCH_FILTER_OBJECT) != 0 && (object == NULL || !(*env)->IsSameObject(env, object, filter->object))) {
+        return JNI_FALSE;
+    }
+    if ((filter->filters & FIELD_WATCH_FILTER_THREAD) != 0 && !(*env)->IsSameObject(env, thread, filter->thread)) {
+        return JNI_FALSE;
+    }
+    if ((filter->filters & FIELD_WATCH_FILTER_VALUE_CHANGE) != 0 && signature_type != 0 && !changesValue(env, field_class, object, field, signature_type, new_value)) {
+        return JNI_FALSE;
+    }
+    return JNI_TRUE;
+}
+
+/*
+ * The SetFieldWatchFilter extension function: jvmtiError SetFieldWatchFilter(jvmtiEnv *env, jint filters, jobject object, jthread thread).
+ * Replaces the field watch filter of an environment, 'filters' being a combination of the FIELD_WATCH_FILTER_* values
+ * or 0 to deliver all the field watch events again.
+ */
+static jvmtiError JNICALL setFieldWatchFilter(jvmtiEnv *jvmti_env, ...) {
+    JVMTIEnvImpl impl = (JVMTIEnvImpl) jvmti_env;
+    JavaVM *vm = (JavaVM *) &main_vm;
+    JNIEnv *env;
+    FieldWatchFilter filter = NULL;
+    va_list args;
+    jint filters;
+    jobject object;
+    jthread thread;
+
+    va_start(args, jvmti_env);
+    filters = va_arg(args, jint);
+    object = va_arg(args, jobject);
+    thread = va_arg(args, jthread);
+    va_end(args);
+
+    if ((filters & ~FIELD_WATCH_FILTER_ALL) != 0 ||
+        ((filters & FIELD_WATCH_FILTER_OBJECT) != 0 && object == NULL) ||
+        ((filters & FIELD_WATCH_FILTER_THREAD) != 0 && thread == NULL)) {
+        return JVMTI_ERROR_ILLEGAL_ARGUMENT;
+    }
+    if ((*vm)->GetEnv(vm, (void **) &env, JNI_VERSION_1_2) != JNI_OK) {
+        return JVMTI_ERROR_UNATTACHED_THREAD;
+    }
+    if (filters != 0) {
+        filter = (FieldWatchFilter) malloc(sizeof(FieldWatchFilterStruct));
+        if (filter == NULL) {
+            return JVMTI_ERROR_OUT_OF_MEMORY;
+        }
+        filter->filters = filters;
+        filter->object = (filters & FIELD_WATCH_FILTER_OBJECT) != 0 ? (*env)->NewGlobalRef(env, object) : NULL;
+        filter->thread = (filters & FIELD_WATCH_FILTER_THREAD) != 0 ? (*env)->NewGlobalRef(env, thread) : NULL;
+        filter->next = NULL;
+    }
+    __sync_synchronize();
+    FieldWatchFilter replaced = __sync_lock_test_and_set(&impl->fieldWatchFilter, filter);
+    if (replaced != NULL) {
+        /*
+         * Events may still be being filtered with the replaced filter in other threads, so it is only
+         * released (by disposeFieldWatchFilters) when the environment is disposed.
+         */
+        FieldWatchFilter head;
+        do {
+            head = impl->replacedFieldWatchFilters;
+            replaced->next = head;
+        } while (!__sync_bool_compare_and_swap(&impl->replacedFieldWatchFilters, head, replaced));
+    }
+    return JVMTI_ERROR_NONE;
+}
+
+static void freeFieldWatchFilter(JNIEnv *env, FieldWatchFilter filter) {
+    if (filter->object != NULL) {
+        (*env)->DeleteGlobalRef(env, filter->object);
+    }
+    if (filter->thread != NULL) {
+        (*env)->DeleteGlobalRef(env, filter->thread);
+    }
+    free(filter);
+}
+
+/*
+ * Releases the field watch filters of an environment that is being disposed.
+ */
+JNIEXPORT void JNICALL
+Java_com_oracle_max_vm_ext_jvmti_JVMTICallbacks_disposeFieldWatchFilters(JNIEnv *env, jclass c, jvmtiEnv *jvmti_env) {
+    JVMTIEnvImpl impl = (JVMTIEnvImpl) jvmti_env;
+    FieldWatchFilter filter = __sync_lock_test_and_set(&impl->fieldWatchFilter, NULL);
+    if (filter != NULL) {
+        freeFieldWatchFilter(env, filter);
+    }
+    filter = __sync_lock_test_and_set(&impl->replacedFieldWatchFilters, NULL);
+    while (filter != NULL) {
+        FieldWatchFilter next = filter->next;
+        freeFieldWatchFilter(env, filter);
+        filter = next;
+    }
+}
+
 JNIEXPORT void JNICALL
 Java_com_oracle_max_vm_ext_jvmti_JVMTICallbacks_invokeFieldWatchCallback(JNIEnv *env, jclass c, void *callback,
                 jvmtiEnv *jvmti_env,
@@ -89,6 +265,10 @@ Java_com_oracle_max_vm_ext_jvmti_JVMTICallbacks_invokeFieldWatchCallback(JNIEnv
                 jobject object, jfieldID field,
                 char signature_type,
                 jvalue new_value) {
+    FieldWatchFilter filter = ((JVMTIEnvImpl) jvmti_env)->fieldWatchFilter;
+    if (filter != NULL && !passesFieldWatchFilter(env, filter, thread, field_class, object, field, signature_type, new_value)) {
+        return;
+    }
     if (signature_type == 0) {
         jvmtiEventFieldAccess a_callback = (jvmtiEventFieldAccess) callback;
         (*a_callback)(jvmti_env, env, thread, method, location, field_class, object, field);
@@ -98,12 +278,94 @@ Java_com_oracle_max_vm_ext_jvmti_JVMTICallbacks_invokeFieldWatchCallback(JNIEnv
     }
 }
 
+static char *copyString(jvmtiEnv *jvmti_env, const char *string) {
+    unsigned char *copy;
+    if ((*jvmti_env)->Allocate(jvmti_env, strlen(string) + 1, &copy) != JVMTI_ERROR_NONE) {
+        return NULL;
+    }
+    strcpy((char *) copy, string);
+    return (char *) copy;
+}
+
+/*
+ * Implements GetExtensionFunctions. The returned arrays and strings are allocated with Allocate,
+ * so that the agent can release them with Deallocate.
+ */
+JNIEXPORT jint JNICALL
+Java_com_oracle_max_vm_ext_jvmti_JVMTICallbacks_getExtensionFunctions(JNIEnv *env, jclass c, jvmtiEnv *jvmti_env,
+                jint *extension_count_ptr, jvmtiExtensionFunctionInfo **extensions) {
+    static const char *paramNames[] = {"filters", "object", "thread"};
+    static const jvmtiParamTypes paramTypes[] = {JVMTI_TYPE_JINT, JVMTI_TYPE_JOBJECT, JVMTI_TYPE_JTHREAD};
+    static const jvmtiError errors[] = {JVMTI_ERROR_ILLEGAL_ARGUMENT, JVMTI_ERROR_UNATTACHED_THREAD, JVMTI_ERROR_OUT_OF_MEMORY};
+    const jint paramCount = sizeof(paramNames) / sizeof(paramNames[0]);
+    const jint errorCount = sizeof(errors) / sizeof(errors[0]);
+    jvmtiExtensionFunctionInfo *info;
+    jint i;
+
+    if (extension_count_ptr == NULL || extensions == NULL) {
+        return JVMTI_ERROR_NULL_POINTER;
+    }
+    if ((*jvmti_env)->Allocate(jvmti_env, sizeof(jvmtiExtensionFunctionInfo), (unsigned char **) &info) != JVMTI_ERROR_NONE) {
+        return JVMTI_ERROR_OUT_OF_MEMORY;
+    }
+    info->func = (jvmtiExtensionFunction) setFieldWatchFilter;
+    info->id = copyString(jvmti_env, "com.oracle.max.vm.ext.jvmti.SetFieldWatchFilter");
+    info->short_description = copyString(jvmti_env,
+        "Filters the field watch events before they are delivered: filters is a combination of 1 (only the events on object), "
+        "2 (only the events in thread) and 4 (only the modifications that change the value), or 0 to deliver all the events. "
+        "Replaced filters are only released when the environment is disposed");
+    info->param_count = paramCount;
+    info->error_count = errorCount;
+    if ((*jvmti_env)->Allocate(jvmti_env, paramCount * sizeof(jvmtiParamInfo), (unsigned char **) &info->params) != JVMTI_ERROR_NONE ||
+        (*jvmti_env)->Allocate(jvmti_env, errorCount * sizeof(jvmtiError), (unsigned char **) &info->errors) != JVMTI_ERROR_NONE) {
+        return JVMTI_ERROR_OUT_OF_MEMORY;
+    }
+    for (i = 0; i < paramCount; i++) {
+        info->params[i].name = copyString(jvmti_env, paramNames[i]);
+        info->params[i].kind = JVMTI_KIND_IN;
+        info->params[i].base_type = paramTypes[i];
+        info->params[i].null_ok = i != 0;
+    }
+    for (i = 0; i < errorCount; i++) {
+        info->errors[i] = errors[i];
+    }
+    *extension_count_ptr = 1;
+    *extensions = info;
+    return JVMTI_ERROR_NONE;
+}
+
 JNIEXPORT jint JNICALL
 Java_com_oracle_max_vm_ext_jvmti_JVMTICallbacks_invokeHeapIterationCallback(JNIEnv *env, jclass c, jvmtiHeapIterationCallback callback,
                 long class_tag, jlong size, jlong* tag_ptr, jint length, void* user_data) {
     return (*callback)(class_tag, size, tag_ptr, length, user_data);
 }
 
+/*
+ * An object in a batch given to invokeHeapIterationCallbacks. The layout must be kept in sync
+ * with JVMTIHeapFunctions.HEAP_ITERATION_ENTRY_SIZE and the offsets used by JVMTIHeapFunctions.CBCVNative.
+ */
+typedef struct {
+    jlong tag;
+    jlong class_tag;
+    jlong size;
+    jint length;
+    jint padding;
+} HeapIterationEntryStruct;
+
+JNIEXPORT jint JNICALL
+Java_com_oracle_max_vm_ext_jvmti_JVMTICallbacks_invokeHeapIterationCallbacks(JNIEnv *env, jclass c, jvmtiHeapIterationCallback callback,
+                HeapIterationEntryStruct *entries, jint count, void* user_data) {
+    jint i;
+    for (i = 0; i < count; i++) {
+        HeapIterationEntryStruct *entry = &entries[i];
+        jint flags = (*callback)(entry->class_tag, entry->size, &entry->tag, entry->length, user_data);
+        if ((flags & JVMTI_VISIT_ABORT) != 0) {
+            return -(i + 1);
+        }
+    }
+    return count;
+}
+
 JNIEXPORT void JNICALL
 Java_com_oracle_max_vm_ext_jvmti_JVMTICallbacks_invokeBreakpointCallback(JNIEnv *env, jclass c, jvmtiEventBreakpoint callback,
                 jvmtiEnv *jvmti_env, jthread thread,
@@ -148,6 +410,12 @@ Java_com_oracle_max_vm_ext_jvmti_JVMTICallbacks_invokeCompiledMethodUnloadCallba
 
 }
 
+JNIEXPORT void JNICALL
+Java_com_oracle_max_vm_ext_jvmti_JVMTICallbacks_invokeSampledObjectAllocCallback(JNIEnv *env, jclass c, SampledObjectAllocCallback callback,
+                jvmtiEnv *jvmti_env, jthread thread, jobject object, jclass klass, jlong size) {
+    (*callback)(jvmti_env, env, thread, object, klass, size);
+}
+
 void setJVMTIThreadInfo(jvmtiThreadInfo *threadInfo, char *name, jint priority, jboolean is_daemon,
                 jobject thread_group, jobject context_class_loader) {
     threadInfo->name = name;
@@ -367,12 +635,6 @@ struct jvmtiInterface_1_ jvmti_interface = {
 };
 
 
-typedef struct {
-    const struct jvmtiInterface_1_ *functions;
-    jvmtiEventCallbacks *callbacks;
-    jvmtiCapabilities *capabilities;
-} JVMTIEnvImplStruct, *JVMTIEnvImpl;
-
 void *getJVMTIInterface(int version) {
     if (version == -1 || version == JVMTI_VERSION) {
         return (void*) &jvmti_interface;
@@ -384,10 +646,12 @@ void *getJVMTIImpl(JNIEnv *env, int version) {
     JVMTIEnvImplStruct *jvmtienv_impl = malloc(sizeof(JVMTIEnvImplStruct));
     if (jvmtienv_impl == NULL) return NULL;
     jvmtienv_impl->functions = &jvmti_interface;
-    jvmtienv_impl->callbacks = malloc(sizeof(jvmtiEventCallbacks));
+    jvmtienv_impl->callbacks = calloc(1, CALLBACK_COUNT * sizeof(void *) > sizeof(jvmtiEventCallbacks) ? CALLBACK_COUNT * sizeof(void *) : sizeof(jvmtiEventCallbacks));
     if (jvmtienv_impl->callbacks == NULL) return NULL;
     jvmtienv_impl->capabilities = malloc(sizeof(jvmtiCapabilities));
     if (jvmtienv_impl->capabilities == NULL) return NULL;
+    jvmtienv_impl->fieldWatchFilter = NULL;
+    jvmtienv_impl->replacedFieldWatchFilters = NULL;
     JVMTIEnvImpl jvmti = (JVMTIEnvImpl) jvmtienv_impl;
     getVMInterface()->SetJVMTIEnv(env, jvmti);
     return (void *)jvmti;
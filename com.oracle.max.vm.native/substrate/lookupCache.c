@@ -0,0 +1,656 @@
+/*
+ * Copyright (c) 2011, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include "os.h"
+#include "log.h"
+#include "mutex.h"
+#include "word.h"
+#include "lookupCache.h"
+
+#if os_SOLARIS || os_LINUX || os_DARWIN
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define ZIP_END_SIGNATURE           0x06054b50
+#define ZIP_END_SIZE                22
+#define ZIP64_END_LOCATOR_SIGNATURE 0x07064b50
+#define ZIP64_END_LOCATOR_SIZE      20
+#define ZIP64_END_SIGNATURE         0x06064b50
+#define ZIP_CENTRAL_SIGNATURE       0x02014b50
+#define ZIP_CENTRAL_SIZE            46
+#define ZIP_MAX_COMMENT             0xFFFF
+
+typedef struct {
+    Unsigned4 hash;
+    Unsigned4 nameOffset;
+    Unsigned4 nameLength;
+    /* The first jar containing the entry, -1 for an empty slot. */
+    jint firstJar;
+    /* The postings of the other jars containing the entry, in class path order. */
+    jint moreHead;
+    jint moreTail;
+} EntryStruct, *Entry;
+
+typedef struct {
+    jint jar;
+    jint next;
+} PostingStruct, *Posting;
+
+typedef struct LookupCacheStruct {
+    /* A weak reference to the loader. */
+    jobject loader;
+    /* A global reference to the URL[] returned by lookupCache_urls(). */
+    jobjectArray urls;
+    jint urlsLength;
+
+    /* The class path entries that could not be indexed. */
+    jint *unindexed;
+    jint unindexedLength;
+
+    Entry table;
+    Unsigned4 tableCapacity;
+    Unsigned4 tableCount;
+
+    char *names;
+    Size namesLength;
+    Size namesCapacity;
+
+    Posting postings;
+    jint postingsLength;
+    jint postingsCapacity;
+
+    struct LookupCacheStruct *next;
+} LookupCacheStruct, *LookupCache;
+
+static pthread_once_t theInitializeOnce = PTHREAD_ONCE_INIT;
+static mutex_Struct theLock;
+static LookupCache theCaches;
+
+static Unsigned4 hashName(const char *name, Size length) {
+    Unsigned4 hash = 2166136261u;
+    Size i;
+    for (i = 0; i < length; i++) {
+        hash = (hash ^ (Unsigned1) name[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static Entry findEntry(LookupCache cache, const char *name, Size length, Unsigned4 hash) {
+    Unsigned4 mask = cache->tableCapacity - 1;
+    Unsigned4 i = hash & mask;
+    for (;;) {
+        Entry entry = &cache->table[i];
+        if (entry->firstJar < 0) {
+            return entry;
+        }
+        if (entry->hash == hash && entry->nameLength == length && memcmp(cache->names + entry->nameOffset, name, length) == 0) {
+            return entry;
+        }
+        i = (i + 1) & mask;
+    }
+}
+
+static jboolean growTable(LookupCache cache) {
+    Unsigned4 capacity = cache->tableCapacity == 0 ? 4096 : cache->tableCapacity * 2;
+    Entry table = (Entry) malloc(capacity * sizeof(EntryStruct));
+    if (table == NULL) {
+        return false;
+    }
+    Unsigned4 i;
+    for (i = 0; i < capacity; i++) {
+        table[i].firstJar = -1;
+    }
+    Entry oldTable = cache->table;
+    Unsigned4 oldCapacity = cache->tableCapacity;
+    cache->table = table;
+    cache->tableCapacity = capacity;
+    for (i = 0; i < oldCapacity; i++) {
+        Entry old = &oldTable[i];
+        if (old->firstJar >= 0) {
+            *findEntry(cache, cache->names + old->nameOffset, old->nameLength, old->hash) = *old;
+        }
+    }
+    free(oldTable);
+    return true;
+}
+
+static jboolean addPosting(LookupCache cache, Entry entry, jint jar) {
+    if (cache->postingsLength == cache->postingsCapacity) {
+        jint capacity = cache->postingsCapacity == 0 ? 1024 : cache->postingsCapacity * 2;
+        Posting postings = (Posting) realloc(cache->postings, capacity * sizeof(PostingStruct));
+        if (postings == NULL) {
+            return false;
+        }
+        cache->postings = postings;
+        cache->postingsCapacity = capacity;
+    }
+    jint index = cache->postingsLength++;
+    cache->postings[index].jar = jar;
+    cache->postings[index].next = -1;
+    if (entry->moreTail < 0) {
+        entry->moreHead = index;
+    } else {
+        cache->postings[entry->moreTail].next = index;
+    }
+    entry->moreTail = index;
+    return true;
+}
+
+static jboolean addName(LookupCache cache, const char *name, Size length, jint jar) {
+    if ((cache->tableCount + 1) * 2 > cache->tableCapacity && !growTable(cache)) {
+        return false;
+    }
+    Unsigned4 hash = hashName(name, length);
+    Entry entry = findEntry(cache, name, length, hash);
+    if (entry->firstJar >= 0) {
+        jint last = entry->moreTail < 0 ? entry->firstJar : cache->postings[entry->moreTail].jar;
+        /* The jars are indexed in class path order, so a repeated name in the same jar is the last one added. */
+        return last == jar || addPosting(cache, entry, jar);
+    }
+    if (cache->namesLength + length > cache->namesCapacity) {
+        Size capacity = cache->namesCapacity == 0 ? 64 * 1024 : cache->namesCapacity;
+        while (cache->namesLength + length > capacity) {
+            capacity *= 2;
+        }
+        char *names = (char *) realloc(cache->names, capacity);
+        if (names == NULL) {
+            return false;
+        }
+        cache->names = names;
+        cache->namesCapacity = capacity;
+    }
+    memcpy(cache->names + cache->namesLength, name, length);
+    entry->hash = hash;
+    entry->nameOffset = (Unsigned4) cache->namesLength;
+    entry->nameLength = (Unsigned4) length;
+    entry->firstJar = jar;
+    entry->moreHead = -1;
+    entry->moreTail = -1;
+    cache->namesLength += length;
+    cache->tableCount++;
+    return true;
+}
+
+static Unsigned2 get2(const Unsigned1 *p) {
+    return (Unsigned2) (p[0] | (p[1] << 8));
+}
+
+static Unsigned4 get4(const Unsigned1 *p) {
+    return (Unsigned4) p[0] | ((Unsigned4) p[1] << 8) | ((Unsigned4) p[2] << 16) | ((Unsigned4) p[3] << 24);
+}
+
+static Unsigned8 get8(const Unsigned1 *p) {
+    return (Unsigned8) get4(p) | ((Unsigned8) get4(p + 4) << 32);
+}
+
+/*
+ * Adds the names in the central directory of a zip file to the cache.
+ *
+ * @return false if the file is not a zip file that could be read
+ */
+static jboolean indexJar(LookupCache cache, const char *path, jint jar) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat status;
+    if (fstat(fd, &status) != 0 || !S_ISREG(status.st_mode) || status.st_size < ZIP_END_SIZE) {
+        close(fd);
+        return false;
+    }
+    Size size = (Size) status.st_size;
+    void *mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        return false;
+    }
+    const Unsigned1 *zip = (const Unsigned1 *) mapping;
+    jboolean result = false;
+
+    /* The end record is followed by a comment of at most 64K. */
+    const Unsigned1 *end = NULL;
+    const Unsigned1 *p = zip + size - ZIP_END_SIZE;
+    const Unsigned1 *limit = size > ZIP_END_SIZE + ZIP_MAX_COMMENT ? zip + size - ZIP_END_SIZE - ZIP_MAX_COMMENT : zip;
+    for (; p >= limit; p--) {
+        if (get4(p) == ZIP_END_SIGNATURE) {
+            end = p;
+            break;
+        }
+    }
+    if (end != NULL) {
+        Unsigned8 entries = get2(end + 10);
+        Unsigned8 centralSize = get4(end + 12);
+        Unsigned8 centralOffset = get4(end + 16);
+        if ((entries == 0xFFFF || centralSize == 0xFFFFFFFF || centralOffset == 0xFFFFFFFF) && end - zip >= ZIP64_END_LOCATOR_SIZE) {
+            const Unsigned1 *locator = end - ZIP64_END_LOCATOR_SIZE;
+            if (get4(locator) == ZIP64_END_LOCATOR_SIGNATURE) {
+                Unsigned8 end64Offset = get8(locator + 8);
+                if (end64Offset + 56 <= size && get4(zip + end64Offset) == ZIP64_END_SIGNATURE) {
+                    const Unsigned1 *end64 = zip + end64Offset;
+                    entries = get8(end64 + 32);
+                    centralSize = get8(end64 + 40);
+                    centralOffset = get8(end64 + 48);
+                }
+            }
+        }
+        if (centralOffset + centralSize <= size) {
+            const Unsigned1 *central = zip + centralOffset;
+            const Unsigned1 *centralEnd = central + centralSize;
+            Unsigned8 i;
+            result = true;
+            for (i = 0; i < entries; i++) {
+                if (central + ZIP_CENTRAL_SIZE > centralEnd || get4(central) != ZIP_CENTRAL_SIGNATURE) {
+                    result = false;
+                    break;
+                }
+                Unsigned2 nameLength = get2(central + 28);
+                Unsigned2 extraLength = get2(central + 30);
+                Unsigned2 commentLength = get2(central + 32);
+                const char *name = (const char *) central + ZIP_CENTRAL_SIZE;
+                if ((const Unsigned1 *) name + nameLength > centralEnd || !addName(cache, name, nameLength, jar)) {
+                    result = false;
+                    break;
+                }
+                central += ZIP_CENTRAL_SIZE + nameLength + extraLength + commentLength;
+            }
+        }
+    }
+    munmap(mapping, size);
+    return result;
+}
+
+static int hexValue(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+/*
+ * Decodes the %-escapes of a URL path in place.
+ */
+static void decodePath(char *path) {
+    char *in = path;
+    char *out = path;
+    while (*in != '\0') {
+        int high, low;
+        if (in[0] == '%' && (high = hexValue(in[1])) >= 0 && (low = hexValue(in[2])) >= 0) {
+            *out++ = (char) ((high << 4) | low);
+            in += 3;
+        } else {
+            *out++ = *in++;
+        }
+    }
+    *out = '\0';
+}
+
+/*
+ * Gets the path of a 'file:' URL naming a file (not a directory), or NULL.
+ */
+static char *jarPath(JNIEnv *env, jobject url, jmethodID getProtocol, jmethodID getPath) {
+    jstring protocol = (jstring) (*env)->CallObjectMethod(env, url, getProtocol);
+    if (protocol == NULL || (*env)->ExceptionCheck(env)) {
+        return NULL;
+    }
+    const char *protocolChars = (*env)->GetStringUTFChars(env, protocol, NULL);
+    jboolean isFile = protocolChars != NULL && strcmp(protocolChars, "file") == 0;
+    if (protocolChars != NULL) {
+        (*env)->ReleaseStringUTFChars(env, protocol, protocolChars);
+    }
+    (*env)->DeleteLocalRef(env, protocol);
+    if (!isFile) {
+        return NULL;
+    }
+    jstring path = (jstring) (*env)->CallObjectMethod(env, url, getPath);
+    if (path == NULL || (*env)->ExceptionCheck(env)) {
+        return NULL;
+    }
+    const char *pathChars = (*env)->GetStringUTFChars(env, path, NULL);
+    char *result = NULL;
+    if (pathChars != NULL) {
+        Size length = strlen(pathChars);
+        /* URLClassPath treats a URL ending with a '/' as a directory. */
+        if (length > 0 && pathChars[length - 1] != '/') {
+            result = strdup(pathChars);
+            decodePath(result);
+        }
+        (*env)->ReleaseStringUTFChars(env, path, pathChars);
+    }
+    (*env)->DeleteLocalRef(env, path);
+    return result;
+}
+
+static void freeCache(JNIEnv *env, LookupCache cache) {
+    if (cache->loader != NULL) {
+        (*env)->DeleteWeakGlobalRef(env, cache->loader);
+    }
+    if (cache->urls != NULL) {
+        (*env)->DeleteGlobalRef(env, cache->urls);
+    }
+    free(cache->unindexed);
+    free(cache->table);
+    free(cache->names);
+    free(cache->postings);
+    free(cache);
+}
+
+static LookupCache buildCache(JNIEnv *env, jobject loader) {
+    jclass urlClassLoaderClass = (*env)->FindClass(env, "java/net/URLClassLoader");
+    if (urlClassLoaderClass == NULL) {
+        (*env)->ExceptionClear(env);
+        return NULL;
+    }
+    if (!(*env)->IsInstanceOf(env, loader, urlClassLoaderClass)) {
+        return NULL;
+    }
+    jmethodID getURLs = (*env)->GetMethodID(env, urlClassLoaderClass, "getURLs", "()[Ljava/net/URL;");
+    jclass urlClass = (*env)->FindClass(env, "java/net/URL");
+    jmethodID getProtocol = urlClass == NULL ? NULL : (*env)->GetMethodID(env, urlClass, "getProtocol", "()Ljava/lang/String;");
+    jmethodID getPath = urlClass == NULL ? NULL : (*env)->GetMethodID(env, urlClass, "getPath", "()Ljava/lang/String;");
+    if (getURLs == NULL || getProtocol == NULL || getPath == NULL) {
+        (*env)->ExceptionClear(env);
+        return NULL;
+    }
+    jobjectArray urls = (jobjectArray) (*env)->CallObjectMethod(env, loader, getURLs);
+    if (urls == NULL || (*env)->ExceptionCheck(env)) {
+        (*env)->ExceptionClear(env);
+        return NULL;
+    }
+
+    LookupCache cache = (LookupCache) calloc(1, sizeof(LookupCacheStruct));
+    if (cache == NULL) {
+        return NULL;
+    }
+    cache->urlsLength = (*env)->GetArrayLength(env, urls);
+    cache->unindexed = (jint *) malloc((cache->urlsLength + 1) * sizeof(jint));
+    if (cache->unindexed == NULL || !growTable(cache)) {
+        freeCache(env, cache);
+        return NULL;
+    }
+    jint i;
+    for (i = 0; i < cache->urlsLength; i++) {
+        jobject url = (*env)->GetObjectArrayElement(env, urls, i);
+        char *path = url == NULL ? NULL : jarPath(env, url, getProtocol, getPath);
+        if ((*env)->ExceptionCheck(env)) {
+            (*env)->ExceptionClear(env);
+        }
+        struct stat status;
+        if (path != NULL && stat(path, &status) != 0) {
+            /* A missing jar contains nothing. */
+        } else if (path == NULL || !indexJar(cache, path, i)) {
+            cache->unindexed[cache->unindexedLength++] = i;
+        }
+        free(path);
+        if (url != NULL) {
+            (*env)->DeleteLocalRef(env, url);
+        }
+    }
+    cache->loader = (*env)->NewWeakGlobalRef(env, loader);
+    cache->urls = (jobjectArray) (*env)->NewGlobalRef(env, urls);
+#if log_LOADER
+    log_println("lookupCache: indexed %u names of %d class path entries (%d not indexed)", cache->tableCount, cache->urlsLength, cache->unindexedLength);
+#endif
+    return cache;
+}
+
+static void initialize(void) {
+    mutex_initialize(&theLock);
+}
+
+/*
+ * Gets the cache of a loader, building it if necessary.
+ */
+static LookupCache getCache(JNIEnv *env, jobject loader, jboolean create) {
+    if (loader == NULL) {
+        return NULL;
+    }
+    pthread_once(&theInitializeOnce, initialize);
+    mutex_enter(&theLock);
+    LookupCache cache;
+    LookupCache *link = &theCaches;
+    while ((cache = *link) != NULL) {
+        if ((*env)->IsSameObject(env, cache->loader, NULL)) {
+            /* The loader has been collected. No thread can be using its cache as that needs a reference to the loader. */
+            *link = cache->next;
+            freeCache(env, cache);
+            continue;
+        }
+        if ((*env)->IsSameObject(env, cache->loader, loader)) {
+            break;
+        }
+        link = &cache->next;
+    }
+    mutex_exit(&theLock);
+    if (cache == NULL && create) {
+        /* The cache is built without holding the lock because building it calls Java code. */
+        LookupCache newCache = buildCache(env, loader);
+        if (newCache != NULL) {
+            mutex_enter(&theLock);
+            for (cache = theCaches; cache != NULL; cache = cache->next) {
+                if ((*env)->IsSameObject(env, cache->loader, loader)) {
+                    break;
+                }
+            }
+            if (cache == NULL) {
+                newCache->next = theCaches;
+                theCaches = newCache;
+                cache = newCache;
+                newCache = NULL;
+            }
+            mutex_exit(&theLock);
+            if (newCache != NULL) {
+                freeCache(env, newCache);
+            }
+        }
+    }
+    return cache;
+}
+
+/*
+ * Adds the jars containing a given name to a sorted set of indices.
+ */
+static void addJars(LookupCache cache, const char *name, Size length, jint *indices, jint *count) {
+    Entry entry = findEntry(cache, name, length, hashName(name, length));
+    if (entry->firstJar < 0) {
+        return;
+    }
+    jint jar = entry->firstJar;
+    jint posting = entry->moreHead;
+    for (;;) {
+        jint i = *count;
+        while (i > 0 && indices[i - 1] > jar) {
+            i--;
+        }
+        if (i == 0 || indices[i - 1] != jar) {
+            memmove(indices + i + 1, indices + i, (*count - i) * sizeof(jint));
+            indices[i] = jar;
+            (*count)++;
+        }
+        if (posting < 0) {
+            break;
+        }
+        jar = cache->postings[posting].jar;
+        posting = cache->postings[posting].next;
+    }
+}
+
+/*
+ * Computes the sorted indices of the URLs that may contain a given resource into an array of at least 'urlsLength' elements.
+ */
+static jint lookup(LookupCache cache, const char *name, jint *indices) {
+    jint count = cache->unindexedLength;
+    memcpy(indices, cache->unindexed, count * sizeof(jint));
+    Size length = strlen(name);
+    addJars(cache, name, length, indices, &count);
+    if (length > 0 && name[length - 1] != '/') {
+        /* ZipFile.getEntry() also finds a directory entry given its name without the trailing '/'. */
+        char *directory = (char *) malloc(length + 1);
+        if (directory != NULL) {
+            memcpy(directory, name, length);
+            directory[length] = '/';
+            addJars(cache, directory, length + 1, indices, &count);
+            free(directory);
+        }
+    }
+    return count;
+}
+
+jobjectArray lookupCache_urls(JNIEnv *env, jobject loader) {
+    LookupCache cache = getCache(env, loader, true);
+    if (cache == NULL) {
+        return NULL;
+    }
+    return (jobjectArray) (*env)->NewLocalRef(env, cache->urls);
+}
+
+jintArray lookupCache_lookup(JNIEnv *env, jobject loader, const char *resourceName) {
+    LookupCache cache = getCache(env, loader, false);
+    if (cache == NULL || resourceName == NULL) {
+        return NULL;
+    }
+    jint *indices = (jint *) malloc((cache->urlsLength + 1) * sizeof(jint));
+    if (indices == NULL) {
+        return NULL;
+    }
+    jint count = lookup(cache, resourceName, indices);
+    jintArray result = (*env)->NewIntArray(env, count);
+    if (result != NULL) {
+        (*env)->SetIntArrayRegion(env, result, 0, count, indices);
+    }
+    free(indices);
+    return result;
+}
+
+/*
+ * Determines if the jars of a given loader's cache do not contain a given class file.
+ */
+static jboolean notInCache(LookupCache cache, const char *resourceName, Size length) {
+    if (cache == NULL || cache->unindexedLength != 0) {
+        return false;
+    }
+    return findEntry(cache, resourceName, length, hashName(resourceName, length))->firstJar < 0;
+}
+
+/*
+ * Determines if the boot class loader can find a given class, which loads it if it exists as delegation would.
+ */
+static jboolean foundByBootLoader(JNIEnv *env, jobject loader, const char *className) {
+    jclass classLoaderClass = (*env)->FindClass(env, "java/lang/ClassLoader");
+    jmethodID findBootstrapClass = classLoaderClass == NULL ? NULL : (*env)->GetMethodID(env, classLoaderClass, "findBootstrapClass", "(Ljava/lang/String;)Ljava/lang/Class;");
+    jstring name = findBootstrapClass == NULL ? NULL : (*env)->NewStringUTF(env, className);
+    if (name == NULL) {
+        (*env)->ExceptionClear(env);
+        return true;
+    }
+    jobject c = (*env)->CallObjectMethod(env, loader, findBootstrapClass, name);
+    if ((*env)->ExceptionCheck(env)) {
+        /* A ClassNotFoundException means that the class does not exist, anything else is inconclusive. */
+        jthrowable exception = (*env)->ExceptionOccurred(env);
+        jclass cnfe = (*env)->FindClass(env, "java/lang/ClassNotFoundException");
+        (*env)->ExceptionClear(env);
+        return cnfe == NULL || !(*env)->IsInstanceOf(env, exception, cnfe);
+    }
+    return c != NULL;
+}
+
+/*
+ * A class is only known to not exist if none of the jars of the loader and of its ancestors contain it
+ * and the boot class loader cannot find it, as loadClass() throws ClassNotFoundException without delegating
+ * to the parent when this returns true.
+ */
+jboolean lookupCache_knownToNotExist(JNIEnv *env, jobject loader, const char *className) {
+    LookupCache cache = getCache(env, loader, false);
+    if (cache == NULL || className == NULL || cache->unindexedLength != 0) {
+        return false;
+    }
+    Size length = strlen(className);
+    char *resourceName = (char *) malloc(length + sizeof(".class"));
+    if (resourceName == NULL) {
+        return false;
+    }
+    Size i;
+    for (i = 0; i < length; i++) {
+        resourceName[i] = className[i] == '.' ? '/' : className[i];
+    }
+    strcpy(resourceName + length, ".class");
+    length += 6;
+
+    jboolean result = notInCache(cache, resourceName, length);
+    jclass classLoaderClass = (*env)->FindClass(env, "java/lang/ClassLoader");
+    jmethodID getParent = classLoaderClass == NULL ? NULL : (*env)->GetMethodID(env, classLoaderClass, "getParent", "()Ljava/lang/ClassLoader;");
+    if (getParent == NULL) {
+        (*env)->ExceptionClear(env);
+        result = false;
+    }
+    jobject ancestor = loader;
+    while (result) {
+        jobject parent = (*env)->CallObjectMethod(env, ancestor, getParent);
+        if ((*env)->ExceptionCheck(env)) {
+            (*env)->ExceptionClear(env);
+            result = false;
+            break;
+        }
+        if (ancestor != loader) {
+            (*env)->DeleteLocalRef(env, ancestor);
+        }
+        ancestor = parent;
+        if (parent == NULL) {
+            result = !foundByBootLoader(env, loader, className);
+            break;
+        }
+        /* A parent that is not a URLClassLoader (or whose class path cannot be indexed) may contain any class. */
+        result = notInCache(getCache(env, ancestor, true), resourceName, length);
+    }
+    if (ancestor != NULL && ancestor != loader) {
+        (*env)->DeleteLocalRef(env, ancestor);
+    }
+    free(resourceName);
+    return result;
+}
+
+#else
+
+jobjectArray lookupCache_urls(JNIEnv *env, jobject loader) {
+    return NULL;
+}
+
+jintArray lookupCache_lookup(JNIEnv *env, jobject loader, const char *resourceName) {
+    return NULL;
+}
+
+jboolean lookupCache_knownToNotExist(JNIEnv *env, jobject loader, const char *className) {
+    return false;
+}
+
+#endif
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2011, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ */
+#ifndef __lookupCache_h__
+#define __lookupCache_h__ 1
+
+#include "jni.h"
+
+/*
+ * The resource lookup cache used by sun.misc.URLClassPath (enabled by the
+ * 'sun.cds.enableSharedLookupCache' system property).
+ *
+ * The cache of a URLClassLoader is built the first time the loader asks for it: the central
+ * directories of the jar files on its class path are read into a hash table that maps each entry
+ * name to the indices of the jars containing it. A class path entry that cannot be indexed (a
+ * directory, a non-file URL or a file that is not a zip file) may contain any resource, so its
+ * index is included in every lookup. The cache of a loader that has been collected is freed the
+ * next time a cache is looked up.
+ */
+
+/**
+ * Returns the URLs that the indices returned by lookupCache_lookup() refer to, or NULL if no cache is
+ * available for the given loader.
+ */
+extern jobjectArray lookupCache_urls(JNIEnv *env, jobject loader);
+
+/**
+ * Returns the indices of the URLs that may contain a given resource, in class path order,
+ * or NULL if the loader has no cache.
+ */
+extern jintArray lookupCache_lookup(JNIEnv *env, jobject loader, const char *resourceName);
+
+/**
+ * Determines if the caches of a given loader and of its ancestors show that none of their URLs contain a given
+ * class, and the boot class loader cannot find it either.
+ *
+ * @param className a class name in the form given to ClassLoader.loadClass()
+ */
+extern jboolean lookupCache_knownToNotExist(JNIEnv *env, jobject loader, const char *className);
+
+#endif /*__lookupCache_h__*/
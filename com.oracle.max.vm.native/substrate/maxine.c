@@ -32,6 +32,7 @@
 #include <unistd.h>
 #include <alloca.h>
 #include <errno.h>
+#include <limits.h>
 #include <pwd.h>
 #include <time.h>
 #include <sys/param.h>
@@ -41,11 +42,23 @@
 #include "log.h"
 #include "isa.h"
 #include "image.h"
+#include "mutex.h"
 #include "threads.h"
 #include "os.h"
 #include "vm.h"
 #include "virtualMemory.h"
 #include "maxine.h"
+#include "startup.h"
+#include "sampler.h"
+#include "trace.h"
+#include "aio.h"
+#include "readiness.h"
+#include "resolver.h"
+#include "perfMap.h"
+#include "symbolIndex.h"
+#include "zygote.h"
+#include "javaArithmetic.h"
+#include "spinWait.h"
 #include <fenv.h>
 
 #if os_MAXVE
@@ -132,10 +145,82 @@ static void getImageFilePath(char *result) {
 #endif
 }
 
-static void loadImage(void) {
+static void loadImage(int relocationMode, int largePages, int pageProfile, int pageProfileSeconds, boolean mergeable) {
     char imageFilePath[MAX_PATH_LENGTH];
     getImageFilePath(imageFilePath);
-    image_load(imageFilePath);
+    image_load(imageFilePath, relocationMode, largePages, pageProfile, pageProfileSeconds, mergeable);
+}
+
+static int parseImageRelocationMode(const char *mode) {
+    if (strcmp(mode, "eager") == 0) {
+        return image_RELOCATION_EAGER;
+    } else if (strcmp(mode, "lazy") == 0) {
+        return image_RELOCATION_LAZY;
+    }
+    log_exit(1, "invalid value for -XX:ImageRelocation: %s (must be 'eager' or 'lazy')", mode);
+    return image_RELOCATION_EAGER;
+}
+
+static int parseImageLargePages(const char *pages) {
+    if (strcmp(pages, "none") == 0) {
+        return image_LARGE_PAGES_NONE;
+    } else if (strcmp(pages, "thp") == 0) {
+        return image_LARGE_PAGES_THP;
+    } else if (strcmp(pages, "2M") == 0) {
+        return image_LARGE_PAGES_2M;
+    } else if (strcmp(pages, "1G") == 0) {
+        return image_LARGE_PAGES_1G;
+    }
+    log_exit(1, "invalid value for -XX:ImageLargePages: %s (must be 'none', 'thp', '2M' or '1G')", pages);
+    return image_LARGE_PAGES_NONE;
+}
+
+/**
+ * Parses the value of the '-XX:ImagePageProfile=' option: 'none', 'prefetch', 'record' or 'record:<seconds>'.
+ */
+static int parseImagePageProfile(const char *profile, int *seconds) {
+    *seconds = image_PAGE_PROFILE_DEFAULT_SECONDS;
+    if (strcmp(profile, "none") == 0) {
+        return image_PAGE_PROFILE_NONE;
+    } else if (strcmp(profile, "prefetch") == 0) {
+        return image_PAGE_PROFILE_PREFETCH;
+    } else if (strcmp(profile, "record") == 0) {
+        return image_PAGE_PROFILE_RECORD;
+    } else if (strncmp(profile, "record:", 7) == 0) {
+        char *end;
+        long value = strtol(profile + 7, &end, 10);
+        if (*end == '\0' && end != profile + 7 && value > 0 && value <= INT_MAX) {
+            *seconds = (int) value;
+            return image_PAGE_PROFILE_RECORD;
+        }
+    }
+    log_exit(1, "invalid value for -XX:ImagePageProfile: %s (must be 'none', 'prefetch', 'record' or 'record:<seconds>')", profile);
+    return image_PAGE_PROFILE_NONE;
+}
+
+/**
+ * Parses the value of the '-XX:NUMAHeapPlacement=' option: 'firsttouch', 'interleave', 'local',
+ * 'bind:<node>' or 'preferred:<node>'.
+ */
+static int parseNUMAPlacement(const char *placement, int *node) {
+    *node = -1;
+    if (strcmp(placement, "firsttouch") == 0) {
+        return NUMA_POLICY_FIRST_TOUCH;
+    } else if (strcmp(placement, "interleave") == 0) {
+        return NUMA_POLICY_INTERLEAVE;
+    } else if (strcmp(placement, "local") == 0) {
+        return NUMA_POLICY_LOCAL;
+    } else if (strncmp(placement, "bind:", 5) == 0 || strncmp(placement, "preferred:", 10) == 0) {
+        const char *value = strchr(placement, ':') + 1;
+        char *end;
+        long n = strtol(value, &end, 10);
+        if (*end == '\0' && end != value && n >= 0 && n <= INT_MAX) {
+            *node = (int) n;
+            return placement[0] == 'b' ? NUMA_POLICY_BIND : NUMA_POLICY_PREFERRED;
+        }
+    }
+    log_exit(1, "invalid value for -XX:NUMAHeapPlacement: %s (must be 'firsttouch', 'interleave', 'local', 'bind:<node>' or 'preferred:<node>')", placement);
+    return NUMA_POLICY_FIRST_TOUCH;
 }
 
 static void *openLibrary(char *path) {
@@ -162,7 +247,11 @@ static void *openLibrary(char *path) {
 }
 
 static void* loadSymbol(void* handle, const char* symbol) {
+#if os_MAXVE
     void* result = dlsym(handle, symbol);
+#else
+    void* result = symbolIndex_lookup(handle, symbol);
+#endif
 #if log_LINKER
 #if os_MAXVE
     log_println("loadSymbol(%p, \"%s\") = %p", handle, symbol, result);
@@ -297,18 +386,91 @@ int maxine(int argc, char *argv[], char *executablePath) {
     VMRunMethod method;
     int exitCode = 0;
     int i;
-    /* Extract the '-XX:LogFile' argument and pass the rest through to MaxineVM.run(). */
+    /* Extract the '-XX:LogFile' and '-XX:Image*' loader arguments and pass the rest through to MaxineVM.run(). */
     const char *logFilePath = getenv("MAXINE_LOG_FILE");
+    const char *imageRelocationMode = "eager";
+    const char *imageLargePages = "none";
+    const char *imagePageProfile = "none";
+    int imagePageProfileSeconds;
+    boolean imageMergeable = false;
+    const char *numaHeapPlacement = "firsttouch";
+    int numaHeapNode;
+    const char *binaryTraceDirectory = NULL;
+    const char *zygotePath = NULL;
+    startup_mark(STARTUP_LAUNCH);
     for (i = 1; i < argc; i++) {
         const char *arg = argv[i];
+        if (arg == NULL) {
+            continue;
+        }
         if (strncmp(arg, "-XX:LogFile=", 12) == 0) {
             logFilePath = arg + 12;
             /* Null out the argument so that it is not parsed later. */
             argv[i] = NULL;
-            break;
+        } else if (strncmp(arg, "-XX:ImageRelocation=", 20) == 0) {
+            imageRelocationMode = arg + 20;
+            argv[i] = NULL;
+        } else if (strncmp(arg, "-XX:ImageLargePages=", 20) == 0) {
+            imageLargePages = arg + 20;
+            argv[i] = NULL;
+        } else if (strncmp(arg, "-XX:ImagePageProfile=", 21) == 0) {
+            imagePageProfile = arg + 21;
+            argv[i] = NULL;
+        } else if (strcmp(arg, "-XX:+ImageMergeable") == 0 || strcmp(arg, "-XX:-ImageMergeable") == 0) {
+            imageMergeable = arg[4] == '+';
+            argv[i] = NULL;
+        } else if (strncmp(arg, "-XX:NUMAHeapPlacement=", 22) == 0) {
+            numaHeapPlacement = arg + 22;
+            argv[i] = NULL;
+        } else if (strcmp(arg, "-XX:+NUMALocalThreadLocals") == 0 || strcmp(arg, "-XX:-NUMALocalThreadLocals") == 0) {
+            threadLocalsBlock_setNUMALocal(arg[4] == '+');
+            argv[i] = NULL;
+        } else if (strcmp(arg, "-XX:+AdaptiveNativeMutexes") == 0 || strcmp(arg, "-XX:-AdaptiveNativeMutexes") == 0) {
+            /* Must be selected before log_initialize() creates the first mutex. */
+            mutex_setAdaptive(arg[4] == '+');
+            argv[i] = NULL;
+        } else if (strcmp(arg, "-XX:+DormantAttachedThreads") == 0 || strcmp(arg, "-XX:-DormantAttachedThreads") == 0) {
+            thread_setDormantAttach(arg[4] == '+');
+            argv[i] = NULL;
+        } else if (strcmp(arg, "-XX:+AsyncLogging") == 0 || strcmp(arg, "-XX:-AsyncLogging") == 0) {
+            log_setAsync(arg[4] == '+');
+            argv[i] = NULL;
+        } else if (strncmp(arg, "-XX:BinaryTrace=", 16) == 0) {
+            binaryTraceDirectory = arg + 16;
+            argv[i] = NULL;
+        } else if (strcmp(arg, "-XX:+SocketPoller") == 0 || strcmp(arg, "-XX:-SocketPoller") == 0) {
+            readiness_setEnabled(arg[4] == '+');
+            argv[i] = NULL;
+        } else if (strcmp(arg, "-XX:+IoUring") == 0 || strcmp(arg, "-XX:-IoUring") == 0) {
+            aio_setUseIoUring(arg[4] == '+');
+            argv[i] = NULL;
+        } else if (strcmp(arg, "-XX:+PerfMap") == 0 || strcmp(arg, "-XX:-PerfMap") == 0) {
+            perfMap_setMode(PERF_MAP_ENABLED, arg[4] == '+');
+            argv[i] = NULL;
+        } else if (strcmp(arg, "-XX:+JitDump") == 0 || strcmp(arg, "-XX:-JitDump") == 0) {
+            perfMap_setMode(PERF_MAP_JIT_DUMP, arg[4] == '+');
+            argv[i] = NULL;
+        } else if (strncmp(arg, "-XX:NativeMutexProfile=", 23) == 0) {
+            mutex_setProfilePeriod(atoi(arg + 23));
+            argv[i] = NULL;
+        } else if (strncmp(arg, "-XX:HostCacheTTL=", 17) == 0) {
+            resolver_setTimeToLive(atoi(arg + 17));
+            argv[i] = NULL;
+        } else if (strncmp(arg, "-XX:HostCacheNegativeTTL=", 25) == 0) {
+            resolver_setNegativeTimeToLive(atoi(arg + 25));
+            argv[i] = NULL;
+        } else if (strncmp(arg, "-XX:Zygote=", 11) == 0) {
+            zygotePath = arg + 11;
+            argv[i] = NULL;
         }
     }
+    if (zygotePath != NULL) {
+        /* The children of a zygote would not inherit the log writer thread. */
+        log_setAsync(false);
+    }
     log_initialize(logFilePath);
+    startup_mark(STARTUP_LOG_INITIALIZED);
+    virtualMemory_setTypePlacementPolicy(HEAP_VM, parseNUMAPlacement(numaHeapPlacement, &numaHeapNode), numaHeapNode);
 
 #if os_DARWIN
     _executablePath = executablePath;
@@ -334,13 +496,32 @@ int maxine(int argc, char *argv[], char *executablePath) {
     }
 #endif
     max_fd_limit();
-    loadImage();
+    startup_mark(STARTUP_FD_LIMIT);
+    int pageProfile = parseImagePageProfile(imagePageProfile, &imagePageProfileSeconds);
+    if (zygotePath != NULL && pageProfile == image_PAGE_PROFILE_RECORD) {
+        log_exit(1, "-XX:ImagePageProfile=record cannot be used with -XX:Zygote");
+    }
+    loadImage(parseImageRelocationMode(imageRelocationMode), parseImageLargePages(imageLargePages), pageProfile, imagePageProfileSeconds, imageMergeable);
+    startup_mark(STARTUP_IMAGE_LOADED);
     tla_initialize(image_header()->tlaSize);
+    startup_mark(STARTUP_TLA_INITIALIZED);
+    if (zygotePath != NULL) {
+        /* Only returns in a child, which continues with the arguments of its request. */
+        zygote_serve(zygotePath, &argc, &argv);
+        startup_mark(STARTUP_ZYGOTE_FORKED);
+    }
     debugger_initialize();
+    startup_mark(STARTUP_DEBUGGER_INITIALIZED);
     method = image_offset_as_address(VMRunMethod, vmRunMethodOffset);
 
     Address tlBlock = threadLocalsBlock_create(PRIMORDIAL_THREAD_ID, 0, 0);
     NativeThreadLocals ntl = NATIVE_THREAD_LOCALS_FROM_TLBLOCK(tlBlock);
+    startup_mark(STARTUP_PRIMORDIAL_THREAD_LOCALS);
+    spinWait_initialize();
+    sampler_initialize();
+    sampler_threadStarted();
+    trace_initialize(binaryTraceDirectory);
+    trace_threadStarted(tlBlock, ntl->stackBase, ntl->stackSize);
 
 #if log_LOADER
     log_println("entering Java by calling MaxineVM.run(tlBlock=%p, bootHeapRegionStart=%p, openLibrary=%p, dlsym=%p, dlerror=%p, vmInterface=%p, jniEnv=%p, jmmInterface=%p, jvmtiInterface=%p, argc=%d, argv=%p)",
@@ -397,6 +578,8 @@ void native_exit(jint code) {
     //if (code != 11) {
     //    cleanupCurrentThreadBlockBeforeExit();
     //}
+    perfMap_flush();
+    log_flush();
     exit(code);
 }
 
@@ -405,6 +588,7 @@ void core_dump() {
     log_print("dumping core....\n  heap @ ");
     log_print_symbol(image_heap());
     log_print_newline();
+    log_flush();
     // Use kill instead of abort so the vm process keeps running after the core is created.
     kill(getpid(), SIGABRT);
     sleep(3);
@@ -500,84 +684,282 @@ double native_parseDouble(const char* cstring, double nan) {
 #endif
 }
 
-void maxine_cache_flush(char *start, int length) {
+/*
+ * Instruction cache maintenance. A flush of a set of ranges is split into a clean of the data cache to the
+ * point of unification for every range, one barrier, an invalidation of the instruction cache for every
+ * range and one final barrier, so that the barriers are paid once per set instead of once per range.
+ */
+
+#if isa_AARCH64
+/*
+ * The cache type register, read once. It gives the smallest data and instruction cache line sizes and
+ * whether the data cache clean (IDC) or the instruction cache invalidation (DIC) are not required for
+ * instruction to data coherence.
+ */
+static Unsigned8 cacheType;
+
+#define CTR_IDC (1ULL << 28)
+#define CTR_DIC (1ULL << 29)
+
+static Unsigned8 cache_type(void) {
+    if (cacheType == 0) {
+        Unsigned8 ctr;
+        __asm__ __volatile__("mrs %0, ctr_el0" : "=r" (ctr));
+        cacheType = ctr;
+    }
+    return cacheType;
+}
+
+static inline Address cache_dataLineSize(Unsigned8 ctr) {
+    return 4 << ((ctr >> 16) & 0xf);
+}
+
+static inline Address cache_instructionLineSize(Unsigned8 ctr) {
+    return 4 << (ctr & 0xf);
+}
+#endif
+
+static void cache_beginFlush(void) {
 #if isa_ARM
-    char * end = start + length;
-    asm volatile("isb ");
-    asm volatile("dsb ");
-    asm volatile("dmb ");
-    __clear_cache(start, end);
-    asm volatile("isb ");
-    asm volatile("dsb ");
-    asm volatile("dmb ");
-#elif isa_AARCH64 || isa_RISCV64
-    char * end = start + length;
-    __builtin___clear_cache(start, end);
+    /* Complete the writes of the new code before the maintenance. */
+    __asm__ __volatile__("dsb" ::: "memory");
 #endif
 }
 
-long long d2long(double x) {
-    if (isnan(x)) {
-        return (long long) 0;
+static void cache_cleanRange(Address start, Address end) {
+#if isa_AARCH64
+    Unsigned8 ctr = cache_type();
+    if ((ctr & CTR_IDC) == 0) {
+        Address lineSize = cache_dataLineSize(ctr);
+        Address line;
+        for (line = start & ~(lineSize - 1); line < end; line += lineSize) {
+            __asm__ __volatile__("dc cvau, %0" :: "r" (line) : "memory");
+        }
     }
-    if (x <= (double) ((long long) -9223372036854775808ULL)) {
-        return -9223372036854775808ULL;
-    } else if (x >= (double) ((long long) 9223372036854775807ULL)) {
-        return 9223372036854775807ULL;
-    } else {
-        return (long long) x;
+#endif
+}
+
+static void cache_cleanBarrier(void) {
+#if isa_AARCH64
+    __asm__ __volatile__("dsb ish" ::: "memory");
+#endif
+}
+
+static void cache_invalidateRange(Address start, Address end) {
+#if isa_AARCH64
+    Unsigned8 ctr = cache_type();
+    if ((ctr & CTR_DIC) == 0) {
+        Address lineSize = cache_instructionLineSize(ctr);
+        Address line;
+        for (line = start & ~(lineSize - 1); line < end; line += lineSize) {
+            __asm__ __volatile__("ic ivau, %0" :: "r" (line) : "memory");
+        }
     }
+#elif isa_ARM
+    /* Cache maintenance is privileged on ARMv7: this is the cacheflush system call. */
+    __clear_cache((char *) start, (char *) end);
+#endif
 }
 
-long long f2long(float x) {
-    if (isnan(x)) {
-        return (long long) 0;
+/**
+ * @param low the lowest address of the flushed ranges
+ * @param high the end of the highest flushed range
+ */
+static void cache_endFlush(Address low, Address high) {
+#if isa_AARCH64
+    __asm__ __volatile__("dsb ish" ::: "memory");
+    __asm__ __volatile__("isb" ::: "memory");
+#elif isa_ARM
+    __asm__ __volatile__("dsb" ::: "memory");
+    __asm__ __volatile__("isb" ::: "memory");
+#elif isa_RISCV64
+    /*
+     * The riscv_flush_icache system call does not flush by range: it executes a FENCE.I on this hart and
+     * makes every other hart running this process execute one before it next returns to user mode, so
+     * one call covers all the ranges and the remote fences are deferred to when they are needed.
+     */
+    __builtin___clear_cache((char *) low, (char *) high);
+#endif
+}
+
+/**
+ * Flushes ranges that are sorted by address and do not overlap.
+ */
+static void cache_flushSortedRanges(CodeRange ranges, jint count) {
+    jint i;
+    if (count == 0) {
+        return;
     }
-    if (x <= (float) ((long long) -9223372036854775808ULL)) {
-        return -9223372036854775808ULL;
-    } else if (x >= (float) ((long long) 9223372036854775807ULL)) {
-        return 9223372036854775807ULL;
-    } else {
-        return (long long) x;
+    cache_beginFlush();
+    for (i = 0; i < count; i++) {
+        cache_cleanRange(ranges[i].start, ranges[i].start + ranges[i].size);
     }
+    cache_cleanBarrier();
+    for (i = 0; i < count; i++) {
+        cache_invalidateRange(ranges[i].start, ranges[i].start + ranges[i].size);
+    }
+    cache_endFlush(ranges[0].start, ranges[count - 1].start + ranges[count - 1].size);
 }
 
-long long arithmeticldiv(long long x, long long y) {
-    if (y == 0) {
-        //raise(SIGFPE);
-        return 0;
+/*
+ * The granularity at which adjacent ranges are merged into a single cache flush.
+ */
+#define CODE_PATCH_FLUSH_GRANULARITY 64
+
+void maxine_cache_flush_ranges(CodeRange ranges, jint count) {
+    jint i;
+    /* Sort by start address (insertion sort as the ranges are few and usually nearly sorted). */
+    for (i = 1; i < count; i++) {
+        CodeRangeStruct range = ranges[i];
+        jint j = i - 1;
+        while (j >= 0 && ranges[j].start > range.start) {
+            ranges[j + 1] = ranges[j];
+            j--;
+        }
+        ranges[j + 1] = range;
+    }
+
+    /* Merge overlapping and neighbouring ranges in place. */
+    jint merged = 0;
+    for (i = 0; i < count; i++) {
+        if (ranges[i].size == 0) {
+            continue;
+        }
+        if (merged > 0) {
+            CodeRange last = &ranges[merged - 1];
+            Address lastEnd = last->start + last->size;
+            if (ranges[i].start <= lastEnd + CODE_PATCH_FLUSH_GRANULARITY) {
+                Address end = ranges[i].start + ranges[i].size;
+                if (end > lastEnd) {
+                    last->size = end - last->start;
+                }
+                continue;
+            }
+        }
+        ranges[merged++] = ranges[i];
     }
-    return x / y;
+    cache_flushSortedRanges(ranges, merged);
 }
 
-jlong arithmeticlrem(jlong x, jlong y) {
-    if (y == 0) {
-        //raise(SIGFPE);
-        return 0;
+void maxine_cache_flush(char *start, int length) {
+    CodeRangeStruct range;
+    range.start = (Address) start;
+    range.size = length;
+    if (length > 0) {
+        cache_flushSortedRanges(&range, 1);
     }
-    return x % y;
 }
 
-unsigned long long arithmeticludiv(unsigned long long x, unsigned long long y) {
-    if (y == 0) {
-        //raise(SIGFPE);
-        return 0;
+/*
+ * The number of merged ranges of a patch batch that are flushed together.
+ */
+#define CODE_PATCH_RANGES_PER_FLUSH 32
+
+/*
+ * A queued code patch (see com.sun.max.vm.compiler.target.CodePatchBatch).
+ */
+typedef struct {
+    Address address;
+    Address value;
+    Address size;  // 4 or 8
+} CodePatchStruct, *CodePatch;
+
+/**
+ * Applies a batch of code patches, flushes the instruction cache for the patched ranges (merging
+ * neighbouring ranges) and then, if requested, executes a single core serializing membarrier.
+ *
+ * @param patches an array of {@code count} patches. The array is sorted by address on return.
+ * @param count the number of patches
+ * @param barrier specifies if a membarrier is issued after the instruction cache maintenance
+ */
+void maxine_patch_code(CodePatch patches, jint count, jboolean barrier) {
+    CodeRangeStruct ranges[CODE_PATCH_RANGES_PER_FLUSH];
+    jint rangeCount = 0;
+    int i;
+    for (i = 0; i < count; i++) {
+        CodePatch patch = &patches[i];
+        if (patch->size == sizeof(jint)) {
+            *((volatile jint *) patch->address) = (jint) patch->value;
+        } else {
+            c_ASSERT(patch->size == sizeof(jlong));
+            *((volatile jlong *) patch->address) = (jlong) patch->value;
+        }
+    }
+
+    /* Sort by address (insertion sort as batches are small and usually nearly sorted). */
+    for (i = 1; i < count; i++) {
+        CodePatchStruct patch = patches[i];
+        int j = i - 1;
+        while (j >= 0 && patches[j].address > patch.address) {
+            patches[j + 1] = patches[j];
+            j--;
+        }
+        patches[j + 1] = patch;
+    }
+
+    i = 0;
+    while (i < count) {
+        Address start = patches[i].address;
+        Address end = start + patches[i].size;
+        i++;
+        while (i < count && patches[i].address <= end + CODE_PATCH_FLUSH_GRANULARITY) {
+            Address patchEnd = patches[i].address + patches[i].size;
+            if (patchEnd > end) {
+                end = patchEnd;
+            }
+            i++;
+        }
+        ranges[rangeCount].start = start;
+        ranges[rangeCount].size = end - start;
+        rangeCount++;
+        if (rangeCount == CODE_PATCH_RANGES_PER_FLUSH) {
+            cache_flushSortedRanges(ranges, rangeCount);
+            rangeCount = 0;
+        }
+    }
+    cache_flushSortedRanges(ranges, rangeCount);
+
+    if (barrier && count != 0) {
+        jboolean membarrier_isAvailable();
+        void syscall_membarrierSyncCore();
+        if (membarrier_isAvailable()) {
+            syscall_membarrierSyncCore();
+        }
     }
-    return x / y;
+}
+
+/*
+ * The out-of-line entry points of the runtime helpers. Native callers use javaArithmetic.h directly.
+ */
+
+long long d2long(double x) {
+    return javaArithmetic_d2l(x);
+}
+
+long long f2long(float x) {
+    return javaArithmetic_f2l(x);
+}
+
+long long arithmeticldiv(long long x, long long y) {
+    return javaArithmetic_ldiv(x, y);
+}
+
+jlong arithmeticlrem(jlong x, jlong y) {
+    return javaArithmetic_lrem(x, y);
+}
+
+unsigned long long arithmeticludiv(unsigned long long x, unsigned long long y) {
+    return javaArithmetic_ludiv(x, y);
 }
 
 unsigned long long arithmeticlurem(unsigned long long x, unsigned long long y) {
-    if (y == 0) {
-        //raise(SIGFPE);
-        return 0;
-    }
-    return x % y;
+    return javaArithmetic_lurem(x, y);
 }
 
 double l2double(jlong x) {
-    return (jdouble) x;
+    return javaArithmetic_l2d(x);
 }
 
 float l2float(jlong x) {
-    return (jfloat) x;
+    return javaArithmetic_l2f(x);
 }
@@ -23,6 +23,7 @@
 
 #include "os.h"
 #include "jni.h"
+#include "word.h"
 
 extern jlong native_nanoTime(void);
 extern jlong native_currentTimeMillis(void);
@@ -41,5 +42,26 @@ typedef struct {
     char *user_dir;
 } native_props_t;
 
+/**
+ * A range of modified code. The layout must be kept in sync with the users of MaxineVM.maxine_cache_flush_ranges().
+ */
+typedef struct {
+    Address start;
+    Address size;
+} CodeRangeStruct, *CodeRange;
+
+/**
+ * Makes the instruction fetches of all threads observe the modified code in a range.
+ */
+extern void maxine_cache_flush(char *start, int length);
+
+/**
+ * Makes the instruction fetches of all threads observe the modified code in a set of ranges. The ranges
+ * are merged where they overlap or are close, the data cache lines of all of them are cleaned before their
+ * instruction cache lines are invalidated, and the barriers are executed once for the whole set.
+ *
+ * @param ranges an array of {@code count} ranges, which is sorted and merged in place
+ */
+extern void maxine_cache_flush_ranges(CodeRange ranges, jint count);
 
 #endif /* __maxine_h__ */
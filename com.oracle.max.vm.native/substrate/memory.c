@@ -31,6 +31,373 @@
 #include "virtualMemory.h"
 #include "log.h"
 
+#if !os_MAXVE
+
+/*
+ * memory_allocate(), memory_reallocate() and memory_deallocate() are served by a size-class allocator
+ * instead of the C library so that the VM's many threads do not contend on its locks.
+ *
+ * Requests of up to MEMORY_SMALL_LIMIT bytes are rounded up to one of MEMORY_SIZE_CLASSES block sizes.
+ * Each thread keeps a free list per size class that it allocates from and frees to without locking.
+ * A thread whose list is empty takes a batch of blocks from the central list of the class and one whose
+ * list has grown too long gives a batch back, so blocks freed by another thread are recycled. When the
+ * central list is empty too a block is carved from a span of virtual memory owned by the thread, which is
+ * placed on the NUMA node the thread runs on. Carved blocks come from fresh pages and so are known to be
+ * zero: only blocks that are reused are cleared. Larger requests and their headers go to calloc(3).
+ * The unused rest of the span of an exiting thread goes to a shared pool from which threads take
+ * their next span before they allocate a new one.
+ *
+ * Every block is preceded by a header recording its size class and an owner tag, which is the address
+ * of the header combined with MEMORY_OWNER_KEY. The tag identifies memory that did not come from
+ * memory_allocate() (whose preceding word cannot be its own tagged address) so that it is passed on to free(3).
+ */
+#include <pthread.h>
+
+#define MEMORY_ALIGNMENT 16
+#define MEMORY_HEADER_SIZE 16
+#define MEMORY_SMALL_LIMIT (32 * 1024)
+#define MEMORY_SIZE_CLASSES 44
+#define MEMORY_OWNER_KEY ((Address) 0x6d656d316d656d31ULL)
+#define MEMORY_SPAN_SIZE (256 * 1024)
+#define MEMORY_BATCH 32
+#define MEMORY_STATISTICS_FLUSH 1024
+
+typedef struct {
+    Address owner;     /* see ownerTag() */
+    Size size;         /* the size class of a small block, or the size requested for a large block */
+} BlockHeaderStruct, *BlockHeader;
+
+/* A large block is never smaller than MEMORY_SMALL_LIMIT, which is larger than any size class. */
+#define isLargeBlock(header) ((header)->size > MEMORY_SMALL_LIMIT)
+
+/* The rest of a span abandoned by an exiting thread, which starts with this structure. */
+typedef struct SpanRemainderStruct {
+    struct SpanRemainderStruct *next;
+    Address end;
+} SpanRemainderStruct, *SpanRemainder;
+
+typedef struct FreeBlockStruct {
+    struct FreeBlockStruct *next;
+} FreeBlockStruct, *FreeBlock;
+
+typedef struct {
+    pthread_mutex_t lock;
+    FreeBlock head;
+    int count;
+} CentralListStruct;
+
+typedef struct {
+    FreeBlock head[MEMORY_SIZE_CLASSES];
+    int count[MEMORY_SIZE_CLASSES];
+    Address spanTop;
+    Address spanEnd;
+    Size allocations;
+    Size deallocations;
+    boolean registered;
+} ThreadCacheStruct, *ThreadCache;
+
+static CentralListStruct theCentralLists[MEMORY_SIZE_CLASSES];
+static pthread_mutex_t theSpanRemaindersLock = PTHREAD_MUTEX_INITIALIZER;
+static SpanRemainder theSpanRemainders;
+static Size theStatistics[MEMORY_STATISTICS];
+static __thread ThreadCacheStruct theThreadCache;
+static pthread_key_t threadCacheKey;
+static pthread_once_t initializeOnce = PTHREAD_ONCE_INIT;
+
+Size *memory_getStatistics(void) {
+    return theStatistics;
+}
+
+static Address ownerTag(BlockHeader header) {
+    return (Address) header ^ MEMORY_OWNER_KEY;
+}
+
+/*
+ * The classes are multiples of 16 bytes up to 256 bytes and then four per power of two up to MEMORY_SMALL_LIMIT.
+ */
+static int sizeClass(Size size) {
+    if (size <= 256) {
+        return size == 0 ? 0 : (int) ((size - 1) >> 4);
+    }
+    int log2 = 8;
+    while (((size - 1) >> (log2 + 1)) != 0) {
+        log2++;
+    }
+    return 16 + (log2 - 8) * 4 + (int) (((size - 1) - ((Size) 1 << log2)) >> (log2 - 2));
+}
+
+static Size classSize(int sizeClass) {
+    if (sizeClass < 16) {
+        return (Size) (sizeClass + 1) << 4;
+    }
+    int log2 = 8 + (sizeClass - 16) / 4;
+    return ((Size) 1 << log2) + (Size) ((sizeClass - 16) % 4 + 1) * ((Size) 1 << (log2 - 2));
+}
+
+static void flushStatistics(ThreadCache cache) {
+    __sync_fetch_and_add(&theStatistics[MEMORY_ALLOCATIONS], cache->allocations);
+    __sync_fetch_and_add(&theStatistics[MEMORY_DEALLOCATIONS], cache->deallocations);
+    cache->allocations = 0;
+    cache->deallocations = 0;
+}
+
+/* Moves up to 'count' blocks of a class from a thread's list to the central list. */
+static void releaseBlocks(ThreadCache cache, int sizeClass, int count) {
+    FreeBlock first = cache->head[sizeClass];
+    FreeBlock last = first;
+    int n = 1;
+    while (n < count && last->next != NULL) {
+        last = last->next;
+        n++;
+    }
+    cache->head[sizeClass] = last->next;
+    cache->count[sizeClass] -= n;
+    CentralListStruct *central = &theCentralLists[sizeClass];
+    pthread_mutex_lock(&central->lock);
+    last->next = central->head;
+    central->head = first;
+    central->count += n;
+    pthread_mutex_unlock(&central->lock);
+    __sync_fetch_and_add(&theStatistics[MEMORY_CENTRAL_TRANSFERS], 1);
+}
+
+/* Moves up to MEMORY_BATCH blocks of a class from the central list to a thread's empty list. */
+static boolean acquireBlocks(ThreadCache cache, int sizeClass) {
+    CentralListStruct *central = &theCentralLists[sizeClass];
+    if (central->head == NULL) {
+        /* An unlocked peek: missing a block that is being released only means carving a new one. */
+        return false;
+    }
+    pthread_mutex_lock(&central->lock);
+    FreeBlock first = central->head;
+    if (first == NULL) {
+        pthread_mutex_unlock(&central->lock);
+        return false;
+    }
+    FreeBlock last = first;
+    int n = 1;
+    while (n < MEMORY_BATCH && last->next != NULL) {
+        last = last->next;
+        n++;
+    }
+    central->head = last->next;
+    central->count -= n;
+    pthread_mutex_unlock(&central->lock);
+    last->next = NULL;
+    cache->head[sizeClass] = first;
+    cache->count[sizeClass] = n;
+    __sync_fetch_and_add(&theStatistics[MEMORY_CENTRAL_TRANSFERS], 1);
+    return true;
+}
+
+/* Gives the cached blocks of an exiting thread to the central lists. */
+static void threadCacheExited(void *value) {
+    ThreadCache cache = (ThreadCache) value;
+    int i;
+    for (i = 0; i < MEMORY_SIZE_CLASSES; i++) {
+        if (cache->head[i] != NULL) {
+            releaseBlocks(cache, i, cache->count[i]);
+        }
+    }
+    flushStatistics(cache);
+    if (cache->spanEnd - cache->spanTop >= MEMORY_HEADER_SIZE + classSize(0)) {
+        SpanRemainder remainder = (SpanRemainder) cache->spanTop;
+        remainder->end = cache->spanEnd;
+        pthread_mutex_lock(&theSpanRemaindersLock);
+        remainder->next = theSpanRemainders;
+        theSpanRemainders = remainder;
+        pthread_mutex_unlock(&theSpanRemaindersLock);
+    }
+    cache->spanTop = cache->spanEnd = 0;
+    cache->registered = false;
+}
+
+/*
+ * Takes the rest of a span abandoned by an exited thread that can hold at least 'size' bytes.
+ * The rest is zero apart from its SpanRemainderStruct, which is cleared before it is carved.
+ */
+static boolean takeSpanRemainder(ThreadCache cache, Size size) {
+    if (theSpanRemainders == NULL) {
+        /* An unlocked peek: missing a remainder that is being added only means allocating a new span. */
+        return false;
+    }
+    pthread_mutex_lock(&theSpanRemaindersLock);
+    SpanRemainder *link = &theSpanRemainders;
+    while (*link != NULL && (*link)->end - (Address) *link < size) {
+        link = &(*link)->next;
+    }
+    SpanRemainder remainder = *link;
+    if (remainder != NULL) {
+        *link = remainder->next;
+    }
+    pthread_mutex_unlock(&theSpanRemaindersLock);
+    if (remainder == NULL) {
+        return false;
+    }
+    cache->spanTop = (Address) remainder;
+    cache->spanEnd = remainder->end;
+    memset(remainder, 0, sizeof(SpanRemainderStruct));
+    return true;
+}
+
+static void initialize(void) {
+    int i;
+    for (i = 0; i < MEMORY_SIZE_CLASSES; i++) {
+        pthread_mutex_init(&theCentralLists[i].lock, NULL);
+    }
+    if (pthread_key_create(&threadCacheKey, threadCacheExited) != 0) {
+        log_exit(11, "Could not create the native allocator's thread cache key");
+    }
+}
+
+static ThreadCache threadCache(void) {
+    ThreadCache cache = &theThreadCache;
+    if (!cache->registered) {
+        pthread_once(&initializeOnce, initialize);
+        cache->registered = true;
+        pthread_setspecific(threadCacheKey, cache);
+    }
+    return cache;
+}
+
+/* Carves a block of a class from the thread's span, which is replaced when it is exhausted. */
+static Address carveBlock(ThreadCache cache, int sizeClass) {
+    Size blockSize = MEMORY_HEADER_SIZE + classSize(sizeClass);
+    if (cache->spanTop + blockSize > cache->spanEnd && !takeSpanRemainder(cache, blockSize)) {
+        Address span = virtualMemory_allocate(MEMORY_SPAN_SIZE, DATA_VM);
+        if (span == ALLOC_FAILED) {
+            return 0;
+        }
+        virtualMemory_setPlacementPolicy(span, MEMORY_SPAN_SIZE, NUMA_POLICY_LOCAL, 0);
+        __sync_fetch_and_add(&theStatistics[MEMORY_SPAN_BYTES], MEMORY_SPAN_SIZE);
+        cache->spanTop = span;
+        cache->spanEnd = span + MEMORY_SPAN_SIZE;
+    }
+    Address block = cache->spanTop;
+    cache->spanTop += blockSize;
+    return block;
+}
+
+static Address allocateLarge(Size size, boolean zero) {
+    BlockHeader header = (BlockHeader) (zero ? calloc(1, (size_t) (MEMORY_HEADER_SIZE + size)) : malloc((size_t) (MEMORY_HEADER_SIZE + size)));
+    if (header == NULL) {
+        return 0;
+    }
+    header->owner = ownerTag(header);
+    header->size = size;
+    __sync_fetch_and_add(&theStatistics[MEMORY_LARGE_BYTES], size);
+    __sync_fetch_and_add(&theStatistics[MEMORY_ALLOCATIONS], 1);
+    return (Address) header + MEMORY_HEADER_SIZE;
+}
+
+/*
+ * Allocates a block of at least 'size' bytes aligned to MEMORY_ALIGNMENT, cleared if 'zero' is true.
+ */
+static Address allocate(Size size, boolean zero) {
+    if (size > MEMORY_SMALL_LIMIT) {
+        return allocateLarge(size, zero);
+    }
+    ThreadCache cache = threadCache();
+    int c = sizeClass(size);
+    Address block;
+    boolean reused = cache->head[c] != NULL || acquireBlocks(cache, c);
+    if (reused) {
+        FreeBlock freeBlock = cache->head[c];
+        cache->head[c] = freeBlock->next;
+        cache->count[c]--;
+        block = (Address) freeBlock - MEMORY_HEADER_SIZE;
+    } else {
+        block = carveBlock(cache, c);
+        if (block == 0) {
+            return 0;
+        }
+        BlockHeader header = (BlockHeader) block;
+        header->owner = ownerTag(header);
+        header->size = c;
+    }
+    if (++cache->allocations >= MEMORY_STATISTICS_FLUSH) {
+        flushStatistics(cache);
+    }
+    Address result = block + MEMORY_HEADER_SIZE;
+    if (zero && reused) {
+        memset((void *) result, 0, (size_t) size);
+    }
+    return result;
+}
+
+static BlockHeader blockHeader(Address pointer) {
+    BlockHeader header = (BlockHeader) (pointer - MEMORY_HEADER_SIZE);
+    return header->owner == ownerTag(header) ? header : NULL;
+}
+
+Address memory_allocate(Size size) {
+    return allocate(size, true);
+}
+
+Address memory_reallocate(Address pointer, Size size) {
+    if (pointer == 0) {
+        return allocate(size, true);
+    }
+    BlockHeader header = blockHeader(pointer);
+    if (header == NULL) {
+        return (Address) realloc((void *) pointer, (size_t) size);
+    }
+    Size oldSize;
+    if (isLargeBlock(header)) {
+        oldSize = header->size;
+        if (size > MEMORY_SMALL_LIMIT) {
+            BlockHeader newHeader = (BlockHeader) realloc(header, (size_t) (MEMORY_HEADER_SIZE + size));
+            if (newHeader == NULL) {
+                return 0;
+            }
+            newHeader->owner = ownerTag(newHeader);
+            newHeader->size = size;
+            __sync_fetch_and_add(&theStatistics[MEMORY_LARGE_BYTES], size - oldSize);
+            return (Address) newHeader + MEMORY_HEADER_SIZE;
+        }
+    } else {
+        oldSize = classSize((int) header->size);
+        if (size <= oldSize && size > oldSize / 2) {
+            return pointer;
+        }
+    }
+    Address result = allocate(size, false);
+    if (result != 0) {
+        memcpy((void *) result, (void *) pointer, (size_t) (size < oldSize ? size : oldSize));
+        memory_deallocate(pointer);
+    }
+    return result;
+}
+
+jint memory_deallocate(Address pointer) {
+    BlockHeader header = blockHeader(pointer);
+    if (header == NULL) {
+        free((void *) pointer);
+        return 0;
+    }
+    if (isLargeBlock(header)) {
+        __sync_fetch_and_sub(&theStatistics[MEMORY_LARGE_BYTES], header->size);
+        __sync_fetch_and_add(&theStatistics[MEMORY_DEALLOCATIONS], 1);
+        header->owner = 0;
+        free(header);
+        return 0;
+    }
+    ThreadCache cache = threadCache();
+    int c = (int) header->size;
+    FreeBlock freeBlock = (FreeBlock) pointer;
+    freeBlock->next = cache->head[c];
+    cache->head[c] = freeBlock;
+    if (++cache->count[c] > 2 * MEMORY_BATCH) {
+        releaseBlocks(cache, c, MEMORY_BATCH);
+    }
+    if (++cache->deallocations >= MEMORY_STATISTICS_FLUSH) {
+        flushStatistics(cache);
+    }
+    return 0;
+}
+
+#else
+
 Address memory_allocate(Size size) {
     Address mem = (Address) calloc(1, (size_t) size);
     if (mem % sizeof(void *)) {
@@ -53,3 +420,87 @@ jint memory_deallocate(Address pointer) {
     free((void *) pointer);
     return 0;
 }
+
+Size *memory_getStatistics(void) {
+    return NULL;
+}
+
+#endif
+
+#if isa_AMD64
+
+/*
+ * Copies at least this many bytes with non-temporal stores. A copy larger than the last level cache
+ * would evict all of it anyway, so streaming the destination past the cache is no slower and keeps
+ * the rest of the cache contents.
+ */
+static Size theNonTemporalCopyThreshold;
+
+static Size nonTemporalCopyThreshold(void) {
+    if (theNonTemporalCopyThreshold == 0) {
+        long cacheSize = -1;
+#if os_LINUX && defined(_SC_LEVEL3_CACHE_SIZE)
+        cacheSize = sysconf(_SC_LEVEL3_CACHE_SIZE);
+        if (cacheSize <= 0) {
+            cacheSize = sysconf(_SC_LEVEL2_CACHE_SIZE);
+        }
+#endif
+        theNonTemporalCopyThreshold = cacheSize > 0 ? (Size) cacheSize : 8 * 1024 * 1024;
+    }
+    return theNonTemporalCopyThreshold;
+}
+
+/*
+ * The non-temporal kernels copy whole 128 byte blocks to a 32 byte aligned destination and return the
+ * number of bytes copied.
+ */
+__attribute__((target("avx2")))
+static Size copyNonTemporalAVX2(Address dst, Address src, Size size) {
+    Size i = 0;
+    for (; i + 128 <= size; i += 128) {
+        __m256i a = _mm256_loadu_si256((const __m256i *) (src + i));
+        __m256i b = _mm256_loadu_si256((const __m256i *) (src + i + 32));
+        __m256i c = _mm256_loadu_si256((const __m256i *) (src + i + 64));
+        __m256i d = _mm256_loadu_si256((const __m256i *) (src + i + 96));
+        _mm256_stream_si256((__m256i *) (dst + i), a);
+        _mm256_stream_si256((__m256i *) (dst + i + 32), b);
+        _mm256_stream_si256((__m256i *) (dst + i + 64), c);
+        _mm256_stream_si256((__m256i *) (dst + i + 96), d);
+    }
+    return i;
+}
+
+static Size copyNonTemporalSSE2(Address dst, Address src, Size size) {
+    Size i = 0;
+    for (; i + 128 <= size; i += 128) {
+        int j;
+        for (j = 0; j < 128; j += 16) {
+            _mm_stream_si128((__m128i *) (dst + i + j), _mm_loadu_si128((const __m128i *) (src + i + j)));
+        }
+    }
+    return i;
+}
+
+#endif
+
+void memory_copy(Address dst, Address src, Size size) {
+#if isa_AMD64
+    if (size >= nonTemporalCopyThreshold() && (dst + size <= src || src + size <= dst)) {
+        /* Align the destination so that every streaming store is aligned. */
+        Size head = (32 - (dst & 31)) & 31;
+        memcpy((void *) dst, (void *) src, (size_t) head);
+        Size copied = head;
+        if (__builtin_cpu_supports("avx2")) {
+            copied += copyNonTemporalAVX2(dst + head, src + head, size - head);
+        } else {
+            copied += copyNonTemporalSSE2(dst + head, src + head, size - head);
+        }
+        /* Order the streaming stores before any later store, e.g. one publishing the copy. */
+        _mm_sfence();
+        memcpy((void *) (dst + copied), (void *) (src + copied), (size_t) (size - copied));
+        return;
+    }
+#endif
+    /* memmove(3) of the C library already uses the widest vector copies the CPU supports. */
+    memmove((void *) dst, (void *) src, (size_t) size);
+}
@@ -24,4 +24,53 @@
 #ifndef MEMORY_H_
 #define MEMORY_H_
 
+#include "word.h"
+#include "jni.h"
+
+/*
+ * The allocation statistics of the native allocator (see memory_getStatistics()).
+ *
+ *  ATTENTION: these must match the ordinals of 'com.sun.max.memory.Memory.Statistic'.
+ */
+#define MEMORY_ALLOCATIONS 0        // blocks allocated
+#define MEMORY_DEALLOCATIONS 1      // blocks deallocated
+#define MEMORY_SPAN_BYTES 2         // bytes of virtual memory from which small blocks are carved
+#define MEMORY_LARGE_BYTES 3        // bytes in live blocks too large for a size class
+#define MEMORY_CENTRAL_TRANSFERS 4  // batches of blocks moved between the thread caches and the central lists
+#define MEMORY_STATISTICS 5
+
+/**
+ * Allocates a zeroed block of at least 'size' bytes, aligned to 16 bytes, like calloc(3).
+ *
+ * @return the address of the block or 0 if it could not be allocated
+ */
+extern Address memory_allocate(Size size);
+
+/**
+ * Changes the size of a block allocated by memory_allocate() like realloc(3). The bytes beyond
+ * the old size of the block are not cleared. If 'pointer' is 0 this is memory_allocate(size).
+ */
+extern Address memory_reallocate(Address pointer, Size size);
+
+/**
+ * Frees a block allocated by memory_allocate() or memory_reallocate(). A block that was allocated by
+ * malloc(3) is passed on to free(3).
+ *
+ * @return 0
+ */
+extern jint memory_deallocate(Address pointer);
+
+/**
+ * Gets the allocation statistics of the native allocator, indexed by the MEMORY_* statistic constants,
+ * or NULL if memory is allocated with the C library on this platform. The allocation and deallocation
+ * counts are accumulated per thread and added to these counters in batches, so they lag slightly behind.
+ */
+extern Size *memory_getStatistics(void);
+
+/**
+ * Copies a range of memory like memmove(3). Large copies that do not overlap are made with non-temporal
+ * stores so that they do not evict the working set of the thread from the caches.
+ */
+extern void memory_copy(Address dst, Address src, Size size);
+
 #endif /* MEMORY_H_ */
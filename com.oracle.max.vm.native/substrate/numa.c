@@ -21,9 +21,76 @@
  * libNUMA wrappers for Maxine VM
  */
 #include <numa.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
 
+#include "log.h"
 #include "vm.h"
 
+/*
+ * A snapshot of the NUMA topology. The queries below are answered from the current snapshot instead
+ * of calling libnuma each time. A snapshot is immutable once published: numaTopologyRefresh() (e.g.
+ * after CPUs have been hot plugged) builds a new one. Old snapshots are never freed as readers may
+ * still be using them and refreshes are rare.
+ */
+typedef struct {
+    jint cpus;
+    jint nodes;
+    jint pageSize;
+    jint *cpuToNode;        // [cpus]
+    jint *distances;        // [nodes * nodes], the distance from node i to node j is at i * nodes + j
+    jlong *memorySize;      // [nodes]
+    jlong *freeMemory;      // [nodes], when the snapshot was taken
+} NUMATopologyStruct, *NUMATopology;
+
+static NUMATopology volatile theNUMATopology;
+
+static NUMATopology buildTopology(void) {
+    NUMATopology topology = (NUMATopology) calloc(1, sizeof(NUMATopologyStruct));
+    if (topology == NULL) {
+        log_exit(1, "could not allocate NUMA topology");
+    }
+    jint cpus = numa_num_configured_cpus();
+    jint nodes = numa_max_node() + 1;
+    topology->cpus = cpus;
+    topology->nodes = nodes;
+    topology->pageSize = numa_pagesize();
+    topology->cpuToNode = (jint *) calloc(cpus, sizeof(jint));
+    topology->distances = (jint *) calloc(nodes * nodes, sizeof(jint));
+    topology->memorySize = (jlong *) calloc(nodes, sizeof(jlong));
+    topology->freeMemory = (jlong *) calloc(nodes, sizeof(jlong));
+    if (topology->cpuToNode == NULL || topology->distances == NULL || topology->memorySize == NULL || topology->freeMemory == NULL) {
+        log_exit(1, "could not allocate NUMA topology");
+    }
+    int i, j;
+    for (i = 0; i < cpus; i++) {
+        topology->cpuToNode[i] = numa_node_of_cpu(i);
+    }
+    for (i = 0; i < nodes; i++) {
+        for (j = 0; j < nodes; j++) {
+            topology->distances[i * nodes + j] = numa_distance(i, j);
+        }
+        long long freeMemory = 0;
+        topology->memorySize[i] = numa_node_size64(i, &freeMemory);
+        topology->freeMemory[i] = freeMemory;
+    }
+    return topology;
+}
+
+static NUMATopology topology(void) {
+    NUMATopology topology = __atomic_load_n(&theNUMATopology, __ATOMIC_ACQUIRE);
+    if (topology == NULL) {
+        topology = buildTopology();
+        if (!__sync_bool_compare_and_swap(&theNUMATopology, NULL, topology)) {
+            /* Another thread published a snapshot first. */
+            topology = __atomic_load_n(&theNUMATopology, __ATOMIC_ACQUIRE);
+        }
+    }
+    return topology;
+}
+
 int numalib_available() {
     return numa_available();
 }
@@ -35,14 +102,255 @@ int numaNodeOfAddress(jlong address) {
     return status;
 }
 
+/*
+ * Finds the nodes of the pages containing a batch of addresses with one system call. An entry of
+ * 'nodes' is a negative errno value (e.g. -EFAULT for a page that has not been touched yet) if the
+ * node of the corresponding address could not be found.
+ */
+void numaNodesOfAddresses(jlong *addresses, jint *nodes, jint count) {
+    c_ASSERT(sizeof(void *) == sizeof(jlong));
+    int i;
+    for (i = 0; i < count; i++) {
+        nodes[i] = -1;
+    }
+    if (count > 0) {
+        numa_move_pages(0, count, (void **) addresses, NULL, nodes, 0);
+    }
+}
+
 int numaConfiguredCPUs() {
-    return numa_num_configured_cpus();
+    return topology()->cpus;
 }
 
 int numaNodeOfCPU(int cpuID) {
-    return numa_node_of_cpu(cpuID);
+    NUMATopology t = topology();
+    if (cpuID < 0 || cpuID >= t->cpus) {
+        return -1;
+    }
+    return t->cpuToNode[cpuID];
 }
 
 int numaPageSize() {
-    return numa_pagesize();
-}
\ No newline at end of file
+    return topology()->pageSize;
+}
+
+/**
+ * Replaces the topology snapshot with a new one, e.g. after a CPU has been hot plugged or to get the current free memory of the nodes.
+ */
+void numaTopologyRefresh() {
+    NUMATopology topology = buildTopology();
+    /* Publish the snapshot only once it is complete. */
+    __atomic_store_n(&theNUMATopology, topology, __ATOMIC_RELEASE);
+}
+
+int numaTopologyNodes() {
+    return topology()->nodes;
+}
+
+/*
+ * The arrays of the current snapshot. These are valid for the lifetime of the process.
+ */
+jint *numaTopologyCPUToNode() {
+    return topology()->cpuToNode;
+}
+
+jint *numaTopologyDistances() {
+    return topology()->distances;
+}
+
+jlong *numaTopologyMemorySize() {
+    return topology()->memorySize;
+}
+
+jlong *numaTopologyFreeMemory() {
+    return topology()->freeMemory;
+}
+
+/*
+ * Allocation counters of the NUMA profiler (-XX:+NUMAProfilerCountersOnly). Every thread counts
+ * its allocations into its own shard, without locks or atomic read-modify-write instructions, and the
+ * shards are only merged when a report is requested. A shard is padded to a multiple of the cache line
+ * size so that threads never write to the same line. The shard of an exited thread keeps its counts
+ * and is reused by the next thread that starts.
+ *
+ * The counters of a shard are indexed by the node of the allocated object: the last index is for
+ * objects whose node is not known. The node of an object is found with numaNodeOfAddress() and
+ * remembered per page in a small cache in the shard, so a thread allocating sequentially in its TLAB
+ * makes one system call per page.
+ */
+
+#define NUMA_COUNTER_CACHE_LINE 64
+
+#define NUMA_COUNTER_LOCAL_COUNT   0
+#define NUMA_COUNTER_LOCAL_BYTES   1
+#define NUMA_COUNTER_REMOTE_COUNT  2
+#define NUMA_COUNTER_REMOTE_BYTES  3
+#define NUMA_COUNTERS_PER_NODE     4
+
+#define NUMA_PAGE_CACHE_SIZE 64
+
+typedef struct NUMACounterShardStruct *NUMACounterShard;
+
+struct NUMACounterShardStruct {
+    NUMACounterShard next;
+    volatile int inUse;
+    jint nodes;
+    jint epoch;
+    jlong cachedPages[NUMA_PAGE_CACHE_SIZE];
+    jint cachedNodes[NUMA_PAGE_CACHE_SIZE];
+    volatile jlong counters[];          // [(nodes + 1) * NUMA_COUNTERS_PER_NODE], only written by the owner
+};
+
+static NUMACounterShard volatile theNUMACounterShards;
+
+/* Incremented by numaCounters_reset() to invalidate the page caches of all shards. */
+static volatile jint theNUMACounterEpoch;
+
+/* The counts at the last numaCounters_reset(), subtracted from the merged counts. */
+static jlong *theNUMACounterBaseline;
+static jint theNUMACounterBaselineNodes;
+
+static pthread_key_t theNUMACounterShardKey;
+static pthread_once_t theNUMACounterShardKeyOnce = PTHREAD_ONCE_INIT;
+
+static __thread NUMACounterShard theCurrentNUMACounterShard;
+
+static void releaseNUMACounterShard(void *value) {
+    NUMACounterShard shard = (NUMACounterShard) value;
+    theCurrentNUMACounterShard = NULL;
+    __sync_synchronize();
+    shard->inUse = 0;
+}
+
+static void createNUMACounterShardKey(void) {
+    if (pthread_key_create(&theNUMACounterShardKey, releaseNUMACounterShard) != 0) {
+        log_exit(1, "could not create NUMA counter shard key");
+    }
+}
+
+static NUMACounterShard acquireNUMACounterShard(void) {
+    pthread_once(&theNUMACounterShardKeyOnce, createNUMACounterShardKey);
+    jint nodes = topology()->nodes;
+    NUMACounterShard shard;
+    for (shard = theNUMACounterShards; shard != NULL; shard = shard->next) {
+        if (shard->nodes == nodes && shard->inUse == 0 && __sync_bool_compare_and_swap(&shard->inUse, 0, 1)) {
+            break;
+        }
+    }
+    if (shard == NULL) {
+        size_t size = sizeof(struct NUMACounterShardStruct) + (nodes + 1) * NUMA_COUNTERS_PER_NODE * sizeof(jlong);
+        size = (size + NUMA_COUNTER_CACHE_LINE - 1) & ~((size_t) NUMA_COUNTER_CACHE_LINE - 1);
+        void *memory;
+        if (posix_memalign(&memory, NUMA_COUNTER_CACHE_LINE, size) != 0) {
+            log_exit(1, "could not allocate NUMA counter shard");
+        }
+        memset(memory, 0, size);
+        shard = (NUMACounterShard) memory;
+        shard->inUse = 1;
+        shard->nodes = nodes;
+        shard->epoch = theNUMACounterEpoch - 1;
+        NUMACounterShard head;
+        do {
+            head = theNUMACounterShards;
+            shard->next = head;
+        } while (!__sync_bool_compare_and_swap(&theNUMACounterShards, head, shard));
+    }
+    pthread_setspecific(theNUMACounterShardKey, shard);
+    theCurrentNUMACounterShard = shard;
+    return shard;
+}
+
+static jint nodeOfAllocation(NUMACounterShard shard, jlong address) {
+    jint epoch = theNUMACounterEpoch;
+    if (shard->epoch != epoch) {
+        memset(shard->cachedPages, 0, sizeof(shard->cachedPages));
+        shard->epoch = epoch;
+    }
+    jlong page = address & ~((jlong) topology()->pageSize - 1);
+    int index = (int) ((page / topology()->pageSize) % NUMA_PAGE_CACHE_SIZE);
+    if (shard->cachedPages[index] != page) {
+        jint node = numaNodeOfAddress(page);
+        if (node < 0) {
+            /* The page is not placed yet, do not remember that. */
+            return node;
+        }
+        shard->cachedPages[index] = page;
+        shard->cachedNodes[index] = node;
+    }
+    return shard->cachedNodes[index];
+}
+
+static inline void addNUMACounter(NUMACounterShard shard, int index, jlong delta) {
+    /* Only the owner writes a counter so no atomic read-modify-write is needed, but the store must not tear for merging readers. */
+    __atomic_store_n(&shard->counters[index], shard->counters[index] + delta, __ATOMIC_RELAXED);
+}
+
+/**
+ * Counts an allocation of 'size' bytes at 'address' by the current thread.
+ */
+void numaCounters_countAllocation(jlong address, jint size) {
+    NUMACounterShard shard = theCurrentNUMACounterShard;
+    if (shard == NULL) {
+        shard = acquireNUMACounterShard();
+    }
+    jint objectNode = nodeOfAllocation(shard, address);
+    jint threadNode = numaNodeOfCPU(sched_getcpu());
+    int base = (objectNode >= 0 && objectNode < shard->nodes ? objectNode : shard->nodes) * NUMA_COUNTERS_PER_NODE;
+    if (objectNode >= 0 && objectNode == threadNode) {
+        addNUMACounter(shard, base + NUMA_COUNTER_LOCAL_COUNT, 1);
+        addNUMACounter(shard, base + NUMA_COUNTER_LOCAL_BYTES, size);
+    } else {
+        addNUMACounter(shard, base + NUMA_COUNTER_REMOTE_COUNT, 1);
+        addNUMACounter(shard, base + NUMA_COUNTER_REMOTE_BYTES, size);
+    }
+}
+
+static void mergeNUMACounters(jlong *result, jint nodes) {
+    int length = (nodes + 1) * NUMA_COUNTERS_PER_NODE;
+    memset(result, 0, length * sizeof(jlong));
+    NUMACounterShard shard;
+    for (shard = theNUMACounterShards; shard != NULL; shard = shard->next) {
+        if (shard->nodes != nodes) {
+            continue;
+        }
+        int i;
+        for (i = 0; i < length; i++) {
+            result[i] += __atomic_load_n(&shard->counters[i], __ATOMIC_RELAXED);
+        }
+    }
+}
+
+/**
+ * Merges the counts of all the shards since the last numaCounters_reset() into 'result', which has
+ * (nodes + 1) * 4 elements: the local count, local bytes, remote count and remote bytes of each node
+ * followed by those of the objects whose node is not known.
+ */
+void numaCounters_merge(jlong *result, jint nodes) {
+    mergeNUMACounters(result, nodes);
+    if (theNUMACounterBaseline != NULL && theNUMACounterBaselineNodes == nodes) {
+        int i;
+        for (i = 0; i < (nodes + 1) * NUMA_COUNTERS_PER_NODE; i++) {
+            result[i] -= theNUMACounterBaseline[i];
+        }
+    }
+}
+
+/**
+ * Starts a new counting period. The shards are not cleared, as their owners may be writing to them, but
+ * the current counts become the baseline of numaCounters_merge(). This must not be called concurrently
+ * with numaCounters_merge().
+ */
+void numaCounters_reset() {
+    jint nodes = topology()->nodes;
+    if (theNUMACounterBaseline == NULL || theNUMACounterBaselineNodes != nodes) {
+        free(theNUMACounterBaseline);
+        theNUMACounterBaseline = (jlong *) calloc((nodes + 1) * NUMA_COUNTERS_PER_NODE, sizeof(jlong));
+        if (theNUMACounterBaseline == NULL) {
+            log_exit(1, "could not allocate NUMA counter baseline");
+        }
+        theNUMACounterBaselineNodes = nodes;
+    }
+    mergeNUMACounters(theNUMACounterBaseline, nodes);
+    /* Pages may be placed on other nodes after a GC. */
+    __sync_fetch_and_add(&theNUMACounterEpoch, 1);
+}
@@ -0,0 +1,479 @@
+/*
+ * Copyright (c) 2011, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ */
+#include "c.h"
+#include "os.h"
+#include "isa.h"
+#include "log.h"
+#include "maxine.h"
+#include "perfMap.h"
+
+#if os_LINUX
+#include <elf.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#include "condition.h"
+#include "mutex.h"
+
+#define BUFFER_SIZE (64 * 1024)
+
+/* The longest time a line or record stays in a buffer when more code is installed. */
+#define FLUSH_INTERVAL_NANOS (1000LL * 1000 * 1000)
+
+#define JITDUMP_MAGIC 0x4A695444
+#define JITDUMP_VERSION 1
+
+#define JIT_CODE_LOAD 0
+#define JIT_CODE_DEBUG_INFO 2
+
+typedef struct {
+    Unsigned4 magic;
+    Unsigned4 version;
+    Unsigned4 totalSize;
+    Unsigned4 elfMachine;
+    Unsigned4 pad;
+    Unsigned4 pid;
+    Unsigned8 timestamp;
+    Unsigned8 flags;
+} JitDumpHeaderStruct;
+
+typedef struct {
+    Unsigned4 id;
+    Unsigned4 totalSize;
+    Unsigned8 timestamp;
+} JitDumpRecordHeaderStruct;
+
+typedef struct {
+    JitDumpRecordHeaderStruct header;
+    Unsigned4 pid;
+    Unsigned4 tid;
+    Unsigned8 vma;
+    Unsigned8 codeAddress;
+    Unsigned8 codeSize;
+    Unsigned8 codeIndex;
+    /* followed by the NULL terminated name and the code */
+} JitDumpCodeLoadStruct;
+
+typedef struct {
+    JitDumpRecordHeaderStruct header;
+    Unsigned8 codeAddress;
+    Unsigned8 entries;
+    /* followed by the entries */
+} JitDumpDebugInfoStruct;
+
+typedef struct {
+    Unsigned8 address;
+    Unsigned4 line;
+    Unsigned4 discriminator;
+    /* followed by the NULL terminated file name */
+} JitDumpDebugEntryStruct;
+
+typedef struct Buffer {
+    struct Buffer *next;
+    Size used;
+    char data[BUFFER_SIZE];
+} BufferStruct, *Buffer;
+
+/*
+ * The lines or records of a file are appended to its current buffer, which is queued for the
+ * writer thread once full. The writes are thus never made by the threads installing code, which
+ * may be describing moved code during a GC. If the writer thread cannot be started, the queued
+ * buffers are written by the thread that queued them.
+ */
+typedef struct {
+    int fd;
+    boolean failed;
+    Buffer current;
+    Buffer head;
+    Buffer tail;
+} OutputStruct, *Output;
+
+static jint theMode;
+
+static pthread_once_t theOpenOnce = PTHREAD_ONCE_INIT;
+
+/* Protects the outputs, the free buffers and the code index. */
+static mutex_Struct theLock;
+
+/* Signals the writer that buffers are queued and the flushing threads that the writer is idle. */
+static condition_Struct theWriterCondition;
+
+static boolean theWriterStarted;
+
+static boolean theWriterBusy;
+
+static OutputStruct theMap;
+
+static OutputStruct theDump;
+
+static Buffer theFreeBuffers;
+
+static Unsigned8 theCodeIndex;
+
+static jlong theLastFlushNanos;
+
+void perfMap_setMode(jint mode, jboolean value) {
+    if (value) {
+        theMode |= mode;
+    } else {
+        theMode &= ~mode;
+    }
+}
+
+static Unsigned8 timestamp(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (Unsigned8) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static Unsigned4 elfMachine(void) {
+#if isa_AMD64
+    return EM_X86_64;
+#elif isa_AARCH64
+    return EM_AARCH64;
+#elif isa_ARM
+    return EM_ARM;
+#elif isa_RISCV64 && defined(EM_RISCV)
+    return EM_RISCV;
+#else
+    return EM_NONE;
+#endif
+}
+
+static void writeFully(int fd, const char *data, Size length) {
+    while (length > 0) {
+        ssize_t n = write(fd, data, length);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            log_println("perfMap: write failed: %s", strerror(errno));
+            return;
+        }
+        data += n;
+        length -= n;
+    }
+}
+
+/* Writes a list of buffers in order and returns its last buffer, or NULL if the list is empty. */
+static Buffer writeBuffers(int fd, Buffer buffers) {
+    Buffer last = NULL;
+    Buffer buffer;
+    for (buffer = buffers; buffer != NULL; buffer = buffer->next) {
+        writeFully(fd, buffer->data, buffer->used);
+        last = buffer;
+    }
+    return last;
+}
+
+/* Puts written buffers on the free list. Called with theLock held. */
+static void recycle(Buffer buffers, Buffer last) {
+    if (last != NULL) {
+        last->next = theFreeBuffers;
+        theFreeBuffers = buffers;
+    }
+}
+
+/* Queues the buffer being filled, if any, for the writer. Called with theLock held. */
+static void submit(Output output) {
+    Buffer buffer = output->current;
+    if (buffer == NULL || buffer->used == 0) {
+        return;
+    }
+    output->current = NULL;
+    buffer->next = NULL;
+    if (output->tail == NULL) {
+        output->head = buffer;
+    } else {
+        output->tail->next = buffer;
+    }
+    output->tail = buffer;
+}
+
+/* Hands the queued buffers over to the writer, or writes them if there is no writer. Called with theLock held. */
+static void release(void) {
+    if (theMap.head == NULL && theDump.head == NULL) {
+        return;
+    }
+    if (theWriterStarted) {
+        condition_notifyAll(&theWriterCondition);
+        return;
+    }
+    recycle(theMap.head, writeBuffers(theMap.fd, theMap.head));
+    recycle(theDump.head, writeBuffers(theDump.fd, theDump.head));
+    theMap.head = theMap.tail = NULL;
+    theDump.head = theDump.tail = NULL;
+}
+
+/* Appends data to the current buffer of an output, queuing the buffers it fills. Called with theLock held. */
+static void append(Output output, const void *data, Size length) {
+    const char *p = (const char *) data;
+    if (output->fd < 0 || output->failed) {
+        return;
+    }
+    while (length > 0) {
+        Buffer buffer = output->current;
+        if (buffer == NULL) {
+            buffer = theFreeBuffers;
+            if (buffer != NULL) {
+                theFreeBuffers = buffer->next;
+            } else if ((buffer = (Buffer) malloc(sizeof(BufferStruct))) == NULL) {
+                /* A partial line or record would make the rest of the file unreadable. */
+                log_println("perfMap: could not allocate a buffer, no more code is described");
+                output->failed = true;
+                return;
+            }
+            buffer->used = 0;
+            output->current = buffer;
+        }
+        Size n = BUFFER_SIZE - buffer->used;
+        if (n > length) {
+            n = length;
+        }
+        memcpy(buffer->data + buffer->used, p, n);
+        buffer->used += n;
+        p += n;
+        length -= n;
+        if (buffer->used == BUFFER_SIZE) {
+            submit(output);
+        }
+    }
+}
+
+static void *runWriter(void *arg) {
+    mutex_enter(&theLock);
+    for (;;) {
+        while (theMap.head == NULL && theDump.head == NULL) {
+            theWriterBusy = false;
+            condition_notifyAll(&theWriterCondition);
+            condition_wait(&theWriterCondition, &theLock);
+        }
+        theWriterBusy = true;
+        Buffer map = theMap.head;
+        Buffer dump = theDump.head;
+        theMap.head = theMap.tail = NULL;
+        theDump.head = theDump.tail = NULL;
+        mutex_exit(&theLock);
+        Buffer lastMap = writeBuffers(theMap.fd, map);
+        Buffer lastDump = writeBuffers(theDump.fd, dump);
+        mutex_enter(&theLock);
+        recycle(map, lastMap);
+        recycle(dump, lastDump);
+    }
+    return NULL;
+}
+
+/*
+ * Starts the writer thread. All signals are blocked in the thread so that it never handles
+ * signals meant for VM threads.
+ */
+static void startWriter(void) {
+    pthread_t thread;
+    pthread_attr_t attr;
+    sigset_t all, saved;
+    condition_initialize(&theWriterCondition);
+    sigfillset(&all);
+    pthread_sigmask(SIG_SETMASK, &all, &saved);
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    if (pthread_create(&thread, &attr, runWriter, NULL) == 0) {
+        theWriterStarted = true;
+    } else {
+        log_println("perfMap: could not start the writer thread, writing synchronously");
+    }
+    pthread_attr_destroy(&attr);
+    pthread_sigmask(SIG_SETMASK, &saved, NULL);
+}
+
+static int create(const char *format) {
+    char path[MAX_PATH_LENGTH];
+    snprintf(path, sizeof(path), format, (int) getpid());
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        log_println("perfMap: could not create %s: %s", path, strerror(errno));
+    }
+    return fd;
+}
+
+static void openFiles(void) {
+    mutex_initialize(&theLock);
+    theLastFlushNanos = native_nanoTime();
+    theMap.fd = -1;
+    theDump.fd = -1;
+    if (theMode & PERF_MAP_ENABLED) {
+        theMap.fd = create("/tmp/perf-%d.map");
+    }
+    if (theMode & PERF_MAP_JIT_DUMP) {
+        int fd = create("/tmp/jit-%d.dump");
+        if (fd < 0) {
+            return;
+        }
+        /* perf record finds the jitdump file of a process by this executable mapping of it. */
+        if (mmap(NULL, sysconf(_SC_PAGESIZE), PROT_READ | PROT_EXEC, MAP_PRIVATE, fd, 0) == MAP_FAILED) {
+            log_println("perfMap: could not map the jitdump file: %s", strerror(errno));
+            close(fd);
+            return;
+        }
+        theDump.fd = fd;
+        JitDumpHeaderStruct header;
+        memset(&header, 0, sizeof(header));
+        header.magic = JITDUMP_MAGIC;
+        header.version = JITDUMP_VERSION;
+        header.totalSize = sizeof(header);
+        header.elfMachine = elfMachine();
+        header.pid = getpid();
+        header.timestamp = timestamp();
+        append(&theDump, &header, sizeof(header));
+    }
+    if (theMap.fd >= 0 || theDump.fd >= 0) {
+        startWriter();
+    }
+}
+
+static void appendDebugInfo(Address code, PerfMapLine lines, int lineCount, const char *fileName, Unsigned8 now) {
+    Size fileNameLength = strlen(fileName) + 1;
+    int entries = 0;
+    int i;
+    for (i = 0; i < lineCount; i++) {
+        if (lines[i].line > 0) {
+            entries++;
+        }
+    }
+    if (entries == 0) {
+        return;
+    }
+    JitDumpDebugInfoStruct record;
+    record.header.id = JIT_CODE_DEBUG_INFO;
+    record.header.totalSize = sizeof(record) + entries * (sizeof(JitDumpDebugEntryStruct) + fileNameLength);
+    record.header.timestamp = now;
+    record.codeAddress = code;
+    record.entries = entries;
+    append(&theDump, &record, sizeof(record));
+    for (i = 0; i < lineCount; i++) {
+        if (lines[i].line > 0) {
+            JitDumpDebugEntryStruct entry;
+            entry.address = code + lines[i].offset;
+            entry.line = lines[i].line;
+            entry.discriminator = 0;
+            append(&theDump, &entry, sizeof(entry));
+            append(&theDump, fileName, fileNameLength);
+        }
+    }
+}
+
+void perfMap_codeLoaded(Address code, Size size, const char *name, PerfMapLine lines, int lineCount, const char *fileName) {
+    if (theMode == 0 || size == 0) {
+        return;
+    }
+    pthread_once(&theOpenOnce, openFiles);
+    mutex_enter(&theLock);
+    if (theMap.fd >= 0) {
+        char line[64];
+        int length = snprintf(line, sizeof(line), "%lx %lx ", (unsigned long) code, (unsigned long) size);
+        append(&theMap, line, length);
+        append(&theMap, name, strlen(name));
+        append(&theMap, "\n", 1);
+    }
+    if (theDump.fd >= 0) {
+        Unsigned8 now = timestamp();
+        /* The debug information of a method precedes its code load record. */
+        if (lines != NULL && fileName != NULL) {
+            appendDebugInfo(code, lines, lineCount, fileName, now);
+        }
+        Size nameLength = strlen(name) + 1;
+        JitDumpCodeLoadStruct record;
+        record.header.id = JIT_CODE_LOAD;
+        record.header.totalSize = sizeof(record) + nameLength + size;
+        record.header.timestamp = now;
+        record.pid = getpid();
+        record.tid = (Unsigned4) syscall(__NR_gettid);
+        record.vma = code;
+        record.codeAddress = code;
+        record.codeSize = size;
+        record.codeIndex = theCodeIndex++;
+        append(&theDump, &record, sizeof(record));
+        append(&theDump, name, nameLength);
+        append(&theDump, (const void *) code, size);
+    }
+    jlong nanos = native_nanoTime();
+    if (nanos - theLastFlushNanos > FLUSH_INTERVAL_NANOS) {
+        submit(&theMap);
+        submit(&theDump);
+        theLastFlushNanos = nanos;
+    }
+    release();
+    mutex_exit(&theLock);
+}
+
+void perfMap_flush(void) {
+    if (theMode == 0) {
+        return;
+    }
+    pthread_once(&theOpenOnce, openFiles);
+    mutex_enter(&theLock);
+    submit(&theMap);
+    submit(&theDump);
+    release();
+    if (theWriterStarted) {
+        while (theMap.head != NULL || theDump.head != NULL || theWriterBusy) {
+            condition_wait(&theWriterCondition, &theLock);
+        }
+    }
+    mutex_exit(&theLock);
+}
+
+#else
+
+void perfMap_setMode(jint mode, jboolean value) {
+}
+
+void perfMap_codeLoaded(Address code, Size size, const char *name, PerfMapLine lines, int lineCount, const char *fileName) {
+}
+
+void perfMap_flush(void) {
+}
+
+#endif
+
+JNIEXPORT jint JNICALL
+Java_com_sun_max_vm_code_PerfMap_nativeMode(JNIEnv *env, jclass c) {
+#if os_LINUX
+    return theMode;
+#else
+    return 0;
+#endif
+}
+
+JNIEXPORT void JNICALL
+Java_com_sun_max_vm_code_PerfMap_nativeCodeLoaded(JNIEnv *env, jclass c, Address code, jint size, Address name, Address lines, jint lineCount, Address fileName) {
+    perfMap_codeLoaded(code, (Size) size, (const char *) name, (PerfMapLine) lines, lineCount, (const char *) fileName);
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2011, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ */
+#ifndef __perfMap_h__
+#define __perfMap_h__ 1
+
+#include "word.h"
+#include "jni.h"
+
+/*
+ * Descriptions of compiled code for the Linux perf tools (-XX:+PerfMap and -XX:+JitDump).
+ *
+ * With -XX:+PerfMap, a line '<start> <size> <name>' is appended to /tmp/perf-<pid>.map for every
+ * method in the boot image and every method installed at run time, which is the file perf report
+ * consults for addresses that are not in a mapped ELF file. With -XX:+JitDump, the methods are also
+ * recorded with their code and source line numbers in /tmp/jit-<pid>.dump in the jitdump format
+ * (see tools/perf/Documentation/jitdump-specification.txt in the Linux sources), which 'perf inject
+ * --jit' turns into ELF files so that perf annotate can show the code. The timestamps in the jitdump
+ * file are from CLOCK_MONOTONIC, so the profile must be recorded with 'perf record -k mono'.
+ *
+ * The lines and records are buffered and handed over to a native writer thread when a buffer is
+ * full, when the last hand-over is more than a second old and when the VM exits, so that no write
+ * is made by a thread installing code (perfMap_codeLoaded() is called without leaving Java code).
+ */
+
+#define PERF_MAP_ENABLED 1
+#define PERF_MAP_JIT_DUMP 2
+
+/**
+ * Selects the descriptions written. This is called while the VM options are parsed.
+ *
+ * @param mode PERF_MAP_ENABLED, PERF_MAP_JIT_DUMP or both
+ * @param value specifies if the descriptions selected by 'mode' are to be written
+ */
+extern void perfMap_setMode(jint mode, jboolean value);
+
+/**
+ * An entry of the line table given to perfMap_codeLoaded().
+ */
+typedef struct {
+    Unsigned4 offset; /* the offset of an instruction from the start of the code */
+    Signed4 line;     /* the source line number of the instruction */
+} PerfMapLineStruct, *PerfMapLine;
+
+/**
+ * Describes a block of code that has been installed.
+ *
+ * @param name the name of the code as a NULL terminated UTF8 string
+ * @param lines the line table of the code or NULL (only used for the jitdump file)
+ * @param fileName the name of the source file the line numbers refer to or NULL
+ */
+extern void perfMap_codeLoaded(Address code, Size size, const char *name, PerfMapLine lines, int lineCount, const char *fileName);
+
+/**
+ * Writes the buffered lines and records. This is called when the VM exits.
+ */
+extern void perfMap_flush(void);
+
+#endif /*__perfMap_h__*/
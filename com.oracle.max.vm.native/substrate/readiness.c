@@ -0,0 +1,292 @@
+/*
+ * Copyright (c) 2011, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ */
+#include "os.h"
+#include "log.h"
+#include "maxine.h"
+#include "readiness.h"
+
+#if os_LINUX || os_DARWIN
+#include <errno.h>
+#include <limits.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "condition.h"
+#include "mutex.h"
+
+#if os_LINUX
+#include <sys/epoll.h>
+#else
+#include <sys/types.h>
+#include <sys/event.h>
+#include <sys/time.h>
+#endif
+
+#define WAITER_BUCKETS 256
+
+#define POLLER_EVENTS 64
+
+typedef struct WaiterStruct {
+    int fd;
+    /* 0 while waiting, then the result of readiness_waitReadable(). */
+    int result;
+    int error;
+    condition_Struct condition;
+    struct WaiterStruct *next;
+} WaiterStruct, *Waiter;
+
+static jboolean enabled;
+
+static pthread_once_t theInitializeOnce = PTHREAD_ONCE_INIT;
+
+/* The epoll or kqueue file descriptor, or -1 if the poller could not be started. */
+static int thePollFd = -1;
+
+/* Protects the waiter lists. The conditions of all waiters are used with this mutex. */
+static mutex_Struct theLock;
+
+static Waiter theWaiters[WAITER_BUCKETS];
+
+void readiness_setEnabled(jboolean value) {
+    enabled = value;
+}
+
+static jlong millisToNanos(jlong millis) {
+    return millis * 1000 * 1000;
+}
+
+/*
+ * The synchronous path: poll() restarted after a signal with the remaining time measured by the monotonic clock.
+ */
+static jint pollReadable(jint fd, jlong timeoutMillis) {
+    jlong deadline = timeoutMillis < 0 ? 0 : native_nanoTime() + millisToNanos(timeoutMillis);
+    for (;;) {
+        struct pollfd pfd;
+        pfd.fd = fd;
+        pfd.events = POLLIN | POLLERR;
+        int timeout = timeoutMillis < 0 ? -1 : (timeoutMillis > INT_MAX ? INT_MAX : (int) timeoutMillis);
+        int result = poll(&pfd, 1, timeout);
+        if (result != -1 || errno != EINTR) {
+            return result;
+        }
+        if (timeoutMillis >= 0) {
+            jlong remaining = deadline - native_nanoTime();
+            if (remaining <= 0) {
+                return 0;
+            }
+            timeoutMillis = (remaining + 999999) / 1000000;
+        }
+    }
+}
+
+static Waiter *bucket(int fd) {
+    return &theWaiters[((unsigned) fd) % WAITER_BUCKETS];
+}
+
+/*
+ * Removes the waiters for a given file descriptor from their list and wakes them with a given result.
+ * The caller holds the lock.
+ */
+static void wakeWaiters(int fd, int result, int error) {
+    Waiter *link = bucket(fd);
+    while (*link != NULL) {
+        Waiter waiter = *link;
+        if (waiter->fd == fd) {
+            *link = waiter->next;
+            waiter->result = result;
+            waiter->error = error;
+            condition_notify(&waiter->condition);
+        } else {
+            link = &waiter->next;
+        }
+    }
+}
+
+static void *poll_run(void *arg) {
+#if os_LINUX
+    struct epoll_event events[POLLER_EVENTS];
+#else
+    struct kevent events[POLLER_EVENTS];
+#endif
+    for (;;) {
+#if os_LINUX
+        int n = epoll_wait(thePollFd, events, POLLER_EVENTS, -1);
+#else
+        int n = kevent(thePollFd, NULL, 0, events, POLLER_EVENTS, NULL);
+#endif
+        if (n < 0) {
+            if (errno != EINTR) {
+                log_println("readiness: poller failed: %s", strerror(errno));
+                return NULL;
+            }
+            continue;
+        }
+        mutex_enter(&theLock);
+        int i;
+        for (i = 0; i < n; i++) {
+#if os_LINUX
+            wakeWaiters(events[i].data.fd, 1, 0);
+#else
+            wakeWaiters((int) events[i].ident, 1, 0);
+#endif
+        }
+        mutex_exit(&theLock);
+    }
+    return NULL;
+}
+
+static void initialize(void) {
+    mutex_initialize(&theLock);
+#if os_LINUX
+    int fd = epoll_create1(EPOLL_CLOEXEC);
+#else
+    int fd = kqueue();
+#endif
+    if (fd < 0) {
+        log_println("readiness: could not create the poller: %s", strerror(errno));
+        return;
+    }
+    /* The poller thread blocks all signals so that it is never chosen to handle one. */
+    sigset_t all, saved;
+    sigfillset(&all);
+    pthread_sigmask(SIG_SETMASK, &all, &saved);
+    pthread_attr_t attributes;
+    pthread_attr_init(&attributes);
+    pthread_attr_setdetachstate(&attributes, PTHREAD_CREATE_DETACHED);
+    pthread_t thread;
+    thePollFd = fd;
+    int error = pthread_create(&thread, &attributes, poll_run, NULL);
+    pthread_attr_destroy(&attributes);
+    pthread_sigmask(SIG_SETMASK, &saved, NULL);
+    if (error != 0) {
+        log_println("readiness: could not start the poller thread: %s", strerror(error));
+        close(fd);
+        thePollFd = -1;
+    }
+}
+
+/*
+ * Arms a one-shot readability event for a file descriptor.
+ */
+static int arm(int fd) {
+#if os_LINUX
+    struct epoll_event event;
+    event.events = EPOLLIN | EPOLLERR | EPOLLHUP | EPOLLONESHOT;
+    event.data.u64 = 0;
+    event.data.fd = fd;
+    if (epoll_ctl(thePollFd, EPOLL_CTL_MOD, fd, &event) == 0) {
+        return 0;
+    }
+    if (errno != ENOENT) {
+        return -1;
+    }
+    return epoll_ctl(thePollFd, EPOLL_CTL_ADD, fd, &event);
+#else
+    struct kevent event;
+    EV_SET(&event, fd, EVFILT_READ, EV_ADD | EV_ONESHOT, 0, 0, NULL);
+    return kevent(thePollFd, &event, 1, NULL, 0, NULL);
+#endif
+}
+
+jint readiness_waitReadable(jint fd, jlong timeoutMillis) {
+    if (!enabled || fd < 0) {
+        return pollReadable(fd, timeoutMillis);
+    }
+    pthread_once(&theInitializeOnce, initialize);
+    if (thePollFd < 0) {
+        return pollReadable(fd, timeoutMillis);
+    }
+    jlong deadline = timeoutMillis < 0 ? 0 : native_nanoTime() + millisToNanos(timeoutMillis);
+
+    WaiterStruct waiter;
+    waiter.fd = fd;
+    waiter.result = 0;
+    waiter.error = 0;
+    condition_initialize(&waiter.condition);
+
+    mutex_enter(&theLock);
+    /* The event is armed by the first waiter for the file descriptor and disarmed when it fires. */
+    jboolean mustArm = true;
+    Waiter *list = bucket(fd);
+    Waiter w;
+    for (w = *list; w != NULL; w = w->next) {
+        if (w->fd == fd) {
+            mustArm = false;
+            break;
+        }
+    }
+    waiter.next = *list;
+    *list = &waiter;
+    mutex_exit(&theLock);
+
+    if (mustArm && arm(fd) != 0) {
+        int error = errno;
+        mutex_enter(&theLock);
+        /* epoll rejects regular files (EPERM), which poll() always reports to be readable. */
+        wakeWaiters(fd, error == EPERM ? 1 : -1, error);
+        mutex_exit(&theLock);
+    }
+
+    mutex_enter(&theLock);
+    while (waiter.result == 0) {
+        if (timeoutMillis < 0) {
+            condition_wait(&waiter.condition, &theLock);
+        } else {
+            jlong remaining = deadline - native_nanoTime();
+            if (remaining <= 0) {
+                break;
+            }
+            condition_timedWait(&waiter.condition, &theLock, (Unsigned8) ((remaining + 999999) / 1000000));
+        }
+    }
+    if (waiter.result == 0) {
+        /* Timed out: the event stays armed and finds no waiter when it fires. */
+        Waiter *link = list;
+        while (*link != &waiter) {
+            link = &(*link)->next;
+        }
+        *link = waiter.next;
+    }
+    mutex_exit(&theLock);
+    condition_destroy(&waiter.condition);
+
+    if (waiter.result < 0) {
+        errno = waiter.error;
+    }
+    return waiter.result;
+}
+
+#else
+
+void readiness_setEnabled(jboolean value) {
+}
+
+jint readiness_waitReadable(jint fd, jlong timeoutMillis) {
+    log_exit(1, "readiness_waitReadable is not implemented on this platform");
+    return -1;
+}
+
+#endif
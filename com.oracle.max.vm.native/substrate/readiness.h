@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2011, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ */
+#ifndef __readiness_h__
+#define __readiness_h__ 1
+
+#include "word.h"
+#include "jni.h"
+
+/*
+ * Event driven file descriptor readiness (-XX:+SocketPoller).
+ *
+ * A thread waiting for a file descriptor to become readable registers its interest with a single
+ * epoll (Linux) or kqueue (Darwin) instance and parks on a condition variable. One poller thread
+ * waits for the events of all registered file descriptors and wakes the threads waiting for them.
+ * With many threads blocked in socket reads with a timeout, this replaces a poll() per waiting
+ * thread (restarted after every signal) with one epoll_wait() for all of them, and the timeouts
+ * are measured by the monotonic clock of the condition variables.
+ */
+
+/**
+ * Selects whether readiness_waitReadable() uses the poller thread. This must be called before the first wait.
+ */
+extern void readiness_setEnabled(jboolean value);
+
+/**
+ * Waits for a file descriptor to become readable or to report an error.
+ *
+ * @param timeoutMillis the maximum time to wait, or a negative value to wait forever
+ * @return 1 if the file descriptor is ready, 0 if the wait timed out or -1 (with errno set) on error
+ */
+extern jint readiness_waitReadable(jint fd, jlong timeoutMillis);
+
+#endif /*__readiness_h__*/
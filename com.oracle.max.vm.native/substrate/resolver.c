@@ -0,0 +1,452 @@
+/*
+ * Copyright (c) 2011, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ */
+#include "os.h"
+#include "log.h"
+#include "maxine.h"
+#include "resolver.h"
+
+#if os_LINUX || os_DARWIN || os_SOLARIS
+#include <ctype.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+
+#include "condition.h"
+#include "mutex.h"
+
+#define CACHE_BUCKETS 256
+
+/* The most entries kept; beyond this, results are still shared while in flight but not cached. */
+#define CACHE_MAX_ENTRIES 4096
+
+#define MAX_KEY_LENGTH 256
+
+#define NANOS_PER_SECOND ((jlong) 1000 * 1000 * 1000)
+
+typedef enum {
+    /* The IPv4 addresses of a name. */
+    LOOKUP_NAME,
+    /* The IPv4 and IPv6 addresses of a name. */
+    LOOKUP_NAME_ANY,
+    LOOKUP_ADDRESS
+} LookupKind;
+
+typedef struct EntryStruct {
+    LookupKind kind;
+    /* The lower-cased host name or the numeric address. */
+    char key[MAX_KEY_LENGTH];
+    /* The address to look up, for LOOKUP_ADDRESS. */
+    unsigned char address[16];
+    int addressLength;
+    int family;
+
+    /* True while a thread is running the lookup for the entry. */
+    jboolean pending;
+    /* Notified when the lookup for the entry completes. */
+    condition_Struct resolved;
+    /* The native_nanoTime() after which the result is stale. */
+    jlong expires;
+    /* The number of threads waiting for or copying the result. */
+    int users;
+
+    int addressCount;
+    ResolverAddressStruct addresses[RESOLVER_MAX_ADDRESSES];
+    /* The canonical name of a name lookup or the name of a LOOKUP_ADDRESS, "" if the lookup failed. */
+    char name[NI_MAXHOST];
+
+    struct EntryStruct *next;
+} EntryStruct, *Entry;
+
+static jlong timeToLive = 30 * NANOS_PER_SECOND;
+static jlong negativeTimeToLive = 10 * NANOS_PER_SECOND;
+
+static pthread_once_t theInitializeOnce = PTHREAD_ONCE_INIT;
+
+/* Protects the cache. It is never held while a lookup runs. */
+static mutex_Struct theLock;
+
+static Entry theCache[CACHE_BUCKETS];
+static int theEntryCount;
+
+static jlong secondsToNanos(jint seconds) {
+    return seconds < 0 ? -1 : seconds * NANOS_PER_SECOND;
+}
+
+void resolver_setTimeToLive(jint seconds) {
+    timeToLive = secondsToNanos(seconds);
+}
+
+void resolver_setNegativeTimeToLive(jint seconds) {
+    negativeTimeToLive = secondsToNanos(seconds);
+}
+
+static void initialize(void) {
+    mutex_initialize(&theLock);
+}
+
+static void freeEntry(Entry e) {
+    condition_destroy(&e->resolved);
+    free(e);
+}
+
+static unsigned int hash(LookupKind kind, const char *key) {
+    unsigned int h = kind;
+    while (*key != '\0') {
+        h = h * 31 + (unsigned char) *key++;
+    }
+    return h % CACHE_BUCKETS;
+}
+
+static Entry find(LookupKind kind, const char *key) {
+    Entry e;
+    for (e = theCache[hash(kind, key)]; e != NULL; e = e->next) {
+        if (e->kind == kind && strcmp(e->key, key) == 0) {
+            return e;
+        }
+    }
+    return NULL;
+}
+
+static jboolean isEvictable(Entry e, jlong now) {
+    return !e->pending && e->users == 0 && (e->expires - now) <= 0;
+}
+
+static void removeEntry(Entry entry) {
+    Entry *link = &theCache[hash(entry->kind, entry->key)];
+    while (*link != entry) {
+        link = &(*link)->next;
+    }
+    *link = entry->next;
+    theEntryCount--;
+}
+
+/*
+ * Frees the stale entries that no thread is using. The caller must hold theLock.
+ */
+static void evictStale(jlong now) {
+    int b;
+    for (b = 0; b < CACHE_BUCKETS; b++) {
+        Entry *link = &theCache[b];
+        while (*link != NULL) {
+            Entry e = *link;
+            if (isEvictable(e, now)) {
+                *link = e->next;
+                theEntryCount--;
+                freeEntry(e);
+            } else {
+                link = &e->next;
+            }
+        }
+    }
+}
+
+/*
+ * Runs the lookup for an entry. This is called without holding theLock; the entry stays allocated
+ * because it is pending.
+ */
+static void perform(Entry e, int *addressCount, ResolverAddress addresses, char *name) {
+    *addressCount = 0;
+    name[0] = '\0';
+    if (e->kind != LOOKUP_ADDRESS) {
+        struct addrinfo hints;
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family = e->kind == LOOKUP_NAME ? AF_INET : AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_flags = AI_CANONNAME;
+        struct addrinfo *result = NULL;
+        if (getaddrinfo(e->key, NULL, &hints, &result) != 0) {
+            return;
+        }
+        struct addrinfo *ai;
+        for (ai = result; ai != NULL && *addressCount < RESOLVER_MAX_ADDRESSES; ai = ai->ai_next) {
+            ResolverAddressStruct address;
+            if (ai->ai_family == AF_INET) {
+                address.length = 4;
+                memcpy(address.bytes, &((struct sockaddr_in *) ai->ai_addr)->sin_addr, 4);
+            } else if (ai->ai_family == AF_INET6) {
+                address.length = 16;
+                memcpy(address.bytes, &((struct sockaddr_in6 *) ai->ai_addr)->sin6_addr, 16);
+            } else {
+                continue;
+            }
+            int i;
+            for (i = 0; i < *addressCount; i++) {
+                if (addresses[i].length == address.length && memcmp(addresses[i].bytes, address.bytes, address.length) == 0) {
+                    break;
+                }
+            }
+            if (i == *addressCount) {
+                addresses[(*addressCount)++] = address;
+            }
+        }
+        const char *canonicalName = result != NULL && result->ai_canonname != NULL ? result->ai_canonname : e->key;
+        strncpy(name, canonicalName, NI_MAXHOST - 1);
+        name[NI_MAXHOST - 1] = '\0';
+        freeaddrinfo(result);
+    } else {
+        struct sockaddr_storage storage;
+        socklen_t length;
+        memset(&storage, 0, sizeof(storage));
+        if (e->family == AF_INET) {
+            struct sockaddr_in *sin = (struct sockaddr_in *) &storage;
+            sin->sin_family = AF_INET;
+            memcpy(&sin->sin_addr, e->address, sizeof(sin->sin_addr));
+            length = sizeof(struct sockaddr_in);
+        } else {
+            struct sockaddr_in6 *sin6 = (struct sockaddr_in6 *) &storage;
+            sin6->sin6_family = AF_INET6;
+            memcpy(&sin6->sin6_addr, e->address, sizeof(sin6->sin6_addr));
+            length = sizeof(struct sockaddr_in6);
+        }
+        if (getnameinfo((struct sockaddr *) &storage, length, name, NI_MAXHOST, NULL, 0, NI_NAMEREQD) != 0) {
+            name[0] = '\0';
+        }
+    }
+}
+
+/*
+ * Stores the result of a lookup in its entry and wakes the threads waiting for it. The caller must hold theLock.
+ */
+static void publish(Entry e, int addressCount, const ResolverAddressStruct *addresses, const char *name) {
+    e->addressCount = addressCount;
+    memcpy(e->addresses, addresses, addressCount * sizeof(ResolverAddressStruct));
+    strcpy(e->name, name);
+    jboolean resolved = e->kind != LOOKUP_ADDRESS ? addressCount > 0 : name[0] != '\0';
+    jlong ttl = resolved ? timeToLive : negativeTimeToLive;
+    jlong now = native_nanoTime();
+    /* A negative time to live caches forever. */
+    e->expires = ttl < 0 ? now + ((jlong) 1 << 62) : now + ttl;
+    e->pending = false;
+    condition_notifyAll(&e->resolved);
+}
+
+/*
+ * Gets the entry for a lookup, waiting for the lookup if its result is not cached. The caller must
+ * hold theLock and release the entry with release().
+ */
+static Entry acquire(LookupKind kind, const char *key, const void *address, int addressLength, int family) {
+    jlong now = native_nanoTime();
+    Entry e = find(kind, key);
+    if (e == NULL) {
+        if (theEntryCount >= CACHE_MAX_ENTRIES) {
+            evictStale(now);
+        }
+        e = (Entry) calloc(1, sizeof(EntryStruct));
+        if (e == NULL) {
+            return NULL;
+        }
+        e->kind = kind;
+        strcpy(e->key, key);
+        if (address != NULL) {
+            memcpy(e->address, address, addressLength);
+        }
+        e->addressLength = addressLength;
+        e->family = family;
+        condition_initialize(&e->resolved);
+        unsigned int b = hash(kind, key);
+        e->next = theCache[b];
+        theCache[b] = e;
+        theEntryCount++;
+        e->expires = now;
+    }
+    e->users++;
+    if (!e->pending && (e->expires - now) <= 0) {
+        /*
+         * The calling thread runs the lookup itself, without holding theLock, so that lookups of different
+         * entries run concurrently and only the threads wanting this entry wait for it.
+         */
+        ResolverAddressStruct addresses[RESOLVER_MAX_ADDRESSES];
+        char name[NI_MAXHOST];
+        int addressCount;
+        e->pending = true;
+        mutex_exit(&theLock);
+        perform(e, &addressCount, addresses, name);
+        mutex_enter(&theLock);
+        publish(e, addressCount, addresses, name);
+    }
+    while (e->pending) {
+        condition_wait(&e->resolved, &theLock);
+    }
+    return e;
+}
+
+static void release(Entry e) {
+    e->users--;
+    if (theEntryCount > CACHE_MAX_ENTRIES && !e->pending && e->users == 0) {
+        /* Over the limit: the result was only kept for the threads that shared the lookup. */
+        removeEntry(e);
+        freeEntry(e);
+    }
+}
+
+static int lookupName(LookupKind kind, const char *name, ResolverAddress addresses, char *canonicalName, size_t canonicalNameLength) {
+    char key[MAX_KEY_LENGTH];
+    size_t i;
+    for (i = 0; name[i] != '\0'; i++) {
+        if (i == MAX_KEY_LENGTH - 1) {
+            /* Longer than any valid host name. */
+            return 0;
+        }
+        key[i] = tolower((unsigned char) name[i]);
+    }
+    key[i] = '\0';
+
+    pthread_once(&theInitializeOnce, initialize);
+    mutex_enter(&theLock);
+    Entry e = acquire(kind, key, NULL, 0, kind == LOOKUP_NAME ? AF_INET : AF_UNSPEC);
+    int result = 0;
+    if (e != NULL) {
+        result = e->addressCount;
+        memcpy(addresses, e->addresses, result * sizeof(ResolverAddressStruct));
+        if (canonicalNameLength > 0) {
+            strncpy(canonicalName, e->name, canonicalNameLength - 1);
+            canonicalName[canonicalNameLength - 1] = '\0';
+        }
+        release(e);
+    }
+    mutex_exit(&theLock);
+    return result;
+}
+
+int resolver_lookupName(const char *name, Unsigned4 *addresses, char *canonicalName, size_t canonicalNameLength) {
+    ResolverAddressStruct found[RESOLVER_MAX_ADDRESSES];
+    int result = lookupName(LOOKUP_NAME, name, found, canonicalName, canonicalNameLength);
+    int i;
+    for (i = 0; i < result; i++) {
+        memcpy(&addresses[i], found[i].bytes, sizeof(Unsigned4));
+    }
+    return result;
+}
+
+int resolver_lookupAllAddresses(const char *name, ResolverAddress addresses) {
+    return lookupName(LOOKUP_NAME_ANY, name, addresses, NULL, 0);
+}
+
+jboolean resolver_lookupAddress(const void *address, int length, int family, char *name, size_t nameLength) {
+    if (!((family == AF_INET && length == 4) || (family == AF_INET6 && length == 16))) {
+        return false;
+    }
+    /* The key is the address in hexadecimal. */
+    char key[MAX_KEY_LENGTH];
+    int i;
+    for (i = 0; i < length; i++) {
+        static const char digits[] = "0123456789abcdef";
+        key[2 * i] = digits[((const unsigned char *) address)[i] >> 4];
+        key[2 * i + 1] = digits[((const unsigned char *) address)[i] & 0xf];
+    }
+    key[2 * length] = '\0';
+
+    pthread_once(&theInitializeOnce, initialize);
+    mutex_enter(&theLock);
+    Entry e = acquire(LOOKUP_ADDRESS, key, address, length, family);
+    jboolean result = false;
+    if (e != NULL) {
+        result = e->name[0] != '\0';
+        if (result && nameLength > 0) {
+            strncpy(name, e->name, nameLength - 1);
+            name[nameLength - 1] = '\0';
+        }
+        release(e);
+    }
+    mutex_exit(&theLock);
+    return result;
+}
+
+/*
+ * The lookups of java.net.Inet4AddressImpl and java.net.Inet6AddressImpl (see HostResolver.java).
+ *
+ * @return the addresses of a host as byte arrays of 4 or 16 bytes, or NULL if the host could not be resolved
+ */
+JNIEXPORT jobjectArray JNICALL
+Java_com_sun_max_vm_jdk_unix_HostResolver_nativeLookupName(JNIEnv *env, jclass c, jstring host, jboolean ipv6) {
+    const char *name = (*env)->GetStringUTFChars(env, host, NULL);
+    if (name == NULL) {
+        return NULL;
+    }
+    ResolverAddressStruct addresses[RESOLVER_MAX_ADDRESSES];
+    int count = ipv6 ? resolver_lookupAllAddresses(name, addresses) : lookupName(LOOKUP_NAME, name, addresses, NULL, 0);
+    (*env)->ReleaseStringUTFChars(env, host, name);
+    if (count == 0) {
+        return NULL;
+    }
+    jclass byteArrayClass = (*env)->FindClass(env, "[B");
+    jobjectArray result = byteArrayClass == NULL ? NULL : (*env)->NewObjectArray(env, count, byteArrayClass, NULL);
+    if (result == NULL) {
+        return NULL;
+    }
+    int i;
+    for (i = 0; i < count; i++) {
+        jbyteArray address = (*env)->NewByteArray(env, addresses[i].length);
+        if (address == NULL) {
+            return NULL;
+        }
+        (*env)->SetByteArrayRegion(env, address, 0, addresses[i].length, (const jbyte *) addresses[i].bytes);
+        (*env)->SetObjectArrayElement(env, result, i, address);
+        (*env)->DeleteLocalRef(env, address);
+    }
+    return result;
+}
+
+/*
+ * @return the name of the host with a given IPv4 or IPv6 address, or NULL if it has none
+ */
+JNIEXPORT jstring JNICALL
+Java_com_sun_max_vm_jdk_unix_HostResolver_nativeLookupAddress(JNIEnv *env, jclass c, jbyteArray address) {
+    jsize length = (*env)->GetArrayLength(env, address);
+    if (length != 4 && length != 16) {
+        return NULL;
+    }
+    jbyte bytes[16];
+    (*env)->GetByteArrayRegion(env, address, 0, length, bytes);
+    char name[NI_MAXHOST];
+    if (!resolver_lookupAddress(bytes, length, length == 4 ? AF_INET : AF_INET6, name, sizeof(name))) {
+        return NULL;
+    }
+    return (*env)->NewStringUTF(env, name);
+}
+
+#else
+
+void resolver_setTimeToLive(jint seconds) {
+}
+
+void resolver_setNegativeTimeToLive(jint seconds) {
+}
+
+int resolver_lookupName(const char *name, Unsigned4 *addresses, char *canonicalName, size_t canonicalNameLength) {
+    return 0;
+}
+
+int resolver_lookupAllAddresses(const char *name, ResolverAddress addresses) {
+    return 0;
+}
+
+jboolean resolver_lookupAddress(const void *address, int length, int family, char *name, size_t nameLength) {
+    return false;
+}
+
+#endif
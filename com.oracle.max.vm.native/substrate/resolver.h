@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2011, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ */
+#ifndef __resolver_h__
+#define __resolver_h__ 1
+
+#include <stddef.h>
+
+#include "word.h"
+#include "jni.h"
+
+/*
+ * A caching host name resolver behind JVM_GetHostByName() and JVM_GetHostByAddr().
+ *
+ * It also answers the lookups of java.net.Inet4AddressImpl and java.net.Inet6AddressImpl (see HostResolver.java).
+ * The getaddrinfo(3) and getnameinfo(3) calls run in the thread whose lookup missed the cache, so lookups of
+ * different names run concurrently. Their results, failures included, are cached, and a thread looking up a name
+ * that is already being resolved waits for that lookup instead of starting its own, so a burst of lookups of one
+ * name costs one query of the name service.
+ * The C library does not expose the TTL of DNS records, so results are kept for fixed times, which default to
+ * those of the JDK's networkaddress.cache.ttl and networkaddress.cache.negative.ttl security properties.
+ */
+
+#define RESOLVER_MAX_ADDRESSES 16
+
+/*
+ * An IPv4 (4 bytes) or IPv6 (16 bytes) address, in network byte order.
+ */
+typedef struct {
+    int length;
+    unsigned char bytes[16];
+} ResolverAddressStruct, *ResolverAddress;
+
+/**
+ * Sets how long successful (-XX:HostCacheTTL) and failed (-XX:HostCacheNegativeTTL) lookups are cached.
+ * Zero disables the caching of such results (in-flight lookups are still shared) and a negative value
+ * caches them forever.
+ */
+extern void resolver_setTimeToLive(jint seconds);
+extern void resolver_setNegativeTimeToLive(jint seconds);
+
+/**
+ * Looks up the IPv4 addresses of a host.
+ *
+ * @param addresses receives up to RESOLVER_MAX_ADDRESSES addresses, in network byte order
+ * @param canonicalName receives the canonical name of the host (truncated to 'canonicalNameLength' bytes)
+ * @return the number of addresses, or 0 if the name could not be resolved
+ */
+extern int resolver_lookupName(const char *name, Unsigned4 *addresses, char *canonicalName, size_t canonicalNameLength);
+
+/**
+ * Looks up the IPv4 and IPv6 addresses of a host.
+ *
+ * @param addresses receives up to RESOLVER_MAX_ADDRESSES addresses, in the order given by getaddrinfo(3)
+ * @return the number of addresses, or 0 if the name could not be resolved
+ */
+extern int resolver_lookupAllAddresses(const char *name, ResolverAddress addresses);
+
+/**
+ * Looks up the name of the host with a given IPv4 (AF_INET) or IPv6 (AF_INET6) address.
+ *
+ * @param address the address, in network byte order
+ * @return whether the address has a name, which is then stored in 'name' (truncated to 'nameLength' bytes)
+ */
+extern jboolean resolver_lookupAddress(const void *address, int length, int family, char *name, size_t nameLength);
+
+#endif /*__resolver_h__*/
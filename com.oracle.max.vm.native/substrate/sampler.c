@@ -0,0 +1,364 @@
+/*
+ * Copyright (c) 2011, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include "c.h"
+#include "jni.h"
+#include "log.h"
+#include "mutex.h"
+#include "os.h"
+#include "threads.h"
+#include "sampler.h"
+#include "trap.h"
+
+#if os_LINUX
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+/* Older C libraries do not name the thread id member of a SIGEV_THREAD_ID sigevent. */
+#ifndef sigev_notify_thread_id
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+
+typedef struct {
+    Address ip;
+    Address sp;
+    Address fp;
+} SampleStruct, *Sample;
+
+/*
+ * The samples of a single thread. The buffer is a ring with a single producer (the SIGPROF handler
+ * running on the owning thread) and a single consumer (sampler_drain(), called with samplerLock held)
+ * and so needs no locking on the sampling path.
+ */
+typedef struct SampleBufferStruct {
+    struct SampleBufferStruct *next;
+    Address handle;          // pthread_self() of the owning thread
+    pid_t tid;               // kernel thread id of the owning thread
+    timer_t timer;
+    jboolean timerIsArmed;
+    jboolean exited;         // set once the owning thread can no longer add samples
+    volatile Size head;      // only updated by the owning thread
+    volatile Size tail;      // only updated by sampler_drain()
+    volatile Size dropped;   // samples lost because the buffer was full
+    Size capacity;
+    Sample samples;
+} SampleBufferStruct, *SampleBuffer;
+
+/*
+ * The buffer of the current thread. The initial-exec model guarantees that accessing
+ * this variable from the signal handler does not allocate.
+ */
+static __thread SampleBuffer theCurrentSampleBuffer __attribute__((tls_model("initial-exec")));
+
+/*
+ * Guards the list of buffers and the profiler settings.
+ */
+static mutex_Struct samplerLock;
+
+static SampleBuffer theSampleBuffers;
+
+/*
+ * The sampling interval in nanoseconds of thread CPU time. Zero when the profiler is not running.
+ */
+static jlong theSamplingInterval;
+
+/*
+ * The number of samples each per-thread buffer can hold.
+ */
+static jint theSamplesPerThread;
+
+/*
+ * The samples lost by threads whose buffers have been released.
+ */
+static jlong theDroppedSamplesOfExitedThreads;
+
+/*
+ * The SIGPROF disposition in place before the profiler was started, restored when it stops.
+ */
+static struct sigaction thePreviousProfilingAction;
+static jboolean theProfilingHandlerIsInstalled;
+
+/*
+ * Creates and starts the timer of a given buffer. Must be called with samplerLock held.
+ */
+static void armTimer(SampleBuffer buffer) {
+    if (buffer->exited || buffer->timerIsArmed) {
+        return;
+    }
+    if (buffer->samples == NULL) {
+        buffer->samples = (Sample) calloc(theSamplesPerThread, sizeof(SampleStruct));
+        if (buffer->samples == NULL) {
+            log_println("sampler: could not allocate sample buffer for thread %d", buffer->tid);
+            return;
+        }
+        buffer->capacity = theSamplesPerThread;
+    }
+
+    clockid_t clock;
+    int error = pthread_getcpuclockid((pthread_t) buffer->handle, &clock);
+    if (error != 0) {
+        log_println("sampler: pthread_getcpuclockid failed for thread %d: %s", buffer->tid, strerror(error));
+        return;
+    }
+
+    struct sigevent event;
+    memset(&event, 0, sizeof(event));
+    event.sigev_notify = SIGEV_THREAD_ID;
+    event.sigev_signo = SIGPROF;
+    event.sigev_notify_thread_id = buffer->tid;
+    if (timer_create(clock, &event, &buffer->timer) != 0) {
+        log_println("sampler: timer_create failed for thread %d: %s", buffer->tid, strerror(errno));
+        return;
+    }
+
+    struct itimerspec spec;
+    spec.it_interval.tv_sec = theSamplingInterval / 1000000000LL;
+    spec.it_interval.tv_nsec = theSamplingInterval % 1000000000LL;
+    spec.it_value = spec.it_interval;
+    if (timer_settime(buffer->timer, 0, &spec, NULL) != 0) {
+        log_println("sampler: timer_settime failed for thread %d: %s", buffer->tid, strerror(errno));
+        timer_delete(buffer->timer);
+        return;
+    }
+    buffer->timerIsArmed = true;
+}
+
+/*
+ * Deletes the timer of a given buffer. Must be called with samplerLock held.
+ */
+static void disarmTimer(SampleBuffer buffer) {
+    if (buffer->timerIsArmed) {
+        timer_delete(buffer->timer);
+        buffer->timerIsArmed = false;
+    }
+}
+
+void sampler_initialize(void) {
+    mutex_initialize(&samplerLock);
+}
+
+void sampler_threadStarted(void) {
+    SampleBuffer buffer = (SampleBuffer) calloc(1, sizeof(SampleBufferStruct));
+    if (buffer == NULL) {
+        return;
+    }
+    buffer->handle = (Address) thread_self();
+    buffer->tid = syscall(__NR_gettid);
+
+    mutex_enter(&samplerLock);
+    buffer->next = theSampleBuffers;
+    theSampleBuffers = buffer;
+    theCurrentSampleBuffer = buffer;
+    if (theSamplingInterval != 0) {
+        armTimer(buffer);
+    }
+    mutex_exit(&samplerLock);
+}
+
+void sampler_threadExiting(void) {
+    SampleBuffer buffer = theCurrentSampleBuffer;
+    if (buffer == NULL) {
+        return;
+    }
+    /* A SIGPROF that is still pending when the timer is deleted is ignored by sampler_record(). */
+    theCurrentSampleBuffer = NULL;
+
+    mutex_enter(&samplerLock);
+    disarmTimer(buffer);
+    if (buffer->head == buffer->tail) {
+        /* Nothing is left to drain, which is always the case once the profiler has stopped and been flushed. */
+        SampleBuffer *link = &theSampleBuffers;
+        while (*link != buffer) {
+            link = &(*link)->next;
+        }
+        *link = buffer->next;
+        theDroppedSamplesOfExitedThreads += buffer->dropped;
+        free(buffer->samples);
+        free(buffer);
+    } else {
+        buffer->exited = true;
+    }
+    mutex_exit(&samplerLock);
+}
+
+void sampler_record(Address ip, Address sp, Address fp) {
+    SampleBuffer buffer = theCurrentSampleBuffer;
+    if (buffer == NULL || buffer->samples == NULL) {
+        return;
+    }
+    Size head = buffer->head;
+    if (head - buffer->tail >= buffer->capacity) {
+        buffer->dropped++;
+        return;
+    }
+    Sample sample = &buffer->samples[head % buffer->capacity];
+    sample->ip = ip;
+    sample->sp = sp;
+    sample->fp = fp;
+    /* Publish the sample before the new head. */
+    __sync_synchronize();
+    buffer->head = head + 1;
+}
+
+/**
+ * Implementation of com.sun.max.vm.profilers.sampling.AsyncSamplingProfiler.sampler_start().
+ *
+ * @param interval the sampling interval in nanoseconds of thread CPU time
+ * @param samplesPerThread the capacity of each thread's buffer
+ */
+jboolean sampler_start(jlong interval, jint samplesPerThread) {
+    mutex_enter(&samplerLock);
+    if (!theProfilingHandlerIsInstalled) {
+        struct sigaction action;
+        memset((char *) &action, 0, sizeof(action));
+        sigemptyset(&action.sa_mask);
+        action.sa_flags = SA_SIGINFO | SA_RESTART | SA_ONSTACK;
+        action.sa_sigaction = samplerSignalHandler;
+        if (sigaction(SIGPROF, &action, &thePreviousProfilingAction) != 0) {
+            log_println("sampler: could not install SIGPROF handler: %s", strerror(errno));
+            mutex_exit(&samplerLock);
+            return false;
+        }
+        theProfilingHandlerIsInstalled = true;
+    }
+    theSamplingInterval = interval;
+    theSamplesPerThread = samplesPerThread;
+    SampleBuffer buffer;
+    for (buffer = theSampleBuffers; buffer != NULL; buffer = buffer->next) {
+        armTimer(buffer);
+    }
+    mutex_exit(&samplerLock);
+    return true;
+}
+
+/**
+ * Implementation of com.sun.max.vm.profilers.sampling.AsyncSamplingProfiler.sampler_stop().
+ */
+void sampler_stop(void) {
+    mutex_enter(&samplerLock);
+    theSamplingInterval = 0;
+    SampleBuffer buffer;
+    for (buffer = theSampleBuffers; buffer != NULL; buffer = buffer->next) {
+        disarmTimer(buffer);
+    }
+    /* Deleting a timer also discards its queued signal, so no SIGPROF of the profiler can reach the previous disposition. */
+    if (theProfilingHandlerIsInstalled) {
+        sigaction(SIGPROF, &thePreviousProfilingAction, NULL);
+        theProfilingHandlerIsInstalled = false;
+    }
+    mutex_exit(&samplerLock);
+}
+
+/**
+ * Implementation of com.sun.max.vm.profilers.sampling.AsyncSamplingProfiler.sampler_drain().
+ * Copies the pending samples of all threads into a given array of (ip, sp, fp) triples
+ * and releases the buffers of exited threads that have been completely drained.
+ *
+ * @param samples the array into which samples are copied
+ * @param length the number of samples that {@code samples} can hold
+ * @return the number of samples copied
+ */
+jint sampler_drain(Address *samples, jint length) {
+    jint n = 0;
+    mutex_enter(&samplerLock);
+    SampleBuffer *link = &theSampleBuffers;
+    while (*link != NULL) {
+        SampleBuffer buffer = *link;
+        Size head = buffer->head;
+        __sync_synchronize();
+        Size tail = buffer->tail;
+        while (tail != head && n < length) {
+            Sample sample = &buffer->samples[tail % buffer->capacity];
+            samples[n * 3] = sample->ip;
+            samples[n * 3 + 1] = sample->sp;
+            samples[n * 3 + 2] = sample->fp;
+            n++;
+            tail++;
+        }
+        /* Make sure the samples have been read before their slots are handed back to the thread. */
+        __sync_synchronize();
+        buffer->tail = tail;
+
+        if (buffer->exited && tail == head) {
+            *link = buffer->next;
+            theDroppedSamplesOfExitedThreads += buffer->dropped;
+            free(buffer->samples);
+            free(buffer);
+        } else {
+            link = &buffer->next;
+        }
+    }
+    mutex_exit(&samplerLock);
+    return n;
+}
+
+/**
+ * Implementation of com.sun.max.vm.profilers.sampling.AsyncSamplingProfiler.sampler_droppedSamples().
+ */
+jlong sampler_droppedSamples(void) {
+    mutex_enter(&samplerLock);
+    jlong result = theDroppedSamplesOfExitedThreads;
+    SampleBuffer buffer;
+    for (buffer = theSampleBuffers; buffer != NULL; buffer = buffer->next) {
+        result += buffer->dropped;
+    }
+    mutex_exit(&samplerLock);
+    return result;
+}
+
+#else
+
+void sampler_initialize(void) {
+}
+
+void sampler_threadStarted(void) {
+}
+
+void sampler_threadExiting(void) {
+}
+
+void sampler_record(Address ip, Address sp, Address fp) {
+}
+
+jboolean sampler_start(jlong interval, jint samplesPerThread) {
+    return false;
+}
+
+void sampler_stop(void) {
+}
+
+jint sampler_drain(Address *samples, jint length) {
+    return 0;
+}
+
+jlong sampler_droppedSamples(void) {
+    return 0;
+}
+
+#endif
@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2011, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ */
+#ifndef __sampler_h__
+#define __sampler_h__ 1
+
+#include "word.h"
+
+/*
+ * Support for the asynchronous sampling profiler (see com.sun.max.vm.profilers.sampling.AsyncSamplingProfiler).
+ *
+ * While the profiler is running, every thread known to the sampler has a timer that measures the
+ * CPU time consumed by the thread and sends it SIGPROF at the end of each sampling interval. The
+ * signal handler (see trap.c), which is only installed while the profiler is running, records the
+ * interrupted instruction, stack and frame pointers in a buffer owned by the thread. The buffers are
+ * drained by the profiler thread which resolves the samples against the code regions of the VM.
+ */
+
+/**
+ * Initializes the sampler. This must be called on the primordial thread before it calls sampler_threadStarted().
+ */
+extern void sampler_initialize(void);
+
+/**
+ * Makes the current thread known to the sampler. If the profiler is running, the thread's timer is started.
+ */
+extern void sampler_threadStarted(void);
+
+/**
+ * Stops sampling the current thread. Its buffer is released now if it is empty or otherwise once the profiler has drained it.
+ * This is also called for a thread that exits while attached and may be called more than once.
+ */
+extern void sampler_threadExiting(void);
+
+/**
+ * Records a sample for the current thread. This is only called from the SIGPROF handler and is async-signal-safe.
+ */
+extern void sampler_record(Address ip, Address sp, Address fp);
+
+#endif /*__sampler_h__*/
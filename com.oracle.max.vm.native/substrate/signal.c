@@ -53,11 +53,26 @@ static sem_t signal_sem;
 boolean traceSignals = false;
 
 /**
- *  ATTENTION: this signature must match the signatures of 'com.sun.max.vm.runtime.SignalDispatcher.tryPostSignal(int)'.
+ * The signals posted by the signal handler and not yet taken by the signal dispatcher thread.
+ *
+ * Each signal has a counter of its pending occurrences. The first occurrence of a signal that is
+ * not already pending also enters the signal number into a ring buffer that preserves the order in
+ * which signals arrived. As a signal occupies at most one ring entry, the ring never overflows and
+ * posting a signal takes a bounded number of steps: a flood of the same signal only increments its
+ * counter. Only async-signal-safe operations (atomic updates and posting a semaphore) are used by
+ * the posting side. The dispatcher thread is the only consumer of the ring.
  */
-typedef boolean (*TryPostSignalFunction)(int signal);
+#define SIGNAL_SLOTS 128 /* a power of 2 greater than NSIG on all supported platforms */
+
+static volatile int pendingSignalCounts[SIGNAL_SLOTS];
+static volatile int pendingSignalRing[SIGNAL_SLOTS];
+static volatile unsigned int pendingSignalRingTail = 0;
+static unsigned int pendingSignalRingHead = 0;
 
-static TryPostSignalFunction tryPostSignal = NULL;
+/**
+ * Non-zero once the semaphore used to notify the dispatcher thread has been initialized.
+ */
+static volatile int signalDispatcherInitialized = 0;
 
 /**
  * Implementation of com.sun.max.vm.runtime.SignalDispatcher.nativeSignalNotify().
@@ -81,30 +96,28 @@ Java_com_sun_max_vm_runtime_SignalDispatcher_nativeSignalNotify(JNIEnv *env, jcl
 
 /**
  * Called from userSignalHandler() in trap.c to deliver a signal dispatched by Signal.java.
- * This function atomically updates the pending signal queue by calling SignalDispatcher.tryPostSignal().
+ * This function adds the signal to the pending signals (see above) and notifies the dispatcher
+ * thread if the signal was not already pending. It never blocks or retries.
  */
 void postSignal(int signal) {
-    c_ASSERT(tryPostSignal != NULL);
+    c_ASSERT(signal > 0 && signal < SIGNAL_SLOTS);
     if (traceSignals) {
         log_print("Thread %p posting Java signal semaphore [signal: %d]\n", thread_self(), signal);
     }
-    while (!tryPostSignal(signal)) {
-        if (traceSignals) {
-            log_print("Thread %p posting Java signal semaphore [signal: %d] -- retrying\n", thread_self(), signal);
+    if (__sync_fetch_and_add(&pendingSignalCounts[signal], 1) == 0) {
+        unsigned int tail = __sync_fetch_and_add(&pendingSignalRingTail, 1);
+        pendingSignalRing[tail & (SIGNAL_SLOTS - 1)] = signal;
+        __sync_synchronize();
+        if (signalDispatcherInitialized) {
+            Java_com_sun_max_vm_runtime_SignalDispatcher_nativeSignalNotify(NULL, NULL);
         }
-        /* empty body */
     }
-    Java_com_sun_max_vm_runtime_SignalDispatcher_nativeSignalNotify(NULL, NULL);
     if (traceSignals) {
         log_print("Thread %p posted Java signal semaphore [signal: %d]\n", thread_self(), signal);
     }
 }
 
-/**
- * Implementation of com.sun.max.vm.runtime.SignalDispatcher.nativeSignalWait().
- */
-JNIEXPORT void JNICALL
-Java_com_sun_max_vm_runtime_SignalDispatcher_nativeSignalWait(JNIEnv *env, jclass c) {
+static void signalWait(void) {
     if (traceSignals) {
         log_print("Thread %p waiting on Java signal semaphore\n", thread_self());
     }
@@ -115,7 +128,7 @@ Java_com_sun_max_vm_runtime_SignalDispatcher_nativeSignalWait(JNIEnv *env, jclas
     }
 #elif os_LINUX || os_SOLARIS
     int ret;
-    while ((ret = sem_wait(&signal_sem) == EINTR)) {
+    while ((ret = sem_wait(&signal_sem)) != 0 && errno == EINTR) {
     }
     if (ret != 0) {
         log_exit(11, "sem_wait failed: %s", strerror(errno));
@@ -129,11 +142,49 @@ Java_com_sun_max_vm_runtime_SignalDispatcher_nativeSignalWait(JNIEnv *env, jclas
     }
 }
 
+/**
+ * Removes the oldest signal from the ring of pending signals.
+ *
+ * @return the signal or 0 if the ring is empty
+ */
+static int takePendingSignal(void) {
+    int *slot = (int *) &pendingSignalRing[pendingSignalRingHead & (SIGNAL_SLOTS - 1)];
+    int signal = *slot;
+    if (signal != 0) {
+        *slot = 0;
+        pendingSignalRingHead++;
+    }
+    return signal;
+}
+
+/**
+ * Implementation of com.sun.max.vm.runtime.SignalDispatcher.nativeSignalTake().
+ *
+ * Blocks the dispatcher thread until a signal is pending or the dispatcher is notified.
+ *
+ * @return 0 if woken without a pending signal, otherwise the oldest pending signal in the low 32 bits
+ *         and the number of its occurrences coalesced since it was last taken in the high 32 bits
+ */
+JNIEXPORT jlong JNICALL
+Java_com_sun_max_vm_runtime_SignalDispatcher_nativeSignalTake(JNIEnv *env, jclass c) {
+    int signal = takePendingSignal();
+    if (signal == 0) {
+        signalWait();
+        signal = takePendingSignal();
+        if (signal == 0) {
+            return 0;
+        }
+    }
+    /* Resetting the counter lets the next occurrence of the signal enter the ring again. */
+    jlong occurrences = __sync_lock_test_and_set(&pendingSignalCounts[signal], 0);
+    return (occurrences << 32) | signal;
+}
+
 /**
  * Implementation of com.sun.max.vm.runtime.SignalDispatcher.nativeSignalInit().
  */
 JNIEXPORT void JNICALL
-Java_com_sun_max_vm_runtime_SignalDispatcher_nativeSignalInit(JNIEnv *env, jclass c, Address tryPostSignalAddress) {
+Java_com_sun_max_vm_runtime_SignalDispatcher_nativeSignalInit(JNIEnv *env, jclass c) {
 #if os_DARWIN
     kern_return_t kr = semaphore_create(mach_task_self(), &signal_sem, SYNC_POLICY_FIFO, 0);
     if (kr != KERN_SUCCESS) {
@@ -157,9 +208,11 @@ Java_com_sun_max_vm_runtime_SignalDispatcher_nativeSignalInit(JNIEnv *env, jclas
      * semaphores functions are linked now as linking during a trap handler
      * appears to cause problems. */
     Java_com_sun_max_vm_runtime_SignalDispatcher_nativeSignalNotify(NULL, NULL);
-    Java_com_sun_max_vm_runtime_SignalDispatcher_nativeSignalWait(NULL, NULL);
+    signalWait();
 
-    tryPostSignal = (TryPostSignalFunction) tryPostSignalAddress;
+    /* Signals posted before now are already in the ring; make sure the dispatcher looks at them. */
+    signalDispatcherInitialized = 1;
+    Java_com_sun_max_vm_runtime_SignalDispatcher_nativeSignalNotify(NULL, NULL);
 }
 
 /**
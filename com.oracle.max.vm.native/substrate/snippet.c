@@ -24,6 +24,7 @@
  
 #include "image.h"
 #include "jni.h"
+#include "javaArithmetic.h"
 
 jint nativeLongCompare(jlong greater, long less) 
 {
@@ -48,20 +49,20 @@ jlong nativeLongMultiply(jlong factor1, jlong factor2)
 
 jlong nativeLongDivided(jlong dividend, jlong divisor) 
 {
-    return dividend / divisor;
+    return javaArithmetic_ldiv(dividend, divisor);
 }
 
 jlong nativeLongRemainder(jlong dividend, jlong divisor) 
 {
-    return dividend % divisor;
+    return javaArithmetic_lrem(dividend, divisor);
 }
 
 jfloat nativeFloatRemainder(jfloat dividend, jfloat divisor) 
 {
-    return (float) fmod((double) dividend, (double) divisor);
+    return javaArithmetic_frem(dividend, divisor);
 }
 
 jdouble nativeDoubleRemainder(jdouble dividend, jdouble divisor) 
 {
-    return fmod(dividend, divisor);
+    return javaArithmetic_drem(dividend, divisor);
 }
@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2011, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ */
+#include "jni.h"
+#include "os.h"
+#include "isa.h"
+#include "virtualMemory.h"
+#include "threadLocals.h"
+#include "stackWalk.h"
+
+/*
+ * Where the caller's frame pointer and the return address are saved relative to the frame pointer
+ * of a frame. The chain is not followed on ISAs whose frame record is not at a fixed place.
+ */
+#if isa_AMD64 || isa_IA32 || isa_AARCH64
+#define FRAME_POINTER_CHAIN 1
+#define SAVED_FRAME_POINTER_OFFSET 0
+#define RETURN_ADDRESS_OFFSET ((int) sizeof(Address))
+#elif isa_RISCV64
+#define FRAME_POINTER_CHAIN 1
+#define SAVED_FRAME_POINTER_OFFSET (-2 * (int) sizeof(Address))
+#define RETURN_ADDRESS_OFFSET (-(int) sizeof(Address))
+#else
+#define FRAME_POINTER_CHAIN 0
+#endif
+
+/*
+ * The bounds of the current thread's stack that the walk can read.
+ */
+typedef struct {
+    Address low;
+    Address high;
+} StackBounds;
+
+/**
+ * Determines if the 'n' words at a given address are within the stack.
+ */
+static inline boolean inStack(StackBounds *bounds, Address address, int n) {
+    return (address & (sizeof(Address) - 1)) == 0 && address >= bounds->low && address + n * sizeof(Address) <= bounds->high;
+}
+
+static inline void addFrame(StackWalkFrame frames, int *count, Address kind, Address ip, Address sp, Address fp) {
+    StackWalkFrame frame = &frames[(*count)++];
+    frame->ip = ip;
+    frame->sp = sp;
+    frame->fp = fp;
+    frame->kind = kind;
+}
+
+int stackWalk_walk(Address ip, Address sp, Address fp, StackWalkFrame frames, int maxFrames) {
+    int count = 0;
+    if (maxFrames <= 0) {
+        return 0;
+    }
+    addFrame(frames, &count, STACK_FRAME_INTERRUPTED, ip, sp, fp);
+
+    Address tlBlock = threadLocalsBlock_current();
+    if (tlBlock == 0) {
+        /* Not a thread known to the VM: the bounds of its stack are unknown. */
+        return count;
+    }
+    NativeThreadLocals ntl = NATIVE_THREAD_LOCALS_FROM_TLBLOCK(tlBlock);
+    StackBounds bounds;
+    bounds.low = sp;
+    bounds.high = ntl->stackBase + ntl->stackSize;
+    if (sp < ntl->stackBase || sp >= bounds.high) {
+        /* Running on another stack (e.g. a signal stack). */
+        return count;
+    }
+
+    Address anchor = tla_load(Address, ETLA_FROM_TLBLOCK(tlBlock), LAST_JAVA_FRAME_ANCHOR);
+    if (anchor != 0 && !inStack(&bounds, anchor, 4)) {
+        anchor = 0;
+    }
+
+#if FRAME_POINTER_CHAIN
+    /* Native frames are those more recent (i.e. lower) than the most recent anchor. */
+    Address limit = anchor != 0 ? ((Address *) anchor)[2] : bounds.high;
+    while (count < maxFrames && fp > sp && fp < limit
+                    && inStack(&bounds, fp + SAVED_FRAME_POINTER_OFFSET, 1) && inStack(&bounds, fp + RETURN_ADDRESS_OFFSET, 1)) {
+        Address callerFP = *(Address *) (fp + SAVED_FRAME_POINTER_OFFSET);
+        Address returnAddress = *(Address *) (fp + RETURN_ADDRESS_OFFSET);
+        if (returnAddress == 0) {
+            break;
+        }
+        addFrame(frames, &count, STACK_FRAME_NATIVE, returnAddress, fp, callerFP);
+        /* Each caller's frame must be strictly older than its callee's. */
+        sp = fp;
+        fp = callerFP;
+    }
+#endif
+
+    /* The fields of an anchor are laid out as in JavaFrameAnchor.java: PREVIOUS, PC, SP, FP. */
+    while (anchor != 0 && count < maxFrames) {
+        Address *fields = (Address *) anchor;
+        Address pc = fields[1];
+        addFrame(frames, &count, pc == 0 ? STACK_FRAME_JAVA_ENTRY : STACK_FRAME_JAVA_CALL, pc, fields[2], fields[3]);
+        Address previous = fields[0];
+        if (previous != 0 && (previous <= anchor || !inStack(&bounds, previous, 4))) {
+            break;
+        }
+        anchor = previous;
+    }
+    return count;
+}
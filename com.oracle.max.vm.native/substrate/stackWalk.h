@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2011, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ */
+#ifndef __stackWalk_h__
+#define __stackWalk_h__ 1
+
+#include "word.h"
+
+/*
+ * A bounded stack walker that can be used from a signal handler, e.g. by the sampling profiler or
+ * to describe the stack of a thread when it takes a fatal trap. It only reads memory within the
+ * stack of the current thread (as described by its NativeThreadLocals), never allocates, locks or
+ * calls into the C library and stops at the first inconsistency.
+ *
+ * The walk records the interrupted frame, then the native frames found by following the frame
+ * pointer chain up to the most recent Java frame anchor, then every anchor in the
+ * LAST_JAVA_FRAME_ANCHOR list. Compiled Java code does not maintain a frame pointer chain so
+ * the Java frames between anchors are not walked here: the recorded anchors are the points from
+ * which the Java stack walker can resolve them.
+ */
+
+#define STACK_FRAME_INTERRUPTED  0 // the frame of the interrupted instruction
+#define STACK_FRAME_NATIVE       1 // a frame found by following the frame pointer chain; 'ip' is its return address
+#define STACK_FRAME_JAVA_CALL    2 // a Java frame anchor recorded by a Java frame calling native code
+#define STACK_FRAME_JAVA_ENTRY   3 // a Java frame anchor recorded where native code called into Java ('ip' is 0)
+
+typedef struct {
+    Address ip;
+    Address sp;
+    Address fp;
+    Address kind;  // one of the STACK_FRAME_* constants
+} StackWalkFrameStruct, *StackWalkFrame;
+
+/**
+ * Walks the stack of the current thread from a given execution point. This is async-signal-safe.
+ *
+ * @param ip the instruction pointer at which to start
+ * @param sp the stack pointer at which to start
+ * @param fp the frame pointer at which to start
+ * @param frames the buffer into which the frames are written, innermost first
+ * @param maxFrames the number of frames that 'frames' can hold
+ * @return the number of frames written to 'frames'
+ */
+extern int stackWalk_walk(Address ip, Address sp, Address fp, StackWalkFrame frames, int maxFrames);
+
+#endif /*__stackWalk_h__*/
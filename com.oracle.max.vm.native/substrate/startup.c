@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2011, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ */
+#include "os.h"
+#include "jni.h"
+#include "maxine.h"
+#include "startup.h"
+
+#define STARTUP_PHASE_NAME(phase, name) name,
+
+static const char *phaseNames[] = {
+    STARTUP_PHASES(STARTUP_PHASE_NAME)
+};
+
+/*
+ * The time (in nanoseconds, see native_nanoTime) at which each startup phase completed, or 0 if it did not run.
+ */
+static jlong phaseTimes[STARTUP_PHASE_COUNT];
+
+void startup_mark(startup_Phase phase) {
+    phaseTimes[phase] = native_nanoTime();
+}
+
+int native_startupPhaseCount(void) {
+    return STARTUP_PHASE_COUNT;
+}
+
+const char *native_startupPhaseName(int phase) {
+    return phaseNames[phase];
+}
+
+jlong native_startupPhaseTime(int phase) {
+    return phaseTimes[phase];
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2011, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ */
+#ifndef __startup_h__
+#define __startup_h__ 1
+
+#include "jni.h"
+
+/*
+ * The phases of the native startup of the VM, in the order in which they complete.
+ * The time at which each phase completes is recorded with 'startup_mark' and made
+ * available to Java (see com.sun.max.vm.StartupTimes).
+ */
+#define STARTUP_PHASES(f) \
+    f(LAUNCH, "launch") \
+    f(LOG_INITIALIZED, "log_initialize") \
+    f(FD_LIMIT, "max_fd_limit") \
+    f(IMAGE_CHECKED, "image_load: read and check") \
+    f(IMAGE_MAPPED, "image_load: map heap and code") \
+    f(IMAGE_DECOMPRESSED, "image_load: decompress") \
+    f(IMAGE_RELOCATED, "image_load: relocate") \
+    f(IMAGE_LOADED, "image_load") \
+    f(TLA_INITIALIZED, "tla_initialize") \
+    f(ZYGOTE_FORKED, "zygote fork") \
+    f(DEBUGGER_INITIALIZED, "debugger_initialize") \
+    f(PRIMORDIAL_THREAD_LOCALS, "threadLocalsBlock_create") \
+
+#define STARTUP_PHASE_ENUM(phase, name) STARTUP_##phase,
+
+typedef enum {
+    STARTUP_PHASES(STARTUP_PHASE_ENUM)
+    STARTUP_PHASE_COUNT
+} startup_Phase;
+
+/**
+ * Records the current time as the time at which a given startup phase completed.
+ * This is cheap enough to be always enabled.
+ */
+extern void startup_mark(startup_Phase phase);
+
+#endif /*__startup_h__*/
@@ -27,9 +27,9 @@ PROJECT = ../../..
 
 LIB = jvm
 
-SOURCES = c.c condition.c log.c image.c $(ISA).c jni.c jvm.c maxine.c memory.c mutex.c \
-          relocation.c dataio.c snippet.c threads.c threadLocals.c time.c trap.c \
-          virtualMemory.c jnitests.c sync.c signal.c jmm.c jvmti.c barrier.c
+SOURCES = c.c cacheTopology.c cgroup.c condition.c cpuFeatures.c log.c image.c $(ISA).c jni.c jvm.c maxine.c memory.c mutex.c \
+          relocation.c dataio.c snippet.c startup.c threads.c threadLocals.c time.c trap.c \
+          virtualMemory.c jnitests.c sync.c signal.c jmm.c jvmti.c heapDump.c barrier.c sampler.c spinWait.c stackWalk.c trace.c aio.c readiness.c resolver.c zygote.c lookupCache.c symbolIndex.c perfMap.c
 
 TARGETOS ?= $(shell uname -s)
 ifeq ($(TARGETOS),Linux)
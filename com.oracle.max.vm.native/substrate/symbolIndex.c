@@ -0,0 +1,305 @@
+/*
+ * Copyright (c) 2011, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ */
+#include "os.h"
+#include "log.h"
+#include "symbolIndex.h"
+
+#if os_SOLARIS || os_LINUX || os_DARWIN
+#include <dlfcn.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mutex.h"
+
+#if os_LINUX
+#include <elf.h>
+#include <link.h>
+#endif
+
+#define JNI_PREFIX "Java_"
+#define JNI_PREFIX_LENGTH 5
+
+typedef struct {
+    Unsigned4 hash;
+    char *name;
+    void *address;
+} SymbolStruct, *Symbol;
+
+typedef struct LibraryStruct {
+    void *handle;
+    /* An open addressing table of the indexed symbols followed by those that were looked up with dlsym(). */
+    Symbol symbols;
+    Unsigned4 capacity;
+    Unsigned4 count;
+    struct LibraryStruct *next;
+} LibraryStruct, *Library;
+
+static pthread_once_t theInitializeOnce = PTHREAD_ONCE_INIT;
+static mutex_Struct theLock;
+static Library theLibraries;
+
+/* The handle of the main program, which searches every object loaded with RTLD_GLOBAL. */
+static void *theMainHandle;
+
+static void initialize(void) {
+    mutex_initialize(&theLock);
+    theMainHandle = dlopen(NULL, RTLD_LAZY);
+}
+
+static Unsigned4 hashName(const char *name) {
+    Unsigned4 hash = 2166136261u;
+    while (*name != '\0') {
+        hash = (hash ^ (Unsigned1) *name++) * 16777619u;
+    }
+    return hash;
+}
+
+static Symbol findSymbol(Symbol symbols, Unsigned4 capacity, const char *name, Unsigned4 hash) {
+    Unsigned4 i = hash & (capacity - 1);
+    for (;;) {
+        Symbol symbol = &symbols[i];
+        if (symbol->name == NULL || (symbol->hash == hash && strcmp(symbol->name, name) == 0)) {
+            return symbol;
+        }
+        i = (i + 1) & (capacity - 1);
+    }
+}
+
+/*
+ * Adds a symbol to the table of a library unless it is already there. Returns false if memory is exhausted.
+ */
+static boolean addSymbol(Library library, const char *name, Unsigned4 hash, void *address) {
+    if ((library->count + 1) * 2 > library->capacity) {
+        Unsigned4 capacity = library->capacity == 0 ? 64 : library->capacity * 2;
+        Symbol symbols = (Symbol) calloc(capacity, sizeof(SymbolStruct));
+        if (symbols == NULL) {
+            return false;
+        }
+        Unsigned4 i;
+        for (i = 0; i < library->capacity; i++) {
+            if (library->symbols[i].name != NULL) {
+                *findSymbol(symbols, capacity, library->symbols[i].name, library->symbols[i].hash) = library->symbols[i];
+            }
+        }
+        free(library->symbols);
+        library->symbols = symbols;
+        library->capacity = capacity;
+    }
+    Symbol symbol = findSymbol(library->symbols, library->capacity, name, hash);
+    if (symbol->name == NULL) {
+        char *copy = strdup(name);
+        if (copy == NULL) {
+            return false;
+        }
+        symbol->hash = hash;
+        symbol->name = copy;
+        symbol->address = address;
+        library->count++;
+    }
+    return true;
+}
+
+#if os_LINUX
+
+/*
+ * Glibc relocates the addresses in the dynamic section of most platforms when the object is loaded,
+ * other implementations leave them relative to the load address.
+ */
+static Address dynamicAddress(struct link_map *map, ElfW(Addr) value) {
+    return value < map->l_addr ? map->l_addr + value : value;
+}
+
+/*
+ * Gets the number of entries in a dynamic symbol table from one of its hash tables.
+ */
+static Unsigned4 symbolCount(const Elf32_Word *hash, const Elf32_Word *gnuHash) {
+    if (hash != NULL) {
+        return hash[1];
+    }
+    if (gnuHash == NULL) {
+        return 0;
+    }
+    /* A GNU hash table has no count: the last chain of the highest bucket ends with the last symbol. */
+    Elf32_Word nbuckets = gnuHash[0];
+    Elf32_Word symbolBase = gnuHash[1];
+    Elf32_Word bloomSize = gnuHash[2];
+    const Elf32_Word *buckets = gnuHash + 4 + bloomSize * (sizeof(ElfW(Addr)) / sizeof(Elf32_Word));
+    const Elf32_Word *chains = buckets + nbuckets;
+    Elf32_Word last = 0;
+    Elf32_Word i;
+    for (i = 0; i < nbuckets; i++) {
+        if (buckets[i] > last) {
+            last = buckets[i];
+        }
+    }
+    if (last < symbolBase) {
+        return symbolBase;
+    }
+    while ((chains[last - symbolBase] & 1) == 0) {
+        last++;
+    }
+    return last + 1;
+}
+
+/*
+ * Adds the JNI functions defined by a loaded object to the table of its library.
+ */
+static void indexLibrary(Library library) {
+    struct link_map *map;
+    if (dlinfo(library->handle, RTLD_DI_LINKMAP, &map) != 0 || map == NULL) {
+        return;
+    }
+    const ElfW(Sym) *symbols = NULL;
+    const char *strings = NULL;
+    const Elf32_Word *hash = NULL;
+    const Elf32_Word *gnuHash = NULL;
+    const ElfW(Dyn) *dyn;
+    for (dyn = map->l_ld; dyn != NULL && dyn->d_tag != DT_NULL; dyn++) {
+        switch (dyn->d_tag) {
+            case DT_SYMTAB: symbols = (const ElfW(Sym) *) dynamicAddress(map, dyn->d_un.d_ptr); break;
+            case DT_STRTAB: strings = (const char *) dynamicAddress(map, dyn->d_un.d_ptr); break;
+            case DT_HASH: hash = (const Elf32_Word *) dynamicAddress(map, dyn->d_un.d_ptr); break;
+            case DT_GNU_HASH: gnuHash = (const Elf32_Word *) dynamicAddress(map, dyn->d_un.d_ptr); break;
+        }
+    }
+    if (symbols == NULL || strings == NULL) {
+        return;
+    }
+    Unsigned4 count = symbolCount(hash, gnuHash);
+    Unsigned4 i;
+    for (i = 0; i < count; i++) {
+        const ElfW(Sym) *symbol = &symbols[i];
+        int type = ELF64_ST_TYPE(symbol->st_info);
+        int binding = ELF64_ST_BIND(symbol->st_info);
+        /* Indirect functions are resolved by dlsym(), so they are left to the fallback path. */
+        if (symbol->st_shndx == SHN_UNDEF || (type != STT_FUNC && type != STT_OBJECT) ||
+                        (binding != STB_GLOBAL && binding != STB_WEAK)) {
+            continue;
+        }
+        const char *name = strings + symbol->st_name;
+        if (strncmp(name, JNI_PREFIX, JNI_PREFIX_LENGTH) == 0) {
+            if (!addSymbol(library, name, hashName(name), (void *) (map->l_addr + symbol->st_value))) {
+                return;
+            }
+        }
+    }
+#if log_LINKER
+    log_println("symbolIndex: indexed %d symbols of %s", library->count, map->l_name);
+#endif
+}
+
+#else
+
+static void indexLibrary(Library library) {
+}
+
+#endif
+
+static Library findLibrary(void *handle) {
+    Library library;
+    for (library = theLibraries; library != NULL; library = library->next) {
+        if (library->handle == handle) {
+            return library;
+        }
+    }
+    library = (Library) calloc(1, sizeof(LibraryStruct));
+    if (library != NULL) {
+        library->handle = handle;
+        if (handle != NULL) {
+            indexLibrary(library);
+        }
+        library->next = theLibraries;
+        theLibraries = library;
+    }
+    return library;
+}
+
+void *symbolIndex_lookup(void *handle, const char *name) {
+    if (strncmp(name, JNI_PREFIX, JNI_PREFIX_LENGTH) != 0) {
+        return dlsym(handle, name);
+    }
+    pthread_once(&theInitializeOnce, initialize);
+    Unsigned4 hash = hashName(name);
+    mutex_enter(&theLock);
+    Library library = findLibrary(handle);
+    if (library != NULL && library->capacity != 0) {
+        Symbol symbol = findSymbol(library->symbols, library->capacity, name, hash);
+        if (symbol->name != NULL) {
+            void *address = symbol->address;
+            mutex_exit(&theLock);
+            return address;
+        }
+    }
+    mutex_exit(&theLock);
+
+    /*
+     * Not defined by the library itself: it may still be found in one of its dependencies. These are fixed
+     * when the library is loaded, but the global scope searched from the main program may grow, so a failed
+     * lookup in the main program is not remembered.
+     */
+    void *address = dlsym(handle, name);
+    if (address == NULL && (handle == NULL || handle == theMainHandle)) {
+        return NULL;
+    }
+    mutex_enter(&theLock);
+    library = findLibrary(handle);
+    if (library != NULL) {
+        addSymbol(library, name, hash, address);
+    }
+    mutex_exit(&theLock);
+    return address;
+}
+
+void symbolIndex_forget(void *handle) {
+    pthread_once(&theInitializeOnce, initialize);
+    mutex_enter(&theLock);
+    Library *link = &theLibraries;
+    while (*link != NULL) {
+        Library library = *link;
+        if (library->handle == handle) {
+            *link = library->next;
+            Unsigned4 i;
+            for (i = 0; i < library->capacity; i++) {
+                free(library->symbols[i].name);
+            }
+            free(library->symbols);
+            free(library);
+            break;
+        }
+        link = &library->next;
+    }
+    mutex_exit(&theLock);
+}
+
+#else
+
+void *symbolIndex_lookup(void *handle, const char *name) {
+    log_exit(1, "symbolIndex_lookup is not implemented on this platform");
+    return NULL;
+}
+
+void symbolIndex_forget(void *handle) {
+}
+
+#endif
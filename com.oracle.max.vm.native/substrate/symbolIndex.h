@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2011, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ */
+#ifndef __symbolIndex_h__
+#define __symbolIndex_h__ 1
+
+/*
+ * Cached native symbol lookup for dynamically loaded libraries.
+ *
+ * Linking a native method looks up its short JNI name and then its long JNI name in every library
+ * loaded by the class loader and then in the libraries on the system path. With dlsym() each of
+ * these probes walks the symbol hash tables of a library and all of its dependencies. Here the
+ * 'Java_' symbols defined by a library are indexed the first time a symbol is looked up in it
+ * (Linux only, from the dynamic symbol table of the loaded object) and the symbols that are not in
+ * the index are looked up with dlsym() once and remembered, including failed lookups.
+ */
+
+/**
+ * Looks up a symbol with the same result as dlsym(handle, name).
+ */
+extern void *symbolIndex_lookup(void *handle, const char *name);
+
+/**
+ * Discards the cache of a library that is about to be closed.
+ */
+extern void symbolIndex_forget(void *handle);
+
+#endif /*__symbolIndex_h__*/
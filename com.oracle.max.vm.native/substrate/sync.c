@@ -106,3 +106,7 @@ jboolean nativeConditionNotify(Condition condition, jboolean all) {
     }
     return condition_notify(condition);
 }
+
+void nativeMutexPrintProfile(void) {
+    mutex_printProfile();
+}
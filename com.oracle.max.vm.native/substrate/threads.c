@@ -33,15 +33,23 @@
 #include <string.h>
 #include <signal.h>
 #include <limits.h>
+#include <stdint.h>
 #include "log.h"
 #include "image.h"
 #include "vm.h"
 #include "word.h"
 #include "mutex.h"
+#include "condition.h"
 #include "trap.h"
+#include "sampler.h"
+#include "trace.h"
+#include "aio.h"
 #include "threads.h"
 #include "threadLocals.h"
 #include <sys/mman.h>
+#if os_LINUX
+#include <sys/prctl.h>
+#endif
 
 #if (os_DARWIN || os_LINUX)
 #   include <pthread.h>
@@ -136,15 +144,206 @@ void thread_getStackInfo(Address *stackBase, Size* stackSize) {
 
 }
 
+#if os_LINUX
+#define STACK_CACHE 1
+#endif
+
+#if STACK_CACHE
+/**
+ * A bounded cache of thread stacks allocated by the VM. Each stack is mapped together with the
+ * red zone page(s) just below it and has its red and yellow zones protected when it is first
+ * allocated. The zones stay protected while a stack is in the cache so that starting a thread
+ * with a cached stack needs no mmap, mprotect or munmap system calls.
+ *
+ * A stack is released by its thread just before the thread terminates, so the thread is joined
+ * before the stack is reused or unmapped.
+ */
+#define STACK_CACHE_SIZE 32
+
+typedef struct {
+    Address base;      // start of the mapping (i.e. of the red zone)
+    Size stackSize;
+    pthread_t owner;   // the terminating thread that released the stack, 0 if none
+    boolean hasOwner;
+} CachedStack;
+
+static CachedStack theStackCache[STACK_CACHE_SIZE];
+static int theStackCacheCount = 0;
+static pthread_mutex_t theStackCacheMutex = PTHREAD_MUTEX_INITIALIZER;
+
+static Size redZoneSize(void) {
+    return RED_ZONE_PAGES * virtualMemory_getPageSize();
+}
+
+static void waitForOwner(CachedStack *stack) {
+    if (stack->hasOwner) {
+        pthread_join(stack->owner, NULL);
+    }
+}
+
+/**
+ * Gets a stack of a given size from the stack cache or allocates (and arms) a new one.
+ *
+ * @return the base (i.e. lowest) address of the usable stack or 0 if allocation failed
+ */
+static Address takeStack(Size stackSize) {
+    CachedStack stack;
+    boolean found = false;
+    int i;
+    pthread_mutex_lock(&theStackCacheMutex);
+    for (i = theStackCacheCount - 1; i >= 0; i--) {
+        if (theStackCache[i].stackSize == stackSize) {
+            stack = theStackCache[i];
+            theStackCache[i] = theStackCache[--theStackCacheCount];
+            found = true;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&theStackCacheMutex);
+    if (found) {
+        waitForOwner(&stack);
+        return stack.base + redZoneSize();
+    }
+    Address base = virtualMemory_allocatePrivateAnon(0, redZoneSize() + stackSize, JNI_TRUE, JNI_FALSE, STACK_VM);
+    if (base == ALLOC_FAILED) {
+        return 0;
+    }
+    virtualMemory_protectPages(base, RED_ZONE_PAGES + YELLOW_ZONE_PAGES);
+    return base + redZoneSize();
+}
+
+/**
+ * Puts a stack into the stack cache, evicting (and unmapping) another one if the cache is full.
+ */
+static void putStack(Address stackBase, Size stackSize, boolean hasOwner, pthread_t owner) {
+    CachedStack evicted;
+    boolean evict = false;
+    pthread_mutex_lock(&theStackCacheMutex);
+    if (theStackCacheCount == STACK_CACHE_SIZE) {
+        evicted = theStackCache[0];
+        theStackCache[0] = theStackCache[--theStackCacheCount];
+        evict = true;
+    }
+    CachedStack *stack = &theStackCache[theStackCacheCount++];
+    stack->base = stackBase - redZoneSize();
+    stack->stackSize = stackSize;
+    stack->owner = owner;
+    stack->hasOwner = hasOwner;
+    pthread_mutex_unlock(&theStackCacheMutex);
+    if (evict) {
+        waitForOwner(&evicted);
+        virtualMemory_deallocate(evicted.base, redZoneSize() + evicted.stackSize, STACK_VM);
+    }
+}
+#endif
+
+void thread_releaseStack(NativeThreadLocals ntl) {
+#if STACK_CACHE
+    c_ASSERT(ntl->stackIsCached);
+    /* Re-arm the yellow zone in case the thread terminated while it was unprotected (see VmThread). */
+    virtualMemory_protectPages(ntl->yellowZone, YELLOW_ZONE_PAGES);
+    putStack(ntl->stackBase, ntl->stackSize, true, pthread_self());
+#else
+    c_UNIMPLEMENTED();
+#endif
+}
+
+#if os_LINUX
+#include <dirent.h>
+
+/**
+ * Adds the CPUs of a NUMA node (as listed in sysfs) to a CPU set.
+ */
+static boolean addNodeCPUs(int node, cpu_set_t *cpus) {
+    char path[128];
+    char list[4096];
+    snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        return false;
+    }
+    boolean result = fgets(list, sizeof(list), file) != NULL;
+    fclose(file);
+    if (result) {
+        /* The list is of the form "0-3,8,10-11" */
+        char *range;
+        for (range = strtok(list, ",\n"); range != NULL; range = strtok(NULL, ",\n")) {
+            int first, last;
+            int n = sscanf(range, "%d-%d", &first, &last);
+            if (n == 1) {
+                last = first;
+            } else if (n != 2) {
+                continue;
+            }
+            for (; first <= last && first < CPU_SETSIZE; first++) {
+                CPU_SET(first, cpus);
+            }
+        }
+    }
+    return result;
+}
+
+/**
+ * Gets the NUMA node of a CPU from sysfs.
+ *
+ * @return the node or -1 if it cannot be determined
+ */
+static int nodeOfCPU(int cpu) {
+    char path[128];
+    int node = -1;
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d", cpu);
+    DIR *dir = opendir(path);
+    if (dir != NULL) {
+        struct dirent *entry;
+        while (node < 0 && (entry = readdir(dir)) != NULL) {
+            if (strncmp(entry->d_name, "node", 4) == 0) {
+                node = atoi(entry->d_name + 4);
+            }
+        }
+        closedir(dir);
+    }
+    return node;
+}
+
+/**
+ * Computes the CPU set for a CPU and/or NUMA node (either of which may be -1).
+ *
+ * @return true if 'cpus' denotes an affinity, false if there is none
+ */
+static boolean affinityCPUs(int cpu, int node, cpu_set_t *cpus) {
+    CPU_ZERO(cpus);
+    if (cpu >= 0 && cpu < CPU_SETSIZE) {
+        CPU_SET(cpu, cpus);
+        return true;
+    }
+    return node >= 0 && addNodeCPUs(node, cpus) && CPU_COUNT(cpus) > 0;
+}
+
+/**
+ * Places the whole pages of a range on a NUMA node.
+ */
+static void placeOnNode(Address start, Size size, int node) {
+    Size pageSize = virtualMemory_getPageSize();
+    Address alignedStart = virtualMemory_pageAlign(start);
+    Address end = (start + size) & ~(pageSize - 1);
+    if (end > alignedStart) {
+        virtualMemory_setPlacementPolicy(alignedStart, end - alignedStart, NUMA_POLICY_PREFERRED, node);
+    }
+}
+#endif
+
 /**
  * OS-specific thread creation.
  *
  * @param id the identifier reserved in the thread map for the thread to be started
  * @param stackSize the requested size of the thread's stack
  * @param priority the initial priority of the thread
+ * @param cpu the CPU the thread is bound to or -1
+ * @param node the NUMA node the thread runs on or -1 (ignored if cpu != -1). The thread locals block
+ *             and (where the VM allocates it) the stack of the thread are placed on the node of the thread.
  * @return the native thread handle (e.g. pthread_self()) of the started thread or 0 in the case of failure
  */
-static Thread thread_create(jint id, Size stackSize, int priority) {
+static Thread thread_create(jint id, Size stackSize, int priority, int cpu, int node) {
     Thread thread;
 #if !os_MAXVE
     int error;
@@ -174,6 +373,7 @@ static Thread thread_create(jint id, Size stackSize, int priority) {
 
     TLA etla = ETLA_FROM_TLBLOCK(tlBlock);
     tla_store(etla, ID, id);
+    NATIVE_THREAD_LOCALS_FROM_TLBLOCK(tlBlock)->stackIsCached = 0;
 
 #if os_MAXVE
     thread = maxve_create_thread(
@@ -188,16 +388,46 @@ static Thread thread_create(jint id, Size stackSize, int priority) {
     pthread_attr_t attributes;
     pthread_attr_init(&attributes);
 
+#if STACK_CACHE
+    /* The stack comes from the stack cache with its red-zone guard page
+     * just below the bottom of the stack already protected. */
+    Address stack = takeStack(stackSize);
+    if (stack == 0) {
+        log_println("thread_create: could not allocate a stack of %ld bytes", stackSize);
+        return (Thread) 0;
+    }
+    NATIVE_THREAD_LOCALS_FROM_TLBLOCK(tlBlock)->stackIsCached = 1;
+    pthread_attr_setstack(&attributes, (void *) stack, stackSize);
+    pthread_attr_setguardsize(&attributes, 0);
+#else
     /* The thread library allocates the stack and sets the red-zone
      * guard page at (Linux) or just below (Darwin) the bottom of the stack. */
     pthread_attr_setstacksize(&attributes, stackSize);
     pthread_attr_setguardsize(&attributes, virtualMemory_getPageSize());
+#endif
     pthread_attr_setdetachstate(&attributes, PTHREAD_CREATE_JOINABLE);
 
+#if os_LINUX
+    cpu_set_t cpus;
+    if (affinityCPUs(cpu, node, &cpus)) {
+        pthread_attr_setaffinity_np(&attributes, sizeof(cpus), &cpus);
+        int memoryNode = cpu >= 0 ? nodeOfCPU(cpu) : node;
+        if (memoryNode >= 0) {
+            placeOnNode(tlBlock, NATIVE_THREAD_LOCALS_FROM_TLBLOCK(tlBlock)->tlBlockSize, memoryNode);
+#if STACK_CACHE
+            placeOnNode(stack, stackSize, memoryNode);
+#endif
+        }
+    }
+#endif
+
     error = pthread_create(&thread, &attributes, (void *(*)(void *)) thread_run, (void *) tlBlock);
     pthread_attr_destroy(&attributes);
     if (error != 0) {
         log_println("pthread_create failed with error: %d", error);
+#if STACK_CACHE
+        putStack(stack, stackSize, false, 0);
+#endif
         return (Thread) 0;
     }
 #elif os_SOLARIS
@@ -221,6 +451,224 @@ void *thread_self() {
     return (void *) thread_current();
 }
 
+/**
+ * Threads are added to the thread map (by upcalls to VmThread.add()) while the global thread lock
+ * is held. This blocks the addition of threads while a GC is underway (the GC holds the lock) and
+ * serializes the updates to the thread list. Instead of each starting thread acquiring the lock
+ * in turn, a starting thread pushes a request onto a lock-free list of pending admissions. The
+ * first thread to find no admission in progress acquires the lock once and admits the whole list
+ * in arrival order, letting each requesting thread in turn perform its own upcall (the upcall must
+ * run on the thread being added) while the lock stays held. A burst of starting threads therefore
+ * costs one acquisition of the lock per batch rather than one contended acquisition per thread.
+ *
+ * An admitter admits exactly one batch. Requests that arrive meanwhile are handed over as the next
+ * batch to the oldest of them, which becomes the next admitter, so no thread keeps admitting others
+ * indefinitely. The hand-offs between the admitter and the admitted threads park on the state word
+ * of the request (a futex on Linux), which costs one wake-up in each direction.
+ */
+#define ADMISSION_PENDING  0
+#define ADMISSION_GRANTED  1
+#define ADMISSION_ADMIT    2
+
+#define ADMISSION_PARKS (os_LINUX || os_DARWIN)
+
+typedef struct ThreadAdmission {
+    struct ThreadAdmission *next;
+    struct ThreadAdmission *admitter;
+
+    /* The batch to admit when this request is handed the admission (ADMISSION_ADMIT). */
+    struct ThreadAdmission *batch;
+
+    /* Arguments and result of the VmThread.add() upcall. */
+    jint id;
+    jboolean daemon;
+    Address nativeThread;
+    TLA etla;
+    NativeThreadLocals ntl;
+    jint result;
+
+    volatile int state;
+    volatile int admittedOther;
+#if !ADMISSION_PARKS
+    mutex_Struct mutex;
+    condition_Struct condition;
+#endif
+} ThreadAdmission;
+
+static ThreadAdmission * volatile thePendingAdmissions = NULL;
+static volatile int theAdmissionInProgress = 0;
+
+/**
+ * Waits until a word of a request owned by the current thread no longer has a given value.
+ */
+static void admissionAwait(ThreadAdmission *owner, volatile int *word, int value) {
+#if ADMISSION_PARKS
+    while (__atomic_load_n(word, __ATOMIC_ACQUIRE) == value) {
+        mutex_park(word, value, 0);
+    }
+#else
+    mutex_enter(&owner->mutex);
+    while (*word == value) {
+        condition_wait(&owner->condition, &owner->mutex);
+    }
+    mutex_exit(&owner->mutex);
+#endif
+}
+
+/**
+ * Sets a word of a request and wakes the thread owning the request if it is waiting for the word to change.
+ */
+static void admissionPost(ThreadAdmission *owner, volatile int *word, int value) {
+#if ADMISSION_PARKS
+    __atomic_store_n(word, value, __ATOMIC_RELEASE);
+    mutex_unpark(word, false);
+#else
+    mutex_enter(&owner->mutex);
+    *word = value;
+    condition_notify(&owner->condition);
+    mutex_exit(&owner->mutex);
+#endif
+}
+
+static void addAdmittedThread(ThreadAdmission *admission) {
+    VmThreadAddMethod addMethod = image_offset_as_address(VmThreadAddMethod, vmThreadAddMethodOffset);
+#if log_THREADS
+    log_print("thread_admit: id=%d, t=%p, calling VmThread.add(): ", admission->id, admission->nativeThread);
+    void image_printAddress(Address address);
+    image_printAddress((Address) addMethod);
+    log_println("");
+#endif
+    NativeThreadLocals ntl = admission->ntl;
+    admission->result = (*addMethod)(admission->id,
+                    admission->daemon,
+                    admission->nativeThread,
+                    admission->etla,
+                    ntl->stackBase,
+                    ntl->stackBase + ntl->stackSize,
+                    ntl->yellowZone);
+}
+
+/**
+ * Lets the thread that made a pending admission request perform its upcall and waits for it to finish.
+ * Must only be called by the admitting thread while it holds the global thread lock.
+ */
+static void admitOther(ThreadAdmission *admitter, ThreadAdmission *admission) {
+    admitter->admittedOther = false;
+    admission->admitter = admitter;
+    admissionPost(admission, &admission->state, ADMISSION_GRANTED);
+    admissionAwait(admitter, &admitter->admittedOther, false);
+}
+
+/**
+ * Takes the list of pending requests and hands it, in arrival order, to its oldest request whose
+ * thread then admits it. Must only be called by a thread that has claimed the admission.
+ *
+ * @return false if there were no pending requests
+ */
+static boolean handOverPendingAdmissions(void) {
+    ThreadAdmission *batch = __sync_lock_test_and_set(&thePendingAdmissions, NULL);
+    if (batch == NULL) {
+        return false;
+    }
+    ThreadAdmission *ordered = NULL;
+    while (batch != NULL) {
+        ThreadAdmission *next = batch->next;
+        batch->next = ordered;
+        ordered = batch;
+        batch = next;
+    }
+    ordered->batch = ordered;
+    admissionPost(ordered, &ordered->state, ADMISSION_ADMIT);
+    return true;
+}
+
+/**
+ * Admits a batch of requests (in arrival order) that includes the request of the calling thread,
+ * and then passes the admission on to the requests that arrived meanwhile, if any.
+ */
+static void admitBatch(ThreadAdmission *self, ThreadAdmission *batch) {
+#if log_THREADS
+    log_println("thread_admit: t=%p acquiring global thread lock", self->nativeThread);
+#endif
+    mutex_enter(globalThreadLock);
+    while (batch != NULL) {
+        ThreadAdmission *next = batch->next;
+        if (batch == self) {
+            addAdmittedThread(self);
+        } else {
+            admitOther(self, batch);
+        }
+        batch = next;
+    }
+    mutex_exit(globalThreadLock);
+#if log_THREADS
+    log_println("thread_admit: t=%p released  global thread lock", self->nativeThread);
+#endif
+
+    while (!handOverPendingAdmissions()) {
+        __sync_lock_release(&theAdmissionInProgress);
+        /* __sync_lock_release is only a release store: without a full fence the re-check of
+         * thePendingAdmissions below could be satisfied before the flag is seen as cleared. A thread
+         * in thread_admit could then push its request and fail its CAS on the flag while this thread
+         * reads an empty list and leaves, with nobody left to admit the request. */
+        __sync_synchronize();
+        /* Requests made after the flag was cleared are admitted by the thread that claims it. This
+         * only repeats if that thread took the list before this one claimed the flag again. */
+        if (__atomic_load_n(&thePendingAdmissions, __ATOMIC_RELAXED) == NULL || !__sync_bool_compare_and_swap(&theAdmissionInProgress, 0, 1)) {
+            return;
+        }
+    }
+}
+
+/**
+ * Adds the current thread to the thread map by calling VmThread.add() while (some thread) holds the global thread lock.
+ *
+ * @return the value returned by VmThread.add()
+ */
+static jint thread_admit(jint id, jboolean daemon, Address nativeThread, TLA etla, NativeThreadLocals ntl) {
+    ThreadAdmission admission;
+    admission.admitter = NULL;
+    admission.batch = NULL;
+    admission.id = id;
+    admission.daemon = daemon;
+    admission.nativeThread = nativeThread;
+    admission.etla = etla;
+    admission.ntl = ntl;
+    admission.state = ADMISSION_PENDING;
+    admission.admittedOther = false;
+#if !ADMISSION_PARKS
+    mutex_initialize(&admission.mutex);
+    condition_initialize(&admission.condition);
+#endif
+
+    ThreadAdmission *head;
+    do {
+        head = __atomic_load_n(&thePendingAdmissions, __ATOMIC_RELAXED);
+        admission.next = head;
+    } while (!__sync_bool_compare_and_swap(&thePendingAdmissions, head, &admission));
+
+    if (__sync_bool_compare_and_swap(&theAdmissionInProgress, 0, 1)) {
+        /* The list now includes this request as it cannot be taken without claiming the admission. */
+        handOverPendingAdmissions();
+    }
+
+    /* Either an admitter grants this request or this thread is handed the batch containing it. */
+    admissionAwait(&admission, &admission.state, ADMISSION_PENDING);
+    if (admission.state == ADMISSION_ADMIT) {
+        admitBatch(&admission, admission.batch);
+    } else {
+        addAdmittedThread(&admission);
+        ThreadAdmission *admitter = admission.admitter;
+        admissionPost(admitter, &admitter->admittedOther, true);
+    }
+
+#if !ADMISSION_PARKS
+    condition_destroy(&admission.condition);
+    mutex_dispose(&admission.mutex);
+#endif
+    return admission.result;
+}
+
 /**
  * The start routine called by the native threading library once the new thread starts.
  *
@@ -248,53 +696,23 @@ void *thread_run(void *arg) {
     }
     NativeThreadLocals ntl = NATIVE_THREAD_LOCALS_FROM_TLBLOCK(tlBlock);
 
-    /* Grab the global thread lock so that:
-     *   1. This thread can atomically be added to the thread list
-     *   2. This thread is blocked if a GC is currently underway. Once we have the lock,
-     *      GC is blocked and cannot occur until we completed the upcall to
-     *      VmThread.add().
-     */
-#if log_THREADS
-    log_println("thread_run: t=%p acquiring global thread lock", nativeThread);
-#endif
-    mutex_enter(globalThreadLock);
-#if log_THREADS
-    log_println("thread_run: t=%p acquired  global thread lock", nativeThread);
-#endif
-
-    VmThreadAddMethod addMethod = image_offset_as_address(VmThreadAddMethod, vmThreadAddMethodOffset);
-
-#if log_THREADS
-    log_print("thread_run: id=%d, t=%p, calling VmThread.add(): ", id, nativeThread);  
-    void image_printAddress(Address address);
-    image_printAddress((Address) addMethod);
-    log_println("");
-#endif
+    /* Add this thread to the thread list. This is done while the global thread lock is held so that
+     * this thread is blocked if a GC is currently underway. Once the lock is held, GC is blocked
+     * and cannot occur until the upcall to VmThread.add() has completed. */
+    int result = thread_admit(id, false, nativeThread, etla, ntl);
     Address stackEnd = ntl->stackBase + ntl->stackSize;
-    int result = (*addMethod)(id,
-              false,
-              nativeThread,
-              etla,
-              ntl->stackBase,
-              stackEnd,
-              ntl->yellowZone);
-
-#if log_THREADS
-    log_println("thread_run: t=%p releasing global GC and thread list lock", nativeThread);
-#endif
-    mutex_exit(globalThreadLock);
-#if log_THREADS
-    log_println("thread_run: t=%p released  global GC and thread list lock", nativeThread);
-#endif
 
     /* Adding a VM created thread to the thread list should never fail. */
     c_ASSERT(result == 0 || result == 1);
     setCurrentThreadSignalMask(result == 1);
+    sampler_threadStarted();
+    trace_threadStarted(tlBlock, ntl->stackBase, ntl->stackSize);
 
     VmThreadRunMethod runMethod = image_offset_as_address(VmThreadRunMethod, vmThreadRunMethodOffset);
 
 #if log_THREADS
     log_print("thread_run: id=%d, t=%p, calling VmThread.run(): ", id, nativeThread);
+    void image_printAddress(Address address);
     image_printAddress((Address) runMethod);
     log_println("");
 #endif
@@ -304,12 +722,69 @@ void *thread_run(void *arg) {
     log_println("thread_run: END t=%p", nativeThread);
 #endif
 
+    trace_threadExiting(tlBlock);
+    aio_threadExiting();
+    sampler_threadExiting();
     setCurrentThreadSignalMaskOnThreadExit(result == 1);
 
     /* Successful thread exit */
     return NULL;
 }
 
+static boolean dormantAttach = false;
+
+static int detachCurrent(boolean keepDormant);
+
+void thread_setDormantAttach(boolean dormant) {
+    dormantAttach = dormant;
+}
+
+static jclass vmThreadClass;
+static jmethodID vmThreadBecomeDormantMethod;
+static jmethodID vmThreadAwakenMethod;
+
+/**
+ * Looks up the methods of VmThread that make an attached thread dormant and running again.
+ */
+static boolean lookupDormancyMethods(JNIEnv *env) {
+    if (vmThreadAwakenMethod != NULL) {
+        return true;
+    }
+    jclass c = (*env)->FindClass(env, "com/sun/max/vm/thread/VmThread");
+    if (c == NULL) {
+        (*env)->ExceptionClear(env);
+        return false;
+    }
+    vmThreadBecomeDormantMethod = (*env)->GetStaticMethodID(env, c, "becomeDormant", "()V");
+    jmethodID awaken = (*env)->GetStaticMethodID(env, c, "awaken", "(JZ)I");
+    if (vmThreadBecomeDormantMethod == NULL || awaken == NULL) {
+        (*env)->ExceptionClear(env);
+        return false;
+    }
+    vmThreadClass = (jclass) (*env)->NewGlobalRef(env, c);
+    __atomic_store_n(&vmThreadAwakenMethod, awaken, __ATOMIC_RELEASE);
+    return true;
+}
+
+/**
+ * Makes the current, dormant thread running again.
+ *
+ * @return the value returned by VmThread.awaken()
+ */
+static int thread_awaken(JNIEnv *env, JavaVMAttachArgs* args, boolean daemon) {
+    NativeThreadLocals ntl = NATIVE_THREAD_LOCALS_FROM_TLBLOCK(threadLocalsBlock_current());
+    jint result = (*env)->CallStaticIntMethod(env, vmThreadClass, vmThreadAwakenMethod,
+                    (jlong) (Address) (args == NULL ? NULL : args->name), (jboolean) daemon);
+    if ((*env)->ExceptionCheck(env)) {
+        (*env)->ExceptionClear(env);
+        result = JNI_ERR;
+    }
+    if (result == JNI_OK) {
+        ntl->dormant = 0;
+    }
+    return result;
+}
+
 /**
  * Support for the AttachCurrentThread/AttachCurrentThreadAsDaemon JNI functions.
  *
@@ -321,12 +796,26 @@ int thread_attachCurrent(void **penv, JavaVMAttachArgs* args, boolean daemon) {
     log_println("thread_attach: BEGIN t=%p", nativeThread);
 #endif
     if (tla_current() != 0) {
-        // If the thread has been attached, this operation is a no-op
-        *penv = (void *) currentJniEnv();
+        NativeThreadLocals ntl = NATIVE_THREAD_LOCALS_FROM_TLBLOCK(threadLocalsBlock_current());
+        if (!ntl->dormant) {
+            // If the thread has been attached, this operation is a no-op
+            *penv = (void *) currentJniEnv();
 #if log_THREADS
     log_println("thread_attach: END t=%p (already attached)", nativeThread);
 #endif
-        return JNI_OK;
+            return JNI_OK;
+        }
+        int result = thread_awaken((JNIEnv *) currentJniEnv(), args, daemon);
+        if (result != JNI_ERR) {
+            *penv = result == JNI_OK ? (void *) currentJniEnv() : NULL;
+#if log_THREADS
+    log_println("thread_attach: END t=%p (dormant, result=%d)", nativeThread, result);
+#endif
+            return result;
+        }
+        /* The daemon status changed: tear the thread down and attach it afresh. */
+        ntl->dormant = 0;
+        detachCurrent(false);
     }
 
     /* Give the thread a temporary id based on its native handle. The id must
@@ -343,43 +832,16 @@ int thread_attachCurrent(void **penv, JavaVMAttachArgs* args, boolean daemon) {
 
     while (true) {
 
-        /* Grab the global thread lock so that:
-         *   1. This thread can atomically be added to the thread list
-         *   2. This thread is blocked if a GC is currently underway. Once we have the lock,
-         *      GC is blocked and cannot occur until we completed the upcall to
-         *      VmThread.attach().
-         */
-#if log_THREADS
-    log_println("thread_attach: t=%p acquiring global GC and thread list lock", nativeThread);
-#endif
-        mutex_enter(globalThreadLock);
-
-        VmThreadAddMethod addMethod = image_offset_as_address(VmThreadAddMethod, vmThreadAddMethodOffset);
-
-#if log_THREADS
-        log_print("thread_attach: id=%d, t=%p, calling VmThread.add(): ", id, nativeThread);
-        void image_printAddress(Address address);
-        image_printAddress((Address) addMethod);
-        log_println("");
-#endif
-        Address stackEnd = ntl->stackBase + ntl->stackSize;
-        int result = (*addMethod)(id,
-                        daemon,
-                        nativeThread,
-                        etla,
-                        ntl->stackBase,
-                        stackEnd,
-                        ntl->yellowZone);
-        mutex_exit(globalThreadLock);
-#if log_THREADS
-    log_println("thread_attach: t=%p released global GC and thread list lock", nativeThread);
-#endif
+        /* Add this thread to the thread list while the global thread lock is held (see thread_run()). */
+        int result = thread_admit(id, daemon, nativeThread, etla, ntl);
 
         if (result == 0) {
             id = tla_load(jint, etla, ID);
 
             /* TODO: Save current thread signal mask so that it can be restored when this thread is detached. */
             setCurrentThreadSignalMask(false);
+            sampler_threadStarted();
+            trace_threadStarted(tlBlock, ntl->stackBase, ntl->stackSize);
             break;
         } else if (result == -1) {
 #if log_THREADS
@@ -429,7 +891,12 @@ int thread_attachCurrent(void **penv, JavaVMAttachArgs* args, boolean daemon) {
     return result;
 }
 
-int thread_detachCurrent() {
+/**
+ * Detaches the current thread.
+ *
+ * @param keepDormant specifies if a thread that was attached through JNI is kept dormant instead of being torn down
+ */
+static int detachCurrent(boolean keepDormant) {
     Address tlBlock = threadLocalsBlock_current();
     if (tlBlock == 0) {
         // If the thread has been detached, this operation is a no-op
@@ -439,6 +906,30 @@ int thread_detachCurrent() {
         return JNI_OK;
     }
 
+    NativeThreadLocals ntl = NATIVE_THREAD_LOCALS_FROM_TLBLOCK(tlBlock);
+    if (ntl->dormant) {
+        return JNI_OK;
+    }
+    const jboolean attached = ntl->redZone == ntl->stackBase;
+    if (keepDormant && attached && tla_load(jint, ETLA_FROM_TLBLOCK(tlBlock), ID) >= 0) {
+        /* Keep the thread dormant unless there is a pending exception, which a full detach reports. */
+        JNIEnv *env = (JNIEnv *) currentJniEnv();
+        if (!(*env)->ExceptionCheck(env) && lookupDormancyMethods(env)) {
+            (*env)->CallStaticVoidMethod(env, vmThreadClass, vmThreadBecomeDormantMethod);
+            if (!(*env)->ExceptionCheck(env)) {
+                ntl->dormant = 1;
+#if log_THREADS
+                log_println("thread_detach: END (dormant)");
+#endif
+                return JNI_OK;
+            }
+            (*env)->ExceptionClear(env);
+        }
+    }
+
+    trace_threadExiting(tlBlock);
+    aio_threadExiting();
+    sampler_threadExiting();
     setCurrentThreadSignalMaskOnThreadExit(false);
 
     threadLocalsBlock_setCurrent(0);
@@ -446,6 +937,10 @@ int thread_detachCurrent() {
     return JNI_OK;
 }
 
+int thread_detachCurrent() {
+    return detachCurrent(dormantAttach);
+}
+
 /**
  * Declared in VmThreadMap.java.
  */
@@ -468,18 +963,49 @@ void nativeBlockOnThreadLock() {
  * Create a thread.
  * @C_FUNCTION - called from Java
  */
-Address nativeThreadCreate(jint id, Size stackSize, jint priority) {
-    return (Address) thread_create(id, stackSize, priority);
+Address nativeThreadCreate(jint id, Size stackSize, jint priority, jint cpu, jint node) {
+    return (Address) thread_create(id, stackSize, priority, cpu, node);
+}
+
+/**
+ * Binds the current thread to a CPU or NUMA node and moves its thread locals block and stack to the
+ * node it then runs on.
+ *
+ * @param cpu the CPU to bind to or -1
+ * @param node the NUMA node to bind to or -1 (ignored if cpu != -1)
+ * @return true if the thread was bound, false otherwise
+ */
+static jboolean thread_bindCurrent(int cpu, int node) {
+#if os_LINUX
+    cpu_set_t cpus;
+    if (!affinityCPUs(cpu, node, &cpus) || pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) != 0) {
+        return false;
+    }
+    NativeThreadLocals ntl = nativeThreadLocals_current();
+    if (ntl != NULL) {
+        int memoryNode = cpu >= 0 ? nodeOfCPU(cpu) : node;
+        if (memoryNode >= 0) {
+            placeOnNode(ntl->tlBlock, ntl->tlBlockSize, memoryNode);
+            placeOnNode(ntl->stackBase, ntl->stackSize, memoryNode);
+        }
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_sun_max_vm_thread_VmThread_nativeBindCurrentThread(JNIEnv *env, jclass c, jint cpu, jint node) {
+    return thread_bindCurrent(cpu, node);
 }
 
 JNIEXPORT void JNICALL
 Java_com_sun_max_vm_thread_VmThread_nativeYield(JNIEnv *env, jclass c) {
 #if os_SOLARIS
     thr_yield();
-#elif os_DARWIN
+#elif os_DARWIN || os_LINUX
     sched_yield();
-#elif os_LINUX
-    pthread_yield();
 #elif os_MAXVE
     maxve_yield();
 #else
@@ -523,24 +1049,67 @@ Java_com_sun_max_vm_thread_VmThread_nativeInterrupt(JNIEnv *env, jclass c, Addre
  #endif
 }
 
-jboolean thread_sleep(jlong numberOfMilliSeconds) {
+#if os_LINUX || os_DARWIN || os_SOLARIS
+#include <time.h>
+
+#define NANOS_PER_SECOND (1000LL * 1000 * 1000)
+
+static jlong monotonicNanos(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((jlong) now.tv_sec) * NANOS_PER_SECOND + now.tv_nsec;
+}
+#endif
+
+jlong thread_sleepNanos(jlong nanos) {
+    if (nanos <= 0) {
+        return 0;
+    }
 #if os_MAXVE
-    return maxve_sleep(numberOfMilliSeconds * 1000000);
+    return maxve_sleep(nanos) ? 1 : 0;
 #else
-    struct timespec time, remainder;
+    /* The sleep is to an absolute deadline so that the time already slept is never slept again. */
+    jlong now = monotonicNanos();
+    jlong deadline = nanos > INT64_MAX - now ? INT64_MAX : now + nanos;
+#if os_LINUX || os_SOLARIS
+    struct timespec time;
+    time.tv_sec = deadline / NANOS_PER_SECOND;
+    time.tv_nsec = deadline % NANOS_PER_SECOND;
+    int error = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &time, NULL);
+#else
+    /* Darwin has no absolute sleep, so the time remaining is measured against the deadline afterwards. */
+    struct timespec time;
+    time.tv_sec = nanos / NANOS_PER_SECOND;
+    time.tv_nsec = nanos % NANOS_PER_SECOND;
+    int error = nanosleep(&time, NULL) == 0 ? 0 : errno;
+#endif
+    if (error == 0) {
+        return 0;
+    }
+    jlong remaining = deadline - monotonicNanos();
+    if (error != EINTR) {
+        log_println("Call to clock_nanosleep failed (other than by being interrupted): %s [remaining nano sec: %ld]", strerror(error), remaining);
+    }
+    /* An interrupted sleep always reports some time remaining so that it can be told apart from a completed one. */
+    return remaining > 0 ? remaining : 1;
+#endif
+}
 
-    time.tv_sec = numberOfMilliSeconds / 1000;
-    time.tv_nsec = (numberOfMilliSeconds % 1000) * 1000000;
-    int value = nanosleep(&time, &remainder);
+jboolean thread_sleep(jlong numberOfMilliSeconds) {
+    /* Saturate rather than overflow so that, e.g., Thread.sleep(Long.MAX_VALUE) does not return at once. */
+    jlong nanos = numberOfMilliSeconds > INT64_MAX / 1000000 ? INT64_MAX : numberOfMilliSeconds * 1000000;
+    return thread_sleepNanos(nanos) != 0;
+}
 
-    if (value == -1) {
-        int error = errno;
-        if (error != EINTR && error != 0) {
-            log_println("Call to nanosleep failed (other than by being interrupted): %s [remaining sec: %d, remaining nano sec: %d]", strerror(error), remainder.tv_sec,
-                            remainder.tv_nsec);
-        }
+jlong thread_setTimerSlack(jlong nanos) {
+#if os_LINUX && defined(PR_SET_TIMERSLACK)
+    int previous = prctl(PR_GET_TIMERSLACK, 0, 0, 0, 0);
+    if (previous < 0 || prctl(PR_SET_TIMERSLACK, (unsigned long) nanos, 0, 0, 0) != 0) {
+        return -1;
     }
-    return value;
+    return previous;
+#else
+    return -1;
 #endif
 }
 
@@ -553,6 +1122,64 @@ Java_com_sun_max_vm_thread_VmThread_nativeSleep(JNIEnv *env, jclass c, jlong num
     return thread_sleep(numberOfMilliSeconds);
 }
 
+JNIEXPORT jlong JNICALL
+Java_com_sun_max_vm_thread_VmThread_nativeSleepNanos(JNIEnv *env, jclass c, jlong nanos) {
+    return thread_sleepNanos(nanos);
+}
+
+JNIEXPORT jlong JNICALL
+Java_com_sun_max_vm_thread_VmThread_nativeSetTimerSlack(JNIEnv *env, jclass c, jlong nanos) {
+    return thread_setTimerSlack(nanos);
+}
+
+#if os_LINUX
+#include <time.h>
+#elif os_DARWIN
+#include <mach/mach.h>
+#endif
+
+/*
+ * Gets the CPU time consumed by a native thread in nanoseconds, or -1 if it cannot be measured.
+ * The caller ensures that the thread does not terminate during the call.
+ *
+ * @param userAndSystem specifies if the time spent in the kernel on behalf of the thread is included
+ */
+JNIEXPORT jlong JNICALL
+Java_com_sun_max_vm_thread_VmThread_nativeThreadCpuTime(JNIEnv *env, jclass c, Address nativeThread, jboolean userAndSystem) {
+#if os_LINUX
+    clockid_t clock;
+    struct timespec time;
+    if (pthread_getcpuclockid((pthread_t) nativeThread, &clock) != 0) {
+        return -1;
+    }
+    if (!userAndSystem) {
+        /*
+         * The clock returned by glibc measures user and system time (CPUCLOCK_SCHED). The low two bits of a
+         * thread CPU clock id select what is measured and CPUCLOCK_VIRT measures user time only.
+         */
+        clock = (clock & ~((clockid_t) 3)) | 1;
+    }
+    if (clock_gettime(clock, &time) != 0) {
+        return -1;
+    }
+    return ((jlong) time.tv_sec) * 1000000000LL + time.tv_nsec;
+#elif os_DARWIN
+    thread_basic_info_data_t info;
+    mach_msg_type_number_t count = THREAD_BASIC_INFO_COUNT;
+    mach_port_t port = pthread_mach_thread_np((pthread_t) nativeThread);
+    if (thread_info(port, THREAD_BASIC_INFO, (thread_info_t) &info, &count) != KERN_SUCCESS) {
+        return -1;
+    }
+    jlong nanos = ((jlong) info.user_time.seconds) * 1000000000LL + ((jlong) info.user_time.microseconds) * 1000;
+    if (userAndSystem) {
+        nanos += ((jlong) info.system_time.seconds) * 1000000000LL + ((jlong) info.system_time.microseconds) * 1000;
+    }
+    return nanos;
+#else
+    return -1;
+#endif
+}
+
 JNIEXPORT void JNICALL
 Java_com_sun_max_vm_thread_VmThread_nativeSetPriority(JNIEnv *env, jclass c, Address nativeThread, jint priority) {
 #if os_SOLARIS
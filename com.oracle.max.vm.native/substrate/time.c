@@ -19,6 +19,8 @@
  * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 #include "os.h"
+#include "isa.h"
+#include "word.h"
 #include "jni.h"
 #include "maxine.h"
 
@@ -29,7 +31,237 @@
 #include <mach/mach_time.h>
 #include <mach/kern_return.h>
 #elif os_LINUX
-#include <dlfcn.h>
+#include <fcntl.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#if isa_AMD64
+#include <cpuid.h>
+#endif
+#endif
+
+#if os_LINUX
+
+/*
+ * On Linux, clock_gettime() is serviced by the vDSO without entering the kernel. Where the CPU
+ * has a counter that ticks at a constant rate and is synchronized across cores (an invariant TSC
+ * on AMD64, the virtual counter on AArch64), native_nanoTime() reads the counter directly and
+ * scales it, which is cheaper still.
+ *
+ * The counter frequency is read from cntfrq_el0 on AArch64. The TSC frequency is calibrated
+ * against CLOCK_MONOTONIC over the first COUNTER_CALIBRATION_NANOS after the first call, during
+ * which time clock_gettime() is used (so that startup is not delayed by the calibration).
+ *
+ * Once ready, the counter clock is re-anchored to CLOCK_MONOTONIC every COUNTER_REANCHOR_NANOS so
+ * that it follows NTP slewing of the monotonic clock and any error in the calibrated TSC frequency
+ * does not accumulate. The anchor is published under a sequence lock: the sequence is odd while one
+ * thread updates the anchor (during which readers use clock_gettime()), and readers retry if the
+ * sequence changed while they read it. A new anchor never puts the clock behind the value the old
+ * anchor yields at the same tick.
+ */
+
+#define COUNTER_CLOCK_UNINITIALIZED 0
+#define COUNTER_CLOCK_CALIBRATING   1
+#define COUNTER_CLOCK_READY         2
+#define COUNTER_CLOCK_UNAVAILABLE   3
+#define COUNTER_CLOCK_UPDATING      4
+
+#define COUNTER_CALIBRATION_NANOS (50 * 1000 * 1000LL)
+#define COUNTER_REANCHOR_NANOS (1000 * 1000 * 1000LL)
+
+/* The nanoseconds per tick as a 32.32 fixed point number. */
+#define COUNTER_SCALE_SHIFT 32
+
+#if isa_AMD64 || isa_AARCH64
+typedef unsigned __int128 CounterProduct;
+#else
+typedef Unsigned8 CounterProduct; /* the counter clock is never used on other platforms */
+#endif
+
+static volatile int counterClockState = COUNTER_CLOCK_UNINITIALIZED;
+static volatile Unsigned4 counterSequence;
+static Unsigned8 counterBaseTicks;
+static jlong counterBaseNanos;
+static Unsigned8 counterScale;
+static Unsigned8 counterReanchorTicks;
+
+/* The last simultaneous reading of the counter and CLOCK_MONOTONIC, from which the TSC frequency is recalibrated. */
+static Unsigned8 counterAnchorTicks;
+static jlong counterAnchorNanos;
+
+static jlong monotonicNanos(void) {
+    struct timespec tp;
+    clock_gettime(CLOCK_MONOTONIC, &tp);
+    return ((jlong) tp.tv_sec) * (1000 * 1000 * 1000) + (jlong) tp.tv_nsec;
+}
+
+static inline Unsigned8 readCounter(void) {
+#if isa_AMD64
+    unsigned int low, high;
+    __asm__ __volatile__("rdtsc" : "=a" (low), "=d" (high));
+    return ((Unsigned8) high << 32) | low;
+#elif isa_AARCH64
+    Unsigned8 ticks;
+    __asm__ __volatile__("isb; mrs %0, cntvct_el0" : "=r" (ticks) :: "memory");
+    return ticks;
+#else
+    return 0;
+#endif
+}
+
+static inline jlong counterClockNanos(Unsigned8 ticks, Unsigned8 baseTicks, jlong baseNanos, Unsigned8 scale) {
+    return baseNanos + (jlong) (((CounterProduct) (ticks - baseTicks) * scale) >> COUNTER_SCALE_SHIFT);
+}
+
+/*
+ * Sets the anchor of the counter clock. Called with the sequence odd (or before the clock is ready).
+ */
+static void counterClockSetAnchor(Unsigned8 ticks, jlong nanos, Unsigned8 scale) {
+    __atomic_store_n(&counterBaseTicks, ticks, __ATOMIC_RELAXED);
+    __atomic_store_n(&counterBaseNanos, nanos, __ATOMIC_RELAXED);
+    __atomic_store_n(&counterScale, scale, __ATOMIC_RELAXED);
+    __atomic_store_n(&counterReanchorTicks, (Unsigned8) ((((CounterProduct) COUNTER_REANCHOR_NANOS) << COUNTER_SCALE_SHIFT) / scale), __ATOMIC_RELAXED);
+}
+
+/*
+ * Re-anchors the counter clock to CLOCK_MONOTONIC, given the anchor read under the (now odd) sequence.
+ */
+static jlong counterClockReanchor(Unsigned4 sequence, Unsigned8 baseTicks, jlong baseNanos, Unsigned8 baseScale) {
+    Unsigned8 ticks = readCounter();
+    jlong nanos = monotonicNanos();
+    Unsigned8 scale = baseScale;
+#if isa_AMD64
+    Unsigned8 elapsedTicks = ticks - counterAnchorTicks;
+    if ((Signed8) elapsedTicks > 0 && nanos > counterAnchorNanos) {
+        scale = (Unsigned8) ((((CounterProduct) (nanos - counterAnchorNanos)) << COUNTER_SCALE_SHIFT) / elapsedTicks);
+    }
+#endif
+    counterAnchorTicks = ticks;
+    counterAnchorNanos = nanos;
+    /* Do not step the clock backwards if it was running ahead of CLOCK_MONOTONIC. */
+    jlong counted = counterClockNanos(ticks, baseTicks, baseNanos, baseScale);
+    if (counted > nanos) {
+        nanos = counted;
+    }
+    counterClockSetAnchor(ticks, nanos, scale);
+    __atomic_store_n(&counterSequence, sequence + 2, __ATOMIC_RELEASE);
+    return nanos;
+}
+
+/*
+ * The fast path of native_nanoTime(), taken once the counter clock is ready.
+ */
+static inline jlong counterClockRead(void) {
+    while (true) {
+        Unsigned4 sequence = __atomic_load_n(&counterSequence, __ATOMIC_ACQUIRE);
+        if ((sequence & 1) != 0) {
+            /* Do not spin on an update whose thread may have been descheduled. */
+            return monotonicNanos();
+        }
+        Unsigned8 ticks = readCounter();
+        Unsigned8 baseTicks = __atomic_load_n(&counterBaseTicks, __ATOMIC_RELAXED);
+        jlong baseNanos = __atomic_load_n(&counterBaseNanos, __ATOMIC_RELAXED);
+        Unsigned8 scale = __atomic_load_n(&counterScale, __ATOMIC_RELAXED);
+        Unsigned8 reanchorTicks = __atomic_load_n(&counterReanchorTicks, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&counterSequence, __ATOMIC_RELAXED) != sequence) {
+            continue;
+        }
+        if (ticks - baseTicks >= reanchorTicks && __sync_bool_compare_and_swap(&counterSequence, sequence, sequence + 1)) {
+            return counterClockReanchor(sequence, baseTicks, baseNanos, scale);
+        }
+        return counterClockNanos(ticks, baseTicks, baseNanos, scale);
+    }
+}
+
+/*
+ * Determines if the counter can be used as a clock source: it must tick at a constant rate in all
+ * power states and the kernel must consider it synchronized across CPUs (i.e. use it as its own clock source).
+ */
+static jboolean counterIsUsable(void) {
+#if isa_AMD64
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) || (edx & (1 << 8)) == 0) {
+        return false;
+    }
+    char clockSource[16] = { 0 };
+    int fd = open("/sys/devices/system/clocksource/clocksource0/current_clocksource", O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    ssize_t n = read(fd, clockSource, sizeof(clockSource) - 1);
+    close(fd);
+    return n >= 3 && strncmp(clockSource, "tsc", 3) == 0;
+#elif isa_AARCH64
+    return true;
+#else
+    return false;
+#endif
+}
+
+/*
+ * The slow path of native_nanoTime(), taken until the counter clock is ready.
+ */
+static jlong counterClockCalibrate(void) {
+    jlong nanos = monotonicNanos();
+    int state = counterClockState;
+    if (state == COUNTER_CLOCK_UNINITIALIZED) {
+        /* Only one thread initializes the counter clock. */
+        if (!__sync_bool_compare_and_swap(&counterClockState, COUNTER_CLOCK_UNINITIALIZED, COUNTER_CLOCK_UPDATING)) {
+            return nanos;
+        }
+        if (!counterIsUsable()) {
+            counterClockState = COUNTER_CLOCK_UNAVAILABLE;
+            return nanos;
+        }
+#if isa_AARCH64
+        Unsigned8 frequency;
+        __asm__ __volatile__("mrs %0, cntfrq_el0" : "=r" (frequency));
+        counterAnchorTicks = readCounter();
+        counterAnchorNanos = monotonicNanos();
+        counterClockSetAnchor(counterAnchorTicks, counterAnchorNanos, (((Unsigned8) 1000 * 1000 * 1000) << COUNTER_SCALE_SHIFT) / frequency);
+        __atomic_store_n(&counterClockState, COUNTER_CLOCK_READY, __ATOMIC_RELEASE);
+        return counterAnchorNanos;
+#else
+        counterBaseTicks = readCounter();
+        counterBaseNanos = monotonicNanos();
+        __atomic_store_n(&counterClockState, COUNTER_CLOCK_CALIBRATING, __ATOMIC_RELEASE);
+#endif
+    } else if (state == COUNTER_CLOCK_CALIBRATING && nanos - counterBaseNanos >= COUNTER_CALIBRATION_NANOS) {
+        /* Only one thread completes the calibration. */
+        if (__sync_bool_compare_and_swap(&counterClockState, COUNTER_CLOCK_CALIBRATING, COUNTER_CLOCK_UPDATING)) {
+            Unsigned8 ticks = readCounter();
+            nanos = monotonicNanos();
+            Unsigned8 elapsedTicks = ticks - counterBaseTicks;
+            Unsigned8 scale = (Unsigned8) ((((CounterProduct) (nanos - counterBaseNanos)) << COUNTER_SCALE_SHIFT) / elapsedTicks);
+            /* Rebase so that the counter clock continues from the current monotonic time. */
+            counterAnchorTicks = ticks;
+            counterAnchorNanos = nanos;
+            counterClockSetAnchor(ticks, nanos, scale);
+            __atomic_store_n(&counterClockState, COUNTER_CLOCK_READY, __ATOMIC_RELEASE);
+        }
+    }
+    return nanos;
+}
+
+/*
+ * The clock used by native_currentTimeMillis(): the coarse real time clock if it has at least millisecond resolution.
+ */
+static clockid_t realTimeClock(void) {
+    static clockid_t clock = -1;
+    if (clock == -1) {
+        clockid_t result = CLOCK_REALTIME;
+#ifdef CLOCK_REALTIME_COARSE
+        struct timespec resolution;
+        if (clock_getres(CLOCK_REALTIME_COARSE, &resolution) == 0 && resolution.tv_sec == 0 && resolution.tv_nsec <= 1000 * 1000) {
+            result = CLOCK_REALTIME_COARSE;
+        }
+#endif
+        clock = result;
+    }
+    return clock;
+}
+
 #endif
 
 
@@ -70,62 +302,21 @@ jlong native_nanoTime(void) {
 	gettimeofday(&tv, NULL);
 	return (uint64_t)tv.tv_sec * (uint64_t)(1000 * 1000 * 1000) + (uint64_t)(tv.tv_usec * 1000);
 #elif os_LINUX
-
-#ifndef CLOCK_MONOTONIC
-#define CLOCK_MONOTONIC (1)
-#endif
-
-    static int (*clock_gettime_func)(clockid_t, struct timespec*) = NULL;
-    static int initialized = 0;
-
-    if (!initialized) {
-        initialized = 1;
-
-        /* This code is adopted from the HotSpot handling of System.nanoTime for Linux */
-        /* we do dlopen's in this particular order due to bug in linux
-           dynamical loader (see 6348968) leading to crash on exit */
-        void* handle = dlopen("librt.so.1", RTLD_LAZY);
-        if (handle == NULL) {
-            handle = dlopen("librt.so", RTLD_LAZY);
-        }
-
-        if (handle) {
-            clock_gettime_func = (int(*)(clockid_t, struct timespec*))dlsym(handle, "clock_gettime");
-            if (clock_gettime_func) {
-                struct timespec tp;
-                if (clock_gettime_func(CLOCK_MONOTONIC, &tp) != 0) {
-                    /* monotonic clock is not supported */
-                    clock_gettime_func = NULL;
-                    dlclose(handle);
-                }
-            }
-        }
-	}
-
-    if (clock_gettime_func != NULL) {
-        struct timespec tp;
-        clock_gettime_func(CLOCK_MONOTONIC, &tp);
-#ifdef arm
-	return ((long long) tp.tv_sec) * (1000 * 1000 * 1000) + (long long) tp.tv_nsec;
-#else
-    return ((jlong)tp.tv_sec) * (1000 * 1000 * 1000) + (jlong) tp.tv_nsec;
-#endif
-
+    if (__atomic_load_n(&counterClockState, __ATOMIC_ACQUIRE) == COUNTER_CLOCK_READY) {
+        return counterClockRead();
     }
-
-    /* worst case: fallback to gettimeofday(). */
-    struct timeval time;
-    int status = gettimeofday(&time, NULL);
-    c_ASSERT(status != -1);
-    jlong usecs = ((jlong) time.tv_sec) * (1000 * 1000) + (jlong) time.tv_usec;
-    return 1000 * usecs;
+    return counterClockCalibrate();
 #else
 	return 1;
 #endif
 }
 
 jlong native_currentTimeMillis(void) {
-#if os_SOLARIS || os_DARWIN || os_LINUX
+#if os_LINUX
+    struct timespec tp;
+    clock_gettime(realTimeClock(), &tp);
+    return ((jlong) tp.tv_sec * 1000) + ((jlong) tp.tv_nsec / (1000 * 1000));
+#elif os_SOLARIS || os_DARWIN
 	struct timeval tv;
 	gettimeofday(&tv, NULL);
 	// we need to cast to jlong to avoid overflows in ARMv7
@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2011, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "c.h"
+#include "image.h"
+#include "log.h"
+#include "maxine.h"
+#include "os.h"
+#include "trace.h"
+
+#if os_LINUX || os_DARWIN
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#if os_LINUX
+#include <sys/syscall.h>
+#endif
+
+/*
+ * The mapped trace file of the current thread. The initial-exec model guarantees that accessing
+ * this variable from a signal handler does not allocate.
+ */
+static __thread TraceFileHeader theCurrentTraceFile __attribute__((tls_model("initial-exec")));
+
+static char *theTraceDirectory;
+
+static Unsigned8 theTraceStartNanos;
+
+static Unsigned4 currentThreadId(void) {
+#if os_LINUX
+    return (Unsigned4) syscall(__NR_gettid);
+#else
+    Unsigned8 id;
+    pthread_threadid_np(NULL, &id);
+    return (Unsigned4) id;
+#endif
+}
+
+static Size traceFileSize(void) {
+    return sizeof(TraceFileHeaderStruct) + TRACE_RECORDS_PER_THREAD * sizeof(TraceRecordStruct);
+}
+
+/*
+ * Saves the memory map of the process next to the trace files so that tracedump can describe native addresses.
+ */
+static void saveMemoryMap(void) {
+#if os_LINUX
+    char path[MAX_PATH_LENGTH];
+    snprintf(path, sizeof(path), "%s/maxine-%d.maps", theTraceDirectory, (int) getpid());
+    int in = open("/proc/self/maps", O_RDONLY);
+    if (in < 0) {
+        return;
+    }
+    int out = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (out >= 0) {
+        char buffer[4096];
+        ssize_t n;
+        while ((n = read(in, buffer, sizeof(buffer))) > 0) {
+            if (write(out, buffer, n) != n) {
+                break;
+            }
+        }
+        close(out);
+    }
+    close(in);
+#endif
+}
+
+void trace_initialize(const char *directory) {
+    if (directory == NULL) {
+        return;
+    }
+    theTraceDirectory = strdup(directory);
+    theTraceStartNanos = native_nanoTime();
+    /* The libraries loaded later are only in the map saved when the VM exits. */
+    saveMemoryMap();
+    atexit(saveMemoryMap);
+}
+
+void trace_threadStarted(Address tlBlock, Address stackBase, Size stackSize) {
+    if (theTraceDirectory == NULL) {
+        return;
+    }
+    Unsigned4 thread = currentThreadId();
+    char path[MAX_PATH_LENGTH];
+    snprintf(path, sizeof(path), "%s/maxine-%d-%u.trace", theTraceDirectory, (int) getpid(), thread);
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        log_println("trace: could not create %s: %s", path, strerror(errno));
+        return;
+    }
+    Size size = traceFileSize();
+    if (ftruncate(fd, size) != 0) {
+        log_println("trace: could not extend %s: %s", path, strerror(errno));
+        close(fd);
+        return;
+    }
+    void *mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    /* The mapping keeps the file open. */
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        log_println("trace: could not map %s: %s", path, strerror(errno));
+        return;
+    }
+    TraceFileHeader header = (TraceFileHeader) mapping;
+    header->version = TRACE_VERSION;
+    header->recordSize = sizeof(TraceRecordStruct);
+    header->capacity = TRACE_RECORDS_PER_THREAD;
+    header->pid = getpid();
+    header->thread = thread;
+    header->heap = image_heap();
+    header->code = image_code();
+    header->codeEnd = image_code_end();
+    header->startNanos = theTraceStartNanos;
+    header->next = 0;
+    /* A file with a valid magic number is complete. */
+    __sync_synchronize();
+    header->magic = TRACE_MAGIC;
+    theCurrentTraceFile = header;
+
+    trace_event(TRACE_THREAD_START, tlBlock, stackBase, stackSize);
+}
+
+void trace_threadExiting(Address tlBlock) {
+    TraceFileHeader header = theCurrentTraceFile;
+    if (header == NULL) {
+        return;
+    }
+    trace_event(TRACE_THREAD_EXIT, tlBlock, 0, 0);
+    /* An event recorded by a signal handler from now on is ignored. */
+    theCurrentTraceFile = NULL;
+    munmap((void *) header, traceFileSize());
+}
+
+void trace_event(jint event, Address a, Address b, Address c) {
+    TraceFileHeader header = theCurrentTraceFile;
+    if (header == NULL) {
+        return;
+    }
+    /* An atomic increment so that an event recorded by a signal handler interrupting this function gets its own slot. */
+    Unsigned8 index = __sync_fetch_and_add(&header->next, 1);
+    TraceRecord record = &((TraceRecord) (header + 1))[index % TRACE_RECORDS_PER_THREAD];
+    record->nanos = native_nanoTime();
+    record->event = event;
+    record->thread = (Unsigned4) header->thread;
+    record->payload[0] = a;
+    record->payload[1] = b;
+    record->payload[2] = c;
+}
+
+#else
+
+void trace_initialize(const char *directory) {
+}
+
+void trace_threadStarted(Address tlBlock, Address stackBase, Size stackSize) {
+}
+
+void trace_threadExiting(Address tlBlock) {
+}
+
+void trace_event(jint event, Address a, Address b, Address c) {
+}
+
+#endif
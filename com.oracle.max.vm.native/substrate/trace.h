@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2011, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ */
+#ifndef __trace_h__
+#define __trace_h__ 1
+
+#include "word.h"
+#include "jni.h"
+
+/*
+ * Binary tracing (-XX:BinaryTrace=<directory>).
+ *
+ * Every thread writes fixed size, timestamped records into a ring that is a memory mapped file in
+ * the trace directory named 'maxine-<pid>-<tid>.trace'. Recording an event takes no locks and makes
+ * no system calls, so events can be recorded from signal handlers. The records are decoded offline
+ * by the tracedump tool (see trace/tracedump.c), which uses the heap and code addresses saved in the
+ * file headers and the memory map of the process saved in 'maxine-<pid>.maps' to describe the payloads.
+ */
+
+#define TRACE_MAGIC 0x5254584D /* "MXTR" */
+#define TRACE_VERSION 1
+
+/*
+ * The number of records in the ring of each thread.
+ */
+#define TRACE_RECORDS_PER_THREAD (64 * 1024)
+
+#define TRACE_PAYLOAD_WORDS 3
+
+/*
+ * The events recorded by the substrate. Event ids below TRACE_FIRST_VM_EVENT are reserved for the substrate.
+ */
+#define TRACE_EVENTS(e) \
+    e(THREAD_START, 1)   /* payload: thread locals block, stack base, stack size */ \
+    e(THREAD_EXIT, 2)    /* payload: thread locals block */ \
+    e(TRAP, 3)           /* payload: signal number, instruction pointer, fault address */
+
+#define TRACE_EVENT_ENUM(name, id) TRACE_##name = id,
+enum {
+    TRACE_EVENTS(TRACE_EVENT_ENUM)
+    TRACE_FIRST_VM_EVENT = 256
+};
+#undef TRACE_EVENT_ENUM
+
+typedef struct {
+    Unsigned8 nanos;
+    Unsigned4 event;
+    Unsigned4 thread;
+    Unsigned8 payload[TRACE_PAYLOAD_WORDS];
+} TraceRecordStruct, *TraceRecord;
+
+/*
+ * The header of a trace file, followed by 'capacity' records. All fields are in the byte order of the traced process.
+ */
+typedef struct {
+    Unsigned4 magic;
+    Unsigned4 version;
+    Unsigned4 recordSize;
+    Unsigned4 capacity;
+    Unsigned8 pid;
+    Unsigned8 thread;
+    Unsigned8 heap;              // start of the boot heap, see image_printAddress()
+    Unsigned8 code;              // start of the boot code
+    Unsigned8 codeEnd;
+    Unsigned8 startNanos;        // native_nanoTime() when tracing was initialized
+    volatile Unsigned8 next;     // the number of records ever written, the next record is at 'next % capacity'
+    Unsigned8 reserved[7];
+} TraceFileHeaderStruct, *TraceFileHeader;
+
+/**
+ * Enables tracing into a given directory. This must be called on the primordial thread after the image has been loaded.
+ *
+ * @param directory the directory for the trace files or NULL if tracing is disabled
+ */
+extern void trace_initialize(const char *directory);
+
+/**
+ * Creates the trace file of the current thread.
+ */
+extern void trace_threadStarted(Address tlBlock, Address stackBase, Size stackSize);
+
+/**
+ * Closes the trace file of the current thread.
+ */
+extern void trace_threadExiting(Address tlBlock);
+
+/**
+ * Records an event for the current thread. This is async-signal-safe and does nothing if the thread has no trace file.
+ */
+extern void trace_event(jint event, Address a, Address b, Address c);
+
+#endif /*__trace_h__*/
@@ -29,6 +29,9 @@
 #include "isa.h"
 #include "image.h"
 #include "trap.h"
+#include "sampler.h"
+#include "stackWalk.h"
+#include "trace.h"
 
 #if os_SOLARIS && isa_SPARC
     /* Get STACK_BIAS definition for Solaris / SPARC */
@@ -184,6 +187,52 @@ static Address getInstructionPointer(UContext *ucontext) {
 #endif
 }
 
+#if !os_MAXVE
+static Address getStackPointer(UContext *ucontext) {
+#if os_SOLARIS
+    return ucontext->uc_mcontext.gregs[REG_SP];
+#elif os_LINUX
+#   if isa_AMD64
+    return ucontext->uc_mcontext.gregs[REG_RSP];
+#   elif isa_IA32
+    return ucontext->uc_mcontext.gregs[REG_ESP];
+#   elif isa_ARM
+    return ucontext->uc_mcontext.arm_sp;
+#   elif isa_AARCH64
+    return ucontext->uc_mcontext.sp;
+#   elif isa_RISCV64
+    return ucontext->uc_mcontext.__gregs[2];
+#   endif
+#elif os_DARWIN
+    return ucontext->uc_mcontext->__ss.__rsp;
+#else
+    c_UNIMPLEMENTED();
+#endif
+}
+
+static Address getFramePointer(UContext *ucontext) {
+#if os_SOLARIS
+    return ucontext->uc_mcontext.gregs[REG_FP];
+#elif os_LINUX
+#   if isa_AMD64
+    return ucontext->uc_mcontext.gregs[REG_RBP];
+#   elif isa_IA32
+    return ucontext->uc_mcontext.gregs[REG_EBP];
+#   elif isa_ARM
+    return ucontext->uc_mcontext.arm_fp;
+#   elif isa_AARCH64
+    return ucontext->uc_mcontext.regs[29];
+#   elif isa_RISCV64
+    return ucontext->uc_mcontext.__gregs[8];
+#   endif
+#elif os_DARWIN
+    return ucontext->uc_mcontext->__ss.__rbp;
+#else
+    c_UNIMPLEMENTED();
+#endif
+}
+#endif
+
 static void setInstructionPointer(UContext *ucontext, Address stub) {
 #if os_SOLARIS
 #   if isa_SPARC
@@ -354,6 +403,42 @@ static void logTrap(int signal, Address ip, Address fault, TLA dtla) {
     log_unlock();
 }
 
+/*
+ * The maximum number of frames printed by logStack().
+ */
+#define LOG_STACK_FRAMES 32
+
+/**
+ * Prints the frames found by the native stack walker for the thread that took a fatal trap.
+ */
+static void logStack(UContext *ucontext) {
+#if !os_MAXVE
+    static const char *kinds[] = { "interrupted", "native", "java call", "java entry" };
+    StackWalkFrameStruct frames[LOG_STACK_FRAMES];
+    int count = stackWalk_walk(getInstructionPointer(ucontext), getStackPointer(ucontext), getFramePointer(ucontext), frames, LOG_STACK_FRAMES);
+    int i;
+    log_lock();
+    log_println("  Native stack:");
+    for (i = 0; i < count; i++) {
+        log_print("    [%2d] %-11s ip=%p sp=%p fp=%p ", i, kinds[frames[i].kind], frames[i].ip, frames[i].sp, frames[i].fp);
+        if (frames[i].ip != 0) {
+            log_print_symbol(frames[i].ip);
+        }
+        log_print_newline();
+    }
+    log_unlock();
+#endif
+}
+
+/**
+ * Counts a trap taken by the current thread.
+ */
+static inline void countTrap(NativeThreadLocals ntl, int kind) {
+    if (ntl != 0) {
+        ntl->trapCounts[kind]++;
+    }
+}
+
 /**
  * The handler for signals dealt with by Stubs.trapStub.
  */
@@ -369,9 +454,15 @@ static void vmSignalHandler(int signal, SigInfo *signalInfo, UContext *ucontext)
         ucontext->uc_mcontext.arm_cpsr = ucontext->uc_mcontext.arm_cpsr & 0xffffffdf;
     }
 #endif
+    if (trapNumber == MEMORY_FAULT && image_relocateOnFault(faultAddress)) {
+        /* The fault was on a boot image page that had not yet been relocated. */
+        return;
+    }
+
     /* Only VM signals should get here. */
     if (trapNumber < 0) {
         logTrap(signal, ip, faultAddress, 0);
+        logStack(ucontext);
         log_exit(-22, "Non VM signal %d should be handled by the Java signal handler", signal);
     }
 
@@ -381,6 +472,7 @@ static void vmSignalHandler(int signal, SigInfo *signalInfo, UContext *ucontext)
         if (traceTraps || log_TRAP) {
             log_println("SIGNAL: Handled Integer.MIN_VALUE / -1");
         }
+        countTrap(nativeThreadLocals_current(), TRAP_COUNT_DIVIDE_OVERFLOW);
         return;
     }
 #endif
@@ -392,6 +484,7 @@ static void vmSignalHandler(int signal, SigInfo *signalInfo, UContext *ucontext)
         log_exit(-22, "could not find native thread locals in trap handler");
     }
     TLA dtla = tla_load(TLA, tla, DTLA);
+    trace_event(TRACE_TRAP, signal, ip, faultAddress);
 
     boolean trapLogged = false;
     if (traceTraps || log_TRAP) {
@@ -420,6 +513,7 @@ static void vmSignalHandler(int signal, SigInfo *signalInfo, UContext *ucontext)
                     logTrap(signal, ip, faultAddress, dtla);
                     trapLogged = true;
                 }
+                logStack(ucontext);
                 log_exit(1, "fatal stack fault in red zone");
             }
         } else if (faultAddress < yellowZoneEnd) {
@@ -428,6 +522,7 @@ static void vmSignalHandler(int signal, SigInfo *signalInfo, UContext *ucontext)
             virtualMemory_unprotectPages(ntl->yellowZone, YELLOW_ZONE_PAGES);
             trapNumber = STACK_FAULT;
         } else {
+            countTrap(ntl, TRAP_COUNT_BLUE_ZONE);
             blueZoneTrap(ntl);
             return;
         }
@@ -465,6 +560,29 @@ static void vmSignalHandler(int signal, SigInfo *signalInfo, UContext *ucontext)
     c_UNIMPLEMENTED();
 #endif
 
+    switch (trapNumber) {
+    case MEMORY_FAULT:
+        /* A safepoint poll traps when it loads through a latch register holding the triggered TLA. */
+        if (tla_load(Address, dtla, TRAP_LATCH_REGISTER) == tla_load(Address, dtla, TTLA)) {
+            countTrap(ntl, TRAP_COUNT_SAFEPOINT);
+        } else {
+            countTrap(ntl, TRAP_COUNT_NULL_CHECK);
+        }
+        break;
+    case STACK_FAULT:
+        countTrap(ntl, TRAP_COUNT_STACK_FAULT);
+        break;
+    case STACK_FATAL:
+        countTrap(ntl, TRAP_COUNT_STACK_FATAL);
+        break;
+    case ARITHMETIC_EXCEPTION:
+        countTrap(ntl, TRAP_COUNT_DIVIDE_BY_ZERO);
+        break;
+    case ASYNC_INTERRUPT:
+        countTrap(ntl, TRAP_COUNT_ASYNC_INTERRUPT);
+        break;
+    }
+
     setInstructionPointer(ucontext, theJavaTrapStub);
 }
 
@@ -476,9 +594,23 @@ static void userSignalHandlerDef(int signal, SigInfo *signalInfo, UContext *ucon
     postSignal(signal);
 }
 
+#if !os_MAXVE
+/**
+ * The handler for the SIGPROF signals sent by the timers of the asynchronous sampling profiler (see sampler.c).
+ */
+static void samplerSignalHandlerDef(int signal, SigInfo *signalInfo, UContext *ucontext) {
+    sampler_record(getInstructionPointer(ucontext), getStackPointer(ucontext), getFramePointer(ucontext));
+}
+#endif
+
 /* Defined global declared in trap.h */
 SignalHandlerFunction userSignalHandler = (SignalHandlerFunction) userSignalHandlerDef;
 
+#if !os_MAXVE
+/* Defined global declared in trap.h */
+SignalHandlerFunction samplerSignalHandler = (SignalHandlerFunction) samplerSignalHandlerDef;
+#endif
+
 /**
  * Implementation of com.sun.max.vm.runtime.Trap.nativeInitialize().
  */
@@ -507,6 +639,7 @@ void nativeTrapInitialize(Address javaTrapStub) {
     sigaddset(&vmSignals, SIGILL);
     sigaddset(&vmSignals, SIGFPE);
     sigaddset(&vmSignals, SIGUSR1);
+    sigaddset(&vmSignals, SIGPROF);
 
     /* Let all threads be stopped by a debugger. */
     sigaddset(&vmSignals, SIGTRAP);
@@ -521,6 +654,13 @@ void nativeTrapInitialize(Address javaTrapStub) {
 #endif
 }
 
+/**
+ * Implementation of com.sun.max.vm.runtime.Trap.nativeExitedThreadsTrapCounts().
+ */
+Address *nativeExitedThreadsTrapCounts(void) {
+    return threadLocalsBlock_exitedThreadsTrapCounts;
+}
+
 /**
  * Implementation of com.sun.max.vm.runtime.Trap.nativeSetTracing().
  */
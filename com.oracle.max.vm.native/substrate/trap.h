@@ -53,6 +53,12 @@ void* setSignalHandler(int signal, SignalHandlerFunction handler);
  */
 extern SignalHandlerFunction userSignalHandler;
 
+/**
+ * The handler for the SIGPROF signals of the asynchronous sampling profiler. It is only
+ * installed while the profiler is running (see sampler.c).
+ */
+extern SignalHandlerFunction samplerSignalHandler;
+
 /**
  * Option controlling tracing of signal related functionality.
  */
@@ -89,6 +89,11 @@ typedef struct vmInterface_ {
         jint (JNICALL *GetNumberOfArguments) (JNIEnv *env, jmethodID methodID);
         void (JNICALL *GetKindsOfArguments) (JNIEnv *env, jmethodID methodID, void* kinds);
         void (JNICALL *SetJVMTIEnv) (JNIEnv *env, void* jvmtiEnv);
+        jint (JNICALL *ArrayBaseOffset) (JNIEnv *env);
+        jint (JNICALL *PrimitiveArrayCopyElementSize) (JNIEnv *env, jobject src, jint srcPos, jobject dest, jint destPos, jint length);
+        jobject (JNICALL *ClassFileUTF) (JNIEnv *env, jobject cb, jint kind, jint index);
+        void (JNICALL *DumpAllStacks) (JNIEnv *env);
+        jobject (JNICALL *DumpThreads) (JNIEnv *env, jobject threads);
 // END GENERATED CODE
 } VMInterface;
 
@@ -0,0 +1,277 @@
+/*
+ * Copyright (c) 2011, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ */
+#include "os.h"
+#include "log.h"
+#include "zygote.h"
+
+#if os_LINUX || os_DARWIN
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+/* The number of file descriptors passed with a request: standard input, output and error. */
+#define STDIO_COUNT 3
+
+static boolean writeInt(int fd, int value) {
+    char *p = (char *) &value;
+    size_t remaining = sizeof(value);
+    while (remaining > 0) {
+        ssize_t n = write(fd, p, remaining);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        p += n;
+        remaining -= n;
+    }
+    return true;
+}
+
+static boolean readFully(int fd, void *buffer, size_t length) {
+    char *p = (char *) buffer;
+    while (length > 0) {
+        ssize_t n = read(fd, p, length);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        length -= n;
+    }
+    return true;
+}
+
+/**
+ * Receives the standard file descriptors and the payload of a request.
+ *
+ * @param fds the array in which the file descriptors are returned
+ * @return the payload, which is NUL terminated, or NULL if the request is malformed
+ */
+static char *receiveRequest(int connection, int fds[STDIO_COUNT], int *payloadLength) {
+    char byte;
+    struct iovec iov;
+    union {
+        struct cmsghdr header;
+        char buffer[CMSG_SPACE(STDIO_COUNT * sizeof(int))];
+    } control;
+    struct msghdr message;
+    ssize_t n;
+    int i;
+
+    iov.iov_base = &byte;
+    iov.iov_len = 1;
+    memset(&message, 0, sizeof(message));
+    message.msg_iov = &iov;
+    message.msg_iovlen = 1;
+    message.msg_control = control.buffer;
+    message.msg_controllen = sizeof(control.buffer);
+    do {
+        n = recvmsg(connection, &message, 0);
+    } while (n < 0 && errno == EINTR);
+    if (n != 1) {
+        return NULL;
+    }
+    struct cmsghdr *header = CMSG_FIRSTHDR(&message);
+    if (header == NULL || header->cmsg_level != SOL_SOCKET || header->cmsg_type != SCM_RIGHTS) {
+        return NULL;
+    }
+    if (header->cmsg_len != CMSG_LEN(STDIO_COUNT * sizeof(int))) {
+        /* Close whatever was passed instead of the three descriptors. */
+        int count = (header->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        int *received = (int *) CMSG_DATA(header);
+        for (i = 0; i < count; i++) {
+            close(received[i]);
+        }
+        return NULL;
+    }
+    memcpy(fds, CMSG_DATA(header), STDIO_COUNT * sizeof(int));
+
+    int length;
+    char *payload = NULL;
+    if (readFully(connection, &length, sizeof(length)) && length > 0 && length <= ZYGOTE_MAX_REQUEST) {
+        payload = malloc(length + 1);
+        if (payload != NULL && (!readFully(connection, payload, length) || payload[length - 1] != '\0')) {
+            free(payload);
+            payload = NULL;
+        }
+    }
+    if (payload == NULL) {
+        for (i = 0; i < STDIO_COUNT; i++) {
+            close(fds[i]);
+        }
+        return NULL;
+    }
+    payload[length] = '\0';
+    *payloadLength = length;
+    return payload;
+}
+
+/**
+ * Makes the file descriptors of a request the standard file descriptors of the current process.
+ */
+static void installStdio(int fds[STDIO_COUNT]) {
+    int i;
+    /* A received descriptor numbered below STDIO_COUNT would be overwritten by the dup2() calls. */
+    for (i = 0; i < STDIO_COUNT; i++) {
+        if (fds[i] < STDIO_COUNT) {
+            fds[i] = fcntl(fds[i], F_DUPFD, STDIO_COUNT);
+        }
+    }
+    for (i = 0; i < STDIO_COUNT; i++) {
+        dup2(fds[i], i);
+    }
+    for (i = 0; i < STDIO_COUNT; i++) {
+        close(fds[i]);
+    }
+}
+
+/**
+ * Serves one request in a monitor process forked from the zygote. The monitor forks the child VM,
+ * reports its process id and then its exit code to the client. This returns only in the child.
+ */
+static void serveRequest(int connection, int *argc, char ***argv) {
+    int fds[STDIO_COUNT];
+    int length;
+    int i;
+
+    signal(SIGCHLD, SIG_DFL);
+    signal(SIGPIPE, SIG_IGN);
+    char *payload = receiveRequest(connection, fds, &length);
+    if (payload == NULL) {
+        writeInt(connection, -1);
+        _exit(1);
+    }
+
+    pid_t child = fork();
+    if (child == 0) {
+        signal(SIGPIPE, SIG_DFL);
+        close(connection);
+        installStdio(fds);
+
+        /* The payload is the working directory followed by the arguments. */
+        const char *directory = payload;
+        int count = 1;
+        for (i = strlen(directory) + 1; i < length; i += strlen(payload + i) + 1) {
+            count++;
+        }
+        char **arguments = malloc((count + 1) * sizeof(char *));
+        if (arguments == NULL) {
+            log_exit(1, "zygote: could not allocate the arguments of a child");
+        }
+        arguments[0] = (*argv)[0];
+        count = 1;
+        for (i = strlen(directory) + 1; i < length; i += strlen(payload + i) + 1) {
+            arguments[count++] = payload + i;
+        }
+        arguments[count] = NULL;
+        if (chdir(directory) != 0) {
+            log_exit(1, "zygote: could not change the working directory to %s: %s", directory, strerror(errno));
+        }
+        *argc = count;
+        *argv = arguments;
+        return;
+    }
+
+    for (i = 0; i < STDIO_COUNT; i++) {
+        close(fds[i]);
+    }
+    if (child < 0) {
+        writeInt(connection, -1);
+        _exit(1);
+    }
+    writeInt(connection, child);
+    int status;
+    while (waitpid(child, &status, 0) < 0) {
+        if (errno != EINTR) {
+            _exit(1);
+        }
+    }
+    writeInt(connection, WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status));
+    _exit(0);
+}
+
+void zygote_serve(const char *path, int *argc, char ***argv) {
+    struct sockaddr_un address;
+    if (strlen(path) >= sizeof(address.sun_path)) {
+        log_exit(1, "zygote: socket path is too long: %s", path);
+    }
+    int server = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (server < 0) {
+        log_exit(1, "zygote: could not create a socket: %s", strerror(errno));
+    }
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, path);
+    unlink(path);
+    if (bind(server, (struct sockaddr *) &address, sizeof(address)) != 0 || listen(server, SOMAXCONN) != 0) {
+        log_exit(1, "zygote: could not listen on %s: %s", path, strerror(errno));
+    }
+    fcntl(server, F_SETFD, FD_CLOEXEC);
+
+    /* The monitor processes are reaped automatically. */
+    signal(SIGCHLD, SIG_IGN);
+#if log_LOADER
+    log_println("zygote: listening on %s", path);
+#endif
+    while (true) {
+        /* Nothing buffered may be written again by the children. */
+        log_flush();
+        int connection = accept(server, NULL, NULL);
+        if (connection < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            log_exit(1, "zygote: accept failed: %s", strerror(errno));
+        }
+        pid_t monitor = fork();
+        if (monitor == 0) {
+            close(server);
+            serveRequest(connection, argc, argv);
+            return;
+        }
+        if (monitor < 0) {
+            log_println("zygote: could not fork: %s", strerror(errno));
+        }
+        close(connection);
+    }
+}
+
+#else
+
+void zygote_serve(const char *path, int *argc, char ***argv) {
+    log_exit(1, "-XX:Zygote is not supported on this platform");
+}
+
+#endif
@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2011, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ */
+#ifndef __zygote_h__
+#define __zygote_h__ 1
+
+/*
+ * Pre-forked VM processes (-XX:Zygote=<socket path>).
+ *
+ * A zygote is a long-lived VM process that loads, maps and relocates the boot image and initializes
+ * the thread locals area once, then listens on a Unix domain socket. Each connection is a request for
+ * a new VM: the zygote forks a child that inherits the loaded image copy-on-write and continues the
+ * startup in maxine() with the arguments of the request, skipping the image loading completely.
+ *
+ * A request carries the client's standard input, output and error (as SCM_RIGHTS ancillary data of
+ * its first byte), followed by the request payload: its length as a 4-byte integer and then a
+ * sequence of NUL terminated strings, the working directory of the child and its arguments. The
+ * zygote replies with the process id of the child (or -1 if it could not be forked) and, when the
+ * child terminates, with its exit code (128 + the signal number if it was killed by a signal), both
+ * as 4-byte integers. 'maxvm -XX:ZygoteConnect=<socket path> <arguments>' is such a client.
+ *
+ * The loader options (see maxine()) and the environment of the children are those of the zygote.
+ * No thread may be started before the fork, so asynchronous logging is disabled in a zygote and an
+ * image page profile cannot be recorded.
+ */
+
+#define ZYGOTE_MAX_REQUEST (1024 * 1024)
+
+/**
+ * Serves requests on a Unix domain socket until the zygote is killed. This only returns in a
+ * forked child, with the arguments of its request.
+ *
+ * @param path the path of the socket, which is replaced if it exists
+ * @param argc the argument count, updated to that of the request
+ * @param argv the arguments, updated to those of the request with the zygote's argv[0] as the program name
+ */
+extern void zygote_serve(const char *path, int *argc, char ***argv);
+
+#endif /*__zygote_h__*/
@@ -28,9 +28,12 @@
 #include <mach/mach_vm.h>
 #include <mach/vm_map.h>
 #include <errno.h>
+#include <pthread.h>
 
 #include "darwin.h"
 #include "log.h"
+#include "jni.h"
+#include "pageCache.h"
 
 boolean forall_threads(task_t task, thread_visitor visitor, void *arg) {
     thread_array_t thread_list = NULL;
@@ -84,3 +87,193 @@ void report_mach_error(const char *file, int line, kern_return_t krn, const char
     errno = error; \
     return krn; \
 }
+
+/* The most regions and holes cached at once. The cache is simply emptied when it is full. */
+#define MAX_CACHED_REGIONS 512
+
+static pthread_mutex_t cacheMutex = PTHREAD_MUTEX_INITIALIZER;
+
+static TaskRegionStruct cachedRegions[MAX_CACHED_REGIONS];
+static int cachedRegionCount;
+
+static boolean lookup_region(mach_vm_address_t address, TaskRegion region) {
+    int i;
+    for (i = 0; i < cachedRegionCount; i++) {
+        if (cachedRegions[i].start <= address && address < cachedRegions[i].end) {
+            *region = cachedRegions[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+static void cache_region(TaskRegion region) {
+    if (cachedRegionCount == MAX_CACHED_REGIONS) {
+        cachedRegionCount = 0;
+    }
+    cachedRegions[cachedRegionCount++] = *region;
+}
+
+boolean task_region(task_t task, mach_vm_address_t address, TaskRegion region) {
+    pthread_mutex_lock(&cacheMutex);
+    if (lookup_region(address, region)) {
+        pthread_mutex_unlock(&cacheMutex);
+        return true;
+    }
+
+    vm_region_submap_short_info_data_64_t info;
+    mach_vm_address_t base = address;
+    mach_vm_size_t length;
+    natural_t depth = 100000;
+    mach_msg_type_number_t count = VM_REGION_SUBMAP_SHORT_INFO_COUNT_64;
+    kern_return_t kr = mach_vm_region_recurse(task, &base, &length, &depth, (vm_region_recurse_info_t) &info, &count);
+    if (kr == KERN_INVALID_ADDRESS) {
+        /* There is no region at or above 'address'. */
+        region->start = address;
+        region->end = (mach_vm_address_t) -1;
+        region->mapped = false;
+    } else if (kr != KERN_SUCCESS) {
+        pthread_mutex_unlock(&cacheMutex);
+        REPORT_MACH_ERROR("mach_vm_region_recurse", kr);
+        return false;
+    } else if (base > address) {
+        /* 'address' is in the hole below the next region. */
+        region->start = address;
+        region->end = base;
+        region->mapped = false;
+    } else {
+        region->start = base;
+        region->end = base + length;
+        region->mapped = true;
+        region->protection = info.protection;
+        region->maxProtection = info.max_protection;
+    }
+    cache_region(region);
+    pthread_mutex_unlock(&cacheMutex);
+    return true;
+}
+
+typedef struct {
+    thread_t thread;
+    boolean hasState;
+    boolean hasFloatState;
+    ThreadState state;
+    OsFloatingPointRegistersStruct floatState;
+} CachedThreadStateStruct, *CachedThreadState;
+
+static CachedThreadState cachedThreadStates;
+static int cachedThreadStateCount;
+static int cachedThreadStateCapacity;
+
+static CachedThreadState cached_thread_state(thread_t thread, boolean create) {
+    int i;
+    for (i = 0; i < cachedThreadStateCount; i++) {
+        if (cachedThreadStates[i].thread == thread) {
+            return &cachedThreadStates[i];
+        }
+    }
+    if (!create) {
+        return NULL;
+    }
+    if (cachedThreadStateCount == cachedThreadStateCapacity) {
+        int capacity = cachedThreadStateCapacity == 0 ? 32 : cachedThreadStateCapacity * 2;
+        CachedThreadState states = (CachedThreadState) realloc(cachedThreadStates, capacity * sizeof(CachedThreadStateStruct));
+        if (states == NULL) {
+            return NULL;
+        }
+        cachedThreadStates = states;
+        cachedThreadStateCapacity = capacity;
+    }
+    CachedThreadState entry = &cachedThreadStates[cachedThreadStateCount++];
+    entry->thread = thread;
+    entry->hasState = false;
+    entry->hasFloatState = false;
+    return entry;
+}
+
+static boolean fetch_thread_state(CachedThreadState entry) {
+    mach_msg_type_number_t count = THREAD_STATE_COUNT;
+    entry->hasState = thread_get_state(entry->thread, THREAD_STATE_FLAVOR, (thread_state_t) &entry->state, &count) == KERN_SUCCESS;
+    count = FLOATING_POINT_REGISTER_COUNT;
+    entry->hasFloatState = thread_get_state(entry->thread, FLOAT_REGISTER_FLAVOR, (thread_state_t) &entry->floatState, &count) == KERN_SUCCESS;
+    return entry->hasState;
+}
+
+static boolean fetch_thread_state_visitor(thread_t thread, void *arg) {
+    CachedThreadState entry = cached_thread_state(thread, true);
+    if (entry != NULL && !entry->hasState) {
+        fetch_thread_state(entry);
+    }
+    return true;
+}
+
+void thread_states_fetch(task_t task) {
+    pthread_mutex_lock(&cacheMutex);
+    forall_threads(task, fetch_thread_state_visitor, NULL);
+    pthread_mutex_unlock(&cacheMutex);
+}
+
+boolean thread_cached_state(thread_t thread, ThreadState *state) {
+    pthread_mutex_lock(&cacheMutex);
+    CachedThreadState entry = cached_thread_state(thread, true);
+    boolean result;
+    if (entry == NULL) {
+        mach_msg_type_number_t count = THREAD_STATE_COUNT;
+        result = thread_get_state(thread, THREAD_STATE_FLAVOR, (thread_state_t) state, &count) == KERN_SUCCESS;
+    } else {
+        result = entry->hasState || fetch_thread_state(entry);
+        if (result) {
+            *state = entry->state;
+        }
+    }
+    pthread_mutex_unlock(&cacheMutex);
+    return result;
+}
+
+boolean thread_cached_float_state(thread_t thread, OsFloatingPointRegistersStruct *state) {
+    pthread_mutex_lock(&cacheMutex);
+    CachedThreadState entry = cached_thread_state(thread, true);
+    boolean result;
+    if (entry == NULL) {
+        mach_msg_type_number_t count = FLOATING_POINT_REGISTER_COUNT;
+        result = thread_get_state(thread, FLOAT_REGISTER_FLAVOR, (thread_state_t) state, &count) == KERN_SUCCESS;
+    } else {
+        if (!entry->hasFloatState) {
+            fetch_thread_state(entry);
+        }
+        result = entry->hasFloatState;
+        if (result) {
+            *state = entry->floatState;
+        }
+    }
+    pthread_mutex_unlock(&cacheMutex);
+    return result;
+}
+
+boolean thread_set_cached_state(thread_t thread, ThreadState *state) {
+    pthread_mutex_lock(&cacheMutex);
+    boolean result = thread_set_state(thread, THREAD_STATE_FLAVOR, (thread_state_t) state, THREAD_STATE_COUNT) == KERN_SUCCESS;
+    CachedThreadState entry = cached_thread_state(thread, false);
+    if (entry != NULL) {
+        entry->hasState = result;
+        if (result) {
+            entry->state = *state;
+        }
+    }
+    pthread_mutex_unlock(&cacheMutex);
+    return result;
+}
+
+void task_regions_invalidate(void) {
+    pthread_mutex_lock(&cacheMutex);
+    cachedRegionCount = 0;
+    pthread_mutex_unlock(&cacheMutex);
+}
+
+void task_caches_invalidate(void) {
+    pageCache_invalidate();
+    pthread_mutex_lock(&cacheMutex);
+    cachedRegionCount = 0;
+    cachedThreadStateCount = 0;
+    pthread_mutex_unlock(&cacheMutex);
+}
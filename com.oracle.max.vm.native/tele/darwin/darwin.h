@@ -127,4 +127,55 @@ boolean thread_set_single_step(thread_t thread, void *arg);
 extern void log_task_info(task_t task);
 extern boolean log_thread_info(thread_t thread, void *arg);
 
+/**
+ * A region of the address space of a task, or a hole between two regions.
+ */
+typedef struct {
+    mach_vm_address_t start;
+    mach_vm_address_t end;
+    boolean mapped;
+    vm_prot_t protection;
+    vm_prot_t maxProtection;
+} TaskRegionStruct, *TaskRegion;
+
+/**
+ * Gets the region or hole of the address space of 'task' containing 'address'. Regions are cached
+ * until task_caches_invalidate() is called so that repeated probes, in particular of unmapped
+ * addresses, are answered without a kernel call.
+ *
+ * @return false if the region information could not be obtained
+ */
+extern boolean task_region(task_t task, mach_vm_address_t address, TaskRegion region);
+
+/**
+ * Discards the cached regions, for example after the protection of a region has been changed.
+ */
+extern void task_regions_invalidate(void);
+
+/**
+ * Gets the general purpose register state of 'thread', from the cache filled by thread_states_fetch() if possible.
+ */
+extern boolean thread_cached_state(thread_t thread, ThreadState *state);
+
+/**
+ * Gets the floating point register state of 'thread', from the cache filled by thread_states_fetch() if possible.
+ */
+extern boolean thread_cached_float_state(thread_t thread, OsFloatingPointRegistersStruct *state);
+
+/**
+ * Sets the general purpose register state of 'thread' and updates the cache accordingly.
+ */
+extern boolean thread_set_cached_state(thread_t thread, ThreadState *state);
+
+/**
+ * Fetches the register state of all the threads of 'task' in one pass into the thread state cache.
+ */
+extern void thread_states_fetch(task_t task);
+
+/**
+ * Discards all the information cached about a task while it is stopped: the page cache, the region
+ * cache and the thread state cache. This must be called whenever the task may have run.
+ */
+extern void task_caches_invalidate(void);
+
 #endif
@@ -124,27 +124,19 @@ Java_com_sun_max_tele_channel_natives_TeleChannelNatives_readRegisters(JNIEnv *e
                 jbyteArray integerRegisters, jint integerRegistersLength,
                 jbyteArray floatingPointRegisters, jint floatingPointRegistersLength,
                 jbyteArray stateRegisters, jint stateRegistersLength) {
-    OsIntegerRegistersStruct osIntegerRegisters;
     OsFloatingPointRegistersStruct osFloatRegisters;
-    OsStateRegistersStruct osStateRegisters;
+    ThreadState threadState;
 
-    mach_msg_type_number_t count;
-    count = INTEGER_REGISTER_COUNT;
-    if (thread_get_state((thread_act_t) thread, INTEGER_REGISTER_FLAVOR, (thread_state_t) &osIntegerRegisters, &count) != KERN_SUCCESS) {
+    /* The integer and state registers are both in the thread state flavor, which is cached with the
+     * floating point state for every thread when the threads are gathered. */
+    if (!thread_cached_state((thread_t) thread, &threadState)) {
         return false;
     }
-
-    count = STATE_REGISTER_COUNT;
-    if (thread_get_state((thread_act_t) thread, STATE_REGISTER_FLAVOR, (thread_state_t) &osStateRegisters, &count) != KERN_SUCCESS) {
+    if (!thread_cached_float_state((thread_t) thread, &osFloatRegisters)) {
         return false;
     }
 
-    count = FLOATING_POINT_REGISTER_COUNT;
-    if (thread_get_state((thread_act_t) thread, FLOAT_REGISTER_FLAVOR, (thread_state_t) &osFloatRegisters, &count) != KERN_SUCCESS) {
-        return false;
-    }
-
-    return copyRegisters(env, c, &osIntegerRegisters, &osStateRegisters, &osFloatRegisters,
+    return copyRegisters(env, c, &threadState, &threadState, &osFloatRegisters,
                     integerRegisters, integerRegistersLength,
                     floatingPointRegisters, floatingPointRegistersLength,
                     stateRegisters, stateRegistersLength);
@@ -152,26 +144,20 @@ Java_com_sun_max_tele_channel_natives_TeleChannelNatives_readRegisters(JNIEnv *e
 
 JNIEXPORT jboolean JNICALL
 Java_com_sun_max_tele_channel_natives_TeleChannelNatives_setInstructionPointer(JNIEnv *env, jobject this, jlong task, jlong thread, jlong instructionPointer) {
-    OsStateRegistersStruct osStateRegisters;
-    mach_msg_type_number_t count = STATE_REGISTER_COUNT;
-    if (thread_get_state((thread_act_t) thread, STATE_REGISTER_FLAVOR, (thread_state_t) &osStateRegisters, &count) != KERN_SUCCESS) {
-        return false;
-    }
-    osStateRegisters.__rip = instructionPointer;
-    if (thread_set_state((thread_act_t) thread, STATE_REGISTER_FLAVOR, (thread_state_t) &osStateRegisters, count) != KERN_SUCCESS) {
+    ThreadState threadState;
+    if (!thread_cached_state((thread_t) thread, &threadState)) {
         return false;
     }
-    return true;
+    threadState.__rip = instructionPointer;
+    return thread_set_cached_state((thread_t) thread, &threadState);
 }
 
 boolean thread_set_single_step(thread_t thread, void *arg) {
     ThreadState threadState;
 
     const boolean isEnabled = arg != NULL;
-    mach_msg_type_number_t count = THREAD_STATE_COUNT;
-    kern_return_t error = thread_get_state(thread, THREAD_STATE_FLAVOR, (natural_t *) &threadState, &count);
-    if (error != KERN_SUCCESS) {
-        log_println("thread_get_state failed, error: %d, %s", error, mach_error_string(error));
+    if (!thread_cached_state(thread, &threadState)) {
+        log_println("thread_get_state failed for thread %d", thread);
         return false;
     }
 
@@ -180,9 +166,8 @@ boolean thread_set_single_step(thread_t thread, void *arg) {
     } else {
         threadState.__rflags &= ~0x100UL;
     }
-    error = thread_set_state(thread, THREAD_STATE_FLAVOR, (natural_t *) &threadState, count);
-    if (error != KERN_SUCCESS) {
-        log_println("thread_set_state failed, error: %d, %s", error, mach_error_string(error));
+    if (!thread_set_cached_state(thread, &threadState)) {
+        log_println("thread_set_state failed for thread %d", thread);
         return false;
     }
     return true;
@@ -282,7 +267,9 @@ Java_com_sun_max_tele_channel_natives_TeleChannelNatives_singleStep(JNIEnv *env,
     log_task_info((task_t) task);
 #endif
     tele_log_println("Single stepping");
-    jboolean result = thread_set_single_step((thread_t) thread, (void *) true)
+    jboolean result = thread_set_single_step((thread_t) thread, (void *) true);
+    task_caches_invalidate();
+    result = result
         && forall_threads(task, suspend_noncurrent_thread, (void *) thread)
         && task_resume_thread(task, (thread_t) thread)
         && forall_threads(task, resume_noncurrent_thread, (void *) thread);
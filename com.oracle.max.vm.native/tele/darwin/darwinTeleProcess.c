@@ -48,6 +48,7 @@
 #include "threads.h"
 
 #include "teleProcess.h"
+#include "pageCache.h"
 #include "teleNativeThread.h"
 
 const char *threadRunStateAsString(int state) {
@@ -97,6 +98,11 @@ void log_task_info(task_t task) {
 }
 
 int task_read(task_t task, vm_address_t src, void *dst, size_t size) {
+    TaskRegionStruct region;
+    if (task_region(task, src, &region) && !region.mapped) {
+        /* Fail fast on an unmapped address. */
+        return -1;
+    }
     mach_vm_size_t bytesRead;
     kern_return_t result = mach_vm_read_overwrite(task, src, size, (vm_address_t) dst, &bytesRead);
     return result == KERN_SUCCESS ? (jint) bytesRead : -1;
@@ -105,30 +111,26 @@ int task_read(task_t task, vm_address_t src, void *dst, size_t size) {
 
 int task_write(task_t task, vm_address_t dst, void *src, size_t size) {
     // check writable (only really needed for setting breakpoints in native code)
-    vm_region_submap_short_info_data_64_t info;
-    mach_vm_address_t dst_base = dst;
-    mach_msg_type_number_t count;
-    mach_vm_size_t region_length;
-    natural_t region_depth;
-
-    // check for write protection
-    region_depth = 100000;
-    count = VM_REGION_SUBMAP_SHORT_INFO_COUNT_64;
-    kern_return_t result = mach_vm_region_recurse(task, &dst_base, &region_length, &region_depth,
-                                  (vm_region_recurse_info_t) &info, &count);
-    REPORT_MACH_ERROR("mach_vm_region_recurse", result);
+    TaskRegionStruct region;
+    if (!task_region(task, dst, &region) || !region.mapped) {
+        return -1;
+    }
+    mach_vm_size_t region_length = region.end - region.start;
+    kern_return_t result;
 
     // try to increase max protection if necessary
-    if (!(info.max_protection & VM_PROT_WRITE)) {
-        result = mach_vm_protect(task, dst, region_length, TRUE, info.max_protection | VM_PROT_WRITE | VM_PROT_COPY);
+    if (!(region.maxProtection & VM_PROT_WRITE)) {
+        result = mach_vm_protect(task, dst, region_length, TRUE, region.maxProtection | VM_PROT_WRITE | VM_PROT_COPY);
         REPORT_MACH_ERROR("mach_vm_protect max", result);
         if (result != KERN_SUCCESS) return -1;
     }
     // try to increase current protection
-    if (!(info.protection & VM_PROT_WRITE)) {
-        result = mach_vm_protect(task, dst, region_length, FALSE, info.protection | VM_PROT_WRITE);
+    if (!(region.protection & VM_PROT_WRITE)) {
+        result = mach_vm_protect(task, dst, region_length, FALSE, region.protection | VM_PROT_WRITE);
         REPORT_MACH_ERROR("mach_vm_protect", result);
         if (result != KERN_SUCCESS) return -1;
+        // the region map has changed
+        task_regions_invalidate();
     }
 
     result = mach_vm_write(task, (vm_address_t) dst, (vm_offset_t) src, size);
@@ -190,6 +192,7 @@ jint waitForSignal(jlong task, int signalnum) {
 
 JNIEXPORT jlong JNICALL
 Java_com_sun_max_tele_channel_natives_TeleChannelNatives_createChild(JNIEnv *env, jobject this, jlong commandLineArgumentArray, jint vmAgentPort) {
+    task_caches_invalidate();
     char **argv = (char**) commandLineArgumentArray;
 
     int childPid = fork();
@@ -247,6 +250,7 @@ Java_com_sun_max_tele_channel_natives_TeleChannelNatives_createChild(JNIEnv *env
 
 JNIEXPORT jboolean JNICALL
 Java_com_sun_max_tele_channel_natives_TeleChannelNatives_kill(JNIEnv *env, jobject this, jint task) {
+    task_caches_invalidate();
     int pid;
     kern_return_t kr =  pid_for_task((task_t) task, &pid);
     REPORT_MACH_ERROR("pid_for_task", kr);
@@ -259,7 +263,7 @@ typedef struct {
     jobject process;
     jlong task;
     jobject threadList;
-    jlong tlaList;
+    TLAIndex tlaIndex;
 } GatherThreadArgs;
 
 static boolean gatherThread(thread_t thread, void* args) {
@@ -267,22 +271,24 @@ static boolean gatherThread(thread_t thread, void* args) {
     ThreadState_t state = TS_SUSPENDED;
     ThreadState threadState;
 
-    mach_msg_type_number_t count = THREAD_STATE_COUNT;
-
-    kern_return_t kr = thread_get_state(thread, THREAD_STATE_FLAVOR, (natural_t *) &threadState, &count);
-    RETURN_ON_MACH_ERROR("thread_get_state", kr, true);
+    if (!thread_cached_state(thread, &threadState)) {
+        log_println("Could not get the state of thread %d", thread);
+        return true;
+    }
 
     TLA threadLocals = (TLA) alloca(tlaSize());
     NativeThreadLocalsStruct nativeThreadLocalsStruct;
-    TLA tla = teleProcess_findTLA(a->task, a->tlaList, threadState.__rsp, threadLocals, &nativeThreadLocalsStruct);
+    TLA tla = teleProcess_findIndexedTLA(a->tlaIndex, threadState.__rsp, threadLocals, &nativeThreadLocalsStruct);
     teleProcess_jniGatherThread(a->env, a->process, a->threadList, thread, state, threadState.__rip, tla);
     return true;
 }
 
 JNIEXPORT void JNICALL
 Java_com_sun_max_tele_channel_natives_TeleChannelNatives_gatherThreads(JNIEnv *env, jobject this, jlong task, jobject teleProcess, jobject threadList, jlong tlaList) {
-    GatherThreadArgs args = {env, teleProcess, task, threadList, tlaList};
+    thread_states_fetch(task);
+    GatherThreadArgs args = {env, teleProcess, task, threadList, teleProcess_indexTLAs(task, tlaList)};
     forall_threads(task, gatherThread, (void *) &args);
+    teleProcess_freeTLAIndex(args.tlaIndex);
 }
 
 JNIEXPORT jboolean JNICALL
@@ -300,7 +306,10 @@ Java_com_sun_max_tele_channel_natives_TeleChannelNatives_suspend(JNIEnv *env, jo
 
 JNIEXPORT jint JNICALL
 Java_com_sun_max_tele_channel_natives_TeleChannelNatives_waitUntilStopped(JNIEnv *env, jobject this, jlong task) {
-    return waitForSignal(task, SIGTRAP);
+    jint result = waitForSignal(task, SIGTRAP);
+    /* Pages read while the process was running may have changed before it stopped. */
+    task_caches_invalidate();
+    return result;
 }
 
 /**
@@ -336,6 +345,7 @@ void resume_task(task_t task) {
 
 JNIEXPORT jboolean JNICALL
 Java_com_sun_max_tele_channel_natives_TeleChannelNatives_resume(JNIEnv *env, jobject this, jlong task) {
+    task_caches_invalidate();
     int pid;
     kern_return_t kr = pid_for_task((task_t) task, &pid);
     REPORT_MACH_ERROR("pid_for_task", kr);
@@ -353,6 +363,16 @@ Java_com_sun_max_tele_channel_natives_TeleChannelNatives_readBytes(JNIEnv *env,
     return teleProcess_read(task, env, this, src, dst, isDirectByteBuffer, dstOffset, length);
 }
 
+JNIEXPORT jint JNICALL
+Java_com_sun_max_tele_channel_natives_TeleChannelNatives_readBytesBatch(JNIEnv *env, jobject this, jlong task, jlongArray descriptors, jint count, jobject dst) {
+    return teleProcess_readBatch(task, env, this, descriptors, count, dst);
+}
+
+JNIEXPORT jint JNICALL
+Java_com_sun_max_tele_channel_natives_TeleChannelNatives_writeBytesBatch(JNIEnv *env, jobject this, jlong task, jlongArray descriptors, jint count, jobject src) {
+    return teleProcess_writeBatch(task, env, this, descriptors, count, src);
+}
+
 JNIEXPORT jint JNICALL
 Java_com_sun_max_tele_channel_natives_TeleChannelNatives_writeBytes(JNIEnv *env, jobject this, jlong task, jlong dst, jobject src, jboolean isDirectByteBuffer, jint srcOffset, jint length) {
     return teleProcess_write(task, env, this, dst, src, isDirectByteBuffer, srcOffset, length);
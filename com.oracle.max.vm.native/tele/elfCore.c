@@ -0,0 +1,247 @@
+/*
+ * Copyright (c) 2017-2018, APT Group, School of Computer Science,
+ * The University of Manchester. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * The segment index holds the file-backed part of each PT_LOAD segment, sorted by address, with
+ * segments that are adjacent both in the dumped process and in the file merged into one. A segment
+ * whose memory was not dumped (p_filesz is 0, e.g. a read-only mapping of a file) is not indexed,
+ * and neither is any part of a segment past the end of a truncated core file, as touching the
+ * mapping there would raise SIGBUS.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#if os_SOLARIS
+#include <sys/elf.h>
+#else
+#include <elf.h>
+#endif
+
+#include "jni.h"
+#include "log.h"
+#include "elfCore.h"
+
+typedef struct {
+    Address start;
+    Address end;
+    const char *data;
+} CoreSegmentStruct, *CoreSegment;
+
+typedef struct CoreFileStruct {
+    char *base;
+    size_t size;
+    int segmentCount;
+    CoreSegmentStruct segments[];
+} CoreFileStruct;
+
+static int compareSegments(const void *a, const void *b) {
+    Address startA = ((CoreSegment) a)->start;
+    Address startB = ((CoreSegment) b)->start;
+    return startA < startB ? -1 : startA > startB ? 1 : 0;
+}
+
+CoreFile coreFile_open(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        log_println("Could not open core file %s", path);
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(Elf64_Ehdr)) {
+        log_println("Core file %s is too small to be an ELF file", path);
+        close(fd);
+        return NULL;
+    }
+    size_t size = (size_t) st.st_size;
+    char *base = (char *) mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == (char *) MAP_FAILED) {
+        log_println("Could not map core file %s", path);
+        return NULL;
+    }
+
+    Elf64_Ehdr *ehdr = (Elf64_Ehdr *) base;
+    if (memcmp(ehdr->e_ident, ELFMAG, SELFMAG) != 0 || ehdr->e_ident[EI_CLASS] != ELFCLASS64 ||
+                    ehdr->e_ident[EI_DATA] != (word_BIG_ENDIAN ? ELFDATA2MSB : ELFDATA2LSB) || ehdr->e_type != ET_CORE) {
+        log_println("%s is not a 64-bit core file with the byte order of this host", path);
+        munmap(base, size);
+        return NULL;
+    }
+    if (ehdr->e_phentsize != sizeof(Elf64_Phdr) || ehdr->e_phoff > size || ehdr->e_phnum > (size - ehdr->e_phoff) / sizeof(Elf64_Phdr)) {
+        log_println("Core file %s has a malformed program header table", path);
+        munmap(base, size);
+        return NULL;
+    }
+
+    Elf64_Phdr *phdrs = (Elf64_Phdr *) (base + ehdr->e_phoff);
+    CoreFile core = (CoreFile) malloc(sizeof(CoreFileStruct) + ehdr->e_phnum * sizeof(CoreSegmentStruct));
+    if (core == NULL) {
+        log_println("Could not allocate the segment index of core file %s", path);
+        munmap(base, size);
+        return NULL;
+    }
+    core->base = base;
+    core->size = size;
+    int count = 0;
+    int i;
+    for (i = 0; i < ehdr->e_phnum; i++) {
+        Elf64_Phdr *phdr = &phdrs[i];
+        if (phdr->p_type != PT_LOAD || phdr->p_filesz == 0 || phdr->p_offset >= size) {
+            continue;
+        }
+        size_t length = phdr->p_filesz < size - phdr->p_offset ? phdr->p_filesz : size - phdr->p_offset;
+        core->segments[count].start = (Address) phdr->p_vaddr;
+        core->segments[count].end = (Address) phdr->p_vaddr + length;
+        core->segments[count].data = base + phdr->p_offset;
+        count++;
+    }
+    qsort(core->segments, count, sizeof(CoreSegmentStruct), compareSegments);
+
+    int merged = 0;
+    for (i = 0; i < count; i++) {
+        CoreSegment last = merged == 0 ? NULL : &core->segments[merged - 1];
+        CoreSegment segment = &core->segments[i];
+        if (last != NULL && last->end == segment->start && last->data + (last->end - last->start) == segment->data) {
+            last->end = segment->end;
+        } else {
+            core->segments[merged++] = *segment;
+        }
+    }
+    core->segmentCount = merged;
+    return core;
+}
+
+void coreFile_close(CoreFile core) {
+    munmap(core->base, core->size);
+    free(core);
+}
+
+const char *coreFile_address(CoreFile core, Address address, size_t *available) {
+    int low = 0;
+    int high = core->segmentCount - 1;
+    while (low <= high) {
+        int middle = (low + high) >> 1;
+        CoreSegment segment = &core->segments[middle];
+        if (address < segment->start) {
+            high = middle - 1;
+        } else if (address >= segment->end) {
+            low = middle + 1;
+        } else {
+            if (available != NULL) {
+                *available = segment->end - address;
+            }
+            return segment->data + (address - segment->start);
+        }
+    }
+    return NULL;
+}
+
+size_t coreFile_read(CoreFile core, Address src, void *dst, size_t size) {
+    size_t done = 0;
+    while (done < size) {
+        size_t available;
+        const char *data = coreFile_address(core, src + done, &available);
+        if (data == NULL) {
+            break;
+        }
+        size_t n = size - done < available ? size - done : available;
+        memcpy((char *) dst + done, data, n);
+        done += n;
+    }
+    return done;
+}
+
+JNIEXPORT jlong JNICALL
+Java_com_sun_max_tele_debug_dump_ELFDumpTeleChannelProtocolAdaptor_nativeOpenCore(JNIEnv *env, jclass c, jstring path) {
+    const char *pathChars = (*env)->GetStringUTFChars(env, path, NULL);
+    if (pathChars == NULL) {
+        return 0L;
+    }
+    CoreFile core = coreFile_open(pathChars);
+    (*env)->ReleaseStringUTFChars(env, path, pathChars);
+    return (jlong) (Address) core;
+}
+
+JNIEXPORT void JNICALL
+Java_com_sun_max_tele_debug_dump_ELFDumpTeleChannelProtocolAdaptor_nativeCloseCore(JNIEnv *env, jclass c, jlong handle) {
+    coreFile_close((CoreFile) (Address) handle);
+}
+
+JNIEXPORT jint JNICALL
+Java_com_sun_max_tele_debug_dump_ELFDumpTeleChannelProtocolAdaptor_nativeReadBytes(JNIEnv *env, jclass c, jlong handle, jlong src, jobject dst, jboolean isDirectByteBuffer, jint offset, jint length) {
+    CoreFile core = (CoreFile) (Address) handle;
+    if (isDirectByteBuffer) {
+        jbyte *dstBuffer = (*env)->GetDirectBufferAddress(env, dst);
+        if (dstBuffer == NULL) {
+            log_println("Failed to get address from NIO direct buffer");
+            return -1;
+        }
+        return (jint) coreFile_read(core, (Address) src, dstBuffer + offset, (size_t) length);
+    }
+    /* Copy straight out of the mapping into the array, one contiguous run at a time. */
+    jint done = 0;
+    while (done < length) {
+        size_t available;
+        const char *data = coreFile_address(core, (Address) src + done, &available);
+        if (data == NULL) {
+            break;
+        }
+        jint n = (size_t) (length - done) < available ? length - done : (jint) available;
+        (*env)->SetByteArrayRegion(env, dst, offset + done, n, (const jbyte *) data);
+        done += n;
+    }
+    return done;
+}
+
+JNIEXPORT jint JNICALL
+Java_com_sun_max_tele_debug_dump_ELFDumpTeleChannelProtocolAdaptor_nativeReadBytesBatch(JNIEnv *env, jclass c, jlong handle, jlongArray descriptors, jint count, jobject dst) {
+    CoreFile core = (CoreFile) (Address) handle;
+    if (count <= 0) {
+        return 0;
+    }
+    jbyte *dstBuffer = (*env)->GetDirectBufferAddress(env, dst);
+    if (dstBuffer == NULL) {
+        log_println("Failed to get address from NIO direct buffer");
+        return -1;
+    }
+    jlong capacity = (*env)->GetDirectBufferCapacity(env, dst);
+    jlong *ranges = (*env)->GetLongArrayElements(env, descriptors, NULL);
+    if (ranges == NULL) {
+        return -1;
+    }
+    jlong offset = 0;
+    int i;
+    for (i = 0; i < count; i++) {
+        jlong length = ranges[2 * i + 1];
+        if (length < 0 || offset + length > capacity) {
+            log_println("Batch read range %d of %ld bytes does not fit in a buffer of %ld bytes", i, length, capacity);
+            break;
+        }
+        if (coreFile_read(core, (Address) ranges[2 * i], dstBuffer + offset, (size_t) length) != (size_t) length) {
+            break;
+        }
+        offset += length;
+    }
+    (*env)->ReleaseLongArrayElements(env, descriptors, ranges, JNI_ABORT);
+    return i;
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2017-2018, APT Group, School of Computer Science,
+ * The University of Manchester. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * Read-only access to the memory of a process saved in an ELF core file.
+ *
+ * The file is mapped once when it is opened and the file-backed parts of its PT_LOAD segments are
+ * indexed by address, so a read of the dumped process's memory is a lookup in the index and a copy
+ * out of the mapping. The file is never read as a whole, which keeps opening a large core cheap.
+ */
+#ifndef __elfCore_h__
+#define __elfCore_h__ 1
+
+#include <stddef.h>
+
+#include "word.h"
+
+typedef struct CoreFileStruct *CoreFile;
+
+/**
+ * Maps a 64-bit ELF core file and indexes its PT_LOAD segments.
+ *
+ * @return NULL if the file cannot be mapped or is not a core file of the host's byte order
+ */
+extern CoreFile coreFile_open(const char *path);
+
+/**
+ * Unmaps a core file opened by coreFile_open() and frees its index.
+ */
+extern void coreFile_close(CoreFile core);
+
+/**
+ * Gets the location in the mapping of the byte at 'address' in the dumped process.
+ *
+ * @param available if not NULL, set to the number of bytes at and after 'address' that are
+ *            contiguous in both the dumped process and the mapping
+ * @return NULL if 'address' is not in the file-backed part of a PT_LOAD segment
+ */
+extern const char *coreFile_address(CoreFile core, Address address, size_t *available);
+
+/**
+ * Copies 'size' bytes from 'src' in the dumped process to 'dst', crossing segment boundaries
+ * where the segments are adjacent.
+ *
+ * @return the number of bytes copied, which is less than 'size' if the range runs into memory
+ *         that is not in the core file
+ */
+extern size_t coreFile_read(CoreFile core, Address src, void *dst, size_t size);
+
+#endif /*__elfCore_h__*/
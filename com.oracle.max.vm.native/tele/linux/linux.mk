@@ -21,6 +21,6 @@
 # questions.
 #
 
-OS_SOURCES = ptrace.c teleProcess.c linuxTeleProcess.c linuxTask.c
+OS_SOURCES = ptrace.c teleProcess.c linuxTeleProcess.c linuxTask.c linuxWatchpoint.c elfCore.c
 
 CFLAGS += -DINTERPOSE_PTRACE
@@ -33,12 +33,16 @@
 #include <sys/wait.h>
 #include <sys/time.h>
 #include <sys/prctl.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
 
 #include "log.h"
 #include "ptrace.h"
 #include "threadLocals.h"
 #include "teleProcess.h"
 #include "linuxTask.h"
+#include "linuxWatchpoint.h"
+#include "pageCache.h"
 
 #ifdef __arm__
 typedef struct user_fpregs user_fpregs_structure;
@@ -86,6 +90,7 @@ static void task_attach_ptrace_to_new_task(int newTid, int starterTid) {
     }
 
     ptrace(PT_SETOPTIONS, newTid, 0, PTRACE_O_TRACECLONE | PTRACE_O_TRACEEXIT);
+    watchpoint_attach_task(newTid);
 
     tele_log_println("Resuming tasks %d and %d", newTid, starterTid);
     ptrace(PT_CONTINUE, newTid, 0, 0);
@@ -327,18 +332,141 @@ int scan_process_tasks(pid_t pid, pid_t **tasks) {
 /* The pause time between each poll of the VM to see if at least one thread has stopped */
 #define PROCESS_POLL_PAUSE_NANOSECONDS (200 * 1000)
 
-jboolean process_resume_all_threads(pid_t pid) {
-    pid_t *tasks = NULL;
-    const int nTasks = scan_process_tasks(pid, &tasks);
+/* The debugger's view of the state of a task in the traced process. */
+typedef enum {
+    TRACKED_TASK_RUNNING,
+    TRACKED_TASK_STOPPED,
+    /* A new task that has reported its initial SIGSTOP before the clone event of the task that started it. */
+    TRACKED_TASK_NEW
+} TrackedTaskState;
+
+typedef struct {
+    pid_t tid;
+    TrackedTaskState state;
+} TrackedTaskStruct, *TrackedTask;
+
+/* The tasks of the traced process. This set is seeded once from /proc/<tgid>/task and then kept up to
+ * date from the clone and exit events reported by ptrace so that waiting for the process to stop
+ * does not need to poll /proc. */
+static pid_t _trackedTgid = 0;
+static TrackedTask _trackedTasks = NULL;
+static int _trackedTaskCount = 0;
+static int _trackedTaskCapacity = 0;
+
+static TrackedTask tracked_task_find(pid_t tid) {
+    int n;
+    for (n = 0; n < _trackedTaskCount; n++) {
+        if (_trackedTasks[n].tid == tid) {
+            return &_trackedTasks[n];
+        }
+    }
+    return NULL;
+}
+
+static TrackedTask tracked_task_add(pid_t tid, TrackedTaskState state) {
+    TrackedTask task = tracked_task_find(tid);
+    if (task == NULL) {
+        if (_trackedTaskCount == _trackedTaskCapacity) {
+            int capacity = _trackedTaskCapacity == 0 ? 16 : _trackedTaskCapacity * 2;
+            TrackedTask tasks = (TrackedTask) realloc(_trackedTasks, capacity * sizeof(TrackedTaskStruct));
+            if (tasks == NULL) {
+                log_exit(1, "Could not allocate space for %d tracked tasks", capacity);
+            }
+            _trackedTasks = tasks;
+            _trackedTaskCapacity = capacity;
+        }
+        task = &_trackedTasks[_trackedTaskCount++];
+        task->tid = tid;
+    }
+    task->state = state;
+    return task;
+}
+
+static void tracked_task_remove(pid_t tid) {
+    TrackedTask task = tracked_task_find(tid);
+    if (task != NULL) {
+        *task = _trackedTasks[--_trackedTaskCount];
+    }
+}
+
+static int tracked_tasks_stopped(void) {
+    int nStopped = 0;
+    int n;
+    for (n = 0; n < _trackedTaskCount; n++) {
+        if (_trackedTasks[n].state == TRACKED_TASK_STOPPED) {
+            nStopped++;
+        }
+    }
+    return nStopped;
+}
+
+void process_tasks_reset(void) {
+    free(_trackedTasks);
+    _trackedTasks = NULL;
+    _trackedTaskCount = 0;
+    _trackedTaskCapacity = 0;
+    _trackedTgid = 0;
+}
+
+/**
+ * Seeds the task set from /proc/<tgid>/task unless it is already tracking the tasks of 'tgid'.
+ */
+static boolean process_tasks_track(pid_t tgid) {
+    if (_trackedTgid == tgid) {
+        return true;
+    }
+    process_tasks_reset();
+
+    pid_t *tasks;
+    const int nTasks = scan_process_tasks(tgid, &tasks);
     if (nTasks < 0) {
-        log_println("Error scanning /proc/%d/task directory: %s", pid, strerror(errno));
+        log_println("Error scanning /proc/%d/task directory: %s", tgid, strerror(errno));
+        return false;
+    }
+    int n;
+    for (n = 0; n < nTasks; n++) {
+        pid_t tid = tasks[n];
+        tracked_task_add(tid, task_state(tgid, tid) == 'T' ? TRACKED_TASK_STOPPED : TRACKED_TASK_RUNNING);
+    }
+    if (nTasks > 0) {
+        free(tasks);
+    }
+    _trackedTgid = tgid;
+    return true;
+}
+
+int process_tasks(pid_t tgid, pid_t **tasks) {
+    if (!process_tasks_track(tgid)) {
+        return -1;
+    }
+    (*tasks) = (pid_t *) malloc((_trackedTaskCount + 1) * sizeof(pid_t));
+    c_ASSERT(*tasks != NULL);
+    int n;
+    for (n = 0; n < _trackedTaskCount; n++) {
+        (*tasks)[n] = _trackedTasks[n].tid;
+    }
+    return _trackedTaskCount;
+}
+
+void process_task_resumed(pid_t tgid, pid_t tid) {
+    if (_trackedTgid == tgid) {
+        TrackedTask task = tracked_task_find(tid);
+        if (task != NULL) {
+            task->state = TRACKED_TASK_RUNNING;
+        }
+    }
+}
+
+jboolean process_resume_all_threads(pid_t pid) {
+    if (!process_tasks_track(pid)) {
         return false;
     }
 
     boolean result = true;
     int n = 0;
-    while (n < nTasks) {
-        pid_t tid = tasks[n];
+    while (n < _trackedTaskCount) {
+        TrackedTask task = &_trackedTasks[n];
+        pid_t tid = task->tid;
 
         /* Clear any left over SIGSTOP or SIGTRAP signals. */
         siginfo_t siginfo;
@@ -360,153 +488,130 @@ jboolean process_resume_all_threads(pid_t pid) {
         if (ptrace(PT_CONTINUE, tid, 0, 0) != 0) {
             result = false;
         }
+        task->state = TRACKED_TASK_RUNNING;
         n++;
     }
-    free(tasks);
     return result;
 }
 
 int process_wait_all_threads_stopped(pid_t pid) {
+    if (!process_tasks_track(pid)) {
+        return -1;
+    }
     pid_t pgid = getpgid(pid);
 
     boolean stopping = false;
     while (1) {
-
-        pid_t *tasks;
-        const int nTasks = scan_process_tasks(pid, &tasks);
-        if (nTasks < 0) {
-            log_println("Error scanning /proc/%d/task directory: %s", pid, strerror(errno));
-            return -1;
+        if (_trackedTaskCount == 0) {
+            tele_log_println("All threads have exited");
+            return 0;
         }
-
-        if (stopping) {
-            tele_log_println("Stopping %d tasks...", nTasks);
-        } else {
-            tele_log_println("Scanning %d tasks...", nTasks);
+        if (tracked_tasks_stopped() == _trackedTaskCount) {
+            tele_log_println("Stopped all %d tasks...", _trackedTaskCount);
+            return _trackedTaskCount;
         }
 
-        int nStopped = 0;
-        int nExited = 0;
-        int n = 0;
-        while (n < nTasks) {
-            pid_t tid = tasks[n];
-
-            /* The WNOHANG option means that we won't be blocked on the waitpid() call if the signal
-             * state of the task has not changed since the last time waitpid() was called on it.
-             * The __WALL option is necessary so that we can wait on a thread not directly
-             * created by the primordial VM thread. This strangeness is due to the way threads
-             * are implemented on Linux. See the waitpid(2) man page for more detail. */
-            int waitOptions = WNOHANG | __WALL;
-            if (stopping) {
-                tele_log_println("Waiting for %d", tid);
+        /* Block until a task in the VM's process group changes state. The __WALL option is necessary
+         * so that we can wait on a thread not directly created by the primordial VM thread. This
+         * strangeness is due to the way threads are implemented on Linux. See the waitpid(2) man
+         * page for more detail. */
+        int status = 0;
+        pid_t tid = waitpid(-pgid, &status, __WALL);
+        if (tid < 0) {
+            if (errno == EINTR) {
+                continue;
             }
-            int status = 0;
-            int result = waitpid(tid, &status, waitOptions);
-            if (result == 0) {
-                char state = task_state(pid, tid);
-                if (state == 'T') {
-                    nStopped++;
-                }
-                tele_log_println("No change in task %d since waitpid last called on it", tid);
-            } else if (result < 0) {
-                log_println("Error calling waitpid(%d): %s", tid, strerror(errno));
-            } else if (WIFEXITED(status)) {
-                log_println("Task %d exited with exit status %d", tid, WEXITSTATUS(status));
-            } else if (WIFSIGNALED(status)) {
-                int signal = WTERMSIG(status);
-                log_println("Task %d terminated by signal %d [%s]", tid, signal, strsignal(signal));
-            } else if (WIFSTOPPED(status)) {
-                int signal = WSTOPSIG(status);
-                tele_log_println("Task %d stopped by signal %d [%s]", tid, signal, strsignal(signal));
-
-                if (!sigismember(&_caughtSignals, signal)) {
-                    tele_log_println("Resuming task %d with signal %d [%s]", tid, signal, strsignal(signal));
-                    ptrace(PT_CONTINUE, tid, NULL, (Address) signal);
-                } else {
-                    if (signal == SIGTRAP) {
-                        nStopped++;
-                        int event = PTRACE_EVENT(status);
-                        if (event != 0) {
-                            unsigned long eventMsg;
-                            ptrace(PT_GETEVENTMSG, tid, NULL, &eventMsg);
-                            if (event == PTRACE_EVENT_CLONE) {
-                                /* This is the SIGTRAP event denoting that a new thread has been started. */
-                                int newTid = eventMsg;
-                                task_attach_ptrace_to_new_task(newTid, tid);
-                                nStopped--;
-                            } else if (event == PTRACE_EVENT_EXIT) {
-                                /* This is the SIGTRAP event denoting that a thread is about to exit
-                                 * and needs to be detached from ptrace. */
-                                nExited++;
-                                nStopped--;
-                                tele_log_println("Detaching exiting task %d", tid);
-                                ptrace(PT_DETACH, tid, NULL, 0);
-                            } else {
-                                log_println("Task %d received unexpected ptrace event %d with message %ul", tid, event, eventMsg);
-                            }
-                        }
-                    } else {
-                        nStopped++;
-                    }
-                }
-            } else {
-                char state = task_state(pid, tid);
-                tele_log_println("Task %d not yet stopped; state = '%c'", tid, state);
-                if (state == 'Z') {
-                    /* Missed the PTRACE_EVENT_EXIT event for this task somehow. Still need to account
-                     * for it as exited. However, we cannot no longer PT_DETACH it. */
-                    tele_log_println("Missed exit event for task %d: cleaning up anyway", tid);
-                    nExited++;
-                }
+            if (errno == ECHILD) {
+                tele_log_println("No tasks left to wait for in process group %d", pgid);
+                process_tasks_reset();
+                return 0;
             }
-            n++;
+            log_println("Error calling waitpid(%d): %s", -pgid, strerror(errno));
+            return -1;
         }
-        free(tasks);
 
-        if (nExited == nTasks) {
-            tele_log_println("All threads have exited");
-            return 0;
+        if (WIFEXITED(status)) {
+            log_println("Task %d exited with exit status %d", tid, WEXITSTATUS(status));
+            tracked_task_remove(tid);
+            continue;
         }
-
-        if (nStopped == 0) {
-            /* No tasks are stopped yet: continue after a brief sleep */
-            usleep(PROCESS_POLL_PAUSE_NANOSECONDS);
+        if (WIFSIGNALED(status)) {
+            int signal = WTERMSIG(status);
+            log_println("Task %d terminated by signal %d [%s]", tid, signal, strsignal(signal));
+            tracked_task_remove(tid);
+            continue;
+        }
+        if (!WIFSTOPPED(status)) {
             continue;
         }
 
-        if (nStopped != nTasks) {
-            /* Give all tasks a brief chance to receive the last SIGSTOP (if any) */
-            usleep(PROCESS_POLL_PAUSE_NANOSECONDS);
+        int signal = WSTOPSIG(status);
+        tele_log_println("Task %d stopped by signal %d [%s]", tid, signal, strsignal(signal));
 
-            /* Stop all threads by sending SIGSTOP to the process group (which is why the VM
-             * must run in a separate process group from the debugger!). Note that the tasks
-             * already stopped due to a previous SIGSTOP will simply ignore this SIGSTOP.
-             * However, the SIGSTOP must be sent until all tasks have stopped so that we catch
-             * tasks that start in between each SIGSTOP. */
-            tele_log_println("Not all tasks stopped yet - sending SIGSTOP to process group %d", pgid);
-            kill(-pgid, SIGSTOP);
-            stopping = true;
+        TrackedTask task = tracked_task_find(tid);
+        if (task == NULL && signal == SIGSTOP) {
+            /* The initial stop of a new task can be reported before the clone event of its starter. */
+            tele_log_println("New task %d stopped before its clone event was reported", tid);
+            tracked_task_add(tid, TRACKED_TASK_NEW);
             continue;
         }
+        if (task == NULL) {
+            task = tracked_task_add(tid, TRACKED_TASK_RUNNING);
+        }
 
-        /* Re-scan tasks to ensure we've got them all and they are all stopped. */
-        const int mTasks = scan_process_tasks(pid, &tasks);
-        if (mTasks < 0) {
-            log_println("Error scanning /proc/%d/task directory: %s", pid, strerror(errno));
+        if (!sigismember(&_caughtSignals, signal)) {
+            tele_log_println("Resuming task %d with signal %d [%s]", tid, signal, strsignal(signal));
+            ptrace(PT_CONTINUE, tid, NULL, (Address) signal);
+            task->state = TRACKED_TASK_RUNNING;
             continue;
         }
-        free(tasks);
 
-        int nNewTasks = mTasks - nTasks;
-        if (nNewTasks != 0) {
-            tele_log_println("%d new tasks started since last scan - continuing...", mTasks - nTasks);
+        int event = signal == SIGTRAP ? PTRACE_EVENT(status) : 0;
+        if (event == PTRACE_EVENT_CLONE) {
+            /* This is the SIGTRAP event denoting that a new thread has been started. */
+            unsigned long eventMsg;
+            ptrace(PT_GETEVENTMSG, tid, NULL, &eventMsg);
+            pid_t newTid = (pid_t) eventMsg;
+            TrackedTask newTask = tracked_task_find(newTid);
+            if (newTask != NULL && newTask->state == TRACKED_TASK_NEW) {
+                ptrace(PT_SETOPTIONS, newTid, 0, PTRACE_O_TRACECLONE | PTRACE_O_TRACEEXIT);
+                watchpoint_attach_task(newTid);
+                tele_log_println("Resuming tasks %d and %d", newTid, tid);
+                ptrace(PT_CONTINUE, newTid, 0, 0);
+                ptrace(PT_CONTINUE, tid, 0, 0);
+            } else {
+                task_attach_ptrace_to_new_task(newTid, tid);
+            }
+            /* 'task' may have moved if the set grew. */
+            tracked_task_add(newTid, TRACKED_TASK_RUNNING);
+            tracked_task_add(tid, TRACKED_TASK_RUNNING);
+            if (stopping) {
+                /* The new task may have started after the last SIGSTOP was delivered. */
+                kill(-pgid, SIGSTOP);
+            }
             continue;
+        } else if (event == PTRACE_EVENT_EXIT) {
+            /* This is the SIGTRAP event denoting that a thread is about to exit
+             * and needs to be detached from ptrace. */
+            tele_log_println("Detaching exiting task %d", tid);
+            ptrace(PT_DETACH, tid, NULL, 0);
+            tracked_task_remove(tid);
+            continue;
+        } else if (event != 0) {
+            unsigned long eventMsg;
+            ptrace(PT_GETEVENTMSG, tid, NULL, &eventMsg);
+            log_println("Task %d received unexpected ptrace event %d with message %ul", tid, event, eventMsg);
         }
 
-        /* We are now sure that we have stopped all the tasks. */
-        stopping = false;
-        tele_log_println("Stopped all tasks...");
-        return mTasks;
+        task->state = TRACKED_TASK_STOPPED;
+        if (!stopping && tracked_tasks_stopped() != _trackedTaskCount) {
+            /* Stop all threads by sending SIGSTOP to the process group (which is why the VM
+             * must run in a separate process group from the debugger!). Note that the tasks
+             * already stopped due to a previous SIGSTOP will simply ignore this SIGSTOP. */
+            tele_log_println("Not all tasks stopped yet - sending SIGSTOP to process group %d", pgid);
+            kill(-pgid, SIGSTOP);
+            stopping = true;
+        }
     }
 }
 
@@ -670,6 +775,9 @@ int process_wait_all_threads_stopped_alternative(pid_t pid) {
 JNIEXPORT jint JNICALL
 Java_com_sun_max_tele_debug_linux_LinuxTask_nativeCreateChildProcess(JNIEnv *env, jclass c, jlong commandLineArgumentArray, jint vmAgentPort) {
     char **argv = (char**) (intptr_t) commandLineArgumentArray;
+    pageCache_invalidate();
+    process_tasks_reset();
+    watchpoint_reset();
 
     /* Configure the debugging related signals we want to intercept. */
     sigemptyset(&_caughtSignals);
@@ -724,6 +832,10 @@ Java_com_sun_max_tele_debug_linux_LinuxTask_nativeCreateChildProcess(JNIEnv *env
 
 JNIEXPORT jboolean JNICALL
 Java_com_sun_max_tele_debug_linux_LinuxTask_nativeDetach(JNIEnv *env, jclass c, jint tgid, jint tid) {
+    task_memory_close();
+    pageCache_invalidate();
+    process_tasks_reset();
+    watchpoint_reset();
     return ptrace(PT_DETACH, tid, 0, 0) == 0;
 }
 
@@ -740,25 +852,136 @@ Java_com_sun_max_tele_debug_linux_LinuxTask_nativeSuspend(JNIEnv *env, jclass c,
 
 JNIEXPORT jboolean JNICALL
 Java_com_sun_max_tele_debug_linux_LinuxTask_nativeSingleStep(JNIEnv *env, jclass c, jint tgid, int tid) {
+    pageCache_invalidate();
+    watchpoint_prepare_resume();
     if (ptrace(PT_STEP, tid, 0, 0) != 0) {
         return false;
     }
+    process_task_resumed(tgid, tid);
     return true;
 }
 
+/**
+ * Reads the instruction pointer of a stopped task.
+ */
+static boolean task_read_instruction_pointer(pid_t tid, Address *ip) {
+    user_regs_structure registers;
+
+    if (ptrace(PT_GETREGS, tid, 0, &registers) != 0) {
+        return false;
+    }
+#ifdef __arm__
+    *ip = registers.uregs[15];
+#elif defined __aarch64__
+    *ip = registers.pc;
+#elif defined(__riscv64__) || defined(riscv64) || defined(RISCV64)
+    *ip = registers.pc;
+#else
+    *ip = registers.rip;
+#endif
+    return true;
+}
+
+/* Reasons returned by nativeStepUntil; must match the constants in LinuxTask.java. */
+#define STEP_UNTIL_ERROR         -1
+#define STEP_UNTIL_TARGET         0
+#define STEP_UNTIL_LEFT_RANGE     1
+#define STEP_UNTIL_LIMIT          2
+#define STEP_UNTIL_TRAPPED        3
+#define STEP_UNTIL_PENDING        4
+
+/**
+ * Single steps a task until it reaches a given address, leaves a given address range or has executed
+ * a given number of instructions, without returning to the debugger between steps. Each step only
+ * costs a ptrace(PT_STEP), a wait and a register read instead of a round trip through the Java side
+ * of the channel.
+ *
+ * The loop stops early if the task stops for any reason other than the completion of a single step
+ * (e.g. it hit a breakpoint or a watchpoint, or received another signal). A trace trap is consumed by
+ * this function and leaves the task tracked as stopped. Any other change of state is left pending and
+ * the task is marked as resumed so that the general wait reports it.
+ *
+ * @param target stop when the instruction pointer equals this address (0 for no target)
+ * @param rangeStart the start of the range (inclusive) within which stepping continues
+ * @param rangeEnd the end of the range (exclusive); if {@code rangeEnd <= rangeStart} there is no range
+ * @param maxSteps the maximum number of instructions to step
+ * @return one of the STEP_UNTIL_* reasons
+ */
+JNIEXPORT jint JNICALL
+Java_com_sun_max_tele_debug_linux_LinuxTask_nativeStepUntil(JNIEnv *env, jclass c, jint tgid, jint tid, jlong target, jlong rangeStart, jlong rangeEnd, jlong maxSteps) {
+    boolean checkRange = rangeStart < rangeEnd;
+    jlong steps = 0;
+
+    pageCache_invalidate();
+    watchpoint_prepare_resume();
+    while (true) {
+        if (ptrace(PT_STEP, tid, 0, 0) != 0) {
+            return STEP_UNTIL_ERROR;
+        }
+        steps++;
+
+        /* Peek at the state change so that anything other than a trap can be left for the general wait. */
+        siginfo_t info;
+        memset(&info, 0, sizeof(info));
+        while (waitid(P_PID, tid, &info, WSTOPPED | WEXITED | __WALL | WNOWAIT) != 0) {
+            if (errno != EINTR) {
+                log_println("Error calling waitid(%d): %s", tid, strerror(errno));
+                return STEP_UNTIL_ERROR;
+            }
+        }
+        if (info.si_code != CLD_TRAPPED || info.si_status != SIGTRAP) {
+            process_task_resumed(tgid, tid);
+            return STEP_UNTIL_PENDING;
+        }
+
+        int status;
+        if (waitpid(tid, &status, __WALL) != tid) {
+            log_println("Error calling waitpid(%d): %s", tid, strerror(errno));
+            return STEP_UNTIL_ERROR;
+        }
+        siginfo_t siginfo;
+        if (ptrace(PT_GETSIGINFO, tid, NULL, &siginfo) == 0 && siginfo.si_code != TRAP_TRACE) {
+            /* A breakpoint or watchpoint was hit. */
+            return STEP_UNTIL_TRAPPED;
+        }
+
+        Address ip;
+        if (!task_read_instruction_pointer(tid, &ip)) {
+            return STEP_UNTIL_ERROR;
+        }
+        if (ip == (Address) target) {
+            return STEP_UNTIL_TARGET;
+        }
+        if (checkRange && (ip < (Address) rangeStart || ip >= (Address) rangeEnd)) {
+            return STEP_UNTIL_LEFT_RANGE;
+        }
+        if (steps >= maxSteps) {
+            return STEP_UNTIL_LIMIT;
+        }
+    }
+}
+
 JNIEXPORT jboolean JNICALL
 Java_com_sun_max_tele_debug_linux_LinuxTask_nativeResume(JNIEnv *env, jclass c, jint tgid, jint tid, jboolean allTasks) {
+    pageCache_invalidate();
+    watchpoint_prepare_resume();
     if (allTasks) {
         return process_resume_all_threads(tgid);
     }
     int result = ptrace(PT_CONTINUE, tid, NULL, 0);
+    if (result == 0) {
+        process_task_resumed(tgid, tid);
+    }
     return result == 0;
 }
 
 JNIEXPORT jint JNICALL
 Java_com_sun_max_tele_debug_linux_LinuxTask_nativeWait(JNIEnv *env, jclass c, jint tgid, jint tid, jboolean allTasks) {
     if (allTasks) {
-        if (process_wait_all_threads_stopped(tgid) > 0) {
+        int stopped = process_wait_all_threads_stopped(tgid);
+        /* Pages read while the process was running may have changed before it stopped. */
+        pageCache_invalidate();
+        if (stopped > 0) {
             return PS_STOPPED;
         }
         return PS_TERMINATED;
@@ -770,6 +993,10 @@ Java_com_sun_max_tele_debug_linux_LinuxTask_nativeWait(JNIEnv *env, jclass c, ji
 JNIEXPORT jboolean JNICALL
 Java_com_sun_max_tele_debug_linux_LinuxTask_nativeKill(JNIEnv *env, jclass c, jint tgid, jint tid) {
     pid_t killID = -getpgid(tgid);
+    task_memory_close();
+    pageCache_invalidate();
+    process_tasks_reset();
+    watchpoint_reset();
     tele_log_println("Sending SIGKILL to %d", tid, killID);
     if (kill(killID, SIGKILL) != 0) {
         log_println("Error sending SIGKILL to kill process %d: %s", tgid, strerror(errno));
@@ -778,34 +1005,64 @@ Java_com_sun_max_tele_debug_linux_LinuxTask_nativeKill(JNIEnv *env, jclass c, ji
     return true;
 }
 
-/**
- * Gets an open file descriptor on /proc/<pid>/mem for reading the memory of the traced process 'tgid'.
- *
- * @param tgid the task group id of the traced process
- * @param address the address at which the memory of tgid is to be read
- * @return a file descriptor opened on the memory file and positioned at 'address' or -1 if there was an error.
- *        If there was no error, it is the caller's responsibility to close the file descriptor.
- */
-int task_memory_read_fd(int tgid, const void *address) {
+/* The process whose memory file is open on _memoryFileFd. */
+static pid_t _memoryFileTgid = 0;
+static int _memoryFileFd = -1;
+static boolean _memoryFileWritable = false;
+
+/* Set once process_vm_readv(2) and process_vm_writev(2) have been found to be unsupported by the kernel. */
+static boolean _processVmUnsupported = false;
+
+int task_memory_fd(pid_t tgid) {
     ptrace_check_tracer(POS, tgid);
-    char *memoryFileName;
-    asprintf(&memoryFileName, "/proc/%d/mem", tgid);
-    c_ASSERT(memoryFileName != NULL);
-    int fd = open(memoryFileName, O_RDONLY);
+    if (_memoryFileFd >= 0 && _memoryFileTgid == tgid) {
+        return _memoryFileFd;
+    }
+    task_memory_close();
+    char memoryFileName[64];
+    snprintf(memoryFileName, sizeof(memoryFileName), "/proc/%d/mem", tgid);
+    int fd = open(memoryFileName, O_RDWR | O_CLOEXEC);
+    _memoryFileWritable = fd >= 0;
+    if (fd < 0) {
+        fd = open(memoryFileName, O_RDONLY | O_CLOEXEC);
+    }
     if (fd < 0) {
         log_println("Error opening %s: %s", memoryFileName, strerror(errno));
         return fd;
     }
-    free(memoryFileName);
+    _memoryFileFd = fd;
+    _memoryFileTgid = tgid;
+    return fd;
+}
 
-    off64_t fdOffset = (off64_t) (intptr_t)address;
+void task_memory_close(void) {
+    if (_memoryFileFd >= 0) {
+        close(_memoryFileFd);
+        _memoryFileFd = -1;
+        _memoryFileTgid = 0;
+        _memoryFileWritable = false;
+    }
+}
 
-    if (lseek64(fd, fdOffset, SEEK_SET) != fdOffset) {
-        log_println("Error seeking memory file for process %d to %p [%ul]: %s", tgid, address, fdOffset, strerror(errno));
-        close(fd);
-        return -1;
+/**
+ * Transfers memory between the caller and 'tgid' with process_vm_readv(2) or process_vm_writev(2).
+ *
+ * @return the number of bytes transferred or -1 if the call failed, in which case errno is set
+ */
+static ssize_t process_vm_transfer(pid_t tgid, void *local, void *remote, size_t size, boolean write) {
+#if defined(__NR_process_vm_readv) && defined(__NR_process_vm_writev)
+    if (!_processVmUnsupported) {
+        struct iovec localIov = { local, size };
+        struct iovec remoteIov = { remote, size };
+        ssize_t result = syscall(write ? __NR_process_vm_writev : __NR_process_vm_readv, tgid, &localIov, 1, &remoteIov, 1, 0);
+        if (result < 0 && errno == ENOSYS) {
+            _processVmUnsupported = true;
+        }
+        return result;
     }
-    return fd;
+#endif
+    errno = ENOSYS;
+    return -1;
 }
 
 /**
@@ -819,6 +1076,13 @@ size_t task_read(pid_t tgid, pid_t tid, const void *src, void *dst, size_t size)
     }
 
     //tele_log_println("Reading %d bytes from memory of task %d at %p", size, tid, src);
+    ssize_t bytesRead = process_vm_transfer(tgid, dst, (void *) src, size, false);
+    if (bytesRead >= 0) {
+        if ((size_t) bytesRead != size) {
+            log_println("Only read %d of %d bytes from %p", bytesRead, size, src);
+        }
+        return bytesRead;
+    }
     if (size <= sizeof(Address)) {
         Address word = ptrace(PT_READ_D, tid, (Address) src, NULL);
         if (errno != 0) {
@@ -830,19 +1094,63 @@ size_t task_read(pid_t tgid, pid_t tid, const void *src, void *dst, size_t size)
         }
         return size;
     } else {
-        int fd = task_memory_read_fd(tgid, src);
+        int fd = task_memory_fd(tgid);
         if (fd < 0) {
             return -1;
         }
-        size_t bytesRead = read(fd, dst, size);
-        if (bytesRead != size) {
+        bytesRead = pread64(fd, dst, size, (off64_t) (intptr_t) src);
+        if (bytesRead != (ssize_t) size) {
             log_println("Only read %d of %d bytes from %p: %s", bytesRead, size, src, strerror(errno));
         }
-        close(fd);
         return bytesRead;
     }
 }
 
+int task_readv(pid_t tgid, pid_t tid, const struct iovec *local, const struct iovec *remote, int count) {
+    char state;
+    if ((state = task_state(tgid, tid)) != 'T') {
+        log_println("Cannot read memory of task %d while it is in state '%c'", tid, state);
+        return 0;
+    }
+
+    int done = 0;
+    while (done < count) {
+        /* The kernel transfers whole iovec elements, so a short count ends at an element boundary. */
+        int n = count - done > UIO_MAXIOV ? UIO_MAXIOV : count - done;
+        size_t expected = 0;
+        int i;
+        for (i = 0; i < n; i++) {
+            expected += remote[done + i].iov_len;
+        }
+        ssize_t bytesRead;
+#if defined(__NR_process_vm_readv)
+        bytesRead = _processVmUnsupported ? -1 : syscall(__NR_process_vm_readv, tgid, local + done, n, remote + done, n, 0);
+        if (bytesRead < 0 && errno == ENOSYS) {
+            _processVmUnsupported = true;
+        }
+#else
+        bytesRead = -1;
+#endif
+        if (bytesRead >= 0 && (size_t) bytesRead == expected) {
+            done += n;
+            continue;
+        }
+        /* Skip the elements that were transferred and read the next one on its own (with a fallback if the
+         * kernel does not support process_vm_readv), stopping at the first that cannot be read completely. */
+        size_t skipped = bytesRead > 0 ? (size_t) bytesRead : 0;
+        while (done < count && skipped >= remote[done].iov_len && remote[done].iov_len != 0) {
+            skipped -= remote[done].iov_len;
+            done++;
+        }
+        size_t length = remote[done].iov_len;
+        if (length != 0 && task_read(tgid, tid, remote[done].iov_base, local[done].iov_base, length) != length) {
+            break;
+        }
+        done++;
+    }
+    return done;
+}
+
 /**
  * Copies 'size' bytes from 'src' in the caller's address space to 'dst' in the address space of 'tgid'.
  * The value of 'size' must be >= 0 and < sizeof(Word).
@@ -891,6 +1199,13 @@ size_t task_write(pid_t tgid, pid_t tid, void *dst, const void *src, size_t size
         return 0;
     }
 
+    /* A page that is not writable in the task (e.g. code in which a breakpoint is being set)
+     * can only be written with ptrace, so a failure here falls back to ptrace. */
+    ssize_t result = process_vm_transfer(tgid, (void *) src, dst, size, true);
+    if (result == (ssize_t) size) {
+        return size;
+    }
+
     size_t bytesWritten = 0;
     const size_t wholeWords = size / sizeof(Word);
     if (wholeWords > 0) {
@@ -912,6 +1227,150 @@ size_t task_write(pid_t tgid, pid_t tid, void *dst, const void *src, size_t size
     return bytesWritten;
 }
 
+typedef struct {
+    Address address;
+    size_t length;
+    const char *data;
+    int index;
+} PatchStruct, *Patch;
+
+static int comparePatches(const void *a, const void *b) {
+    Patch p1 = (Patch) a;
+    Patch p2 = (Patch) b;
+    if (p1->address != p2->address) {
+        return p1->address < p2->address ? -1 : 1;
+    }
+    return p1->index - p2->index;
+}
+
+/**
+ * Patches the span [start, end) of the memory of 'tgid' with one read and one write of its memory file.
+ * The span must lie within the pages spanned by 'patches', which must all lie within the span.
+ */
+static boolean task_write_span(pid_t tgid, Patch patches, int count, Address start, Address end) {
+    int fd = task_memory_fd(tgid);
+    if (fd < 0 || !_memoryFileWritable) {
+        return false;
+    }
+    size_t size = end - start;
+    char *buffer = (char *) malloc(size);
+    if (buffer == NULL) {
+        return false;
+    }
+    boolean result = false;
+    if (pread64(fd, buffer, size, (off64_t) start) == (ssize_t) size) {
+        int i;
+        for (i = 0; i < count; i++) {
+            memcpy(buffer + (patches[i].address - start), patches[i].data, patches[i].length);
+        }
+        result = pwrite64(fd, buffer, size, (off64_t) start) == (ssize_t) size;
+    }
+    free(buffer);
+    return result;
+}
+
+int task_writev(pid_t tgid, pid_t tid, const struct iovec *local, const struct iovec *remote, int count) {
+    if (count <= 0) {
+        return 0;
+    }
+    char state;
+    if ((state = task_state(tgid, tid)) != 'T') {
+        log_println("Cannot write to memory of task %d while it is in state '%c'", tid, state);
+        return 0;
+    }
+
+    Patch patches = (Patch) malloc(count * sizeof(PatchStruct));
+    boolean *written = (boolean *) calloc(count, sizeof(boolean));
+    struct iovec *iovecs = (struct iovec *) malloc(2 * UIO_MAXIOV * sizeof(struct iovec));
+    if (patches == NULL || written == NULL || iovecs == NULL) {
+        log_println("Failed to malloc descriptors for a batch of %d writes", count);
+        free(patches);
+        free(written);
+        free(iovecs);
+        return 0;
+    }
+    int i;
+    for (i = 0; i < count; i++) {
+        patches[i].address = (Address) remote[i].iov_base;
+        patches[i].length = remote[i].iov_len;
+        patches[i].data = (const char *) local[i].iov_base;
+        patches[i].index = i;
+        written[i] = patches[i].length == 0;
+    }
+    qsort(patches, count, sizeof(PatchStruct), comparePatches);
+
+    /* Writable memory takes one process_vm_writev per chunk of patches. */
+#if defined(__NR_process_vm_writev)
+    int done = 0;
+    while (done < count && !_processVmUnsupported) {
+        int n = count - done > UIO_MAXIOV ? UIO_MAXIOV : count - done;
+        struct iovec *localChunk = iovecs;
+        struct iovec *remoteChunk = iovecs + UIO_MAXIOV;
+        for (i = 0; i < n; i++) {
+            Patch patch = &patches[done + i];
+            localChunk[i].iov_base = (void *) patch->data;
+            localChunk[i].iov_len = patch->length;
+            remoteChunk[i].iov_base = (void *) patch->address;
+            remoteChunk[i].iov_len = patch->length;
+        }
+        ssize_t bytesWritten = syscall(__NR_process_vm_writev, tgid, localChunk, n, remoteChunk, n, 0);
+        if (bytesWritten < 0 && errno == ENOSYS) {
+            _processVmUnsupported = true;
+            break;
+        }
+        /* The kernel transfers whole iovec elements, so a short count ends at an element boundary. */
+        size_t remaining = bytesWritten > 0 ? (size_t) bytesWritten : 0;
+        for (i = 0; i < n && remaining >= patches[done + i].length; i++) {
+            remaining -= patches[done + i].length;
+            written[patches[done + i].index] = true;
+        }
+        done += n;
+    }
+#endif
+
+    /* The rest (typically code that is not writable in the task) is patched a page at a time. */
+    const Address pageMask = ~((Address) sysconf(_SC_PAGESIZE) - 1);
+    int first = 0;
+    while (first < count) {
+        if (written[patches[first].index]) {
+            first++;
+            continue;
+        }
+        Address start = patches[first].address;
+        Address end = start + patches[first].length;
+        int last = first + 1;
+        while (last < count && (patches[last].address & pageMask) <= ((end - 1) & pageMask)) {
+            if (patches[last].address + patches[last].length > end) {
+                end = patches[last].address + patches[last].length;
+            }
+            last++;
+        }
+        /* Already written patches in the span are written again with the same bytes. */
+        if (task_write_span(tgid, &patches[first], last - first, start, end)) {
+            for (i = first; i < last; i++) {
+                written[patches[i].index] = true;
+            }
+        } else {
+            for (i = first; i < last; i++) {
+                Patch patch = &patches[i];
+                if (!written[patch->index] && task_write(tgid, tid, (void *) patch->address, patch->data, patch->length) == patch->length) {
+                    written[patch->index] = true;
+                }
+            }
+        }
+        first = last;
+    }
+
+    int result = 0;
+    while (result < count && written[result]) {
+        result++;
+    }
+    free(patches);
+    free(written);
+    free(iovecs);
+    return result;
+}
+
 JNIEXPORT jint JNICALL
 Java_com_sun_max_tele_debug_linux_LinuxTask_nativeWriteBytes(JNIEnv *env, jclass c, jint tgid, jint tid, jlong dst, jobject src, jboolean isDirectByteBuffer, jint srcOffset, jint length) {
     ProcessHandleStruct ph = {tgid, tid};
@@ -924,6 +1383,26 @@ Java_com_sun_max_tele_debug_linux_LinuxTask_nativeReadBytes(JNIEnv *env, jclass
     return teleProcess_read(&ph, env, c, src, dst, isDirectByteBuffer, dstOffset, length);
 }
 
+JNIEXPORT void JNICALL
+Java_com_sun_max_tele_debug_linux_LinuxTask_nativeClose(JNIEnv *env, jclass c) {
+    task_memory_close();
+    pageCache_invalidate();
+    process_tasks_reset();
+    watchpoint_reset();
+}
+
+JNIEXPORT jint JNICALL
+Java_com_sun_max_tele_debug_linux_LinuxTask_nativeReadBytesBatch(JNIEnv *env, jclass c, jint tgid, jint tid, jlongArray descriptors, jint count, jobject dst) {
+    ProcessHandleStruct ph = {tgid, tid};
+    return teleProcess_readBatch(&ph, env, c, descriptors, count, dst);
+}
+
+JNIEXPORT jint JNICALL
+Java_com_sun_max_tele_debug_linux_LinuxTask_nativeWriteBytesBatch(JNIEnv *env, jclass c, jint tgid, jint tid, jlongArray descriptors, jint count, jobject src) {
+    ProcessHandleStruct ph = {tgid, tid};
+    return teleProcess_writeBatch(&ph, env, c, descriptors, count, src);
+}
+
 JNIEXPORT jboolean JNICALL
 Java_com_sun_max_tele_debug_linux_LinuxTask_nativeSetInstructionPointer(JNIEnv *env, jclass c, jint tid, jlong instructionPointer) {
     user_regs_structure registers;
@@ -27,6 +27,8 @@
 #ifndef __linuxTask_h__
 #define __linuxTask_h__ 1
 
+#include <sys/uio.h>
+
 #include "isa.h"
 
 /**
@@ -73,20 +75,36 @@ extern pid_t _ptracerTask;
 #define _LARGEFILE64_SOURCE 1
 
 /**
- * Gets an open file descriptor on /proc/<pid>/mem for reading the memory of the traced process 'tgid'.
+ * Gets an open file descriptor on /proc/<pid>/mem for accessing the memory of the traced process 'tgid' with
+ * pread(2) and, if the file could be opened for writing, pwrite(2).
+ * The file stays open for subsequent calls with the same 'tgid' until task_memory_close() is called.
  *
  * @param tgid the task group id of the traced process
- * @param address the address at which the memory of tgid is to be read
- * @return a file descriptor opened on the memory file and positioned at 'address' or -1 if there was an error.
- *        If there was no error, it is the caller's responsibility to close the file descriptor.
+ * @return a file descriptor opened on the memory file or -1 if there was an error. The caller must not close it.
+ */
+int task_memory_fd(pid_t tgid);
+
+/**
+ * Closes the file descriptor returned by task_memory_fd(), if any. This is called when the traced process is
+ * detached or killed.
  */
-int task_memory_read_fd(int tgid, const void *address);
+void task_memory_close(void);
 
 /**
  * Copies 'size' bytes from 'src' in the address space of 'tgid' to 'dst' in the caller's address space.
+ * This uses process_vm_readv(2) if the kernel supports it, falling back to ptrace(2) for a word or less
+ * and to the memory file returned by task_memory_fd() for larger reads.
  */
 size_t task_read(pid_t tgid, pid_t tid, const void *src, void *dst, size_t size);
 
+/**
+ * Copies the 'count' ranges described by 'remote' in the address space of 'tgid' to the ranges described by
+ * 'local' in the caller's address space, with as few process_vm_readv(2) calls as possible.
+ *
+ * @return the number of leading ranges that were copied completely
+ */
+int task_readv(pid_t tgid, pid_t tid, const struct iovec *local, const struct iovec *remote, int count);
+
 /**
  * Copies 'size' bytes from 'src' in the caller's address space to 'dst' in the address space of 'tgid'.
  * The value of 'size' must be >= 0 and < sizeof(Word).
@@ -95,12 +113,28 @@ int task_write_subword(jint tgid, jint tid, void *dst, const void *src, size_t s
 
 /**
  * Copies 'size' bytes from 'src' in the caller's address space to 'dst' in the address space of 'tgid'.
+ * This uses process_vm_writev(2) if the kernel supports it and the destination is writable in 'tgid',
+ * and ptrace(2) otherwise.
  */
 size_t task_write(pid_t tgid, pid_t tid, void *dst, const void *src, size_t size);
 
+/**
+ * Copies the 'count' ranges described by 'local' in the caller's address space to the ranges described by
+ * 'remote' in the address space of 'tgid', e.g. the patches for setting or clearing a batch of breakpoints.
+ * The ranges are sorted by address and written with one process_vm_writev(2) call per UIO_MAXIOV ranges.
+ * Ranges that cannot be written that way (e.g. in code that is not writable in 'tgid') are coalesced
+ * per page and each page is patched with one read and one write of the memory file, falling back to
+ * ptrace(2) per range. Overlapping ranges are not supported.
+ *
+ * @return the number of leading ranges that were copied completely
+ */
+int task_writev(pid_t tgid, pid_t tid, const struct iovec *local, const struct iovec *remote, int count);
+
 /**
  * Waits for at least one thread in a given process to stop on a SIGTRAP or SIGSTOP at which
- * time, all threads in the process group will be stopped (via SIGSTOP).
+ * time, all threads in the process group will be stopped (via SIGSTOP). This blocks in waitpid(2)
+ * on the process group and tracks the tasks of the process from their clone and exit events
+ * rather than polling /proc.
  *
  * @param pid the PID of the process whose threads are to stopped once any one of them hits a
  *        breakpoint or receives some other debugger related signal
@@ -108,6 +142,29 @@ size_t task_write(pid_t tgid, pid_t tid, void *dst, const void *src, size_t size
  */
 int process_wait_all_threads_stopped(pid_t pid);
 
+/**
+ * Gets the tasks of a given process from the task set maintained by process_wait_all_threads_stopped().
+ * The set is seeded from /proc/<pid>/task the first time 'pid' is seen and is then updated from the
+ * clone and exit events reported by ptrace.
+ *
+ * @param pid the PID of the traced process
+ * @param tasks [out] an array of the PIDs of the tasks in the set. The memory allocated for this
+ *        array needs to be reclaimed by the caller.
+ * @return the number of entries returned in 'tasks' or -1 if an error occurs
+ */
+int process_tasks(pid_t pid, pid_t **tasks);
+
+/**
+ * Records that a single task of the traced process has been resumed or single stepped.
+ */
+void process_task_resumed(pid_t pid, pid_t tid);
+
+/**
+ * Discards the task set maintained for the traced process. This is called when the process
+ * is created, detached or killed.
+ */
+void process_tasks_reset(void);
+
 /**
  * Converts a directory entry to a numeric PID.
  *
@@ -26,6 +26,8 @@
 #include <stdlib.h>
 #include <sys/types.h>
 #include <sys/user.h>
+#include <sys/uio.h>
+#include <stddef.h>
 #include <alloca.h>
 
 #include "log.h"
@@ -37,6 +39,24 @@
 #include "teleProcess.h"
 #include "teleNativeThread.h"
 #include "linuxTask.h"
+#include "linuxWatchpoint.h"
+
+/**
+ * Reads one register set of 'tid' with PT_GETREGSET, checking that the kernel filled all of 'regs'.
+ */
+static boolean task_read_register_set(pid_t tid, int type, void *regs, size_t size) {
+    struct iovec iov;
+    iov.iov_base = regs;
+    iov.iov_len = size;
+    if (ptrace(PT_GETREGSET, tid, (Address) type, &iov) != 0) {
+        return false;
+    }
+    if (iov.iov_len != size) {
+        log_println("Register set %d of task %d has %lu bytes, expected %lu", type, tid, iov.iov_len, size);
+        return false;
+    }
+    return true;
+}
 
 boolean task_read_registers(pid_t tid,
     isa_CanonicalIntegerRegistersStruct *canonicalIntegerRegisters,
@@ -49,7 +69,7 @@ boolean task_read_registers(pid_t tid,
 #else
 	    struct user_regs osIntegerRegisters;
 #endif
-        if (ptrace(PT_GETREGS, tid, 0, &osIntegerRegisters) != 0) {
+        if (!task_read_register_set(tid, PT_NT_PRSTATUS, &osIntegerRegisters, sizeof(osIntegerRegisters))) {
             return false;
         }
         if (canonicalIntegerRegisters != NULL) {
@@ -70,7 +90,7 @@ boolean task_read_registers(pid_t tid,
 #else
         struct user_fpregs_struct osFloatRegisters;
 #endif
-        if (ptrace(PT_GETFPREGS, tid, 0, &osFloatRegisters) != 0) {
+        if (!task_read_register_set(tid, PT_NT_PRFPREG, &osFloatRegisters, sizeof(osFloatRegisters))) {
             return false;
         }
         isa_canonicalizeTeleFloatingPointRegisters(&osFloatRegisters, canonicalFloatingPointRegisters);
@@ -96,47 +116,93 @@ ThreadState_t toThreadState(char taskState, pid_t tid) {
     return threadState;
 }
 
-static void gatherThread(JNIEnv *env, pid_t tgid, pid_t tid, jobject linuxTeleProcess, jobject threadList, jlong tlaList) {
+/*
+ * The registers of every task captured while gathering the threads at a stop. The records are
+ * written into a direct ByteBuffer supplied by LinuxNativeTeleChannelProtocol, which serves the
+ * register reads of the stop from it instead of making ptrace and JNI calls per thread.
+ */
+typedef struct {
+    jint tid;
+    jint valid;
+    isa_CanonicalIntegerRegistersStruct integerRegisters;
+    isa_CanonicalFloatingPointRegistersStruct floatingPointRegisters;
+    isa_CanonicalStateRegistersStruct stateRegisters;
+} RegisterSnapshotStruct, *RegisterSnapshot;
+
+static void gatherThread(JNIEnv *env, pid_t tgid, pid_t tid, jobject linuxTeleProcess, jobject threadList, TLAIndex tlaIndex, RegisterSnapshot snapshot) {
 
-    isa_CanonicalIntegerRegistersStruct canonicalIntegerRegisters;
-    isa_CanonicalStateRegistersStruct canonicalStateRegisters;
+    RegisterSnapshotStruct registers;
+    if (snapshot == NULL) {
+        snapshot = &registers;
+    }
+    snapshot->tid = tid;
+    snapshot->valid = false;
 
     char taskState = task_state(tgid, tid);
 
     TLA tla = 0;
-    if (taskState == 'T' && task_read_registers(tid, &canonicalIntegerRegisters, &canonicalStateRegisters, NULL)) {
+    if (taskState == 'T' && task_read_registers(tid, &snapshot->integerRegisters, &snapshot->stateRegisters, &snapshot->floatingPointRegisters)) {
+        snapshot->valid = true;
 #ifdef __arm__
-        Address stackPointer = (Address) canonicalIntegerRegisters.r13;
+        Address stackPointer = (Address) snapshot->integerRegisters.r13;
 #elif defined __aarch64__
-        Address stackPointer = (Address) canonicalStateRegisters.sp;
+        Address stackPointer = (Address) snapshot->stateRegisters.sp;
 #elif defined(__riscv64__) || defined(riscv64) || defined(RISCV64)
-        Address stackPointer = (Address) canonicalStateRegisters.sp;
+        Address stackPointer = (Address) snapshot->stateRegisters.sp;
 #else
-        Address stackPointer = (Address) canonicalIntegerRegisters.rsp;
+        Address stackPointer = (Address) snapshot->integerRegisters.rsp;
 #endif
         TLA threadLocals = (TLA) alloca(tlaSize());
         NativeThreadLocalsStruct nativeThreadLocalsStruct;
-        ProcessHandleStruct ph = {tgid, tid};
-        tla = teleProcess_findTLA(&ph, tlaList, stackPointer, threadLocals, &nativeThreadLocalsStruct);
+        tla = teleProcess_findIndexedTLA(tlaIndex, stackPointer, threadLocals, &nativeThreadLocalsStruct);
     }
-    teleProcess_jniGatherThread(env, linuxTeleProcess, threadList, tid, toThreadState(taskState, tid), (jlong) canonicalStateRegisters.rip, tla);
+    ThreadState_t threadState = toThreadState(taskState, tid);
+    if (taskState == 'T' && watchpoint_check_task(tgid, tid)) {
+        threadState = TS_WATCHPOINT;
+    }
+    teleProcess_jniGatherThread(env, linuxTeleProcess, threadList, tid, threadState, (jlong) snapshot->stateRegisters.rip, tla);
 }
 
 JNIEXPORT void JNICALL
-Java_com_sun_max_tele_debug_linux_LinuxNativeTeleChannelProtocol_nativeGatherThreads(JNIEnv *env, jclass c, jlong pid, jobject linuxTeleProcess, jobject threads, long tlaList) {
+Java_com_sun_max_tele_debug_linux_LinuxNativeTeleChannelProtocol_nativeRegisterSnapshotLayout(JNIEnv *env, jclass c, jintArray layout) {
+    jint values[] = {
+        sizeof(RegisterSnapshotStruct),
+        offsetof(RegisterSnapshotStruct, tid),
+        offsetof(RegisterSnapshotStruct, valid),
+        offsetof(RegisterSnapshotStruct, integerRegisters),
+        offsetof(RegisterSnapshotStruct, floatingPointRegisters),
+        offsetof(RegisterSnapshotStruct, stateRegisters)
+    };
+    (*env)->SetIntArrayRegion(env, layout, 0, sizeof(values) / sizeof(values[0]), values);
+}
+
+JNIEXPORT jint JNICALL
+Java_com_sun_max_tele_debug_linux_LinuxNativeTeleChannelProtocol_nativeGatherThreads(JNIEnv *env, jclass c, jlong pid, jobject linuxTeleProcess, jobject threads, long tlaList, jobject registers) {
 
     pid_t *tasks;
-    const int nTasks = scan_process_tasks(pid, &tasks);
+    const int nTasks = process_tasks(pid, &tasks);
     if (nTasks < 0) {
-        log_println("Error scanning /proc/%d/task directory: %s", pid, strerror(errno));
-        return;
+        return -1;
+    }
+
+    RegisterSnapshot snapshots = NULL;
+    int nSnapshots = 0;
+    if (registers != NULL) {
+        snapshots = (RegisterSnapshot) (*env)->GetDirectBufferAddress(env, registers);
+        if (snapshots != NULL) {
+            nSnapshots = (*env)->GetDirectBufferCapacity(env, registers) / sizeof(RegisterSnapshotStruct);
+        }
     }
 
+    ProcessHandleStruct ph = {pid, pid};
+    TLAIndex tlaIndex = teleProcess_indexTLAs(&ph, tlaList);
     int n = 0;
     while (n < nTasks) {
         pid_t tid = tasks[n];
-        gatherThread(env, pid, tid, linuxTeleProcess, threads, tlaList);
+        gatherThread(env, pid, tid, linuxTeleProcess, threads, tlaIndex, n < nSnapshots ? &snapshots[n] : NULL);
         n++;
     }
+    teleProcess_freeTLAIndex(tlaIndex);
     free(tasks);
+    return nTasks;
 }
@@ -0,0 +1,394 @@
+/*
+ * Copyright (c) 2017-2018, APT Group, School of Computer Science,
+ * The University of Manchester. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/**
+ * Hardware watchpoints for a ptraced Linux process.
+ *
+ * On AMD64 each watched word occupies one of the four debug address registers DR0-DR3 and is
+ * enabled in DR7. The debug registers are per task and are not inherited by new threads, so they
+ * are written to every task of the process when a watchpoint changes and to each new task when
+ * it is attached. A task stopped by a watchpoint has the bit of the triggering register set in DR6.
+ */
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <dirent.h>
+#include <sys/user.h>
+
+#include "jni.h"
+#include "log.h"
+#include "isa.h"
+#include "ptrace.h"
+#include "threadLocals.h"
+#include "teleProcess.h"
+#include "linuxTask.h"
+#include "linuxWatchpoint.h"
+
+#if isa_AMD64
+
+#define SLOT_COUNT 4
+
+/* The DR7 condition encodings. */
+#define CONDITION_EXEC 0
+#define CONDITION_WRITE 1
+#define CONDITION_READ_WRITE 3
+
+/* The resume flag in RFLAGS, which suppresses an exec breakpoint for one instruction. */
+#define RFLAGS_RF (1 << 16)
+
+typedef struct {
+    boolean active;
+    /* The watchpoint that this slot is part of. */
+    Address watchpointAddress;
+    Size watchpointSize;
+    boolean read;
+    boolean write;
+    boolean exec;
+    /* The naturally aligned word watched by this slot. */
+    Address address;
+    int length;
+    int condition;
+    /* The value of the watched word when it was last armed, used to tell a read from a write. */
+    Word value;
+} WatchpointSlotStruct, *WatchpointSlot;
+
+static WatchpointSlotStruct _slots[SLOT_COUNT];
+
+static pid_t _triggeredTgid = 0;
+static pid_t _triggeredTid = 0;
+static int _triggeredSlot = -1;
+
+#define DEBUG_REGISTER_OFFSET(n) (offsetof(struct user, u_debugreg) + (n) * sizeof(Address))
+
+static Address dr7(void) {
+    Address result = 0;
+    int i;
+    for (i = 0; i < SLOT_COUNT; i++) {
+        WatchpointSlot slot = &_slots[i];
+        if (slot->active) {
+            int length;
+            switch (slot->length) {
+                case 2: length = 1; break;
+                case 4: length = 3; break;
+                case 8: length = 2; break;
+                default: length = 0; break;
+            }
+            result |= ((Address) 1) << (2 * i);
+            result |= ((Address) slot->condition) << (16 + 4 * i);
+            result |= ((Address) length) << (18 + 4 * i);
+        }
+    }
+    return result;
+}
+
+/**
+ * Writes the debug registers of a task from the current slots.
+ */
+static boolean program_task(pid_t tid) {
+    /* Disable all slots first so that the kernel does not validate a new address against an old length. */
+    if (ptrace(PT_WRITE_U, tid, DEBUG_REGISTER_OFFSET(7), 0) != 0) {
+        log_println("Could not clear DR7 of task %d: %s", tid, strerror(errno));
+        return false;
+    }
+    int i;
+    for (i = 0; i < SLOT_COUNT; i++) {
+        if (_slots[i].active && ptrace(PT_WRITE_U, tid, DEBUG_REGISTER_OFFSET(i), _slots[i].address) != 0) {
+            log_println("Could not write DR%d of task %d: %s", i, tid, strerror(errno));
+            return false;
+        }
+    }
+    Address control = dr7();
+    if (control != 0 && ptrace(PT_WRITE_U, tid, DEBUG_REGISTER_OFFSET(7), control) != 0) {
+        log_println("Could not write DR7 of task %d: %s", tid, strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+static boolean program_process(pid_t tgid) {
+    pid_t *tasks;
+    const int nTasks = process_tasks(tgid, &tasks);
+    if (nTasks < 0) {
+        return false;
+    }
+    boolean result = true;
+    int n;
+    for (n = 0; n < nTasks; n++) {
+        if (!program_task(tasks[n])) {
+            result = false;
+        }
+    }
+    free(tasks);
+    return result;
+}
+
+static Word read_watched_word(pid_t tgid, WatchpointSlot slot) {
+    Word value = 0;
+    task_read(tgid, tgid, (const void *) slot->address, &value, slot->length);
+    return value;
+}
+
+int watchpoint_slot_count(void) {
+    return SLOT_COUNT;
+}
+
+boolean watchpoint_activate(pid_t tgid, Address address, Size size, boolean after, boolean read, boolean write, boolean exec) {
+    if (size == 0 || (!exec && !after) || (!read && !write && !exec)) {
+        return false;
+    }
+
+    /* Cover the range with naturally aligned words of up to 8 bytes. */
+    Address words[SLOT_COUNT];
+    int lengths[SLOT_COUNT];
+    int nWords = 0;
+    if (exec) {
+        words[nWords] = address;
+        lengths[nWords++] = 1;
+    }
+    if (read || write) {
+        Address end = address + size;
+        Address a = address;
+        while (a < end) {
+            int length = 8;
+            while (length > 1 && ((a & (length - 1)) != 0 || a + length > end)) {
+                length >>= 1;
+            }
+            if (nWords == SLOT_COUNT) {
+                log_println("Watchpoint at %p of %lu bytes needs more than %d debug registers", address, size, SLOT_COUNT);
+                return false;
+            }
+            words[nWords] = a;
+            lengths[nWords++] = length;
+            a += length;
+        }
+    }
+
+    int freeSlots[SLOT_COUNT];
+    int nFree = 0;
+    int i;
+    for (i = 0; i < SLOT_COUNT; i++) {
+        if (!_slots[i].active) {
+            freeSlots[nFree++] = i;
+        }
+    }
+    if (nFree < nWords) {
+        log_println("Watchpoint at %p of %lu bytes needs %d debug registers but only %d are free", address, size, nWords, nFree);
+        return false;
+    }
+
+    for (i = 0; i < nWords; i++) {
+        WatchpointSlot slot = &_slots[freeSlots[i]];
+        slot->active = true;
+        slot->watchpointAddress = address;
+        slot->watchpointSize = size;
+        slot->read = read;
+        slot->write = write;
+        slot->exec = exec && i == 0;
+        slot->address = words[i];
+        slot->length = lengths[i];
+        slot->condition = slot->exec ? CONDITION_EXEC : (read ? CONDITION_READ_WRITE : CONDITION_WRITE);
+        slot->value = slot->exec ? 0 : read_watched_word(tgid, slot);
+    }
+    if (!program_process(tgid)) {
+        for (i = 0; i < nWords; i++) {
+            _slots[freeSlots[i]].active = false;
+        }
+        program_process(tgid);
+        return false;
+    }
+    return true;
+}
+
+boolean watchpoint_deactivate(pid_t tgid, Address address, Size size) {
+    boolean found = false;
+    int i;
+    for (i = 0; i < SLOT_COUNT; i++) {
+        WatchpointSlot slot = &_slots[i];
+        if (slot->active && slot->watchpointAddress == address && slot->watchpointSize == size) {
+            slot->active = false;
+            found = true;
+        }
+    }
+    if (!found) {
+        return false;
+    }
+    return program_process(tgid);
+}
+
+void watchpoint_attach_task(pid_t tid) {
+    int i;
+    for (i = 0; i < SLOT_COUNT; i++) {
+        if (_slots[i].active) {
+            program_task(tid);
+            return;
+        }
+    }
+}
+
+boolean watchpoint_check_task(pid_t tgid, pid_t tid) {
+    int activeMask = 0;
+    int i;
+    for (i = 0; i < SLOT_COUNT; i++) {
+        if (_slots[i].active) {
+            activeMask |= 1 << i;
+        }
+    }
+    if (activeMask == 0) {
+        return false;
+    }
+    errno = 0;
+    Address status = ptrace(PT_READ_U, tid, DEBUG_REGISTER_OFFSET(6), NULL);
+    if (errno != 0) {
+        return false;
+    }
+    int hits = (int) status & activeMask;
+    if (hits == 0) {
+        return false;
+    }
+    /* DR6 is sticky, so it is cleared for the next stop. */
+    ptrace(PT_WRITE_U, tid, DEBUG_REGISTER_OFFSET(6), 0);
+    if (_triggeredSlot < 0) {
+        _triggeredTgid = tgid;
+        _triggeredTid = tid;
+        for (i = 0; (hits & (1 << i)) == 0; i++) {
+        }
+        _triggeredSlot = i;
+    }
+    return true;
+}
+
+Address watchpoint_triggered_address(void) {
+    if (_triggeredSlot < 0) {
+        return 0;
+    }
+    return _slots[_triggeredSlot].address;
+}
+
+int watchpoint_triggered_code(void) {
+    if (_triggeredSlot < 0) {
+        return 0;
+    }
+    WatchpointSlot slot = &_slots[_triggeredSlot];
+    if (slot->exec) {
+        return WATCHPOINT_EXEC_CODE;
+    }
+    if (!slot->read) {
+        return WATCHPOINT_WRITE_CODE;
+    }
+    /* A read/write debug register does not say which access it caught, so compare the watched word with its last value. */
+    Word value = read_watched_word(_triggeredTgid, slot);
+    if (value != slot->value) {
+        return WATCHPOINT_WRITE_CODE;
+    }
+    return WATCHPOINT_READ_CODE;
+}
+
+void watchpoint_prepare_resume(void) {
+    if (_triggeredSlot < 0) {
+        return;
+    }
+    WatchpointSlot slot = &_slots[_triggeredSlot];
+    if (slot->active) {
+        if (slot->exec) {
+            /* Step over the instruction that triggered the exec watchpoint instead of trapping on it again. */
+            size_t offset = offsetof(struct user, regs) + offsetof(struct user_regs_struct, eflags);
+            errno = 0;
+            Address rflags = ptrace(PT_READ_U, _triggeredTid, offset, NULL);
+            if (errno == 0) {
+                ptrace(PT_WRITE_U, _triggeredTid, offset, rflags | RFLAGS_RF);
+            }
+        } else {
+            slot->value = read_watched_word(_triggeredTgid, slot);
+        }
+    }
+    _triggeredSlot = -1;
+    _triggeredTgid = 0;
+    _triggeredTid = 0;
+}
+
+void watchpoint_reset(void) {
+    memset(_slots, 0, sizeof(_slots));
+    _triggeredSlot = -1;
+    _triggeredTgid = 0;
+    _triggeredTid = 0;
+}
+
+#else
+
+int watchpoint_slot_count(void) {
+    return 0;
+}
+
+boolean watchpoint_activate(pid_t tgid, Address address, Size size, boolean after, boolean read, boolean write, boolean exec) {
+    return false;
+}
+
+boolean watchpoint_deactivate(pid_t tgid, Address address, Size size) {
+    return false;
+}
+
+void watchpoint_attach_task(pid_t tid) {
+}
+
+boolean watchpoint_check_task(pid_t tgid, pid_t tid) {
+    return false;
+}
+
+Address watchpoint_triggered_address(void) {
+    return 0;
+}
+
+int watchpoint_triggered_code(void) {
+    return 0;
+}
+
+void watchpoint_prepare_resume(void) {
+}
+
+void watchpoint_reset(void) {
+}
+
+#endif
+
+JNIEXPORT jint JNICALL
+Java_com_sun_max_tele_debug_linux_LinuxTask_nativeWatchpointCount(JNIEnv *env, jclass c) {
+    return watchpoint_slot_count();
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_sun_max_tele_debug_linux_LinuxTask_nativeActivateWatchpoint(JNIEnv *env, jclass c, jint tgid, jlong address, jlong size, jboolean after, jboolean read, jboolean write, jboolean exec) {
+    return watchpoint_activate(tgid, (Address) address, (Size) size, after, read, write, exec);
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_sun_max_tele_debug_linux_LinuxTask_nativeDeactivateWatchpoint(JNIEnv *env, jclass c, jint tgid, jlong address, jlong size) {
+    return watchpoint_deactivate(tgid, (Address) address, (Size) size);
+}
+
+JNIEXPORT jlong JNICALL
+Java_com_sun_max_tele_debug_linux_LinuxTask_nativeReadWatchpointAddress(JNIEnv *env, jclass c) {
+    return watchpoint_triggered_address();
+}
+
+JNIEXPORT jint JNICALL
+Java_com_sun_max_tele_debug_linux_LinuxTask_nativeReadWatchpointAccessCode(JNIEnv *env, jclass c) {
+    return watchpoint_triggered_code();
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2017-2018, APT Group, School of Computer Science,
+ * The University of Manchester. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * Hardware watchpoints for a ptraced Linux process, implemented with the debug registers of each task.
+ */
+#ifndef __linuxWatchpoint_h__
+#define __linuxWatchpoint_h__ 1
+
+#include <sys/types.h>
+
+#include "word.h"
+
+/* The access codes reported for a triggered watchpoint. These are the values of the Solaris
+ * TRAP_RWATCH, TRAP_WWATCH and TRAP_XWATCH signal codes expected by UnixTeleProcessAdaptor. */
+#define WATCHPOINT_READ_CODE 3
+#define WATCHPOINT_WRITE_CODE 4
+#define WATCHPOINT_EXEC_CODE 5
+
+/**
+ * Gets the number of hardware watchpoints available, which is 0 if they are not supported on this platform.
+ */
+int watchpoint_slot_count(void);
+
+/**
+ * Activates a watchpoint on the memory range ['address' .. 'address' + 'size') in all the tasks of 'tgid'.
+ * A data watchpoint is split over as many debug registers as are needed to cover the range with
+ * naturally aligned words and is only supported with 'after' semantics, as data breakpoints trap
+ * after the access. An exec watchpoint traps before the instruction at 'address' executes.
+ *
+ * @return true if the watchpoint was activated, false if there are not enough free debug registers
+ *         or the tasks could not be updated
+ */
+boolean watchpoint_activate(pid_t tgid, Address address, Size size, boolean after, boolean read, boolean write, boolean exec);
+
+/**
+ * Deactivates the watchpoint previously activated on ['address' .. 'address' + 'size') in all the tasks of 'tgid'.
+ */
+boolean watchpoint_deactivate(pid_t tgid, Address address, Size size);
+
+/**
+ * Programs the debug registers of a task that has just been attached to with the active watchpoints.
+ */
+void watchpoint_attach_task(pid_t tid);
+
+/**
+ * Determines if a stopped task was stopped by a watchpoint. If so, the triggering watchpoint
+ * is recorded for watchpoint_triggered_address() and watchpoint_triggered_code().
+ */
+boolean watchpoint_check_task(pid_t tgid, pid_t tid);
+
+/**
+ * Gets the address of the watched word that triggered the last watchpoint stop, or 0 if there is no such stop.
+ */
+Address watchpoint_triggered_address(void);
+
+/**
+ * Gets the access code of the last watchpoint stop, or 0 if there is no such stop.
+ */
+int watchpoint_triggered_code(void);
+
+/**
+ * Prepares the task that triggered the last watchpoint stop (if any) to be resumed. This must be
+ * called before the process is resumed or single stepped.
+ */
+void watchpoint_prepare_resume(void);
+
+/**
+ * Forgets all watchpoints. This is called when the traced process is created, detached or killed.
+ */
+void watchpoint_reset(void);
+
+#endif
@@ -55,6 +55,7 @@ static const char* requestToString(int request, char *unknownRequestNameBuf, int
         case PT_GETEVENTMSG: return "GETEVENTMSG";;
         case PT_GETSIGINFO: return "GETSIGINFO";;
         case PT_SETSIGINFO: return "SETSIGINFO";;
+        case PT_GETREGSET: return "GETREGSET";;
     }
     snprintf(unknownRequestNameBuf, unknownRequestNameBufLength, "<unknown:%d>", request);
     return unknownRequestNameBuf;
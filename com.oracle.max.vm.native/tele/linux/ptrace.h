@@ -56,6 +56,11 @@
 #define PT_GETEVENTMSG 0x4201
 #define PT_GETSIGINFO  0x4202
 #define PT_SETSIGINFO  0x4203
+#define PT_GETREGSET   0x4204
+
+/* The register sets read with PT_GETREGSET, named by the type of the core file note that holds them. */
+#define PT_NT_PRSTATUS  1   /* general purpose registers */
+#define PT_NT_PRFPREG   2   /* floating point registers */
 
 #define PTRACE_O_TRACESYSGOOD   0x00000001
 #define PTRACE_O_TRACEFORK      0x00000002
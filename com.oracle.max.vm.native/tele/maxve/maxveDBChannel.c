@@ -31,6 +31,7 @@
 #include "threadLocals.h"
 #include "teleProcess.h"
 #include "teleNativeThread.h"
+#include "pageCache.h"
 
 extern void gather_and_trace_threads(void);
 
@@ -46,6 +47,7 @@ static struct maxve_memory_handler db_memory_handler = {
 
 JNIEXPORT jboolean JNICALL
 Java_com_sun_max_tele_debug_maxve_MaxVEDBNativeTeleChannelProtocol_nativeAttach(JNIEnv *env, jclass c, jint domainId, jlong extra1) {
+    pageCache_invalidate();
     // The agent can handle multiple connections serially, so we must re-initialize the static state
     terminated = 0;
     threads_at_rest = NULL;
@@ -57,6 +59,7 @@ Java_com_sun_max_tele_debug_maxve_MaxVEDBNativeTeleChannelProtocol_nativeAttach(
 
 JNIEXPORT jboolean JNICALL
 Java_com_sun_max_tele_debug_maxve_MaxVEDBNativeTeleChannelProtocol_nativeDetach(JNIEnv *env, jclass c) {
+    pageCache_invalidate();
     tele_log_println("Calling do_detach");
     return db_detach();
 }
@@ -85,6 +88,7 @@ Java_com_sun_max_tele_debug_maxve_MaxVEDBNativeTeleChannelProtocol_nativeSuspend
 
 JNIEXPORT jboolean JNICALL
 Java_com_sun_max_tele_debug_maxve_MaxVEDBNativeTeleChannelProtocol_nativeSingleStep(JNIEnv *env, jclass c, jint threadId) {
+    pageCache_invalidate();
     int rc = db_single_step(threadId);
     return rc == 0;
 }
@@ -163,15 +167,17 @@ Java_com_sun_max_tele_debug_maxve_MaxVEDBNativeTeleChannelProtocol_nativeGatherT
     int num_threads;
 
     threads = db_gather_threads(&num_threads);
+    TLAIndex tlaIndex = teleProcess_indexTLAs(&db_memory_handler, tlaList);
     int i;
     for (i=0; i<num_threads; i++) {
         tele_log_println("nativeGatherThreads processing thread %d,", threads[i].id);
         TLA threadLocals = (TLA) alloca(tlaSize());
         NativeThreadLocalsStruct nativeThreadLocalsStruct;
         struct db_regs *db_regs = checked_get_regs("nativeGatherThreads", threads[i].id);
-        threadLocals = teleProcess_findTLA(&db_memory_handler, tlaList, db_regs->rsp, threadLocals, &nativeThreadLocalsStruct);
+        threadLocals = teleProcess_findIndexedTLA(tlaIndex, db_regs->rsp, threadLocals, &nativeThreadLocalsStruct);
         teleProcess_jniGatherThread(env, teleDomain, threadList, (jlong) threads[i].id, toThreadState(threads[i].flags), db_regs->rip, threadLocals);
     }
+    teleProcess_freeTLAIndex(tlaIndex);
     free(threads);
 
     return 0;
@@ -212,6 +218,7 @@ void gather_and_trace_threads(void) {
 
 JNIEXPORT jboolean JNICALL
 Java_com_sun_max_tele_debug_maxve_MaxVEDBNativeTeleChannelProtocol_nativeResume(JNIEnv *env, jobject domain) {
+    pageCache_invalidate();
     unsigned long sleep_time = 0;
     struct db_thread *threads;
     int num_threads, i;
@@ -279,6 +286,11 @@ Java_com_sun_max_tele_debug_maxve_MaxVEDBNativeTeleChannelProtocol_nativeReadByt
     return teleProcess_read(&db_memory_handler, env, c, src, dst, isDirectByteBuffer, dstOffset, length);
 }
 
+JNIEXPORT jint JNICALL
+Java_com_sun_max_tele_debug_maxve_MaxVEDBNativeTeleChannelProtocol_nativeReadBytesBatch(JNIEnv *env, jclass c, jlongArray descriptors, jint count, jobject dst) {
+    return teleProcess_readBatch(&db_memory_handler, env, c, descriptors, count, dst);
+}
+
 JNIEXPORT jint JNICALL
 Java_com_sun_max_tele_debug_maxve_MaxVEDBNativeTeleChannelProtocol_nativeWriteBytes(JNIEnv *env, jclass c, jlong dst, jobject src, jboolean isDirectByteBuffer, jint srcOffset, jint length) {
     return teleProcess_write(&db_memory_handler, env, c, dst, src, isDirectByteBuffer, srcOffset, length);
@@ -31,6 +31,7 @@
 #include "threadLocals.h"
 #include "teleProcess.h"
 #include "teleNativeThread.h"
+#include "pageCache.h"
 
 /*
  * Size and member offsets of the native GUK thread struct.
@@ -100,9 +101,46 @@ static int tele_xg_writebytes(uint64_t src, char *buf, unsigned short size) {
     return size - result;
 }
 
+/*
+ * The largest transfer done with one gdbsx memory hypercall. Larger transfers are split into chunks
+ * of this size, which bounds the time spent in the hypervisor per call and the amount of the local
+ * buffer that has to be locked for it. The hypercalls are serialized by Xen's domctl lock, so there
+ * is nothing to gain from having several chunks in flight.
+ */
+#define XG_MAX_TRANSFER_SIZE (1024 * 1024)
+
+/* The largest buffer the Inspector may pass in one call. */
+#define XG_MAX_BYTE_BUFFER_SIZE (64 * 1024 * 1024)
+
+static int tele_xg_transfer(uint64_t address, char *buf, size_t size, boolean write) {
+    size_t done = 0;
+    while (done < size) {
+        int chunk = size - done > XG_MAX_TRANSFER_SIZE ? XG_MAX_TRANSFER_SIZE : (int) (size - done);
+        int remain = write ? xg_write_mem(address + done, buf + done, chunk, 0) : xg_read_mem(address + done, buf + done, chunk, 0);
+        if (remain < 0) {
+            break;
+        }
+        done += chunk - remain;
+        if (remain != 0) {
+            break;
+        }
+    }
+    return (int) done;
+}
+
+static int tele_xg_readlarge(uint64_t src, char *buf, size_t size) {
+    return tele_xg_transfer(src, buf, size, false);
+}
+
+static int tele_xg_writelarge(uint64_t dst, char *buf, size_t size) {
+    return tele_xg_transfer(dst, buf, size, true);
+}
+
 static struct maxve_memory_handler xg_memory_handler = {
                 .readbytes = &tele_xg_readbytes,
-                .writebytes = &tele_xg_writebytes
+                .writebytes = &tele_xg_writebytes,
+                .readlarge = &tele_xg_readlarge,
+                .writelarge = &tele_xg_writelarge
 };
 
 
@@ -116,6 +154,7 @@ Java_com_sun_max_tele_debug_maxve_MaxVEXGNativeTeleChannelProtocol_nativeInit(JN
 
 JNIEXPORT jboolean JNICALL
 Java_com_sun_max_tele_debug_maxve_MaxVEXGNativeTeleChannelProtocol_nativeAttach(JNIEnv *env, jclass c, jint domainId, jlong extra1) {
+    pageCache_invalidate();
     thread_list_address = extra1;
     debug_println("Calling xg_attach on domId=%d, thread_list_addr %lx", domainId, extra1);
     return xg_attach(domainId);
@@ -216,20 +255,23 @@ static struct tele_xg_thread *get_thread(int id) {
 JNIEXPORT jboolean JNICALL
 Java_com_sun_max_tele_debug_guestvm_GuestVMXGNativeTeleChannelProtocol_nativeGatherThreads(JNIEnv *env, jclass c, jobject teleDomain, jobject threadList, jlong tlaList) {
     tele_xg_gather_threads();
+    TLAIndex tlaIndex = teleProcess_indexTLAs(&xg_memory_handler, tlaList);
     struct tele_xg_thread *tcb = tele_xg_thread_list;
     while (tcb != NULL) {
             debug_println("nativeGatherThreads processing thread %d,", tcb->id);
             TLA threadLocals = (TLA) alloca(tlaSize());
             NativeThreadLocalsStruct nativeThreadLocalsStruct;
-            threadLocals = teleProcess_findTLA(&xg_memory_handler, tlaList, tcb->regs.u.xregs_64.rsp, threadLocals, &nativeThreadLocalsStruct);
+            threadLocals = teleProcess_findIndexedTLA(tlaIndex, tcb->regs.u.xregs_64.rsp, threadLocals, &nativeThreadLocalsStruct);
             teleProcess_jniGatherThread(env, teleDomain, threadList, (jlong) tcb->id, toThreadState(tcb->flags), tcb->regs.u.xregs_64.rip, threadLocals);
             tcb = tcb->next;
     }
+    teleProcess_freeTLAIndex(tlaIndex);
     return 0;
 }
 
 JNIEXPORT jboolean JNICALL
 Java_com_sun_max_tele_debug_maxve_MaxVEXGNativeTeleChannelProtocol_nativeResume(JNIEnv *env, jobject domain) {
+    pageCache_invalidate();
     debug_println("Calling xg_resume_n_wait");
     resume_vcpu = xg_resume_n_wait(64);
     debug_println("xg_resume_n_wait returned %d", resume_vcpu);
@@ -243,14 +285,26 @@ Java_com_sun_max_tele_debug_maxve_MaxVEXGNativeTeleChannelProtocol_nativeReadByt
 }
 
 
+JNIEXPORT jint JNICALL
+Java_com_sun_max_tele_debug_maxve_MaxVEXGNativeTeleChannelProtocol_nativeReadBytesBatch(JNIEnv *env, jclass c, jlongArray descriptors, jint count, jobject dst) {
+    return teleProcess_readBatch(&xg_memory_handler, env, c, descriptors, count, dst);
+}
+
+
 JNIEXPORT jint JNICALL
 Java_com_sun_max_tele_debug_maxve_MaxVEXGNativeTeleChannelProtocol_nativeWriteBytes(JNIEnv *env, jclass c, jlong dst, jobject src, jboolean isDirectByteBuffer, jint srcOffset, jint length) {
     return teleProcess_write(&xg_memory_handler, env, c, dst, src, isDirectByteBuffer, srcOffset, length);
 }
 
+JNIEXPORT jint JNICALL
+Java_com_sun_max_tele_debug_maxve_MaxVEXGNativeTeleChannelProtocol_nativeMaxByteBufferSize(JNIEnv *env, jclass c) {
+    return XG_MAX_BYTE_BUFFER_SIZE;
+}
+
 
 JNIEXPORT jboolean JNICALL
 Java_com_sun_max_tele_debug_maxve_MaxVEXGNativeTeleChannelProtocol_nativeSingleStep(JNIEnv *env, jclass c, jint threadId) {
+    pageCache_invalidate();
     debug_println("nativeSingleStep %d", threadId);
     struct tele_xg_thread *tcb = get_thread(threadId);
     int rc = xg_step(tcb->cpu, 64);
@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) 2011, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ */
+#include <string.h>
+#include <stdlib.h>
+
+#include "c.h"
+#include "log.h"
+#include "jni.h"
+#include "mutex.h"
+#include "pageCache.h"
+
+/* The unit of caching. Mappings in the tele process are aligned to at least this size, so a
+ * cached page is either readable as a whole or not at all. */
+#define CACHE_PAGE_SIZE 4096
+
+/* The number of pages in the (direct mapped) cache, which must be a power of 2. */
+#define CACHE_PAGES 1024
+
+/* Reads larger than this bypass the cache so that bulk transfers do not evict the small objects,
+ * thread locals and stack frames that are read repeatedly in one stop. */
+#define CACHE_MAX_READ (16 * CACHE_PAGE_SIZE)
+
+typedef struct {
+    Address page;
+    Unsigned8 epoch;
+    char data[CACHE_PAGE_SIZE];
+} CachedPageStruct, *CachedPage;
+
+static CachedPage _pages;
+
+/* The current stop epoch. A page whose epoch differs from it is invalid. */
+static Unsigned8 _epoch = 1;
+
+static mutex_Struct _lock;
+
+void pageCache_initialize(void) {
+    mutex_initialize(&_lock);
+    _pages = (CachedPage) calloc(CACHE_PAGES, sizeof(CachedPageStruct));
+    if (_pages == NULL) {
+        log_println("Could not allocate the tele page cache, memory will be read uncached");
+    }
+}
+
+static inline CachedPage slot(Address page) {
+    return &_pages[(page / CACHE_PAGE_SIZE) & (CACHE_PAGES - 1)];
+}
+
+/**
+ * Gets the cached copy of a page, reading it from the tele process if it is not cached.
+ *
+ * @return the cached page or NULL if the page cannot be read as a whole
+ */
+static CachedPage lookup(ProcessHandle ph, Address page) {
+    CachedPage entry = slot(page);
+    if (entry->page == page && entry->epoch == _epoch) {
+        return entry;
+    }
+    entry->epoch = 0;
+    int bytesRead = readProcessMemory(ph, page, entry->data, CACHE_PAGE_SIZE);
+    if (bytesRead != CACHE_PAGE_SIZE) {
+        return NULL;
+    }
+    entry->page = page;
+    entry->epoch = _epoch;
+    return entry;
+}
+
+int pageCache_read(ProcessHandle ph, Address src, void *dst, size_t size) {
+    if (_pages == NULL || size > CACHE_MAX_READ) {
+        return readProcessMemory(ph, src, dst, size);
+    }
+    mutex_enter(&_lock);
+    size_t done = 0;
+    while (done < size) {
+        Address address = src + done;
+        Address page = address & ~((Address) CACHE_PAGE_SIZE - 1);
+        size_t offset = address - page;
+        size_t n = CACHE_PAGE_SIZE - offset;
+        if (n > size - done) {
+            n = size - done;
+        }
+        CachedPage entry = lookup(ph, page);
+        if (entry == NULL) {
+            /* Let the platform read (and report on) what it can of the rest. */
+            int bytesRead = readProcessMemory(ph, address, (char *) dst + done, size - done);
+            mutex_exit(&_lock);
+            if (bytesRead < 0) {
+                return done > 0 ? (int) done : bytesRead;
+            }
+            return (int) done + bytesRead;
+        }
+        memcpy((char *) dst + done, entry->data + offset, n);
+        done += n;
+    }
+    mutex_exit(&_lock);
+    return (int) done;
+}
+
+/**
+ * Copies 'length' bytes written to 'dst' in the tele process into the cached pages they overlap.
+ * The caller must hold _lock.
+ */
+static void update(Address dst, const void *src, size_t length) {
+    Address end = dst + length;
+    Address page = dst & ~((Address) CACHE_PAGE_SIZE - 1);
+    for (; page < end; page += CACHE_PAGE_SIZE) {
+        CachedPage entry = slot(page);
+        if (entry->page == page && entry->epoch == _epoch) {
+            Address from = dst > page ? dst : page;
+            Address to = end < page + CACHE_PAGE_SIZE ? end : page + CACHE_PAGE_SIZE;
+            memcpy(entry->data + (from - page), (const char *) src + (from - dst), to - from);
+        }
+    }
+}
+
+int pageCache_write(ProcessHandle ph, Address dst, const void *src, size_t length) {
+    int result = writeProcessMemory(ph, dst, src, length);
+    if (_pages == NULL || result <= 0) {
+        return result;
+    }
+    mutex_enter(&_lock);
+    update(dst, src, result);
+    mutex_exit(&_lock);
+    return result;
+}
+
+int pageCache_writeBatch(ProcessHandle ph, const struct iovec *local, const struct iovec *remote, int count) {
+#ifdef writeProcessMemoryVector
+    int result = writeProcessMemoryVector(ph, local, remote, count);
+#else
+    int result = 0;
+    while (result < count) {
+        int length = (int) remote[result].iov_len;
+        if (length > 0) {
+            int bytesWritten = writeProcessMemory(ph, remote[result].iov_base, local[result].iov_base, length);
+            if (bytesWritten != length) {
+                break;
+            }
+        }
+        result++;
+    }
+#endif
+    if (_pages == NULL) {
+        return result;
+    }
+    mutex_enter(&_lock);
+    if (result < count) {
+        /* Some of the ranges after the leading ones may have been written. */
+        _epoch++;
+    } else {
+        int i;
+        for (i = 0; i < count; i++) {
+            update((Address) remote[i].iov_base, local[i].iov_base, remote[i].iov_len);
+        }
+    }
+    mutex_exit(&_lock);
+    return result;
+}
+
+void pageCache_invalidate(void) {
+    if (_pages == NULL) {
+        return;
+    }
+    mutex_enter(&_lock);
+    _epoch++;
+    mutex_exit(&_lock);
+}
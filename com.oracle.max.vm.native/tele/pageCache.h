@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2011, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ */
+#ifndef __pageCache_h__
+#define __pageCache_h__ 1
+
+#include <sys/uio.h>
+
+#include "threadLocals.h"
+#include "teleProcess.h"
+
+/*
+ * A cache of the pages of the tele process read while it is stopped.
+ *
+ * Each cached page is stamped with the stop epoch in which it was read. The epoch is advanced
+ * by pageCache_invalidate() whenever the tele process may change its memory (i.e. when it is
+ * resumed or single-stepped) and when it stops, so a page is only served from the cache for reads
+ * within the stop in which it was read. Writes go through to the tele process and update the
+ * cached copy of the pages they touch. The cache holds the pages of one tele process: it must be
+ * invalidated when a process is created, attached, detached or killed.
+ */
+
+/**
+ * Allocates the cache. This is called when the tele library is loaded.
+ */
+extern void pageCache_initialize(void);
+
+/**
+ * Copies 'size' bytes from 'src' in the tele process to 'dst', from the cache where possible.
+ *
+ * @return the number of bytes copied or -1 if there was an error (as for readProcessMemory)
+ */
+extern int pageCache_read(ProcessHandle ph, Address src, void *dst, size_t size);
+
+/**
+ * Copies 'length' bytes from 'src' to 'dst' in the tele process and updates the cached pages it overlaps.
+ *
+ * @return the number of bytes copied or -1 if there was an error (as for writeProcessMemory)
+ */
+extern int pageCache_write(ProcessHandle ph, Address dst, const void *src, size_t length);
+
+/**
+ * Copies the 'count' ranges described by 'local' to those described by 'remote' in the tele process and updates
+ * the cached pages they overlap.
+ *
+ * @return the number of leading ranges that were copied completely
+ */
+extern int pageCache_writeBatch(ProcessHandle ph, const struct iovec *local, const struct iovec *remote, int count);
+
+/**
+ * Advances the stop epoch, invalidating all cached pages.
+ */
+extern void pageCache_invalidate(void);
+
+#endif /*__pageCache_h__*/
@@ -21,4 +21,4 @@
 # questions.
 #
 
-OS_SOURCES = teleProcess.c solarisTeleNativeThread.c solarisTeleProcess.c proc.c
+OS_SOURCES = teleProcess.c solarisTeleNativeThread.c solarisTeleProcess.c proc.c elfCore.c
@@ -27,6 +27,7 @@
 #include "os.h"
 #include "threadLocals.h"
 #include "solarisTeleProcess.h"
+#include "pageCache.h"
 #include <sys/siginfo.h>
 
 struct ps_lwphandle {
@@ -149,6 +150,7 @@ Java_com_sun_max_tele_channel_natives_TeleChannelNatives_setInstructionPointer(J
 
 JNIEXPORT jboolean JNICALL
 Java_com_sun_max_tele_channel_natives_TeleChannelNatives_singleStep(JNIEnv *env, jobject  this, jlong processHandle, jlong lwpId) {
+    pageCache_invalidate();
     struct ps_prochandle *ph = (struct ps_prochandle *) processHandle;
     INIT_LWP_HANDLE(lh, processHandle, lwpId, false);
 
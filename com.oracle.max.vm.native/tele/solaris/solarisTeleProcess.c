@@ -35,6 +35,7 @@
 #include "teleNativeThread.h"
 #include "threads.h"
 #include "teleProcess.h"
+#include "pageCache.h"
 
 #include <sys/types.h>
 #include <sys/wait.h>
@@ -46,6 +47,18 @@ Java_com_sun_max_tele_channel_natives_TeleChannelNatives_readBytes(JNIEnv *env,
     return teleProcess_read(ph, env, this, src, dst, isDirectByteBuffer, dstOffset, length);
 }
 
+JNIEXPORT jint JNICALL
+Java_com_sun_max_tele_channel_natives_TeleChannelNatives_readBytesBatch(JNIEnv *env, jobject  this, jlong handle, jlongArray descriptors, jint count, jobject dst) {
+    struct ps_prochandle *ph = (struct ps_prochandle *) handle;
+    return teleProcess_readBatch(ph, env, this, descriptors, count, dst);
+}
+
+JNIEXPORT jint JNICALL
+Java_com_sun_max_tele_channel_natives_TeleChannelNatives_writeBytesBatch(JNIEnv *env, jobject  this, jlong handle, jlongArray descriptors, jint count, jobject src) {
+    struct ps_prochandle *ph = (struct ps_prochandle *) handle;
+    return teleProcess_writeBatch(ph, env, this, descriptors, count, src);
+}
+
 JNIEXPORT jint JNICALL
 Java_com_sun_max_tele_channel_natives_TeleChannelNatives_writeBytes(JNIEnv *env, jobject  this, jlong handle, jlong dst, jobject src, jboolean isDirectByteBuffer, jint srcOffset, jint length) {
     struct ps_prochandle *ph = (struct ps_prochandle *) handle;
@@ -54,6 +67,7 @@ Java_com_sun_max_tele_channel_natives_TeleChannelNatives_writeBytes(JNIEnv *env,
 
 JNIEXPORT jlong JNICALL
 Java_com_sun_max_tele_channel_natives_TeleChannelNatives_createChild(JNIEnv *env, jobject  this, jlong commandLineArgumentArray, jint vmAgentPort) {
+    pageCache_invalidate();
     int error;
     char path[MAX_PATH_LENGTH];
     char **argv = (char**) commandLineArgumentArray;
@@ -90,6 +104,7 @@ Java_com_sun_max_tele_channel_natives_TeleChannelNatives_createChild(JNIEnv *env
 
 JNIEXPORT void JNICALL
 Java_com_sun_max_tele_channel_natives_TeleChannelNatives_kill(JNIEnv *env, jobject  this, jlong processHandle) {
+    pageCache_invalidate();
     struct ps_prochandle *ph = (struct ps_prochandle *) processHandle;
     int state = Pstate(ph);
     if (state != PS_LOST && state != PS_DEAD && state != PS_UNDEAD) {
@@ -151,6 +166,7 @@ static int cancelFault(void *data, const lwpstatus_t *ls) {
 
 JNIEXPORT jboolean JNICALL
 Java_com_sun_max_tele_channel_natives_TeleChannelNatives_resume(JNIEnv *env, jobject  this, jlong processHandle) {
+    pageCache_invalidate();
     struct ps_prochandle *ph = (struct ps_prochandle *) processHandle;
 
     int error = Plwp_iter(ph, cancelFault, ph);
@@ -170,7 +186,10 @@ Java_com_sun_max_tele_channel_natives_TeleChannelNatives_resume(JNIEnv *env, job
 JNIEXPORT jint JNICALL
 Java_com_sun_max_tele_channel_natives_TeleChannelNatives_waitUntilStopped(JNIEnv *env, jobject  this, jlong processHandle) {
     struct ps_prochandle *ph = (struct ps_prochandle *) processHandle;
-    if (Pwait(ph, 0) != 0) {
+    int result = Pwait(ph, 0);
+    /* Pages read while the process was running may have changed before it stopped. */
+    pageCache_invalidate();
+    if (result != 0) {
         int error = errno;
         if (error == ENOENT) {
             return PS_TERMINATED;
@@ -203,7 +222,7 @@ typedef struct GatherThreadArgument {
     JNIEnv *env;
     jobject teleProcess;
     jobject threadList;
-    Address tlaList;
+    TLAIndex tlaIndex;
 } *GatherThreadArgument;
 
 static int gatherThread(void *data, const lwpstatus_t *ls) {
@@ -216,7 +235,7 @@ static int gatherThread(void *data, const lwpstatus_t *ls) {
     NativeThreadLocalsStruct nativeThreadLocalsStruct;
     Address stackPointer = ls->pr_reg[R_SP];
     Address instructionPointer = ls->pr_reg[R_PC];
-    TLA tla = teleProcess_findTLA(a->ph, a->tlaList, stackPointer, threadLocals, &nativeThreadLocalsStruct);
+    TLA tla = teleProcess_findIndexedTLA(a->tlaIndex, stackPointer, threadLocals, &nativeThreadLocalsStruct);
     teleProcess_jniGatherThread(a->env, a->teleProcess, a->threadList, lwpId, threadState, instructionPointer, tla);
 
     return 0;
@@ -231,12 +250,13 @@ Java_com_sun_max_tele_channel_natives_TeleChannelNatives_gatherThreads(JNIEnv *e
     a.env = env;
     a.teleProcess = teleProcess;
     a.threadList = threadList;
-    a.tlaList = tlaList;
+    a.tlaIndex = teleProcess_indexTLAs(ph, tlaList);
 
     int error = Plwp_iter(ph, gatherThread, &a);
     if (error != 0) {
         log_println("Error iterating over threads of process");
     }
+    teleProcess_freeTLAIndex(a.tlaIndex);
 }
 
 JNIEXPORT jboolean JNICALL
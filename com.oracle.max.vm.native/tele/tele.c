@@ -27,6 +27,7 @@
 #include "log.h"
 #include "threadLocals.h"
 #include "teleProcess.h"
+#include "pageCache.h"
 
 JNIEXPORT jint JNICALL
 JNI_OnLoad(JavaVM *vm, void *reserved)
@@ -35,6 +36,7 @@ JNI_OnLoad(JavaVM *vm, void *reserved)
 #if !os_MAXVE
     log_initialize(getenv("TELE_LOG_FILE"));
 #endif
+    pageCache_initialize();
     return JNI_VERSION_1_2;
 }
 
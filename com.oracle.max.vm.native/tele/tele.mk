@@ -28,7 +28,7 @@ LIB = tele
 include $(PROJECT)/platform/platform.mk
 include $(PROJECT)/tele/$(OS)/$(OS).mk
 
-SOURCES = $(OS_SOURCES) c.c log.c tele.c mutex.c threadLocals.c threads.c $(ISA).c platform.c relocation.c dataio.c virtualMemory.c
+SOURCES = $(OS_SOURCES) c.c log.c tele.c pageCache.c mutex.c threadLocals.c threads.c $(ISA).c platform.c relocation.c dataio.c virtualMemory.c cgroup.c
 
 SOURCE_DIRS = tele tele/$(OS) platform hosted share substrate
 
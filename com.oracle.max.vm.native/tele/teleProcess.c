@@ -23,12 +23,15 @@
 #include <string.h>
 #include <stdlib.h>
 #include <alloca.h>
+#include <pthread.h>
+#include <sys/uio.h>
 
 #include "c.h"
 #include "log.h"
 #include "jni.h"
 #include "threadLocals.h"
 #include "teleProcess.h"
+#include "pageCache.h"
 
 static jmethodID jniGatherThreadID = NULL;
 
@@ -90,36 +93,163 @@ void teleProcess_jniGatherThread(JNIEnv *env, jobject teleProcess, jobject threa
                     size);
 }
 
-static boolean isTLAForStackPointer(ProcessHandle ph, Address stackPointer, Address tla, TLA tlaCopy, NativeThreadLocals ntlCopy) {
-    Address ntl;
+typedef struct {
+    Address stackBase;
+    Address stackEnd;
+    TLA tla;
+    NativeThreadLocalsStruct ntl;
+} TLAIndexEntryStruct, *TLAIndexEntry;
 
-    readProcessMemory(ph, tla, tlaCopy, tlaSize());
-    ntl = tla_load(Address, tlaCopy, NATIVE_THREAD_LOCALS);
-    readProcessMemory(ph, ntl, ntlCopy, sizeof(NativeThreadLocalsStruct));
-    tla_store(tlaCopy, NATIVE_THREAD_LOCALS, ntlCopy);
+struct TLAIndexStruct {
+    int count;
+    TLAIndexEntry entries;
+    /* Backing storage for the TLA copies of the entries. */
+    char *tlas;
+};
+
+static int compareTLAIndexEntries(const void *a, const void *b) {
+    Address stackBaseA = ((TLAIndexEntry) a)->stackBase;
+    Address stackBaseB = ((TLAIndexEntry) b)->stackBase;
+    return stackBaseA < stackBaseB ? -1 : (stackBaseA > stackBaseB ? 1 : 0);
+}
+
+TLAIndex teleProcess_indexTLAs(ProcessHandle ph, Address tlaList) {
+    TLAIndex index = (TLAIndex) calloc(1, sizeof(struct TLAIndexStruct));
+    if (index == NULL) {
+        log_println("Failed to malloc TLA index");
+        return NULL;
+    }
+    const int size = tlaSize();
+    int capacity = 0;
+    Address tla = tlaList;
+    while (tla != 0) {
+        if (index->count == capacity) {
+            capacity = capacity == 0 ? 64 : capacity * 2;
+            TLAIndexEntry entries = (TLAIndexEntry) realloc(index->entries, capacity * sizeof(TLAIndexEntryStruct));
+            char *tlas = (char *) realloc(index->tlas, capacity * size);
+            if (entries != NULL) {
+                index->entries = entries;
+            }
+            if (tlas != NULL) {
+                index->tlas = tlas;
+            }
+            if (entries == NULL || tlas == NULL) {
+                log_println("Failed to malloc TLA index of %d entries", capacity);
+                break;
+            }
+        }
+        TLAIndexEntry entry = &index->entries[index->count];
+        TLA tlaCopy = (TLA) (index->tlas + index->count * size);
+        memset((void *) tlaCopy, 0, size);
+        memset((void *) &entry->ntl, 0, sizeof(NativeThreadLocalsStruct));
+        readProcessMemory(ph, tla, tlaCopy, size);
+        Address ntl = tla_load(Address, tlaCopy, NATIVE_THREAD_LOCALS);
+        readProcessMemory(ph, ntl, &entry->ntl, sizeof(NativeThreadLocalsStruct));
 #if log_TELE
-    log_print("teleProcess_findTLA(%p): ", stackPointer);
-    tla_println(tlaCopy);
+        log_print("teleProcess_indexTLAs(%p): ", tla);
+        tla_println(tlaCopy);
 #endif
-    Address stackBase = ntlCopy->stackBase;
-    Size stackSize = ntlCopy->stackSize;
-    return stackBase <= stackPointer && stackPointer < (stackBase + stackSize);
+        entry->stackBase = entry->ntl.stackBase;
+        entry->stackEnd = entry->ntl.stackBase + entry->ntl.stackSize;
+        index->count++;
+        tla = tla_load(Address, tlaCopy, FORWARD_LINK);
+    }
+
+    /* The TLA copies move with realloc, so the entries only refer to them once the list has been walked. */
+    int i;
+    for (i = 0; i < index->count; i++) {
+        index->entries[i].tla = (TLA) (index->tlas + i * size);
+    }
+    qsort(index->entries, index->count, sizeof(TLAIndexEntryStruct), compareTLAIndexEntries);
+    return index;
 }
 
-TLA teleProcess_findTLA(ProcessHandle ph, Address tlaList, Address stackPointer, TLA tlaCopy, NativeThreadLocals ntlCopy) {
+TLA teleProcess_findIndexedTLA(TLAIndex index, Address stackPointer, TLA tlaCopy, NativeThreadLocals ntlCopy) {
     memset((void *) tlaCopy, 0, tlaSize());
     memset((void *) ntlCopy, 0, sizeof(NativeThreadLocalsStruct));
+    if (index == NULL) {
+        return 0;
+    }
 
-    if (tlaList != 0) {
-        Address tla = tlaList;
-        while (tla != 0) {
-            if (isTLAForStackPointer(ph, stackPointer, tla, tlaCopy, ntlCopy)) {
-                return tlaCopy;
-            }
-            tla = tla_load(Address, tlaCopy, FORWARD_LINK);
-        };
+    /* Find the entry with the highest stack base that is <= stackPointer. */
+    int low = 0;
+    int high = index->count - 1;
+    TLAIndexEntry entry = NULL;
+    while (low <= high) {
+        int mid = (low + high) >> 1;
+        if (index->entries[mid].stackBase <= stackPointer) {
+            entry = &index->entries[mid];
+            low = mid + 1;
+        } else {
+            high = mid - 1;
+        }
+    }
+    if (entry == NULL || stackPointer >= entry->stackEnd) {
+        return 0;
+    }
+    memcpy((void *) tlaCopy, (void *) entry->tla, tlaSize());
+    *ntlCopy = entry->ntl;
+    tla_store(tlaCopy, NATIVE_THREAD_LOCALS, ntlCopy);
+    return tlaCopy;
+}
+
+void teleProcess_freeTLAIndex(TLAIndex index) {
+    if (index != NULL) {
+        free(index->entries);
+        free(index->tlas);
+        free(index);
+    }
+}
+
+/* Transfers of up to this many bytes between a Java byte array and the tele process are staged
+ * in a buffer that is kept by the calling thread for reuse instead of being allocated per transfer. */
+#define TRANSFER_BUFFER_MAX_SIZE (1024 * 1024)
+
+typedef struct {
+    size_t size;
+    char data[];
+} TransferBufferStruct, *TransferBuffer;
+
+static pthread_key_t transferBufferKey;
+static pthread_once_t transferBufferKeyOnce = PTHREAD_ONCE_INIT;
+
+static void createTransferBufferKey(void) {
+    if (pthread_key_create(&transferBufferKey, free) != 0) {
+        log_exit(11, "Could not create transfer buffer key");
+    }
+}
+
+/**
+ * Gets a buffer of at least 'size' bytes for staging a transfer. The buffer must be released with releaseTransferBuffer().
+ */
+static void *acquireTransferBuffer(size_t size) {
+    if (size > TRANSFER_BUFFER_MAX_SIZE) {
+        return malloc(size);
+    }
+    pthread_once(&transferBufferKeyOnce, createTransferBufferKey);
+    TransferBuffer buffer = (TransferBuffer) pthread_getspecific(transferBufferKey);
+    if (buffer == NULL || buffer->size < size) {
+        size_t bufferSize = buffer == NULL ? 4096 : buffer->size;
+        while (bufferSize < size) {
+            bufferSize *= 2;
+        }
+        free(buffer);
+        buffer = (TransferBuffer) malloc(sizeof(TransferBufferStruct) + bufferSize);
+        if (buffer != NULL) {
+            buffer->size = bufferSize;
+        }
+        pthread_setspecific(transferBufferKey, buffer);
+        if (buffer == NULL) {
+            return NULL;
+        }
+    }
+    return buffer->data;
+}
+
+static void releaseTransferBuffer(void *data, size_t size) {
+    if (size > TRANSFER_BUFFER_MAX_SIZE) {
+        free(data);
     }
-    return 0;
 }
 
 int teleProcess_read(ProcessHandle ph, JNIEnv *env, jclass c, jlong src, jobject dst, jboolean isDirectByteBuffer, jint offset, jint length) {
@@ -136,8 +266,8 @@ int teleProcess_read(ProcessHandle ph, JNIEnv *env, jclass c, jlong src, jobject
         dstBuffer = (jbyte *) dstBuffer + offset;
     } else {
         if (size >  sizeof(Word)) {
-            // More than a word's worth of bytes: allocate a buffer
-            dstBuffer = (void *) malloc(length * sizeof(jbyte));
+            // More than a word's worth of bytes: use a transfer buffer
+            dstBuffer = acquireTransferBuffer(size);
             if (dstBuffer == 0) {
                 log_println("Failed to malloc byte array of %d bytes", length);
                 return -1;
@@ -149,19 +279,113 @@ int teleProcess_read(ProcessHandle ph, JNIEnv *env, jclass c, jlong src, jobject
     }
 
     // Do the read
-    jint bytesRead = readProcessMemory(ph, src, dstBuffer, size);
+    jint bytesRead = pageCache_read(ph, (Address) src, dstBuffer, size);
 
     if (!isDirectByteBuffer) {
         if (bytesRead > 0) {
             (*env)->SetByteArrayRegion(env, dst, offset, bytesRead, dstBuffer);
         }
         if (dstBuffer != (void *) &bufferWord) {
-            free(dstBuffer);
+            releaseTransferBuffer(dstBuffer, size);
         }
     }
     return bytesRead;
 }
 
+/**
+ * Describes a batch of transfers between the tele process and the direct ByteBuffer 'buffer' with two
+ * iovec arrays of 'count' elements each: 'local' for the data in 'buffer', one range after the other,
+ * and 'remote' for the ranges in the tele process. The descriptors stop at the first range that does not fit.
+ *
+ * @return the iovec arrays (to be freed with free()) or NULL if there was an error
+ */
+static struct iovec *batchIovecs(JNIEnv *env, jlongArray descriptors, jint *count, jobject buffer, const char *kind) {
+    jbyte *bufferAddress = (*env)->GetDirectBufferAddress(env, buffer);
+    if (bufferAddress == 0) {
+        log_println("Failed to get address from NIO direct buffer");
+        return NULL;
+    }
+    jlong capacity = (*env)->GetDirectBufferCapacity(env, buffer);
+    jlong *ranges = (jlong *) malloc(2 * *count * sizeof(jlong));
+    struct iovec *iovecs = (struct iovec *) malloc(2 * *count * sizeof(struct iovec));
+    if (ranges == NULL || iovecs == NULL) {
+        log_println("Failed to malloc descriptors for a batch of %d %s", *count, kind);
+        free(ranges);
+        free(iovecs);
+        return NULL;
+    }
+    (*env)->GetLongArrayRegion(env, descriptors, 0, 2 * *count, ranges);
+    if ((*env)->ExceptionOccurred(env) != NULL) {
+        free(ranges);
+        free(iovecs);
+        return NULL;
+    }
+
+    struct iovec *local = iovecs;
+    struct iovec *remote = iovecs + *count;
+    jlong offset = 0;
+    int i;
+    for (i = 0; i < *count; i++) {
+        jlong length = ranges[2 * i + 1];
+        if (length < 0 || offset + length > capacity) {
+            log_println("Batch %s range %d of %ld bytes does not fit in a buffer of %ld bytes", kind, i, length, capacity);
+            break;
+        }
+        remote[i].iov_base = (void *) (Address) ranges[2 * i];
+        remote[i].iov_len = (size_t) length;
+        local[i].iov_base = bufferAddress + offset;
+        local[i].iov_len = (size_t) length;
+        offset += length;
+    }
+    if (i < *count) {
+        /* Keep 'remote' adjacent to the valid prefix of 'local'. */
+        memmove(iovecs + i, remote, i * sizeof(struct iovec));
+    }
+    *count = i;
+    free(ranges);
+    return iovecs;
+}
+
+int teleProcess_readBatch(ProcessHandle ph, JNIEnv *env, jclass c, jlongArray descriptors, jint count, jobject dst) {
+    if (count <= 0) {
+        return 0;
+    }
+    struct iovec *iovecs = batchIovecs(env, descriptors, &count, dst, "reads");
+    if (iovecs == NULL) {
+        return -1;
+    }
+    struct iovec *local = iovecs;
+    struct iovec *remote = iovecs + count;
+
+#ifdef readProcessMemoryVector
+    int result = readProcessMemoryVector(ph, local, remote, count);
+#else
+    int result = 0;
+    while (result < count) {
+        int length = (int) remote[result].iov_len;
+        if (length > 0 && readProcessMemory(ph, remote[result].iov_base, local[result].iov_base, length) != length) {
+            break;
+        }
+        result++;
+    }
+#endif
+    free(iovecs);
+    return result;
+}
+
+int teleProcess_writeBatch(ProcessHandle ph, JNIEnv *env, jclass c, jlongArray descriptors, jint count, jobject src) {
+    if (count <= 0) {
+        return 0;
+    }
+    struct iovec *iovecs = batchIovecs(env, descriptors, &count, src, "writes");
+    if (iovecs == NULL) {
+        return -1;
+    }
+    int result = pageCache_writeBatch(ph, iovecs, iovecs + count, count);
+    free(iovecs);
+    return result;
+}
+
 int teleProcess_write(ProcessHandle ph, JNIEnv *env, jclass c, jlong dst, jobject src, jboolean isDirectByteBuffer, jint offset, jint length) {
     Word bufferWord;
     void* srcBuffer;
@@ -175,7 +399,7 @@ int teleProcess_write(ProcessHandle ph, JNIEnv *env, jclass c, jlong dst, jobjec
         srcBuffer = (jbyte *) srcBuffer + offset;
     } else {
         if (size >  sizeof(Word)) {
-            srcBuffer = malloc(length * sizeof(jbyte));
+            srcBuffer = acquireTransferBuffer(size);
             if (srcBuffer == 0) {
                 log_println("failed to malloc byte array of %d bytes", length);
                 return -1;
@@ -187,17 +411,45 @@ int teleProcess_write(ProcessHandle ph, JNIEnv *env, jclass c, jlong dst, jobjec
         (*env)->GetByteArrayRegion(env, src, offset, length, srcBuffer);
         if ((*env)->ExceptionOccurred(env) != NULL) {
             log_println("failed to copy %d bytes from byte array into buffer", length);
+            if (srcBuffer != (void *) &bufferWord) {
+                releaseTransferBuffer(srcBuffer, size);
+            }
             return -1;
         }
     }
 
-    int result = writeProcessMemory(ph, dst, srcBuffer, size);
+    int result = pageCache_write(ph, (Address) dst, srcBuffer, size);
 
     if (!isDirectByteBuffer) {
         if (srcBuffer != (void *) &bufferWord) {
-            free(srcBuffer);
+            releaseTransferBuffer(srcBuffer, size);
         }
     }
     return result;
 }
 
+#if os_MAXVE
+/* The largest chunk for a basic MaxVE memory handler: a whole number of pages that fits in 16 bits. */
+#define MAXVE_BASIC_TRANSFER_SIZE 0xF000
+
+int maxve_transfer(ProcessHandle ph, boolean write, uint64_t address, char *buffer, size_t size) {
+    MaxVELargeMemoryHandler large = write ? ph->writelarge : ph->readlarge;
+    if (large != NULL) {
+        return large(address, buffer, size);
+    }
+    MaxVEMemoryHandler basic = write ? ph->writebytes : ph->readbytes;
+    size_t done = 0;
+    while (done < size) {
+        size_t chunk = size - done > MAXVE_BASIC_TRANSFER_SIZE ? MAXVE_BASIC_TRANSFER_SIZE : size - done;
+        int n = basic(address + done, buffer + done, (unsigned short) chunk);
+        if (n <= 0) {
+            break;
+        }
+        done += n;
+        if ((size_t) n != chunk) {
+            break;
+        }
+    }
+    return (int) done;
+}
+#endif
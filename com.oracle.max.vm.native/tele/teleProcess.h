@@ -35,6 +35,16 @@ typedef enum ProcessState {
     PS_TERMINATED
 } ProcessState;
 
+/*
+ * A platform may also define 'readProcessMemoryVector(ph, local, remote, count)', which reads the 'count'
+ * ranges described by the iovec array 'remote' into those described by 'local' and returns the number of
+ * leading ranges that were read completely. Otherwise the ranges are read one by one with 'readProcessMemory'.
+ *
+ * Likewise, a platform may define 'writeProcessMemoryVector(ph, local, remote, count)', which writes the 'count'
+ * ranges described by 'local' to those described by 'remote' and returns the number of leading ranges that were
+ * written completely. Otherwise the ranges are written one by one with 'writeProcessMemory'.
+ */
+
 /*
  * Definition of the platform specific type 'ProcessHandle' and the two operations
  * 'readProcessMemory' & 'writeProcessMemory' that use the handle to access the
@@ -51,6 +61,11 @@ typedef struct {
 #include <stdint.h>
 #define readProcessMemory(ph, src, dst, size) task_read(ph->tgid, ph->tid, (const void *) (intptr_t) src, (void *) (intptr_t) dst, (size_t) size)
 #define writeProcessMemory(ph, dst, src, size) task_write(ph->tgid, ph->tid, (void *) (intptr_t) dst, (const void *) (intptr_t) src, (size_t) size)
+#include <sys/uio.h>
+int task_readv(pid_t tgid, pid_t tid, const struct iovec *local, const struct iovec *remote, int count);
+#define readProcessMemoryVector(ph, local, remote, count) task_readv(ph->tgid, ph->tid, local, remote, count)
+int task_writev(pid_t tgid, pid_t tid, const struct iovec *local, const struct iovec *remote, int count);
+#define writeProcessMemoryVector(ph, local, remote, count) task_writev(ph->tgid, ph->tid, local, remote, count)
 #elif os_DARWIN
 #include <mach/mach.h>
 int task_read(task_t task, vm_address_t src, void *dst, size_t size);
@@ -69,33 +84,66 @@ typedef struct ps_prochandle *ProcessHandle;
 // We (ab)use the ProcessHandle argument to distinguish the two different native implementations (xg,db) of tele
 #include <stdint.h>
 typedef int (*MaxVEMemoryHandler)(uint64_t, char *, unsigned short);
+typedef int (*MaxVELargeMemoryHandler)(uint64_t, char *, size_t);
 struct maxve_memory_handler {
     MaxVEMemoryHandler readbytes;
     MaxVEMemoryHandler writebytes;
+    // Optional handlers for transfers of any size, used in preference to the ones above if set
+    MaxVELargeMemoryHandler readlarge;
+    MaxVELargeMemoryHandler writelarge;
 };
 typedef struct maxve_memory_handler *ProcessHandle;
-#define readProcessMemory(ph, src, dst, size) ph->readbytes((uint64_t) src, (char *) dst, (unsigned short) size)
-#define writeProcessMemory(ph, dst, src, size) ph->writebytes((uint64_t) dst, (char *) src, (unsigned short) size);
+
+/**
+ * Transfers 'size' bytes with the large handler of 'ph' if it has one, and otherwise in
+ * chunks that fit the 16 bit size of its basic handler.
+ *
+ * @return the number of bytes transferred
+ */
+extern int maxve_transfer(ProcessHandle ph, boolean write, uint64_t address, char *buffer, size_t size);
+#define readProcessMemory(ph, src, dst, size) maxve_transfer(ph, false, (uint64_t) src, (char *) dst, (size_t) size)
+#define writeProcessMemory(ph, dst, src, size) maxve_transfer(ph, true, (uint64_t) dst, (char *) src, (size_t) size)
 #else
 #error
 #endif
 
 /**
- * Searches the thread locals list in the VM's address space for an entry 'tla' such that:
+ * A copy of the thread locals list in the VM's address space, ordered by stack base so that
+ * the entry for a given stack pointer can be found without any further reads of the VM.
+ */
+typedef struct TLAIndexStruct *TLAIndex;
+
+/**
+ * Copies the thread locals list in the VM's address space into an index. This is done once
+ * when gathering the threads of the VM, after which the TLA of each thread is found with
+ * teleProcess_findIndexedTLA().
+ *
+ * @param ph a platform specific process handle
+ * @param tlaList the head of the thread locals list in the VM's address space
+ * @return the index, which must be released with teleProcess_freeTLAIndex(), or NULL if it could not be allocated
+ */
+extern TLAIndex teleProcess_indexTLAs(ProcessHandle ph, Address tlaList);
+
+/**
+ * Searches an index of the thread locals list for an entry 'tla' such that:
  *
  *   tla.stackBase <= stackPointer && stackPointer < (tla.stackBase + tla.stackSize)
  *
- * If such an entry is found, then its contents are copied from the VM to the structs pointed to by 'tlCopy' and 'ntlCopy'.
+ * If such an entry is found, then its contents are copied to the structs pointed to by 'tlaCopy' and 'ntlCopy'.
  *
- * @param ph a platform specific process handle
- * @param tlaList the head of the thread locals list in the VM's address space
+ * @param index an index created by teleProcess_indexTLAs()
  * @param stackPointer the stack pointer to search with
- * @param tlaCopy pointer to a TLA which the found entry (if any) will be copied from the VM's address space
+ * @param tlaCopy pointer to a TLA into which the found entry (if any) will be copied
  * @param ntlCopy pointer to storage for a NativeThreadLocalsStruct into which the native thread locals of the found entry
- *        (if any) will be copied from the VM's address space
+ *        (if any) will be copied
  * @return the entry that was found, NULL otherwise
  */
-extern TLA teleProcess_findTLA(ProcessHandle ph, Address tlaList, Address stackPointer, TLA tlaCopy, NativeThreadLocals ntlCopy);
+extern TLA teleProcess_findIndexedTLA(TLAIndex index, Address stackPointer, TLA tlaCopy, NativeThreadLocals ntlCopy);
+
+/**
+ * Releases an index created by teleProcess_indexTLAs().
+ */
+extern void teleProcess_freeTLAIndex(TLAIndex index);
 
 /**
  * Makes the upcall to TeleProcess.jniGatherThread
@@ -123,6 +171,31 @@ extern void teleProcess_jniGatherThread(JNIEnv *env, jobject teleProcess, jobjec
  */
 extern int teleProcess_read(ProcessHandle ph, JNIEnv *env, jclass c, jlong src, jobject dst, jboolean isDirectByteBuffer, jint dstOffset, jint length);
 
+/**
+ * Copies a batch of memory ranges from the tele process into a given direct ByteBuffer in one call.
+ * The ranges are copied one after the other, starting at the beginning of 'dst'.
+ *
+ * @param ph a platform specific process handle
+ * @param descriptors a long[] holding an address and a length for each range
+ * @param count the number of ranges
+ * @param dst a direct java.nio.ByteBuffer large enough for the sum of the range lengths
+ * @return the number of leading ranges that were copied completely or -1 if there was an error
+ */
+extern int teleProcess_readBatch(ProcessHandle ph, JNIEnv *env, jclass c, jlongArray descriptors, jint count, jobject dst);
+
+/**
+ * Copies a batch of memory ranges from a given direct ByteBuffer into the tele process in one call, e.g. the
+ * patches for setting or clearing many breakpoints. The ranges are taken one after the other, starting at the
+ * beginning of 'src'.
+ *
+ * @param ph a platform specific process handle
+ * @param descriptors a long[] holding an address and a length for each range
+ * @param count the number of ranges
+ * @param src a direct java.nio.ByteBuffer holding the bytes of the ranges
+ * @return the number of leading ranges that were copied completely or -1 if there was an error
+ */
+extern int teleProcess_writeBatch(ProcessHandle ph, JNIEnv *env, jclass c, jlongArray descriptors, jint count, jobject src);
+
 /**
  * Copies bytes from a given direct ByteBuffer or byte array into the tele process.
  *
@@ -0,0 +1,212 @@
+/*
+ * Copyright (c) 2011, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ */
+/**
+ * Offline decoder for the binary trace files written by a VM run with -XX:BinaryTrace=<directory> (see trace.h).
+ *
+ *     tracedump <file>...
+ *
+ * The records of all the given files are merged in timestamp order and printed one per line. Payload words
+ * that are boot heap or code addresses are printed as offsets in the same way as image_printAddress().
+ * Other addresses are described by the mapped file containing them, taken from the 'maxine-<pid>.maps'
+ * file next to the trace file if there is one.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "trace.h"
+
+typedef struct {
+    Unsigned8 start;
+    Unsigned8 end;
+    Unsigned8 offset;
+    char *path;
+} MappingStruct, *Mapping;
+
+typedef struct {
+    TraceFileHeaderStruct header;
+    Mapping mappings;
+    int mappingsLength;
+} TraceFileStruct, *TraceFile;
+
+typedef struct {
+    TraceRecordStruct record;
+    TraceFile file;
+} DecodedRecordStruct, *DecodedRecord;
+
+#define TRACE_EVENT_NAME(name, id) case id: return #name;
+
+static const char *eventName(Unsigned4 event) {
+    switch (event) {
+        TRACE_EVENTS(TRACE_EVENT_NAME)
+    }
+    return NULL;
+}
+
+/*
+ * Reads the memory map saved for the traced process by trace.c.
+ */
+static void readMappings(TraceFile file, const char *tracePath) {
+    char path[4096];
+    const char *slash = strrchr(tracePath, '/');
+    int directoryLength = slash == NULL ? 0 : (int) (slash - tracePath + 1);
+    snprintf(path, sizeof(path), "%.*smaxine-%llu.maps", directoryLength, tracePath, (unsigned long long) file->header.pid);
+    FILE *maps = fopen(path, "r");
+    if (maps == NULL) {
+        return;
+    }
+    char line[4096 + 256];
+    int capacity = 0;
+    while (fgets(line, sizeof(line), maps) != NULL) {
+        unsigned long long start, end, offset;
+        char mappedPath[4096];
+        if (sscanf(line, "%llx-%llx %*s %llx %*s %*s %4095s", &start, &end, &offset, mappedPath) != 4) {
+            continue;
+        }
+        if (file->mappingsLength == capacity) {
+            capacity = capacity == 0 ? 64 : capacity * 2;
+            file->mappings = (Mapping) realloc(file->mappings, capacity * sizeof(MappingStruct));
+        }
+        Mapping mapping = &file->mappings[file->mappingsLength++];
+        mapping->start = start;
+        mapping->end = end;
+        mapping->offset = offset;
+        mapping->path = strdup(mappedPath);
+    }
+    fclose(maps);
+}
+
+/*
+ * Appends the records of a trace file, oldest first, to a given array.
+ */
+static DecodedRecord readTraceFile(const char *path, DecodedRecord records, int *length, int *capacity) {
+    FILE *in = fopen(path, "rb");
+    if (in == NULL) {
+        fprintf(stderr, "could not open %s\n", path);
+        return records;
+    }
+    TraceFile file = (TraceFile) calloc(1, sizeof(TraceFileStruct));
+    if (fread(&file->header, sizeof(TraceFileHeaderStruct), 1, in) != 1 || file->header.magic != TRACE_MAGIC) {
+        fprintf(stderr, "%s is not a trace file\n", path);
+        fclose(in);
+        free(file);
+        return records;
+    }
+    if (file->header.version != TRACE_VERSION || file->header.recordSize != sizeof(TraceRecordStruct)) {
+        fprintf(stderr, "%s has an unsupported version (%u) or record size (%u)\n", path, file->header.version, file->header.recordSize);
+        fclose(in);
+        free(file);
+        return records;
+    }
+    readMappings(file, path);
+
+    Unsigned8 next = file->header.next;
+    Unsigned8 capacityOfFile = file->header.capacity;
+    Unsigned8 n = next < capacityOfFile ? next : capacityOfFile;
+    Unsigned8 i;
+    for (i = next - n; i < next; i++) {
+        TraceRecordStruct record;
+        long position = sizeof(TraceFileHeaderStruct) + (long) (i % capacityOfFile) * sizeof(TraceRecordStruct);
+        if (fseek(in, position, SEEK_SET) != 0 || fread(&record, sizeof(record), 1, in) != 1) {
+            break;
+        }
+        if (record.event == 0) {
+            /* A slot that was claimed but not yet written when the trace was taken. */
+            continue;
+        }
+        if (*length == *capacity) {
+            *capacity = *capacity == 0 ? 4096 : *capacity * 2;
+            records = (DecodedRecord) realloc(records, *capacity * sizeof(DecodedRecordStruct));
+        }
+        records[*length].record = record;
+        records[*length].file = file;
+        (*length)++;
+    }
+    fclose(in);
+    return records;
+}
+
+static int compareRecords(const void *a, const void *b) {
+    Unsigned8 nanosA = ((DecodedRecord) a)->record.nanos;
+    Unsigned8 nanosB = ((DecodedRecord) b)->record.nanos;
+    return nanosA < nanosB ? -1 : (nanosA > nanosB ? 1 : 0);
+}
+
+static void printWord(TraceFile file, Unsigned8 value) {
+    TraceFileHeader header = &file->header;
+    if (value < 0x10000) {
+        printf("%llu", (unsigned long long) value);
+        return;
+    }
+    printf("0x%016llx", (unsigned long long) value);
+    if (value >= header->heap && value < header->code) {
+        printf("(heap + %llu)", (unsigned long long) (value - header->heap));
+        return;
+    } else if (value >= header->code && value < header->codeEnd) {
+        printf("(code + %llu)", (unsigned long long) (value - header->code));
+        return;
+    }
+    int i;
+    for (i = 0; i < file->mappingsLength; i++) {
+        Mapping mapping = &file->mappings[i];
+        if (value >= mapping->start && value < mapping->end) {
+            printf("(%s + 0x%llx)", mapping->path, (unsigned long long) (value - mapping->start + mapping->offset));
+            return;
+        }
+    }
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <trace file>...\n", argv[0]);
+        return 1;
+    }
+    DecodedRecord records = NULL;
+    int length = 0;
+    int capacity = 0;
+    int i;
+    for (i = 1; i < argc; i++) {
+        records = readTraceFile(argv[i], records, &length, &capacity);
+    }
+    qsort(records, length, sizeof(DecodedRecordStruct), compareRecords);
+
+    for (i = 0; i < length; i++) {
+        TraceRecord record = &records[i].record;
+        TraceFile file = records[i].file;
+        Unsigned8 micros = (record->nanos - file->header.startNanos) / 1000;
+        printf("%10llu.%03llu ms %8u ", (unsigned long long) (micros / 1000), (unsigned long long) (micros % 1000), record->thread);
+        const char *name = eventName(record->event);
+        if (name != NULL) {
+            printf("%-14s", name);
+        } else {
+            printf("EVENT_%-8u", record->event);
+        }
+        int j;
+        for (j = 0; j < TRACE_PAYLOAD_WORDS; j++) {
+            printf(" ");
+            printWord(file, record->payload[j]);
+        }
+        printf("\n");
+    }
+    return 0;
+}
@@ -22,8 +22,10 @@ package com.oracle.max.vm.tests.crossisa;
 import com.sun.cri.ci.CiRegister;
 
 import java.io.*;
+import java.lang.reflect.*;
 import java.math.BigInteger;
 import java.util.ArrayList;
+import java.util.Arrays;
 
 import static com.oracle.max.vm.tests.crossisa.CrossISATester.BitsFlag.All64Bits;
 import static com.oracle.max.vm.tests.crossisa.CrossISATester.BitsFlag.Lower32Bits;
@@ -31,11 +33,14 @@ import static com.oracle.max.vm.tests.crossisa.CrossISATester.BitsFlag.Lower32Bi
 public abstract class CrossISATester {
 
     private static final   String ENABLE_QEMU    = "test.crossisa.qemu";
+    private static final   String BENCHMARK      = "test.crossisa.benchmark";
     protected static final File   qemuOutput     = new File("qemu_output");
     protected static final File   qemuErrors     = new File("qemu_errors");
     private static final   File   bindOutput     = new File("bind_output");
     protected static final File   gdbOutput      = new File("gdb_output");
     protected static final String gdbInput       = "gdb_input";
+    protected static final String gdbBenchmarkInput = "gdb_input_benchmark";
+    protected static final File   benchmarkResults  = new File("benchmark_results");
     protected static final File   gdbErrors      = new File("gdb_errors");
     protected static final File   gccOutput      = new File("gcc_output");
     protected static final File   gccErrors      = new File("gcc_errors");
@@ -45,6 +50,14 @@ public abstract class CrossISATester {
     protected static final File   linkErrors     = new File("link_errors");
 
     public static  boolean ENABLE_SIMULATOR = true;
+
+    /**
+     * The number of times the generated code is run in benchmark mode, or 0 if not benchmarking. Benchmark mode is
+     * enabled with {@code -Dtest.crossisa.benchmark=<iterations>}. The generated code is then run in a loop under
+     * {@code qemu -icount} (see "maxine-tester/junit-tests/benchmark.c") and the cycle counter ticks it takes are
+     * appended to {@link #benchmarkResults} instead of the registers being validated.
+     */
+    public static final int BENCHMARK_ITERATIONS = Integer.getInteger(BENCHMARK, 0);
     private static boolean RESET            = false;
     private static boolean DEBUG            = false;
 
@@ -74,6 +87,16 @@ public abstract class CrossISATester {
     protected double[]   expectedDoubleRegisters  = new double[MAX_NUMBER_OF_REGISTERS];
     protected boolean[]  testDoubleRegisters      = new boolean[MAX_NUMBER_OF_REGISTERS];
 
+    /**
+     * The counts printed by {@link #gdbBenchmarkInput}: the iterations run, the ticks taken by the loop around the
+     * generated code and around an empty function, and the frequency of the counter (0 if unknown).
+     */
+    protected long benchmarkIterations;
+    protected long benchmarkCycles;
+    protected long benchmarkOverhead;
+    protected long benchmarkFrequency;
+    private String benchmarkName;
+
     protected CrossISATester() {
         gccProcessBuilder = getCompilerProcessBuilder();
         gccProcessBuilder.redirectOutput(gccOutput);
@@ -100,6 +123,44 @@ public abstract class CrossISATester {
         }
     }
 
+    public static boolean isBenchmarking() {
+        return BENCHMARK_ITERATIONS > 0;
+    }
+
+    /**
+     * Gets the C statement with which the generated {@code c_entry()} calls the generated code through the function
+     * pointer {@code pf}. In benchmark mode, this is a call of {@code benchmark_run()} which passes at most three
+     * integer arguments; the arguments are zero if there are more or if any of them is floating point.
+     */
+    public static String callCode(String listOfTypes, String listOfValues) {
+        if (!isBenchmarking()) {
+            return "(*pf)(" + listOfValues + ");\n";
+        }
+        final String[] values = listOfValues.trim().isEmpty() ? new String[0] : listOfValues.split(",");
+        final boolean passArguments = values.length <= 3 && !listOfTypes.contains("float") && !listOfTypes.contains("double");
+        final StringBuilder call = new StringBuilder("benchmark_run((void *) pf, " + BENCHMARK_ITERATIONS + "ULL");
+        for (int i = 0; i < 3; i++) {
+            call.append(", ").append(passArguments && i < values.length ? "(long) (" + values[i].trim() + ")" : "0");
+        }
+        return call.append(");\n").toString();
+    }
+
+    /**
+     * Sets the name under which the next benchmark results are recorded. By default, the name of the JUnit test
+     * method found on the call stack is used.
+     */
+    public void setBenchmarkName(String name) {
+        benchmarkName = name;
+    }
+
+    public long getBenchmarkCycles() {
+        return benchmarkCycles;
+    }
+
+    public long getBenchmarkOverhead() {
+        return benchmarkOverhead;
+    }
+
     public static void enableDebug() {
         DEBUG = true;
     }
@@ -230,6 +291,10 @@ public abstract class CrossISATester {
     }
 
     public boolean validateIntRegisters() {
+        if (isBenchmarking()) {
+            // The registers hold the state of the benchmark loop rather than the results of the code
+            return true;
+        }
         boolean valid   = true;
 
         assert expectedIntRegisters != null;
@@ -258,6 +323,10 @@ public abstract class CrossISATester {
     }
 
     public boolean validateLongRegisters() {
+        if (isBenchmarking()) {
+            // The registers hold the state of the benchmark loop rather than the results of the code
+            return true;
+        }
         boolean valid   = true;
 
         assert expectedLongRegisters != null;
@@ -286,6 +355,10 @@ public abstract class CrossISATester {
     }
 
     public boolean validateFloatRegisters() {
+        if (isBenchmarking()) {
+            // The registers hold the state of the benchmark loop rather than the results of the code
+            return true;
+        }
         boolean valid   = true;
 
         assert expectedFloatRegisters != null;
@@ -314,6 +387,10 @@ public abstract class CrossISATester {
     }
 
     public boolean validateDoubleRegisters() {
+        if (isBenchmarking()) {
+            // The registers hold the state of the benchmark loop rather than the results of the code
+            return true;
+        }
         boolean valid   = true;
 
         assert expectedDoubleRegisters != null;
@@ -694,6 +771,83 @@ public abstract class CrossISATester {
             cleanProcesses();
             System.exit(-1);
         }
+        if (isBenchmarking()) {
+            parseBenchmarkCounts();
+            recordBenchmarkResults();
+        }
+    }
+
+    /**
+     * Parses the counts printed by {@link #gdbBenchmarkInput}, which are in the same form as the registers:
+     *
+     * <pre>
+     *   benchmark_cycles 0x2a3f0
+     * </pre>
+     */
+    protected void parseBenchmarkCounts() throws IOException {
+        BufferedReader reader = new BufferedReader(new FileReader(gdbOutput));
+        String         line;
+        while ((line = reader.readLine()) != null) {
+            if (line.startsWith("benchmark_iterations ")) {
+                benchmarkIterations = parseLongRegister(line);
+            } else if (line.startsWith("benchmark_cycles ")) {
+                benchmarkCycles = parseLongRegister(line);
+            } else if (line.startsWith("benchmark_overhead ")) {
+                benchmarkOverhead = parseLongRegister(line);
+            } else if (line.startsWith("benchmark_frequency ")) {
+                benchmarkFrequency = parseLongRegister(line);
+            }
+        }
+        reader.close();
+    }
+
+    /**
+     * Appends a line {@code name,iterations,cycles,overhead,frequency} to {@link #benchmarkResults} and reports the
+     * ticks per iteration, net of the loop overhead.
+     */
+    private void recordBenchmarkResults() throws IOException {
+        final String name = benchmarkName != null ? benchmarkName : testMethodName();
+        benchmarkName = null;
+        final PrintWriter writer = new PrintWriter(new FileWriter(benchmarkResults, true));
+        writer.println(name + "," + benchmarkIterations + "," + benchmarkCycles + "," + benchmarkOverhead + "," + benchmarkFrequency);
+        writer.close();
+        if (benchmarkIterations > 0) {
+            System.out.printf("%s: %.2f ticks per iteration%n", name, (benchmarkCycles - benchmarkOverhead) / (double) benchmarkIterations);
+        } else {
+            System.out.println(name + ": the benchmark did not complete");
+        }
+    }
+
+    private static String testMethodName() {
+        for (StackTraceElement frame : new Throwable().getStackTrace()) {
+            try {
+                for (Method method : Class.forName(frame.getClassName()).getDeclaredMethods()) {
+                    if (method.getName().equals(frame.getMethodName()) && method.isAnnotationPresent(org.junit.Test.class)) {
+                        return frame.getClassName() + "." + frame.getMethodName();
+                    }
+                }
+            } catch (ClassNotFoundException e) {
+                // Not a test class
+            }
+        }
+        return "code";
+    }
+
+    /**
+     * Creates the process builder for a QEMU command line. In benchmark mode QEMU is run with {@code -icount shift=0}
+     * so that its clocks and cycle counters advance deterministically with the instructions executed.
+     */
+    protected static ProcessBuilder qemuCommand(String... command) {
+        final ArrayList<String> arguments = new ArrayList<>(Arrays.asList(command));
+        if (isBenchmarking()) {
+            arguments.add("-icount");
+            arguments.add("shift=0");
+        }
+        return new ProcessBuilder(arguments);
+    }
+
+    protected static String gdbScript() {
+        return isBenchmarking() ? gdbBenchmarkInput : gdbInput;
     }
 
     public void link() {
@@ -715,7 +869,7 @@ public abstract class CrossISATester {
         if (gdbProcessBuilder != null) {
             return gdbProcessBuilder;
         }
-        return new ProcessBuilder("gdb-multiarch", "-q", "-x", gdbInput);
+        return new ProcessBuilder("gdb-multiarch", "-q", "-x", gdbScript());
     }
 
     public void run() throws Exception {
@@ -22,6 +22,7 @@ package com.oracle.max.vm.tests.crossisa.aarch64.asm;
 import java.io.*;
 
 import com.oracle.max.asm.*;
+import com.oracle.max.vm.tests.crossisa.*;
 
 import static com.sun.max.vm.stack.JVMSFrameLayout.JVMS_SLOT_SIZE;
 
@@ -66,7 +67,7 @@ public class Aarch64CodeWriter {
         String val = new String(returnType + " (*pf)(");
         val += listOfTypes + ") = (" + returnType + "(*)(" + listOfTypes + "))(code);\n";
         val += "print_uart0(\"Changed!\");\n";
-        val += "(*pf)(" + listOfValues + ");\n";
+        val += CrossISATester.callCode(listOfTypes, listOfValues);
         return val;
     }
 
@@ -84,8 +85,8 @@ public class Aarch64CodeWriter {
                                "0x" + Integer.toHexString(stubs[i + 2] & 0xFF) + ", " +
                                "0x" + Integer.toHexString(stubs[i + 3] & 0xFF) + ",");
             }
-            // ret
-            writer.println("0xd6, 0x5f, 0x03, 0xc0 };\n");
+            // ret (emitted in instruction byte order in benchmark mode, where the code must return)
+            writer.println(CrossISATester.isBenchmarking() ? "0xc0, 0x03, 0x5f, 0xd6 };\n" : "0xd6, 0x5f, 0x03, 0xc0 };\n");
             writer.println("unsigned char *code = codeArray + " + entryPoint + ";");
             writer.println("void c_entry() {");
             writer.print(functionPrototype);
@@ -114,8 +115,8 @@ public class Aarch64CodeWriter {
                         "0x" + Long.toHexString(xxx >> 16 & 0xFF) + ", " +
                         "0x" + Long.toHexString(xxx >> 24 & 0xFF) + ",");
             }
-            // ret
-            writer.println("0xd6, 0x5f, 0x03, 0xc0 };\n");
+            // ret (emitted in instruction byte order in benchmark mode, where the code must return)
+            writer.println(CrossISATester.isBenchmarking() ? "0xc0, 0x03, 0x5f, 0xd6 };\n" : "0xd6, 0x5f, 0x03, 0xc0 };\n");
             writer.println("void c_entry() {");
             String preAmble = preAmble("void", "", "");
             writer.print(preAmble);
@@ -118,7 +118,7 @@ public class MaxineAarch64Tester extends CrossISATester {
         if (qemuProcessBuilder != null) {
             return qemuProcessBuilder;
         }
-        return new ProcessBuilder("qemu-system-aarch64", "-cpu", "cortex-a57", "-M", "virt", "-m", "128M", "-nographic",
+        return qemuCommand("qemu-system-aarch64", "-cpu", "cortex-a57", "-M", "virt", "-m", "128M", "-nographic",
                 "-s", "-S", "-kernel", "test.elf");
     }
 
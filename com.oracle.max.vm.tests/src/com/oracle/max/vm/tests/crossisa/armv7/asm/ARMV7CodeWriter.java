@@ -22,6 +22,7 @@ package com.oracle.max.vm.tests.crossisa.armv7.asm;
 import java.io.*;
 
 import com.oracle.max.asm.*;
+import com.oracle.max.vm.tests.crossisa.*;
 
 public class ARMV7CodeWriter {
 
@@ -64,7 +65,7 @@ public class ARMV7CodeWriter {
         String val = new String(returnType + " (*pf)(");
         val += listOfTypes + ") = (" + returnType + "(*)(" + listOfTypes + "))(code);\n";
         val += "print_uart0(\"Changed!\");\n";
-        val += "(*pf)(" + listOfValues + ");\n";
+        val += CrossISATester.callCode(listOfTypes, listOfValues);
         return val;
     }
 
@@ -82,8 +83,8 @@ public class ARMV7CodeWriter {
                                "0x" + Integer.toHexString(stubs[i + 2] & 0xFF) + ", " +
                                "0x" + Integer.toHexString(stubs[i + 3] & 0xFF) + ",");
             }
-            // bx lr
-            writer.println("0xe1, 0x2f, 0xff, 0x1e  };\n");
+            // bx lr (emitted in instruction byte order in benchmark mode, where the code must return)
+            writer.println(CrossISATester.isBenchmarking() ? "0x1e, 0xff, 0x2f, 0xe1  };\n" : "0xe1, 0x2f, 0xff, 0x1e  };\n");
             writer.println("unsigned char *code = codeArray + " + entryPoint + ";");
             writer.println("void c_entry() {");
             writer.print(functionPrototype);
@@ -51,7 +51,7 @@ public class MaxineARMv7Tester extends CrossISATester {
         if (qemuProcessBuilder != null) {
             return qemuProcessBuilder;
         }
-        return new ProcessBuilder("qemu-system-arm", "-cpu", "cortex-a15", "-M", "versatilepb", "-m", "128M",
+        return qemuCommand("qemu-system-arm", "-cpu", "cortex-a15", "-M", "versatilepb", "-m", "128M",
                                   "-nographic", "-s", "-S", "-kernel", "test.elf");
     }
 
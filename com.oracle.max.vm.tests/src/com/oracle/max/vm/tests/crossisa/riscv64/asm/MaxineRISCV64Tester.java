@@ -82,7 +82,7 @@ public class MaxineRISCV64Tester extends CrossISATester {
         if (gdbProcessBuilder != null) {
             return gdbProcessBuilder;
         }
-        return new ProcessBuilder("riscv64-elf-gdb", "-q", "-x", gdbInput);
+        return new ProcessBuilder("riscv64-elf-gdb", "-q", "-x", gdbScript());
     }
 
     @Override
@@ -90,7 +90,7 @@ public class MaxineRISCV64Tester extends CrossISATester {
         if (qemuProcessBuilder != null) {
             return qemuProcessBuilder;
         }
-        return new ProcessBuilder("qemu-system-riscv64", "-M", "virt", "-m", "128M", "-nographic", "-s", "-S", "-kernel", "test.elf");
+        return qemuCommand("qemu-system-riscv64", "-M", "virt", "-m", "128M", "-nographic", "-s", "-S", "-kernel", "test.elf");
     }
 
     public long[] runRegisteredSimulation() throws Exception {
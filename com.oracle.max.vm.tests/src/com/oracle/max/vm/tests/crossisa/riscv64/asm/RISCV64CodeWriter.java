@@ -22,6 +22,7 @@ package com.oracle.max.vm.tests.crossisa.riscv64.asm;
 import java.io.*;
 
 import com.oracle.max.asm.*;
+import com.oracle.max.vm.tests.crossisa.*;
 
 public class RISCV64CodeWriter {
 
@@ -64,7 +65,7 @@ public class RISCV64CodeWriter {
         String val = new String(returnType + " (*pf)(");
         val += listOfTypes + ") = (" + returnType + "(*)(" + listOfTypes + "))(code);\n";
         val += "print_uart0(\"Changed!\");\n";
-        val += "(*pf)(" + listOfValues + ");\n";
+        val += CrossISATester.callCode(listOfTypes, listOfValues);
         return val;
     }
 
@@ -82,8 +83,8 @@ public class RISCV64CodeWriter {
                                "0x" + Integer.toHexString(stubs[i + 2] & 0xFF) + ", " +
                                "0x" + Integer.toHexString(stubs[i + 3] & 0xFF) + ",");
             }
-            // jalr zero, ra, 0
-            writer.println("0x00, 0x00, 0x80, 0x67  };\n");
+            // jalr zero, ra, 0 (emitted in instruction byte order in benchmark mode, where the code must return)
+            writer.println(CrossISATester.isBenchmarking() ? "0x67, 0x80, 0x00, 0x00  };\n" : "0x00, 0x00, 0x80, 0x67  };\n");
             writer.println("unsigned char *code = codeArray + " + entryPoint + ";");
             writer.println("void c_entry() {");
             writer.print(functionPrototype);
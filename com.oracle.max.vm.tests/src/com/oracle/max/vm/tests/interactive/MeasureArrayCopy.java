@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2007, 2012, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ */
+package com.oracle.max.vm.tests.interactive;
+
+import java.util.*;
+
+/**
+ * Measures copying {@code byte} arrays of 8 bytes to 64MB with {@link System#arraycopy} and with the
+ * JVM_ArrayCopy entry point as called by native code (see arrayCopy.c). The median time of
+ * {@value #TRIALS} trials is reported for each size, both per copy and as a bandwidth.
+ *
+ * The native library is built by the {@code bench} target of the native makefile.
+ *
+ * Usage: {@code MeasureArrayCopy [bytes per trial]}
+ */
+public class MeasureArrayCopy {
+
+    private static final long DEFAULT_BYTES_PER_TRIAL = 256L * 1024 * 1024;
+
+    private static final int TRIALS = 5;
+
+    private static final int MIN_SIZE = 8;
+
+    private static final int MAX_SIZE = 64 * 1024 * 1024;
+
+    /**
+     * The most copies made in a trial, which bounds the time taken by the trials of the small sizes.
+     */
+    private static final int MAX_ITERATIONS = 1000000;
+
+    static {
+        System.loadLibrary("bench");
+    }
+
+    private static native long jvmArrayCopy(Object src, Object dst, int length, int iterations);
+
+    interface Copier {
+        /**
+         * Makes {@code iterations} copies of {@code length} elements from {@code src} to {@code dst}.
+         *
+         * @return the time taken in nanoseconds or -1 if the copies failed
+         */
+        long run(byte[] src, byte[] dst, int length, int iterations);
+    }
+
+    static final Copier SYSTEM_ARRAYCOPY = new Copier() {
+        public long run(byte[] src, byte[] dst, int length, int iterations) {
+            final long start = System.nanoTime();
+            for (int i = 0; i < iterations; i++) {
+                System.arraycopy(src, 0, dst, 0, length);
+            }
+            return System.nanoTime() - start;
+        }
+    };
+
+    static final Copier JVM_ARRAYCOPY = new Copier() {
+        public long run(byte[] src, byte[] dst, int length, int iterations) {
+            return jvmArrayCopy(src, dst, length, iterations);
+        }
+    };
+
+    public static void main(String[] args) {
+        final long bytesPerTrial = args.length > 0 ? Long.parseLong(args[0]) : DEFAULT_BYTES_PER_TRIAL;
+        final byte[] src = new byte[MAX_SIZE];
+        final byte[] dst = new byte[MAX_SIZE];
+        new Random(42).nextBytes(src);
+        for (int size = MIN_SIZE; size <= MAX_SIZE; size *= 2) {
+            final int iterations = (int) Math.max(1, Math.min(MAX_ITERATIONS, bytesPerTrial / size));
+            measure("System.arraycopy", SYSTEM_ARRAYCOPY, src, dst, size, iterations);
+            measure("JVM_ArrayCopy", JVM_ARRAYCOPY, src, dst, size, iterations);
+        }
+    }
+
+    static void measure(String name, Copier copier, byte[] src, byte[] dst, int size, int iterations) {
+        // Warm up so that the measured trials do not include compilation
+        copier.run(src, dst, size, Math.max(1, iterations / 10));
+
+        final double[] nanosPerCopy = new double[TRIALS];
+        for (int trial = 0; trial < TRIALS; trial++) {
+            final long nanos = copier.run(src, dst, size, iterations);
+            if (nanos < 0) {
+                System.out.printf("%-18s %10d bytes: failed%n", name, size);
+                return;
+            }
+            nanosPerCopy[trial] = nanos / (double) iterations;
+        }
+        Arrays.sort(nanosPerCopy);
+        final double median = nanosPerCopy[TRIALS / 2];
+        System.out.printf("%-18s %10d bytes: %14.1f ns/copy %8.2f GB/s%n", name, size, median, size / median);
+    }
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2007, 2012, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ */
+package com.oracle.max.vm.tests.interactive;
+
+import java.util.*;
+
+/**
+ * Measures the out-of-line runtime helpers for long and floating point arithmetic exported by the VM
+ * (d2long, arithmeticldiv et al.) as called by native code, and the inline versions of javaArithmetic.h
+ * that native callers use (see javaArithmetic.c). The median time per call of {@value #TRIALS} trials
+ * is reported for each helper.
+ *
+ * The native library is built by the {@code bench} target of the native makefile.
+ *
+ * Usage: {@code MeasureJavaArithmetic [iterations]}
+ */
+public class MeasureJavaArithmetic {
+
+    private static final int DEFAULT_ITERATIONS = 10000000;
+
+    private static final int TRIALS = 5;
+
+    /**
+     * The helpers, in the order of {@code helperNames} in javaArithmetic.c.
+     */
+    private static final String[] HELPERS = {
+        "d2long", "f2long", "l2double", "l2float",
+        "arithmeticldiv", "arithmeticlrem", "arithmeticludiv", "arithmeticlurem",
+        "nativeLongCompare", "nativeLongSignedShiftedRight", "nativeLongMultiply", "nativeLongDivided", "nativeLongRemainder",
+        "nativeFloatRemainder", "nativeDoubleRemainder"
+    };
+
+    static {
+        System.loadLibrary("bench");
+    }
+
+    private static native int helperCount();
+
+    /**
+     * Times {@code iterations} calls of a helper.
+     *
+     * @return the time taken in nanoseconds or -1 if the helper is not available
+     */
+    private static native long measure(int helper, boolean inline, int iterations);
+
+    public static void main(String[] args) {
+        final int iterations = args.length > 0 ? Integer.parseInt(args[0]) : DEFAULT_ITERATIONS;
+        if (helperCount() != HELPERS.length) {
+            throw new Error("the helpers of javaArithmetic.c do not match " + MeasureJavaArithmetic.class.getName());
+        }
+        System.out.printf("%-30s %14s %14s%n", "helper", "VM entry", "inline");
+        for (int helper = 0; helper < HELPERS.length; helper++) {
+            System.out.printf("%-30s %14s %14s%n", HELPERS[helper], median(helper, false, iterations), median(helper, true, iterations));
+        }
+    }
+
+    static String median(int helper, boolean inline, int iterations) {
+        // Warm up the caches and branch predictors
+        measure(helper, inline, Math.max(1, iterations / 10));
+
+        final double[] nanosPerCall = new double[TRIALS];
+        for (int trial = 0; trial < TRIALS; trial++) {
+            final long nanos = measure(helper, inline, iterations);
+            if (nanos < 0) {
+                return "n/a";
+            }
+            nanosPerCall[trial] = nanos / (double) iterations;
+        }
+        Arrays.sort(nanosPerCall);
+        return String.format("%.2f ns/call", nanosPerCall[TRIALS / 2]);
+    }
+}
@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2007, 2012, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ */
+package com.oracle.max.vm.tests.interactive;
+
+import java.util.*;
+
+/**
+ * Microbenchmarks for the cost of JNI transitions and JNI functions: empty static, instance and
+ * critical native calls, calls back into Java through the varargs and the jvalue array functions,
+ * field access, the ways of accessing a primitive array, local reference churn and attaching and
+ * detaching a native thread (see jniTransitions.c). The median time per operation of
+ * {@value #TRIALS} trials is reported for each benchmark.
+ *
+ * The native library is built by the {@code bench} target of the native makefile.
+ *
+ * Usage: {@code MeasureJniTransitions [iterations]}
+ */
+public class MeasureJniTransitions {
+
+    private static final int DEFAULT_ITERATIONS = 1000000;
+
+    private static final int TRIALS = 5;
+
+    private static final int ARRAY_LENGTH = 64;
+
+    private static final int ARRAY_ELEMENTS = 0;
+    private static final int ARRAY_REGION = 1;
+    private static final int ARRAY_CRITICAL = 2;
+
+    static {
+        System.loadLibrary("bench");
+    }
+
+    private static native void emptyStatic();
+    private native void emptyInstance();
+    private static native int sum(int[] array);
+    private static native int criticalSum(int[] array);
+    private static native long callMethod(Object receiver, boolean varargs, int iterations);
+    private static native long fieldAccess(Object object, int iterations);
+    private static native long arrayAccess(int[] array, int mode, int iterations);
+    private static native long localRefs(Object object, boolean frames, int iterations);
+    private static native long attachDetach(int iterations);
+
+    /**
+     * The receiver of the calls and field accesses made by the native code.
+     */
+    int value;
+
+    int add(int a, int b) {
+        return a + b;
+    }
+
+    interface Benchmark {
+        /**
+         * Runs {@code iterations} operations.
+         *
+         * @return the time taken in nanoseconds or -1 if the benchmark failed
+         */
+        long run(int iterations);
+    }
+
+    static final MeasureJniTransitions receiver = new MeasureJniTransitions();
+    static final int[] array = new int[ARRAY_LENGTH];
+
+    static final Benchmark EMPTY_STATIC = new Benchmark() {
+        public long run(int iterations) {
+            final long start = System.nanoTime();
+            for (int i = 0; i < iterations; i++) {
+                emptyStatic();
+            }
+            return System.nanoTime() - start;
+        }
+    };
+
+    static final Benchmark EMPTY_INSTANCE = new Benchmark() {
+        public long run(int iterations) {
+            final long start = System.nanoTime();
+            for (int i = 0; i < iterations; i++) {
+                receiver.emptyInstance();
+            }
+            return System.nanoTime() - start;
+        }
+    };
+
+    static final Benchmark ARRAY_SUM = new Benchmark() {
+        public long run(int iterations) {
+            final long start = System.nanoTime();
+            for (int i = 0; i < iterations; i++) {
+                sum(array);
+            }
+            return System.nanoTime() - start;
+        }
+    };
+
+    static final Benchmark CRITICAL_ARRAY_SUM = new Benchmark() {
+        public long run(int iterations) {
+            final long start = System.nanoTime();
+            for (int i = 0; i < iterations; i++) {
+                criticalSum(array);
+            }
+            return System.nanoTime() - start;
+        }
+    };
+
+    public static void main(String[] args) {
+        final int iterations = args.length > 0 ? Integer.parseInt(args[0]) : DEFAULT_ITERATIONS;
+        measure("empty static native call", EMPTY_STATIC, iterations);
+        measure("empty instance native call", EMPTY_INSTANCE, iterations);
+        measure("int[" + ARRAY_LENGTH + "] sum native call (JNI)", ARRAY_SUM, iterations);
+        measure("int[" + ARRAY_LENGTH + "] sum native call (critical)", CRITICAL_ARRAY_SUM, iterations);
+        measure("CallIntMethod (varargs)", new Benchmark() {
+            public long run(int n) {
+                return callMethod(receiver, true, n);
+            }
+        }, iterations);
+        measure("CallIntMethodA", new Benchmark() {
+            public long run(int n) {
+                return callMethod(receiver, false, n);
+            }
+        }, iterations);
+        measure("GetIntField + SetIntField", new Benchmark() {
+            public long run(int n) {
+                return fieldAccess(receiver, n);
+            }
+        }, iterations);
+        measure("Get/ReleaseIntArrayElements int[" + ARRAY_LENGTH + "]", new Benchmark() {
+            public long run(int n) {
+                return arrayAccess(array, ARRAY_ELEMENTS, n);
+            }
+        }, iterations);
+        measure("Get/SetIntArrayRegion int[" + ARRAY_LENGTH + "]", new Benchmark() {
+            public long run(int n) {
+                return arrayAccess(array, ARRAY_REGION, n);
+            }
+        }, iterations);
+        measure("Get/ReleasePrimitiveArrayCritical int[" + ARRAY_LENGTH + "]", new Benchmark() {
+            public long run(int n) {
+                return arrayAccess(array, ARRAY_CRITICAL, n);
+            }
+        }, iterations);
+        measure("NewLocalRef + DeleteLocalRef", new Benchmark() {
+            public long run(int n) {
+                return localRefs(receiver, false, n);
+            }
+        }, iterations);
+        measure("Push/PopLocalFrame with 16 references", new Benchmark() {
+            public long run(int n) {
+                return localRefs(receiver, true, n);
+            }
+        }, iterations);
+        // attaching a thread is orders of magnitude slower than the other operations
+        measure("AttachCurrentThread + DetachCurrentThread", new Benchmark() {
+            public long run(int n) {
+                return attachDetach(n);
+            }
+        }, Math.max(1, iterations / 100));
+    }
+
+    static void measure(String name, Benchmark benchmark, int iterations) {
+        // Warm up so that the measured trials do not include compilation or class loading
+        benchmark.run(Math.max(1, iterations / 10));
+
+        final double[] nanosPerOp = new double[TRIALS];
+        for (int trial = 0; trial < TRIALS; trial++) {
+            final long nanos = benchmark.run(iterations);
+            if (nanos < 0) {
+                System.out.printf("%-56s failed%n", name);
+                return;
+            }
+            nanosPerOp[trial] = nanos / (double) iterations;
+        }
+        Arrays.sort(nanosPerOp);
+        System.out.printf("%-56s %10.1f ns/op (min %.1f, max %.1f)%n", name, nanosPerOp[TRIALS / 2], nanosPerOp[0], nanosPerOp[TRIALS - 1]);
+    }
+}
@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2007, 2012, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ */
+package com.oracle.max.vm.tests.interactive;
+
+import java.util.*;
+
+/**
+ * Microbenchmarks for the native thread lifecycle paths of the substrate: creating and destroying
+ * VM threads, attaching and detaching native threads, and the complete lifecycle of an attached
+ * native thread. For each benchmark, the latency percentiles of an iteration are reported together
+ * with the number of system calls, page faults and context switches per iteration where the
+ * platform can count them (see threadLifecycle.c).
+ *
+ * Usage: {@code MeasureThreadLifecycle [iterations]}
+ */
+public class MeasureThreadLifecycle {
+
+    private static final int DEFAULT_ITERATIONS = 10000;
+
+    private static final String[] EVENTS = {"syscalls", "page faults", "context switches"};
+
+    static {
+        System.loadLibrary("bench");
+    }
+
+    private static native void beginEvents();
+    private static native void endEvents(long[] events);
+    private static native int attachDetach(int iterations, long[] nanos);
+    private static native int attachedThread(int iterations, long[] nanos);
+
+    interface Benchmark {
+        /**
+         * Runs {@code nanos.length} iterations, storing the time taken by each in {@code nanos}.
+         *
+         * @return the number of failed iterations
+         */
+        int run(long[] nanos) throws InterruptedException;
+    }
+
+    static final Benchmark VM_THREAD = new Benchmark() {
+        public int run(long[] nanos) throws InterruptedException {
+            final Runnable empty = new Runnable() {
+                public void run() {
+                }
+            };
+            for (int i = 0; i < nanos.length; i++) {
+                final long start = System.nanoTime();
+                final Thread thread = new Thread(empty);
+                thread.start();
+                thread.join();
+                nanos[i] = System.nanoTime() - start;
+            }
+            return 0;
+        }
+    };
+
+    static final Benchmark ATTACH_DETACH = new Benchmark() {
+        public int run(long[] nanos) {
+            return attachDetach(nanos.length, nanos);
+        }
+    };
+
+    static final Benchmark ATTACHED_THREAD = new Benchmark() {
+        public int run(long[] nanos) {
+            return attachedThread(nanos.length, nanos);
+        }
+    };
+
+    public static void main(String[] args) throws InterruptedException {
+        final int iterations = args.length > 0 ? Integer.parseInt(args[0]) : DEFAULT_ITERATIONS;
+        measure("create/start/join VM thread", VM_THREAD, iterations);
+        measure("attach/detach native thread", ATTACH_DETACH, iterations);
+        measure("create/attach/detach/join native thread", ATTACHED_THREAD, iterations);
+    }
+
+    static void measure(String name, Benchmark benchmark, int iterations) throws InterruptedException {
+        // Warm up so that the measured iterations do not include compilation or class loading
+        benchmark.run(new long[Math.max(1, iterations / 10)]);
+
+        final long[] nanos = new long[iterations];
+        final long[] events = new long[EVENTS.length];
+        beginEvents();
+        final int failures = benchmark.run(nanos);
+        endEvents(events);
+
+        Arrays.sort(nanos);
+        System.out.printf("%s: %d iterations%s%n", name, iterations, failures == 0 ? "" : " (" + failures + " failed)");
+        System.out.printf("    latency (us): p50 %.1f, p90 %.1f, p99 %.1f, p99.9 %.1f, max %.1f%n",
+                        percentile(nanos, 50), percentile(nanos, 90), percentile(nanos, 99), percentile(nanos, 99.9), nanos[iterations - 1] / 1000.0d);
+        final StringBuilder sb = new StringBuilder("    per iteration:");
+        for (int i = 0; i < EVENTS.length; i++) {
+            sb.append(i == 0 ? " " : ", ").append(EVENTS[i]).append(' ');
+            sb.append(events[i] < 0 ? "n/a" : String.format("%.1f", events[i] / (double) iterations));
+        }
+        System.out.println(sb);
+    }
+
+    /**
+     * Gets the value in microseconds at a given percentile of a sorted array of nanosecond values.
+     */
+    static double percentile(long[] sortedNanos, double percentile) {
+        final int index = (int) Math.ceil(percentile / 100.0d * sortedNanos.length) - 1;
+        return sortedNanos[Math.max(0, Math.min(index, sortedNanos.length - 1))] / 1000.0d;
+    }
+}
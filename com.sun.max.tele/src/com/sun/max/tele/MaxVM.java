@@ -408,6 +408,23 @@ public interface MaxVM extends MaxEntity<MaxVM> {
      */
     void singleStepThread(MaxThread thread, boolean synchronous) throws InvalidVMRequestException, OSExecutionRequestException;
 
+    /**
+     * Single steps a thread in the VM until it reaches an address, leaves an address range or has executed a number
+     * of instructions, whichever comes first. Where supported, the steps are made without a round trip to the
+     * Inspector for each instruction.
+     *
+     * @param thread a thread in the VM
+     * @param target the address at which to stop, or zero for none
+     * @param rangeStart start of the range within which to keep stepping
+     * @param rangeEnd end of the range; if not greater than {@code rangeStart}, there is no range
+     * @param maxSteps the maximum number of instructions to execute
+     * @param synchronous should the call wait for the execution to complete.
+     * @throws InvalidVMRequestException execution not permissible in current VM state.
+     * @throws OSExecutionRequestException execution failed in OS.
+     */
+    void stepThreadUntil(MaxThread thread, Address target, Address rangeStart, Address rangeEnd, long maxSteps, boolean synchronous)
+        throws InvalidVMRequestException, OSExecutionRequestException;
+
     /**
      * Single steps a thread in the VM; if the instruction is a call, then resume VM execution until call returns.
      *
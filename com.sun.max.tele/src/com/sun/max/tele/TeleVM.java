@@ -1559,6 +1559,12 @@ public abstract class TeleVM implements MaxVM {
         teleProcess.singleStepThread(teleNativeThread, synchronous);
     }
 
+    public final void stepThreadUntil(MaxThread maxThread, Address target, Address rangeStart, Address rangeEnd, long maxSteps, boolean synchronous)
+        throws InvalidVMRequestException, OSExecutionRequestException {
+        final TeleNativeThread teleNativeThread = (TeleNativeThread) maxThread;
+        teleProcess.stepThreadUntil(teleNativeThread, target, rangeStart, rangeEnd, maxSteps, synchronous);
+    }
+
     public final void stepOver(final MaxThread maxThread, boolean synchronous, final boolean withClientBreakpoints) throws InvalidVMRequestException, OSExecutionRequestException {
         final TeleNativeThread teleNativeThread = (TeleNativeThread) maxThread;
         teleProcess.stepOver(teleNativeThread, synchronous, withClientBreakpoints);
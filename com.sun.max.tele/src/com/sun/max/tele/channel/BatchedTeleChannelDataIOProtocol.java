@@ -0,0 +1,36 @@
+/*
+ * Copyright (c) 2017-2018, APT Group, School of Computer Science,
+ * The University of Manchester. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+package com.sun.max.tele.channel;
+
+/**
+ * Extension of {@link TeleChannelDataIOProtocol} with a batched read, so that a remote Inspector can
+ * fetch many ranges of the target VM's memory in one round trip to the agent.
+ */
+public interface BatchedTeleChannelDataIOProtocol {
+    /**
+     * Reads a batch of ranges from the target VM into a byte array, one after the other from the start of the array.
+     * @param descriptors the address and length of each range, as for {@link TeleChannelProtocol#readBytesBatch}
+     * @param count the number of ranges
+     * @param dst byte array to write to
+     * @param length the sum of the lengths of the ranges, {@code length <= maxByteBufferSize()}
+     * @return the number of leading ranges that were read completely, or -1 if there was an error
+     */
+    int readBytesRanges(long[] descriptors, int count, byte[] dst, int length);
+}
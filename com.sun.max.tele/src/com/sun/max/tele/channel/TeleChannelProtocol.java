@@ -54,6 +54,27 @@ public interface TeleChannelProtocol extends TeleChannelDataIOProtocol {
      * @return number of bytes actually written
      */
     int writeBytes(long dst, ByteBuffer src, int srcOffset, int length);
+    /**
+     * Reads a batch of ranges from the target VM into a (likely direct) {@link java.nio.ByteBuffer}, one after the other
+     * from the start of the buffer. A native implementation reads the whole batch with one call.
+     * @param descriptors the address and length of each range, i.e. {@code descriptors[2 * i]} is the address
+     *            and {@code descriptors[2 * i + 1]} the length of range {@code i}
+     * @param count the number of ranges
+     * @param dst the byte buffer to write to
+     * @return the number of leading ranges that were read completely, or -1 if there was an error
+     */
+    int readBytesBatch(long[] descriptors, int count, ByteBuffer dst);
+    /**
+     * Writes a batch of ranges to the target VM from a (likely direct) {@link java.nio.ByteBuffer}, taken one after the
+     * other from the start of the buffer. A native implementation writes the whole batch with one call, coalescing the
+     * ranges that fall in the same page, which makes setting or clearing many breakpoints cheap.
+     * @param descriptors the address and length of each range, i.e. {@code descriptors[2 * i]} is the address
+     *            and {@code descriptors[2 * i + 1]} the length of range {@code i}
+     * @param count the number of ranges
+     * @param src the byte buffer to read from
+     * @return the number of leading ranges that were written completely, or -1 if there was an error
+     */
+    int writeBytesBatch(long[] descriptors, int count, ByteBuffer src);
     /**
      * Gathers the set of active threads in the target VM.
      * This avoids explicit types so that different versions of the Inspector types can be used on the two sides
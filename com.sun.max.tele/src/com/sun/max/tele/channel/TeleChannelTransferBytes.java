@@ -54,6 +54,45 @@ public class TeleChannelTransferBytes {
         return length;
     }
 
+    /**
+     * Reads a batch of ranges with one {@link #readBytes} call per range, for a protocol that has no batch primitive.
+     *
+     * @see TeleChannelProtocol#readBytesBatch(long[], int, ByteBuffer)
+     */
+    public static int readBytesBatch(TeleChannelProtocol protocol, long[] descriptors, int count, ByteBuffer dst) {
+        int offset = 0;
+        for (int i = 0; i < count; i++) {
+            final int length = (int) descriptors[2 * i + 1];
+            if (length > 0 && readBytes(protocol, dst, offset, length, Address.fromLong(descriptors[2 * i])) != length) {
+                return i;
+            }
+            offset += length;
+        }
+        return count;
+    }
+
+    /**
+     * Writes a batch of ranges with one {@link TeleChannelProtocol#writeBytes(long, byte[], int, int)} call per range,
+     * for a protocol that has no batch primitive.
+     *
+     * @see TeleChannelProtocol#writeBytesBatch(long[], int, ByteBuffer)
+     */
+    public static int writeBytesBatch(TeleChannelProtocol protocol, long[] descriptors, int count, ByteBuffer src) {
+        final ByteBuffer view = src.duplicate();
+        view.position(0);
+        for (int i = 0; i < count; i++) {
+            final int length = (int) descriptors[2 * i + 1];
+            if (length > 0) {
+                final byte[] bytes = new byte[length];
+                view.get(bytes);
+                if (protocol.writeBytes(descriptors[2 * i], bytes, 0, length) != length) {
+                    return i;
+                }
+            }
+        }
+        return count;
+    }
+
     public static int writeBytes(TeleChannelProtocol protocol, ByteBuffer src, int offset, int length, Address address) {
         int lengthLeft = length;
         int localOffset = offset;
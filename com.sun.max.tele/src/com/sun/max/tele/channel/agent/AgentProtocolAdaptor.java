@@ -23,6 +23,7 @@
 package com.sun.max.tele.channel.agent;
 
 import java.io.*;
+import java.nio.*;
 import java.util.*;
 
 import com.sun.max.tele.channel.*;
@@ -33,9 +34,10 @@ import com.sun.max.tele.util.*;
  * Base class for agent-side implementations of {@link TeleChannelProtocol}.
  *
  */
-public abstract class AgentProtocolAdaptor extends RemoteInvocationProtocolAdaptor implements TeleChannelDataIOProtocol {
+public abstract class AgentProtocolAdaptor extends RemoteInvocationProtocolAdaptor implements TeleChannelDataIOProtocol, BatchedTeleChannelDataIOProtocol {
     private TeleChannelProtocol impl;
     private TeleProcess teleProcess;
+    private ByteBuffer batchBuffer;
 
     /**
      * Create an {@code AgentProtocolAdaptor}.
@@ -46,7 +48,8 @@ public abstract class AgentProtocolAdaptor extends RemoteInvocationProtocolAdapt
         this.impl = impl;
         this.teleProcess = teleProcess;
         setArrayMode("create", 1, ArrayMode.IN);
-        setArrayMode("readBytes", 1, ArrayMode.OUT);
+        setArrayMode("readBytes", 1, ArrayMode.DEFLATED_OUT);
+        setArrayMode("readBytesRanges", 2, ArrayMode.DEFLATED_OUT);
         setArrayMode("writeBytes", 1, ArrayMode.IN);
         setArrayMode("readRegisters", 1, ArrayMode.OUT);
         setArrayMode("readRegisters", 3, ArrayMode.OUT);
@@ -108,6 +111,18 @@ public abstract class AgentProtocolAdaptor extends RemoteInvocationProtocolAdapt
         return impl.readBytes(src, dst, dstOffset, length);
     }
 
+    @Override
+    public int readBytesRanges(long[] descriptors, int count, byte[] dst, int length) {
+        if (batchBuffer == null || batchBuffer.capacity() < length) {
+            batchBuffer = ByteBuffer.allocateDirect(length);
+        }
+        final int result = impl.readBytesBatch(descriptors, count, batchBuffer);
+        final ByteBuffer data = batchBuffer.duplicate();
+        data.position(0);
+        data.get(dst, 0, length);
+        return result;
+    }
+
     @Override
     public boolean readRegisters(long threadId, byte[] integerRegisters, int integerRegistersSize, byte[] floatingPointRegisters, int floatingPointRegistersSize, byte[] stateRegisters,
                     int stateRegistersSize) {
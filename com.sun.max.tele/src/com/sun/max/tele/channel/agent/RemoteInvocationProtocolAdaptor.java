@@ -25,6 +25,7 @@ package com.sun.max.tele.channel.agent;
 import java.io.*;
 import java.lang.reflect.*;
 import java.util.*;
+import java.util.zip.*;
 
 import com.sun.max.tele.channel.*;
 import com.sun.max.tele.channel.iostream.TeleChannelDataIOProtocolImpl.ArrayMode;
@@ -58,6 +59,9 @@ public abstract class RemoteInvocationProtocolAdaptor {
 
     public final Map<String, MethodInfo> methodMap;
 
+    private final Deflater deflater = new Deflater(Deflater.BEST_SPEED);
+    private final byte[] deflateBuffer = new byte[64 * 1024];
+
     protected RemoteInvocationProtocolAdaptor() {
         final List<Class< ? >> interfaces = new ArrayList<Class< ? >>();
         getTeleChannelDataIOProtocolInterfaceMethods(interfaces, this.getClass());
@@ -131,7 +135,7 @@ public abstract class RemoteInvocationProtocolAdaptor {
                 //Trace.line(2, "    array mode: " + mv + ", length: " + length);
                 ArrayMode am = ArrayMode.values()[mv];
                 byte[] data;
-                if (am == ArrayMode.OUT) {
+                if (am == ArrayMode.OUT || am == ArrayMode.DEFLATED_OUT) {
                     // allocate but don't read (output array)
                     data = new byte[length];
                 } else {
@@ -140,6 +144,14 @@ public abstract class RemoteInvocationProtocolAdaptor {
                     in.read(data);
                 }
                 result[index] = data;
+            } else if (klass == long[].class) {
+                in.readInt();
+                final int length = in.readInt();
+                final long[] data = new long[length];
+                for (int i = 0; i < length; i++) {
+                    data[i] = in.readLong();
+                }
+                result[index] = data;
             } else if (klass == String[].class) {
                 final int mv = in.readInt();
                 final int length = in.readInt();
@@ -170,7 +182,9 @@ public abstract class RemoteInvocationProtocolAdaptor {
         // deal with byte arrays as output
         int index = 0;
         for (Class< ? > klass : m.parameterTypes) {
-            if (klass == byte[].class && m.arrayModes[index] != ArrayMode.IN) {
+            if (klass == byte[].class && m.arrayModes[index] == ArrayMode.DEFLATED_OUT) {
+                writeDeflated(out, (byte[]) args[index]);
+            } else if (klass == byte[].class && m.arrayModes[index] != ArrayMode.IN) {
                 out.write((byte[]) args[index]);
             }
             index++;
@@ -191,4 +205,17 @@ public abstract class RemoteInvocationProtocolAdaptor {
         out.flush();
     }
 
+    private void writeDeflated(DataOutputStream out, byte[] data) throws IOException {
+        final ByteArrayOutputStream deflated = new ByteArrayOutputStream();
+        deflater.reset();
+        deflater.setInput(data);
+        deflater.finish();
+        while (!deflater.finished()) {
+            final int n = deflater.deflate(deflateBuffer);
+            deflated.write(deflateBuffer, 0, n);
+        }
+        out.writeInt(deflated.size());
+        deflated.writeTo(out);
+    }
+
 }
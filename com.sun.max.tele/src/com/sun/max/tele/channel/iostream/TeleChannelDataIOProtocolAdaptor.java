@@ -55,6 +55,16 @@ public abstract class TeleChannelDataIOProtocolAdaptor extends TeleChannelDataIO
         return result;
     }
 
+    @Override
+    public int readBytesBatch(long[] descriptors, int count, ByteBuffer dst) {
+        return TeleChannelTransferBytes.readBytesBatch(this, descriptors, count, dst);
+    }
+
+    @Override
+    public int writeBytesBatch(long[] descriptors, int count, ByteBuffer src) {
+        return TeleChannelTransferBytes.writeBytesBatch(this, descriptors, count, src);
+    }
+
     @Override
     public int writeBytes(long dst, ByteBuffer src, int srcOffset, int length) {
         byte[] bytes;
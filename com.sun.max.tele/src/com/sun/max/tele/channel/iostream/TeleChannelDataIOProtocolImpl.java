@@ -23,6 +23,7 @@
 package com.sun.max.tele.channel.iostream;
 
 import java.io.*;
+import java.util.zip.*;
 
 import com.sun.max.program.*;
 import com.sun.max.tele.channel.*;
@@ -40,14 +41,25 @@ import com.sun.max.tele.util.*;
  * precede the method result value.
  *
  * For this to work, the {@link ArrayMode} of a parameter must be registered with {@link RemoteInvocationProtocolAdaptor} by the target end of the communication..
+ *
+ * The memory contents returned by {@link #readBytes} and {@link #readBytesRanges} are registered as {@link ArrayMode#DEFLATED_OUT},
+ * i.e. they are returned compressed with {@link Deflater}, as the pages of a VM heap compress well and the
+ * whole array is returned however few of its bytes were read.
  */
-public class TeleChannelDataIOProtocolImpl implements TeleChannelDataIOProtocol {
+public class TeleChannelDataIOProtocolImpl implements TeleChannelDataIOProtocol, BatchedTeleChannelDataIOProtocol {
     public enum ArrayMode {
         IN,
         OUT,
-        INOUT
+        INOUT,
+        /**
+         * As for {@link #OUT} except that the contents are returned as an {@code int} length followed by that many bytes
+         * of {@link Deflater deflated} data.
+         */
+        DEFLATED_OUT
     }
 
+    private final Inflater inflater = new Inflater();
+
     protected DataInputStream in;
     protected DataOutputStream out;
 
@@ -176,7 +188,7 @@ public class TeleChannelDataIOProtocolImpl implements TeleChannelDataIOProtocol
             out.writeInt(dstOffset);
             out.writeInt(length);
             out.flush();
-            inByteArray(dst, dstOffset, length);
+            inDeflatedByteArray(dst, dstOffset, length);
             final int result = in.readInt();
             return result;
         } catch (IOException ex) {
@@ -185,6 +197,23 @@ public class TeleChannelDataIOProtocolImpl implements TeleChannelDataIOProtocol
         }
     }
 
+    @Override
+    public int readBytesRanges(long[] descriptors, int count, byte[] dst, int length) {
+        try {
+            out.writeUTF("readBytesRanges");
+            outLongArray(descriptors, 2 * count);
+            out.writeInt(count);
+            outByteArray(ArrayMode.OUT, dst);
+            out.writeInt(length);
+            out.flush();
+            inDeflatedByteArray(dst, 0, length);
+            return in.readInt();
+        } catch (IOException ex) {
+            TeleError.unexpected(ex);
+            return -1;
+        }
+    }
+
     @Override
     public boolean readRegisters(long threadId, byte[] integerRegisters, int integerRegistersSize, byte[] floatingPointRegisters, int floatingPointRegistersSize, byte[] stateRegisters,
                     int stateRegistersSize) {
@@ -394,6 +423,37 @@ public class TeleChannelDataIOProtocolImpl implements TeleChannelDataIOProtocol
         System.arraycopy(result, dstOffset, dst, dstOffset, length);
     }
 
+    private void inDeflatedByteArray(byte[] dst, int dstOffset, int length) throws IOException {
+        final byte[] deflated = new byte[in.readInt()];
+        in.readFully(deflated);
+        final byte[] result = new byte[dst.length];
+        inflater.reset();
+        inflater.setInput(deflated);
+        try {
+            int n = 0;
+            while (n < result.length && !inflater.finished()) {
+                final int inflated = inflater.inflate(result, n, result.length - n);
+                if (inflated == 0 && (inflater.needsInput() || inflater.needsDictionary())) {
+                    throw new IOException("truncated deflated array");
+                }
+                n += inflated;
+            }
+        } catch (DataFormatException ex) {
+            throw new IOException(ex);
+        }
+        System.arraycopy(result, dstOffset, dst, dstOffset, length);
+    }
+
+    /**
+     * Writes the first {@code length} elements of an {@link ArrayMode#IN} array of longs.
+     */
+    private void outLongArray(long[] array, int length) throws IOException {
+        out.writeInt(ArrayMode.IN.ordinal());
+        out.writeInt(length);
+        for (int i = 0; i < length; i++) {
+            out.writeLong(array[i]);
+        }
+    }
 
     private void outStringArray(ArrayMode mode, String[] array) throws IOException {
         out.writeInt(mode.ordinal());
@@ -22,6 +22,8 @@
  */
 package com.sun.max.tele.channel.natives;
 
+import java.nio.*;
+
 import com.sun.max.tele.channel.*;
 import com.sun.max.tele.debug.*;
 
@@ -49,7 +51,9 @@ public class TeleChannelNatives {
     public native int waitUntilStopped(long processHandle);
     public native void gatherThreads(long processHandle, Object teleProcess, Object threadList, long tlaList);
     public native int readBytes(long processHandle, long src, Object dst, boolean isDirectByteBuffer, int offset, int length);
+    public native int readBytesBatch(long processHandle, long[] descriptors, int count, ByteBuffer dst);
     public native int writeBytes(long processHandle, long dst, Object src, boolean isDirectByteBuffer, int offset, int length);
+    public native int writeBytesBatch(long processHandle, long[] descriptors, int count, ByteBuffer src);
     public native boolean activateWatchpoint(long processHandle, long start, long size, boolean after, boolean read, boolean write, boolean exec);
     public native boolean deactivateWatchpoint(long processHandle, long start, long size);
     public native long readWatchpointAddress(long processHandle);
@@ -24,6 +24,8 @@ package com.sun.max.tele.channel.tcp;
 
 import java.io.*;
 import java.net.*;
+import java.nio.*;
+
 import com.sun.max.program.*;
 import com.sun.max.tele.channel.*;
 import com.sun.max.tele.channel.iostream.*;
@@ -39,6 +41,7 @@ public class TCPTeleChannelProtocol extends TeleChannelDataIOProtocolAdaptor {
     private final int port;
     private final String host;
     private Socket socket;
+    private int maxByteBufferSize;
 
     public TCPTeleChannelProtocol(String host, int port) {
         this.host = host;
@@ -53,6 +56,54 @@ public class TCPTeleChannelProtocol extends TeleChannelDataIOProtocolAdaptor {
         }
     }
 
+    /**
+     * Reads the ranges with as few {@link #readBytesRanges} round trips to the agent as the
+     * agent's {@link #maxByteBufferSize()} allows.
+     */
+    @Override
+    public int readBytesBatch(long[] descriptors, int count, ByteBuffer dst) {
+        if (maxByteBufferSize == 0) {
+            maxByteBufferSize = maxByteBufferSize();
+        }
+        int done = 0;
+        int offset = 0;
+        while (done < count) {
+            int n = 0;
+            int length = 0;
+            while (done + n < count && length + descriptors[2 * (done + n) + 1] <= maxByteBufferSize) {
+                length += (int) descriptors[2 * (done + n) + 1];
+                n++;
+            }
+            if (n == 0) {
+                // A range larger than the agent's buffer is read in pieces
+                final long[] single = {descriptors[2 * done], descriptors[2 * done + 1]};
+                final ByteBuffer rest = dst.duplicate();
+                rest.position(offset);
+                if (super.readBytesBatch(single, 1, rest.slice()) != 1) {
+                    return done;
+                }
+                offset += (int) single[1];
+                done++;
+                continue;
+            }
+            final long[] batch = new long[2 * n];
+            System.arraycopy(descriptors, 2 * done, batch, 0, 2 * n);
+            final byte[] bytes = new byte[length];
+            final int result = readBytesRanges(batch, n, bytes, length);
+            if (result < 0) {
+                return done == 0 ? -1 : done;
+            }
+            final ByteBuffer data = dst.duplicate();
+            data.position(offset);
+            data.put(bytes, 0, length);
+            if (result < n) {
+                return done + result;
+            }
+            offset += length;
+            done += n;
+        }
+        return count;
+    }
 
     @Override
     public boolean detach() {
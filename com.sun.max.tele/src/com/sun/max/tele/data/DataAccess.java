@@ -84,6 +84,17 @@ public interface DataAccess extends DataIO {
     void writeBytes(Address address, byte[] bytes);
     void writeBuffer(Address address, ByteBuffer buffer);
 
+    /**
+     * Writes a batch of ranges, taken one after the other from the start of a buffer.
+     *
+     * @param descriptors the address and length of each range, i.e. {@code descriptors[2 * i]} is the address
+     *            and {@code descriptors[2 * i + 1]} the length of range {@code i}
+     * @param count the number of ranges
+     * @param buffer the bytes of the ranges
+     * @return the number of leading ranges that were written completely
+     */
+    int writeBatch(long[] descriptors, int count, ByteBuffer buffer);
+
     void writeByte(Address address, byte value);
     void writeByte(Address address, Offset offset, byte value);
     void writeByte(Address address, int offset, byte value);
@@ -210,6 +210,18 @@ public abstract class DataAccessAdapter implements DataAccess {
         writeBuffer(address, ByteBuffer.wrap(bytes));
     }
 
+    public int writeBatch(long[] descriptors, int count, ByteBuffer buffer) {
+        int offset = 0;
+        for (int i = 0; i < count; i++) {
+            final int length = (int) descriptors[2 * i + 1];
+            if (length > 0 && write(buffer, offset, length, Address.fromLong(descriptors[2 * i])) != length) {
+                return i;
+            }
+            offset += length;
+        }
+        return count;
+    }
+
     public void writeByte(Address address, Offset offset, byte value) {
         writeByte(address.plus(offset), value);
     }
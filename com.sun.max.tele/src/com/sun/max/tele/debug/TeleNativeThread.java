@@ -541,6 +541,22 @@ public abstract class TeleNativeThread extends AbstractVmHolder
      */
     protected abstract boolean singleStep();
 
+    /**
+     * Single steps this thread until it reaches {@code target}, leaves the range {@code [rangeStart, rangeEnd)} or
+     * has executed {@code maxSteps} instructions. Platforms that can do this without a round trip to the
+     * debugger for each instruction override this; the default issues a single step.
+     * Note that this method does not block waiting for the tele process to complete stepping.
+     *
+     * @param target the address at which to stop, or zero for none
+     * @param rangeStart start of the range within which to keep stepping
+     * @param rangeEnd end of the range; if not greater than {@code rangeStart}, there is no range
+     * @param maxSteps the maximum number of instructions to execute
+     * @return true if stepping was issued successfully, false otherwise
+     */
+    protected boolean stepUntil(Address target, Address rangeStart, Address rangeEnd, long maxSteps) {
+        return singleStep();
+    }
+
     protected abstract boolean threadResume();
 
     protected abstract boolean threadSuspend();
@@ -62,6 +62,7 @@ public abstract class TeleProcess extends AbstractVmHolder implements TeleVMCach
     private static final String RESUME = "resume";
     private static final String SINGLE_STEP = "singleStep";
     private static final String STEP_OVER = "stepOver";
+    private static final String STEP_UNTIL = "stepUntil";
 
     private static final List<TeleNativeThread> EMPTY_THREAD_LIST = Collections.emptyList();
     private static final List<TeleBreakpointEvent> EMPTY_BREAKPOINTEVENT_LIST = Collections.emptyList();
@@ -561,6 +562,39 @@ public abstract class TeleProcess extends AbstractVmHolder implements TeleVMCach
         Trace.end(TRACE_VALUE + 1, tracePrefix() + SINGLE_STEP + " schedule");
     }
 
+    /**
+     * Causes VM execution of instructions on a specified thread until it reaches a given address, leaves a given
+     * address range or has executed a given number of instructions. The VM is reported as having completed a
+     * single step on the thread.
+     *
+     * @param thread the thread to be executed
+     * @param target the address at which to stop, or zero for none
+     * @param rangeStart start of the range within which to keep stepping
+     * @param rangeEnd end of the range; if not greater than {@code rangeStart}, there is no range
+     * @param maxSteps the maximum number of instructions to execute
+     * @param isSynchronous wait until execution is complete to return?
+     * @throws InvalidVMRequestException
+     * @throws OSExecutionRequestException
+     */
+    public final void stepThreadUntil(final TeleNativeThread thread, final Address target, final Address rangeStart, final Address rangeEnd, final long maxSteps,
+                    boolean isSynchronous) throws InvalidVMRequestException, OSExecutionRequestException {
+        Trace.begin(TRACE_VALUE + 1, tracePrefix() + STEP_UNTIL + " schedule");
+        final TeleEventRequest request = new TeleEventRequest(STEP_UNTIL, thread, false) {
+            @Override
+            public void execute() throws OSExecutionRequestException {
+                Trace.begin(TRACE_VALUE + 1, tracePrefix() + STEP_UNTIL + " perform");
+                updateWatchpointCaches();
+                lastSingleStepThread = thread;
+                if (!thread.stepUntil(target, rangeStart, rangeEnd, maxSteps)) {
+                    throw new OSExecutionRequestException("Error while stepping thread " + thread);
+                }
+                Trace.end(TRACE_VALUE + 1, tracePrefix() + STEP_UNTIL + " perform");
+            }
+        };
+        requestHandlingThread.scheduleRequest(request, isSynchronous);
+        Trace.end(TRACE_VALUE + 1, tracePrefix() + STEP_UNTIL + " schedule");
+    }
+
     /**
      * Steps a single thread to the next instruction in the current method.  If the current
      * instruction is a call, then run until the call returns.
@@ -750,6 +784,30 @@ public abstract class TeleProcess extends AbstractVmHolder implements TeleVMCach
         return bytesRead;
     }
 
+    /**
+     * Reads a batch of ranges from process memory into a buffer, one after the other from the start of the buffer.
+     * This is much cheaper than a {@link #read} per range when the ranges are small.
+     *
+     * @param descriptors the address and length of each range, i.e. {@code descriptors[2 * i]} is the address
+     *            and {@code descriptors[2 * i + 1]} the length of range {@code i}
+     * @param count the number of ranges
+     * @param buffer the buffer into which the ranges are read
+     * @return the number of leading ranges that were read completely
+     */
+    public final int readBatch(long[] descriptors, int count, ByteBuffer buffer) throws DataIOError, TerminatedProcessIOException {
+        if (processState == TERMINATED) {
+            throw new TerminatedProcessIOException("Batch memory read (process TERMINATED)");
+        }
+        if (processState != STOPPED && processState != null && Thread.currentThread() != requestHandlingThread) {
+            throw new DataIOError(Address.zero(), "Reading from process memory while processed not stopped [thread: " + Thread.currentThread().getName() + "]");
+        }
+        final int result = readBatch0(descriptors, count, buffer);
+        if (result < 0) {
+            throw new DataIOError(Address.zero(), "Batch memory read failed");
+        }
+        return result;
+    }
+
     public final int write(ByteBuffer buffer, int offset, int length, Address address) throws DataIOError, IndexOutOfBoundsException, TerminatedProcessIOException {
         if (processState == TERMINATED) {
             final StringBuilder msg = new StringBuilder();
@@ -771,6 +829,28 @@ public abstract class TeleProcess extends AbstractVmHolder implements TeleVMCach
         return write0(buffer, offset, length, address);
     }
 
+    /**
+     * Writes a batch of ranges to process memory, taken one after the other from the start of the buffer.
+     * This is much cheaper than a {@link #write} per range when there are many small ranges, such as the
+     * patches for activating or deactivating every breakpoint.
+     *
+     * @param descriptors the address and length of each range, i.e. {@code descriptors[2 * i]} is the address
+     *            and {@code descriptors[2 * i + 1]} the length of range {@code i}
+     * @param count the number of ranges
+     * @param buffer the buffer holding the bytes of the ranges
+     * @return the number of leading ranges that were written completely
+     */
+    public final int writeBatch(long[] descriptors, int count, ByteBuffer buffer) throws DataIOError, TerminatedProcessIOException {
+        if (processState == TERMINATED) {
+            throw new TerminatedProcessIOException("Batch memory write (process TERMINATED)");
+        }
+        final int result = writeBatch0(descriptors, count, buffer);
+        if (result < 0) {
+            throw new DataIOError(Address.zero(), "Batch memory write failed");
+        }
+        return result;
+    }
+
     /**
      * @return the current state of the process
      */
@@ -1056,6 +1136,24 @@ public abstract class TeleProcess extends AbstractVmHolder implements TeleVMCach
      */
     protected abstract int read0(Address address, ByteBuffer buffer, int offset, int length);
 
+    /**
+     * Reads a batch of ranges from process memory. This implementation reads the ranges one by one with
+     * {@link #read0}; a platform with a vectored read should override it.
+     *
+     * @see #readBatch(long[], int, ByteBuffer)
+     */
+    protected int readBatch0(long[] descriptors, int count, ByteBuffer buffer) {
+        int offset = 0;
+        for (int i = 0; i < count; i++) {
+            final int length = (int) descriptors[2 * i + 1];
+            if (length > 0 && read0(Address.fromLong(descriptors[2 * i]), buffer, offset, length) != length) {
+                return i;
+            }
+            offset += length;
+        }
+        return count;
+    }
+
 
     /**
      * Writes bytes to process memory, platform-specific implementation.
@@ -1076,6 +1174,24 @@ public abstract class TeleProcess extends AbstractVmHolder implements TeleVMCach
      */
     protected abstract int write0(ByteBuffer buffer, int offset, int length, Address address);
 
+    /**
+     * Writes a batch of ranges to process memory. This implementation writes the ranges one by one with
+     * {@link #write0}; a platform with a vectored write should override it.
+     *
+     * @see #writeBatch(long[], int, ByteBuffer)
+     */
+    protected int writeBatch0(long[] descriptors, int count, ByteBuffer buffer) {
+        int offset = 0;
+        for (int i = 0; i < count; i++) {
+            final int length = (int) descriptors[2 * i + 1];
+            if (length > 0 && write0(buffer, offset, length, Address.fromLong(descriptors[2 * i])) != length) {
+                return i;
+            }
+            offset += length;
+        }
+        return count;
+    }
+
     /**
      * Activates a watchpoint in the native process, according to the specified
      * watchpoint configuration.  All watchpoints are by default <strong>after</strong>
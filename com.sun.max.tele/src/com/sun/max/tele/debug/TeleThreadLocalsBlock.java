@@ -29,6 +29,7 @@ import com.sun.max.program.*;
 import com.sun.max.tele.*;
 import com.sun.max.tele.memory.*;
 import com.sun.max.tele.object.*;
+import com.sun.max.tele.thread.*;
 import com.sun.max.tele.util.*;
 import com.sun.max.unsafe.*;
 import com.sun.max.vm.runtime.*;
@@ -254,6 +255,28 @@ public final class TeleThreadLocalsBlock extends AbstractVmHolder implements Tel
         return teleVmThread;
     }
 
+    /**
+     * Gets the number of traps of each kind (indexed by {@link Trap.Count#ordinal()}) taken by this thread,
+     * as counted by the native trap handler.
+     *
+     * @return the trap counts or {@code null} if the thread has no thread locals
+     */
+    public long[] trapCounts() {
+        final TeleThreadLocalsArea enabledThreadLocalsArea = tlaFor(SafepointPoll.State.ENABLED);
+        if (enabledThreadLocalsArea == null) {
+            return null;
+        }
+        final Address ntl = enabledThreadLocalsArea.getWord(VmThreadLocal.NATIVE_THREAD_LOCALS).asAddress();
+        if (ntl.isZero()) {
+            return null;
+        }
+        final long[] counts = new long[Trap.Count.VALUES.size()];
+        for (Trap.Count count : Trap.Count.VALUES) {
+            counts[count.ordinal()] = memory().readWord(ntl.plus(NativeThreadLocal.TRAP_COUNTS.offset + count.ordinal() * Word.size())).asAddress().toLong();
+        }
+        return counts;
+    }
+
     /**
      * Update any state related to this thread locals area, based on possibly more information having been acquired.
      *
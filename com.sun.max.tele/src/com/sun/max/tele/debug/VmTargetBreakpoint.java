@@ -25,6 +25,7 @@ package com.sun.max.tele.debug;
 import static com.sun.max.platform.Platform.*;
 
 import java.io.*;
+import java.nio.*;
 import java.util.*;
 import java.util.concurrent.*;
 
@@ -607,19 +608,19 @@ public abstract class VmTargetBreakpoint extends VmBreakpoint {
          */
         void setActiveAll(boolean active) {
             assert vm().lockHeldByCurrentThread();
+            final List<VmTargetBreakpoint> breakpoints = new ArrayList<VmTargetBreakpoint>();
             for (VmTargetBreakpoint breakpoint : clientBreakpoints.values()) {
                 if (breakpoint.isEnabled()) {
-                    breakpoint.setActive(active);
+                    breakpoints.add(breakpoint);
                 }
             }
             for (VmTargetBreakpoint breakpoint : systemBreakpoints.values()) {
                 if (breakpoint.isEnabled()) {
-                    breakpoint.setActive(active);
+                    breakpoints.add(breakpoint);
                 }
             }
-            for (VmTargetBreakpoint breakpoint : transientBreakpoints.values()) {
-                breakpoint.setActive(active);
-            }
+            breakpoints.addAll(transientBreakpoints.values());
+            setActive(breakpoints, active);
         }
 
         /**
@@ -632,13 +633,64 @@ public abstract class VmTargetBreakpoint extends VmBreakpoint {
          */
         void setActiveNonClient(boolean active) {
             assert vm().lockHeldByCurrentThread();
+            final List<VmTargetBreakpoint> breakpoints = new ArrayList<VmTargetBreakpoint>();
             for (VmTargetBreakpoint breakpoint : systemBreakpoints.values()) {
                 if (breakpoint.isEnabled()) {
-                    breakpoint.setActive(active);
+                    breakpoints.add(breakpoint);
+                }
+            }
+            breakpoints.addAll(transientBreakpoints.values());
+            setActive(breakpoints, active);
+        }
+
+        /**
+         * Sets the activation state of a number of target breakpoints in the VM, patching the code of all
+         * those whose state changes with a single batched write to VM memory.
+         * <br>
+         * Assumes VM lock held
+         *
+         * @param breakpoints the breakpoints to update
+         * @param active new activation state for the breakpoints
+         * @see VmTargetBreakpoint#setActive(boolean)
+         */
+        private void setActive(List<VmTargetBreakpoint> breakpoints, boolean active) {
+            final List<VmTargetBreakpoint> changing = new ArrayList<VmTargetBreakpoint>(breakpoints.size());
+            for (VmTargetBreakpoint breakpoint : breakpoints) {
+                if (breakpoint.isActive() != active) {
+                    changing.add(breakpoint);
                 }
             }
-            for (VmTargetBreakpoint breakpoint : transientBreakpoints.values()) {
-                breakpoint.setActive(active);
+            if (changing.size() <= 1) {
+                for (VmTargetBreakpoint breakpoint : changing) {
+                    breakpoint.setActive(active);
+                }
+                return;
+            }
+            final int count = changing.size();
+            final long[] descriptors = new long[2 * count];
+            final Address[] addresses = new Address[count];
+            int size = 0;
+            for (int i = 0; i < count; i++) {
+                final VmTargetBreakpoint breakpoint = changing.get(i);
+                addresses[i] = active ? breakpoint.codeLocation().address() : breakpoint.activeAddress;
+                final int length = active ? codeSize() : breakpoint.originalCodeAtBreakpoint.length;
+                descriptors[2 * i] = addresses[i].toLong();
+                descriptors[2 * i + 1] = length;
+                size += length;
+            }
+            final ByteBuffer buffer = ByteBuffer.allocateDirect(size);
+            for (VmTargetBreakpoint breakpoint : changing) {
+                buffer.put(active ? code() : breakpoint.originalCodeAtBreakpoint);
+            }
+            final int written = memory().access().writeBatch(descriptors, count, buffer);
+            for (int i = 0; i < count; i++) {
+                final VmTargetBreakpoint breakpoint = changing.get(i);
+                if (i < written) {
+                    breakpoint.activeAddress = active ? addresses[i] : null;
+                } else {
+                    // Patch the rest one at a time so that a failure is reported for the breakpoint concerned
+                    breakpoint.setActive(active);
+                }
             }
         }
 
@@ -25,6 +25,7 @@ package com.sun.max.tele.debug.dump;
 import static com.oracle.max.elf.ELFProgramHeaderTable.*;
 
 import java.io.*;
+import java.nio.*;
 
 import com.oracle.max.elf.*;
 import com.sun.max.program.*;
@@ -42,6 +43,11 @@ public class ELFDumpTeleChannelProtocolAdaptor extends TeleChannelDataIOProtocol
     protected int tlaSize;
     public boolean bigEndian;
     protected RandomAccessFile dumpRaf;
+    /**
+     * Handle to the native mapping of the dump file through which memory is read, or 0 if the file
+     * could not be mapped, in which case memory is read with {@link #dumpRaf}.
+     */
+    protected long coreHandle;
     protected ELFHeader header;
     protected ELFProgramHeaderTable programHeaderTable;
     protected ELFSymbolLookup symbolLookup;
@@ -58,6 +64,7 @@ public class ELFDumpTeleChannelProtocolAdaptor extends TeleChannelDataIOProtocol
             dumpRaf = new RandomAccessFile(dump, "r");
             this.header = ELFLoader.readELFHeader(dumpRaf);
             this.programHeaderTable = ELFLoader.readPHT(dumpRaf, header);
+            coreHandle = nativeOpenCore(dump.getAbsolutePath());
             // This is not needed currently as we cannot look up symbols from shared libraries.
             //symbolLookup = new ELFSymbolLookup(new File(vm.getParent(), "libjvm.so"));
         } catch (Exception ex) {
@@ -233,6 +240,10 @@ public class ELFDumpTeleChannelProtocolAdaptor extends TeleChannelDataIOProtocol
 
     @Override
     public boolean detach() {
+        if (coreHandle != 0) {
+            nativeCloseCore(coreHandle);
+            coreHandle = 0;
+        }
         return true;
     }
 
@@ -243,6 +254,9 @@ public class ELFDumpTeleChannelProtocolAdaptor extends TeleChannelDataIOProtocol
 
     @Override
     public int readBytes(long src, byte[] dst, int dstOffset, int length) {
+        if (coreHandle != 0) {
+            return nativeReadBytes(coreHandle, src, dst, false, dstOffset, length);
+        }
         final ELFProgramHeaderTable.Entry64 entry64 = findAddress(src);
         if (entry64 == null) {
             return 0;
@@ -256,6 +270,25 @@ public class ELFDumpTeleChannelProtocolAdaptor extends TeleChannelDataIOProtocol
 
     }
 
+    @Override
+    public int readBytes(long src, ByteBuffer dst, int dstOffset, int length) {
+        if (coreHandle != 0) {
+            if (dst.isDirect()) {
+                return nativeReadBytes(coreHandle, src, dst, true, dstOffset, length);
+            }
+            return nativeReadBytes(coreHandle, src, dst.array(), false, dst.arrayOffset() + dstOffset, length);
+        }
+        return super.readBytes(src, dst, dstOffset, length);
+    }
+
+    @Override
+    public int readBytesBatch(long[] descriptors, int count, ByteBuffer dst) {
+        if (coreHandle != 0 && dst.isDirect()) {
+            return nativeReadBytesBatch(coreHandle, descriptors, count, dst);
+        }
+        return super.readBytesBatch(descriptors, count, dst);
+    }
+
     @Override
     public boolean readRegisters(long threadId, byte[] integerRegisters, int integerRegistersSize, byte[] floatingPointRegisters, int floatingPointRegistersSize, byte[] stateRegisters,
                     int stateRegistersSize) {
@@ -357,6 +390,11 @@ public class ELFDumpTeleChannelProtocolAdaptor extends TeleChannelDataIOProtocol
         return null;
     }
 
+    private static native long nativeOpenCore(String path);
+    private static native void nativeCloseCore(long coreHandle);
+    private static native int nativeReadBytes(long coreHandle, long src, Object dst, boolean isDirectByteBuffer, int dstOffset, int length);
+    private static native int nativeReadBytesBatch(long coreHandle, long[] descriptors, int count, ByteBuffer dst);
+
     protected static void inappropriate(String methodName) {
         TeleError.unexpected("method: " + methodName + " should not be called in dump mode");
     }
@@ -51,6 +51,33 @@ public class LinuxNativeTeleChannelProtocol extends UnixNativeTeleChannelProtoco
     private LinuxTask leaderTask;
     private Map<Integer, LinuxTask> taskMap = new HashMap<Integer, LinuxTask>();
 
+    /**
+     * The layout of a record in {@link #registerSnapshot}: its size followed by the offsets of the task id,
+     * the valid flag and the integer, floating point and state registers.
+     */
+    private static final int[] registerSnapshotLayout = new int[6];
+    private static final int SNAPSHOT_SIZE = 0;
+    private static final int SNAPSHOT_TID = 1;
+    private static final int SNAPSHOT_VALID = 2;
+    private static final int SNAPSHOT_INTEGER_REGISTERS = 3;
+    private static final int SNAPSHOT_FLOATING_POINT_REGISTERS = 4;
+    private static final int SNAPSHOT_STATE_REGISTERS = 5;
+
+    /**
+     * The registers of all tasks, captured natively by {@link #gatherThreads} when the process stopped. Register
+     * reads are served from here until the process is resumed or a task's registers are changed.
+     */
+    private ByteBuffer registerSnapshot;
+
+    /**
+     * Maps a task id to the offset of its record in {@link #registerSnapshot}, or {@code null} if there is no valid snapshot.
+     */
+    private Map<Integer, Integer> registerSnapshotOffsets;
+
+    private void invalidateRegisterSnapshot() {
+        registerSnapshotOffsets = null;
+    }
+
     private LinuxTask task(long ltid) {
         final int tid = (int) ltid;
         LinuxTask result = taskMap.get(tid);
@@ -89,6 +116,14 @@ public class LinuxNativeTeleChannelProtocol extends UnixNativeTeleChannelProtoco
         return leaderTask.readBytes(src, dst.array(), false, dst.arrayOffset() + dstOffset, length);
     }
 
+    @Override
+    public int readBytesBatch(long[] descriptors, int count, ByteBuffer dst) {
+        if (dst.isDirect()) {
+            return leaderTask.readBytesBatch(descriptors, count, dst);
+        }
+        return TeleChannelTransferBytes.readBytesBatch(this, descriptors, count, dst);
+    }
+
     @Override
     public int writeBytes(long dst, byte[] src, int srcOffset, int length) {
         return leaderTask.writeBytes(dst, src, false, srcOffset, length);
@@ -102,20 +137,46 @@ public class LinuxNativeTeleChannelProtocol extends UnixNativeTeleChannelProtoco
         return leaderTask.writeBytes(dst, src.array(), false, src.arrayOffset() + srcOffset, length);
     }
 
+    @Override
+    public int writeBytesBatch(long[] descriptors, int count, ByteBuffer src) {
+        if (src.isDirect()) {
+            return leaderTask.writeBytesBatch(descriptors, count, src);
+        }
+        return TeleChannelTransferBytes.writeBytesBatch(this, descriptors, count, src);
+    }
+
 
     @Override
     public boolean gatherThreads(final Object teleDomain, final Object threadList, final long tlaList) {
         final LinuxTeleVM teleVM = (teleDomain instanceof LinuxTeleProcess) ? (LinuxTeleVM) ((LinuxTeleProcess) teleDomain).vm() : null;
+        invalidateRegisterSnapshot();
+        if (registerSnapshot == null) {
+            nativeRegisterSnapshotLayout(registerSnapshotLayout);
+            registerSnapshot = ByteBuffer.allocateDirect(16 * registerSnapshotLayout[SNAPSHOT_SIZE]).order(ByteOrder.nativeOrder());
+        }
         try {
             if (teleVM != null) {
                 teleVM.handOverVMLock();
             }
-            SingleThread.executeWithException(new Function<Void>() {
-                public Void call() throws IOException {
-                    nativeGatherThreads(leaderTask.tgid(), teleDomain, threadList, tlaList);
-                    return null;
+            final int taskCount = SingleThread.executeWithException(new Function<Integer>() {
+                public Integer call() throws IOException {
+                    return nativeGatherThreads(leaderTask.tgid(), teleDomain, threadList, tlaList, registerSnapshot);
                 }
             });
+            final int recordSize = registerSnapshotLayout[SNAPSHOT_SIZE];
+            final int recordCount = Math.min(taskCount, registerSnapshot.capacity() / recordSize);
+            final Map<Integer, Integer> offsets = new HashMap<Integer, Integer>();
+            for (int i = 0; i < recordCount; i++) {
+                final int offset = i * recordSize;
+                if (registerSnapshot.getInt(offset + registerSnapshotLayout[SNAPSHOT_VALID]) != 0) {
+                    offsets.put(registerSnapshot.getInt(offset + registerSnapshotLayout[SNAPSHOT_TID]), offset);
+                }
+            }
+            registerSnapshotOffsets = offsets;
+            if (taskCount > recordCount) {
+                // Tasks that did not fit are read individually for this stop and captured from the next one
+                registerSnapshot = ByteBuffer.allocateDirect(2 * taskCount * recordSize).order(ByteOrder.nativeOrder());
+            }
         } catch (Exception exception) {
             exception.printStackTrace();
         } finally {
@@ -129,21 +190,48 @@ public class LinuxNativeTeleChannelProtocol extends UnixNativeTeleChannelProtoco
     @Override
     public boolean readRegisters(long threadId, byte[] integerRegisters, int integerRegistersSize, byte[] floatingPointRegisters, int floatingPointRegistersSize, byte[] stateRegisters,
                     int stateRegistersSize) {
+        final Map<Integer, Integer> offsets = registerSnapshotOffsets;
+        final Integer offset = offsets == null ? null : offsets.get((int) threadId);
+        if (offset != null) {
+            final ByteBuffer snapshot = registerSnapshot.duplicate();
+            snapshot.position(offset + registerSnapshotLayout[SNAPSHOT_INTEGER_REGISTERS]);
+            snapshot.get(integerRegisters, 0, integerRegistersSize);
+            snapshot.position(offset + registerSnapshotLayout[SNAPSHOT_FLOATING_POINT_REGISTERS]);
+            snapshot.get(floatingPointRegisters, 0, floatingPointRegistersSize);
+            snapshot.position(offset + registerSnapshotLayout[SNAPSHOT_STATE_REGISTERS]);
+            snapshot.get(stateRegisters, 0, stateRegistersSize);
+            return true;
+        }
         return task(threadId).readRegisters(integerRegisters, floatingPointRegisters, stateRegisters);
     }
 
     @Override
     public boolean setInstructionPointer(long threadId, long ip) {
+        invalidateRegisterSnapshot();
         return task(threadId).setInstructionPointer(ip);
     }
 
     @Override
     public boolean singleStep(long threadId) {
+        invalidateRegisterSnapshot();
         return task(threadId).singleStep();
     }
 
+    /**
+     * Single steps a thread until it reaches a given address or leaves a given range, without returning to the
+     * debugger between instructions.
+     *
+     * @see LinuxTask#stepUntil(long, long, long, long)
+     * @return true if stepping was issued successfully, false otherwise
+     */
+    public boolean stepUntil(long threadId, long target, long rangeStart, long rangeEnd, long maxSteps) {
+        invalidateRegisterSnapshot();
+        return task(threadId).stepUntil(target, rangeStart, rangeEnd, maxSteps) != LinuxTask.STEP_UNTIL_ERROR;
+    }
+
     @Override
     public boolean resumeAll() {
+        invalidateRegisterSnapshot();
         try {
             leaderTask.resume(true);
             return true;
@@ -172,6 +260,26 @@ public class LinuxNativeTeleChannelProtocol extends UnixNativeTeleChannelProtoco
         return false;
     }
 
+    @Override
+    public boolean activateWatchpoint(long start, long size, boolean after, boolean read, boolean write, boolean exec) {
+        return leaderTask.activateWatchpoint(start, size, after, read, write, exec);
+    }
+
+    @Override
+    public boolean deactivateWatchpoint(long start, long size) {
+        return leaderTask.deactivateWatchpoint(start, size);
+    }
+
+    @Override
+    public long readWatchpointAddress() {
+        return leaderTask.readWatchpointAddress();
+    }
+
+    @Override
+    public int readWatchpointAccessCode() {
+        return leaderTask.readWatchpointAccessCode();
+    }
+
     @Override
     public int waitUntilStoppedAsInt() {
         final ProcessState result = waitUntilStopped();
@@ -189,6 +297,7 @@ public class LinuxNativeTeleChannelProtocol extends UnixNativeTeleChannelProtoco
 
     @Override
     public boolean kill() {
+        invalidateRegisterSnapshot();
         try {
             leaderTask.kill();
             return true;
@@ -197,7 +306,9 @@ public class LinuxNativeTeleChannelProtocol extends UnixNativeTeleChannelProtoco
         }
     }
 
-    private static native void nativeGatherThreads(long pid, Object teleProcess, Object threadList, long tlaList);
+    private static native int nativeGatherThreads(long pid, Object teleProcess, Object threadList, long tlaList, ByteBuffer registers);
+
+    private static native void nativeRegisterSnapshotLayout(int[] layout);
 
 
 }
@@ -32,7 +32,6 @@ import com.sun.max.lang.*;
 import com.sun.max.tele.data.*;
 import com.sun.max.tele.debug.*;
 import com.sun.max.tele.util.*;
-import com.sun.max.unsafe.*;
 import com.sun.max.util.*;
 
 /**
@@ -233,6 +232,37 @@ public final class LinuxTask {
         });
     }
 
+    /**
+     * Reasons returned by {@link #stepUntil}; must match the STEP_UNTIL_* values in linuxTask.c.
+     */
+    public static final int STEP_UNTIL_ERROR = -1;
+    public static final int STEP_UNTIL_TARGET = 0;
+    public static final int STEP_UNTIL_LEFT_RANGE = 1;
+    public static final int STEP_UNTIL_LIMIT = 2;
+    public static final int STEP_UNTIL_TRAPPED = 3;
+    public static final int STEP_UNTIL_PENDING = 4;
+
+    private static native int nativeStepUntil(int tgid, int tid, long target, long rangeStart, long rangeEnd, long maxSteps);
+
+    /**
+     * Single steps this task natively until it reaches {@code target}, leaves the range {@code [rangeStart, rangeEnd)}
+     * or has executed {@code maxSteps} instructions, whichever comes first. The task is left stopped unless some event
+     * other than a single step trap occurred, in which case the event is reported by the next {@link #waitUntilStopped}.
+     *
+     * @param target the address at which to stop, or 0 for none
+     * @param rangeStart start of the range within which to keep stepping
+     * @param rangeEnd end of the range; if not greater than {@code rangeStart}, no range check is made
+     * @param maxSteps the maximum number of instructions to execute
+     * @return one of the {@code STEP_UNTIL_*} reasons
+     */
+    public int stepUntil(final long target, final long rangeStart, final long rangeEnd, final long maxSteps) {
+        return execute(new Function<Integer>() {
+            public Integer call() throws Exception {
+                return nativeStepUntil(tgid, tid, target, rangeStart, rangeEnd, maxSteps);
+            }
+        });
+    }
+
     private static native boolean nativeResume(int tgid, int tid, boolean allTasks);
 
     public void resume(final boolean allTasks) throws OSExecutionRequestException {
@@ -306,13 +336,6 @@ public final class LinuxTask {
         }
     }
 
-    /**
-     * The file in /proc through which the memory of this task can be read. As Linux does not
-     * support writing to the memory of a process via /proc, it's still necessary to use
-     * ptrace for {@linkplain #writeBytes(long, Object, boolean, int, int) writing}.
-     */
-    private RandomAccessFile memory;
-
     /**
      * Copies bytes from the tele process into a given {@linkplain ByteBuffer#isDirect() direct ByteBuffer} or byte
      * array.
@@ -332,25 +355,32 @@ public final class LinuxTask {
             return leader().readBytes(src, dst, isDirectByteBuffer, offset, length);
         }
         assert src != 0;
+        // The native read serves the pages read earlier in the current stop from the tele page cache (see pageCache.h)
         return execute(new Function<Integer>() {
             public Integer call() throws Exception {
-                final long addr = src;
-                if (addr < 0) {
-                    // RandomAccessFile.see() can't handle unsigned long offsets: have to resort to a JNI call
-                    return nativeReadBytes(tgid, tid, addr, dst, isDirectByteBuffer, offset, length);
-                } else {
-                    if (memory == null) {
-                        memory = new RandomAccessFile("/proc/" + tgid() + "/mem", "r");
-                    }
-                    try {
-                        final ByteBuffer dstDup = dst instanceof ByteBuffer ? ((ByteBuffer) dst).duplicate() : ByteBuffer.wrap((byte[]) dst);
-                        final ByteBuffer dstView = (ByteBuffer) dstDup.position(offset).limit(offset + length);
-                        dstView.position(offset);
-                        return memory.getChannel().read(dstView, addr);
-                    } catch (IOException ioException) {
-                        throw new DataIOError(Address.fromLong(src), ioException.toString());
-                    }
-                }
+                return nativeReadBytes(tgid, tid, src, dst, isDirectByteBuffer, offset, length);
+            }
+        });
+    }
+
+    /**
+     * Copies a batch of ranges from the tele process into a {@linkplain ByteBuffer#isDirect() direct ByteBuffer}
+     * with a single vectored read.
+     *
+     * @param descriptors the address and length of each range
+     * @param count the number of ranges
+     * @param dst the buffer into which the ranges are copied one after the other
+     * @return the number of leading ranges that were copied completely or -1 if there was an error
+     */
+    private static native int nativeReadBytesBatch(int tgid, int tid, long[] descriptors, int count, ByteBuffer dst);
+
+    public int readBytesBatch(final long[] descriptors, final int count, final ByteBuffer dst) {
+        if (!isLeader()) {
+            return leader().readBytesBatch(descriptors, count, dst);
+        }
+        return execute(new Function<Integer>() {
+            public Integer call() throws Exception {
+                return nativeReadBytesBatch(tgid, tid, descriptors, count, dst);
             }
         });
     }
@@ -376,6 +406,28 @@ public final class LinuxTask {
         });
     }
 
+    /**
+     * Copies a batch of ranges from a {@linkplain ByteBuffer#isDirect() direct ByteBuffer} into the tele process
+     * with as few system calls as possible.
+     *
+     * @param descriptors the address and length of each range
+     * @param count the number of ranges
+     * @param src the buffer holding the ranges one after the other
+     * @return the number of leading ranges that were copied completely or -1 if there was an error
+     */
+    private static native int nativeWriteBytesBatch(int tgid, int tid, long[] descriptors, int count, ByteBuffer src);
+
+    public int writeBytesBatch(final long[] descriptors, final int count, final ByteBuffer src) {
+        if (!isLeader()) {
+            return leader().writeBytesBatch(descriptors, count, src);
+        }
+        return execute(new Function<Integer>() {
+            public Integer call() throws Exception {
+                return nativeWriteBytesBatch(tgid, tid, descriptors, count, src);
+            }
+        });
+    }
+
     private static native boolean nativeSetInstructionPointer(int tid, long instructionPointer);
 
     public boolean setInstructionPointer(final long instructionPointer) {
@@ -404,13 +456,73 @@ public final class LinuxTask {
         });
     }
 
-    public void close() {
-        if (memory != null) {
-            try {
-                memory.close();
-            } catch (IOException ioException) {
-                ioException.printStackTrace();
+    private static native int nativeWatchpointCount();
+
+    /**
+     * Gets the number of hardware watchpoints that can be active at once, which is 0 if they are not supported.
+     */
+    public static int watchpointCount() {
+        return nativeWatchpointCount();
+    }
+
+    private static native boolean nativeActivateWatchpoint(int tgid, long address, long size, boolean after, boolean read, boolean write, boolean exec);
+
+    /**
+     * Activates a hardware watchpoint on a memory range in all tasks of this task's process.
+     */
+    public boolean activateWatchpoint(final long address, final long size, final boolean after, final boolean read, final boolean write, final boolean exec) {
+        return execute(new Function<Boolean>() {
+            public Boolean call() throws Exception {
+                return nativeActivateWatchpoint(tgid, address, size, after, read, write, exec);
             }
-        }
+        });
+    }
+
+    private static native boolean nativeDeactivateWatchpoint(int tgid, long address, long size);
+
+    /**
+     * Deactivates the hardware watchpoint on a memory range in all tasks of this task's process.
+     */
+    public boolean deactivateWatchpoint(final long address, final long size) {
+        return execute(new Function<Boolean>() {
+            public Boolean call() throws Exception {
+                return nativeDeactivateWatchpoint(tgid, address, size);
+            }
+        });
+    }
+
+    private static native long nativeReadWatchpointAddress();
+
+    /**
+     * Gets the address of the watched word that stopped the process, or 0 if it was not stopped by a watchpoint.
+     */
+    public long readWatchpointAddress() {
+        return execute(new Function<Long>() {
+            public Long call() throws Exception {
+                return nativeReadWatchpointAddress();
+            }
+        });
+    }
+
+    private static native int nativeReadWatchpointAccessCode();
+
+    /**
+     * Gets the access code of the watchpoint that stopped the process, or 0 if it was not stopped by a watchpoint.
+     */
+    public int readWatchpointAccessCode() {
+        return execute(new Function<Integer>() {
+            public Integer call() throws Exception {
+                return nativeReadWatchpointAccessCode();
+            }
+        });
+    }
+
+    /**
+     * Releases the native resources used to access the memory of the tele process.
+     */
+    private static native void nativeClose();
+
+    public void close() {
+        nativeClose();
     }
 }
@@ -65,6 +65,14 @@ public class LinuxTeleNativeThread extends TeleNativeThread {
         return protocol.singleStep(tid());
     }
 
+    @Override
+    protected boolean stepUntil(Address target, Address rangeStart, Address rangeEnd, long maxSteps) {
+        if (protocol instanceof LinuxNativeTeleChannelProtocol) {
+            return ((LinuxNativeTeleChannelProtocol) protocol).stepUntil(tid(), target.toLong(), rangeStart.toLong(), rangeEnd.toLong(), maxSteps);
+        }
+        return super.stepUntil(target, rangeStart, rangeEnd, maxSteps);
+    }
+
     @Override
     protected boolean threadResume() {
         throw TeleError.unimplemented();
@@ -55,4 +55,13 @@ public final class LinuxTeleProcess extends UnixTeleProcessAdaptor {
         return new LinuxTeleNativeThread(this, params);
     }
 
+    @Override
+    public int platformWatchpointCount() {
+        // Hardware watchpoints are only available when the process is controlled directly with ptrace
+        if (TeleVM.teleChannelProtocol() instanceof LinuxNativeTeleChannelProtocol) {
+            return LinuxTask.watchpointCount();
+        }
+        return 0;
+    }
+
 }
@@ -184,12 +184,24 @@ public class ReadOnlyTeleChannelProtocol implements TeleChannelProtocol {
         return 0;
     }
 
+    @Override
+    public int readBytesBatch(long[] descriptors, int count, ByteBuffer dst) {
+        unexpected();
+        return 0;
+    }
+
     @Override
     public int writeBytes(long dst, ByteBuffer src, int srcOffset, int length) {
         unexpected();
         return 0;
     }
 
+    @Override
+    public int writeBytesBatch(long[] descriptors, int count, ByteBuffer src) {
+        unexpected();
+        return 0;
+    }
+
     @Override
     public boolean gatherThreads(Object teleDomain, Object threadList, long tlaList) {
         unexpected();
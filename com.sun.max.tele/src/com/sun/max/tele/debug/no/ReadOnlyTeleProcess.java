@@ -83,15 +83,28 @@ public final class ReadOnlyTeleProcess extends TeleProcess {
      * @throws IOException if an IO error occurs while performing the memory mapping
      */
     private DataAccess map(File bootImageFile, BootImage bootImage) throws IOException {
-        final RandomAccessFile randomAccessFile = new RandomAccessFile(bootImageFile, "rwd");
         final Header header = bootImage.header;
         int heapOffset = bootImage.heapOffset();
         int heapAndCodeSize = header.heapSize + header.codeSize;
+        File heapAndCodeFile = bootImageFile;
+        if (header.isCompressed()) {
+            // Map the decompressed heap and code from a temporary file instead
+            heapAndCodeFile = File.createTempFile("maxine-heap-and-code", null);
+            heapAndCodeFile.deleteOnExit();
+            final FileOutputStream outputStream = new FileOutputStream(heapAndCodeFile);
+            final ByteBuffer heapAndCode = bootImage.heapAndCode();
+            final byte[] data = new byte[heapAndCode.limit()];
+            heapAndCode.get(data);
+            outputStream.write(data);
+            outputStream.close();
+            heapOffset = 0;
+        }
+        final RandomAccessFile randomAccessFile = new RandomAccessFile(heapAndCodeFile, "rwd");
         final MappedByteBuffer bootImageBuffer = randomAccessFile.getChannel().map(MapMode.PRIVATE, heapOffset, heapAndCodeSize);
         bootImageBuffer.order(platform().endianness().asByteOrder());
         randomAccessFile.close();
 
-        if (heapPointer.isNotZero()) {
+        if (heapPointer.isNotZero() || header.preferredHeapAddress() != 0L) {
             long address = (Long) WithoutAccessCheck.getInstanceField(bootImageBuffer, "address");
             bootImage.relocate(address, heapPointer);
         }
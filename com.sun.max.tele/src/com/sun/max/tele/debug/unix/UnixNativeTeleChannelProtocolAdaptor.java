@@ -214,6 +214,14 @@ public class UnixNativeTeleChannelProtocolAdaptor implements TeleChannelProtocol
         return natives.readBytes(processHandle, src, dst.array(), false, dst.arrayOffset() + dstOffset, length);
     }
 
+    @Override
+    public int readBytesBatch(long[] descriptors, int count, ByteBuffer dst) {
+        if (dst.isDirect()) {
+            return natives.readBytesBatch(processHandle, descriptors, count, dst);
+        }
+        return TeleChannelTransferBytes.readBytesBatch(this, descriptors, count, dst);
+    }
+
     @Override
     public int writeBytes(long dst, ByteBuffer src, int srcOffset, int length) {
         if (src.isDirect()) {
@@ -222,6 +230,14 @@ public class UnixNativeTeleChannelProtocolAdaptor implements TeleChannelProtocol
         return natives.writeBytes(processHandle, dst, src.array(), false, src.arrayOffset() + srcOffset, length);
     }
 
+    @Override
+    public int writeBytesBatch(long[] descriptors, int count, ByteBuffer src) {
+        if (src.isDirect()) {
+            return natives.writeBytesBatch(processHandle, descriptors, count, src);
+        }
+        return TeleChannelTransferBytes.writeBytesBatch(this, descriptors, count, src);
+    }
+
     @Override
     public boolean gatherThreads(Object teleDomain, Object threadList, long tlaList) {
         natives.gatherThreads(processHandle, teleDomain, threadList, tlaList);
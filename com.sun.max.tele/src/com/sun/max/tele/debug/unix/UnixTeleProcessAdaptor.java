@@ -130,11 +130,21 @@ public abstract class UnixTeleProcessAdaptor extends TeleProcess {
         return TeleChannelTransferBytes.readBytes(protocol, dst, offset, length, src);
     }
 
+    @Override
+    protected int readBatch0(long[] descriptors, int count, ByteBuffer buffer) {
+        return protocol.readBytesBatch(descriptors, count, buffer);
+    }
+
     @Override
     protected int write0(ByteBuffer src, int offset, int length, Address dst) {
         return TeleChannelTransferBytes.writeBytes(protocol, src, offset, length, dst);
     }
 
+    @Override
+    protected int writeBatch0(long[] descriptors, int count, ByteBuffer buffer) {
+        return protocol.writeBytesBatch(descriptors, count, buffer);
+    }
+
     @Override
     public int platformWatchpointCount() {
         return 0;
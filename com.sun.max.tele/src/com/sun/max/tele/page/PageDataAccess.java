@@ -161,6 +161,18 @@ public class PageDataAccess extends DataAccessAdapter {
         }
     }
 
+    @Override
+    public synchronized int writeBatch(long[] descriptors, int count, ByteBuffer buffer) {
+        try {
+            for (int i = 0; i < count; i++) {
+                invalidateForWrite(Address.fromLong(descriptors[2 * i]), (int) descriptors[2 * i + 1]);
+            }
+            return teleIO.writeBatch(descriptors, count, buffer);
+        } catch (TerminatedProcessIOException e) {
+            return count;
+        }
+    }
+
     public synchronized void writeByte(Address address, byte value) {
         try {
             invalidateForWrite(address, Bytes.SIZE);
@@ -22,6 +22,8 @@
  */
 package com.sun.max.tele.page;
 
+import java.nio.*;
+
 import com.sun.max.tele.data.*;
 import com.sun.max.unsafe.*;
 
@@ -40,4 +42,12 @@ public interface TeleIO extends DataIO {
      * @return the number of times the I/O source/destination has been modified.
      */
     long epoch();
+
+    /**
+     * Writes a batch of ranges, taken one after the other from the start of a buffer, with as few
+     * transfers to the destination as possible.
+     *
+     * @see DataAccess#writeBatch(long[], int, java.nio.ByteBuffer)
+     */
+    int writeBatch(long[] descriptors, int count, ByteBuffer buffer);
 }
@@ -22,6 +22,7 @@
  */
 package com.sun.max.tele.thread;
 
+import com.sun.max.vm.runtime.*;
 import com.sun.max.vm.thread.*;
 
 /**
@@ -38,9 +39,15 @@ public enum NativeThreadLocal {
     STACK_RED_ZONE(48),
     STACK_RED_ZONE_VMPROTECTED(56),
     STACK_BLUE_ZONE(64),
-    OSDATA(72);
+    OSDATA(72),
+    STACK_IS_CACHED(80),
+    TRAP_COUNTS(88),
+    JNI_LOCAL_HANDLES(88 + 8 * Trap.Count.VALUES.size()),
+    JNI_LOCAL_HANDLES_TOP(96 + 8 * Trap.Count.VALUES.size()),
+    JNI_LOCAL_HANDLES_END(104 + 8 * Trap.Count.VALUES.size()),
+    DORMANT(112 + 8 * Trap.Count.VALUES.size());
 
-    public static final int SIZE = 80;
+    public static final int SIZE = 120 + 8 * Trap.Count.VALUES.size();
     public int offset;
 
     NativeThreadLocal(int offset) {
@@ -58,6 +58,60 @@ public final class Memory {
      */
     public static final long ZAPPED_MARKER = 0xDEADBEEFCAFEBABEL;
 
+    /**
+     * The statistics kept by the native allocator behind {@link #allocate}.
+     *
+     * ATTENTION: the ordinals must match the MEMORY_* statistic constants in memory.h.
+     */
+    public enum Statistic {
+        ALLOCATIONS,        // blocks allocated
+        DEALLOCATIONS,      // blocks deallocated
+        SPAN_BYTES,         // bytes of virtual memory from which small blocks are carved
+        LARGE_BYTES,        // bytes in live blocks too large for a size class
+        CENTRAL_TRANSFERS;  // batches of blocks moved between the per-thread caches and the central lists
+
+        public static final Statistic[] VALUES = values();
+    }
+
+    /**
+     * The native allocator's statistics (see memory_getStatistics() in memory.h).
+     */
+    private static Pointer statistics = Pointer.zero();
+
+    /**
+     * Locates the native allocator's statistics. This must be called before {@link #statistic} is used.
+     */
+    public static void initialize() {
+        statistics = memory_getStatistics();
+    }
+
+    @C_FUNCTION
+    private static native Pointer memory_getStatistics();
+
+    /**
+     * Gets a statistic of the native allocator. The allocation and deallocation counts are gathered per thread
+     * and published in batches, so they may lag slightly behind.
+     *
+     * @return the value of the statistic or zero if the statistics are not available
+     */
+    public static long statistic(Statistic statistic) {
+        if (statistics.isZero()) {
+            return 0;
+        }
+        return statistics.getWord(statistic.ordinal()).asAddress().toLong();
+    }
+
+    public static void reportStatistics() {
+        Log.print("Memory.allocator");
+        for (Statistic statistic : Statistic.VALUES) {
+            Log.print(' ');
+            Log.print(statistic.name());
+            Log.print('=');
+            Log.print(statistic(statistic));
+        }
+        Log.println();
+    }
+
     @C_FUNCTION
     private static native Pointer memory_allocate(Size size);
 
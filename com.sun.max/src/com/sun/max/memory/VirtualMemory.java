@@ -57,9 +57,78 @@ public final class VirtualMemory {
         DATA    // for miscellaneous data
     }
 
+    /**
+     * NUMA placement policies for virtual memory.
+     *
+     * ATTENTION: the ordinals must match the NUMA_POLICY_* constants in virtualMemory.h.
+     */
+    public enum PlacementPolicy {
+        FIRST_TOUCH, // pages are placed on the node of the thread that first touches them (the OS default)
+        BIND,        // pages must be placed on a given node
+        INTERLEAVE,  // pages are interleaved across all nodes the process may allocate on
+        PREFERRED,   // pages are placed on a given node if it has free memory
+        LOCAL        // pages are placed on the node of the calling thread if it has free memory
+    }
+
+    /**
+     * Access pattern hints for mapped memory (see {@link #adviseMapping}).
+     *
+     * ATTENTION: the ordinals must match the MAPPING_ADVICE_* constants in virtualMemory.h.
+     */
+    public enum MappingAdvice {
+        NORMAL,     // no particular access pattern
+        SEQUENTIAL, // the range will be accessed sequentially, so read ahead aggressively
+        RANDOM,     // the range will be accessed randomly, so do not read ahead
+        WILLNEED,   // the range will be accessed soon, so start reading it in
+        DONTNEED    // the range will not be accessed soon, so its pages can be dropped
+    }
+
+    /**
+     * The kinds of virtual memory accounted for per {@link Type}.
+     *
+     * ATTENTION: the ordinals must match the VM_RESERVED, VM_COMMITTED and VM_PROTECTED constants in virtualMemory.h.
+     */
+    public enum Accounting {
+        RESERVED,   // bytes of address space mapped
+        COMMITTED,  // bytes of address space mapped accessible
+        PROTECTED;  // bytes of address space protected by protectPages (always accounted as DATA)
+
+        public static final Accounting[] VALUES = values();
+    }
+
+    /**
+     * The native accounting counters (see virtualMemory_getAccounting() in virtualMemory.h).
+     */
+    @INSPECTED
+    private static Pointer accounting = Pointer.zero();
+
     private VirtualMemory() {
     }
 
+    /**
+     * Locates the native accounting counters. This must be called before {@link #accountedBytes} is used.
+     */
+    public static void initialize() {
+        accounting = virtualMemory_getAccounting();
+    }
+
+    @C_FUNCTION
+    private static native Pointer virtualMemory_getAccounting();
+
+    /**
+     * Gets the number of bytes of a given kind of virtual memory that are currently allocated for a given type of memory.
+     *
+     * @param type the type of memory
+     * @param kind the kind of bytes
+     * @return the number of bytes or zero if the counters are not available
+     */
+    public static Size accountedBytes(Type type, Accounting kind) {
+        if (accounting.isZero()) {
+            return Size.zero();
+        }
+        return accounting.getWord((type.ordinal() * Accounting.VALUES.length) + kind.ordinal()).asSize();
+    }
+
     /**
      * Allocates virtual memory of a given type.
      *
@@ -137,6 +206,23 @@ public final class VirtualMemory {
         return virtualMemory_allocateIn31BitSpace(size, type.ordinal());
     }
 
+    /**
+     * Applies a NUMA placement policy to a range of virtual memory. Pages of the range that have already
+     * been placed are migrated to conform to the policy where possible. This is only supported on Linux.
+     *
+     * @param address the page aligned start of the range
+     * @param size the size of the range
+     * @param policy the placement policy
+     * @param node the node for {@link PlacementPolicy#BIND} and {@link PlacementPolicy#PREFERRED} (ignored otherwise)
+     * @return true if the policy was applied, false otherwise
+     */
+    public static boolean setPlacementPolicy(Address address, Size size, PlacementPolicy policy, int node) {
+        return virtualMemory_setPlacementPolicy(address, size, policy.ordinal(), node);
+    }
+
+    @C_FUNCTION
+    private static native boolean virtualMemory_setPlacementPolicy(Address address, Size size, int policy, int node);
+
     /**
      * Generic virtual memory allocator.
      * @param address reserve virtual memory at specified address if not zero, otherwise let the underlying OS decide where to allocate
@@ -168,14 +254,27 @@ public final class VirtualMemory {
     private static final TimerMetric commitMemoryTime = new TimerMetric(new SingleUseTimer(Clock.SYSTEM_MILLISECONDS));
     private static final TimerMetric uncommitMemoryTime = new TimerMetric(new SingleUseTimer(Clock.SYSTEM_MILLISECONDS));
     private static final TimerMetric deallocateMemoryTime = new TimerMetric(new SingleUseTimer(Clock.SYSTEM_MILLISECONDS));
+    private static final TimerMetric releaseMemoryTime = new TimerMetric(new SingleUseTimer(Clock.SYSTEM_MILLISECONDS));
 
     public static void reportMetrics() {
         reserveMemoryTime.report("VirtualMemory.reserveMemory", Log.out);
         commitMemoryTime.report("VirtualMemory.commitMemory", Log.out);
         uncommitMemoryTime.report("VirtualMemory.uncommitMemory", Log.out);
         deallocateMemoryTime.report("VirtualMemory.deallocate", Log.out);
+        releaseMemoryTime.report("VirtualMemory.releaseMemory", Log.out);
         allocateMemoryTime.report("VirtualMemory.allocate", Log.out);
         allocateAtFixedAddressTime.report("VirtualMemory.allocateAtFixedAddress", Log.out);
+        for (Type type : Type.values()) {
+            Log.print("VirtualMemory.");
+            Log.print(type.name());
+            for (Accounting kind : Accounting.VALUES) {
+                Log.print(' ');
+                Log.print(kind.name());
+                Log.print('=');
+                Log.print(accountedBytes(type, kind).toLong());
+            }
+            Log.println();
+        }
     }
 
     /**
@@ -226,6 +325,39 @@ public final class VirtualMemory {
         return !uncommitted.isZero();
     }
 
+    /**
+     * Gives the physical pages backing a range of committed memory back to the OS while keeping the range
+     * reserved and accessible. Unlike {@link #uncommitMemory}, the range does not need to be committed again
+     * before it is used but its contents are undefined until they are next written.
+     *
+     * @param address the page aligned start of the range
+     * @param size the size of the range
+     * @return true if the pages were released, false otherwise
+     */
+    public static boolean releaseMemory(Address address, Size size) {
+        if (TraceAnonOperations) {
+            traceRange("releaseMemory", address, size);
+        }
+        releaseMemoryTime.start();
+        final boolean released = virtualMemory_uncommit(address.toLong(), size.toLong());
+        releaseMemoryTime.stop();
+        return released;
+    }
+
+    /**
+     * Prepares a range released by {@link #releaseMemory} for reuse.
+     *
+     * @param address the page aligned start of the range
+     * @param size the size of the range
+     * @return true if the range can be used, false otherwise
+     */
+    public static boolean reuseMemory(Address address, Size size) {
+        if (TraceAnonOperations) {
+            traceRange("reuseMemory", address, size);
+        }
+        return virtualMemory_commit(address.toLong(), size.toLong());
+    }
+
     /**
      * Return the amount of physical memory (in bytes) of the underlying platform.
      * @return amount of physical memory in bytes
@@ -314,10 +446,30 @@ public final class VirtualMemory {
         return Pointer.fromLong(virtualMemory_mapFileIn31BitSpace(size, fd, fileOffset.toLong()));
     }
 
+    /**
+     * Gives the OS a hint of how a range of mapped memory, typically a file mapped by {@link #mapFile}, will be accessed.
+     * For {@link MappingAdvice#DONTNEED} the pages of the range are dropped: a later access reads the file again,
+     * so modifications of a private mapping are lost. This is only supported on Solaris, Linux and Darwin.
+     *
+     * @param address the page aligned start of the range
+     * @param size the size of the range
+     * @param advice the expected access pattern
+     * @return true if the hint was given, false otherwise
+     */
+    public static boolean adviseMapping(Address address, Size size, MappingAdvice advice) {
+        return virtualMemory_adviseMapping(address.toLong(), size.toLong(), advice.ordinal());
+    }
+
     /* These are JNI functions because they may block */
 
+    private static native boolean virtualMemory_adviseMapping(long address, long size, int advice);
+
     private static native long virtualMemory_mapFile(long size, int fd, long fileOffset);
 
+    private static native boolean virtualMemory_uncommit(long address, long size);
+
+    private static native boolean virtualMemory_commit(long address, long size);
+
     private static native long virtualMemory_mapFileIn31BitSpace(int size, int fd, long fileOffset);
 
     public static void traceRange(String label, Address start, Size size) {
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2017, APT Group, School of Computer Science,
+ * The University of Manchester. All rights reserved.
+ * Copyright (c) 2007, 2011, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+package com.sun.max.platform;
+
+import com.sun.max.annotate.*;
+import com.sun.max.vm.*;
+import com.sun.max.vm.hosted.*;
+
+/**
+ * The instruction set extensions of the CPU, probed once by the native code (see cpuFeatures.h). The compilers
+ * can use {@link #isPresent()} to select code sequences using an extension over the baseline code. The
+ * {@linkplain #bit bit numbers} are those of the native feature set and are stable.
+ *
+ * While bootstrapping, the features are those of the host, as probed by the hosted native library.
+ */
+public enum CPUFeature {
+    /* AMD64: */
+    SSE4_1(0),
+    SSE4_2(1),
+    POPCNT(2),
+    LZCNT(3),
+    BMI1(4),
+    BMI2(5),
+    AVX(6),
+    AVX2(7),
+    FMA(8),
+    AVX512F(9),
+    AVX512BW(10),
+    AVX512VL(11),
+    AESNI(12),
+
+    /* ARM and AArch64: */
+    NEON(32),
+    SVE(33),
+    SVE2(34),
+    /** The AArch64 large system extension atomics (CAS, LDADD et al.). */
+    LSE(35),
+    CRC32(36),
+    AES(37),
+    PMULL(38),
+    SHA1(39),
+    SHA2(40),
+
+    /** Hardware integer division (always present except on some ARMv7 cores). */
+    IDIV(41),
+
+    /* RISC-V: */
+    RISCV_C(48),
+    RISCV_V(49);
+
+    /**
+     * The number of this feature's bit in the {@linkplain #features() feature set}.
+     */
+    public final int bit;
+
+    CPUFeature(int bit) {
+        this.bit = bit;
+    }
+
+    /**
+     * Determines if the CPU the VM is running on supports this feature.
+     */
+    public boolean isPresent() {
+        return (features() & (1L << bit)) != 0;
+    }
+
+    /**
+     * Gets the set of the features of the CPU, with the {@linkplain #bit bit} of each supported feature set.
+     */
+    public static long features() {
+        if (MaxineVM.isHosted()) {
+            return hostedFeatures();
+        }
+        return cpuFeatures_get();
+    }
+
+    @HOSTED_ONLY
+    private static long hostedFeatures() {
+        Prototype.loadHostedLibrary();
+        return nativeGetCPUFeatures();
+    }
+
+    private static native long nativeGetCPUFeatures();
+
+    @C_FUNCTION
+    private static native long cpuFeatures_get();
+}
@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2017, APT Group, School of Computer Science,
+ * The University of Manchester. All rights reserved.
+ * Copyright (c) 2007, 2011, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+package com.sun.max.platform;
+
+import com.sun.max.annotate.*;
+import com.sun.max.lang.*;
+import com.sun.max.unsafe.*;
+import com.sun.max.vm.*;
+import com.sun.max.vm.hosted.*;
+
+/**
+ * The cache hierarchy of the CPU, probed once by the native code (see cacheTopology.h). Unlike the
+ * {@linkplain DataModel#cacheAlignment cache alignment} fixed when the boot image is built, these are the
+ * values of the machine the VM is running on, so that one boot image can size its cache-sensitive
+ * structures (TLABs, prefetch distances, copy thresholds) for each machine.
+ *
+ * While bootstrapping, the values are those of the host.
+ */
+public enum CacheTopology {
+    /** The smallest data cache line size in bytes. */
+    LINE_SIZE,
+    /** The level 1 data cache size in bytes. */
+    L1D_SIZE,
+    /** The level 1 instruction cache size in bytes. */
+    L1I_SIZE,
+    /** The level 2 cache size in bytes. */
+    L2_SIZE,
+    /** The level 3 cache size in bytes. */
+    L3_SIZE,
+    /** The number of CPUs sharing a level 2 cache. */
+    L2_SHARING,
+    /** The number of CPUs sharing a level 3 cache. */
+    L3_SHARING;
+
+    public static final CacheTopology[] VALUES = values();
+
+    /**
+     * Gets this value of the cache hierarchy.
+     *
+     * @return the value or 0 if it could not be determined
+     */
+    public long value() {
+        if (MaxineVM.isHosted()) {
+            return hostedValue(ordinal());
+        }
+        return cacheTopology_get().getLong(ordinal());
+    }
+
+    /**
+     * Gets the data cache line size, or a given default if it could not be determined.
+     */
+    public static int lineSize(int defaultSize) {
+        final long lineSize = LINE_SIZE.value();
+        return lineSize > 0 ? (int) lineSize : defaultSize;
+    }
+
+    @HOSTED_ONLY
+    private static long hostedValue(int index) {
+        Prototype.loadHostedLibrary();
+        return nativeGetCacheTopology(index);
+    }
+
+    private static native long nativeGetCacheTopology(int index);
+
+    @C_FUNCTION
+    private static native Pointer cacheTopology_get();
+}
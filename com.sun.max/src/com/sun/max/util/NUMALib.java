@@ -20,11 +20,10 @@
 package com.sun.max.util;
 
 import com.sun.max.annotate.*;
+import com.sun.max.unsafe.*;
 
 public class NUMALib {
 
-    private int numOfCores;
-
     /**
      * This variable holds the value of EFAULT return code.
      * This error code is returned by numa_move_pages system call when a page is NOT found.
@@ -36,25 +35,104 @@ public class NUMALib {
     public static final int EFAULT = -14;
 
     /**
-     * This array holds the configuration. The index is the core/cpu id and the value is the numa node of the core/cpu.
+     * A copy of the topology snapshot taken by the native code (see numa.c). It is immutable so that
+     * a {@linkplain NUMALib#refresh() refresh} replaces all of it at once.
      */
-    private int[] coreToNUMANodeMap;
+    private static final class Topology {
 
-    public NUMALib() {
-        numOfCores = numaConfiguredCPUs();
-        assert numOfCores >= Runtime.getRuntime().availableProcessors();
+        final int numOfCores;
+
+        /**
+         * This array holds the configuration. The index is the core/cpu id and the value is the numa node of the core/cpu.
+         */
+        final int[] coreToNUMANodeMap;
+
+        final int numOfNodes;
 
-        coreToNUMANodeMap = new int[numOfCores];
+        /**
+         * The distances between the NUMA nodes, the distance from node {@code i} to node {@code j} is at {@code i * numOfNodes + j}.
+         */
+        final int[] nodeDistances;
 
-        for (int i = 0; i < numOfCores; i++) {
-            coreToNUMANodeMap[i] = numaNodeOfCPU(i);
-            assert coreToNUMANodeMap[i] >= 0 : "Core ID: " + i + " is on NUMA node: " + coreToNUMANodeMap[i];
+        /**
+         * The memory size and the free memory of each node in bytes, as of the snapshot.
+         */
+        final long[] nodeMemorySize;
+        final long[] nodeFreeMemory;
+
+        /**
+         * Copies the current native snapshot into dense arrays.
+         */
+        Topology() {
+            numOfCores = numaConfiguredCPUs();
+            numOfNodes = numaTopologyNodes();
+            final Pointer cpuToNode = numaTopologyCPUToNode();
+            final Pointer distances = numaTopologyDistances();
+            final Pointer memorySize = numaTopologyMemorySize();
+            final Pointer freeMemory = numaTopologyFreeMemory();
+
+            coreToNUMANodeMap = new int[numOfCores];
+            for (int i = 0; i < numOfCores; i++) {
+                coreToNUMANodeMap[i] = cpuToNode.getInt(i);
+                assert coreToNUMANodeMap[i] >= 0 : "Core ID: " + i + " is on NUMA node: " + coreToNUMANodeMap[i];
+            }
+            nodeDistances = new int[numOfNodes * numOfNodes];
+            for (int i = 0; i < nodeDistances.length; i++) {
+                nodeDistances[i] = distances.getInt(i);
+            }
+            nodeMemorySize = new long[numOfNodes];
+            nodeFreeMemory = new long[numOfNodes];
+            for (int i = 0; i < numOfNodes; i++) {
+                nodeMemorySize[i] = memorySize.getLong(i);
+                nodeFreeMemory[i] = freeMemory.getLong(i);
+            }
         }
     }
 
+    private volatile Topology topology;
+
+    public NUMALib() {
+        topology = new Topology();
+        assert topology.numOfCores >= Runtime.getRuntime().availableProcessors();
+    }
+
+    /**
+     * Takes a new snapshot of the topology, e.g. after CPUs have been hot plugged or to update the free memory of the nodes.
+     */
+    public synchronized void refresh() {
+        numaTopologyRefresh();
+        topology = new Topology();
+    }
+
     @INLINE
     public int getNUMANodeOfCPU(int coreId) {
-        return coreToNUMANodeMap[coreId];
+        return topology.coreToNUMANodeMap[coreId];
+    }
+
+    @INLINE
+    public int getNumberOfCPUs() {
+        return topology.numOfCores;
+    }
+
+    @INLINE
+    public int getNumberOfNodes() {
+        return topology.numOfNodes;
+    }
+
+    @INLINE
+    public int getNodeDistance(int fromNode, int toNode) {
+        final Topology t = topology;
+        return t.nodeDistances[fromNode * t.numOfNodes + toNode];
+    }
+
+    @INLINE
+    public long getNodeMemorySize(int node) {
+        return topology.nodeMemorySize[node];
+    }
+
+    @INLINE
+    public long getNodeFreeMemory(int node) {
+        return topology.nodeFreeMemory[node];
     }
 
     @C_FUNCTION
@@ -63,6 +141,40 @@ public class NUMALib {
     @C_FUNCTION
     public static native int numaNodeOfAddress(long address);
 
+    /**
+     * Finds the NUMA nodes of a batch of addresses with a single system call.
+     *
+     * @param addresses a native array of {@code count} addresses
+     * @param nodes a native array of {@code count} ints in which the node of each address is stored, or
+     *            {@link #EFAULT} if the page of the address has not been placed on a node yet
+     */
+    @C_FUNCTION
+    public static native void numaNodesOfAddresses(Pointer addresses, Pointer nodes, int count);
+
+    /**
+     * The number of allocation counters per node merged by {@link #numaCounters_merge}: the local count, local
+     * bytes, remote count and remote bytes.
+     */
+    public static final int ALLOCATION_COUNTERS_PER_NODE = 4;
+
+    /**
+     * Counts an allocation in the allocation counters of the current thread, without taking a lock.
+     */
+    @C_FUNCTION
+    public static native void numaCounters_countAllocation(long address, int size);
+
+    /**
+     * Merges the allocation counters of all threads since the last {@link #numaCounters_reset()}.
+     *
+     * @param result a native array of {@code (nodes + 1) * }{@link #ALLOCATION_COUNTERS_PER_NODE} longs, the
+     *            last node being for the objects whose node is not known
+     */
+    @C_FUNCTION
+    public static native void numaCounters_merge(Pointer result, int nodes);
+
+    @C_FUNCTION
+    public static native void numaCounters_reset();
+
     @C_FUNCTION
     public static native int numaConfiguredCPUs();
 
@@ -71,4 +183,22 @@ public class NUMALib {
 
     @C_FUNCTION
     public static native int numaPageSize();
+
+    @C_FUNCTION
+    private static native void numaTopologyRefresh();
+
+    @C_FUNCTION
+    private static native int numaTopologyNodes();
+
+    @C_FUNCTION
+    private static native Pointer numaTopologyCPUToNode();
+
+    @C_FUNCTION
+    private static native Pointer numaTopologyDistances();
+
+    @C_FUNCTION
+    private static native Pointer numaTopologyMemorySize();
+
+    @C_FUNCTION
+    private static native Pointer numaTopologyFreeMemory();
 }
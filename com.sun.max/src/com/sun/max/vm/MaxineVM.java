@@ -33,6 +33,7 @@ import java.util.concurrent.*;
 import com.sun.max.annotate.*;
 import com.sun.max.config.*;
 import com.sun.max.lang.*;
+import com.sun.max.memory.*;
 import com.sun.max.platform.*;
 import com.sun.max.program.*;
 import com.sun.max.unsafe.*;
@@ -502,6 +503,8 @@ public final class MaxineVM {
 
         // Initialize the trap system:
         Trap.initialize();
+        VirtualMemory.initialize();
+        Memory.initialize();
         ImmortalHeap.initialize();
 
         NativeInterfaces.initialize(vmInterface, jniEnv, jmmInterface);
@@ -509,12 +512,14 @@ public final class MaxineVM {
         // Perhaps this should be later, after VM has initialized
         startupTime = System.currentTimeMillis();
         startupTimeNano = System.nanoTime();
+        StartupTimes.mark(Phase.PRIMORDIAL);
 
         MaxineVM vm = vm();
         vmConfig().initializeSchemes(MaxineVM.Phase.PRIMORDIAL);
 
         vm().stubs.intialize();
         vm.phase = Phase.PRISTINE;
+        StartupTimes.mark(Phase.PRISTINE);
 
         VMOptions.parsePristine(argc, argv);
         return exitCode;
@@ -552,8 +557,9 @@ public final class MaxineVM {
     }
 
     /**
-     * Presently this function calls the Gnu __builtin___clear_cache function.
-     * From the documentation for this builtin function:
+     * On AArch64 this function cleans the data cache and invalidates the instruction cache line by line for the given
+     * range (skipping either step if the cache type register says it is not needed), on ARMv7 and RISC-V it calls the
+     * Gnu __builtin___clear_cache function. From the documentation for this builtin function:
      *      "This function is used to flush the processor’s instruction cache for the region of memory between
      *      begin inclusive and end exclusive."
      *      
@@ -568,11 +574,52 @@ public final class MaxineVM {
     public static native void maxine_cache_flush(Address start, int length);
 
     /**
-     * Executes a membarrier(2) system call on Linux systems.
+     * Flushes the instruction cache for a set of ranges with the barriers executed once for the whole set
+     * (see {@link #maxine_cache_flush(Address, int)}).
+     *
+     * @param ranges an array of {@code count} (start, size) word pairs, which is sorted and merged in place
+     * @param count the number of ranges
+     */
+    @C_FUNCTION
+    public static native void maxine_cache_flush_ranges(Pointer ranges, int count);
+
+    /**
+     * Executes a membarrier(2) system call on Linux systems. The VM exits if no barrier is available.
      */
     @C_FUNCTION
     public static native void syscall_membarrier();
 
+    /**
+     * Executes a core serializing membarrier(2) system call (if the kernel provides it, otherwise
+     * {@link #syscall_membarrier()}) so that all threads discard instructions fetched before modified code was flushed.
+     */
+    @C_FUNCTION
+    public static native void syscall_membarrierSyncCore();
+
+    /**
+     * Applies a batch of code patches, flushes the instruction cache for the merged patched ranges and
+     * optionally executes a single {@linkplain #syscall_membarrierSyncCore() core serializing barrier}.
+     *
+     * @param patches an array of {@code count} (address, value, size) word triples where size is 4 or 8
+     * @param count the number of patches
+     * @param barrier specifies if a barrier is executed after the cache maintenance
+     * @see com.sun.max.vm.compiler.target.CodePatchBatch
+     */
+    @C_FUNCTION
+    public static native void maxine_patch_code(Pointer patches, int count, boolean barrier);
+
+    /**
+     * Determines if {@link #syscall_membarrier()} can be used on this platform.
+     */
+    @C_FUNCTION
+    public static native boolean membarrier_isAvailable();
+
+    /**
+     * Determines if {@link #syscall_membarrier()} only interrupts the CPUs running threads of this process.
+     */
+    @C_FUNCTION
+    public static native boolean membarrier_isExpedited();
+
     @C_FUNCTION
     public static native long arithmeticldiv(long x, long y);
 
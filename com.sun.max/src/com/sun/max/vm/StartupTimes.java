@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2011, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ */
+package com.sun.max.vm;
+
+import static com.sun.max.vm.VMOptions.*;
+
+import com.sun.max.annotate.*;
+import com.sun.max.unsafe.*;
+import com.sun.max.vm.MaxineVM.Phase;
+
+/**
+ * The times at which the phases of VM startup completed. The native phases are recorded by the
+ * launcher and boot image loader (see startup.h) and the Java phases by {@link #mark(Phase)}.
+ * All times are from the same clock as {@link System#nanoTime()}.
+ */
+public final class StartupTimes {
+
+    private static final VMBooleanOption printStartupTimesOption = register(new VMBooleanOption("-XX:-PrintStartupTimes",
+        "Print the time taken by each native and Java phase of VM startup."), MaxineVM.Phase.STARTING);
+
+    /**
+     * The time at which each Java {@linkplain Phase phase} was entered, indexed by the phase's ordinal.
+     */
+    private static final long[] javaPhaseTimes = new long[Phase.values().length];
+
+    private StartupTimes() {
+    }
+
+    @C_FUNCTION
+    private static native int native_startupPhaseCount();
+
+    @C_FUNCTION
+    private static native Pointer native_startupPhaseName(int phase);
+
+    @C_FUNCTION
+    private static native long native_startupPhaseTime(int phase);
+
+    /**
+     * Records the current time as the time at which a given phase was entered.
+     */
+    public static void mark(Phase phase) {
+        javaPhaseTimes[phase.ordinal()] = System.nanoTime();
+    }
+
+    /**
+     * Gets the number of native startup phases.
+     */
+    public static int nativePhaseCount() {
+        return native_startupPhaseCount();
+    }
+
+    /**
+     * Gets the time at which a given native startup phase completed.
+     *
+     * @return the time in nanoseconds or 0 if the phase was not executed (e.g. decompression for an uncompressed image)
+     */
+    public static long nativePhaseTime(int phase) {
+        return native_startupPhaseTime(phase);
+    }
+
+    /**
+     * Gets the time at which a given Java phase was entered.
+     *
+     * @return the time in nanoseconds or 0 if the phase has not been entered
+     */
+    public static long javaPhaseTime(Phase phase) {
+        return javaPhaseTimes[phase.ordinal()];
+    }
+
+    /**
+     * Prints the startup times if requested by {@code -XX:+PrintStartupTimes}. This should be called
+     * once the VM is about to run the application.
+     */
+    public static void printIfRequested() {
+        if (printStartupTimesOption.getValue()) {
+            print();
+        }
+    }
+
+    /**
+     * Prints the time at which each phase completed (native phases) or was entered (Java phases),
+     * relative to the launch of the VM, and the time since the previous phase.
+     */
+    public static void print() {
+        final long launch = native_startupPhaseTime(0);
+        long previous = launch;
+        final boolean lockDisabledSafepoints = Log.lock();
+        Log.println("Startup times (us since launch, us since previous phase):");
+        final int count = native_startupPhaseCount();
+        for (int phase = 0; phase < count; phase++) {
+            final long time = native_startupPhaseTime(phase);
+            if (time != 0L) {
+                Log.print("  native ");
+                Log.printCString(native_startupPhaseName(phase));
+                printTimes(time - launch, time - previous);
+                previous = time;
+            }
+        }
+        for (Phase phase : Phase.values()) {
+            final long time = javaPhaseTimes[phase.ordinal()];
+            if (time != 0L) {
+                Log.print("  java   ");
+                Log.print(phase.name());
+                printTimes(time - launch, time - previous);
+                previous = time;
+            }
+        }
+        Log.unlock(lockDisabledSafepoints);
+    }
+
+    private static void printTimes(long sinceLaunch, long sincePrevious) {
+        Log.print(": ");
+        Log.print(sinceLaunch / 1000);
+        Log.print(", +");
+        Log.println(sincePrevious / 1000);
+    }
+}
@@ -329,6 +329,141 @@ public class VMOptions {
     private static final VMStringOption logFileOption = register(new VMStringOption("-XX:LogFile=", false, null,
         "Redirect VM log output to the specified file. By default, VM log output goes to the standard output stream."), MaxineVM.Phase.STARTING);
 
+    /**
+     * This option is parsed in the native code (see maxine.c). It's declared here simply so that it
+     * shows up in the {@linkplain #printUsage(Category) usage} message.
+     */
+    private static final VMStringOption imageRelocationOption = register(new VMStringOption("-XX:ImageRelocation=", false, "eager",
+        "Relocate the boot image 'eager'ly while loading it or 'lazy' (Linux only), i.e. each page when it is first accessed."), MaxineVM.Phase.STARTING);
+
+    /**
+     * This option is parsed in the native code (see maxine.c). It's declared here simply so that it
+     * shows up in the {@linkplain #printUsage(Category) usage} message.
+     */
+    private static final VMStringOption imageLargePagesOption = register(new VMStringOption("-XX:ImageLargePages=", false, "none",
+        "Back the boot heap and code with 'thp' (transparent huge pages) or with explicitly allocated '2M' or '1G' huge pages (Linux only)."), MaxineVM.Phase.STARTING);
+
+    /**
+     * This option is parsed in the native code (see maxine.c). It's declared here simply so that it
+     * shows up in the {@linkplain #printUsage(Category) usage} message.
+     */
+    private static final VMStringOption imagePageProfileOption = register(new VMStringOption("-XX:ImagePageProfile=", false, "none",
+        "Either 'record[:<seconds>]' the boot image pages touched in the first seconds (default 10) of execution in a file next to the boot image, " +
+        "or 'prefetch' the pages recorded in that file while loading the boot image (Linux only)."), MaxineVM.Phase.STARTING);
+
+    /**
+     * This option is parsed in the native code (see maxine.c). It's declared here simply so that it
+     * shows up in the {@linkplain #printUsage(Category) usage} message.
+     */
+    private static final VMBooleanOption imageMergeableOption = register(new VMBooleanOption("-XX:-ImageMergeable",
+        "Allow the kernel to merge relocated boot image pages that are identical across VM processes (Linux only)."), MaxineVM.Phase.STARTING);
+
+    /**
+     * This option is parsed in the native code (see maxine.c). It's declared here simply so that it
+     * shows up in the {@linkplain #printUsage(Category) usage} message.
+     */
+    private static final VMStringOption numaHeapPlacementOption = register(new VMStringOption("-XX:NUMAHeapPlacement=", false, "firsttouch",
+        "Place the pages of the heap on the NUMA node of the thread that touches them first ('firsttouch'), 'interleave' them across all nodes, " +
+        "prefer the node of the thread committing them ('local') or 'bind:<node>' or 'preferred:<node>' them to a given node (Linux only)."), MaxineVM.Phase.STARTING);
+
+    /**
+     * This option is parsed in the native code (see maxine.c). It's declared here simply so that it
+     * shows up in the {@linkplain #printUsage(Category) usage} message.
+     */
+    private static final VMBooleanOption numaLocalThreadLocalsOption = register(new VMBooleanOption("-XX:-NUMALocalThreadLocals",
+        "Place the thread locals of each thread on the NUMA node of the thread (Linux only)."), MaxineVM.Phase.STARTING);
+
+    /**
+     * This option is parsed in the native code (see maxine.c). It's declared here simply so that it
+     * shows up in the {@linkplain #printUsage(Category) usage} message.
+     */
+    private static final VMBooleanOption adaptiveNativeMutexesOption = register(new VMBooleanOption("-XX:-AdaptiveNativeMutexes",
+        "Use native mutexes that spin briefly before parking on a futex instead of pthread mutexes (Linux and Darwin only)."), MaxineVM.Phase.STARTING);
+
+    /**
+     * This option is parsed in the native code (see maxine.c). It's declared here simply so that it
+     * shows up in the {@linkplain #printUsage(Category) usage} message.
+     */
+    private static final VMBooleanOption dormantAttachedThreadsOption = register(new VMBooleanOption("-XX:-DormantAttachedThreads",
+        "Keep a native thread that detaches from the VM dormant with its thread locals and java.lang.Thread so that attaching it " +
+        "again is cheap. A dormant thread does not keep the VM alive but it stays alive (e.g. for Thread.join()) until its native thread exits."), MaxineVM.Phase.STARTING);
+
+    /**
+     * This option is parsed in the native code (see maxine.c). It's declared here simply so that it
+     * shows up in the {@linkplain #printUsage(Category) usage} message.
+     */
+    private static final VMBooleanOption asyncLoggingOption = register(new VMBooleanOption("-XX:-AsyncLogging",
+        "Buffer the output of the native log per thread and write it to the log file from a background thread (Linux and Darwin only)."), MaxineVM.Phase.STARTING);
+
+    /**
+     * This option is parsed in the native code (see maxine.c). It's declared here simply so that it
+     * shows up in the {@linkplain #printUsage(Category) usage} message.
+     */
+    private static final VMStringOption binaryTraceOption = register(new VMStringOption("-XX:BinaryTrace=", false, null,
+        "Record trace events of each thread in a memory mapped ring file in the given directory, see the tracedump tool (Linux and Darwin only)."), MaxineVM.Phase.STARTING);
+
+    /**
+     * This option is parsed in the native code (see maxine.c). It's declared here simply so that it
+     * shows up in the {@linkplain #printUsage(Category) usage} message.
+     */
+    private static final VMIntOption nativeMutexProfileOption = register(new VMIntOption("-XX:NativeMutexProfile=", 0,
+        "Profile the contention of native mutexes by sampling one in every <n> acquisitions. The profile is printed on SIGQUIT " +
+        "and when the VM exits (Linux and Darwin only)."), MaxineVM.Phase.STARTING);
+
+    /**
+     * This option is parsed in the native code (see maxine.c). It's declared here simply so that it
+     * shows up in the {@linkplain #printUsage(Category) usage} message.
+     */
+    private static final VMBooleanOption socketPollerOption = register(new VMBooleanOption("-XX:-SocketPoller",
+        "Wait for socket reads with a timeout by registering with a single epoll/kqueue poller thread and parking, " +
+        "instead of a poll() per waiting thread (Linux and Darwin only)."), MaxineVM.Phase.STARTING);
+
+    /**
+     * This option is parsed in the native code (see maxine.c). It's declared here simply so that it
+     * shows up in the {@linkplain #printUsage(Category) usage} message.
+     */
+    private static final VMIntOption hostCacheTTLOption = register(new VMIntOption("-XX:HostCacheTTL=", 30,
+        "Cache the successful host lookups of the native resolver behind JVM_GetHostByName and JVM_GetHostByAddr " +
+        "for <n> seconds (0 to not cache, -1 to cache forever)."), MaxineVM.Phase.STARTING);
+
+    /**
+     * This option is parsed in the native code (see maxine.c). It's declared here simply so that it
+     * shows up in the {@linkplain #printUsage(Category) usage} message.
+     */
+    private static final VMIntOption hostCacheNegativeTTLOption = register(new VMIntOption("-XX:HostCacheNegativeTTL=", 10,
+        "Cache the failed host lookups of the native resolver for <n> seconds (0 to not cache, -1 to cache forever)."), MaxineVM.Phase.STARTING);
+
+    /**
+     * This option is parsed in the native code (see maxine.c). It's declared here simply so that it
+     * shows up in the {@linkplain #printUsage(Category) usage} message.
+     */
+    private static final VMBooleanOption perfMapOption = register(new VMBooleanOption("-XX:-PerfMap",
+        "Describe the boot image and compiled methods in /tmp/perf-<pid>.map for the Linux perf tools (Linux only)."), MaxineVM.Phase.STARTING);
+
+    /**
+     * This option is parsed in the native code (see maxine.c). It's declared here simply so that it
+     * shows up in the {@linkplain #printUsage(Category) usage} message.
+     */
+    private static final VMBooleanOption jitDumpOption = register(new VMBooleanOption("-XX:-JitDump",
+        "Record the boot image and compiled methods with their code and line numbers in /tmp/jit-<pid>.dump " +
+        "for 'perf inject --jit' (Linux only)."), MaxineVM.Phase.STARTING);
+
+    /**
+     * This option is parsed in the native code (see maxine.c). It's declared here simply so that it
+     * shows up in the {@linkplain #printUsage(Category) usage} message.
+     */
+    private static final VMBooleanOption ioUringOption = register(new VMBooleanOption("-XX:+IoUring",
+        "Perform the operations queued on asynchronous I/O rings with io_uring if the kernel supports it, " +
+        "otherwise synchronously when they are queued (Linux only)."), MaxineVM.Phase.STARTING);
+
+    /**
+     * This option is parsed in the native code (see maxine.c and zygote.h). It's declared here simply so that it
+     * shows up in the {@linkplain #printUsage(Category) usage} message.
+     */
+    private static final VMStringOption zygoteOption = register(new VMStringOption("-XX:Zygote=", false, null,
+        "Load the boot image once and fork a VM with the arguments of each request received on the Unix domain socket " +
+        "at the given path, see 'maxvm -XX:ZygoteConnect=<path>' (Linux and Darwin only)."), MaxineVM.Phase.STARTING);
+
     /**
      * The '-verbose' option and all its variants (e.g. '-verbose:gc', '-verbose:class' etc).
      */
@@ -30,15 +30,36 @@ import com.sun.max.vm.*;
 import com.sun.max.vm.compiler.target.*;
 import com.sun.max.vm.jni.*;
 import com.sun.max.vm.jni.JniFunctions.LogOperations;
+import com.sun.max.vm.layout.*;
+import com.sun.max.vm.reference.*;
+import com.sun.max.vm.type.*;
 
 /**
  * A native function represents a {@linkplain #makeSymbol() symbol} associated with a {@linkplain #classMethodActor()
  * method} that can be {@linkplain #link() linked} at runtime to produce a native machine code pointer.
  */
 public final class NativeFunction {
+
+    /**
+     * The prefix of the symbol of a {@linkplain #linkCritical() critical} entry point, which replaces the {@code Java_} prefix of the JNI symbol.
+     */
+    public static final String CRITICAL_PREFIX = "JavaCritical_";
+
+    private static boolean CriticalJNINatives = true;
+
+    static {
+        VMOptions.addFieldOption("-XX:", "CriticalJNINatives", NativeFunction.class,
+            "Call the " + CRITICAL_PREFIX + " entry point of a static native method taking only primitives and primitive arrays, if its library defines one.");
+    }
+
     private final ClassMethodActor classMethodActor;
     private String symbol;
 
+    /**
+     * Determines if this native function is linked to a {@linkplain #linkCritical() critical} entry point.
+     */
+    private boolean isCritical;
+
     private Address address = Address.zero();
 
     /**
@@ -127,6 +148,88 @@ public final class NativeFunction {
         return address;
     }
 
+    /**
+     * Determines if a native method may have a {@linkplain #linkCritical() critical} entry point: it must be a static,
+     * unsynchronized JNI method whose parameters are primitives or primitive arrays and whose result is not a reference.
+     */
+    public static boolean canBeCritical(ClassMethodActor m) {
+        if (!m.isStatic() || m.isSynchronized() || m.isCFunction()) {
+            return false;
+        }
+        final SignatureDescriptor sig = m.descriptor();
+        if (sig.resultKind().isReference || sig.resultKind().isWord) {
+            return false;
+        }
+        for (int i = 0; i < sig.numberOfParameters(); i++) {
+            final TypeDescriptor parameterDescriptor = sig.parameterDescriptorAt(i);
+            final Kind kind = parameterDescriptor.toKind();
+            if (kind.isWord) {
+                return false;
+            }
+            if (kind.isReference) {
+                if (!JavaTypeDescriptor.isArray(parameterDescriptor) || !JavaTypeDescriptor.isPrimitive(parameterDescriptor.componentTypeDescriptor())) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Links this native function to its critical entry point, if its library defines one. A critical entry point is
+     * named like the JNI function but with the {@value #CRITICAL_PREFIX} prefix. It takes neither a {@code JNIEnv} nor
+     * a class argument, and each primitive array argument is passed as its length followed by a pointer to its first
+     * element (0 and {@code NULL} for a {@code null} array). It is called without a transition to native code, so any
+     * GC waits until it returns: it must be short and must not block or call back into the VM.
+     *
+     * This must be called before the stub of the native method is generated as the stub depends on the outcome.
+     *
+     * @return {@code true} if this native function is now linked to a critical entry point
+     */
+    public boolean linkCritical() {
+        if (MaxineVM.isHosted() || !CriticalJNINatives || isCritical || address.isNotZero() || !canBeCritical(classMethodActor)) {
+            return isCritical;
+        }
+        final String criticalSymbol = CRITICAL_PREFIX + makeSymbol().substring("Java_".length());
+        final Address criticalAddress = DynamicLinker.find(classMethodActor, criticalSymbol).asAddress();
+        if (criticalAddress.isZero()) {
+            return false;
+        }
+        symbol = criticalSymbol;
+        isCritical = true;
+        address = criticalAddress;
+        if (!MaxineVM.isPrimordialOrPristine()) {
+            if (NativeInterfaces.verbose()) {
+                Log.println("[Dynamic-linking critical native method " + classMethodActor.holder().name + "." + classMethodActor.name + " = " + address.toHexString() + "]");
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Determines if this native function is linked to a {@linkplain #linkCritical() critical} entry point.
+     */
+    public boolean isCritical() {
+        return isCritical;
+    }
+
+    /**
+     * Gets the number of elements of a primitive array passed to a critical entry point.
+     */
+    @INLINE
+    public static int criticalArrayLength(Object array) {
+        return array == null ? 0 : Layout.readArrayLength(Reference.fromJava(array));
+    }
+
+    /**
+     * Gets the address of the first element of a primitive array passed to a critical entry point. The array cannot
+     * move during the call as no GC can happen before the critical entry point returns.
+     */
+    @INLINE
+    public static Pointer criticalArrayElements(Object array) {
+        return array == null ? Pointer.zero() : Reference.fromJava(array).toOrigin().plus(Layout.byteArrayLayout().getElementOffsetFromOrigin(0));
+    }
+
     /**
      * Determines if the native function pointer has been linked.
      */
@@ -138,6 +241,13 @@ public final class NativeFunction {
      * Sets (or clears) the machine code address for this native function.
      */
     public void setAddress(Address address) {
+        if (isCritical && address.isNotZero()) {
+            // the stub calls the critical entry point, whose calling convention differs from that of a JNI function
+            if (!MaxineVM.isPrimordialOrPristine() && NativeInterfaces.verbose()) {
+                Log.println("[Ignoring registration of critical native method " + classMethodActor.holder().name + "." + classMethodActor.name + "]");
+            }
+            return;
+        }
         this.address = address;
         if (JniFunctions.logger.enabled()) {
             JniFunctions.logger.log(LogOperations.RegisterNativeMethod.ordinal(), REGISTER_ENTRY, MethodID.fromMethodActor(classMethodActor), address);
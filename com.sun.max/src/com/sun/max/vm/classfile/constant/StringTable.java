@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) 2011, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ */
+package com.sun.max.vm.classfile.constant;
+
+import java.lang.ref.*;
+
+import com.sun.max.vm.*;
+
+/**
+ * The table of strings interned by {@link String#intern()}.
+ *
+ * The table is split into segments, each an open addressing table of weak references to strings hashed on their
+ * contents. Lookups do not take any lock: a miss, which may also be due to a concurrent insertion or resizing, is
+ * confirmed under the lock of the segment, which also serializes the insertions and the resizing of the segment.
+ * As the entries are weak, the interned strings that are no longer referenced can be collected. The strings of
+ * {@linkplain SymbolTable symbols}, which include the string literals, are interned here too and live as long as
+ * their symbols.
+ */
+public final class StringTable {
+
+    private StringTable() {
+    }
+
+    private static final int SEGMENT_COUNT = 64;
+    private static final int SEGMENT_SHIFT = 26;
+    private static final int INITIAL_CAPACITY = 256;
+
+    static final class Entry extends WeakReference<String> {
+        final int hash;
+
+        Entry(String string, int hash) {
+            super(string);
+            this.hash = hash;
+        }
+    }
+
+    static final class Segment {
+        /**
+         * The slots of this segment, whose length is a power of 2. The array is replaced when this segment is resized.
+         */
+        volatile Entry[] entries = new Entry[INITIAL_CAPACITY];
+
+        /**
+         * The number of used slots, including the ones whose string has been collected.
+         */
+        int used;
+
+        String find(String string, int hash) {
+            final Entry[] entries = this.entries;
+            final int mask = entries.length - 1;
+            int index = hash & mask;
+            Entry entry;
+            while ((entry = entries[index]) != null) {
+                if (entry.hash == hash) {
+                    final String interned = entry.get();
+                    if (interned != null && interned.equals(string)) {
+                        return interned;
+                    }
+                }
+                index = (index + 1) & mask;
+            }
+            return null;
+        }
+
+        synchronized String add(String string, int hash) {
+            Entry[] entries = this.entries;
+            int mask = entries.length - 1;
+            int index = hash & mask;
+            int free = -1;
+            Entry entry;
+            while ((entry = entries[index]) != null) {
+                final String interned = entry.get();
+                if (interned == null) {
+                    if (free < 0) {
+                        free = index;
+                    }
+                } else if (entry.hash == hash && interned.equals(string)) {
+                    return interned;
+                }
+                index = (index + 1) & mask;
+            }
+            if (free >= 0) {
+                // Reuse the slot of a collected string
+                entries[free] = new Entry(string, hash);
+                return string;
+            }
+            if ((used + 1) * 4 > entries.length * 3) {
+                entries = resize(entries);
+                mask = entries.length - 1;
+                index = hash & mask;
+                while (entries[index] != null) {
+                    index = (index + 1) & mask;
+                }
+            }
+            entries[index] = new Entry(string, hash);
+            used++;
+            return string;
+        }
+
+        /**
+         * Rehashes the live entries into a new array, publishes it and returns it. The old array is left untouched
+         * for the concurrent lookups still probing it.
+         */
+        private Entry[] resize(Entry[] entries) {
+            int live = 0;
+            for (Entry entry : entries) {
+                if (entry != null && entry.get() != null) {
+                    live++;
+                }
+            }
+            int capacity = INITIAL_CAPACITY;
+            while (capacity < (live + 1) * 2) {
+                capacity *= 2;
+            }
+            final Entry[] newEntries = new Entry[capacity];
+            final int mask = capacity - 1;
+            for (Entry entry : entries) {
+                if (entry != null && entry.get() != null) {
+                    int index = entry.hash & mask;
+                    while (newEntries[index] != null) {
+                        index = (index + 1) & mask;
+                    }
+                    newEntries[index] = entry;
+                }
+            }
+            used = live;
+            this.entries = newEntries;
+            return newEntries;
+        }
+    }
+
+    private static final Segment[] segments = new Segment[SEGMENT_COUNT];
+
+    static {
+        for (int i = 0; i < SEGMENT_COUNT; i++) {
+            segments[i] = new Segment();
+        }
+    }
+
+    /**
+     * Spreads the bits of a string hash so that the segment (from the high bits) and the slot (from the low bits)
+     * are both well distributed.
+     */
+    private static int hash(String string) {
+        int h = string.hashCode();
+        h ^= (h >>> 20) ^ (h >>> 12);
+        return h ^ (h >>> 7) ^ (h >>> 4);
+    }
+
+    private static Segment segmentFor(int hash) {
+        return segments[(hash >>> SEGMENT_SHIFT) & (SEGMENT_COUNT - 1)];
+    }
+
+    /**
+     * Gets the canonical instance of a string.
+     */
+    public static String intern(String string) {
+        if (MaxineVM.isHosted()) {
+            return SymbolTable.makeSymbol(string).toString();
+        }
+        if (!symbolsInterned) {
+            internSymbols();
+        }
+        final int hash = hash(string);
+        final Segment segment = segmentFor(hash);
+        final String interned = segment.find(string, hash);
+        if (interned != null) {
+            return interned;
+        }
+        return segment.add(string, hash);
+    }
+
+    /**
+     * Specifies if the strings of the symbols in the boot image have been added to this table. The symbols created
+     * later add their strings as they are made.
+     */
+    private static volatile boolean symbolsInterned;
+
+    /**
+     * Adds the strings of the symbols in the boot image to this table, once, before the first string is interned.
+     */
+    private static synchronized void internSymbols() {
+        if (!symbolsInterned) {
+            SymbolTable.internSymbolStrings();
+            symbolsInterned = true;
+        }
+    }
+
+    /**
+     * Interns the string of a new symbol. This is only called with the lock of the {@link SymbolTable} held
+     * and must not call back into it.
+     */
+    static String internSymbol(String string) {
+        final int hash = hash(string);
+        return segmentFor(hash).add(string, hash);
+    }
+}
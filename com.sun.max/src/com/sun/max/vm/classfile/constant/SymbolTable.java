@@ -30,7 +30,7 @@ import com.sun.max.vm.*;
 
 /**
  * Implementation of symbol and String interning, the latter of which is a Java language requirement.
- *
+ * Interned strings are kept in the {@link StringTable}, which also holds the strings of the symbols.
  */
 public final class SymbolTable {
 
@@ -101,14 +101,26 @@ public final class SymbolTable {
                 // String interning is implemented with another data structure when running hosted
                 utf8 = new Utf8ConstantEntry(value.intern());
             } else {
-                utf8 = new Utf8ConstantEntry(value);
+                utf8 = new Utf8ConstantEntry(StringTable.internSymbol(value));
             }
             symbolTable.put(value, utf8);
         }
         return utf8;
     }
 
+    /**
+     * Adds the strings of all the symbols to the {@link StringTable}.
+     */
+    static synchronized void internSymbolStrings() {
+        for (Utf8ConstantEntry symbol : symbolTable.values()) {
+            StringTable.internSymbol(symbol.toString());
+        }
+    }
+
+    /**
+     * Interns a string, without creating a symbol for it once the VM is running (see {@link StringTable}).
+     */
     public static String intern(String value) {
-        return makeSymbol(value).toString();
+        return StringTable.intern(value);
     }
 }
@@ -339,12 +339,10 @@ public final class CodeEviction extends VmOperation {
                     null : (byte[]) relocate(from, to, targetMethod.scalarLiterals());
                 final Object[] referenceLiterals = targetMethod.referenceLiterals() == null ?
                     null : (Object[]) relocate(from, to, targetMethod.referenceLiterals());
-                /* Two calls to cleanCache() are required. The first ensures that old instructions are cleaned from
-                 * caches and prefetch buffers. The second ensures that the effects of any prefetching from the addresses
-                 * that the code is moved to are discarded. */
-                targetMethod.maybeCleanCache();
                 targetMethod.setCodeArrays(code, codeStart, trampolines, trampolineStart, scalarLiterals, referenceLiterals);
-                targetMethod.maybeCleanCache();
+                /* The moved code does not run before the end of this operation, so the cache maintenance for it is
+                 * performed once for all moved methods after their call sites have been fixed (see doIt()). */
+                movedCode.add(to, size.toInt());
                 cr.setMark(cr.mark().plus(size));
                 CodeManager.runtimeBaselineCodeRegion.add(targetMethod);
                 targetMethod.survivedEviction();
@@ -503,6 +501,7 @@ public final class CodeEviction extends VmOperation {
     final class VMTIMove implements TargetMethod.Closure {
         @Override
         public boolean doTargetMethod(TargetMethod targetMethod) {
+            PerfMap.methodMoved(targetMethod);
             VMTI.handler().methodCompiled(targetMethod.classMethodActor);
             return true;
         }
@@ -594,6 +593,7 @@ public final class CodeEviction extends VmOperation {
         tCompact = timerEnd();
 
         fixCallSitesForMovedCode();
+        movedCode.flush();
         logFixed();
 
         timerStart();
@@ -674,6 +674,11 @@ public final class CodeEviction extends VmOperation {
 
     private final CodePointerRelocator codePointerRelocator = new CodePointerRelocator();
 
+    /**
+     * The new locations of the methods moved by {@link #compact()}, which are flushed from the instruction cache together.
+     */
+    private final CodeRangeFlush movedCode = new CodeRangeFlush();
+
     private void markProtectedMethods() {
         CodeManager.runtimeBaselineCodeRegion.doNewTargetMethods(protectedMethodsMarker);
     }
@@ -0,0 +1,197 @@
+/*
+ * Copyright (c) 2011, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ */
+package com.sun.max.vm.code;
+
+import com.sun.max.annotate.*;
+import com.sun.max.memory.*;
+import com.sun.max.unsafe.*;
+import com.sun.max.vm.actor.member.*;
+import com.sun.max.vm.compiler.target.*;
+
+/**
+ * Describes the target methods to the Linux perf tools when the VM is started with {@code -XX:+PerfMap} or
+ * {@code -XX:+JitDump} (see perfMap.c). The methods in the boot code region are described once at startup and
+ * the methods compiled at run time as they are installed.
+ * <p>
+ * The names and line tables are written to C heap memory so that a method moved by code eviction can be described
+ * during the GC without allocating on the Java heap. The line tables are omitted for the moved methods.
+ */
+public final class PerfMap {
+
+    private PerfMap() {
+    }
+
+    /**
+     * The size of an entry in a line table (see PerfMapLineStruct in perfMap.h).
+     */
+    private static final int LINE_SIZE = 8;
+
+    /**
+     * The value of {@code PERF_MAP_JIT_DUMP} in perfMap.h.
+     */
+    private static final int JIT_DUMP = 2;
+
+    /**
+     * The value of {@link #nativeMode()}, or 0 if no description is to be written.
+     */
+    private static int mode;
+
+    /**
+     * Finds the bytecode location of an instruction in the outermost method of its inlining chain.
+     */
+    private static final class OutermostPos implements TargetMethod.CodePosClosure {
+        ClassMethodActor method;
+        int bci;
+
+        public boolean doCodePos(ClassMethodActor method, int bci) {
+            this.method = method;
+            this.bci = bci;
+            return true;
+        }
+    }
+
+    /**
+     * Describes the methods in the boot code region if the VM was started with {@code -XX:+PerfMap} or
+     * {@code -XX:+JitDump}. This is called once in the {@linkplain com.sun.max.vm.MaxineVM.Phase#STARTING starting} phase.
+     */
+    public static void initialize() {
+        mode = nativeMode();
+        if (mode != 0) {
+            Code.bootCodeRegion().doAllTargetMethods(new TargetMethod.Closure() {
+                public boolean doTargetMethod(TargetMethod targetMethod) {
+                    describe(targetMethod, true);
+                    return true;
+                }
+            });
+        }
+    }
+
+    /**
+     * Describes a target method that has just been installed.
+     */
+    public static void methodInstalled(TargetMethod targetMethod) {
+        if (mode != 0 && targetMethod != null) {
+            describe(targetMethod, true);
+        }
+    }
+
+    /**
+     * Describes a target method that has been moved by code eviction. This is called during a GC.
+     */
+    public static void methodMoved(TargetMethod targetMethod) {
+        if (mode != 0) {
+            describe(targetMethod, false);
+        }
+    }
+
+    private static void describe(TargetMethod targetMethod, boolean withLines) {
+        final int codeLength = targetMethod.codeLength();
+        if (codeLength == 0) {
+            return;
+        }
+        final ClassMethodActor method = targetMethod.classMethodActor;
+        final Pointer name;
+        if (method == null) {
+            name = writeName(targetMethod.regionName(), null, null, targetMethod.isBaseline());
+        } else {
+            name = writeName(method.holder().name.string, method.name.string, method.descriptor().string, targetMethod.isBaseline());
+        }
+        if (name.isZero()) {
+            return;
+        }
+        Pointer lines = Pointer.zero();
+        int lineCount = 0;
+        Pointer fileName = Pointer.zero();
+        if (withLines && method != null && (mode & JIT_DUMP) != 0 && method.sourceFileName() != null) {
+            final Safepoints safepoints = targetMethod.safepoints();
+            lines = Memory.allocate(Size.fromInt(Math.max(1, safepoints.size()) * LINE_SIZE));
+            if (!lines.isZero()) {
+                lineCount = writeLines(targetMethod, safepoints, lines);
+                fileName = CString.utf8FromJava(method.sourceFileName());
+            }
+        }
+        nativeCodeLoaded(targetMethod.codeStart().toAddress(), codeLength, name, lines, lineCount, fileName);
+        Memory.deallocate(name);
+        if (!lines.isZero()) {
+            Memory.deallocate(lines);
+        }
+        if (!fileName.isZero()) {
+            Memory.deallocate(fileName);
+        }
+    }
+
+    /**
+     * Writes {@code holder.name(descriptor)} (or just {@code holder} for a stub or adapter) followed by
+     * the compiler tier to a C string that must be {@linkplain Memory#deallocate(Address) deallocated}.
+     */
+    private static Pointer writeName(String holder, String name, String descriptor, boolean baseline) {
+        final String tier = baseline ? " [baseline]" : " [optimized]";
+        int size = (holder.length() + tier.length() + 3) * 3;
+        if (name != null) {
+            size += (name.length() + descriptor.length()) * 3;
+        }
+        final Pointer buffer = Memory.allocate(Size.fromInt(size));
+        if (buffer.isZero()) {
+            return buffer;
+        }
+        final long end = buffer.toLong() + size;
+        long p = CString.writeUtf8(holder, buffer.toLong(), size, false) - 1;
+        if (name != null) {
+            p = CString.writeUtf8(".", p, (int) (end - p), false) - 1;
+            p = CString.writeUtf8(name, p, (int) (end - p), false) - 1;
+            p = CString.writeUtf8(descriptor, p, (int) (end - p), false) - 1;
+        }
+        CString.writeUtf8(tier, p, (int) (end - p), false);
+        return buffer;
+    }
+
+    /**
+     * Writes the source line number of each safepoint in a target method to a line table.
+     *
+     * @return the number of entries written
+     */
+    private static int writeLines(TargetMethod targetMethod, Safepoints safepoints, Pointer lines) {
+        final OutermostPos pos = new OutermostPos();
+        int count = 0;
+        for (int i = 0; i < safepoints.size(); i++) {
+            final int offset = safepoints.posAt(i);
+            pos.method = null;
+            if (targetMethod.forEachCodePos(pos, targetMethod.codeAt(offset)) == 0 || pos.method == null) {
+                continue;
+            }
+            final int line = pos.method.sourceLineNumber(pos.bci);
+            if (line > 0) {
+                lines.setInt(count * 2, offset);
+                lines.setInt(count * 2 + 1, line);
+                count++;
+            }
+        }
+        return count;
+    }
+
+    @C_FUNCTION
+    private static native int nativeMode();
+
+    @C_FUNCTION
+    private static native void nativeCodeLoaded(Address code, int size, Pointer name, Pointer lines, int lineCount, Pointer fileName);
+}
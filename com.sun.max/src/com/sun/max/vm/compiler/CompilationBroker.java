@@ -488,6 +488,7 @@ public class CompilationBroker {
                         compilation.relinquishOwnership();
                     } else {
                         tm = compilation.compile();
+                        PerfMap.methodInstalled(tm);
                         VMTI.handler().methodCompiled(cma);
                     }
                     if (MaxineVM.isRunning() && LogCompiledMethods) {
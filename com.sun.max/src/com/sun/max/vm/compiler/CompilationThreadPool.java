@@ -27,6 +27,7 @@ import java.util.*;
 import com.sun.max.vm.*;
 import com.sun.max.vm.actor.member.*;
 import com.sun.max.vm.Log;
+import com.sun.max.vm.code.*;
 import com.sun.max.vm.compiler.target.*;
 import com.sun.max.vm.thread.*;
 import com.sun.max.vm.ti.*;
@@ -132,6 +133,7 @@ public class CompilationThreadPool {
                 System.gc();
             }
             TargetMethod tm = compilation.compile();
+            PerfMap.methodInstalled(tm);
             VMTI.handler().methodCompiled(tm.classMethodActor);
         }
     }
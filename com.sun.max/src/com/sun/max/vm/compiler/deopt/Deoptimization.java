@@ -165,6 +165,8 @@ public class Deoptimization extends VmOperation {
     @Override
     protected void doIt() {
         Stub staticTrampoline = vm().stubs.staticTrampoline();
+        // Redirect the entry points of all the methods with a single instruction stream synchronisation
+        CodePatchBatch.begin();
         int i = 0;
         while (i < methods.size()) {
             TargetMethod tm = methods.get(i);
@@ -193,6 +195,7 @@ public class Deoptimization extends VmOperation {
                 i++;
             }
         }
+        CodePatchBatch.apply();
 
         // Scan the stacks to patch return addresses
         doAllThreads();
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2011, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ */
+package com.sun.max.vm.compiler.target;
+
+import com.sun.max.memory.*;
+import com.sun.max.unsafe.*;
+import com.sun.max.vm.*;
+import com.sun.max.vm.runtime.*;
+
+/**
+ * A batch of code patches that are applied together. When many call sites or entry points are
+ * patched at once (e.g. when {@linkplain com.sun.max.vm.compiler.deopt.Deoptimization deoptimizing}
+ * a set of methods), queuing the patches means that the instruction cache maintenance for
+ * neighbouring patches is merged and that a single membarrier synchronizes the instruction streams
+ * of all threads, instead of one flush and one barrier per patch.
+ *
+ * There is at most one open batch, opened and applied by the VM operation thread at a safepoint.
+ * Patching code that finds an {@linkplain #open() open} batch queues its writes instead of
+ * performing them.
+ */
+public final class CodePatchBatch {
+
+    /**
+     * The number of words in a queued patch: address, value and size. This must match the
+     * CodePatchStruct type in maxine.c.
+     */
+    private static final int WORDS_PER_PATCH = 3;
+
+    private static final int INITIAL_CAPACITY = 64;
+
+    private static final CodePatchBatch theBatch = new CodePatchBatch();
+
+    private static boolean isOpen;
+
+    /**
+     * The native array of queued patches.
+     */
+    private Pointer patches = Pointer.zero();
+
+    private int capacity;
+
+    private int count;
+
+    private CodePatchBatch() {
+    }
+
+    /**
+     * Opens the batch. Subsequent patches are queued until {@link #apply()} is called.
+     */
+    public static void begin() {
+        FatalError.check(VmOperation.atSafepoint(), "code patches should only be batched at a safepoint");
+        FatalError.check(!isOpen, "code patch batch already open");
+        isOpen = true;
+    }
+
+    /**
+     * Gets the open batch, if any.
+     *
+     * @return {@code null} if no batch is open
+     */
+    public static CodePatchBatch open() {
+        return isOpen ? theBatch : null;
+    }
+
+    /**
+     * Applies the queued patches and closes the batch.
+     */
+    public static void apply() {
+        FatalError.check(isOpen, "no code patch batch is open");
+        isOpen = false;
+        theBatch.flush();
+    }
+
+    /**
+     * Queues a 4 byte patch.
+     */
+    public void patchInt(Pointer address, int value) {
+        add(address, Address.fromInt(value), 4);
+    }
+
+    /**
+     * Queues an 8 byte patch.
+     */
+    public void patchLong(Pointer address, long value) {
+        add(address, Address.fromLong(value), 8);
+    }
+
+    private void add(Pointer address, Address value, int size) {
+        if (count == capacity) {
+            int newCapacity = capacity == 0 ? INITIAL_CAPACITY : capacity * 2;
+            Size newSize = Size.fromInt(newCapacity * WORDS_PER_PATCH * Word.size());
+            patches = patches.isZero() ? Memory.mustAllocate(newSize) : Memory.reallocate(patches, newSize);
+            capacity = newCapacity;
+        }
+        int index = count * WORDS_PER_PATCH;
+        patches.setWord(index, address);
+        patches.setWord(index + 1, value);
+        patches.setWord(index + 2, Address.fromInt(size));
+        count++;
+    }
+
+    private void flush() {
+        if (count != 0) {
+            MaxineVM.maxine_patch_code(patches, count, TargetMethod.useSystemMembarrier());
+            count = 0;
+        }
+    }
+}
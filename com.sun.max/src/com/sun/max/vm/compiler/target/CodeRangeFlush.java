@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2011, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ */
+package com.sun.max.vm.compiler.target;
+
+import static com.sun.max.platform.Platform.*;
+
+import com.sun.max.memory.*;
+import com.sun.max.unsafe.*;
+import com.sun.max.vm.*;
+
+/**
+ * A set of modified code ranges whose instruction cache maintenance is performed together. When code is
+ * written in many places before any of it executes (e.g. when {@linkplain com.sun.max.vm.code.CodeEviction
+ * moving} the surviving baseline methods or patching the deoptimization stubs), flushing the ranges with
+ * {@link MaxineVM#maxine_cache_flush_ranges} merges neighbouring ranges and executes the barriers once for
+ * the whole set, instead of once per range.
+ *
+ * On platforms whose instruction fetches observe modified code without cache maintenance, adding a range
+ * and flushing do nothing.
+ */
+public final class CodeRangeFlush {
+
+    /**
+     * The number of words in a range: start and size. This must match the CodeRangeStruct type in maxine.h.
+     */
+    private static final int WORDS_PER_RANGE = 2;
+
+    private static final int INITIAL_CAPACITY = 64;
+
+    /**
+     * The native array of ranges.
+     */
+    private Pointer ranges = Pointer.zero();
+
+    private int capacity;
+
+    private int count;
+
+    /**
+     * Determines whether modified code needs explicit instruction cache maintenance on this platform.
+     */
+    public static boolean isNeeded() {
+        return !MaxineVM.isHosted() && (platform().target.arch.isARM() || platform().target.arch.isAarch64() || platform().target.arch.isRISCV64());
+    }
+
+    /**
+     * Adds a modified range of code.
+     */
+    public void add(Address start, int size) {
+        if (size == 0 || !isNeeded()) {
+            return;
+        }
+        if (count == capacity) {
+            int newCapacity = capacity == 0 ? INITIAL_CAPACITY : capacity * 2;
+            Size newSize = Size.fromInt(newCapacity * WORDS_PER_RANGE * Word.size());
+            ranges = ranges.isZero() ? Memory.mustAllocate(newSize) : Memory.reallocate(ranges, newSize);
+            capacity = newCapacity;
+        }
+        int index = count * WORDS_PER_RANGE;
+        ranges.setWord(index, start);
+        ranges.setWord(index + 1, Address.fromInt(size));
+        count++;
+    }
+
+    /**
+     * Makes the modified code in all added ranges observable by the instruction fetches of all threads and empties the set.
+     */
+    public void flush() {
+        if (count != 0) {
+            MaxineVM.maxine_cache_flush_ranges(ranges, count);
+            count = 0;
+            TargetMethod.synchronizeInstructionStreams();
+        }
+    }
+}
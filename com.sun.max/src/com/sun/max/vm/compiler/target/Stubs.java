@@ -253,9 +253,11 @@ public class Stubs {
      * Performs all stub-related runtime initialization.
      */
     public void intialize() {
+        final CodeRangeFlush flush = new CodeRangeFlush();
         for (RuntimeInitialization ri : runtimeInits) {
-            ri.apply();
+            ri.apply(flush);
         }
+        flush.flush();
     }
 
     private void delayedInit() {
@@ -1833,7 +1835,10 @@ public class Stubs {
      */
     static abstract class RuntimeInitialization {
 
-        abstract void apply();
+        /**
+         * @param flush the set to which the ranges of modified code are added, which is flushed once all initializations are applied
+         */
+        abstract void apply(CodeRangeFlush flush);
     }
 
     /**
@@ -1865,14 +1870,14 @@ public class Stubs {
         }
 
         @Override
-        void apply() {
+        void apply(CodeRangeFlush flush) {
             Pointer patchAddr = stub.codeAt(pos).toPointer();
             int disp = runtimeRoutine.address().toInt();
             int instruction = ARMV7Assembler.movwHelper(ConditionFlag.Always, ARMV7.r12, disp & 0xffff);
             patchAddr.writeInt(0, instruction);
             instruction = ARMV7Assembler.movtHelper(ConditionFlag.Always, ARMV7.r12, (disp >> 16) & 0xffff);
             patchAddr.writeInt(4, instruction);
-            MaxineVM.maxine_cache_flush(patchAddr, 8);
+            flush.add(patchAddr, 8);
         }
     }
 
@@ -1905,7 +1910,7 @@ public class Stubs {
         }
 
         @Override
-        void apply() {
+        void apply(CodeRangeFlush flush) {
             Pointer patchAddr = stub.codeAt(pos).toPointer();
             patchAddr.writeLong(0, runtimeRoutine.address().toLong());
         }
@@ -1940,7 +1945,7 @@ public class Stubs {
         }
 
         @Override
-        void apply() {
+        void apply(CodeRangeFlush flush) {
             Pointer patchAddr = stub.codeAt(pos).toPointer();
             long disp = runtimeRoutine.address().toLong();
 
@@ -1959,7 +1964,7 @@ public class Stubs {
                 }
             }
 
-            MaxineVM.maxine_cache_flush(patchAddr, 16);
+            flush.add(patchAddr, 16);
         }
     }
 
@@ -1992,7 +1997,7 @@ public class Stubs {
         }
 
         @Override
-        void apply() {
+        void apply(CodeRangeFlush flush) {
             Pointer patchAddr = stub.codeAt(pos).toPointer();
             long disp = runtimeRoutine.address().toLong();
 
@@ -2039,7 +2044,7 @@ public class Stubs {
             int addInstr = RISCV64MacroAssembler.addSubInstructionHelper(RISCV64.x28, RISCV64.x28, RISCV64.x29, false);
             patchAddr.writeInt(20, addInstr);
 
-            MaxineVM.maxine_cache_flush(patchAddr, 24);
+            flush.add(patchAddr, 24);
         }
     }
 
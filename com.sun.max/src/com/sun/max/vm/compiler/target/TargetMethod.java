@@ -910,18 +910,29 @@ public abstract class TargetMethod extends MemoryRegion {
      * up any call-sites that need to be patched.
      */
     public void maybeCleanCache() {
-        if (!MaxineVM.isHosted() && (platform().target.arch.isARM() || platform().target.arch.isAarch64() || platform().target.arch.isRISCV64())) {
+        if (CodeRangeFlush.isNeeded()) {
             long longSize = size().toLong();
             int size = (int) longSize;
             assert size == longSize : "Integer overflow";
             MaxineVM.maxine_cache_flush(start, size);
-            /*
-             * Aarch64 requires an ISB instruction is executed on concurrently executing CPUs to discard
-             * speculatively pre-fetched addresses from buffers. See B2.2.5 ARM ARM (issue E.a).
-             */
-            if (UseSystemMembarrier && platform().target.arch.isAarch64()) {
-                MaxineVM.syscall_membarrier();
-            }
+            synchronizeInstructionStreams();
+        }
+    }
+
+    /**
+     * Discards the instructions that other threads may have fetched before code was modified and its
+     * instruction cache lines were flushed.
+     */
+    static void synchronizeInstructionStreams() {
+        /*
+         * Aarch64 requires an ISB instruction is executed on concurrently executing CPUs to discard
+         * speculatively pre-fetched addresses from buffers. See B2.2.5 ARM ARM (issue E.a).
+         * Likewise, a FENCE.I on RISC-V only synchronises the instruction stream of the executing hart.
+         * The core serializing barrier provides both where the kernel supports it.
+         */
+        if (UseSystemMembarrier && (platform().target.arch.isAarch64() ||
+                        (platform().target.arch.isRISCV64() && MaxineVM.membarrier_isAvailable()))) {
+            MaxineVM.syscall_membarrierSyncCore();
         }
     }
 
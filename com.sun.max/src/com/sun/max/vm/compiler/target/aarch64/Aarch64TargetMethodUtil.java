@@ -47,6 +47,7 @@ import com.sun.max.unsafe.Pointer;
 import com.sun.max.vm.MaxineVM;
 import com.sun.max.vm.compiler.CallEntryPoint;
 import com.sun.max.vm.compiler.target.AdapterGenerator;
+import com.sun.max.vm.compiler.target.CodePatchBatch;
 import com.sun.max.vm.compiler.target.Safepoints;
 import com.sun.max.vm.compiler.target.TargetMethod;
 import com.sun.max.vm.runtime.FatalError;
@@ -281,6 +282,19 @@ public final class Aarch64TargetMethodUtil {
         Pointer code = tm.codeStart().toPointer();
         int offset = BASELINE_ENTRY_POINT.offset();
 
+        CodePatchBatch batch = CodePatchBatch.open();
+        if (batch != null) {
+            // The cache maintenance and barrier are performed once for the whole batch
+            do {
+                batch.patchInt(code.plus(offset), nopHelper());
+                offset += INSTRUCTION_SIZE;
+            } while (offset < OPTIMIZED_ENTRY_POINT.offset());
+            batch.patchInt(code.plus(offset), LDR_X16_8);
+            batch.patchInt(code.plus(offset += INSTRUCTION_SIZE), BR_X16);
+            batch.patchLong(code.plus(offset += INSTRUCTION_SIZE), target.toLong());
+            return;
+        }
+
         synchronized (PatchingLock) {
             do {
                 code.writeInt(offset, nopHelper());
@@ -46,6 +46,7 @@ import com.sun.max.vm.run.java.JavaRunScheme;
 import com.sun.max.vm.runtime.*;
 import com.sun.max.vm.thread.*;
 import com.sun.max.vm.thread.VmThreadLocal.Nature;
+import com.sun.max.vm.ti.*;
 
 /**
  * A HeapScheme adaptor with support for thread local allocation buffers (TLABs). The adaptor factors out methods for
@@ -148,6 +149,33 @@ public abstract class HeapSchemeWithTLAB extends HeapSchemeAdaptor {
     private static final VmThreadLocal ALLOCATION_DISABLED
         = new VmThreadLocal(TLAB_DISABLED_THREAD_LOCAL_NAME, false, "HeapSchemeWithTLAB: disables per thread allocation if non-zero");
 
+    /**
+     * The number of bytes the current thread may allocate before its next allocation is sampled.
+     *
+     * @see #setAllocationSamplingInterval(long)
+     */
+    private static final VmThreadLocal ALLOCATION_SAMPLE_COUNTDOWN
+        = new VmThreadLocal("ALLOCATION_SAMPLE_COUNTDOWN", false, "HeapSchemeWithTLAB: bytes to allocate before the next allocation sample", Nature.Single);
+
+    /**
+     * The TLAB allocation mark from which the bytes allocated by the current thread have not yet been counted
+     * against {@link #ALLOCATION_SAMPLE_COUNTDOWN}.
+     */
+    private static final VmThreadLocal ALLOCATION_SAMPLE_MARK
+        = new VmThreadLocal("ALLOCATION_SAMPLE_MARK", false, "HeapSchemeWithTLAB: TLAB mark at the last allocation sample countdown", Nature.Single);
+
+    /**
+     * The cell of a sampled allocation that has not yet been delivered to {@link VMTIHandler#objectSampled(Object)}.
+     */
+    private static final VmThreadLocal SAMPLED_ALLOCATION
+        = new VmThreadLocal("SAMPLED_ALLOCATION", false, "HeapSchemeWithTLAB: cell of an undelivered allocation sample", Nature.Single);
+
+    /**
+     * The average number of bytes allocated by a thread between two sampled allocations, or 0 if allocations
+     * are not sampled.
+     */
+    private static long allocationSamplingInterval;
+
     /**
      * A procedure for resetting the TLAB of a thread.
      */
@@ -184,6 +212,9 @@ public abstract class HeapSchemeWithTLAB extends HeapSchemeAdaptor {
             doBeforeReset(etla, tlabMark, tlabTop);
             TLAB_TOP.store(etla, Address.zero());
             TLAB_MARK.store(etla, Address.zero());
+            // A sample that has not been delivered refers to a cell the GC may move.
+            ALLOCATION_SAMPLE_MARK.store(etla, Address.zero());
+            SAMPLED_ALLOCATION.store(etla, Address.zero());
         }
     }
 
@@ -547,7 +578,66 @@ public abstract class HeapSchemeWithTLAB extends HeapSchemeAdaptor {
         }
         globalTlabStats.tlabOverflowCount++;
         // This path will always be taken if TLAB allocation is not enabled.
-        return handleTLABOverflow(size, etla, oldAllocationMark, tlabEnd);
+        final Pointer cell = handleTLABOverflow(size, etla, oldAllocationMark, tlabEnd);
+        if (allocationSamplingInterval != 0) {
+            countSampledAllocation(size, etla, oldAllocationMark, cell);
+        }
+        return cell;
+    }
+
+    /**
+     * Sets the average number of bytes allocated by a thread between two allocations that are
+     * {@linkplain VMTIHandler#objectSampled(Object) sampled}.
+     * <p>
+     * The allocations are counted when a TLAB is refilled, so the fast path of allocation is unchanged and the
+     * intervals are rounded up to the TLAB size. A sampled allocation is reported at the next safepoint poll of the
+     * allocating thread, which is triggered by the refill and reached right after the object has been initialized.
+     * A sample is dropped if a GC happens before it is reported.
+     *
+     * @param bytes the sampling interval, or 0 to stop sampling
+     */
+    public static void setAllocationSamplingInterval(long bytes) {
+        allocationSamplingInterval = bytes;
+    }
+
+    /**
+     * Counts the bytes allocated since the last refill against the sampling countdown of the current thread
+     * and samples the allocation of {@code cell} if the countdown has expired.
+     */
+    @NO_SAFEPOINT_POLLS("object allocation and initialization must be atomic")
+    @NEVER_INLINE
+    private static void countSampledAllocation(Size size, Pointer etla, Pointer oldAllocationMark, Pointer cell) {
+        final Pointer sampleMark = ALLOCATION_SAMPLE_MARK.load(etla);
+        long allocated = size.toLong();
+        if (!sampleMark.isZero() && oldAllocationMark.greaterEqual(sampleMark)) {
+            allocated += oldAllocationMark.minus(sampleMark).toLong();
+        }
+        long countdown = ALLOCATION_SAMPLE_COUNTDOWN.load(etla).asAddress().toLong() - allocated;
+        if (countdown <= 0) {
+            countdown = allocationSamplingInterval;
+            if (!VmThread.current().isVmOperationThread()) {
+                SAMPLED_ALLOCATION.store(etla, cell);
+                // Trap at the next safepoint poll, where the sample is reported.
+                SAFEPOINT_LATCH.store(etla, TTLA.load(currentTLA()));
+            }
+        }
+        ALLOCATION_SAMPLE_COUNTDOWN.store(etla, Address.fromLong(countdown));
+        ALLOCATION_SAMPLE_MARK.store(etla, TLAB_MARK.load(etla));
+    }
+
+    /**
+     * Gets and clears the object of the allocation sample recorded for the current thread. This is called by the
+     * safepoint trap handler.
+     *
+     * @return the sampled object, or {@code null} if there is none
+     */
+    public static Object takeSampledAllocation(Pointer etla) {
+        final Pointer cell = SAMPLED_ALLOCATION.load(etla);
+        if (cell.isZero()) {
+            return null;
+        }
+        SAMPLED_ALLOCATION.store(etla, Address.zero());
+        return Reference.fromOrigin(Layout.cellToOrigin(cell)).toJava();
     }
 
     @NEVER_INLINE
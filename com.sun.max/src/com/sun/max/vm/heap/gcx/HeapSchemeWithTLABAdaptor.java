@@ -105,6 +105,7 @@ public abstract class HeapSchemeWithTLABAdaptor extends HeapSchemeWithTLAB {
             if (Heap.logGCTime()) {
                 heapStartupTime.report("allocateHeapAndGCStorage", Log.out);
                 VirtualMemory.reportMetrics();
+                Memory.reportStatistics();
             }
         }
     }
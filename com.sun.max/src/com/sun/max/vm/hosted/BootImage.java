@@ -28,6 +28,7 @@ import java.lang.reflect.*;
 import java.nio.*;
 import java.nio.channels.FileChannel.*;
 import java.util.*;
+import java.util.zip.*;
 
 import com.sun.max.config.*;
 import com.sun.max.lang.*;
@@ -66,6 +67,17 @@ import com.sun.max.vm.type.*;
  *
  * </pre>
  *
+ * If {@link Header#compressionChunkSize} is not 0, the heap and code sections are replaced by a
+ * compressed section of {@link Header#compressedHeapAndCodeSize} bytes:
+ * <pre>
+ *
+ *          int[numberOfChunks] chunk_sizes; // the compressed size of each chunk
+ *          byte[] chunks;                   // the heap and code, each compressionChunkSize bytes compressed separately
+ *
+ * </pre>
+ *
+ * Each chunk is compressed in the zlib format (see {@link Deflater}) and can thus be decompressed independently.
+ *
  * The 'pad' member in the image exists so that in-memory images can be supported. That is, if the
  * VM obtains the image from a memory location as opposed to loading it from a file, then the
  * page-alignment requirement for the heap and code sections in the image will be satisfied if the
@@ -82,7 +94,12 @@ public class BootImage {
     /**
      * A version number of the boot image file layout, checked against IMAGE_FORMAT_VERSION in Native/substrate/image.c .
      */
-    public static final int BOOT_IMAGE_FORMAT_VERSION = 2;
+    public static final int BOOT_IMAGE_FORMAT_VERSION = 4;
+
+    /**
+     * The number of bytes of heap and code in each chunk of a compressed boot image.
+     */
+    public static final int COMPRESSION_CHUNK_SIZE = 1024 * 1024;
 
     /**
      * A field section in a boot image is described by the {@code public final} and {@code final}
@@ -234,6 +251,24 @@ public class BootImage {
          */
         public final int bootRegionMappingConstraint;
 
+        /**
+         * The address (in MB) at which the boot heap region would prefer to be mapped, or 0 if there is no preference.
+         * If non-zero, the pointers in the heap and code sections are written already relocated to this address so that
+         * the boot image loader can skip relocation altogether when it manages to map the boot heap there.
+         */
+        public final int preferredHeapAddressMB;
+
+        /**
+         * The number of bytes of heap and code per independently compressed chunk, or 0 if the heap and code are not compressed.
+         */
+        public final int compressionChunkSize;
+
+        /**
+         * The size of the compressed heap and code section (i.e. the chunk table and the compressed chunks),
+         * or 0 if the heap and code are not compressed.
+         */
+        public final int compressedHeapAndCodeSize;
+
         /**
          * @see VmThreadMap#ACTIVE
          */
@@ -305,6 +340,9 @@ public class BootImage {
             reservedVirtualSpaceSize = endian.readInt(dataInputStream);
             reservedVirtualSpaceFieldOffset = endian.readInt(dataInputStream);
             bootRegionMappingConstraint = endian.readInt(dataInputStream);
+            preferredHeapAddressMB = endian.readInt(dataInputStream);
+            compressionChunkSize = endian.readInt(dataInputStream);
+            compressedHeapAndCodeSize = endian.readInt(dataInputStream);
             tlaListHeadOffset = endian.readInt(dataInputStream);
             exitCodeOffset = endian.readInt(dataInputStream);
 
@@ -334,7 +372,7 @@ public class BootImage {
             return staticTupleOrigin.toInt() + fieldActor.offset();
         }
 
-        private Header(DataPrototype dataPrototype, int stringInfoSize) {
+        private Header(DataPrototype dataPrototype, int stringInfoSize, long preferredHeapAddress, int compressionChunkSize, int compressedHeapAndCodeSize) {
             super(platform().endianness(), 0);
             final VMConfiguration vmConfiguration = vmConfig();
             isBigEndian = endianness() == Endianness.LITTLE ? 0 : 0xffffffff;
@@ -362,6 +400,9 @@ public class BootImage {
             reservedVirtualSpaceSize = vmConfiguration.heapScheme().reservedVirtualSpaceKB();
             reservedVirtualSpaceFieldOffset = staticFieldPointerOffset(dataPrototype, Heap.class, "reservedVirtualSpace");
             bootRegionMappingConstraint = vmConfiguration.heapScheme().bootRegionMappingConstraint().ordinal();
+            preferredHeapAddressMB = (int) (preferredHeapAddress / Longs.M);
+            this.compressionChunkSize = compressionChunkSize;
+            this.compressedHeapAndCodeSize = compressedHeapAndCodeSize;
             tlaListHeadOffset = dataPrototype.objectToOrigin(VmThreadMap.ACTIVE).toInt() + ClassActor.fromJava(VmThreadMap.class).findLocalInstanceFieldActor("tlaListHead").offset();
             exitCodeOffset = staticFieldPointerOffset(dataPrototype, MaxineVM.class, "exitCode");
 
@@ -392,6 +433,29 @@ public class BootImage {
             BootImageException.check(cacheAlignment > 4 && Ints.isPowerOfTwoOrZero(cacheAlignment), "implausible alignment size: " + cacheAlignment);
             BootImageException.check(pageSize >= Longs.K && pageSize % Longs.K == 0, "implausible page size: " + pageSize);
             BootImageException.check(!(bootRegionMappingConstraint > 0 && reservedVirtualSpaceSize == 0), "invalid boot region mapping constraint");
+            BootImageException.check(preferredHeapAddressMB >= 0, "invalid preferred heap address: " + preferredHeapAddressMB + "MB");
+            BootImageException.check(compressionChunkSize >= 0 && compressionChunkSize % pageSize == 0, "invalid compression chunk size: " + compressionChunkSize);
+            BootImageException.check((compressionChunkSize == 0) == (compressedHeapAndCodeSize == 0), "inconsistent compressed heap and code size: " + compressedHeapAndCodeSize);
+        }
+
+        /**
+         * Gets the address at which the pointers in the heap and code sections of the image file are relocated.
+         *
+         * @return 0 if the image file is canonical (i.e. the heap and code are relocated to address 0)
+         */
+        public long preferredHeapAddress() {
+            return preferredHeapAddressMB * Longs.M;
+        }
+
+        public boolean isCompressed() {
+            return compressionChunkSize != 0;
+        }
+
+        /**
+         * Gets the number of chunks in the compressed heap and code section.
+         */
+        public int numberOfCompressedChunks() {
+            return (heapSize + codeSize + compressionChunkSize - 1) / compressionChunkSize;
         }
 
         @Override
@@ -645,11 +709,24 @@ public class BootImage {
     private ByteBuffer heapAndCode;
     public final File imageFile;
 
+    /**
+     * The compressed chunks of the heap and code of an image being written, or null if the image is not compressed.
+     */
+    private final byte[][] compressedChunks;
+
+    /**
+     * The address to which the canonical heap and code of an uncompressed image being written are still to be
+     * relocated, or 0 if they have been relocated. Deferring the relocation lets {@link #write(File)} perform
+     * it in parallel on the mapped image file instead of serially in Java.
+     */
+    private long pendingRelocation;
+
     /**
      * Creates a BootImage object representing the information in a given boot image file.
      */
     public BootImage(File file) throws BootImageException {
         this.imageFile = file;
+        this.compressedChunks = null;
         try {
             final FileInputStream fileInputStream = new FileInputStream(file);
             try {
@@ -681,8 +758,8 @@ public class BootImage {
                                                       stringInfo.bootImagePackage(Key.MONITOR),
                                                       stringInfo.bootImagePackage(Key.RUN)).gatherBootImagePackages();
 
-                fileInputStream.skip(header.heapSize + header.codeSize);
-                int trailerOffset = codeOffset() + header.codeSize;
+                fileInputStream.skip(heapAndCodeSectionSize());
+                int trailerOffset = heapOffset() + heapAndCodeSectionSize();
                 trailer = new Trailer(header, fileInputStream, trailerOffset);
                 trailer.check(header);
             } catch (Utf8Exception utf8Exception) {
@@ -699,20 +776,157 @@ public class BootImage {
      * Used when constructing a boot image to be written to a file.
      */
     public BootImage(DataPrototype dataPrototype) throws BootImageException {
+        this(dataPrototype, 0L, false);
+    }
+
+    /**
+     * Used when constructing a boot image to be written to a file.
+     *
+     * @param preferredHeapAddress the address at which the boot heap should preferably be mapped by the
+     *            boot image loader (a multiple of 1MB) or 0 to write a canonical image
+     * @param compress specifies if the heap and code sections are to be written in compressed chunks
+     */
+    public BootImage(DataPrototype dataPrototype, long preferredHeapAddress, boolean compress) throws BootImageException {
+        BootImageException.check(preferredHeapAddress % Longs.M == 0, "preferred heap address must be a multiple of 1MB: 0x" + Long.toHexString(preferredHeapAddress));
         this.vmConfiguration = vmConfig();
-        this.stringInfo = new StringInfo(vmConfiguration, new Header(dataPrototype, 0).size());
+        this.stringInfo = new StringInfo(vmConfiguration, new Header(dataPrototype, 0, preferredHeapAddress, 0, 0).size());
         this.stringInfo.check();
-        this.header = new Header(dataPrototype, stringInfo.size());
-        this.header.check();
         this.relocationData = dataPrototype.relocationData();
-        this.padding = new byte[deltaToPageAlign(header.size() + stringInfo.size() + relocationData.length)];
         this.heap = ByteBuffer.wrap(dataPrototype.heapData());
         this.code = ByteBuffer.wrap(dataPrototype.codeData());
-        int trailerOffset = codeOffset() + header.codeSize;
+        if (preferredHeapAddress != 0L) {
+            if (compress) {
+                relocateCanonical(preferredHeapAddress);
+            } else {
+                pendingRelocation = preferredHeapAddress;
+            }
+        }
+        int compressedHeapAndCodeSize = 0;
+        if (compress) {
+            this.compressedChunks = compress(dataPrototype.heapData(), dataPrototype.codeData());
+            compressedHeapAndCodeSize = compressedChunks.length * Ints.SIZE;
+            for (byte[] chunk : compressedChunks) {
+                compressedHeapAndCodeSize += chunk.length;
+            }
+        } else {
+            this.compressedChunks = null;
+        }
+        this.header = new Header(dataPrototype, stringInfo.size(), preferredHeapAddress, compress ? COMPRESSION_CHUNK_SIZE : 0, compressedHeapAndCodeSize);
+        this.header.check();
+        this.padding = new byte[deltaToPageAlign(header.size() + stringInfo.size() + relocationData.length)];
+        int trailerOffset = heapOffset() + heapAndCodeSectionSize();
         this.trailer = new Trailer(header, trailerOffset);
         this.imageFile = null;
     }
 
+    /**
+     * Compresses the (contiguous) heap and code in chunks of {@link #COMPRESSION_CHUNK_SIZE} bytes.
+     */
+    private static byte[][] compress(byte[] heapData, byte[] codeData) {
+        final byte[] heapAndCode = new byte[heapData.length + codeData.length];
+        System.arraycopy(heapData, 0, heapAndCode, 0, heapData.length);
+        System.arraycopy(codeData, 0, heapAndCode, heapData.length, codeData.length);
+        final byte[][] chunks = new byte[(heapAndCode.length + COMPRESSION_CHUNK_SIZE - 1) / COMPRESSION_CHUNK_SIZE][];
+        final Deflater deflater = new Deflater(Deflater.BEST_COMPRESSION);
+        final byte[] buffer = new byte[COMPRESSION_CHUNK_SIZE];
+        for (int i = 0; i < chunks.length; i++) {
+            final int offset = i * COMPRESSION_CHUNK_SIZE;
+            final ByteArrayOutputStream chunk = new ByteArrayOutputStream();
+            deflater.reset();
+            deflater.setInput(heapAndCode, offset, Math.min(COMPRESSION_CHUNK_SIZE, heapAndCode.length - offset));
+            deflater.finish();
+            while (!deflater.finished()) {
+                chunk.write(buffer, 0, deflater.deflate(buffer));
+            }
+            chunks[i] = chunk.toByteArray();
+        }
+        deflater.end();
+        return chunks;
+    }
+
+    /**
+     * Decompresses the heap and code section of a compressed image file.
+     */
+    private byte[] decompressHeapAndCode() {
+        final ByteBuffer section = mapSection(heapOffset(), header.compressedHeapAndCodeSize).order(header.endianness().asByteOrder());
+        final byte[] heapAndCode = new byte[header.heapSize + header.codeSize];
+        final int numberOfChunks = header.numberOfCompressedChunks();
+        final Inflater inflater = new Inflater();
+        int compressedOffset = numberOfChunks * Ints.SIZE;
+        try {
+            for (int i = 0; i < numberOfChunks; i++) {
+                final int compressedSize = section.getInt(i * Ints.SIZE);
+                final byte[] compressed = new byte[compressedSize];
+                section.position(compressedOffset);
+                section.get(compressed);
+                compressedOffset += compressedSize;
+                final int offset = i * header.compressionChunkSize;
+                final int size = Math.min(header.compressionChunkSize, heapAndCode.length - offset);
+                inflater.reset();
+                inflater.setInput(compressed);
+                if (inflater.inflate(heapAndCode, offset, size) != size || !inflater.finished()) {
+                    throw new InternalError("Corrupt compressed chunk " + i + " in image file");
+                }
+            }
+        } catch (DataFormatException e) {
+            throw new InternalError("Error trying to decompress image file: " + e);
+        } finally {
+            inflater.end();
+        }
+        return heapAndCode;
+    }
+
+    /**
+     * Relocates the canonical pointers in the heap and code sections of an image being written.
+     * This mirrors {@code relocation_apply()} in "com.oracle.max.vm.native/share/relocation.c".
+     *
+     * @param relocatedHeap the address to which the heap and code are being relocated
+     */
+    private void relocateCanonical(long relocatedHeap) {
+        final ByteOrder byteOrder = platform().endianness().asByteOrder();
+        final ByteBuffer heapBuffer = heap.duplicate().order(byteOrder);
+        final ByteBuffer codeBuffer = code.duplicate().order(byteOrder);
+        final int wordSize = platform().wordWidth().numberOfBytes;
+        final int heapSize = heapBuffer.limit();
+        for (int i = 0; i < relocationData.length; i++) {
+            final int bits = relocationData[i] & 0xff;
+            if (bits == 0) {
+                continue;
+            }
+            for (int bit = 0; bit < 8; bit++) {
+                if ((bits & (1 << bit)) != 0) {
+                    int offset = ((i * 8) + bit) * wordSize;
+                    ByteBuffer buffer = heapBuffer;
+                    if (offset >= heapSize) {
+                        offset -= heapSize;
+                        buffer = codeBuffer;
+                    }
+                    if (wordSize == Longs.SIZE) {
+                        final long value = buffer.getLong(offset);
+                        if (value != 0L) {
+                            buffer.putLong(offset, value + relocatedHeap);
+                        }
+                    } else {
+                        final int value = buffer.getInt(offset);
+                        if (value != 0) {
+                            buffer.putInt(offset, value + (int) relocatedHeap);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * Performs the relocation deferred by the constructor before the heap or code is accessed as relocated data.
+     */
+    private void relocatePending() {
+        if (pendingRelocation != 0L) {
+            relocateCanonical(pendingRelocation);
+            pendingRelocation = 0L;
+        }
+    }
+
     public int relocationDataOffset() {
         return header.size() + stringInfo.size();
     }
@@ -733,7 +947,29 @@ public class BootImage {
         return padding.length;
     }
 
+    /**
+     * Gets the size of the heap and code section(s) in the image file.
+     */
+    public int heapAndCodeSectionSize() {
+        return header.isCompressed() ? header.compressedHeapAndCodeSize : header.heapSize + header.codeSize;
+    }
+
+    private void decompressSections() {
+        final ByteBuffer buffer = ByteBuffer.wrap(decompressHeapAndCode());
+        buffer.order(platform().endianness().asByteOrder());
+        heapAndCode = buffer;
+        buffer.limit(header.heapSize);
+        heap = buffer.slice().order(buffer.order());
+        buffer.limit(header.heapSize + header.codeSize).position(header.heapSize);
+        code = buffer.slice().order(buffer.order());
+        buffer.position(0);
+    }
+
     public synchronized ByteBuffer heap() {
+        relocatePending();
+        if (heap == null && header.isCompressed()) {
+            decompressSections();
+        }
         if (heap == null) {
             heap = mapSection(heapOffset(), header.heapSize);
         }
@@ -743,6 +979,10 @@ public class BootImage {
     }
 
     public synchronized ByteBuffer code() {
+        relocatePending();
+        if (code == null && header.isCompressed()) {
+            decompressSections();
+        }
         if (code == null) {
             code = mapSection(codeOffset(), header.codeSize);
         }
@@ -752,6 +992,10 @@ public class BootImage {
     }
 
     public synchronized ByteBuffer heapAndCode() {
+        relocatePending();
+        if (heapAndCode == null && header.isCompressed()) {
+            decompressSections();
+        }
         if (heapAndCode == null) {
             heapAndCode = mapSection(heapOffset(), header.heapSize + header.codeSize);
         }
@@ -771,11 +1015,101 @@ public class BootImage {
         stringInfo.write(outputStream, header.endianness());
         outputStream.write(relocationData);
         outputStream.write(padding);
-        write(heap(), outputStream);
-        write(code(), outputStream);
+        if (compressedChunks != null) {
+            for (byte[] chunk : compressedChunks) {
+                header.endianness().writeInt(outputStream, chunk.length);
+            }
+            for (byte[] chunk : compressedChunks) {
+                outputStream.write(chunk);
+            }
+        } else {
+            write(heap(), outputStream);
+            write(code(), outputStream);
+        }
         trailer.write(outputStream, header.endianness());
     }
 
+    /**
+     * Gets the size of the image file.
+     */
+    public int imageFileSize() {
+        return heapOffset() + heapAndCodeSectionSize() + trailer.size();
+    }
+
+    /**
+     * Writes this image to a given file. The file is mapped into memory at its full size and each section is
+     * written straight into the mapping. Any relocation of the heap and code still pending is then performed in
+     * place, in parallel, and the mapping is synchronized with the file once. If the file cannot be mapped, the
+     * image is written {@linkplain #write(OutputStream) to a stream} instead.
+     *
+     * @param file the file to which to write this image
+     * @throws IOException
+     */
+    public synchronized void write(File file) throws IOException {
+        Prototype.loadHostedLibrary();
+        final ByteBuffer image = nativeMapImageFile(file.getPath(), imageFileSize());
+        if (image == null) {
+            final OutputStream outputStream = new BufferedOutputStream(new FileOutputStream(file));
+            try {
+                write(outputStream);
+            } finally {
+                outputStream.close();
+            }
+            return;
+        }
+        image.order(header.endianness().asByteOrder());
+        final OutputStream outputStream = new ByteBufferOutputStream(image);
+        header.write(outputStream, header.endianness());
+        stringInfo.write(outputStream, header.endianness());
+        image.put(relocationData);
+        image.put(padding);
+        if (compressedChunks != null) {
+            for (byte[] chunk : compressedChunks) {
+                image.putInt(chunk.length);
+            }
+            for (byte[] chunk : compressedChunks) {
+                image.put(chunk);
+            }
+        } else {
+            image.put(heap == null ? heap() : sectionData(heap));
+            image.put(code == null ? code() : sectionData(code));
+            if (pendingRelocation != 0L) {
+                nativeRelocateMappedImage(image, relocationDataOffset(), relocationData.length, heapOffset(), pendingRelocation, header.isBigEndian, header.wordSize);
+            }
+        }
+        trailer.write(outputStream, header.endianness());
+        if (!nativeUnmapImageFile(image)) {
+            throw new IOException("could not synchronize mapped image file: " + file);
+        }
+    }
+
+    private static ByteBuffer sectionData(ByteBuffer section) {
+        final ByteBuffer duplicate = section.duplicate();
+        duplicate.clear();
+        return duplicate;
+    }
+
+    /**
+     * An output stream that writes to the current position of a buffer.
+     */
+    private static final class ByteBufferOutputStream extends OutputStream {
+        private final ByteBuffer buffer;
+
+        ByteBufferOutputStream(ByteBuffer buffer) {
+            this.buffer = buffer;
+        }
+
+        @Override
+        public void write(int b) {
+            buffer.put((byte) b);
+        }
+
+        @Override
+        public void write(byte[] b, int off, int len) {
+            buffer.put(b, off, len);
+        }
+    }
+
     private void write(ByteBuffer buffer, OutputStream outputStream) throws IOException {
         if (buffer.hasArray()) {
             outputStream.write(buffer.array(), buffer.arrayOffset(), buffer.limit());
@@ -820,16 +1154,40 @@ public class BootImage {
         }
     }
 
+    /**
+     * Creates (or truncates) a file of a given size and maps it into memory for writing.
+     *
+     * @return a direct buffer covering the whole file or {@code null} if the file could not be mapped
+     */
+    private static native ByteBuffer nativeMapImageFile(String path, int size);
+
+    /**
+     * Relocates the heap and code of an image written to a buffer returned by {@link #nativeMapImageFile}, using
+     * the relocation data in the same buffer.
+     */
+    private static native void nativeRelocateMappedImage(ByteBuffer image, int relocationDataOffset, int relocationDataSize, int heapOffset, long relocatedHeap, int isBigEndian, int wordSize);
+
+    /**
+     * Synchronizes and unmaps a buffer returned by {@link #nativeMapImageFile}. The buffer must not be used afterwards.
+     *
+     * @return {@code false} if the mapped data could not be written back to the file
+     */
+    private static native boolean nativeUnmapImageFile(ByteBuffer image);
+
     private static native void nativeRelocate(long heap, long relocatedHeap, byte[] relocationDataPointer, int relocationDataSize, int isBigEndian, int wordSize);
 
     /**
-     * Relocates the pointers in the heap and code. All the pointers are assumed to be
-     * canonicalized; their current values assume that the heap and code start address 0.
+     * Relocates the pointers in the heap and code. The current values of the pointers assume that the
+     * heap and code start at {@linkplain Header#preferredHeapAddress() the preferred heap address},
+     * which is 0 for a canonical image.
      *
      * @param heap the physical address at which the (contiguous) heap and code reside
      * @param relocatedHeap the logical address to which the heap and code is being relocated
      */
     public void relocate(long heap, Address relocatedHeap) {
-        nativeRelocate(heap, relocatedHeap.toLong(), relocationData, relocationData.length, header.isBigEndian, header.wordSize);
+        final long delta = relocatedHeap.toLong() - header.preferredHeapAddress();
+        if (delta != 0L) {
+            nativeRelocate(heap, delta, relocationData, relocationData.length, header.isBigEndian, header.wordSize);
+        }
     }
 }
@@ -98,6 +98,19 @@ public final class BootImageGenerator {
     private static final Option<Boolean> useNumaProfiler = options.newBooleanOption("use-numa-profiler", false,
             "Uses NUMA memory profiler.");
 
+    private static final Option<Long> preferredHeapAddressOption = options.newLongOption("preferred-heap-address", 0L,
+            "The address (a multiple of 1MB) at which the boot image loader should preferably map the boot heap. " +
+            "If non-zero, the image is written already relocated to this address and no relocation is performed " +
+            "at load-time if the boot heap can be mapped there.");
+
+    private static final Option<Boolean> compressImageOption = options.newBooleanOption("compress-image", false,
+            "Compresses the heap and code sections of the boot image in independently decompressible chunks " +
+            "that the boot image loader decompresses in parallel.");
+
+    private static final Option<Boolean> mapImageOption = options.newBooleanOption("map-image", true,
+            "Writes the boot image file through a memory mapping of the whole file, relocating the heap and code " +
+            "in place and in parallel, instead of through a stream.");
+
     // Options shared with the Inspector
     public static final OptionSet inspectorSharedOptions = new OptionSet();
 
@@ -368,9 +381,22 @@ public final class BootImageGenerator {
      * @param file          the file to which to write the data prototype
      */
     private void writeImage(DataPrototype dataPrototype, File file) {
+        if (mapImageOption.getValue()) {
+            try {
+                final BootImage bootImage = new BootImage(dataPrototype, preferredHeapAddressOption.getValue(), compressImageOption.getValue());
+                Trace.begin(1, "writing boot image file: " + file);
+                bootImage.write(file);
+                Trace.end(1, "end boot image file: " + file + " (" + Longs.toUnitsString(file.length(), false) + ")");
+            } catch (IOException ioException) {
+                throw ProgramError.unexpected("could not write file: " + file, ioException);
+            } catch (BootImageException bootImageException) {
+                throw ProgramError.unexpected("could not construct proper boot image", bootImageException);
+            }
+            return;
+        }
         try {
             final FileOutputStream outputStream = new FileOutputStream(file);
-            final BootImage bootImage = new BootImage(dataPrototype);
+            final BootImage bootImage = new BootImage(dataPrototype, preferredHeapAddressOption.getValue(), compressImageOption.getValue());
             try {
                 Trace.begin(1, "writing boot image file: " + file);
                 bootImage.write(outputStream);
@@ -231,11 +231,11 @@ public class BootImagePrinter {
     }
 
     private void printHeap(PrintStream out, Range subregion) {
-        printHeapOrCodeData(out, "HEAP", heapRegion, bootImage.heapAndCode(), subregion, bootImage.heapOffset());
+        printHeapOrCodeData(out, "HEAP", heapRegion, bootImage.heapAndCode(), subregion, 0);
     }
 
     private void printCode(PrintStream out, Range subregion) {
-        printHeapOrCodeData(out, "CODE", codeRegion, bootImage.heapAndCode(), subregion, bootImage.codeOffset());
+        printHeapOrCodeData(out, "CODE", codeRegion, bootImage.heapAndCode(), subregion, bootImage.header.heapSize);
     }
 
     private void printStringInfo(PrintStream out) {
@@ -299,10 +299,19 @@ public class BootImagePrinter {
         return false;
     }
 
-    private void printHeapOrCodeData(PrintStream out, String name, Range region, ByteBuffer heapAndCode, Range subregion, int offsetInImage) {
+    /**
+     * @param offsetInHeapAndCode the offset of the section in the (uncompressed) heap and code data
+     */
+    private void printHeapOrCodeData(PrintStream out, String name, Range region, ByteBuffer heapAndCode, Range subregion, int offsetInHeapAndCode) {
         int startAddress = region.start;
         int size = region.size;
-        out.println(sectionHeader(name, size, startAddress, offsetInImage));
+        if (bootImage.header.isCompressed()) {
+            // The section has no offset of its own in the image file, only in the compressed chunks
+            out.println(sectionHeader(name, size, startAddress, "uncompressed-offset", offsetInHeapAndCode) +
+                String.format(" (compressed heap and code at image-offset=%d[0x%08x]) ---", bootImage.heapOffset(), bootImage.heapOffset()));
+        } else {
+            out.println(sectionHeader(name, size, startAddress, bootImage.heapOffset() + offsetInHeapAndCode));
+        }
 
         int end;
         int address;
@@ -335,10 +344,14 @@ public class BootImagePrinter {
     }
 
     private String sectionHeader(String name, int size, int startAddress, int offsetInImage) {
+        return sectionHeader(name, size, startAddress, "image-offset", offsetInImage) + " ---";
+    }
+
+    private String sectionHeader(String name, int size, int startAddress, String offsetLabel, int offset) {
         int end = startAddress + size;
         int wordSizeWidth = wordSize * 2;
         return String.format("--- %s: start=0x%0" + wordSizeWidth + "x, end=0x%0" + wordSizeWidth +
-            "x, size=%d[0x%08x], image-offset=%d[0x%08x] ---", name, startAddress, end, size, size, offsetInImage, offsetInImage);
+            "x, size=%d[0x%08x], %s=%d[0x%08x]", name, startAddress, end, size, size, offsetLabel, offset, offset);
     }
 
     private void printSection(PrintStream out, FieldSection section, String name) {
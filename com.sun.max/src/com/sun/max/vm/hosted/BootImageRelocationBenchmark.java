@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2011, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ */
+package com.sun.max.vm.hosted;
+
+import java.io.*;
+import java.nio.*;
+
+import com.sun.max.program.option.*;
+
+/**
+ * A utility for measuring the time taken by the native relocation loops (see relocation.c)
+ * to relocate the heap and code of a {@link BootImage}. The word-at-a-time loop used by the
+ * VM is compared against the original bit-at-a-time loop.
+ */
+public class BootImageRelocationBenchmark {
+
+    /**
+     * The relocation loops. The ordinals must match the RELOCATION_KERNEL_* constants in relocation.c.
+     */
+    enum Kernel {
+        BYTEWISE,
+        WORDWISE
+    }
+
+    private final OptionSet options = new OptionSet();
+
+    private final Option<Boolean> help = options.newBooleanOption("help", false,
+            "Show help message and exit.");
+
+    private final Option<Integer> iterationsOption = options.newIntegerOption("iterations", 20,
+            "The number of timed relocations performed with each relocation loop.");
+
+    private final Option<Integer> threadsOption = options.newIntegerOption("threads", 1,
+            "The maximum number of threads used for each relocation.");
+
+    public static void main(String[] args) throws IOException, BootImageException {
+        System.exit(new BootImageRelocationBenchmark().run(args));
+    }
+
+    private static native void nativeRelocate(long heap, long relocatedHeap, byte[] relocationDataPointer, int relocationDataSize, int isBigEndian, int wordSize, int kernel, int maxThreads);
+
+    public int run(String[] args) throws BootImageException, IOException {
+        options.parseArguments(args);
+
+        if (help.getValue()) {
+            options.printHelp(System.out, 80);
+            return 0;
+        }
+
+        String[] arguments = options.getArguments();
+        if (arguments.length != 1) {
+            System.out.println("Expected exactly 1 non-option command line argument, got " + arguments.length);
+            options.printHelp(System.out, 80);
+            return 1;
+        }
+
+        final BootImage bootImage = new BootImage(new File(arguments[0]));
+        final BootImage.Header header = bootImage.header;
+        final ByteBuffer heapAndCode = bootImage.heapAndCode();
+        final int size = heapAndCode.limit();
+        final long heap = WithoutAccessCheck.unsafe.allocateMemory(size);
+        for (int i = 0; i < size; i++) {
+            WithoutAccessCheck.unsafe.putByte(heap + i, heapAndCode.get(i));
+        }
+        Prototype.loadHostedLibrary();
+
+        final int iterations = iterationsOption.getValue();
+        final int maxThreads = threadsOption.getValue();
+        final long delta = 0x10000000L;
+        try {
+            System.out.println("heap and code: " + size + " bytes, relocation data: " + header.relocationDataSize + " bytes, threads: " + maxThreads);
+            for (Kernel kernel : Kernel.values()) {
+                long best = Long.MAX_VALUE;
+                long total = 0;
+                for (int i = 0; i < iterations; i++) {
+                    // Alternate the direction of relocation so that the pointers stay within range
+                    final long relocatedHeap = (i % 2) == 0 ? delta : -delta;
+                    final long start = System.nanoTime();
+                    nativeRelocate(heap, relocatedHeap, bootImage.relocationData, header.relocationDataSize, header.isBigEndian, header.wordSize, kernel.ordinal(), maxThreads);
+                    final long time = System.nanoTime() - start;
+                    best = Math.min(best, time);
+                    total += time;
+                }
+                System.out.printf("%-10s best: %8.3f ms, average: %8.3f ms%n", kernel.name().toLowerCase(),
+                                best / 1000000.0d, (total / (double) iterations) / 1000000.0d);
+            }
+        } finally {
+            WithoutAccessCheck.unsafe.freeMemory(heap);
+        }
+        return 0;
+    }
+}
@@ -793,7 +793,8 @@ public final class JDK_java_lang_System {
         properties.setProperty(JAVA_CLASS_PATH.property, javaClassPath);
         JAVA_CLASS_PATH.setValue(javaClassPath);
 
-
+        // the class path jars are indexed natively (see lookupCache.c), so URLClassPath can use the lookup cache by default
+        setIfAbsent(properties, "sun.cds.enableSharedLookupCache", "true");
 
         // 9. load the native code for zip and java libraries
         BootClassLoader.BOOT_CLASS_LOADER.loadJavaAndZipNativeLibraries(javaAndZipLibraryPaths[0], javaAndZipLibraryPaths[1]);
@@ -157,6 +157,15 @@ public final class JDK_java_lang_Thread {
         VmThread.yield();
     }
 
+    /**
+     * Indicates that the caller is busy-waiting.
+     * @see java.lang.Thread#onSpinWait()
+     */
+    @SUBSTITUTE(optional = true) // Not available in JDK 8
+    public static void onSpinWait() {
+        VmThread.onSpinWait();
+    }
+
     /**
      * Sleep for the specified amount of time.
      * @see java.lang.Thread#sleep(long)
@@ -167,6 +176,24 @@ public final class JDK_java_lang_Thread {
         VmThread.sleep(millis);
     }
 
+    /**
+     * Sleep for the specified amount of time, without rounding it to milliseconds.
+     * @see java.lang.Thread#sleep(long, int)
+     * @param millis the number of milliseconds to sleep
+     * @param nanos the additional number of nanoseconds to sleep
+     */
+    @SUBSTITUTE
+    public static void sleep(long millis, int nanos) throws InterruptedException {
+        if (millis < 0) {
+            throw new IllegalArgumentException("timeout value is negative");
+        }
+        if (nanos < 0 || nanos > 999999) {
+            throw new IllegalArgumentException("nanosecond timeout value out of range");
+        }
+        // saturate rather than overflow for very long sleeps
+        VmThread.sleepNanos(millis > (Long.MAX_VALUE - nanos) / 1000000L ? Long.MAX_VALUE : millis * 1000000L + nanos);
+    }
+
     /**
      * Starts the thread running.
      * @see java.lang.Thread#start()
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2007, 2012, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ */
+package com.sun.max.vm.jdk.unix;
+
+import java.net.*;
+
+/**
+ * Answers the host lookups of {@code java.net.Inet4AddressImpl} and {@code java.net.Inet6AddressImpl} from the
+ * VM's caching resolver (see Native/substrate/resolver.h) instead of the JDK's per-call getaddrinfo(3).
+ */
+final class HostResolver {
+
+    private HostResolver() {
+    }
+
+    /**
+     * Gets the addresses of a host.
+     *
+     * @param ipv6 specifies if IPv6 addresses are included, in which case they come before the IPv4 ones if the
+     *            {@code java.net.preferIPv6Addresses} property is true and after them otherwise (as in the JDK)
+     */
+    static InetAddress[] lookupAllHostAddr(String host, boolean ipv6) throws UnknownHostException {
+        final byte[][] addresses = nativeLookupName(host, ipv6);
+        if (addresses == null) {
+            throw new UnknownHostException(host);
+        }
+        final InetAddress[] result = new InetAddress[addresses.length];
+        int index = 0;
+        if (ipv6) {
+            final int firstLength = Boolean.getBoolean("java.net.preferIPv6Addresses") ? 16 : 4;
+            for (byte[] address : addresses) {
+                if (address.length == firstLength) {
+                    result[index++] = InetAddress.getByAddress(host, address);
+                }
+            }
+            for (byte[] address : addresses) {
+                if (address.length != firstLength) {
+                    result[index++] = InetAddress.getByAddress(host, address);
+                }
+            }
+        } else {
+            for (byte[] address : addresses) {
+                result[index++] = InetAddress.getByAddress(host, address);
+            }
+        }
+        return result;
+    }
+
+    /**
+     * Gets the name of the host with a given IPv4 or IPv6 address.
+     */
+    static String getHostByAddr(byte[] address) throws UnknownHostException {
+        final String name = nativeLookupAddress(address);
+        if (name == null) {
+            throw new UnknownHostException();
+        }
+        return name;
+    }
+
+    private static native byte[][] nativeLookupName(String host, boolean ipv6);
+
+    private static native String nativeLookupAddress(byte[] address);
+}
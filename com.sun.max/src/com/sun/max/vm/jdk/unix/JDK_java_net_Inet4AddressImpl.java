@@ -1,6 +1,5 @@
 /*
- * Copyright (c) 2017, APT Group, School of Computer Science,
- * The University of Manchester. All rights reserved.
+ * Copyright (c) 2007, 2012, Oracle and/or its affiliates. All rights reserved.
  * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
  *
  * This code is free software; you can redistribute it and/or modify it
@@ -16,25 +15,30 @@
  * You should have received a copy of the GNU General Public License version
  * 2 along with this work; if not, write to the Free Software Foundation,
  * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
  */
-package com.sun.max.vm.jdk;
-
-import static com.sun.max.vm.intrinsics.MaxineIntrinsicIDs.UNSAFE_CAST;
+package com.sun.max.vm.jdk.unix;
 
 import java.net.*;
 
 import com.sun.max.annotate.*;
 
-import sun.misc.*;
-
 /**
- * Method substitutions for {@link sun.misc.VM}.
+ * Substitutions for {@code java.net.Inet4AddressImpl} that use the VM's caching host resolver.
  */
-@METHOD_SUBSTITUTIONS(URLClassPath.class)
-final class JDK_sun_misc_URLClassPath {
+@METHOD_SUBSTITUTIONS(className = "java.net.Inet4AddressImpl")
+final class JDK_java_net_Inet4AddressImpl {
+
+    @SUBSTITUTE
+    public InetAddress[] lookupAllHostAddr(String hostname) throws UnknownHostException {
+        return HostResolver.lookupAllHostAddr(hostname, false);
+    }
 
-    @SUBSTITUTE(optional = true) // Not available in JDK 7
-    private static URL[] getLookupCacheURLs(ClassLoader loader) {
-        return null;
+    @SUBSTITUTE
+    public String getHostByAddr(byte[] address) throws UnknownHostException {
+        return HostResolver.getHostByAddr(address);
     }
 }
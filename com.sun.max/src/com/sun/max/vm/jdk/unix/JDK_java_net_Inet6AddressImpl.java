@@ -1,6 +1,5 @@
 /*
- * Copyright (c) 2014, Andrey Rodchenko. All rights reserved.
- * Copyright (c) 2014, Oracle and/or its affiliates. All rights reserved.
+ * Copyright (c) 2007, 2012, Oracle and/or its affiliates. All rights reserved.
  * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
  *
  * This code is free software; you can redistribute it and/or modify it
@@ -21,18 +20,25 @@
  * or visit www.oracle.com if you need additional information or have any
  * questions.
  */
-package com.sun.max.vm.jdk;
+package com.sun.max.vm.jdk.unix;
+
+import java.net.*;
 
 import com.sun.max.annotate.*;
 
 /**
- * Method substitutions for sun.management.ThreadImpl.
+ * Substitutions for {@code java.net.Inet6AddressImpl} that use the VM's caching host resolver.
  */
-@METHOD_SUBSTITUTIONS(className = "sun.management.ThreadImpl")
-final class JDK_sun_management_ThreadImpl {
+@METHOD_SUBSTITUTIONS(className = "java.net.Inet6AddressImpl")
+final class JDK_java_net_Inet6AddressImpl {
+
+    @SUBSTITUTE
+    public InetAddress[] lookupAllHostAddr(String hostname) throws UnknownHostException {
+        return HostResolver.lookupAllHostAddr(hostname, true);
+    }
 
     @SUBSTITUTE
-    public boolean isCurrentThreadCpuTimeSupported() {
-        return false; //TODO
+    public String getHostByAddr(byte[] address) throws UnknownHostException {
+        return HostResolver.getHostByAddr(address);
     }
 }
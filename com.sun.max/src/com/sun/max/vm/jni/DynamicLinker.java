@@ -255,6 +255,19 @@ public final class DynamicLinker {
      * @throws UnsatisfiedLinkError if the symbol cannot be found in any of the dynamic libraries bound to the VM
      */
     public static Word lookup(MethodActor classMethodActor, String symbol) throws UnsatisfiedLinkError {
+        Word symbolAddress = find(classMethodActor, symbol);
+        if (symbolAddress.isZero()) {
+            throw new UnsatisfiedLinkError(symbol);
+        }
+        return symbolAddress;
+    }
+
+    /**
+     * Looks up the symbol for a native method in the same libraries as {@link #lookup}.
+     *
+     * @return the address of {@code symbol} or zero if it is not found
+     */
+    public static Word find(MethodActor classMethodActor, String symbol) {
         Word symbolAddress = Word.zero();
         if (MaxineVM.isHosted()) {
             symbolAddress = MethodID.fromMethodActor(classMethodActor);
@@ -267,9 +280,6 @@ public final class DynamicLinker {
                 symbolAddress = Address.fromLong(findNative(null, symbol));
             }
         }
-        if (symbolAddress.isZero()) {
-            throw new UnsatisfiedLinkError(symbol);
-        }
         return symbolAddress;
     }
 
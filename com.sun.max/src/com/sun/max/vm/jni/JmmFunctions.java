@@ -292,7 +292,7 @@ public final class JmmFunctions {
         }
 
         try {
-            return JniHandle.zero();
+            return JniHandles.createLocalHandle(MemoryManagement.getPoolUsage((MemoryPoolMXBean) pool.unhand()));
         } catch (Throwable t) {
             VmThread.fromJniEnv(env).setJniException(t);
             return asJniHandle(0L);
@@ -314,7 +314,7 @@ public final class JmmFunctions {
         }
 
         try {
-            return JniHandle.zero();
+            return JniHandles.createLocalHandle(MemoryManagement.getPeakPoolUsage((MemoryPoolMXBean) pool.unhand()));
         } catch (Throwable t) {
             VmThread.fromJniEnv(env).setJniException(t);
             return asJniHandle(0L);
@@ -362,7 +362,14 @@ public final class JmmFunctions {
         }
 
         try {
-            return 0;
+            switch (att) {
+                case JMM_GC_EXT_ATTRIBUTE_INFO_SIZE:
+                    return GCStatistics.extAttributeCount();
+                case JMM_VM_THREAD_COUNT:
+                    return ThreadManagement.getInternalThreadCount();
+                default:
+                    return 0;
+            }
         } catch (Throwable t) {
             VmThread.fromJniEnv(env).setJniException(t);
             return JNI_ERR;
@@ -377,14 +384,19 @@ public final class JmmFunctions {
 
     @VM_ENTRY_POINT
     private static boolean GetBoolAttribute(Pointer env, int att) {
-        // Source: JmmFunctionsSource.java:120
+        // Source: JmmFunctionsSource.java:127
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.GetBoolAttribute.ordinal(), UPCALL_ENTRY, anchor, env, Address.fromInt(att));
         }
 
         try {
-            return false;
+            switch (att) {
+                case JMM_THREAD_CPU_TIME:
+                    return ThreadManagement.isThreadCpuTimeEnabled();
+                default:
+                    return false;
+            }
         } catch (Throwable t) {
             VmThread.fromJniEnv(env).setJniException(t);
             return false;
@@ -399,7 +411,7 @@ public final class JmmFunctions {
 
     @VM_ENTRY_POINT
     private static boolean SetBoolAttribute(Pointer env, int att, boolean flag) {
-        // Source: JmmFunctionsSource.java:125
+        // Source: JmmFunctionsSource.java:137
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.SetBoolAttribute.ordinal(), UPCALL_ENTRY, anchor, env, Address.fromInt(att), Address.fromInt(flag ? 1 : 0));
@@ -412,7 +424,7 @@ public final class JmmFunctions {
                 case JMM_VERBOSE_CLASS:
                     return ClassLoadingManagement.setVerboseClass(flag);
                 case JMM_THREAD_CONTENTION_MONITORING:
-                    return ThreadManagement.setThreadCpuTimeEnabled(flag);
+                    return ThreadManagement.setThreadContentionMonitoringEnabled(flag);
                 case JMM_THREAD_CPU_TIME:
                     return ThreadManagement.setThreadCpuTimeEnabled(flag);
                 default:
@@ -433,7 +445,7 @@ public final class JmmFunctions {
 
     @VM_ENTRY_POINT
     private static int GetLongAttributes(Pointer env, JniHandle obj, JniHandle atts, int count, JniHandle result) {
-        // Source: JmmFunctionsSource.java:142
+        // Source: JmmFunctionsSource.java:154
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.GetLongAttributes.ordinal(), UPCALL_ENTRY, anchor, env, obj, atts, Address.fromInt(count), result);
@@ -455,7 +467,7 @@ public final class JmmFunctions {
 
     @VM_ENTRY_POINT
     private static JniHandle FindCircularBlockedThreads(Pointer env) {
-        // Source: JmmFunctionsSource.java:147
+        // Source: JmmFunctionsSource.java:159
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.FindCircularBlockedThreads.ordinal(), UPCALL_ENTRY, anchor, env);
@@ -477,14 +489,14 @@ public final class JmmFunctions {
 
     @VM_ENTRY_POINT
     private static long GetThreadCpuTime(Pointer env, long thread_id) {
-        // Source: JmmFunctionsSource.java:152
+        // Source: JmmFunctionsSource.java:164
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.GetThreadCpuTime.ordinal(), UPCALL_ENTRY, anchor, env, Address.fromLong(thread_id));
         }
 
         try {
-            return 0;
+            return ThreadManagement.getThreadCpuTime(thread_id, true);
         } catch (Throwable t) {
             VmThread.fromJniEnv(env).setJniException(t);
             return JNI_ERR;
@@ -499,7 +511,7 @@ public final class JmmFunctions {
 
     @VM_ENTRY_POINT
     private static JniHandle GetVMGlobalNames(Pointer env) {
-        // Source: JmmFunctionsSource.java:157
+        // Source: JmmFunctionsSource.java:169
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.GetVMGlobalNames.ordinal(), UPCALL_ENTRY, anchor, env);
@@ -521,7 +533,7 @@ public final class JmmFunctions {
 
     @VM_ENTRY_POINT
     private static int GetVMGlobals(Pointer env, JniHandle names, Pointer globals, int count) {
-        // Source: JmmFunctionsSource.java:162
+        // Source: JmmFunctionsSource.java:174
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.GetVMGlobals.ordinal(), UPCALL_ENTRY, anchor, env, names, globals, Address.fromInt(count));
@@ -543,14 +555,14 @@ public final class JmmFunctions {
 
     @VM_ENTRY_POINT
     private static int GetInternalThreadTimes(Pointer env, JniHandle names, JniHandle times) {
-        // Source: JmmFunctionsSource.java:167
+        // Source: JmmFunctionsSource.java:179
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.GetInternalThreadTimes.ordinal(), UPCALL_ENTRY, anchor, env, names, times);
         }
 
         try {
-            return 0;
+            return ThreadManagement.getInternalThreadTimes((String[]) names.unhand(), (long[]) times.unhand());
         } catch (Throwable t) {
             VmThread.fromJniEnv(env).setJniException(t);
             return JNI_ERR;
@@ -565,7 +577,7 @@ public final class JmmFunctions {
 
     @VM_ENTRY_POINT
     private static boolean ResetStatistic(Pointer env, Word obj, int type) {
-        // Source: JmmFunctionsSource.java:172
+        // Source: JmmFunctionsSource.java:184
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.ResetStatistic.ordinal(), UPCALL_ENTRY, anchor, env, obj, Address.fromInt(type));
@@ -587,7 +599,7 @@ public final class JmmFunctions {
 
     @VM_ENTRY_POINT
     private static void SetPoolSensor(Pointer env, JniHandle pool, int type, JniHandle sensor) {
-        // Source: JmmFunctionsSource.java:177
+        // Source: JmmFunctionsSource.java:189
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.SetPoolSensor.ordinal(), UPCALL_ENTRY, anchor, env, pool, Address.fromInt(type), sensor);
@@ -607,7 +619,7 @@ public final class JmmFunctions {
 
     @VM_ENTRY_POINT
     private static long SetPoolThreshold(Pointer env, JniHandle pool, int type, long threshold) {
-        // Source: JmmFunctionsSource.java:181
+        // Source: JmmFunctionsSource.java:193
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.SetPoolThreshold.ordinal(), UPCALL_ENTRY, anchor, env, pool, Address.fromInt(type), Address.fromLong(threshold));
@@ -629,14 +641,14 @@ public final class JmmFunctions {
 
     @VM_ENTRY_POINT
     private static JniHandle GetPoolCollectionUsage(Pointer env, JniHandle pool) {
-        // Source: JmmFunctionsSource.java:186
+        // Source: JmmFunctionsSource.java:198
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.GetPoolCollectionUsage.ordinal(), UPCALL_ENTRY, anchor, env, pool);
         }
 
         try {
-            return JniHandle.zero();
+            return JniHandles.createLocalHandle(MemoryManagement.getPoolCollectionUsage((MemoryPoolMXBean) pool.unhand()));
         } catch (Throwable t) {
             VmThread.fromJniEnv(env).setJniException(t);
             return asJniHandle(0L);
@@ -651,14 +663,14 @@ public final class JmmFunctions {
 
     @VM_ENTRY_POINT
     private static int GetGCExtAttributeInfo(Pointer env, JniHandle mgr, Pointer ext_info, int count) {
-        // Source: JmmFunctionsSource.java:191
+        // Source: JmmFunctionsSource.java:203
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.GetGCExtAttributeInfo.ordinal(), UPCALL_ENTRY, anchor, env, mgr, ext_info, Address.fromInt(count));
         }
 
         try {
-            return 0;
+            return GCStatistics.getExtAttributeInfo(ext_info, count);
         } catch (Throwable t) {
             VmThread.fromJniEnv(env).setJniException(t);
             return JNI_ERR;
@@ -673,13 +685,14 @@ public final class JmmFunctions {
 
     @VM_ENTRY_POINT
     private static void GetLastGCStat(Pointer env, JniHandle mgr, Pointer gc_stat) {
-        // Source: JmmFunctionsSource.java:196
+        // Source: JmmFunctionsSource.java:208
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.GetLastGCStat.ordinal(), UPCALL_ENTRY, anchor, env, mgr, gc_stat);
         }
 
         try {
+            GCStatistics.getLastGCStat(gc_stat, MemoryManagement.getAllPools());
         } catch (Throwable t) {
             VmThread.fromJniEnv(env).setJniException(t);
         } finally {
@@ -693,14 +706,14 @@ public final class JmmFunctions {
 
     @VM_ENTRY_POINT
     private static long GetThreadCpuTimeWithKind(Pointer env, long thread_id, boolean user_sys_cpu_time) {
-        // Source: JmmFunctionsSource.java:200
+        // Source: JmmFunctionsSource.java:213
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.GetThreadCpuTimeWithKind.ordinal(), UPCALL_ENTRY, anchor, env, Address.fromLong(thread_id), Address.fromInt(user_sys_cpu_time ? 1 : 0));
         }
 
         try {
-            return 0;
+            return ThreadManagement.getThreadCpuTime(thread_id, user_sys_cpu_time);
         } catch (Throwable t) {
             VmThread.fromJniEnv(env).setJniException(t);
             return JNI_ERR;
@@ -715,18 +728,18 @@ public final class JmmFunctions {
 
     @VM_ENTRY_POINT
     private static native Pointer reserved5();
-        // Source: JmmFunctionsSource.java:205
+        // Source: JmmFunctionsSource.java:218
 
     @VM_ENTRY_POINT
     private static int DumpHeap0(Pointer env, JniHandle outputfile, boolean live) {
-        // Source: JmmFunctionsSource.java:208
+        // Source: JmmFunctionsSource.java:221
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.DumpHeap0.ordinal(), UPCALL_ENTRY, anchor, env, outputfile, Address.fromInt(live ? 1 : 0));
         }
 
         try {
-            return 0;
+            return MemoryManagement.dumpHeap((String) outputfile.unhand(), live);
         } catch (Throwable t) {
             VmThread.fromJniEnv(env).setJniException(t);
             return JNI_ERR;
@@ -741,7 +754,7 @@ public final class JmmFunctions {
 
     @VM_ENTRY_POINT
     private static JniHandle FindDeadlocks(Pointer env, boolean object_monitors_only) {
-        // Source: JmmFunctionsSource.java:213
+        // Source: JmmFunctionsSource.java:226
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.FindDeadlocks.ordinal(), UPCALL_ENTRY, anchor, env, Address.fromInt(object_monitors_only ? 1 : 0));
@@ -763,7 +776,7 @@ public final class JmmFunctions {
 
     @VM_ENTRY_POINT
     private static void SetVMGlobal(Pointer env, JniHandle flag_name, Word new_value) {
-        // Source: JmmFunctionsSource.java:218
+        // Source: JmmFunctionsSource.java:231
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.SetVMGlobal.ordinal(), UPCALL_ENTRY, anchor, env, flag_name, new_value);
@@ -783,11 +796,11 @@ public final class JmmFunctions {
 
     @VM_ENTRY_POINT
     private static native Word reserved6();
-        // Source: JmmFunctionsSource.java:222
+        // Source: JmmFunctionsSource.java:235
 
     @VM_ENTRY_POINT
     private static JniHandle DumpThreads(Pointer env, JniHandle ids, boolean lockedMonitors, boolean lockedSynchronizers) {
-        // Source: JmmFunctionsSource.java:225
+        // Source: JmmFunctionsSource.java:238
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.DumpThreads.ordinal(), UPCALL_ENTRY, anchor, env, ids, Address.fromInt(lockedMonitors ? 1 : 0), Address.fromInt(lockedSynchronizers ? 1 : 0));
@@ -95,12 +95,12 @@ public final class JmmFunctionsSource {
 
     @VM_ENTRY_POINT
     private static JniHandle GetMemoryPoolUsage(Pointer env, JniHandle pool) {
-        return JniHandle.zero();
+        return JniHandles.createLocalHandle(MemoryManagement.getPoolUsage((MemoryPoolMXBean) pool.unhand()));
     }
 
     @VM_ENTRY_POINT
     private static JniHandle GetPeakMemoryPoolUsage(Pointer env, JniHandle pool) {
-        return JniHandle.zero();
+        return JniHandles.createLocalHandle(MemoryManagement.getPeakPoolUsage((MemoryPoolMXBean) pool.unhand()));
     }
 
     @VM_ENTRY_POINT
@@ -113,12 +113,24 @@ public final class JmmFunctionsSource {
 
     @VM_ENTRY_POINT
     private static long GetLongAttribute(Pointer env, JniHandle obj, int att) {
-        return 0;
+        switch (att) {
+            case JMM_GC_EXT_ATTRIBUTE_INFO_SIZE:
+                return GCStatistics.extAttributeCount();
+            case JMM_VM_THREAD_COUNT:
+                return ThreadManagement.getInternalThreadCount();
+            default:
+                return 0;
+        }
     }
 
     @VM_ENTRY_POINT
     private static boolean GetBoolAttribute(Pointer env, int att) {
-        return false;
+        switch (att) {
+            case JMM_THREAD_CPU_TIME:
+                return ThreadManagement.isThreadCpuTimeEnabled();
+            default:
+                return false;
+        }
     }
 
     @VM_ENTRY_POINT
@@ -129,7 +141,7 @@ public final class JmmFunctionsSource {
             case JMM_VERBOSE_CLASS:
                 return ClassLoadingManagement.setVerboseClass(flag);
             case JMM_THREAD_CONTENTION_MONITORING:
-                return ThreadManagement.setThreadCpuTimeEnabled(flag);
+                return ThreadManagement.setThreadContentionMonitoringEnabled(flag);
             case JMM_THREAD_CPU_TIME:
                 return ThreadManagement.setThreadCpuTimeEnabled(flag);
             default:
@@ -150,7 +162,7 @@ public final class JmmFunctionsSource {
 
     @VM_ENTRY_POINT
     private static long GetThreadCpuTime(Pointer env, long thread_id) {
-        return 0;
+        return ThreadManagement.getThreadCpuTime(thread_id, true);
     }
 
     @VM_ENTRY_POINT
@@ -165,7 +177,7 @@ public final class JmmFunctionsSource {
 
     @VM_ENTRY_POINT
     private static int GetInternalThreadTimes(Pointer env, JniHandle names, JniHandle times) {
-        return 0;
+        return ThreadManagement.getInternalThreadTimes((String[]) names.unhand(), (long[]) times.unhand());
     }
 
     @VM_ENTRY_POINT
@@ -184,21 +196,22 @@ public final class JmmFunctionsSource {
 
     @VM_ENTRY_POINT
     private static JniHandle GetPoolCollectionUsage(Pointer env, JniHandle pool) {
-        return JniHandle.zero();
+        return JniHandles.createLocalHandle(MemoryManagement.getPoolCollectionUsage((MemoryPoolMXBean) pool.unhand()));
     }
 
     @VM_ENTRY_POINT
     private static int GetGCExtAttributeInfo(Pointer env, JniHandle mgr, Pointer ext_info, int count) {
-        return 0;
+        return GCStatistics.getExtAttributeInfo(ext_info, count);
     }
 
     @VM_ENTRY_POINT
     private static void GetLastGCStat(Pointer env, JniHandle mgr, Pointer gc_stat) {
+        GCStatistics.getLastGCStat(gc_stat, MemoryManagement.getAllPools());
     }
 
     @VM_ENTRY_POINT
     private static long GetThreadCpuTimeWithKind(Pointer env, long thread_id, boolean user_sys_cpu_time) {
-        return 0;
+        return ThreadManagement.getThreadCpuTime(thread_id, user_sys_cpu_time);
     }
 
     @VM_ENTRY_POINT
@@ -206,7 +219,7 @@ public final class JmmFunctionsSource {
 
     @VM_ENTRY_POINT
     private static int DumpHeap0(Pointer env, JniHandle outputfile, boolean live) {
-        return 0;
+        return MemoryManagement.dumpHeap((String) outputfile.unhand(), live);
     }
 
     @VM_ENTRY_POINT
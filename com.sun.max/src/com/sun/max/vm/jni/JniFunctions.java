@@ -21,6 +21,7 @@
 package com.sun.max.vm.jni;
 
 import com.sun.max.Utils;
+import com.sun.max.annotate.ALIAS;
 import com.sun.max.annotate.INLINE;
 import com.sun.max.annotate.INTRINSIC;
 import com.sun.max.annotate.VM_ENTRY_POINT;
@@ -115,6 +116,31 @@ public final class JniFunctions {
     @INTRINSIC(UNSAFE_CAST) static native FieldID   asFieldID(long value);
     @INTRINSIC(UNSAFE_CAST) static native Pointer   asPointer(long value);
 
+    /**
+     * Access to the character array of a string, used by {@code GetStringCritical} to avoid copying the characters.
+     */
+    static class StringAlias {
+        @ALIAS(declaringClass = String.class)
+        char[] value;
+        @ALIAS(declaringClass = String.class, optional = true)
+        int offset;
+    }
+
+    @INTRINSIC(UNSAFE_CAST) static native StringAlias asStringAlias(String s);
+
+    /**
+     * Gets the character array of a string if the array holds exactly the characters of the string.
+     *
+     * @return the character array or {@code null} if the string shares a larger array
+     */
+    static char[] directStringChars(String string) {
+        final StringAlias s = asStringAlias(string);
+        if (s.offset != 0 || s.value.length != string.length()) {
+            return null;
+        }
+        return s.value;
+    }
+
     /**
      * This method implements part of the prologue for entering a JNI upcall from native code.
      *
@@ -4640,9 +4666,14 @@ public final class JniFunctions {
         }
 
         try {
-            // TODO(cwi): Implement optimized version for OptimizeJNICritical if a benchmark uses it frequently
+            final String s = (String) string.unhand();
+            final char[] chars = directStringChars(s);
+            if (chars != null && Heap.useDirectPointer(chars)) {
+                setCopyPointer(isCopy, false);
+                return Reference.fromJava(chars).toOrigin().plus(Layout.charArrayLayout().getElementOffsetFromOrigin(0));
+            }
             setCopyPointer(isCopy, true);
-            return copyString((String) string.unhand());
+            return copyString(s);
         } catch (Throwable t) {
             VmThread.fromJniEnv(env).setJniException(t);
             return asPointer(0L);
@@ -4665,13 +4696,18 @@ public final class JniFunctions {
 
     @VM_ENTRY_POINT
     private static void ReleaseStringCritical(Pointer env, JniHandle string, Pointer chars) {
-        // Source: JniFunctionsSource.java:1727
+        // Source: JniFunctionsSource.java:1732
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.ReleaseStringCritical.ordinal(), UPCALL_ENTRY, anchor, env, string, chars);
         }
 
         try {
+            final char[] value = directStringChars((String) string.unhand());
+            if (value != null && chars.equals(Reference.fromJava(value).toOrigin().plus(Layout.charArrayLayout().getElementOffsetFromOrigin(0)))) {
+                Heap.releasedDirectPointer(value);
+                return;
+            }
             Memory.deallocate(chars);
         } catch (Throwable t) {
             VmThread.fromJniEnv(env).setJniException(t);
@@ -4686,7 +4722,7 @@ public final class JniFunctions {
 
     @VM_ENTRY_POINT
     private static JniHandle NewWeakGlobalRef(Pointer env, JniHandle handle) {
-        // Source: JniFunctionsSource.java:1732
+        // Source: JniFunctionsSource.java:1742
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.NewWeakGlobalRef.ordinal(), UPCALL_ENTRY, anchor, env, handle);
@@ -4708,7 +4744,7 @@ public final class JniFunctions {
 
     @VM_ENTRY_POINT
     private static void DeleteWeakGlobalRef(Pointer env, JniHandle handle) {
-        // Source: JniFunctionsSource.java:1737
+        // Source: JniFunctionsSource.java:1747
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.DeleteWeakGlobalRef.ordinal(), UPCALL_ENTRY, anchor, env, handle);
@@ -4729,7 +4765,7 @@ public final class JniFunctions {
 
     @VM_ENTRY_POINT
     private static boolean ExceptionCheck(Pointer env) {
-        // Source: JniFunctionsSource.java:1742
+        // Source: JniFunctionsSource.java:1752
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.ExceptionCheck.ordinal(), UPCALL_ENTRY, anchor, env);
@@ -4754,7 +4790,7 @@ public final class JniFunctions {
 
     @VM_ENTRY_POINT
     private static JniHandle NewDirectByteBuffer(Pointer env, Pointer address, long capacity) throws Exception {
-        // Source: JniFunctionsSource.java:1750
+        // Source: JniFunctionsSource.java:1760
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.NewDirectByteBuffer.ordinal(), UPCALL_ENTRY, anchor, env, address, Address.fromLong(capacity));
@@ -4777,7 +4813,7 @@ public final class JniFunctions {
 
     @VM_ENTRY_POINT
     private static Pointer GetDirectBufferAddress(Pointer env, JniHandle buffer) throws Exception {
-        // Source: JniFunctionsSource.java:1756
+        // Source: JniFunctionsSource.java:1766
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.GetDirectBufferAddress.ordinal(), UPCALL_ENTRY, anchor, env, buffer);
@@ -4804,7 +4840,7 @@ public final class JniFunctions {
 
     @VM_ENTRY_POINT
     private static long GetDirectBufferCapacity(Pointer env, JniHandle buffer) {
-        // Source: JniFunctionsSource.java:1766
+        // Source: JniFunctionsSource.java:1776
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.GetDirectBufferCapacity.ordinal(), UPCALL_ENTRY, anchor, env, buffer);
@@ -4830,7 +4866,7 @@ public final class JniFunctions {
 
     @VM_ENTRY_POINT
     private static int GetObjectRefType(Pointer env, JniHandle obj) {
-        // Source: JniFunctionsSource.java:1775
+        // Source: JniFunctionsSource.java:1785
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.GetObjectRefType.ordinal(), UPCALL_ENTRY, anchor, env, obj);
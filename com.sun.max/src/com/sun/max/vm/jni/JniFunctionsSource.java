@@ -1710,9 +1710,14 @@ public final class JniFunctionsSource {
 
     @VM_ENTRY_POINT
     private static Pointer GetStringCritical(Pointer env, JniHandle string, Pointer isCopy) {
-        // TODO(cwi): Implement optimized version for OptimizeJNICritical if a benchmark uses it frequently
+        final String s = (String) string.unhand();
+        final char[] chars = directStringChars(s);
+        if (chars != null && Heap.useDirectPointer(chars)) {
+            setCopyPointer(isCopy, false);
+            return Reference.fromJava(chars).toOrigin().plus(Layout.charArrayLayout().getElementOffsetFromOrigin(0));
+        }
         setCopyPointer(isCopy, true);
-        return copyString((String) string.unhand());
+        return copyString(s);
     }
 
     private static Pointer copyString(String string) {
@@ -1725,6 +1730,11 @@ public final class JniFunctionsSource {
 
     @VM_ENTRY_POINT
     private static void ReleaseStringCritical(Pointer env, JniHandle string, Pointer chars) {
+        final char[] value = directStringChars((String) string.unhand());
+        if (value != null && chars.equals(Reference.fromJava(value).toOrigin().plus(Layout.charArrayLayout().getElementOffsetFromOrigin(0)))) {
+            Heap.releasedDirectPointer(value);
+            return;
+        }
         Memory.deallocate(chars);
     }
 
@@ -22,12 +22,16 @@
  */
 package com.sun.max.vm.jni;
 
+import static com.sun.max.vm.thread.VmThreadLocal.*;
+
 import java.lang.ref.*;
 
 import com.sun.cri.ci.*;
 import com.sun.max.annotate.*;
 import com.sun.max.unsafe.*;
 import com.sun.max.vm.*;
+import com.sun.max.vm.heap.*;
+import com.sun.max.vm.reference.*;
 import com.sun.max.vm.runtime.*;
 import com.sun.max.vm.thread.*;
 import com.sun.max.vm.type.*;
@@ -76,6 +80,14 @@ import com.sun.max.vm.type.*;
  *
  * Given the above trade offs between 1 and 2 (and the current non-existence of 3!), we
  * have decided to go with choice 2 until it proves too complex and/or inefficient.
+ *
+ * The exception are local references, which are mostly created in large numbers and discarded
+ * together when a native method returns or a local frame is popped. These are first allocated
+ * from an arena in the native thread locals of the thread (choice 1), where creating a reference
+ * is a store and an increment and popping a frame restores the saved top of the arena. Such a
+ * handle is the address of its slot in the arena and so has the {@link Tag#STACK} format. The
+ * pool of the thread is used once the arena is full, so a handle in the pool is always younger
+ * than any handle in the arena and the tops of both can be saved and restored as a single index.
  */
 public final class JniHandles {
 
@@ -100,6 +112,26 @@ public final class JniHandles {
 
     public static final int INITIAL_NUMBER_OF_HANDLES = 32;
 
+    /**
+     * The offset of the {@code jniLocalHandles} field in a NativeThreadLocalsStruct (see Native/share/threadLocals.h),
+     * which is followed by the {@code jniLocalHandlesTop} and {@code jniLocalHandlesEnd} fields. It is preceded by
+     * 11 word-sized fields and the {@code trapCounts} array, as also mirrored in the Inspector's {@code NativeThreadLocal}.
+     */
+    @FOLD
+    private static int arenaStartOffset() {
+        return (11 + Trap.Count.VALUES.size()) * Word.size();
+    }
+
+    @FOLD
+    private static int arenaTopOffset() {
+        return arenaStartOffset() + Word.size();
+    }
+
+    @FOLD
+    private static int arenaEndOffset() {
+        return arenaStartOffset() + 2 * Word.size();
+    }
+
     private static final JniHandles globalHandles = new JniHandles();
     private static final JniHandles weakGlobalHandles = new JniHandles();
 
@@ -251,21 +283,96 @@ public final class JniHandles {
         return jniHandle.asOffset().toInt() & Tag.MASK;
     }
 
-    private void pushFrame(int capacity) {
-        ensureCapacity(capacity);
-        frames = new Frame(top, frames);
+    /**
+     * Allocates a local handle from the arena of a thread.
+     *
+     * @param tla the thread locals of the current thread
+     * @return zero if the arena is full
+     */
+    @INLINE
+    public static JniHandle allocateArenaHandle(Pointer tla, Object object) {
+        final Pointer ntl = NATIVE_THREAD_LOCALS.load(tla);
+        final Pointer top = ntl.readWord(arenaTopOffset()).asPointer();
+        if (top.lessThan(ntl.readWord(arenaEndOffset()).asAddress())) {
+            top.writeReference(0, Reference.fromJava(object));
+            ntl.writeWord(arenaTopOffset(), top.plus(Word.size()));
+            return top.asJniHandle();
+        }
+        return JniHandle.zero();
     }
 
-    private JniHandle popFrame(JniHandle result) {
-        final Object object = get(result);
+    /**
+     * Maps the arena of a thread if it has none yet.
+     *
+     * @param tla the thread locals of the current thread
+     * @return {@code false} if the thread had an arena already, if it could not be mapped or if the pool of the
+     *         thread holds handles (which must be younger than all the handles in the arena)
+     */
+    public static boolean allocateArena(Pointer tla) {
+        final Pointer ntl = NATIVE_THREAD_LOCALS.load(tla);
+        if (!ntl.readWord(arenaStartOffset()).isZero()) {
+            return false;
+        }
+        final JniHandles pool = VmThread.fromTLA(tla).jniHandles();
+        if (pool != null && pool.top() != 0) {
+            return false;
+        }
+        return nativeAllocateArena(ntl);
+    }
 
-        // This test means PopLocalFrame will work even if there was
-        // not a corresponding call to PushLocalFrame
-        if (frames != null) {
-            resetTop(frames.start);
-            frames = frames.previous;
+    @C_FUNCTION
+    private static native boolean nativeAllocateArena(Pointer ntl);
+
+    /**
+     * Gets the number of handles allocated from the arena of a thread.
+     */
+    @INLINE
+    public static int arenaTop(Pointer tla) {
+        final Pointer ntl = NATIVE_THREAD_LOCALS.load(tla);
+        return ntl.readWord(arenaTopOffset()).asAddress().minus(ntl.readWord(arenaStartOffset()).asAddress()).dividedBy(Word.size()).toInt();
+    }
+
+    /**
+     * Frees the handles allocated from the arena of a thread after a given number of handles.
+     */
+    @INLINE
+    public static void resetArenaTop(Pointer tla, int newTop) {
+        final Pointer ntl = NATIVE_THREAD_LOCALS.load(tla);
+        ntl.writeWord(arenaTopOffset(), ntl.readWord(arenaStartOffset()).asPointer().plus(newTop * Word.size()));
+    }
+
+    /**
+     * Gets the number of handles that can still be allocated from the arena of a thread.
+     */
+    private static int arenaAvailable(Pointer tla) {
+        final Pointer ntl = NATIVE_THREAD_LOCALS.load(tla);
+        return ntl.readWord(arenaEndOffset()).asAddress().minus(ntl.readWord(arenaTopOffset()).asAddress()).dividedBy(Word.size()).toInt();
+    }
+
+    private static boolean isArenaHandle(Pointer tla, JniHandle jniHandle) {
+        final Pointer ntl = NATIVE_THREAD_LOCALS.load(tla);
+        final Address address = jniHandle.asAddress();
+        return address.greaterEqual(ntl.readWord(arenaStartOffset()).asAddress()) && address.lessThan(ntl.readWord(arenaTopOffset()).asAddress());
+    }
+
+    /**
+     * Scans the references in the local handle arena of a thread.
+     *
+     * @param tla the thread locals of the thread being scanned
+     */
+    public static void scanArena(Pointer tla, PointerIndexVisitor visitor) {
+        final Pointer ntl = NATIVE_THREAD_LOCALS.load(tla);
+        if (ntl.isZero()) {
+            return;
+        }
+        final Pointer start = ntl.readWord(arenaStartOffset()).asPointer();
+        final int top = arenaTop(tla);
+        for (int i = 0; i < top; i++) {
+            // Deleted local references are cleared
+            if (!start.getReference(i).isZero()) {
+                visitor.visit(start, i);
+            }
         }
-        return (object != null) ? allocateHandle(object, Tag.LOCAL) : result;
     }
 
     /**
@@ -346,6 +453,28 @@ public final class JniHandles {
         }
     }
 
+    /**
+     * A visitor for the objects referenced by the {@linkplain #visitGlobalHandles global handles}.
+     */
+    public interface GlobalHandleVisitor {
+        void visit(JniHandle handle, Object object);
+    }
+
+    /**
+     * Visits the live global handles. The global handles are not locked, so this must only be called at a
+     * safepoint, when no thread can be creating or destroying them.
+     */
+    public static void visitGlobalHandles(GlobalHandleVisitor visitor) {
+        final Object[] handles = globalHandles.handles;
+        final int top = globalHandles.top;
+        for (int index = 0; index != top; ++index) {
+            final Object object = handles[index];
+            if (object != null) {
+                visitor.visit(indexToJniHandle(index, Tag.GLOBAL), object);
+            }
+        }
+    }
+
     public static JniHandle createWeakGlobalHandle(Object object) {
         if (object == null) {
             return JniHandle.zero();
@@ -365,6 +494,9 @@ public final class JniHandles {
                     throw new IllegalArgumentException("invalid JNI handle: " + jniHandle.to0xHexString());
                 }
                 jniHandles.freeHandle(jniHandleToIndex(jniHandle));
+            } else if (isArenaHandle(VmThread.currentTLA(), jniHandle)) {
+                // The slot is reclaimed when the arena is reset but the object need not be kept alive until then
+                jniHandle.asPointer().writeReference(0, Reference.zero());
             } else {
                 // Handles to references on a thread's stack are automatically freed
                 // as these handles are also on the stack
@@ -391,22 +523,34 @@ public final class JniHandles {
     }
 
     public static void ensureLocalHandleCapacity(int capacity) {
-        VmThread.current().makeJniHandles().ensureCapacity(capacity);
+        final VmThread thread = VmThread.current();
+        allocateArena(thread.tla());
+        final int available = arenaAvailable(thread.tla());
+        if (capacity > available) {
+            thread.makeJniHandles().ensureCapacity(capacity - available);
+        }
     }
 
     public static void pushLocalFrame(int capacity) {
-        VmThread.current().makeJniHandles().pushFrame(capacity);
+        ensureLocalHandleCapacity(capacity);
+        final VmThread thread = VmThread.current();
+        final JniHandles jniHandles = thread.makeJniHandles();
+        jniHandles.frames = new Frame(thread.jniHandlesTop(), jniHandles.frames);
     }
 
     public static JniHandle popLocalFrame(JniHandle result) {
-        JniHandles jniHandles = VmThread.current().jniHandles();
-        if (jniHandles == null) {
-            if (!result.isZero()) {
-                throw new IllegalArgumentException("invalid JNI handle: " + result.to0xHexString());
-            }
-            return JniHandle.zero();
+        final VmThread thread = VmThread.current();
+        final JniHandles jniHandles = thread.jniHandles();
+
+        // This test means PopLocalFrame will work even if there was
+        // not a corresponding call to PushLocalFrame
+        if (jniHandles == null || jniHandles.frames == null) {
+            return result;
         }
-        return jniHandles.popFrame(result);
+        final Object object = get(result);
+        thread.resetJniHandlesTop(jniHandles.frames.start);
+        jniHandles.frames = jniHandles.frames.previous;
+        return (object != null) ? thread.createLocalHandle(object) : result;
     }
 
 
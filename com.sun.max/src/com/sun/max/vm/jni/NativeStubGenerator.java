@@ -45,7 +45,7 @@ import com.sun.max.vm.type.*;
  * The steps performed by a generated stub are:
  * <p>
  * <ol>
- *   <li>Record the {@linkplain JniHandles#top() top} of {@linkplain VmThread#jniHandles() the current thread's JNI handle stack}.</li>
+ *   <li>Record the {@linkplain VmThread#jniHandlesTop() top} of the current thread's JNI handle stack.</li>
  *   <li>Push the pointer to the {@linkplain VmThread#jniEnv() current thread's native JNI environment data structure}.</li>
  *   <li>If the native method is static, handlize and push the class reference
  *       otherwise handlize and push the receiver reference.</li>
@@ -61,6 +61,9 @@ import com.sun.max.vm.type.*;
  *   <li>Return the result to the caller.</li>
  * </ol>
  * <p>
+ * A native method {@linkplain NativeFunction#linkCritical() linked to a critical entry point} is called like a
+ * {@code C_FUNCTION}: without JNI handles, environment or class argument and without a transition to native code.
+ * Each primitive array argument is passed as its length and the address of its elements.
  */
 public final class NativeStubGenerator extends BytecodeAssembler {
 
@@ -68,7 +71,8 @@ public final class NativeStubGenerator extends BytecodeAssembler {
         super(constantPoolEditor);
         this.classMethodActor = classMethodActor;
         allocateParameters(classMethodActor.isStatic(), classMethodActor.descriptor());
-        generateCode(classMethodActor.isCFunction(), classMethodActor.isStatic(), classMethodActor.holder(), classMethodActor.descriptor());
+        final boolean isCritical = !classMethodActor.isCFunction() && classMethodActor.nativeFunction.linkCritical();
+        generateCode(classMethodActor.isCFunction(), isCritical, classMethodActor.isStatic(), classMethodActor.holder(), classMethodActor.descriptor());
     }
 
     private final SeekableByteArrayOutputStream codeStream = new SeekableByteArrayOutputStream();
@@ -125,6 +129,9 @@ public final class NativeStubGenerator extends BytecodeAssembler {
     private static final ClassMethodRefConstant nativeCallEpilogue = createClassMethodConstant(Snippets.class, makeSymbol("nativeCallEpilogue"));
     private static final ClassMethodRefConstant nativeCallEpilogueForC = createClassMethodConstant(Snippets.class, makeSymbol("nativeCallEpilogueForC"));
 
+    private static final ClassMethodRefConstant criticalArrayLength = createClassMethodConstant(NativeFunction.class, makeSymbol("criticalArrayLength"), Object.class);
+    private static final ClassMethodRefConstant criticalArrayElements = createClassMethodConstant(NativeFunction.class, makeSymbol("criticalArrayElements"), Object.class);
+
     private static final ClassMethodRefConstant writeObject = createClassMethodConstant(Pointer.class, makeSymbol("writeObject"), int.class, Object.class);
 
     private int methodIDAsInt;
@@ -183,7 +190,7 @@ public final class NativeStubGenerator extends BytecodeAssembler {
     }
 
 
-    private void generateCode(boolean isCFunction, boolean isStatic, ClassActor holder, SignatureDescriptor sig) {
+    private void generateCode(boolean isCFunction, boolean isCritical, boolean isStatic, ClassActor holder, SignatureDescriptor sig) {
         final TypeDescriptor resultDescriptor = sig.resultDescriptor();
         final Kind resultKind = resultDescriptor.toKind();
         final StringBuilder nativeFunctionDescriptor = new StringBuilder("(");
@@ -197,7 +204,7 @@ public final class NativeStubGenerator extends BytecodeAssembler {
         int handles = -1;
         int handleOffset = 0;
 
-        if (!isCFunction) {
+        if (!isCFunction && !isCritical) {
             handles = initializeHandles(sig, isStatic);
 
             // Cache current thread in a local variable
@@ -268,6 +275,19 @@ public final class NativeStubGenerator extends BytecodeAssembler {
                 case REFERENCE: {
                     assert !isCFunction;
 
+                    if (isCritical) {
+                        // A primitive array is passed as its length and the address of its elements
+                        aload(parameterLocalIndex);
+                        invokestatic(criticalArrayLength, 1, 1);
+                        nativeFunctionDescriptor.append(JavaTypeDescriptor.INT);
+                        nativeFunctionArgSlots += Kind.INT.stackSlots;
+
+                        aload(parameterLocalIndex);
+                        invokestatic(criticalArrayElements, 1, 1);
+                        nativeParameterDescriptor = JavaTypeDescriptor.WORD;
+                        break;
+                    }
+
                     aload(handles);
                     iconst(handleOffset);
                     aload(parameterLocalIndex);
@@ -294,17 +314,17 @@ public final class NativeStubGenerator extends BytecodeAssembler {
 
         if (NativeInterfaces.needsPrologueAndEpilogue(classMethodActor)) {
             ldc(nf);
-            invokestatic(!isCFunction ? nativeCallPrologue : nativeCallPrologueForC, 1, 0);
+            invokestatic(!isCFunction && !isCritical ? nativeCallPrologue : nativeCallPrologueForC, 1, 0);
         }
 
         // Invoke the native function
         callnative(SignatureDescriptor.create(nativeFunctionDescriptor.append(')').append(nativeResultDescriptor).toString()), nativeFunctionArgSlots, nativeResultDescriptor.toKind().stackSlots);
 
         if (NativeInterfaces.needsPrologueAndEpilogue(classMethodActor)) {
-            invokestatic(!isCFunction ? nativeCallEpilogue : nativeCallEpilogueForC, 0, 0);
+            invokestatic(!isCFunction && !isCritical ? nativeCallEpilogue : nativeCallEpilogueForC, 0, 0);
         }
 
-        if (!isCFunction) {
+        if (!isCFunction && !isCritical) {
             // Unwrap a reference result from its enclosing JNI handle. This must be done
             // *before* the JNI frame is restored.
             if (resultKind.isReference) {
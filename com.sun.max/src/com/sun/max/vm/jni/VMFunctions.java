@@ -42,6 +42,9 @@ import com.sun.max.vm.actor.member.*;
 import com.sun.max.vm.compiler.target.*;
 import com.sun.max.vm.heap.*;
 import com.sun.max.vm.jdk.*;
+import com.sun.max.vm.layout.*;
+import com.sun.max.vm.management.*;
+import com.sun.max.vm.object.*;
 import com.sun.max.vm.runtime.*;
 import com.sun.max.vm.stack.*;
 import com.sun.max.vm.thread.*;
@@ -148,7 +151,7 @@ public class VMFunctions {
 
     @VM_ENTRY_POINT
     private static void Unimplemented(Pointer env) {
-        // Source: VMFunctionsSource.java:54
+        // Source: VMFunctionsSource.java:57
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.Unimplemented.ordinal(), UPCALL_ENTRY, anchor, env);
@@ -169,7 +172,7 @@ public class VMFunctions {
 
     @VM_ENTRY_POINT
     private static int HashCode(Pointer env, JniHandle obj) {
-        // Source: VMFunctionsSource.java:59
+        // Source: VMFunctionsSource.java:62
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.HashCode.ordinal(), UPCALL_ENTRY, anchor, env, obj);
@@ -191,7 +194,7 @@ public class VMFunctions {
 
     @VM_ENTRY_POINT
     private static void MonitorWait(Pointer env, JniHandle obj, long timeout) throws InterruptedException {
-        // Source: VMFunctionsSource.java:64
+        // Source: VMFunctionsSource.java:67
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.MonitorWait.ordinal(), UPCALL_ENTRY, anchor, env, obj, Address.fromLong(timeout));
@@ -212,7 +215,7 @@ public class VMFunctions {
 
     @VM_ENTRY_POINT
     private static void MonitorNotify(Pointer env, JniHandle obj) {
-        // Source: VMFunctionsSource.java:69
+        // Source: VMFunctionsSource.java:72
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.MonitorNotify.ordinal(), UPCALL_ENTRY, anchor, env, obj);
@@ -233,7 +236,7 @@ public class VMFunctions {
 
     @VM_ENTRY_POINT
     private static void MonitorNotifyAll(Pointer env, JniHandle obj) {
-        // Source: VMFunctionsSource.java:74
+        // Source: VMFunctionsSource.java:77
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.MonitorNotifyAll.ordinal(), UPCALL_ENTRY, anchor, env, obj);
@@ -254,7 +257,7 @@ public class VMFunctions {
 
     @VM_ENTRY_POINT
     private static JniHandle Clone(Pointer env, JniHandle obj) throws CloneNotSupportedException {
-        // Source: VMFunctionsSource.java:79
+        // Source: VMFunctionsSource.java:82
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.Clone.ordinal(), UPCALL_ENTRY, anchor, env, obj);
@@ -279,7 +282,7 @@ public class VMFunctions {
 
     @VM_ENTRY_POINT
     private static JniHandle InternString(Pointer env, JniHandle s) {
-        // Source: VMFunctionsSource.java:87
+        // Source: VMFunctionsSource.java:90
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.InternString.ordinal(), UPCALL_ENTRY, anchor, env, s);
@@ -301,7 +304,7 @@ public class VMFunctions {
 
     @VM_ENTRY_POINT
     private static void Exit(Pointer env, int code) {
-        // Source: VMFunctionsSource.java:92
+        // Source: VMFunctionsSource.java:95
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.Exit.ordinal(), UPCALL_ENTRY, anchor, env, Address.fromInt(code));
@@ -322,7 +325,7 @@ public class VMFunctions {
 
     @VM_ENTRY_POINT
     private static void Halt(Pointer env, int code) {
-        // Source: VMFunctionsSource.java:97
+        // Source: VMFunctionsSource.java:100
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.Halt.ordinal(), UPCALL_ENTRY, anchor, env, Address.fromInt(code));
@@ -343,7 +346,7 @@ public class VMFunctions {
 
     @VM_ENTRY_POINT
     private static void GC(Pointer env) {
-        // Source: VMFunctionsSource.java:102
+        // Source: VMFunctionsSource.java:105
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.GC.ordinal(), UPCALL_ENTRY, anchor, env);
@@ -364,7 +367,7 @@ public class VMFunctions {
 
     @VM_ENTRY_POINT
     private static long MaxObjectInspectionAge(Pointer env) {
-        // Source: VMFunctionsSource.java:107
+        // Source: VMFunctionsSource.java:110
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.MaxObjectInspectionAge.ordinal(), UPCALL_ENTRY, anchor, env);
@@ -386,7 +389,7 @@ public class VMFunctions {
 
     @VM_ENTRY_POINT
     private static long FreeMemory(Pointer env) {
-        // Source: VMFunctionsSource.java:112
+        // Source: VMFunctionsSource.java:115
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.FreeMemory.ordinal(), UPCALL_ENTRY, anchor, env);
@@ -408,7 +411,7 @@ public class VMFunctions {
 
     @VM_ENTRY_POINT
     private static long MaxMemory(Pointer env) {
-        // Source: VMFunctionsSource.java:117
+        // Source: VMFunctionsSource.java:120
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.MaxMemory.ordinal(), UPCALL_ENTRY, anchor, env);
@@ -430,7 +433,7 @@ public class VMFunctions {
 
     @VM_ENTRY_POINT
     private static void FillInStackTrace(Pointer env, JniHandle throwable) {
-        // Source: VMFunctionsSource.java:122
+        // Source: VMFunctionsSource.java:125
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.FillInStackTrace.ordinal(), UPCALL_ENTRY, anchor, env, throwable);
@@ -451,7 +454,7 @@ public class VMFunctions {
 
     @VM_ENTRY_POINT
     private static int GetStackTraceDepth(Pointer env, JniHandle throwable) {
-        // Source: VMFunctionsSource.java:127
+        // Source: VMFunctionsSource.java:130
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.GetStackTraceDepth.ordinal(), UPCALL_ENTRY, anchor, env, throwable);
@@ -473,7 +476,7 @@ public class VMFunctions {
 
     @VM_ENTRY_POINT
     private static JniHandle GetStackTraceElement(Pointer env, JniHandle throwable, int index) {
-        // Source: VMFunctionsSource.java:132
+        // Source: VMFunctionsSource.java:135
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.GetStackTraceElement.ordinal(), UPCALL_ENTRY, anchor, env, throwable, Address.fromInt(index));
@@ -495,7 +498,7 @@ public class VMFunctions {
 
     @VM_ENTRY_POINT
     private static void StartThread(Pointer env, JniHandle thread) {
-        // Source: VMFunctionsSource.java:137
+        // Source: VMFunctionsSource.java:140
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.StartThread.ordinal(), UPCALL_ENTRY, anchor, env, thread);
@@ -517,7 +520,7 @@ public class VMFunctions {
     @SuppressWarnings("deprecation")
     @VM_ENTRY_POINT
     private static void StopThread(Pointer env, JniHandle thread, JniHandle throwable) {
-        // Source: VMFunctionsSource.java:143
+        // Source: VMFunctionsSource.java:146
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.StopThread.ordinal(), UPCALL_ENTRY, anchor, env, thread, throwable);
@@ -538,7 +541,7 @@ public class VMFunctions {
 
     @VM_ENTRY_POINT
     private static boolean IsThreadAlive(Pointer env, JniHandle thread) {
-        // Source: VMFunctionsSource.java:148
+        // Source: VMFunctionsSource.java:151
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.IsThreadAlive.ordinal(), UPCALL_ENTRY, anchor, env, thread);
@@ -561,7 +564,7 @@ public class VMFunctions {
     @SuppressWarnings("deprecation")
     @VM_ENTRY_POINT
     private static void SuspendThread(Pointer env, JniHandle thread) {
-        // Source: VMFunctionsSource.java:154
+        // Source: VMFunctionsSource.java:157
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.SuspendThread.ordinal(), UPCALL_ENTRY, anchor, env, thread);
@@ -583,7 +586,7 @@ public class VMFunctions {
     @SuppressWarnings("deprecation")
     @VM_ENTRY_POINT
     private static void ResumeThread(Pointer env, JniHandle thread) {
-        // Source: VMFunctionsSource.java:160
+        // Source: VMFunctionsSource.java:163
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.ResumeThread.ordinal(), UPCALL_ENTRY, anchor, env, thread);
@@ -604,7 +607,7 @@ public class VMFunctions {
 
     @VM_ENTRY_POINT
     private static void SetThreadPriority(Pointer env, JniHandle thread, int newPriority) {
-        // Source: VMFunctionsSource.java:165
+        // Source: VMFunctionsSource.java:168
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.SetThreadPriority.ordinal(), UPCALL_ENTRY, anchor, env, thread, Address.fromInt(newPriority));
@@ -625,7 +628,7 @@ public class VMFunctions {
 
     @VM_ENTRY_POINT
     private static void Yield(Pointer env) {
-        // Source: VMFunctionsSource.java:170
+        // Source: VMFunctionsSource.java:173
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.Yield.ordinal(), UPCALL_ENTRY, anchor, env);
@@ -646,7 +649,7 @@ public class VMFunctions {
 
     @VM_ENTRY_POINT
     private static void Sleep(Pointer env, long millis) throws InterruptedException {
-        // Source: VMFunctionsSource.java:175
+        // Source: VMFunctionsSource.java:178
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.Sleep.ordinal(), UPCALL_ENTRY, anchor, env, Address.fromLong(millis));
@@ -667,7 +670,7 @@ public class VMFunctions {
 
     @VM_ENTRY_POINT
     private static JniHandle CurrentThread(Pointer env) {
-        // Source: VMFunctionsSource.java:180
+        // Source: VMFunctionsSource.java:183
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.CurrentThread.ordinal(), UPCALL_ENTRY, anchor, env);
@@ -690,7 +693,7 @@ public class VMFunctions {
     @SuppressWarnings("deprecation")
     @VM_ENTRY_POINT
     private static int CountStackFrames(Pointer env, JniHandle thread) {
-        // Source: VMFunctionsSource.java:186
+        // Source: VMFunctionsSource.java:189
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.CountStackFrames.ordinal(), UPCALL_ENTRY, anchor, env, thread);
@@ -712,7 +715,7 @@ public class VMFunctions {
 
     @VM_ENTRY_POINT
     private static void Interrupt(Pointer env, JniHandle thread) {
-        // Source: VMFunctionsSource.java:191
+        // Source: VMFunctionsSource.java:194
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.Interrupt.ordinal(), UPCALL_ENTRY, anchor, env, thread);
@@ -733,7 +736,7 @@ public class VMFunctions {
 
     @VM_ENTRY_POINT
     private static boolean IsInterrupted(Pointer env, JniHandle thread) {
-        // Source: VMFunctionsSource.java:196
+        // Source: VMFunctionsSource.java:199
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.IsInterrupted.ordinal(), UPCALL_ENTRY, anchor, env, thread);
@@ -755,7 +758,7 @@ public class VMFunctions {
 
     @VM_ENTRY_POINT
     private static boolean HoldsLock(Pointer env, JniHandle obj) {
-        // Source: VMFunctionsSource.java:201
+        // Source: VMFunctionsSource.java:204
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.HoldsLock.ordinal(), UPCALL_ENTRY, anchor, env, obj);
@@ -777,7 +780,7 @@ public class VMFunctions {
 
     @VM_ENTRY_POINT
     private static JniHandle GetClassContext(Pointer env) {
-        // Source: VMFunctionsSource.java:206
+        // Source: VMFunctionsSource.java:209
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.GetClassContext.ordinal(), UPCALL_ENTRY, anchor, env);
@@ -801,7 +804,7 @@ public class VMFunctions {
     @SuppressWarnings("deprecation")
     @VM_ENTRY_POINT
     private static JniHandle GetCallerClass(Pointer env, int depth) {
-        // Source: VMFunctionsSource.java:213
+        // Source: VMFunctionsSource.java:216
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.GetCallerClass.ordinal(), UPCALL_ENTRY, anchor, env, Address.fromInt(depth));
@@ -830,7 +833,7 @@ public class VMFunctions {
 
     @VM_ENTRY_POINT
     private static JniHandle GetSystemPackage(Pointer env, JniHandle name) {
-        // Source: VMFunctionsSource.java:225
+        // Source: VMFunctionsSource.java:228
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.GetSystemPackage.ordinal(), UPCALL_ENTRY, anchor, env, name);
@@ -852,7 +855,7 @@ public class VMFunctions {
 
     @VM_ENTRY_POINT
     private static JniHandle GetSystemPackages(Pointer env) {
-        // Source: VMFunctionsSource.java:230
+        // Source: VMFunctionsSource.java:233
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.GetSystemPackages.ordinal(), UPCALL_ENTRY, anchor, env);
@@ -874,7 +877,7 @@ public class VMFunctions {
 
     @VM_ENTRY_POINT
     private static JniHandle LatestUserDefinedLoader(Pointer env) {
-        // Source: VMFunctionsSource.java:235
+        // Source: VMFunctionsSource.java:238
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.LatestUserDefinedLoader.ordinal(), UPCALL_ENTRY, anchor, env);
@@ -901,7 +904,7 @@ public class VMFunctions {
 
     @VM_ENTRY_POINT
     private static JniHandle GetClassName(Pointer env, JniHandle c) {
-        // Source: VMFunctionsSource.java:245
+        // Source: VMFunctionsSource.java:248
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.GetClassName.ordinal(), UPCALL_ENTRY, anchor, env, c);
@@ -923,7 +926,7 @@ public class VMFunctions {
 
     @VM_ENTRY_POINT
     private static JniHandle GetClassLoader(Pointer env, JniHandle c) {
-        // Source: VMFunctionsSource.java:250
+        // Source: VMFunctionsSource.java:253
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.GetClassLoader.ordinal(), UPCALL_ENTRY, anchor, env, c);
@@ -945,7 +948,7 @@ public class VMFunctions {
 
     @VM_ENTRY_POINT
     private static boolean IsInterface(Pointer env, JniHandle c) {
-        // Source: VMFunctionsSource.java:255
+        // Source: VMFunctionsSource.java:258
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.IsInterface.ordinal(), UPCALL_ENTRY, anchor, env, c);
@@ -967,7 +970,7 @@ public class VMFunctions {
 
     @VM_ENTRY_POINT
     private static boolean IsArrayClass(Pointer env, JniHandle c) {
-        // Source: VMFunctionsSource.java:260
+        // Source: VMFunctionsSource.java:263
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.IsArrayClass.ordinal(), UPCALL_ENTRY, anchor, env, c);
@@ -989,7 +992,7 @@ public class VMFunctions {
 
     @VM_ENTRY_POINT
     private static boolean IsPrimitiveClass(Pointer env, JniHandle c) {
-        // Source: VMFunctionsSource.java:265
+        // Source: VMFunctionsSource.java:268
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.IsPrimitiveClass.ordinal(), UPCALL_ENTRY, anchor, env, c);
@@ -1011,7 +1014,7 @@ public class VMFunctions {
 
     @VM_ENTRY_POINT
     private static JniHandle GetClassSigners(Pointer env, JniHandle c) {
-        // Source: VMFunctionsSource.java:270
+        // Source: VMFunctionsSource.java:273
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.GetClassSigners.ordinal(), UPCALL_ENTRY, anchor, env, c);
@@ -1033,7 +1036,7 @@ public class VMFunctions {
 
     @VM_ENTRY_POINT
     private static void SetClassSigners(Pointer env, JniHandle c, JniHandle signers) {
-        // Source: VMFunctionsSource.java:275
+        // Source: VMFunctionsSource.java:278
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.SetClassSigners.ordinal(), UPCALL_ENTRY, anchor, env, c, signers);
@@ -1055,7 +1058,7 @@ public class VMFunctions {
 
     @VM_ENTRY_POINT
     private static JniHandle GetProtectionDomain(Pointer env, JniHandle c) {
-        // Source: VMFunctionsSource.java:281
+        // Source: VMFunctionsSource.java:284
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.GetProtectionDomain.ordinal(), UPCALL_ENTRY, anchor, env, c);
@@ -1077,7 +1080,7 @@ public class VMFunctions {
 
     @VM_ENTRY_POINT
     private static void SetProtectionDomain(Pointer env, JniHandle c, JniHandle pd) {
-        // Source: VMFunctionsSource.java:286
+        // Source: VMFunctionsSource.java:289
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.SetProtectionDomain.ordinal(), UPCALL_ENTRY, anchor, env, c, pd);
@@ -1098,7 +1101,7 @@ public class VMFunctions {
 
     @VM_ENTRY_POINT
     private static void ArrayCopy(Pointer env, JniHandle src, int srcPos, JniHandle dest, int destPos, int length) {
-        // Source: VMFunctionsSource.java:291
+        // Source: VMFunctionsSource.java:294
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.ArrayCopy.ordinal(), UPCALL_ENTRY, anchor, env, src, Address.fromInt(srcPos), dest, Address.fromInt(destPos), Address.fromInt(length));
@@ -1119,7 +1122,7 @@ public class VMFunctions {
 
     @VM_ENTRY_POINT
     private static JniHandle GetAllThreads(Pointer env) {
-        // Source: VMFunctionsSource.java:296
+        // Source: VMFunctionsSource.java:299
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.GetAllThreads.ordinal(), UPCALL_ENTRY, anchor, env);
@@ -1141,7 +1144,7 @@ public class VMFunctions {
 
     @VM_ENTRY_POINT
     private static JniHandle GetThreadStateValues(Pointer env, int javaThreadState) {
-        // Source: VMFunctionsSource.java:301
+        // Source: VMFunctionsSource.java:304
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.GetThreadStateValues.ordinal(), UPCALL_ENTRY, anchor, env, Address.fromInt(javaThreadState));
@@ -1166,7 +1169,7 @@ public class VMFunctions {
 
     @VM_ENTRY_POINT
     private static JniHandle GetThreadStateNames(Pointer env, int javaThreadState, JniHandle threadStateValues) {
-        // Source: VMFunctionsSource.java:309
+        // Source: VMFunctionsSource.java:312
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.GetThreadStateNames.ordinal(), UPCALL_ENTRY, anchor, env, Address.fromInt(javaThreadState), threadStateValues);
@@ -1193,7 +1196,7 @@ public class VMFunctions {
 
     @VM_ENTRY_POINT
     private static JniHandle InitAgentProperties(Pointer env, JniHandle props) {
-        // Source: VMFunctionsSource.java:319
+        // Source: VMFunctionsSource.java:322
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.InitAgentProperties.ordinal(), UPCALL_ENTRY, anchor, env, props);
@@ -1220,7 +1223,7 @@ public class VMFunctions {
 
     @VM_ENTRY_POINT
     private static int GetNumberOfArguments(Pointer env, MethodID methodID) throws NoSuchMethodException {
-        // Source: VMFunctionsSource.java:329
+        // Source: VMFunctionsSource.java:332
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.GetNumberOfArguments.ordinal(), UPCALL_ENTRY, anchor, env, methodID);
@@ -1246,7 +1249,7 @@ public class VMFunctions {
 
     @VM_ENTRY_POINT
     private static void GetKindsOfArguments(Pointer env, MethodID methodID, Pointer kinds) throws Exception {
-        // Source: VMFunctionsSource.java:338
+        // Source: VMFunctionsSource.java:341
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.GetKindsOfArguments.ordinal(), UPCALL_ENTRY, anchor, env, methodID, kinds);
@@ -1275,7 +1278,7 @@ public class VMFunctions {
 
     @VM_ENTRY_POINT
     private static void SetJVMTIEnv(Pointer env, Pointer jvmtiEnv) {
-        // Source: VMFunctionsSource.java:351
+        // Source: VMFunctionsSource.java:354
         Pointer anchor = prologue(env);
         if (logger.enabled()) {
             logger.log(LogOperations.SetJVMTIEnv.ordinal(), UPCALL_ENTRY, anchor, env, jvmtiEnv);
@@ -1294,6 +1297,161 @@ public class VMFunctions {
         }
     }
 
+    /**
+     * Gets the offset of the first element of a primitive array from the object's origin, which is
+     * the base of the offsets passed to JVM_CopySwapMemory for array operands.
+     */
+    @VM_ENTRY_POINT
+    private static int ArrayBaseOffset(Pointer env) {
+        // Source: VMFunctionsSource.java:363
+        Pointer anchor = prologue(env);
+        if (logger.enabled()) {
+            logger.log(LogOperations.ArrayBaseOffset.ordinal(), UPCALL_ENTRY, anchor, env);
+        }
+
+        try {
+            return Layout.byteArrayLayout().getElementOffsetFromOrigin(0).toInt();
+        } catch (Throwable t) {
+            VmThread.fromJniEnv(env).setJniException(t);
+            return JNI_ERR;
+        } finally {
+            epilogue(anchor);
+            if (logger.enabled()) {
+                logger.log(LogOperations.ArrayBaseOffset.ordinal(), UPCALL_EXIT);
+            }
+
+        }
+    }
+
+    /**
+     * Checks that a {@link System#arraycopy} between two arrays can be done by JVM_ArrayCopy as a copy of memory.
+     *
+     * @return the size of the array elements if both arrays are primitive arrays of the same type and the range
+     *         to copy is within both arrays, otherwise 0 (the copy must then be done by {@code ArrayCopy})
+     */
+    @VM_ENTRY_POINT
+    private static int PrimitiveArrayCopyElementSize(Pointer env, JniHandle src, int srcPos, JniHandle dest, int destPos, int length) {
+        // Source: VMFunctionsSource.java:374
+        Pointer anchor = prologue(env);
+        if (logger.enabled()) {
+            logger.log(LogOperations.PrimitiveArrayCopyElementSize.ordinal(), UPCALL_ENTRY, anchor, env, src, Address.fromInt(srcPos), dest, Address.fromInt(destPos), Address.fromInt(length));
+        }
+
+        try {
+            final Object srcArray = src.unhand();
+            final Object destArray = dest.unhand();
+            if (srcArray == null || destArray == null) {
+                return 0;
+            }
+            final ClassActor classActor = ObjectAccess.readClassActor(srcArray);
+            if (classActor != ObjectAccess.readClassActor(destArray) || !classActor.isArrayClass() || !classActor.componentClassActor().isPrimitiveClassActor()) {
+                return 0;
+            }
+            if (srcPos < 0 || destPos < 0 || length < 0 || srcPos > ArrayAccess.readArrayLength(srcArray) - length || destPos > ArrayAccess.readArrayLength(destArray) - length) {
+                return 0;
+            }
+            return classActor.componentClassActor().kind.width.numberOfBytes;
+        } catch (Throwable t) {
+            VmThread.fromJniEnv(env).setJniException(t);
+            return JNI_ERR;
+        } finally {
+            epilogue(anchor);
+            if (logger.enabled()) {
+                logger.log(LogOperations.PrimitiveArrayCopyElementSize.ordinal(), UPCALL_EXIT);
+            }
+
+        }
+    }
+
+    /**
+     * Gets a name or signature from the class file of a class for the JVM_Get*UTF functions in jvm.c.
+     * Class names are in internal form (e.g. {@code java/lang/Object}, or a descriptor for an array class).
+     *
+     * @param kind one of the CLASS_FILE_UTF_* constants in jvm.c
+     * @return {@code null} if {@code kind} is not known
+     */
+    @VM_ENTRY_POINT
+    private static JniHandle ClassFileUTF(Pointer env, JniHandle cb, int kind, int index) {
+        // Source: VMFunctionsSource.java:398
+        Pointer anchor = prologue(env);
+        if (logger.enabled()) {
+            logger.log(LogOperations.ClassFileUTF.ordinal(), UPCALL_ENTRY, anchor, env, cb, Address.fromInt(kind), Address.fromInt(index));
+        }
+
+        try {
+            final ClassActor classActor = ClassActor.fromJava(cb.unhand(Class.class));
+            final com.sun.max.vm.classfile.constant.ConstantPool pool = classActor.constantPool();
+            switch (kind) {
+                case 0: return createLocalHandle(internalName(classActor.typeDescriptor));
+                case 1: return createLocalHandle(pool.fieldAt(index).name(pool).string);
+                case 2: return createLocalHandle(pool.methodAt(index).name(pool).string);
+                case 3: return createLocalHandle(pool.methodAt(index).signature(pool).string);
+                case 4: return createLocalHandle(pool.fieldAt(index).type(pool).string);
+                case 5: return createLocalHandle(internalName(pool.classAt(index).typeDescriptor()));
+                case 6: return createLocalHandle(internalName(pool.fieldAt(index).holder(pool)));
+                case 7: return createLocalHandle(internalName(pool.methodAt(index).holder(pool)));
+                default: return createLocalHandle(null);
+            }
+        } catch (Throwable t) {
+            VmThread.fromJniEnv(env).setJniException(t);
+            return asJniHandle(0L);
+        } finally {
+            epilogue(anchor);
+            if (logger.enabled()) {
+                logger.log(LogOperations.ClassFileUTF.ordinal(), UPCALL_EXIT);
+            }
+
+        }
+    }
+
+    private static String internalName(TypeDescriptor type) {
+        final String descriptor = type.string;
+        return descriptor.charAt(0) == 'L' ? descriptor.substring(1, descriptor.length() - 1) : descriptor;
+    }
+
+    @VM_ENTRY_POINT
+    private static void DumpAllStacks(Pointer env) {
+        // Source: VMFunctionsSource.java:420
+        Pointer anchor = prologue(env);
+        if (logger.enabled()) {
+            logger.log(LogOperations.DumpAllStacks.ordinal(), UPCALL_ENTRY, anchor, env);
+        }
+
+        try {
+            ThreadManagement.dumpAllStacks();
+        } catch (Throwable t) {
+            VmThread.fromJniEnv(env).setJniException(t);
+        } finally {
+            epilogue(anchor);
+            if (logger.enabled()) {
+                logger.log(LogOperations.DumpAllStacks.ordinal(), UPCALL_EXIT);
+            }
+
+        }
+    }
+
+    @VM_ENTRY_POINT
+    private static JniHandle DumpThreads(Pointer env, JniHandle threads) {
+        // Source: VMFunctionsSource.java:425
+        Pointer anchor = prologue(env);
+        if (logger.enabled()) {
+            logger.log(LogOperations.DumpThreads.ordinal(), UPCALL_ENTRY, anchor, env, threads);
+        }
+
+        try {
+            return createLocalHandle(ThreadManagement.dumpThreads((Thread[]) threads.unhand()));
+        } catch (Throwable t) {
+            VmThread.fromJniEnv(env).setJniException(t);
+            return asJniHandle(0L);
+        } finally {
+            epilogue(anchor);
+            if (logger.enabled()) {
+                logger.log(LogOperations.DumpThreads.ordinal(), UPCALL_EXIT);
+            }
+
+        }
+    }
+
     // Checkstyle: resume method name check
     public static enum LogOperations {
         /* 0 */ Unimplemented,
@@ -1346,7 +1504,12 @@ public class VMFunctions {
         /* 47 */ InitAgentProperties,
         /* 48 */ GetNumberOfArguments,
         /* 49 */ GetKindsOfArguments,
-        /* 50 */ SetJVMTIEnv;
+        /* 50 */ SetJVMTIEnv,
+        /* 51 */ ArrayBaseOffset,
+        /* 52 */ PrimitiveArrayCopyElementSize,
+        /* 53 */ ClassFileUTF,
+        /* 54 */ DumpAllStacks,
+        /* 55 */ DumpThreads;
 
     }
 // END GENERATED CODE
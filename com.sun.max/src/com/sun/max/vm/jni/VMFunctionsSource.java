@@ -37,6 +37,9 @@ import com.sun.max.vm.actor.member.*;
 import com.sun.max.vm.heap.*;
 import com.sun.max.vm.jdk.*;
 import com.sun.max.vm.jni.VMFunctions.LatestUserDefinedLoaderVisitor;
+import com.sun.max.vm.layout.*;
+import com.sun.max.vm.management.*;
+import com.sun.max.vm.object.*;
 import com.sun.max.vm.runtime.*;
 import com.sun.max.vm.stack.*;
 import com.sun.max.vm.thread.*;
@@ -352,5 +355,76 @@ public class VMFunctionsSource {
         VMTI.handler().registerAgent(jvmtiEnv);
     }
 
+    /**
+     * Gets the offset of the first element of a primitive array from the object's origin, which is
+     * the base of the offsets passed to JVM_CopySwapMemory for array operands.
+     */
+    @VM_ENTRY_POINT
+    private static int ArrayBaseOffset(Pointer env) {
+        return Layout.byteArrayLayout().getElementOffsetFromOrigin(0).toInt();
+    }
+
+    /**
+     * Checks that a {@link System#arraycopy} between two arrays can be done by JVM_ArrayCopy as a copy of memory.
+     *
+     * @return the size of the array elements if both arrays are primitive arrays of the same type and the range
+     *         to copy is within both arrays, otherwise 0 (the copy must then be done by {@code ArrayCopy})
+     */
+    @VM_ENTRY_POINT
+    private static int PrimitiveArrayCopyElementSize(Pointer env, JniHandle src, int srcPos, JniHandle dest, int destPos, int length) {
+        final Object srcArray = src.unhand();
+        final Object destArray = dest.unhand();
+        if (srcArray == null || destArray == null) {
+            return 0;
+        }
+        final ClassActor classActor = ObjectAccess.readClassActor(srcArray);
+        if (classActor != ObjectAccess.readClassActor(destArray) || !classActor.isArrayClass() || !classActor.componentClassActor().isPrimitiveClassActor()) {
+            return 0;
+        }
+        if (srcPos < 0 || destPos < 0 || length < 0 || srcPos > ArrayAccess.readArrayLength(srcArray) - length || destPos > ArrayAccess.readArrayLength(destArray) - length) {
+            return 0;
+        }
+        return classActor.componentClassActor().kind.width.numberOfBytes;
+    }
+
+    /**
+     * Gets a name or signature from the class file of a class for the JVM_Get*UTF functions in jvm.c.
+     * Class names are in internal form (e.g. {@code java/lang/Object}, or a descriptor for an array class).
+     *
+     * @param kind one of the CLASS_FILE_UTF_* constants in jvm.c
+     * @return {@code null} if {@code kind} is not known
+     */
+    @VM_ENTRY_POINT
+    private static JniHandle ClassFileUTF(Pointer env, JniHandle cb, int kind, int index) {
+        final ClassActor classActor = ClassActor.fromJava(cb.unhand(Class.class));
+        final com.sun.max.vm.classfile.constant.ConstantPool pool = classActor.constantPool();
+        switch (kind) {
+            case 0: return createLocalHandle(internalName(classActor.typeDescriptor));
+            case 1: return createLocalHandle(pool.fieldAt(index).name(pool).string);
+            case 2: return createLocalHandle(pool.methodAt(index).name(pool).string);
+            case 3: return createLocalHandle(pool.methodAt(index).signature(pool).string);
+            case 4: return createLocalHandle(pool.fieldAt(index).type(pool).string);
+            case 5: return createLocalHandle(internalName(pool.classAt(index).typeDescriptor()));
+            case 6: return createLocalHandle(internalName(pool.fieldAt(index).holder(pool)));
+            case 7: return createLocalHandle(internalName(pool.methodAt(index).holder(pool)));
+            default: return createLocalHandle(null);
+        }
+    }
+
+    private static String internalName(TypeDescriptor type) {
+        final String descriptor = type.string;
+        return descriptor.charAt(0) == 'L' ? descriptor.substring(1, descriptor.length() - 1) : descriptor;
+    }
+
+    @VM_ENTRY_POINT
+    private static void DumpAllStacks(Pointer env) {
+        ThreadManagement.dumpAllStacks();
+    }
+
+    @VM_ENTRY_POINT
+    private static JniHandle DumpThreads(Pointer env, JniHandle threads) {
+        return createLocalHandle(ThreadManagement.dumpThreads((Thread[]) threads.unhand()));
+    }
+
     // Checkstyle: resume method name check
 }
@@ -0,0 +1,303 @@
+/*
+ * Copyright (c) 2012, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ */
+package com.sun.max.vm.management;
+
+import java.lang.management.*;
+
+import com.sun.max.memory.*;
+import com.sun.max.unsafe.*;
+import com.sun.max.vm.*;
+import com.sun.max.vm.heap.*;
+import com.sun.max.vm.runtime.*;
+import com.sun.max.vm.thread.*;
+
+/**
+ * A record of the recent garbage collections and a histogram of all GC pause times, filled in by the
+ * {@linkplain Heap#invokeGCCallbacks(Heap.GCCallbackPhase) GC callbacks} of {@link MemoryManagement}.
+ *
+ * All storage is allocated when the boot image is built: recording a collection only stores
+ * primitive values (the fast clock, the cause and the used bytes of each memory pool) into a ring of
+ * {@value #RING_SIZE} entries. The entries are read, and only then converted to {@link MemoryUsage}
+ * objects, on behalf of {@code jmm_GetLastGCStat}.
+ */
+public final class GCStatistics {
+
+    private GCStatistics() {
+    }
+
+    public static final int CAUSE_UNKNOWN = 0;
+    public static final int CAUSE_ALLOCATION_FAILURE = 1;
+    public static final int CAUSE_EXPLICIT = 2;
+
+    static final int RING_SIZE = 64;
+
+    /**
+     * The number of pools whose usage is recorded for each collection.
+     */
+    static final int MAX_POOLS = 16;
+
+    /**
+     * Bucket {@code i} of the pause histogram counts the pauses of at least 2<sup>i</sup> and less than
+     * 2<sup>i+1</sup> microseconds (bucket 0 also counts the shorter pauses).
+     */
+    static final int HISTOGRAM_BUCKETS = 32;
+
+    private static final long[] startMillis = new long[RING_SIZE];
+    private static final long[] endMillis = new long[RING_SIZE];
+    private static final long[] pauseNanos = new long[RING_SIZE];
+    private static final int[] causes = new int[RING_SIZE];
+    private static final long[] usedBefore = new long[RING_SIZE * MAX_POOLS];
+    private static final long[] usedAfter = new long[RING_SIZE * MAX_POOLS];
+    private static final long[] histogram = new long[HISTOGRAM_BUCKETS];
+
+    private static long startNanos;
+    private static long maxPauseNanos;
+    private static long totalPauseNanos;
+
+    /**
+     * The number of collections recorded. It is incremented when a collection ends, so readers can detect that
+     * an entry was overwritten while they read it.
+     */
+    private static volatile long count;
+
+    private static int indexOf(long gcIndex) {
+        return (int) (gcIndex & (RING_SIZE - 1));
+    }
+
+    private static int cause() {
+        final VmOperation operation = VmOperationThread.instance().currentOperation();
+        final VmThread requester = operation == null ? null : operation.callingThread();
+        if (requester == null) {
+            return CAUSE_UNKNOWN;
+        }
+        return requester.gcRequest.explicit ? CAUSE_EXPLICIT : CAUSE_ALLOCATION_FAILURE;
+    }
+
+    private static void recordUsage(MemoryPoolMXBean[] pools, long[] used, int index) {
+        final int base = index * MAX_POOLS;
+        for (int i = 0; i < MAX_POOLS; i++) {
+            long value = -1;
+            if (pools != null && i < pools.length && pools[i] instanceof MemoryPoolMXBeanAdaptor) {
+                value = ((MemoryPoolMXBeanAdaptor) pools[i]).used();
+            }
+            used[base + i] = value;
+        }
+    }
+
+    /**
+     * Records the start of a collection. This must not allocate.
+     *
+     * @param pools the memory pools, in the order used by {@link MemoryManagement#getMemoryPools()}, or {@code null}
+     */
+    static void gcStarted(MemoryPoolMXBean[] pools) {
+        final int index = indexOf(count);
+        startMillis[index] = System.currentTimeMillis() - MaxineVM.getStartupTime();
+        causes[index] = cause();
+        recordUsage(pools, usedBefore, index);
+        startNanos = System.nanoTime();
+    }
+
+    /**
+     * Records the end of a collection. This must not allocate.
+     */
+    static void gcFinished(MemoryPoolMXBean[] pools) {
+        final long pause = System.nanoTime() - startNanos;
+        final long c = count;
+        final int index = indexOf(c);
+        endMillis[index] = System.currentTimeMillis() - MaxineVM.getStartupTime();
+        pauseNanos[index] = pause;
+        recordUsage(pools, usedAfter, index);
+        final long micros = pause / 1000;
+        final int bucket = micros <= 1 ? 0 : Math.min(63 - Long.numberOfLeadingZeros(micros), HISTOGRAM_BUCKETS - 1);
+        histogram[bucket]++;
+        totalPauseNanos += pause;
+        if (pause > maxPauseNanos) {
+            maxPauseNanos = pause;
+        }
+        count = c + 1;
+    }
+
+    /**
+     * Gets the number of collections recorded.
+     */
+    public static long collectionCount() {
+        return count;
+    }
+
+    public static long totalPauseNanos() {
+        return totalPauseNanos;
+    }
+
+    public static long maxPauseNanos() {
+        return maxPauseNanos;
+    }
+
+    /**
+     * Gets an upper bound of a percentile of the GC pause times, computed from the pause histogram.
+     *
+     * @param percentile a value between 0 and 100
+     * @return the upper bound, in nanoseconds, of the bucket containing the percentile, or 0 if there has been no collection
+     */
+    public static long pausePercentileNanos(double percentile) {
+        final long[] buckets = histogram.clone();
+        long total = 0;
+        for (long n : buckets) {
+            total += n;
+        }
+        if (total == 0) {
+            return 0;
+        }
+        final long rank = (long) Math.ceil(total * percentile / 100);
+        long seen = 0;
+        for (int i = 0; i < HISTOGRAM_BUCKETS - 1; i++) {
+            seen += buckets[i];
+            if (seen >= Math.max(rank, 1)) {
+                return Math.min((2L << i) * 1000, maxPauseNanos);
+            }
+        }
+        return maxPauseNanos;
+    }
+
+    private static MemoryUsage[] usages(MemoryPoolMXBean[] pools, long[] used, int index) {
+        final MemoryUsage[] result = new MemoryUsage[pools.length];
+        for (int i = 0; i < pools.length; i++) {
+            final MemoryUsage current = pools[i].getUsage();
+            final long value = i < MAX_POOLS ? used[index * MAX_POOLS + i] : -1;
+            if (current != null) {
+                result[i] = value < 0 ? current : new MemoryUsage(current.getInit(), value, current.getCommitted(), current.getMax());
+            }
+        }
+        return result;
+    }
+
+    /**
+     * The names, types and descriptions of the values returned as GC extension attributes by {@code jmm_GetLastGCStat}.
+     */
+    private static final String[][] EXT_ATTRIBUTES = {
+        {"GcCause", "I", "Cause of the collection: 0 unknown, 1 allocation failure, 2 explicit"},
+        {"PauseNanos", "J", "Pause time of the collection in nanoseconds"},
+        {"PauseP50Nanos", "J", "Median pause time of all collections in nanoseconds"},
+        {"PauseP99Nanos", "J", "99th percentile pause time of all collections in nanoseconds"},
+        {"PauseMaxNanos", "J", "Longest pause time of all collections in nanoseconds"}
+    };
+
+    private static Pointer extAttributeStrings = Pointer.zero();
+
+    public static int extAttributeCount() {
+        return EXT_ATTRIBUTES.length;
+    }
+
+    /**
+     * Support for {@code jmm_GetGCExtAttributeInfo}: fills in up to {@code count} {@code jmmExtAttributeInfo} structures.
+     *
+     * @return the number of structures filled in
+     */
+    public static synchronized int getExtAttributeInfo(Pointer info, int count) {
+        final int n = Math.min(count, EXT_ATTRIBUTES.length);
+        if (extAttributeStrings.isZero()) {
+            // the strings are referenced by the caller for as long as it likes and are never freed
+            final Pointer strings = Memory.mustAllocate(Size.fromInt(EXT_ATTRIBUTES.length * 2 * Word.size()));
+            for (int i = 0; i < EXT_ATTRIBUTES.length; i++) {
+                strings.setWord(i * 2, CString.utf8FromJava(EXT_ATTRIBUTES[i][0]));
+                strings.setWord(i * 2 + 1, CString.utf8FromJava(EXT_ATTRIBUTES[i][2]));
+            }
+            extAttributeStrings = strings;
+        }
+        final int structSize = 3 * Word.size();
+        for (int i = 0; i < n; i++) {
+            final Pointer entry = info.plus(i * structSize);
+            entry.writeWord(0, extAttributeStrings.getWord(i * 2));
+            entry.writeByte(Word.size(), (byte) EXT_ATTRIBUTES[i][1].charAt(0));
+            entry.writeWord(2 * Word.size(), extAttributeStrings.getWord(i * 2 + 1));
+        }
+        return n;
+    }
+
+    // Offsets of the fields of a jmmGCStat structure
+    private static final int GC_INDEX = 0;
+    private static final int START_TIME = 8;
+    private static final int END_TIME = 16;
+    private static final int USAGE_BEFORE_GC = 24;
+    private static final int USAGE_AFTER_GC = USAGE_BEFORE_GC + Word.size();
+    private static final int EXT_VALUES_SIZE = USAGE_AFTER_GC + Word.size();
+    private static final int EXT_VALUES = EXT_VALUES_SIZE + Word.size();
+    private static final int NUM_EXT_ATTRIBUTES = EXT_VALUES + Word.size();
+
+    /**
+     * Support for {@code jmm_GetLastGCStat}: fills in a {@code jmmGCStat} structure with the most recent collection.
+     * The index of the collection is 0 if there has not been one.
+     *
+     * @param pools the memory pools corresponding to the elements of the usage arrays in the structure
+     */
+    public static void getLastGCStat(Pointer gcStat, MemoryPoolMXBean[] pools) {
+        long c;
+        long start;
+        long end;
+        long pause;
+        int cause;
+        MemoryUsage[] before;
+        MemoryUsage[] after;
+        do {
+            c = count;
+            if (c == 0) {
+                gcStat.writeLong(GC_INDEX, 0);
+                return;
+            }
+            final int index = indexOf(c - 1);
+            start = startMillis[index];
+            end = endMillis[index];
+            pause = pauseNanos[index];
+            cause = causes[index];
+            before = usages(pools, usedBefore, index);
+            after = usages(pools, usedAfter, index);
+        } while (c != count);
+
+        gcStat.writeLong(GC_INDEX, c);
+        gcStat.writeLong(START_TIME, start);
+        gcStat.writeLong(END_TIME, end);
+        copyUsages(gcStat.readWord(USAGE_BEFORE_GC), before);
+        copyUsages(gcStat.readWord(USAGE_AFTER_GC), after);
+
+        final int size = gcStat.readInt(EXT_VALUES_SIZE);
+        if (size < EXT_ATTRIBUTES.length) {
+            gcStat.writeInt(NUM_EXT_ATTRIBUTES, size == 0 ? 0 : -1);
+            return;
+        }
+        // an array of jvalue unions
+        final Pointer values = gcStat.readWord(EXT_VALUES).asPointer();
+        values.writeLong(0, 0L);
+        values.writeInt(0, cause);
+        values.writeLong(8, pause);
+        values.writeLong(16, pausePercentileNanos(50));
+        values.writeLong(24, pausePercentileNanos(99));
+        values.writeLong(32, maxPauseNanos);
+        gcStat.writeInt(NUM_EXT_ATTRIBUTES, EXT_ATTRIBUTES.length);
+    }
+
+    private static void copyUsages(Word handle, MemoryUsage[] usages) {
+        final Object[] array = (Object[]) handle.asJniHandle().unhand();
+        if (array != null) {
+            System.arraycopy(usages, 0, array, 0, Math.min(usages.length, array.length));
+        }
+    }
+}
@@ -0,0 +1,393 @@
+/*
+ * Copyright (c) 2011, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ */
+package com.sun.max.vm.management;
+
+import static com.sun.max.vm.VMConfiguration.*;
+
+import java.util.*;
+
+import com.sun.max.memory.*;
+import com.sun.max.unsafe.*;
+import com.sun.max.vm.actor.holder.*;
+import com.sun.max.vm.actor.member.*;
+import com.sun.max.vm.heap.*;
+import com.sun.max.vm.jni.*;
+import com.sun.max.vm.layout.*;
+import com.sun.max.vm.object.*;
+import com.sun.max.vm.reference.*;
+import com.sun.max.vm.runtime.*;
+import com.sun.max.vm.thread.*;
+import com.sun.max.vm.type.*;
+
+/**
+ * A {@link VmOperation} that writes a heap dump in the HPROF binary format.
+ *
+ * The heap is walked at a safepoint and the objects found are handed in batches to the native writer (see
+ * heapDump.c), whose worker threads serialize and compress them in parallel while the walk goes on. The class of
+ * an object is defined before the batch containing it is handed over. Static tuples and class mirrors are not
+ * dumped as objects: their contents are written as class dumps. The roots written are the boot classes, the
+ * {@link Thread} of each thread and the objects referenced by JNI global handles.
+ */
+public final class HeapDump extends VmOperation {
+
+    static {
+        new CriticalNativeMethod(HeapDump.class, "nativeOpen");
+        new CriticalNativeMethod(HeapDump.class, "nativeWriteName");
+        new CriticalNativeMethod(HeapDump.class, "nativeDefineClass");
+        new CriticalNativeMethod(HeapDump.class, "nativeDumpObjects");
+        new CriticalNativeMethod(HeapDump.class, "nativeWriteRoot");
+        new CriticalNativeMethod(HeapDump.class, "nativeClose");
+    }
+
+    /**
+     * The number of objects in a batch handed to the native writer.
+     */
+    private static final int BATCH = 16384;
+
+    /**
+     * The size of {@code heapDump_EntryStruct} in heapDump.c.
+     */
+    private static final int ENTRY_SIZE = 32;
+
+    /**
+     * The sizes of {@code heapDump_ClassDescriptorStruct}, {@code heapDump_StaticFieldStruct} and
+     * {@code heapDump_FieldStruct} in heapDump.c.
+     */
+    private static final int CLASS_DESCRIPTOR_SIZE = 48;
+    private static final int STATIC_FIELD_SIZE = 24;
+    private static final int FIELD_SIZE = 16;
+
+    /**
+     * The HPROF basic types.
+     */
+    private static final int HPROF_NORMAL_OBJECT = 2;
+    private static final int HPROF_BOOLEAN = 4;
+    private static final int HPROF_CHAR = 5;
+    private static final int HPROF_FLOAT = 6;
+    private static final int HPROF_DOUBLE = 7;
+    private static final int HPROF_BYTE = 8;
+    private static final int HPROF_SHORT = 9;
+    private static final int HPROF_INT = 10;
+    private static final int HPROF_LONG = 11;
+
+    /**
+     * The HPROF root sub-record tags written by {@link #nativeWriteRoot}.
+     */
+    private static final int HPROF_GC_ROOT_JNI_GLOBAL = 0x01;
+    private static final int HPROF_GC_ROOT_THREAD_OBJ = 0x08;
+
+    private static final FieldActor[] NO_FIELDS = {};
+
+    private final DumpVisitor visitor = new DumpVisitor();
+    private final BitSet definedClasses = new BitSet();
+    private Pointer dump;
+    private Pointer entries = Pointer.zero();
+    private int count;
+    private Pointer scratch = Pointer.zero();
+    private int scratchSize;
+    private int result = -1;
+
+    private HeapDump(Pointer dump) {
+        super("DumpHeap", null, Mode.Safepoint, false);
+        this.dump = dump;
+    }
+
+    /**
+     * Writes a heap dump to a file, gzip compressed if its name ends with {@code ".gz"}.
+     *
+     * @param live specifies if only the live objects are to be dumped, in which case a full collection is done first
+     * @return 0 if the dump was written completely, -1 otherwise
+     */
+    public static int dump(String path, boolean live) {
+        if (live) {
+            System.gc();
+        }
+        final Pointer cPath = CString.utf8FromJava(path);
+        final Pointer dump = nativeOpen(cPath, path.endsWith(".gz"));
+        Memory.deallocate(cPath);
+        if (dump.isZero()) {
+            return -1;
+        }
+        final HeapDump operation = new HeapDump(dump);
+        operation.submit();
+        return operation.result;
+    }
+
+    final class DumpVisitor extends CallbackCellVisitor {
+        @Override
+        protected boolean callback(Object object) {
+            final Hub hub = ObjectAccess.readHub(object);
+            final ClassActor classActor = hub.classActor;
+            if (hub instanceof StaticHub) {
+                defineClass(classActor);
+                return true;
+            }
+            if (classActor == ClassRegistry.CLASS) {
+                final ClassActor mirrored = (ClassActor) InjectedReferenceFieldActor.Class_classActor.getObject(object);
+                if (mirrored != null) {
+                    defineClass(mirrored);
+                }
+                return true;
+            }
+            defineClass(classActor);
+
+            final Reference reference = Reference.fromJava(object);
+            final Pointer entry = entries.plus(count * ENTRY_SIZE);
+            entry.writeLong(0, reference.toOrigin().toLong());
+            entry.writeLong(8, classId(classActor));
+            if (classActor.isArrayClass()) {
+                entry.writeInt(16, basicType(classActor.componentClassActor().kind));
+                entry.writeInt(20, Layout.readArrayLength(reference));
+                entry.writeInt(24, ((ArrayLayout) hub.specificLayout).getElementOffsetFromOrigin(0).toInt());
+            } else {
+                entry.writeInt(16, 0);
+                entry.writeInt(20, 0);
+                entry.writeInt(24, 0);
+            }
+            entry.writeInt(28, 0);
+            if (++count == BATCH) {
+                flush();
+            }
+            return true;
+        }
+    }
+
+    @Override
+    protected void doIt() {
+        // As for the JVMTI heap iteration, the bookkeeping of the dump is allocated in the immortal heap
+        try {
+            Heap.enableImmortalMemoryAllocation();
+            entries = Memory.mustAllocate(BATCH * ENTRY_SIZE);
+            vmConfig().heapScheme().walkHeap(visitor);
+            flush();
+            writeRoots();
+        } finally {
+            result = nativeClose(dump);
+            dump = Pointer.zero();
+            if (!entries.isZero()) {
+                Memory.deallocate(entries);
+            }
+            if (!scratch.isZero()) {
+                Memory.deallocate(scratch);
+            }
+            Heap.disableImmortalMemoryAllocation();
+        }
+    }
+
+    /**
+     * Writes the thread and JNI global roots. The threads and the global handles cannot change at the safepoint.
+     */
+    private void writeRoots() {
+        VmThreadMap.ACTIVE.forAllThreadLocals(null, new Pointer.Procedure() {
+            public void run(Pointer tla) {
+                final VmThread vmThread = VmThread.fromTLA(tla);
+                final Thread javaThread = vmThread.javaThread();
+                if (javaThread != null) {
+                    nativeWriteRoot(dump, HPROF_GC_ROOT_THREAD_OBJ, id(javaThread), vmThread.id());
+                }
+            }
+        });
+        JniHandles.visitGlobalHandles(new JniHandles.GlobalHandleVisitor() {
+            public void visit(JniHandle handle, Object object) {
+                nativeWriteRoot(dump, HPROF_GC_ROOT_JNI_GLOBAL, id(object), handle.asAddress().toLong());
+            }
+        });
+    }
+
+    private void flush() {
+        if (count > 0) {
+            nativeDumpObjects(dump, entries, count);
+            count = 0;
+        }
+    }
+
+    /**
+     * Gets a native buffer of at least a given size, shared by the names and the class descriptors.
+     */
+    private Pointer scratch(int size) {
+        if (size > scratchSize) {
+            if (!scratch.isZero()) {
+                Memory.deallocate(scratch);
+            }
+            scratchSize = Math.max(size, 4096);
+            scratch = Memory.mustAllocate(scratchSize);
+        }
+        return scratch;
+    }
+
+    /**
+     * Gets the id of a class, which is the address of its mirror or, if it has none yet, of its actor (tagged so
+     * that it cannot be mistaken for an object).
+     */
+    private static long classId(ClassActor classActor) {
+        final Object javaClass = ClassRegistry.ClassActor_javaClass.getObject(classActor);
+        if (javaClass != null) {
+            return Reference.fromJava(javaClass).toOrigin().toLong();
+        }
+        return Reference.fromJava(classActor).toOrigin().toLong() | 1;
+    }
+
+    private static long id(Object object) {
+        return object == null ? 0 : Reference.fromJava(object).toOrigin().toLong();
+    }
+
+    private static int basicType(Kind kind) {
+        switch (kind.asEnum) {
+            case BOOLEAN:
+                return HPROF_BOOLEAN;
+            case BYTE:
+                return HPROF_BYTE;
+            case CHAR:
+                return HPROF_CHAR;
+            case SHORT:
+                return HPROF_SHORT;
+            case INT:
+                return HPROF_INT;
+            case FLOAT:
+                return HPROF_FLOAT;
+            case LONG:
+                return HPROF_LONG;
+            case DOUBLE:
+                return HPROF_DOUBLE;
+            case WORD:
+                return Word.size() == 8 ? HPROF_LONG : HPROF_INT;
+            default:
+                return HPROF_NORMAL_OBJECT;
+        }
+    }
+
+    /**
+     * Writes a name, identified by the address of its string.
+     */
+    private void writeName(String name, boolean className) {
+        final int size = name.length() * 3 + 1;
+        final Pointer buffer = scratch(size);
+        CString.writePartialUtf8(name, 0, name.length(), buffer, size);
+        nativeWriteName(dump, id(name), buffer, className);
+    }
+
+    private static long staticValue(Object staticTuple, FieldActor fieldActor) {
+        if (staticTuple == null) {
+            return 0;
+        }
+        final Reference tuple = Reference.fromJava(staticTuple);
+        final int offset = fieldActor.offset();
+        switch (basicType(fieldActor.kind)) {
+            case HPROF_NORMAL_OBJECT:
+                return tuple.readReference(offset).toOrigin().toLong();
+            case HPROF_BOOLEAN:
+            case HPROF_BYTE:
+                return tuple.readByte(offset);
+            case HPROF_CHAR:
+            case HPROF_SHORT:
+                return tuple.readShort(offset);
+            case HPROF_FLOAT:
+            case HPROF_INT:
+                return tuple.readInt(offset);
+            default:
+                return tuple.readLong(offset);
+        }
+    }
+
+    /**
+     * Defines a class and its super classes to the native writer, unless they have already been defined.
+     */
+    private void defineClass(ClassActor classActor) {
+        if (classActor == null || classActor.isPrimitiveClassActor() || definedClasses.get(classActor.id)) {
+            return;
+        }
+        definedClasses.set(classActor.id);
+        defineClass(classActor.superClassActor);
+
+        final FieldActor[] statics = classActor.localStaticFieldActors();
+        final FieldActor[] fields = classActor.isArrayClass() ? NO_FIELDS : classActor.localInstanceFieldActors();
+        writeName(classActor.typeDescriptor.string, true);
+        for (FieldActor fieldActor : statics) {
+            writeName(fieldActor.name.string, false);
+        }
+        for (FieldActor fieldActor : fields) {
+            writeName(fieldActor.name.string, false);
+        }
+
+        // The names are written first as they share the scratch buffer with the descriptor
+        final Pointer descriptor = scratch(CLASS_DESCRIPTOR_SIZE + statics.length * STATIC_FIELD_SIZE + fields.length * FIELD_SIZE);
+        final ClassLoader classLoader = classActor.classLoader;
+        descriptor.writeLong(0, classId(classActor));
+        descriptor.writeLong(8, classActor.superClassActor == null ? 0 : classId(classActor.superClassActor));
+        descriptor.writeLong(16, classLoader == BootClassLoader.BOOT_CLASS_LOADER ? 0 : id(classLoader));
+        descriptor.writeLong(24, id(classActor.typeDescriptor.string));
+        descriptor.writeInt(32, classActor.isArrayClass() ? 0 : classActor.dynamicTupleSize().toInt());
+        descriptor.writeInt(36, statics.length);
+        descriptor.writeInt(40, fields.length);
+        descriptor.writeInt(44, 0);
+        Pointer p = descriptor.plus(CLASS_DESCRIPTOR_SIZE);
+        final Object staticTuple = classActor.staticTuple();
+        for (FieldActor fieldActor : statics) {
+            p.writeLong(0, id(fieldActor.name.string));
+            p.writeLong(8, staticValue(staticTuple, fieldActor));
+            p.writeInt(16, basicType(fieldActor.kind));
+            p.writeInt(20, 0);
+            p = p.plus(STATIC_FIELD_SIZE);
+        }
+        for (FieldActor fieldActor : fields) {
+            p.writeLong(0, id(fieldActor.name.string));
+            p.writeInt(8, basicType(fieldActor.kind));
+            p.writeInt(12, fieldActor.offset());
+            p = p.plus(FIELD_SIZE);
+        }
+        nativeDefineClass(dump, descriptor);
+    }
+
+    /**
+     * Creates the dump file and starts the native writer.
+     *
+     * @return the native writer or zero if the file could not be created
+     */
+    private static native Pointer nativeOpen(Pointer path, boolean compress);
+
+    private static native void nativeWriteName(Pointer dump, long id, Pointer utf8, boolean className);
+
+    /**
+     * Defines a class (see {@code heapDump_ClassDescriptorStruct} in heapDump.c).
+     */
+    private static native void nativeDefineClass(Pointer dump, Pointer descriptor);
+
+    /**
+     * Hands a batch of {@code count} entries (see {@code heapDump_EntryStruct} in heapDump.c) to the native writer,
+     * which copies it.
+     */
+    private static native void nativeDumpObjects(Pointer dump, Pointer entries, int count);
+
+    /**
+     * Writes a root of type {@code tag} for the object identified by {@code id}. The {@code extra} value is the
+     * thread serial number of a thread root and the handle of a JNI global root.
+     */
+    private static native void nativeWriteRoot(Pointer dump, int tag, long id, long extra);
+
+    /**
+     * Finishes the dump and releases the native writer.
+     *
+     * @return 0 if the dump was written completely, -1 otherwise
+     */
+    private static native int nativeClose(Pointer dump);
+}
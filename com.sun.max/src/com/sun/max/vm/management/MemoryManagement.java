@@ -29,13 +29,50 @@ import java.util.*;
 
 import com.sun.max.vm.code.*;
 import com.sun.max.vm.heap.*;
+import com.sun.max.vm.heap.Heap.GCCallbackPhase;
 
 /**
  * This class provides the entry point to all the memory management functions in Maxine.
+ *
+ * The set of pools is fixed once the VM is running, so the heap and non-heap pools are computed on the
+ * first query and the usage queries, which monitoring agents poll periodically, only read the allocation
+ * marks of the pool regions.
  */
 
 public class MemoryManagement {
 
+    private static volatile MemoryPoolMXBean[] heapPools;
+    private static MemoryPoolMXBean[] nonHeapPools;
+
+    private static MemoryPoolMXBean[] allPools;
+
+    static {
+        Heap.registerGCCallback(new Heap.GCCallback() {
+            public void gcCallback(GCCallbackPhase gcCallbackPhase) {
+                // The pools are only tracked once they have been queried: they cannot be created during a GC.
+                final MemoryPoolMXBean[] pools = heapPools;
+                if (gcCallbackPhase == GCCallbackPhase.BEFORE) {
+                    GCStatistics.gcStarted(pools == null ? null : allPools);
+                }
+                if (pools != null && gcCallbackPhase != GCCallbackPhase.INIT) {
+                    for (MemoryPoolMXBean pool : pools) {
+                        if (pool instanceof MemoryPoolMXBeanAdaptor) {
+                            final MemoryPoolMXBeanAdaptor adaptor = (MemoryPoolMXBeanAdaptor) pool;
+                            if (gcCallbackPhase == GCCallbackPhase.BEFORE) {
+                                adaptor.beforeCollection();
+                            } else {
+                                adaptor.afterCollection();
+                            }
+                        }
+                    }
+                }
+                if (gcCallbackPhase == GCCallbackPhase.AFTER) {
+                    GCStatistics.gcFinished(pools == null ? null : allPools);
+                }
+            }
+        });
+    }
+
     public static MemoryPoolMXBean[] getMemoryPools() {
         /*
          * It is somewhat annoying that a MemoryManagerMXBean only provides access to the names
@@ -65,22 +102,57 @@ public class MemoryManagement {
     }
 
     public static MemoryUsage getMemoryUsage(boolean heap) {
-        List<MemoryPoolMXBean> pools = null;
-        if (heap) {
-            pools = new ArrayList<MemoryPoolMXBean>();
+        return sum(getPools(heap));
+    }
+
+    private static MemoryPoolMXBean[] getPools(boolean heap) {
+        if (heapPools == null) {
+            final List<MemoryPoolMXBean> pools = new ArrayList<MemoryPoolMXBean>();
             pools.addAll(getMemoryManagerMXBeanPools(ImmortalHeap.getMemoryManagerMXBean()).getAll());
             pools.addAll(getMemoryManagerMXBeanPools(vmConfig().heapScheme().getGarbageCollectorMXBean()).getAll());
-        } else {
-            pools = getMemoryManagerMXBeanPools(Code.getMemoryManagerMXBean()).getAll();
+            final List<MemoryPoolMXBean> codePools = getMemoryManagerMXBeanPools(Code.getMemoryManagerMXBean()).getAll();
+            nonHeapPools = codePools.toArray(new MemoryPoolMXBean[codePools.size()]);
+            pools.addAll(0, codePools);
+            allPools = pools.toArray(new MemoryPoolMXBean[pools.size()]);
+            heapPools = Arrays.copyOfRange(allPools, nonHeapPools.length, allPools.length);
         }
-        return sum(pools);
+        return heap ? heapPools : nonHeapPools;
+    }
+
+    /**
+     * Gets all the memory pools in the order of {@link #getMemoryPools()}.
+     */
+    public static MemoryPoolMXBean[] getAllPools() {
+        getPools(true);
+        return allPools;
+    }
+
+    /**
+     * Support for {@code jmm_GetMemoryPoolUsage}.
+     */
+    public static MemoryUsage getPoolUsage(MemoryPoolMXBean pool) {
+        return pool == null ? null : pool.getUsage();
+    }
+
+    /**
+     * Support for {@code jmm_GetPeakMemoryPoolUsage}.
+     */
+    public static MemoryUsage getPeakPoolUsage(MemoryPoolMXBean pool) {
+        return pool == null ? null : pool.getPeakUsage();
+    }
+
+    /**
+     * Support for {@code jmm_GetPoolCollectionUsage}.
+     */
+    public static MemoryUsage getPoolCollectionUsage(MemoryPoolMXBean pool) {
+        return pool == null ? null : pool.getCollectionUsage();
     }
 
     private static MemoryManagerMXBeanPools getMemoryManagerMXBeanPools(MemoryManagerMXBean memoryManagerMXBean) {
         return (MemoryManagerMXBeanPools) memoryManagerMXBean;
     }
 
-    private static MemoryUsage sum(List<MemoryPoolMXBean> pools) {
+    private static MemoryUsage sum(MemoryPoolMXBean[] pools) {
         long init = 0;
         long committed = 0;
         long max = 0;
@@ -88,6 +160,10 @@ public class MemoryManagement {
 
         for (MemoryPoolMXBean pool : pools) {
             final MemoryUsage poolUsage = pool.getUsage();
+            if (poolUsage == null) {
+                // the region of the pool does not record its usage
+                continue;
+            }
             init += poolUsage.getInit();
             committed += poolUsage.getCommitted();
             max += poolUsage.getMax();
@@ -101,4 +177,15 @@ public class MemoryManagement {
         Heap.setVerbose(value);
         return result;
     }
+
+    /**
+     * Writes a heap dump in the HPROF binary format (see {@link HeapDump}).
+     *
+     * @param path the file to write, gzip compressed if its name ends with {@code ".gz"}
+     * @param live specifies if only the live objects are to be dumped
+     * @return 0 if the dump was written completely, -1 otherwise
+     */
+    public static int dumpHeap(String path, boolean live) {
+        return HeapDump.dump(path, live);
+    }
 }
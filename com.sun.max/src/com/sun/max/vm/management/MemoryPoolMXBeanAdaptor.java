@@ -23,6 +23,7 @@
 package com.sun.max.vm.management;
 
 import java.lang.management.*;
+import java.util.concurrent.atomic.*;
 
 import javax.management.*;
 
@@ -33,12 +34,16 @@ import com.sun.max.memory.*;
  * Each instance has an associated MemoryRegion and an associated manager (MemoryManagerMXBean).
  * The management API supports multiple managers for a given memory pool but we don't exploit that currently.
  *
+ * The peak and collection usage are sampled from the allocation mark of the region without allocating or locking:
+ * when the usage is queried and, for heap pools, by {@link MemoryManagement} before and after each collection.
  */
 
 public class MemoryPoolMXBeanAdaptor implements MemoryPoolMXBean {
     protected MemoryManagerMXBean manager;
     protected MemoryRegion region;
     private MemoryType type;
+    private final AtomicLong peakUsed = new AtomicLong();
+    private volatile long collectionUsed = -1;
 
     private MemoryPoolMXBeanAdaptor() {
     }
@@ -46,10 +51,41 @@ public class MemoryPoolMXBeanAdaptor implements MemoryPoolMXBean {
     public MemoryPoolMXBeanAdaptor(MemoryType type, MemoryRegion region, MemoryManagerMXBean manager) {
         this.type = type;
         this.region = region;
+        this.manager = manager;
+    }
+
+    /**
+     * Gets the number of bytes used in the region of this pool, or -1 if the region does not record it.
+     */
+    protected long used() {
+        if (region instanceof LinearAllocationMemoryRegion) {
+            return ((LinearAllocationMemoryRegion) region).used().toLong();
+        }
+        return -1;
+    }
+
+    private void recordPeak(long used) {
+        long peak = peakUsed.get();
+        while (used > peak && !peakUsed.compareAndSet(peak, used)) {
+            peak = peakUsed.get();
+        }
+    }
+
+    void beforeCollection() {
+        recordPeak(used());
+    }
+
+    void afterCollection() {
+        collectionUsed = used();
     }
 
     public MemoryUsage getCollectionUsage() {
-        return null;
+        final long used = collectionUsed;
+        final MemoryUsage usage = used < 0 ? null : region.getUsage();
+        if (usage == null) {
+            return null;
+        }
+        return new MemoryUsage(usage.getInit(), used, usage.getCommitted(), usage.getMax());
     }
 
     public long getCollectionUsageThreshold() {
@@ -69,7 +105,11 @@ public class MemoryPoolMXBeanAdaptor implements MemoryPoolMXBean {
     }
 
     public MemoryUsage getPeakUsage() {
-        return null;
+        final MemoryUsage usage = getUsage();
+        if (usage == null) {
+            return null;
+        }
+        return new MemoryUsage(usage.getInit(), peakUsed.get(), usage.getCommitted(), usage.getMax());
     }
 
     public MemoryType getType() {
@@ -77,7 +117,11 @@ public class MemoryPoolMXBeanAdaptor implements MemoryPoolMXBean {
     }
 
     public MemoryUsage getUsage() {
-        return region.getUsage();
+        final MemoryUsage usage = region.getUsage();
+        if (usage != null) {
+            recordPeak(usage.getUsed());
+        }
+        return usage;
     }
 
     public long getUsageThreshold() {
@@ -109,6 +153,7 @@ public class MemoryPoolMXBeanAdaptor implements MemoryPoolMXBean {
     }
 
     public void resetPeakUsage() {
+        peakUsed.set(Math.max(used(), 0));
     }
 
     public void setCollectionUsageThreshold(long threhsold) {
@@ -27,7 +27,10 @@ import java.lang.reflect.*;
 import java.util.*;
 
 import com.sun.max.unsafe.*;
+import com.sun.max.vm.*;
+import com.sun.max.vm.actor.member.*;
 import com.sun.max.vm.jdk.*;
+import com.sun.max.vm.jdk.JDK_java_lang_Throwable.Backtrace;
 import com.sun.max.vm.runtime.*;
 import com.sun.max.vm.stack.*;
 import com.sun.max.vm.thread.*;
@@ -67,9 +70,129 @@ public class ThreadManagement {
         return VmThreadMap.getLiveTheadCount();
     }
 
+    private static volatile boolean threadCpuTimeEnabled = true;
+
     public static boolean setThreadCpuTimeEnabled(boolean enable) {
-        // TODO
-        return false;
+        final boolean result = threadCpuTimeEnabled;
+        threadCpuTimeEnabled = enable;
+        return result;
+    }
+
+    public static boolean isThreadCpuTimeEnabled() {
+        return threadCpuTimeEnabled;
+    }
+
+    /**
+     * Gets the CPU time of a thread.
+     *
+     * @param id a {@link Thread#getId() thread id} or 0 for the current thread
+     * @param userAndSystem specifies if the time spent in the kernel on behalf of the thread is included
+     * @return the CPU time in nanoseconds, or -1 if the thread is not alive or its CPU time is not available
+     */
+    public static long getThreadCpuTime(long id, boolean userAndSystem) {
+        if (id == 0) {
+            return VmThread.current().cpuTime(userAndSystem);
+        }
+        final long[] times = new long[1];
+        getThreadCpuTimes(new long[] {id}, times, userAndSystem);
+        return times[0];
+    }
+
+    /**
+     * Gets the CPU times of a set of threads with a single pass over the live threads.
+     *
+     * @param ids {@link Thread#getId() thread ids}
+     * @param times the array in which the CPU time in nanoseconds of each thread is returned, or -1 for
+     *            a thread that is not alive or whose CPU time is not available
+     */
+    public static void getThreadCpuTimes(long[] ids, long[] times, boolean userAndSystem) {
+        Arrays.fill(times, 0, ids.length, -1L);
+        final HashMap<Long, Integer> indexes = new HashMap<Long, Integer>(ids.length * 2);
+        for (int i = 0; i < ids.length; i++) {
+            indexes.put(ids[i], i);
+        }
+        final CpuTimeProcedure proc = new CpuTimeProcedure(indexes, times, userAndSystem);
+        synchronized (VmThreadMap.THREAD_LOCK) {
+            // holding the lock prevents the native threads from being destroyed while they are measured
+            VmThreadMap.ACTIVE.forAllThreadLocals(null, proc);
+        }
+    }
+
+    static class CpuTimeProcedure implements Pointer.Procedure {
+        private final HashMap<Long, Integer> indexes;
+        private final long[] times;
+        private final boolean userAndSystem;
+        CpuTimeProcedure(HashMap<Long, Integer> indexes, long[] times, boolean userAndSystem) {
+            this.indexes = indexes;
+            this.times = times;
+            this.userAndSystem = userAndSystem;
+        }
+        public void run(Pointer tla) {
+            final VmThread vmThread = VmThread.fromTLA(tla);
+            final Thread javaThread = vmThread.javaThread();
+            if (javaThread == null) {
+                // the thread is attaching or detaching
+                return;
+            }
+            final Integer index = indexes.get(javaThread.getId());
+            if (index != null) {
+                times[index] = vmThread.cpuTime(userAndSystem);
+            }
+        }
+    }
+
+    /**
+     * Determines if a thread is one of the VM's internal threads (e.g. the VM operation thread), which are all
+     * in the {@linkplain VmThread#systemThreadGroup system thread group}. A thread that is attaching or detaching,
+     * and so has no {@link Thread}, is not one of them.
+     */
+    private static boolean isInternalThread(VmThread vmThread) {
+        final Thread javaThread = vmThread.javaThread();
+        return javaThread != null && javaThread.getThreadGroup() == VmThread.systemThreadGroup;
+    }
+
+    /**
+     * Gets the number of live VM internal threads.
+     */
+    public static int getInternalThreadCount() {
+        final InternalThreadTimesProcedure proc = new InternalThreadTimesProcedure(null, null);
+        synchronized (VmThreadMap.THREAD_LOCK) {
+            VmThreadMap.ACTIVE.forAllThreadLocals(null, proc);
+        }
+        return proc.count;
+    }
+
+    /**
+     * Gets the names and total CPU times of the live VM internal threads (support for {@code jmm_GetInternalThreadTimes}).
+     *
+     * @return the number of threads reported, which is at most the length of the shorter array
+     */
+    public static int getInternalThreadTimes(String[] names, long[] times) {
+        final InternalThreadTimesProcedure proc = new InternalThreadTimesProcedure(names, times);
+        synchronized (VmThreadMap.THREAD_LOCK) {
+            VmThreadMap.ACTIVE.forAllThreadLocals(null, proc);
+        }
+        return Math.min(proc.count, Math.min(names.length, times.length));
+    }
+
+    static class InternalThreadTimesProcedure implements Pointer.Procedure {
+        private final String[] names;
+        private final long[] times;
+        int count;
+        InternalThreadTimesProcedure(String[] names, long[] times) {
+            this.names = names;
+            this.times = times;
+        }
+        public void run(Pointer tla) {
+            final VmThread vmThread = VmThread.fromTLA(tla);
+            if (isInternalThread(vmThread)) {
+                if (names != null && count < names.length && count < times.length) {
+                    names[count] = vmThread.getName();
+                    times[count] = vmThread.cpuTime(true);
+                }
+                count++;
+            }
+        }
     }
 
     public static boolean setThreadContentionMonitoringEnabled(boolean enable) {
@@ -166,60 +289,132 @@ public class ThreadManagement {
     }
 
     private static StackTraceElement[][] getStackTrace(Thread[] threads, int maxDepth) {
+        final Backtrace[] backtraces = getBacktraces(threads, maxDepth);
         final StackTraceElement[][] traces = new StackTraceElement[threads.length][];
-        int currentThreadIndex = -1;
         for (int i = 0; i < threads.length; i++) {
-            if (threads[i] == Thread.currentThread()) {
-                // special case of current thread
-                currentThreadIndex = i;
-                // null it out so StackTraceGatherer will not try to stop it
-                threads[i] = null;
-                StackTraceElement[] trace = new Exception().getStackTrace();
+            if (backtraces[i] != null) {
+                StackTraceElement[] trace = backtraces[i].getTrace();
                 if (maxDepth < trace.length) {
                     trace = Arrays.copyOf(trace, maxDepth);
                 }
                 traces[i] = trace;
             }
         }
-        VmOperationThread.submit(new StackTraceGatherer(Arrays.asList(threads), traces, maxDepth));
-        if (currentThreadIndex >= 0) {
-            threads[currentThreadIndex] = Thread.currentThread();
-        }
         return traces;
     }
 
     /**
-     * A thread-freezing operation to get a stack trace for a given set of threads.
+     * Captures the stacks of a given set of threads. The threads are stopped only while the
+     * raw frames of their stacks are recorded; the frames are converted to stack trace
+     * elements afterwards by the caller.
      *
+     * @return the backtraces of the threads, with {@code null} for a thread that was not alive
+     */
+    private static Backtrace[] getBacktraces(Thread[] threads, int maxDepth) {
+        final Backtrace[] backtraces = new Backtrace[threads.length];
+        final IdentityHashMap<Thread, Integer> indexes = new IdentityHashMap<Thread, Integer>(threads.length);
+        for (int i = 0; i < threads.length; i++) {
+            final Thread thread = threads[i];
+            if (thread == Thread.currentThread()) {
+                // special case of current thread, which is not stopped by StackTraceGatherer
+                backtraces[i] = JDK_java_lang_Throwable.getBacktrace(new Exception());
+            } else if (thread != null) {
+                backtraces[i] = new Backtrace(null, maxDepth);
+                indexes.put(thread, i);
+            }
+        }
+        final StackTraceGatherer gatherer = new StackTraceGatherer(indexes, backtraces);
+        VmOperationThread.submit(gatherer);
+        for (Map.Entry<Thread, Integer> entry : indexes.entrySet()) {
+            final int index = entry.getValue();
+            if (!gatherer.stopped[index]) {
+                backtraces[index] = null;
+            }
+        }
+        return backtraces;
+    }
+
+    /**
+     * A thread-freezing operation to record the stacks of a given set of threads
+     * in backtraces allocated before the threads are frozen.
      */
     static final class StackTraceGatherer extends VmOperation {
-        final int maxDepth;
-        final StackTraceElement[][] traces;
-        final List<Thread> threads;
-        StackTraceGatherer(List<Thread> threads, StackTraceElement[][] result, int maxDepth) {
+        final IdentityHashMap<Thread, Integer> indexes;
+        final Backtrace[] backtraces;
+        final boolean[] stopped;
+        StackTraceGatherer(IdentityHashMap<Thread, Integer> indexes, Backtrace[] backtraces) {
             super("StackTraceGatherer", null, Mode.Safepoint);
-            this.threads = threads;
-            this.maxDepth = maxDepth;
-            this.traces = result;
+            this.indexes = indexes;
+            this.backtraces = backtraces;
+            this.stopped = new boolean[backtraces.length];
         }
 
         @Override
         protected boolean operateOnThread(VmThread thread) {
-            return threads.contains(thread.javaThread());
+            return indexes.containsKey(thread.javaThread());
         }
 
         @Override
         public void doThread(VmThread vmThread, Pointer ip, Pointer sp, Pointer fp) {
-            Thread thread = vmThread.javaThread();
-            if (ip.isZero()) {
-                traces[threads.indexOf(thread)] = new StackTraceElement[0];
-            } else {
-                VmStackFrameWalker sfw = new VmStackFrameWalker(vmThread.tla());
-                traces[threads.indexOf(thread)] = JDK_java_lang_Throwable.getStackTrace(sfw, ip, sp, fp, null, maxDepth);
+            final int index = indexes.get(vmThread.javaThread());
+            stopped[index] = true;
+            if (ip.isNotZero()) {
+                backtraces[index].walk(new VmStackFrameWalker(vmThread.tla()), ip, sp, fp);
             }
         }
     }
 
+    /**
+     * Prints the stacks of all threads to the {@linkplain Log log} (support for {@code JVM_DumpAllStacks}).
+     * The stacks are captured together and each thread is printed as soon as it has been formatted.
+     */
+    public static void dumpAllStacks() {
+        final Thread[] threads = VmThreadMap.getThreads(false);
+        final Backtrace[] backtraces = getBacktraces(threads, Integer.MAX_VALUE);
+        for (int i = 0; i < threads.length; i++) {
+            final Backtrace backtrace = backtraces[i];
+            if (backtrace == null) {
+                continue;
+            }
+            final Thread thread = threads[i];
+            boolean lockDisabledSafepoints = Log.lock();
+            Log.print('"');
+            Log.print(thread.getName());
+            Log.print('"');
+            if (thread.isDaemon()) {
+                Log.print(" daemon");
+            }
+            Log.print(" prio=");
+            Log.print(thread.getPriority());
+            Log.print(" id=");
+            Log.print(thread.getId());
+            Log.print(' ');
+            Log.println(thread.getState().name());
+            for (int j = 0; j < backtrace.count; j++) {
+                final ClassMethodActor method = backtrace.methods[j];
+                final int line = backtrace.lineNos[j];
+                Log.print("\tat ");
+                Log.print(method.holder().name.toString());
+                Log.print('.');
+                Log.print(method.name.toString());
+                Log.print('(');
+                if (line == -2) {
+                    Log.print("Native Method");
+                } else if (method.holder().sourceFileName == null) {
+                    Log.print("Unknown Source");
+                } else {
+                    Log.print(method.holder().sourceFileName);
+                    if (line >= 0) {
+                        Log.print(':');
+                        Log.print(line);
+                    }
+                }
+                Log.println(')');
+            }
+            Log.println();
+            Log.unlock(lockDisabledSafepoints);
+        }
+    }
 
     public static Thread[] findMonitorDeadlockedThreads() {
         return null;
@@ -0,0 +1,271 @@
+/*
+ * Copyright (c) 2011, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ */
+package com.sun.max.vm.profilers.sampling;
+
+import java.util.*;
+
+import com.sun.max.annotate.*;
+import com.sun.max.memory.*;
+import com.sun.max.unsafe.*;
+import com.sun.max.vm.*;
+import com.sun.max.vm.code.*;
+import com.sun.max.vm.compiler.target.*;
+import com.sun.max.vm.thread.*;
+
+/**
+ * Asynchronous CPU sampling profiler. Unlike {@link CPUSamplingProfiler}, the threads are not stopped
+ * to take a sample. Instead, each thread has a timer measuring its CPU time that interrupts it with
+ * SIGPROF at the end of every sampling period. The signal handler (see sampler.c and trap.c) records the
+ * interrupted instruction, stack and frame pointers in a lock-free buffer owned by the thread. This thread
+ * periodically drains the buffers and resolves the instruction pointers against the code regions.
+ *
+ * The profile is flat: time is attributed to the method containing the sampled instruction. Samples
+ * outside of any code region (i.e. in native code) are counted together. The sampling period is
+ * measured in microseconds of thread CPU time.
+ */
+public final class AsyncSamplingProfiler extends Thread {
+
+    private static final String ASYNC_SAMPLING_PROFILER_NAME = "Async Sampling Profiler";
+
+    /**
+     * The default sampling period in microseconds. This keeps the overhead well below 1%.
+     */
+    private static final int DEFAULT_PERIOD = 10000;
+
+    /**
+     * The default capacity of each thread's sample buffer.
+     */
+    private static final int DEFAULT_BUFFER = 1024;
+
+    /**
+     * The period in milliseconds between draining the sample buffers.
+     */
+    private static final int FLUSH_PERIOD = 100;
+
+    /**
+     * The number of samples drained by one call to {@link #sampler_drain}.
+     */
+    private static final int DRAIN_BATCH = 4096;
+
+    /**
+     * The number of words recorded for a sample (instruction, stack and frame pointer).
+     */
+    private static final int WORDS_PER_SAMPLE = 3;
+
+    private final String optionPrefix;
+
+    private int samplePeriod = DEFAULT_PERIOD;
+
+    private int bufferSize = DEFAULT_BUFFER;
+
+    /**
+     * Period in milliseconds between dumping the profile to the log. Zero implies only dump on VM termination.
+     */
+    private long dumpInterval;
+
+    /**
+     * The native array into which samples are drained.
+     */
+    private Pointer drainBuffer;
+
+    /**
+     * Sample counts per method.
+     */
+    private final Map<TargetMethod, long[]> methodCounts = new HashMap<TargetMethod, long[]>();
+
+    /**
+     * Samples that could not be attributed to a method.
+     */
+    private long nativeCount;
+
+    private long sampleCount;
+
+    private volatile boolean isProfiling;
+
+    public AsyncSamplingProfiler(String optionPrefix, String optionValue) {
+        super(VmThread.systemThreadGroup, "AsyncSamplingProfiler");
+        setDaemon(true);
+        this.optionPrefix = optionPrefix;
+        parseOptions(optionValue);
+        drainBuffer = Memory.mustAllocate(Size.fromInt(DRAIN_BATCH * WORDS_PER_SAMPLE * Word.size()));
+        if (!sampler_start(samplePeriod * 1000L, bufferSize)) {
+            Log.println(ASYNC_SAMPLING_PROFILER_NAME + " is not supported on this platform");
+            return;
+        }
+        isProfiling = true;
+        start();
+    }
+
+    /**
+     * Parses the options given by {@code optionValue}.
+     * @param optionValue a string of the form {@code :period=p,buffer=b,dump=t} where any element may be omitted.
+     */
+    private void parseOptions(String optionValue) {
+        if (optionValue.length() == 0) {
+            return;
+        }
+        if (optionValue.charAt(0) != ':') {
+            usage();
+        }
+        for (String option : optionValue.substring(1).split(",")) {
+            if (option.startsWith("period")) {
+                samplePeriod = getOption(option);
+            } else if (option.startsWith("buffer")) {
+                bufferSize = getOption(option);
+            } else if (option.startsWith("dump")) {
+                dumpInterval = getOption(option) * 1000L;
+            } else {
+                usage();
+            }
+        }
+        if (samplePeriod <= 0 || bufferSize <= 0) {
+            usage();
+        }
+    }
+
+    private void usage() {
+        System.err.println("usage: " + optionPrefix + ":period=p,buffer=b,dump=t");
+        MaxineVM.native_exit(1);
+    }
+
+    private int getOption(String s) {
+        final int index = s.indexOf('=');
+        if (index < 0) {
+            usage();
+        }
+        return Integer.parseInt(s.substring(index + 1));
+    }
+
+    @Override
+    public void run() {
+        long lastDump = System.nanoTime();
+        while (true) {
+            try {
+                Thread.sleep(FLUSH_PERIOD);
+            } catch (InterruptedException ex) {
+            }
+            flush();
+            final long now = System.nanoTime();
+            if (dumpInterval > 0 && now > lastDump + dumpInterval * 1000000L) {
+                dumpProfile();
+                lastDump = now;
+            }
+        }
+    }
+
+    /**
+     * Drains the per-thread sample buffers and attributes the samples to methods.
+     */
+    private synchronized void flush() {
+        int n;
+        do {
+            n = sampler_drain(drainBuffer, DRAIN_BATCH);
+            for (int i = 0; i < n; i++) {
+                final Pointer ip = drainBuffer.getWord(i * WORDS_PER_SAMPLE).asPointer();
+                final TargetMethod targetMethod = Code.codePointerToTargetMethod(ip);
+                if (targetMethod == null) {
+                    nativeCount++;
+                } else {
+                    long[] count = methodCounts.get(targetMethod);
+                    if (count == null) {
+                        count = new long[1];
+                        methodCounts.put(targetMethod, count);
+                    }
+                    count[0]++;
+                }
+            }
+            sampleCount += n;
+        } while (n == DRAIN_BATCH);
+    }
+
+    public void terminate() {
+        if (isProfiling) {
+            isProfiling = false;
+            sampler_stop();
+            flush();
+            dumpProfile();
+        }
+    }
+
+    /**
+     * Prints the methods in decreasing order of their sample counts.
+     */
+    private synchronized void dumpProfile() {
+        final List<Map.Entry<TargetMethod, long[]>> entries = new ArrayList<Map.Entry<TargetMethod, long[]>>(methodCounts.entrySet());
+        Collections.sort(entries, new Comparator<Map.Entry<TargetMethod, long[]>>() {
+            public int compare(Map.Entry<TargetMethod, long[]> a, Map.Entry<TargetMethod, long[]> b) {
+                final long ca = a.getValue()[0];
+                final long cb = b.getValue()[0];
+                return ca < cb ? 1 : (ca > cb ? -1 : 0);
+            }
+        });
+        boolean state = Log.lock();
+        Log.print(ASYNC_SAMPLING_PROFILER_NAME + ", #samples: ");
+        Log.print(sampleCount);
+        Log.print(", #dropped: ");
+        Log.print(sampler_droppedSamples());
+        Log.print(", period: ");
+        Log.print(samplePeriod);
+        Log.println("us");
+        Log.println();
+        for (Map.Entry<TargetMethod, long[]> entry : entries) {
+            printCount(entry.getValue()[0]);
+            Log.print("   ");
+            Log.println(entry.getKey().toString());
+        }
+        if (nativeCount != 0) {
+            printCount(nativeCount);
+            Log.println("   <native>");
+        }
+        Log.println();
+        Log.unlock(state);
+    }
+
+    private void printCount(long count) {
+        // percentage to one decimal place
+        final long p10 = sampleCount == 0 ? 0 : (count * 1000) / sampleCount;
+        if (p10 < 1000) {
+            Log.print(' ');
+        }
+        if (p10 < 100) {
+            Log.print(' ');
+        }
+        Log.print(p10 / 10);
+        Log.print('.');
+        Log.print(p10 % 10);
+        Log.print("%   ");
+        Log.print(count);
+    }
+
+    @C_FUNCTION
+    private static native boolean sampler_start(long intervalNanos, int samplesPerThread);
+
+    @C_FUNCTION
+    private static native void sampler_stop();
+
+    @C_FUNCTION
+    private static native int sampler_drain(Pointer samples, int length);
+
+    @C_FUNCTION
+    private static native long sampler_droppedSamples();
+}
@@ -24,6 +24,7 @@ import static com.sun.max.vm.MaxineVM.*;
 import static com.sun.max.vm.thread.VmThreadLocal.*;
 
 import com.sun.max.annotate.*;
+import com.sun.max.memory.*;
 import com.sun.max.program.*;
 import com.sun.max.unsafe.*;
 import com.sun.max.util.*;
@@ -103,6 +104,13 @@ public class NUMAProfiler {
     private static boolean NUMAProfilerDebug;
     @SuppressWarnings("unused")
     private static boolean NUMAProfilerIncludeFinalization;
+    @SuppressWarnings("unused")
+    private static boolean NUMAProfilerCountersOnly;
+
+    /**
+     * The native buffer into which the per-thread allocation counters are merged when {@link #NUMAProfilerCountersOnly} is set.
+     */
+    private static Pointer allocationCounters = Pointer.zero();
 
     private static int totalNewSize  = 0;
     private static int totalSurvSize = 0;
@@ -192,6 +200,7 @@ public class NUMAProfiler {
         VMOptions.addFieldOption("-XX:", "NUMAProfilerFlareProfileWindow", NUMAProfiler.class, "The number of the Flare objects to be allocated before the NUMAProfiler stops recording. (default: 1)");
         VMOptions.addFieldOption("-XX:", "NUMAProfilerDebug", NUMAProfiler.class, "Print information to help in NUMAProfiler's Validation. (default: false)", MaxineVM.Phase.PRISTINE);
         VMOptions.addFieldOption("-XX:", "NUMAProfilerIncludeFinalization", NUMAProfiler.class, "Include memory accesses performed due to Finalization. (default: false)", MaxineVM.Phase.PRISTINE);
+        VMOptions.addFieldOption("-XX:", "NUMAProfilerCountersOnly", NUMAProfiler.class, "Only count the local and remote allocations per NUMA node, without recording the objects or taking a lock. (default: false)", MaxineVM.Phase.PRISTINE);
 
         objectAccessCounterNames = new String[]{
             "REMOTE_TUPLE_WRITES", "LOCAL_TUPLE_WRITES",
@@ -243,6 +252,11 @@ public class NUMAProfiler {
 
         numaConfig = new NUMALib();
 
+        if (NUMAProfilerCountersOnly) {
+            allocationCounters = Memory.mustAllocate(Size.fromInt((numaConfig.getNumberOfNodes() + 1) * NUMALib.ALLOCATION_COUNTERS_PER_NODE * Long.BYTES));
+            NUMALib.numaCounters_reset();
+        }
+
         profilingCycle = 1;
         if (NUMAProfilerVerbose) {
             Log.println("(NUMA Profiler): Initialization Complete.");
@@ -356,6 +370,11 @@ public class NUMAProfiler {
     @NO_SAFEPOINT_POLLS("numa profiler call chain must be atomic")
     @NEVER_INLINE
     public static void profileNew(int size, String type, long address) {
+        if (NUMAProfilerCountersOnly) {
+            // the counters are sharded per thread so that the profiled threads are not serialized
+            NUMALib.numaCounters_countAllocation(address, size);
+            return;
+        }
         /* PROFILER_TLA is currently a thread local that has it's value maintained
          * only in the {@linkplain VmThreadLocal#ETLA safepoints-enabled} TLA. That
          * said if we lock and disable safepoints it is no longer accessible, thus
@@ -570,25 +589,29 @@ public class NUMAProfiler {
     private void findNumaNodeForPages() {
         assert vm().config.heapScheme() instanceof SemiSpaceHeapScheme;
         Address currentAddress = vm().config.heapScheme().getHeapStartAddress();
-        int     index          = 0;
+        int     pageSize       = NUMALib.numaPageSize();
+        int     count          = 0;
         while (vm().config.heapScheme().contains(currentAddress)) {
-            int node = NUMALib.numaNodeOfAddress(currentAddress.toLong());
             if (VirtualPagesBuffer.debug) {
                 Log.print("write starting address ");
                 Log.print(currentAddress.toLong());
                 Log.print(" of range ");
-                Log.println(index);
+                Log.println(count);
             }
-            heapPages.writeAddr(index, currentAddress.toLong());
-            heapPages.writeNumaNode(index, node);
-            index++;
-            currentAddress = currentAddress.plus(NUMALib.numaPageSize());
+            heapPages.writeAddr(count, currentAddress.toLong());
+            count++;
+            currentAddress = currentAddress.plus(pageSize);
+        }
+        // one system call for all the pages instead of one per page
+        heapPages.findNumaNodes(count);
+        for (int index = 0; index < count; index++) {
+            int node = heapPages.readNumaNode(index);
             //update stats
             if (node < 0) {
                 node = VirtualPagesBuffer.maxNumaNodes;
             }
-            int count = heapPages.readStats(node);
-            heapPages.writeStats(node, count + 1);
+            int nodeCount = heapPages.readStats(node);
+            heapPages.writeStats(node, nodeCount + 1);
         }
 
     }
@@ -605,27 +628,27 @@ public class NUMAProfiler {
             Log.print(" to ");
             Log.println(to.buffersName);
         }
+        final int firstSurvivor = to.currentIndex;
         for (int i = 0; i < from.currentIndex; i++) {
             long address = from.readAddr(i);
             /*
-            if an object is alive, update both its Virtual Address and
-            NUMA Node before copy it to the survivors buffer
+            if an object is alive, update its Virtual Address before copy it to the survivors buffer
              */
             if (Heap.isSurvivor(address)) {
                 // update Virtual Address
                 long newAddr = Heap.getForwardedAddress(address);
-                // update NUMA Node
-                int node = NUMALib.numaNodeOfAddress(newAddr);
                 //guard survivors RecordBuffer from overflow
                 if (to.currentIndex >= to.bufferSize) {
                     Log.print("Survivor Buffer out of bounds! Increase the Buffer Size.");
                     MaxineVM.exit(1);
                 }
                 // write it to Buffer
-                to.record(from.readId(i), from.readThreadId(i), from.readType(i), from.readSize(i), newAddr, node);
+                to.record(from.readId(i), from.readThreadId(i), from.readType(i), from.readSize(i), newAddr);
                 totalSurvSize = totalSurvSize + from.readSize(i);
             }
         }
+        // update the NUMA Nodes of all the copied survivors with one system call
+        to.findNumaNodes(firstSurvivor);
     }
 
     /**
@@ -697,6 +720,7 @@ public class NUMAProfiler {
         }
 
         printProfilingCounters();
+        printAllocationCounters();
 
         if (NUMAProfilerVerbose) {
             Log.println("(NUMA Profiler): Leaving Pre-GC Phase.");
@@ -844,6 +868,34 @@ public class NUMAProfiler {
         VmThreadMap.ACTIVE.forAllThreadLocals(profilingPredicate, printThreadLocalProfilingCounters);
     }
 
+    /**
+     * Merges and prints the per-thread allocation counters of the current cycle and starts counting the next one.
+     * Allocation Counters Output format.
+     * Cycle; NumaNode; LocalObjects; LocalBytes; RemoteObjects; RemoteBytes
+     * The NumaNode is -1 for the objects whose node is not known.
+     */
+    private static void printAllocationCounters() {
+        if (!NUMAProfilerCountersOnly) {
+            return;
+        }
+        final int nodes = numaConfig.getNumberOfNodes();
+        NUMALib.numaCounters_merge(allocationCounters, nodes);
+        NUMALib.numaCounters_reset();
+        final boolean lockDisabledSafepoints = Log.lock();
+        for (int node = 0; node <= nodes; node++) {
+            final int index = node * NUMALib.ALLOCATION_COUNTERS_PER_NODE;
+            Log.print(profilingCycle);
+            Log.print(';');
+            Log.print(node == nodes ? -1 : node);
+            for (int i = 0; i < NUMALib.ALLOCATION_COUNTERS_PER_NODE; i++) {
+                Log.print(';');
+                Log.print(allocationCounters.getLong(index + i));
+            }
+            Log.println();
+        }
+        Log.unlock(lockDisabledSafepoints);
+    }
+
     /**
      * A {@link Pointer.Procedure} that initializes a thread's all Object Access Profiling Counters}.
      */
@@ -905,6 +957,7 @@ public class NUMAProfiler {
         }
 
         printProfilingCounters();
+        printAllocationCounters();
 
         if (NUMAProfilerVerbose) {
             Log.println("(NUMA Profiler): Release Reserved Memory.");
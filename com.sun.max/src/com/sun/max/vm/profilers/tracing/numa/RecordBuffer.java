@@ -26,6 +26,7 @@ import com.sun.max.memory.VirtualMemory;
 import com.sun.max.platform.Platform;
 import com.sun.max.unsafe.Pointer;
 import com.sun.max.unsafe.Size;
+import com.sun.max.util.NUMALib;
 import com.sun.max.vm.Intrinsics;
 import com.sun.max.vm.Log;
 import com.sun.max.vm.intrinsics.*;
@@ -188,6 +189,17 @@ class RecordBuffer {
         return readLong(addresses, index);
     }
 
+    /**
+     * Finds the NUMA nodes of the objects recorded at indexes {@code start} to {@code currentIndex - 1}
+     * with a single batched lookup.
+     */
+    void findNumaNodes(int start) {
+        final int count = currentIndex - start;
+        if (count > 0) {
+            NUMALib.numaNodesOfAddresses(addresses.plus(start * Long.BYTES), nodes.plus(start * Integer.BYTES), count);
+        }
+    }
+
     void writeNode(int index, int value) {
         writeInt(nodes, index, value);
     }
@@ -23,6 +23,7 @@ package com.sun.max.vm.profilers.tracing.numa;
 import com.sun.max.memory.VirtualMemory;
 import com.sun.max.unsafe.Pointer;
 import com.sun.max.unsafe.Size;
+import com.sun.max.util.NUMALib;
 import com.sun.max.vm.Log;
 
 public class VirtualPagesBuffer {
@@ -114,6 +115,15 @@ public class VirtualPagesBuffer {
         writeInt(heapBoundariesStats, index, value);
     }
 
+    /**
+     * Finds the NUMA nodes of the first {@code count} pages, whose start addresses have already been written,
+     * with a single batched lookup.
+     */
+    void findNumaNodes(int count) {
+        NUMALib.numaNodesOfAddresses(startAddresses, numaNodes, count);
+        pagesCurrentIndex += count;
+    }
+
     void writeNumaNode(int index, int value) {
         writeInt(numaNodes, index, value);
         pagesCurrentIndex++;
@@ -30,6 +30,7 @@ import com.sun.max.vm.MaxineVM.Phase;
 import com.sun.max.vm.actor.holder.ClassActor;
 import com.sun.max.vm.actor.member.MethodActor;
 import com.sun.max.vm.actor.member.StaticMethodActor;
+import com.sun.max.vm.code.PerfMap;
 import com.sun.max.vm.compiler.*;
 import com.sun.max.vm.compiler.deopt.Deoptimization;
 import com.sun.max.vm.heap.Heap;
@@ -44,6 +45,7 @@ import com.sun.max.vm.profilers.sampling.*;
 import com.sun.max.vm.run.RunScheme;
 import com.sun.max.vm.runtime.CriticalMethod;
 import com.sun.max.vm.runtime.FatalError;
+import com.sun.max.vm.runtime.OSMonitor;
 import com.sun.max.vm.runtime.PrintThreads;
 import com.sun.max.vm.thread.VmThread;
 import com.sun.max.vm.ti.VMTI;
@@ -97,6 +99,8 @@ public class JavaRunScheme extends AbstractVMScheme implements RunScheme {
         "-Xprof", false, null, "run CPU sampling profiler"), MaxineVM.Phase.STARTING);
     private static final VMStringOption hprofOption = register(new VMStringOption(
         "-Xhprof", false, null, "run heap sampling profiler"), MaxineVM.Phase.STARTING);
+    private static final VMStringOption aprofOption = register(new VMStringOption(
+        "-Xaprof", false, null, "run asynchronous (signal based) CPU sampling profiler"), MaxineVM.Phase.STARTING);
     private static final VMStringOption showSettingsOption = register(new VMStringOption(
         "-XshowSettings", false, ":all",
         "show all settings and continue (optionally limit to vm, properties or locale settings appending :vm, :properties and :locale respectively)"),
@@ -109,6 +113,7 @@ public class JavaRunScheme extends AbstractVMScheme implements RunScheme {
     private static List<String> reinitClasses = new LinkedList<String>();
     private static CPUSamplingProfiler cpuSamplingProfiler;
     private static HeapSamplingProfiler heapSamplingProfiler;
+    private static AsyncSamplingProfiler asyncSamplingProfiler;
     private static String mainClassName;
 
     @HOSTED_ONLY
@@ -187,9 +192,13 @@ public class JavaRunScheme extends AbstractVMScheme implements RunScheme {
         if (heapSamplingProfiler != null) {
             heapSamplingProfiler.terminate();
         }
+        if (asyncSamplingProfiler != null) {
+            asyncSamplingProfiler.terminate();
+        }
         if (MaxineVM.numaProfiler != null) {
             MaxineVM.numaProfiler.terminate();
         }
+        OSMonitor.nativeMutexPrintProfile();
     }
 
     public static void restartProfilers() {
@@ -256,6 +265,10 @@ public class JavaRunScheme extends AbstractVMScheme implements RunScheme {
                     final String heapProfOptionPrefix = hprofOption.toString();
                     heapSamplingProfiler = new HeapSamplingProfiler(heapProfOptionPrefix, heapProfOptionValue);
                 }
+                final String asyncProfOptionValue = aprofOption.getValue();
+                if (asyncProfOptionValue != null) {
+                    asyncSamplingProfiler = new AsyncSamplingProfiler(aprofOption.toString(), asyncProfOptionValue);
+                }
                 // The same for the NUMA Profiler
                 if (CompilationBroker.NUMAProfilerEntryPoint != null || NUMAProfiler.profileAll()) {
                     // Initialize NUMA Profiler
@@ -282,12 +295,14 @@ public class JavaRunScheme extends AbstractVMScheme implements RunScheme {
     protected final void initializeBasicFeatures() {
         MaxineVM vm = vm();
         vm.phase = MaxineVM.Phase.STARTING;
+        StartupTimes.mark(MaxineVM.Phase.STARTING);
 
         // Now we can decode all the other VM arguments using the full language
         if (VMOptions.parseStarting()) {
             VMLog.checkLogOptions();
 
             vmConfig().initializeSchemes(MaxineVM.Phase.STARTING);
+            PerfMap.initialize();
             if (Heap.ExcessiveGCFrequency != 0) {
                 new ExcessiveGCDaemon(Heap.ExcessiveGCFrequency).start();
             }
@@ -341,6 +356,8 @@ public class JavaRunScheme extends AbstractVMScheme implements RunScheme {
             MaxineVM vm = vm();
             vmConfig().initializeSchemes(MaxineVM.Phase.RUNNING);
             vm.phase = Phase.RUNNING;
+            StartupTimes.mark(Phase.RUNNING);
+            StartupTimes.printIfRequested();
             mainClassName = getMainClassName();
             VMTI.handler().vmInitialized();
             VMTI.handler().threadStart(VmThread.current());
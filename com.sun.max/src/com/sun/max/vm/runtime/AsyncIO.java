@@ -0,0 +1,246 @@
+/*
+ * Copyright (c) 2011, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ */
+package com.sun.max.vm.runtime;
+
+import com.sun.max.annotate.*;
+import com.sun.max.memory.*;
+import com.sun.max.unsafe.*;
+
+/**
+ * Asynchronous I/O rings (see aio.h). An operation queued on a ring is tagged with a caller chosen
+ * {@code long} and its result is delivered as a completion that a {@link Poller} drains in batches.
+ * With io_uring ({@code -XX:+IoUring}, the default on Linux kernels that support it) the operations are
+ * performed by the kernel and a batch of them costs a single system call. Otherwise an operation is performed
+ * when it is queued, so the methods queuing operations may block.
+ * <p>
+ * The result of a completion is the non-negative result of the operation or a negated errno value.
+ * Queuing methods return 0 or a negated errno value if the operation could not be queued.
+ * The buffers of an operation must not move or be freed until it has completed.
+ */
+public final class AsyncIO {
+
+    /**
+     * Tags a file descriptor argument as an index into the files {@linkplain #registerFiles registered} with a ring.
+     */
+    public static final int FIXED_FILE_TAG = 0x40000000;
+
+    private AsyncIO() {
+    }
+
+    /**
+     * Gets the ring of the current thread, which is destroyed when the thread exits.
+     */
+    public static Pointer currentThreadRing() {
+        return aio_currentThreadRing();
+    }
+
+    /**
+     * Gets the ring shared by all threads.
+     */
+    public static Pointer sharedRing() {
+        return aio_sharedRing();
+    }
+
+    /**
+     * Determines if the operations queued on a given ring are performed asynchronously by the kernel.
+     */
+    public static boolean isAsynchronous(Pointer ring) {
+        return aio_isAsynchronous(ring);
+    }
+
+    public static int fixedFile(int index) {
+        return index | FIXED_FILE_TAG;
+    }
+
+    /**
+     * Queues a read. An offset of -1 reads at the file position.
+     */
+    public static int read(Pointer ring, int fd, Pointer buffer, int length, long offset, long userData) {
+        return nativeRead(ring, fd, buffer, length, offset, userData);
+    }
+
+    /**
+     * Queues a write. An offset of -1 writes at the file position.
+     */
+    public static int write(Pointer ring, int fd, Pointer buffer, int length, long offset, long userData) {
+        return nativeWrite(ring, fd, buffer, length, offset, userData);
+    }
+
+    /**
+     * Queues a read into the {@linkplain #registerBuffers registered} buffer at a given index.
+     */
+    public static int readFixed(Pointer ring, int fd, Pointer buffer, int length, long offset, int bufferIndex, long userData) {
+        return nativeReadFixed(ring, fd, buffer, length, offset, bufferIndex, userData);
+    }
+
+    /**
+     * Queues a write from the {@linkplain #registerBuffers registered} buffer at a given index.
+     */
+    public static int writeFixed(Pointer ring, int fd, Pointer buffer, int length, long offset, int bufferIndex, long userData) {
+        return nativeWriteFixed(ring, fd, buffer, length, offset, bufferIndex, userData);
+    }
+
+    public static int fsync(Pointer ring, int fd, long userData) {
+        return nativeFsync(ring, fd, userData);
+    }
+
+    /**
+     * Queues an accept. The result of the completion is the accepted socket.
+     *
+     * @param address the buffer receiving the address of the peer, or zero
+     * @param addressLength the address of an {@code int} holding the size of {@code address}, or zero
+     */
+    public static int accept(Pointer ring, int fd, Pointer address, Pointer addressLength, long userData) {
+        return nativeAccept(ring, fd, address, addressLength, userData);
+    }
+
+    public static int recv(Pointer ring, int fd, Pointer buffer, int length, int flags, long userData) {
+        return nativeRecv(ring, fd, buffer, length, flags, userData);
+    }
+
+    public static int send(Pointer ring, int fd, Pointer buffer, int length, int flags, long userData) {
+        return nativeSend(ring, fd, buffer, length, flags, userData);
+    }
+
+    /**
+     * Submits the operations queued on a ring to the kernel.
+     *
+     * @param minComplete the number of completions to wait for
+     * @return the number of operations submitted or a negated errno value
+     */
+    public static int submit(Pointer ring, int minComplete) {
+        return nativeSubmit(ring, minComplete);
+    }
+
+    /**
+     * Registers buffers with a ring, replacing any registered before.
+     *
+     * @param iov a native array of {@code count} {@code struct iovec}
+     */
+    public static int registerBuffers(Pointer ring, Pointer iov, int count) {
+        return nativeRegisterBuffers(ring, iov, count);
+    }
+
+    /**
+     * Registers file descriptors with a ring, replacing any registered before.
+     *
+     * @param fds a native array of {@code count} {@code int}s
+     */
+    public static int registerFiles(Pointer ring, Pointer fds, int count) {
+        return nativeRegisterFiles(ring, fds, count);
+    }
+
+    /**
+     * Drains the completions of a ring in batches into native arrays.
+     */
+    public static final class Poller {
+
+        private final Pointer ring;
+
+        private final int capacity;
+
+        private final Pointer userData;
+
+        private final Pointer results;
+
+        private int count;
+
+        /**
+         * @param capacity the maximum number of completions drained by a {@link #poll}
+         */
+        public Poller(Pointer ring, int capacity) {
+            this.ring = ring;
+            this.capacity = capacity;
+            this.userData = Memory.mustAllocate(Size.fromInt(capacity * 8));
+            this.results = Memory.mustAllocate(Size.fromInt(capacity * 4));
+        }
+
+        /**
+         * Submits the queued operations and drains the available completions.
+         *
+         * @param minComplete the number of completions to wait for
+         * @return the number of completions drained or a negated errno value
+         */
+        public int poll(int minComplete) {
+            int n = nativeDrain(ring, userData, results, capacity, Math.min(minComplete, capacity));
+            count = n < 0 ? 0 : n;
+            return n;
+        }
+
+        /**
+         * Gets the number of completions drained by the last {@link #poll}.
+         */
+        public int count() {
+            return count;
+        }
+
+        public long userData(int index) {
+            return userData.getLong(index);
+        }
+
+        public int result(int index) {
+            return results.getInt(index);
+        }
+
+        /**
+         * Frees the native arrays of this poller.
+         */
+        public void dispose() {
+            Memory.deallocate(userData);
+            Memory.deallocate(results);
+        }
+    }
+
+    @C_FUNCTION
+    private static native Pointer aio_currentThreadRing();
+
+    @C_FUNCTION
+    private static native Pointer aio_sharedRing();
+
+    @C_FUNCTION
+    private static native boolean aio_isAsynchronous(Pointer ring);
+
+    private static native int nativeRead(Pointer ring, int fd, Pointer buffer, int length, long offset, long userData);
+
+    private static native int nativeWrite(Pointer ring, int fd, Pointer buffer, int length, long offset, long userData);
+
+    private static native int nativeReadFixed(Pointer ring, int fd, Pointer buffer, int length, long offset, int bufferIndex, long userData);
+
+    private static native int nativeWriteFixed(Pointer ring, int fd, Pointer buffer, int length, long offset, int bufferIndex, long userData);
+
+    private static native int nativeFsync(Pointer ring, int fd, long userData);
+
+    private static native int nativeAccept(Pointer ring, int fd, Pointer address, Pointer addressLength, long userData);
+
+    private static native int nativeRecv(Pointer ring, int fd, Pointer buffer, int length, int flags, long userData);
+
+    private static native int nativeSend(Pointer ring, int fd, Pointer buffer, int length, int flags, long userData);
+
+    private static native int nativeSubmit(Pointer ring, int minComplete);
+
+    private static native int nativeDrain(Pointer ring, Pointer userData, Pointer results, int max, int minComplete);
+
+    private static native int nativeRegisterBuffers(Pointer ring, Pointer iov, int count);
+
+    private static native int nativeRegisterFiles(Pointer ring, Pointer fds, int count);
+}
@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2011, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ */
+package com.sun.max.vm.runtime;
+
+import com.sun.max.annotate.*;
+import com.sun.max.unsafe.*;
+
+/**
+ * Records events in the binary trace enabled with {@code -XX:BinaryTrace=<directory>} (see trace.h).
+ * An event is a fixed size record holding a timestamp, the event id, the id of the current thread and
+ * three payload words. Recording an event is cheap enough for per-allocation tracing and does nothing
+ * if tracing is disabled. The trace files are decoded offline by the {@code tracedump} tool.
+ */
+public final class BinaryTrace {
+
+    /**
+     * The lowest event id that can be used by the VM. Lower ids are used by the substrate.
+     */
+    public static final int FIRST_VM_EVENT = 256;
+
+    private BinaryTrace() {
+    }
+
+    /**
+     * Records an event for the current thread.
+     *
+     * @param event an event id not lower than {@link #FIRST_VM_EVENT}
+     */
+    @INLINE
+    public static void event(int event, Word a, Word b, Word c) {
+        trace_event(event, a, b, c);
+    }
+
+    @C_FUNCTION
+    private static native void trace_event(int event, Word a, Word b, Word c);
+}
@@ -42,6 +42,7 @@ public class OSMonitor {
         new CriticalNativeMethod(OSMonitor.class, "nativeConditionWait");
         new CriticalNativeMethod(OSMonitor.class, "nativeTakeLockAndNotify");
         new CriticalNativeMethod(OSMonitor.class, "nativeTakeLockAndWait");
+        new CriticalNativeMethod(OSMonitor.class, "nativeMutexPrintProfile");
     }
 
     static int mutexSize;
@@ -180,4 +181,11 @@ public class OSMonitor {
      */
     public static native boolean nativeTakeLockAndWait(Word mutex, Word condition, long millis);
 
+    /**
+     * Prints the native mutex contention profile to the log if the profiler was enabled
+     * with {@code -XX:NativeMutexProfile}.
+     */
+    @C_FUNCTION
+    public static native void nativeMutexPrintProfile();
+
 }
@@ -90,5 +90,6 @@ public class PrintThreads extends VmOperation implements SignalHandler {
 
     public void handle(Signal sig) {
         submit();
+        OSMonitor.nativeMutexPrintProfile();
     }
 }
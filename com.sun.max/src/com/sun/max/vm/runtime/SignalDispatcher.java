@@ -34,15 +34,15 @@ import com.sun.max.*;
 import com.sun.max.annotate.*;
 import com.sun.max.unsafe.*;
 import com.sun.max.vm.*;
-import com.sun.max.vm.compiler.*;
 
 /**
  * The thread used to post and dispatch signals to user supplied {@link SignalHandler}s.
  * <p>
  * The special C signal handler mentioned in {@link Signal} is 'userSignalHandler' in trap.c.
- * This C signal handler atomically adds a signal to a queue in this class by up-calling
- * {@link #tryPostSignal(int)} and then notifies the native semaphore
- * on which the signal dispatching thread is {@linkplain #waitForSignal() waiting}.
+ * This C signal handler adds a signal to a fixed size, lock-free queue in the native substrate
+ * (see signal.c) and then notifies the native semaphore on which the signal dispatching thread
+ * is {@linkplain #waitForSignal() waiting}. Repeated occurrences of a pending signal are
+ * coalesced into a count so that posting a signal always completes in bounded time.
  * <p>
  * The native layer of the VM also uses thread signal masks so that only one thread
  * (the {@linkplain VmOperationThread VM operation thread}) handles the
@@ -87,7 +87,11 @@ public final class SignalDispatcher extends Thread {
                     return signal;
                 }
             }
-            nativeSignalWait();
+            final long taken = nativeSignalTake();
+            if (taken != 0) {
+                // Each coalesced occurrence of the signal is dispatched
+                PendingSignals.addAndGet((int) taken, (int) (taken >>> 32));
+            }
         }
     }
 
@@ -109,44 +113,26 @@ public final class SignalDispatcher extends Thread {
      * Instead, a single OS-level semaphore (e.g. POSIX sem_init(3))
      * is used.
      */
-    private static native void nativeSignalInit(Address tryPostSignalAddress);
+    private static native void nativeSignalInit();
     private static native void nativeSignalFinalize();
     private static native void nativeSignalNotify();
-    private static native void nativeSignalWait();
-
-    @C_FUNCTION // called on the primordial thrad
-    private static native void nativeSetSignalTracing(boolean flag);
 
     /**
-     * The handle by which the address of {@link #tryPostSignal} can be communicated to the native substrate.
+     * Blocks until a signal is pending in the native queue or the dispatcher is {@linkplain #nativeSignalNotify() notified}.
+     *
+     * @return 0 if no signal was pending, otherwise the signal in the low 32 bits and the number of
+     *         its coalesced occurrences in the high 32 bits
      */
-    private static CriticalMethod tryPostSignal = new CriticalMethod(SignalDispatcher.class, "tryPostSignal", null, CallEntryPoint.C_ENTRY_POINT);
+    private static native long nativeSignalTake();
+
+    @C_FUNCTION // called on the primordial thrad
+    private static native void nativeSetSignalTracing(boolean flag);
 
     static {
         new CriticalNativeMethod(SignalDispatcher.class, "nativeSignalInit");
         new CriticalNativeMethod(SignalDispatcher.class, "nativeSignalFinalize");
         new CriticalNativeMethod(SignalDispatcher.class, "nativeSignalNotify");
-        new CriticalNativeMethod(SignalDispatcher.class, "nativeSignalWait");
-    }
-
-    /**
-     * Attempts to atomically increment an element of {@link #PendingSignals}.
-     * This is provided so that the native substrate does not have to encode
-     * architecture specific mechanisms for trying to perform an atomic
-     * update on a given value in memory.
-     *
-     * This code is called from within a native signal handler and so
-     * must not block, cause any exception or assume that the thread
-     * pointer/safepoint latch (i.e. R14 on x64) is set up correctly.
-     *
-     * @param signal the index of the element in {@link #PendingSignals} on which an atomic increment attempt is performed
-     * @return {@code true} if the update succeeded, {@code false} otherwise
-     */
-    @VM_ENTRY_POINT
-    @NO_SAFEPOINT_POLLS("executes inside a native signal handler")
-    private static boolean tryPostSignal(int signal) {
-        int n = PendingSignals.get(signal);
-        return PendingSignals.compareAndSet(signal, n, n + 1);
+        new CriticalNativeMethod(SignalDispatcher.class, "nativeSignalTake");
     }
 
     /**
@@ -191,7 +177,7 @@ public final class SignalDispatcher extends Thread {
             return;
         }
 
-        nativeSignalInit(tryPostSignal.address());
+        nativeSignalInit();
         state = 1;
 
         while (true) {
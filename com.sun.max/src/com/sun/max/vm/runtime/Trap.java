@@ -28,6 +28,8 @@ import static com.sun.max.vm.runtime.Trap.Number.*;
 import static com.sun.max.vm.thread.VmThread.*;
 import static com.sun.max.vm.thread.VmThreadLocal.*;
 
+import java.util.*;
+
 import com.oracle.max.asm.target.riscv64.RISCV64;
 import com.oracle.max.asm.target.riscv64.RISCV64MacroAssembler;
 import com.sun.max.annotate.*;
@@ -38,8 +40,10 @@ import com.sun.max.vm.*;
 import com.sun.max.vm.code.*;
 import com.sun.max.vm.compiler.*;
 import com.sun.max.vm.compiler.target.*;
+import com.sun.max.vm.heap.*;
 import com.sun.max.vm.reference.*;
 import com.sun.max.vm.thread.*;
+import com.sun.max.vm.ti.*;
 
 /**
  * This class handles synchronous operating systems signals used to implement the following VM features:
@@ -191,6 +195,82 @@ public abstract class Trap {
         nativeSetTrapTracing(TraceTraps);
     }
 
+    /**
+     * The kinds of traps counted by the native trap handler for each thread. These are counted without any
+     * logging or synchronization so they are always available. The ordinals must match the TRAP_COUNT_*
+     * constants in Native/share/threadLocals.h.
+     */
+    public enum Count {
+        /**
+         * Memory faults other than safepoints and stack overflows, i.e. implicit null checks.
+         */
+        NULL_CHECK,
+        SAFEPOINT,
+        STACK_FAULT,
+        STACK_FATAL,
+        DIVIDE_BY_ZERO,
+        /**
+         * {@code Integer.MIN_VALUE / -1} (or the long equivalent) on AMD64, handled entirely by the native trap handler.
+         */
+        DIVIDE_OVERFLOW,
+        BLUE_ZONE,
+        ASYNC_INTERRUPT;
+
+        public static final List<Count> VALUES = Arrays.asList(values());
+    }
+
+    /**
+     * The offset of the trap counts array in a NativeThreadLocalsStruct (see Native/share/threadLocals.h).
+     */
+    @FOLD
+    public static int nativeTrapCountsOffset() {
+        return 11 * Word.size();
+    }
+
+    /**
+     * Gets the address of the trap counts accumulated for all the threads that have terminated.
+     */
+    @C_FUNCTION
+    private static native Pointer nativeExitedThreadsTrapCounts();
+
+    /**
+     * Gets the number of traps of a given kind taken by a thread.
+     *
+     * @param tla the thread locals of the thread
+     */
+    public static long trapCount(Pointer tla, Count count) {
+        final Pointer ntl = NATIVE_THREAD_LOCALS.load(tla).asPointer();
+        if (ntl.isZero()) {
+            return 0;
+        }
+        return ntl.readWord(nativeTrapCountsOffset() + count.ordinal() * Word.size()).asAddress().toLong();
+    }
+
+    private static final class TrapCountsAccumulator implements Pointer.Procedure {
+        final long[] counts = new long[Count.VALUES.size()];
+
+        public void run(Pointer tla) {
+            for (Count count : Count.VALUES) {
+                counts[count.ordinal()] += trapCount(tla, count);
+            }
+        }
+    }
+
+    /**
+     * Gets the number of traps of each kind (indexed by {@link Count#ordinal()}) taken by all threads, live or terminated.
+     */
+    public static long[] trapCounts() {
+        final TrapCountsAccumulator accumulator = new TrapCountsAccumulator();
+        synchronized (VmThreadMap.THREAD_LOCK) {
+            final Pointer exited = nativeExitedThreadsTrapCounts();
+            for (Count count : Count.VALUES) {
+                accumulator.counts[count.ordinal()] = exited.getWord(count.ordinal()).asAddress().toLong();
+            }
+            VmThreadMap.ACTIVE.forAllThreadLocals(null, accumulator);
+        }
+        return accumulator.counts;
+    }
+
     /**
      * This method is called from the {@linkplain Stubs#trapStub trap stub} and does the actual trap handling.
      *
@@ -404,6 +484,12 @@ public abstract class Trap {
             // safepoint instruction.
             tfa.setSafepointLatch(trapFrame, etla);
 
+            // A thread triggers its own safepoint to report an allocation sample once the sampled object is initialized.
+            final Object sampled = HeapSchemeWithTLAB.takeSampledAllocation(etla);
+            if (sampled != null) {
+                VMTI.handler().objectSampled(sampled);
+            }
+
         } else if (inJava(dtla)) {
             tfa.setTrapNumber(trapFrame, Number.NULL_POINTER_EXCEPTION);
             // null pointer exception
@@ -554,6 +554,7 @@ public class VmOperation {
                 // Ensures updates to safepoint-related control variables are visible to all threads
                 // before the VM operation thread reads them
                 MemoryBarriers.barrier(MemoryBarriers.STORE_LOAD);
+                handshake();
 
                 waitUntilFrozen();
 
@@ -735,6 +736,43 @@ public class VmOperation {
             "Number of iterations in VM operation thread while waiting for a thread to freeze before falling back to yield or sleep");
     }
 
+    /**
+     * Off by default as the barrier interrupts every CPU running a thread of the VM on each VM operation, which
+     * only pays off where threads are slow to see their safepoint latch being triggered. It does not change how
+     * threads are stopped.
+     */
+    static boolean UseMembarrierHandshakes = false;
+    static {
+        VMOptions.addFieldOption("-XX:", "UseMembarrierHandshakes", VmOperation.class,
+            "Use the membarrier system call (where a process private barrier is available) to make triggered safepoints " +
+            "visible to running threads before waiting for them to freeze");
+    }
+
+    /**
+     * Denotes whether the process private membarrier is available: 0 if not yet determined, 1 if available, -1 if not.
+     */
+    private static int membarrierHandshakes;
+
+    /**
+     * Forces every thread running on another CPU through a full memory barrier, making the safepoint latches
+     * and freeze requests just stored by the VM operation thread visible to them. The values stored by those
+     * threads (in particular their {@link VmThreadLocal#MUTATOR_STATE}) up to that point are in turn visible
+     * to the VM operation thread. This shortens the time until triggered threads reach their next safepoint
+     * on platforms with weak memory models and lets the first check in {@link #waitForThreadFreeze(VmThread)}
+     * succeed more often. It is skipped if only the (slow) system wide barrier is available.
+     */
+    private static void handshake() {
+        if (!UseMembarrierHandshakes) {
+            return;
+        }
+        if (membarrierHandshakes == 0) {
+            membarrierHandshakes = MaxineVM.membarrier_isExpedited() ? 1 : -1;
+        }
+        if (membarrierHandshakes > 0) {
+            MaxineVM.syscall_membarrier();
+        }
+    }
+
     /**
      * Pauses/yields/sleeps the VM operation thread while waiting for another thread to freeze.
      *
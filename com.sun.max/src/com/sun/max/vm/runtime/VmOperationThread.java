@@ -117,6 +117,13 @@ public class VmOperationThread extends Thread implements UncaughtExceptionHandle
         FatalError.unexpected("Only the VM thread can promote a VmOperation's mode to global safepoint");
     }
 
+    /**
+     * Gets the operation being executed by the VM operation thread, or {@code null} if it is idle.
+     */
+    public VmOperation currentOperation() {
+        return currentOperation;
+    }
+
     public boolean runsGlobalSafepointOperation() {
         VmOperation vmOp = currentOperation;
         return vmOp != null && vmOp.requiresGlobalSafepoint();
@@ -38,6 +38,7 @@ import com.sun.max.lang.*;
 import com.sun.max.memory.*;
 import com.sun.max.platform.*;
 import com.sun.max.unsafe.*;
+import com.sun.max.util.*;
 import com.sun.max.vm.*;
 import com.sun.max.vm.actor.holder.*;
 import com.sun.max.vm.bytecode.refmaps.*;
@@ -234,6 +235,12 @@ public class VmThread {
     private Throwable terminationCause;
     private int id;
     private int parkState;
+
+    /**
+     * Specifies if this attached thread has been detached but kept {@linkplain #becomeDormant() dormant}.
+     * A dormant thread is not counted as a running non-daemon thread.
+     */
+    boolean dormant;
     /**
      * Guaranteed unique for the lifetime of the VM.
      */
@@ -265,6 +272,16 @@ public class VmThread {
     @CONSTANT
     protected Word nativeThread = Word.zero();
 
+    /**
+     * The CPU the native thread is bound to when it is started or -1.
+     */
+    protected int startCPU = -1;
+
+    /**
+     * The NUMA node the native thread runs on when it is started or -1.
+     */
+    protected int startNUMANode = -1;
+
     private final VmStackFrameWalker stackFrameWalker = new VmStackFrameWalker(Pointer.zero());
 
     private final VmStackFrameWalker stackDumpStackFrameWalker = new VmStackFrameWalker(Pointer.zero());
@@ -456,7 +473,42 @@ public class VmThread {
     }
 
     @C_FUNCTION
-    protected static native Word nativeThreadCreate(int id, Size stackSize, int priority);
+    protected static native Word nativeThreadCreate(int id, Size stackSize, int priority, int cpu, int node);
+
+    /**
+     * Specifies the CPU or NUMA node this thread is bound to when it is started. The thread locals and stack of
+     * the thread are then placed on the NUMA node the thread runs on. This is only supported on Linux
+     * and must be called before the thread is started.
+     *
+     * @param cpu the CPU to bind to or -1
+     * @param node the NUMA node to bind to or -1 (ignored if {@code cpu != -1})
+     */
+    public final void setStartAffinity(int cpu, int node) {
+        startCPU = cpu;
+        startNUMANode = node;
+    }
+
+    /**
+     * Binds the current thread to a CPU and moves its thread locals and stack to the NUMA node of the CPU.
+     * This is only supported on Linux.
+     *
+     * @return true if the thread was bound, false otherwise
+     */
+    public static boolean bindCurrentThreadToCPU(int cpu) {
+        return nativeBindCurrentThread(cpu, -1);
+    }
+
+    /**
+     * Binds the current thread to the CPUs of a NUMA node and moves its thread locals and stack to the node.
+     * This is only supported on Linux.
+     *
+     * @return true if the thread was bound, false otherwise
+     */
+    public static boolean bindCurrentThreadToNUMANode(int node) {
+        return nativeBindCurrentThread(-1, node);
+    }
+
+    private static native boolean nativeBindCurrentThread(int cpu, int node);
 
     /**
      * Gets the current {@linkplain VmThreadLocal TLA}.
@@ -763,6 +815,55 @@ public class VmThread {
     }
 
 
+    /**
+     * Called through JNI by 'thread_detachCurrent()' in threads.c, instead of tearing the thread down, when
+     * detached threads are kept dormant (see -XX:+DormantAttachedThreads). The thread keeps its thread locals
+     * and its place in the thread map but stops counting as a running non-daemon thread. As it is outside
+     * any JNI call, it is already safe for GC.
+     */
+    private static void becomeDormant() {
+        VmThread thread = VmThread.current();
+        // Release the local references of the callbacks made while attached
+        thread.resetJniHandlesTop(0);
+        synchronized (VmThreadMap.THREAD_LOCK) {
+            if (!thread.daemon) {
+                VmThreadMap.decrementNonDaemonThreads();
+            }
+            thread.dormant = true;
+        }
+    }
+
+    /**
+     * Called through JNI by 'thread_attachCurrent()' in threads.c when a {@linkplain #becomeDormant() dormant}
+     * thread is attached again.
+     *
+     * @param nameCString the name given in the attach arguments, or 0
+     * @param daemon specifies if the thread is being attached as a daemon
+     * @return {@link JniFunctions#JNI_OK} if the thread is running again, {@link JniFunctions#JNI_EDETACHED} if the
+     *         main thread has exited or {@link JniFunctions#JNI_ERR} if the thread must be detached and attached
+     *         afresh because its daemon status changed
+     */
+    private static int awaken(long nameCString, boolean daemon) {
+        VmThread thread = VmThread.current();
+        synchronized (VmThreadMap.THREAD_LOCK) {
+            if (daemon != thread.daemon) {
+                return JniFunctions.JNI_ERR;
+            }
+            if (!daemon && !VmThreadMap.incrementNonDaemonThreads()) {
+                return JniFunctions.JNI_EDETACHED;
+            }
+            thread.dormant = false;
+        }
+        if (nameCString != 0L) {
+            try {
+                thread.javaThread.setName(CString.utf8ToJava(Pointer.fromLong(nameCString)));
+            } catch (Utf8Exception utf8Exception) {
+                // Keep the previous name
+            }
+        }
+        return JniFunctions.JNI_OK;
+    }
+
     @INSPECTED
     @NEVER_INLINE
     private static void detached() {
@@ -850,6 +951,30 @@ public class VmThread {
 
     private static native void nativeYield();
 
+    /**
+     * Hints to the CPU that the current thread is busy-waiting, without entering the kernel.
+     * @see Thread#onSpinWait()
+     */
+    public static void onSpinWait() {
+        spinWait_onSpinWait();
+    }
+
+    /**
+     * Waits briefly for a condition that another thread is expected to establish soon: the first rounds spin on the
+     * CPU with exponential backoff and later ones {@linkplain #yield() yield} it.
+     *
+     * @param round the number of times the caller has already waited for the same condition, starting at 0
+     */
+    public static void spinWait(int round) {
+        spinWait_adaptive(round);
+    }
+
+    @C_FUNCTION
+    private static native void spinWait_onSpinWait();
+
+    @C_FUNCTION
+    private static native void spinWait_adaptive(int round);
+
     private static native void nativeSetPriority(Word nativeThread, int newPriority);
 
     /**
@@ -869,6 +994,10 @@ public class VmThread {
 
     private static native boolean nativeSleep(long numberOfMilliSeconds);
 
+    private static native long nativeSleepNanos(long nanos);
+
+    private static native long nativeSetTimerSlack(long nanos);
+
     public static void sleep(long millis) throws InterruptedException {
         final VmThread current = current();
         State oldState = current.state();
@@ -881,8 +1010,43 @@ public class VmThread {
         }
     }
 
+    /**
+     * Sleeps the current thread for a given number of nanoseconds. Unlike {@link #sleep(long)}, the sleep
+     * is not rounded to milliseconds and a signal other than an {@linkplain #interrupt0() interrupt} only
+     * causes the rest of the time to be slept.
+     *
+     * @param nanos the time to sleep in nanoseconds
+     */
+    public static void sleepNanos(long nanos) throws InterruptedException {
+        final VmThread current = current();
+        State oldState = current.state();
+        current.setState(State.TIMED_WAITING);
+        long remaining = nanos;
+        do {
+            remaining = current.sleepNanos0(remaining);
+        } while (remaining != 0 && !current.interrupted);
+        current.setState(oldState);
+        if (remaining != 0) {
+            current.interrupted = false;
+            throw new InterruptedException();
+        }
+    }
+
+    /**
+     * Sets how late the timed wakeups of the current thread may be delivered so that the kernel can coalesce them
+     * with others. Latency-critical threads can ask for a small slack and background threads for a large one.
+     *
+     * @param nanos the slack in nanoseconds, or 0 to restore the default slack of the thread
+     * @return the previous slack in nanoseconds, or -1 if the platform does not support setting it
+     */
+    public static long setTimerSlack(long nanos) {
+        return nativeSetTimerSlack(nanos);
+    }
+
     public static native void nativeInterrupt(Word nativeThread);
 
+    private static native long nativeThreadCpuTime(Word nativeThread, boolean userAndSystem);
+
     /**
      * Number of yellow zone pages used for detecting recoverable stack overflow.
      * This space must also accommodate the execution of stack over handling from
@@ -1074,6 +1238,20 @@ public class VmThread {
         return nativeThread;
     }
 
+    /**
+     * Gets the CPU time consumed by this thread. Unless this is the current thread, the caller must hold
+     * {@link VmThreadMap#THREAD_LOCK} so that the native thread cannot terminate during the call.
+     *
+     * @param userAndSystem specifies if the time spent in the kernel on behalf of this thread is included
+     * @return the CPU time in nanoseconds or -1 if it is not available
+     */
+    public final long cpuTime(boolean userAndSystem) {
+        if (nativeThread.isZero()) {
+            return -1;
+        }
+        return nativeThreadCpuTime(nativeThread, userAndSystem);
+    }
+
     /**
      * Gets the identifier used to identify this thread in the {@linkplain VmThreadMap thread map}.
      * A thread that has not been added to the thread map, will have an identifier of 0 and
@@ -1228,6 +1406,14 @@ public class VmThread {
     }
 
     public final JniHandle createLocalHandle(Object object) {
+        JniHandle handle = JniHandles.allocateArenaHandle(tla, object);
+        if (handle.isZero() && JniHandles.allocateArena(tla)) {
+            // the arena is mapped when the first local reference is created
+            handle = JniHandles.allocateArenaHandle(tla, object);
+        }
+        if (!handle.isZero()) {
+            return handle;
+        }
         if (jniHandles == null) {
             jniHandles = new JniHandles();
         }
@@ -1244,15 +1430,15 @@ public class VmThread {
     }
 
     /**
-     * Return the "top" (i.e. current size) of JNI handles for this thread
+     * Return the "top" (i.e. current size) of JNI handles for this thread, which is the number of
+     * handles in the local handle arena followed by those in the {@linkplain #jniHandles() pool}.
      *
      * NOTE: This code is called from a {@linkplain NativeStubGenerator JNI stub}
-     *
-     * @return -1 if the JNI handles have not been allocated for this thread
      */
     @INLINE
     public final int jniHandlesTop() {
-        return jniHandles == null ? -1 : jniHandles.top();
+        final int arenaTop = JniHandles.arenaTop(tla);
+        return jniHandles == null ? arenaTop : arenaTop + jniHandles.top();
     }
 
     /**
@@ -1260,12 +1446,19 @@ public class VmThread {
      *
      * NOTE: This code is called from a {@linkplain NativeStubGenerator JNI stub}
      *
-     * @param newTop the value to which the top should be reset or -1 if no resetting is to occur
+     * @param newTop a value previously returned by {@link #jniHandlesTop()}
      */
     @INLINE
     public final void resetJniHandlesTop(int newTop) {
-        if (newTop != -1) {
-            jniHandles.resetTop(newTop);
+        final int arenaTop = JniHandles.arenaTop(tla);
+        if (newTop < arenaTop) {
+            // The pool is only used once the arena is full so it was empty when newTop was saved
+            JniHandles.resetArenaTop(tla, newTop);
+            if (jniHandles != null) {
+                jniHandles.resetTop(0);
+            }
+        } else if (jniHandles != null) {
+            jniHandles.resetTop(newTop - arenaTop);
         }
     }
 
@@ -1405,6 +1598,13 @@ public class VmThread {
         return VmThread.nativeSleep(numberOfMilliSeconds);
     }
 
+    /**
+     * @return 0 if the full time was slept, otherwise the number of nanoseconds remaining when the sleep was interrupted
+     */
+    protected long sleepNanos0(long nanos) {
+        return VmThread.nativeSleepNanos(nanos);
+    }
+
     public final void stop0(Object throwable) {
         terminationCause = (Throwable) throwable;
         FatalError.unimplemented("stop0");
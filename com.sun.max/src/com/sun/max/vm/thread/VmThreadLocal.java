@@ -557,6 +557,8 @@ public class VmThreadLocal implements FormatWithToString {
 
         VMLog.scanLogs(tla, wordPointerIndexVisitor);
 
+        JniHandles.scanArena(tla, wordPointerIndexVisitor);
+
         Pointer anchor = JavaFrameAnchor.from(tla);
         if (!anchor.isZero()) {
             final Pointer lastJavaCallerStackPointer = JavaFrameAnchor.SP.get(anchor);
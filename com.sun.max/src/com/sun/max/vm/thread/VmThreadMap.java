@@ -333,7 +333,7 @@ public final class VmThreadMap {
         setNext(tla, Pointer.zero());
         // release the ID for a later thread's use
         idMap.release(thread.id());
-        if (!thread.daemon && thread != VmThread.mainThread) {
+        if (!thread.daemon && !thread.dormant && thread != VmThread.mainThread) {
             decrementNonDaemonThreads();
         }
         liveThreads--;
@@ -359,7 +359,7 @@ public final class VmThreadMap {
                 }
             }
 
-            final Word nativeThread = VmThread.nativeThreadCreate(id, stackSize, priority);
+            final Word nativeThread = VmThread.nativeThreadCreate(id, stackSize, priority, thread.startCPU, thread.startNUMANode);
             if (nativeThread.isZero()) {
                 /* This means that we did not create the native thread at all so there is nothing to
                  * terminate. Most likely we ran out of memory allocating the stack, so we throw
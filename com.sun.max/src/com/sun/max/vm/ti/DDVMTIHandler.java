@@ -156,6 +156,12 @@ public class DDVMTIHandler implements VMTIHandler {
         eventHandler2.raise(throwable, sp, fp, ip);
     }
 
+    @Override
+    public void objectSampled(Object object) {
+        eventHandler1.objectSampled(object);
+        eventHandler2.objectSampled(object);
+    }
+
     @Override
     public RuntimeCompiler runtimeCompiler(RuntimeCompiler stdRuntimeCompiler) {
         RuntimeCompiler rc1 = eventHandler1.runtimeCompiler(stdRuntimeCompiler);
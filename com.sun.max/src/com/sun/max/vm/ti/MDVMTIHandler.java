@@ -187,6 +187,13 @@ class MDVMTIHandler implements VMTIHandler {
         }
     }
 
+    @Override
+    public void objectSampled(Object object) {
+        for (int i = 0; i < eventHandlers.length; i++) {
+            eventHandlers[i].objectSampled(object);
+        }
+    }
+
     @Override
     public RuntimeCompiler runtimeCompiler(RuntimeCompiler stdRuntimeCompiler) {
         for (int i = 0; i < eventHandlers.length; i++) {
@@ -101,6 +101,10 @@ public class NullVMTIHandler implements VMTIHandler {
     public void raise(Throwable throwable, Pointer sp, Pointer fp, CodePointer ip) {
     }
 
+    @Override
+    public void objectSampled(Object object) {
+    }
+
     @Override
     public RuntimeCompiler runtimeCompiler(RuntimeCompiler stdRuntimeCompiler) {
         return null;
@@ -129,6 +129,11 @@ class SDVMTIHandler implements VMTIHandler {
         eventHandler.raise(throwable, sp, fp, ip);
     }
 
+    @Override
+    public void objectSampled(Object object) {
+        eventHandler.objectSampled(object);
+    }
+
     @Override
     public RuntimeCompiler runtimeCompiler(RuntimeCompiler stdRuntimeCompiler) {
         return eventHandler.runtimeCompiler(stdRuntimeCompiler);
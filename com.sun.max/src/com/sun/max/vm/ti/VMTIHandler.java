@@ -139,6 +139,13 @@ public interface VMTIHandler {
      */
     void raise(Throwable throwable, Pointer sp, Pointer fp, CodePointer ip);
 
+    /**
+     * An allocation has been sampled (see {@link com.sun.max.vm.heap.HeapSchemeWithTLAB#setAllocationSamplingInterval(long)}).
+     * This is called in the allocating thread shortly after the allocation.
+     * @param object the allocated object
+     */
+    void objectSampled(Object object);
+
 
     /**
      * Allows the tooling system to register a special (baseline) compiler to use
@@ -160,6 +160,7 @@ public final class ClassRegistry {
 
         new CriticalNativeMethod(VmThread.class, "nonJniNativeSleep");
         new CriticalNativeMethod(VmThread.class, "nativeSleep");
+        new CriticalNativeMethod(VmThread.class, "nativeSleepNanos");
         new CriticalNativeMethod(VmThread.class, "nativeYield");
     }
 
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2018, APT Group, School of Computer Science,
+ * The University of Manchester. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * The benchmark mode of the cross-ISA tests (see CrossISATester.BENCHMARK_ITERATIONS), included by the
+ * test_<isa>.c harnesses after they define cycle_counter_enable(), cycle_counter_read() and
+ * cycle_counter_frequency().
+ *
+ * In benchmark mode the generated c_entry() calls benchmark_run() instead of calling the generated code once.
+ * The code is called 'iterations' times through benchmark_call (see startup_<isa>.s), which preserves the
+ * callee saved registers the code may clobber, and the counter ticks taken are recorded. The same loop around
+ * an empty function is timed to give the overhead of the loop and the call. gdb_input_benchmark prints the
+ * variables below at the 'success' breakpoint in the same format as the register dump.
+ *
+ * The code must return and must preserve the stack pointer. Up to three integer arguments are passed to it.
+ */
+
+unsigned long long benchmark_iterations;
+unsigned long long benchmark_cycles;
+unsigned long long benchmark_overhead;
+unsigned long long benchmark_frequency;
+
+extern void benchmark_call(void *code, long a0, long a1, long a2);
+
+static void benchmark_empty(void) {
+}
+
+static unsigned long long benchmark_loop(void *code, unsigned long long iterations, long a0, long a1, long a2) {
+    unsigned long long i;
+    unsigned long long start = cycle_counter_read();
+    for (i = 0; i < iterations; i++) {
+        benchmark_call(code, a0, a1, a2);
+    }
+    return cycle_counter_read() - start;
+}
+
+void benchmark_run(void *code, unsigned long long iterations, long a0, long a1, long a2) {
+    cycle_counter_enable();
+    benchmark_frequency = cycle_counter_frequency();
+    benchmark_iterations = iterations;
+    benchmark_overhead = benchmark_loop((void *) benchmark_empty, iterations, a0, a1, a2);
+    benchmark_cycles = benchmark_loop(code, iterations, a0, a1, a2);
+}
@@ -20,6 +20,37 @@ success:
 failure:
  B . // We got an exception, go debug
 
+// Calls the generated code at x0 with the arguments in x1-x3 for benchmark_run()
+// in benchmark.c, preserving the callee saved registers that the code may clobber.
+.global benchmark_call
+benchmark_call:
+ STP x29, x30, [sp, #-160]!
+ STP x19, x20, [sp, #16]
+ STP x21, x22, [sp, #32]
+ STP x23, x24, [sp, #48]
+ STP x25, x26, [sp, #64]
+ STP x27, x28, [sp, #80]
+ STP d8, d9, [sp, #96]
+ STP d10, d11, [sp, #112]
+ STP d12, d13, [sp, #128]
+ STP d14, d15, [sp, #144]
+ MOV x16, x0
+ MOV x0, x1
+ MOV x1, x2
+ MOV x2, x3
+ BLR x16
+ LDP d14, d15, [sp, #144]
+ LDP d12, d13, [sp, #128]
+ LDP d10, d11, [sp, #112]
+ LDP d8, d9, [sp, #96]
+ LDP x27, x28, [sp, #80]
+ LDP x25, x26, [sp, #64]
+ LDP x23, x24, [sp, #48]
+ LDP x21, x22, [sp, #32]
+ LDP x19, x20, [sp, #16]
+ LDP x29, x30, [sp], #160
+ RET
+
 // Typical exception vector table code.
 .balign 0x800
 vector_table_el:
@@ -8,6 +8,20 @@ success:
 failure:
  B .
 
+@ Calls the generated code at r0 with the arguments in r1-r3 for benchmark_run()
+@ in benchmark.c, preserving the callee saved registers that the code may clobber.
+.global benchmark_call
+benchmark_call:
+ PUSH {r4-r12, lr}
+ VPUSH {d8-d15}
+ MOV r12, r0
+ MOV r0, r1
+ MOV r1, r2
+ MOV r2, r3
+ BLX r12
+ VPOP {d8-d15}
+ POP {r4-r12, pc}
+
 .EQU Mode_UNDEF, 0x1B
 .EQU UNDEF_Stack, 0x4000;
 Setup_Undef_Stack:
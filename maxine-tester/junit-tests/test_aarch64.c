@@ -7,6 +7,26 @@ void print_uart0(const char *s) {
     }
 }
 
+/*
+ * The generic timer's virtual count. With 'qemu -icount' it advances deterministically with the instructions executed.
+ */
+static inline void cycle_counter_enable(void) {
+}
+
+static inline unsigned long long cycle_counter_read(void) {
+    unsigned long long value;
+    __asm__ __volatile__("isb; mrs %0, cntvct_el0" : "=r" (value) : : "memory");
+    return value;
+}
+
+static inline unsigned long long cycle_counter_frequency(void) {
+    unsigned long long value;
+    __asm__ __volatile__("mrs %0, cntfrq_el0" : "=r" (value));
+    return value;
+}
+
+#include "./benchmark.c"
+
 #include "./codebuffer.c"
 
 // Add a main method to trick gcc to consider c_entry as a normal
@@ -7,4 +7,22 @@ void print_uart0(const char *s) {
     }
 }
 
+/*
+ * The cycle CSR. With 'qemu -icount' it advances deterministically with the instructions executed.
+ */
+static inline void cycle_counter_enable(void) {
+}
+
+static inline unsigned long long cycle_counter_read(void) {
+    unsigned long long value;
+    __asm__ __volatile__("rdcycle %0" : "=r" (value) : : "memory");
+    return value;
+}
+
+static inline unsigned long long cycle_counter_frequency(void) {
+    return 0;
+}
+
+#include "./benchmark.c"
+
 #include "./codebuffer.c"